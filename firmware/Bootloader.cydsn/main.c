@@ -1,40 +1,344 @@
 #include <project.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Bootloader_PVT.h"
+#include "../Reload Pro.cydsn/lzfx.h"
+
+// Baud rate negotiation, the same as the application's 'baud' command:
+// "baud <rate>" is answered at the old rate, then the host must send the same
+// line again at the new rate within BAUD_CONFIRM_MS, or the old rate returns.
+#define BAUD_CONFIRM_MS 1000
+
+// Reception is interrupt driven into a ring, so the 8 byte hardware FIFO
+// can't overflow at high baud rates while the bootloader is busy elsewhere.
+// UART is SCB0, whose interrupt line is fixed; there's no ISR component for
+// it in this design, so the vector is installed by hand.
+#define UART_RX_IRQ 10u
+#define RX_RING_SIZE 256 // Must be a power of two
+#define BYTE_TIMEOUT_US 10000 // Gap that ends a read that isn't a whole packet
+
+// Two commands beyond the standard set, handled here before the bootloader
+// sees the packet, for the host to speed up updates with:
+//  * Program compressed: [array id] [row, 16 bit] [lzfx compressed row]. The
+//    row is decompressed and passed on as an ordinary program row command, so
+//    it's checked and answered exactly as one.
+//  * Row hash: [array id] [row, 16 bit], answered with the CRC-16 (CCITT,
+//    initial 0xFFFF) of the row as it's programmed now, so the host can skip
+//    rows that already match the new image.
+#define COMMAND_PROGRAM_COMPRESSED 0x40u
+#define COMMAND_ROW_HASH 0x41u
+#define ROWS_PER_ARRAY (CY_FLASH_SIZEOF_ARRAY / CY_FLASH_SIZEOF_ROW)
+
+#if(0u != Bootloader_PACKET_CHECKSUM_CRC)
+#error "packet_checksum only implements the basic summation checksum"
+#endif
+
+// A normal boot skips Bootloader_Start's whole-image checksum once the image
+// has passed it. The mark is the metadata row's verified byte, which the
+// component's fast validation would use, set here after a full check of our
+// own. Programming the metadata row brings the image's own value, so a new
+// image is always checked in full on its first boot; the mark is also
+// cleared at the first row programmed or erased, so an update that's cut
+// short can't leave old metadata vouching for half a new image.
+#if(0u != Bootloader_DUAL_APP_BOOTLOADER || 0u != Bootloader_FAST_APP_VALIDATION)
+#error "the validated mark assumes one application and the component's own check"
+#endif
+#define IMAGE_APP 0u
+
+static uint8 image_marked() {
+	return Bootloader_MD_BTLDB_VERIFIED_VALUE(IMAGE_APP) == Bootloader_MD_BTLDB_IS_VERIFIED;
+}
+
+static void image_mark(uint8 value) {
+	Bootloader_SetFlashByte((uint32)Bootloader_MD_BTLDB_VERIFIED_OFFSET(IMAGE_APP), value);
+}
+
+// Metadata fields are little endian on PSoC 4, and may be unaligned
+static uint32 metadata_field(uint32 address, uint8 size) {
+	uint32 value = 0;
+	while(size > 0)
+		value = (value << 8) | CY_GET_XTND_REG8((volatile uint8 *)(address + --size));
+	return value;
+}
+
+// The same check as Bootloader_ValidateBootloadable, which is private to it:
+// the image's bytes sum with the stored checksum to zero, and they aren't all
+// blank
+static uint8 image_valid() {
+	uint32 start = CYDEV_FLS_ROW_SIZE * (metadata_field(Bootloader_MD_BTLDR_LAST_ROW_OFFSET(IMAGE_APP), 2) + 1);
+	uint32 end = start + metadata_field(Bootloader_MD_BTLDB_LENGTH_OFFSET(IMAGE_APP), 4);
+	uint8 sum = 0, blank = 1;
+
+	if(metadata_field(Bootloader_MD_BTLDB_ADDR_OFFSET(IMAGE_APP), 4) == 0 || end > CYDEV_FLASH_SIZE - Bootloader_MD_SIZEOF)
+		return 0;
+	for(uint32 address = start; address < end; address++) {
+		uint8 byte = Bootloader_GET_CODE_BYTE(address);
+		if(byte != 0 && byte != 0xFF)
+			blank = 0;
+		sum += byte;
+	}
+	return !blank && (uint8)(1u + (uint8)~sum) == Bootloader_MD_BTLDB_CHECKSUM_VALUE(IMAGE_APP);
+}
+
+static uint8 rx_ring[RX_RING_SIZE];
+static volatile uint16 rx_head = 0;
+static uint16 rx_tail = 0;
+
+CY_ISR(uart_rx_isr) {
+	while(UART_GET_RX_FIFO_ENTRIES != 0) {
+		rx_ring[rx_head & (RX_RING_SIZE - 1)] = UART_RX_FIFO_RD_REG;
+		rx_head++;
+	}
+	UART_ClearRxInterruptSource(UART_INTR_RX_NOT_EMPTY);
+}
+
+// Next received byte, or -1 if none arrives within timeoutUs
+static int get_byte(int timeoutUs) {
+	while(rx_head == rx_tail) {
+		if(timeoutUs <= 0)
+			return -1;
+		CyDelayUs(10);
+		timeoutUs -= 10;
+	}
+	return rx_ring[rx_tail++ & (RX_RING_SIZE - 1)];
+}
+
+// Reprograms the UART for the nearest rate the oversampling factor and
+// fractional clock divider can make. Returns 0 if none is within 2%.
+static uint32 set_baud(uint32 baud) {
+	uint32 best_div32 = 0, best_rate = 0, best_error = baud / 50;
+	uint8 best_ovs = 0;
+
+	for(uint8 ovs = 16; ovs >= 8; ovs--) {
+		// The divider is in 32nds of HFCLK
+		uint32 div32 = ((CYDEV_BCLK__HFCLK__HZ * 32u) / ovs + baud / 2) / baud;
+		if(div32 < 32 || div32 >= (0x10000u << 5))
+			continue;
+		uint32 rate = (CYDEV_BCLK__HFCLK__HZ * 32u) / (div32 * ovs);
+		uint32 error = (rate > baud)?rate - baud:baud - rate;
+		if(error <= best_error) {
+			best_error = error;
+			best_div32 = div32;
+			best_ovs = ovs;
+			best_rate = rate;
+		}
+	}
+	if(best_ovs == 0)
+		return 0;
+
+	// Let the last byte finish at the old rate
+	while(UART_SpiUartGetTxBufferSize() > 0);
+	CyDelay(1);
+
+	UART_Stop();
+	UART_Clock_SetFractionalDividerRegister((best_div32 >> 5) - 1, best_div32 & 0x1F);
+	UART_CTRL_REG = (UART_CTRL_REG & ~UART_CTRL_OVS_MASK) | UART_GET_CTRL_OVS(best_ovs);
+	UART_Enable();
+	return best_rate;
+}
+
+static void put_string(const char *s) {
+	UART_SpiUartPutArray((const uint8 *)s, strlen(s));
+}
+
+static uint32 current_baud = 115200;
+
+static void negotiate_baud(const char *request) {
+	char expected[24], line[24];
+	uint8 len = 0;
+	uint32 old_baud = current_baud, baud = atoi(request + 5);
+
+	strncpy(expected, request, sizeof(expected) - 1);
+	expected[sizeof(expected) - 1] = '\0';
+	expected[strcspn(expected, "\r\n")] = '\0';
+	put_string(expected);
+	put_string("\r\n");
+	if(set_baud(baud) == 0) {
+		put_string("err baud rate not possible\r\n");
+		return;
+	}
+	current_baud = baud;
+
+	for(int timeoutMs = BAUD_CONFIRM_MS; timeoutMs > 0; timeoutMs--) {
+		int c = get_byte(1000);
+		if(c < 0)
+			continue;
+		if(c != '\r' && c != '\n') {
+			if(len < sizeof(line) - 1)
+				line[len++] = c;
+			continue;
+		}
+		line[len] = '\0';
+		len = 0;
+		if(strcmp(line, expected) == 0) {
+			put_string(expected);
+			put_string(" ok\r\n");
+			return;
+		}
+	}
+
+	set_baud(old_baud);
+	current_baud = old_baud;
+	put_string("err baud not confirmed\r\n");
+}
+
+// The same as the bootloader's own, which is private to it
+static uint16 packet_checksum(const uint8 *buffer, uint16 size) {
+	uint16 sum = 0;
+	while(size > 0)
+		sum += buffer[--size];
+	return 1u + (uint16)~sum;
+}
+
+static void send_response(uint8 status, const uint8 *data, uint16 size) {
+	uint8 packet[Bootloader_MIN_PKT_SIZE + 2];
+	packet[Bootloader_SOP_ADDR] = Bootloader_SOP;
+	packet[Bootloader_CMD_ADDR] = status;
+	packet[Bootloader_SIZE_ADDR] = size;
+	packet[Bootloader_SIZE_ADDR + 1] = 0;
+	if(size > 0)
+		memcpy(&packet[Bootloader_DATA_ADDR], data, size);
+	uint16 checksum = packet_checksum(packet, Bootloader_DATA_ADDR + size);
+	packet[Bootloader_CHK_ADDR(size)] = checksum & 0xFF;
+	packet[Bootloader_CHK_ADDR(size) + 1] = checksum >> 8;
+	packet[Bootloader_EOP_ADDR(size)] = Bootloader_EOP;
+	UART_SpiUartPutArray(packet, Bootloader_MIN_PKT_SIZE + size);
+}
+
+static uint16 row_crc(const uint8 *row) {
+	uint16 crc = 0xFFFF;
+	for(uint16 i = 0; i < CY_FLASH_SIZEOF_ROW; i++) {
+		crc ^= (uint16)row[i] << 8;
+		for(uint8 bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000)?(crc << 1) ^ 0x1021:crc << 1;
+	}
+	return crc;
+}
+
+// Handles the extra commands in a whole, well formed packet. Returns 1 if the
+// bootloader should process what's left in buffer (rewritten in the case of
+// a compressed row), or 0 if it's been answered here.
+static int extra_command(uint8 *buffer, uint16 *count, uint16 size) {
+	uint8 command = buffer[Bootloader_CMD_ADDR];
+	if(command != COMMAND_PROGRAM_COMPRESSED && command != COMMAND_ROW_HASH)
+		return 1;
+
+	uint16 length = buffer[Bootloader_SIZE_ADDR] | (buffer[Bootloader_SIZE_ADDR + 1] << 8);
+	uint16 checksum = buffer[Bootloader_CHK_ADDR(length)] | (buffer[Bootloader_CHK_ADDR(length) + 1] << 8);
+	if(buffer[Bootloader_EOP_ADDR(length)] != Bootloader_EOP || checksum != packet_checksum(buffer, Bootloader_DATA_ADDR + length))
+		// Ill formed, so let the bootloader reject it in the usual way
+		return 1;
+
+	uint8 *data = &buffer[Bootloader_DATA_ADDR];
+	uint8 array = data[0];
+	uint16 row = data[1] | (data[2] << 8);
+	if(length < 3 || (command == COMMAND_ROW_HASH && length != 3)) {
+		send_response(Bootloader_ERR_LENGTH, NULL, 0);
+		return 0;
+	}
+	if(array >= Bootloader_NUM_OF_FLASH_ARRAYS) {
+		send_response(Bootloader_ERR_ARRAY, NULL, 0);
+		return 0;
+	}
+	if(row >= ROWS_PER_ARRAY) {
+		send_response(Bootloader_ERR_ROW, NULL, 0);
+		return 0;
+	}
+
+	if(command == COMMAND_ROW_HASH) {
+		uint16 crc = row_crc((const uint8 *)(CY_FLASH_BASE + array * CY_FLASH_SIZEOF_ARRAY + row * CY_FLASH_SIZEOF_ROW));
+		uint8 response[2] = {crc & 0xFF, crc >> 8};
+		send_response(CYRET_SUCCESS, response, sizeof(response));
+		return 0;
+	}
+
+	static uint8 row_data[CY_FLASH_SIZEOF_ROW];
+	unsigned int row_length = sizeof(row_data);
+	uint16 program_length = 3 + CY_FLASH_SIZEOF_ROW;
+	if(lzfx_decompress(&data[3], length - 3, row_data, &row_length) < 0 || row_length != sizeof(row_data)
+	   || Bootloader_MIN_PKT_SIZE + program_length > size) {
+		send_response(Bootloader_ERR_DATA, NULL, 0);
+		return 0;
+	}
+	buffer[Bootloader_CMD_ADDR] = Bootloader_COMMAND_PROGRAM;
+	buffer[Bootloader_SIZE_ADDR] = program_length & 0xFF;
+	buffer[Bootloader_SIZE_ADDR + 1] = program_length >> 8;
+	memcpy(&data[3], row_data, sizeof(row_data));
+	checksum = packet_checksum(buffer, Bootloader_DATA_ADDR + program_length);
+	buffer[Bootloader_CHK_ADDR(program_length)] = checksum & 0xFF;
+	buffer[Bootloader_CHK_ADDR(program_length) + 1] = checksum >> 8;
+	buffer[Bootloader_EOP_ADDR(program_length)] = Bootloader_EOP;
+	*count = Bootloader_MIN_PKT_SIZE + program_length;
+	return 1;
+}
 
 void CyBtldrCommStart(void) {
 	UART_Start();
+	rx_tail = rx_head;
+	UART_SetRxInterruptMode(UART_INTR_RX_NOT_EMPTY);
+	CyIntSetVector(UART_RX_IRQ, uart_rx_isr);
+	CyIntEnable(UART_RX_IRQ);
 }
 
 void CyBtldrCommStop (void) {
+	CyIntDisable(UART_RX_IRQ);
+	UART_SetRxInterruptMode(0);
 	UART_Stop();
 }
 
 void CyBtldrCommReset(void) {
 	UART_SpiUartClearRxBuffer();
 	UART_SpiUartClearTxBuffer();
+	rx_tail = rx_head;
 }
 
 cystatus CyBtldrCommWrite(uint8* buffer, uint16 size, uint16* count, uint8 timeOut) {
-	for(*count = 0; *count < size; (*count)++) {
-		UART_UartPutChar(buffer[*count]);
-	}
+	UART_SpiUartPutArray(buffer, size);
+	*count = size;
 	
 	return CYRET_SUCCESS;
 }
 
+// Returns as soon as a whole packet is in, going by its length field, rather
+// than waiting out the byte timeout after every one. Text (for 'baud') ends
+// at its newline. Anything else ends at a BYTE_TIMEOUT_US gap, as before.
 cystatus CyBtldrCommRead (uint8* buffer, uint16 size, uint16* count, uint8 timeOut) {
 	int timeoutUs = timeOut * 10000;
+	uint32 expected = size;
 	cystatus status = CYRET_TIMEOUT;
 	
 	*count = 0;
-	while(*count < size && timeoutUs >= 0) {
-		if(UART_SpiUartGetRxBufferSize() > 0) {
-			buffer[(*count)++] = UART_UartGetByte();
-			// Switch to byte-to-byte timeout and mark as success
-			timeoutUs = 10000; //10mS
-			status = CYRET_SUCCESS;
-		} else {
-			CyDelayUs(10);
-			timeoutUs -= 10;
+	while(*count < expected) {
+		int c = get_byte(timeoutUs);
+		if(c < 0)
+			break;
+		buffer[(*count)++] = c;
+		// Switch to byte-to-byte timeout and mark as success
+		timeoutUs = BYTE_TIMEOUT_US;
+		status = CYRET_SUCCESS;
+		
+		if(*count == Bootloader_DATA_ADDR && buffer[0] == Bootloader_SOP) {
+			expected = Bootloader_MIN_PKT_SIZE + (buffer[Bootloader_SIZE_ADDR] | (buffer[Bootloader_SIZE_ADDR + 1] << 8));
+			if(expected > size)
+				expected = size;
+		} else if(buffer[0] != Bootloader_SOP && c == '\n') {
+			break;
+		}
+	}
+	
+	// Bootloader packets start with 0x01, so text can't be mistaken for one
+	if(status == CYRET_SUCCESS && *count > 5 && *count < 24 && *count < size && memcmp(buffer, "baud ", 5) == 0) {
+		buffer[*count] = '\0';
+		negotiate_baud((const char *)buffer);
+		*count = 0;
+		status = CYRET_TIMEOUT;
+	} else if(status == CYRET_SUCCESS && *count == expected && buffer[0] == Bootloader_SOP) {
+		if(!extra_command(buffer, count, size)) {
+			*count = 0;
+			status = CYRET_TIMEOUT;
+		} else if((buffer[Bootloader_CMD_ADDR] == Bootloader_COMMAND_PROGRAM
+		           || buffer[Bootloader_CMD_ADDR] == Bootloader_COMMAND_ERASE) && image_marked()) {
+			image_mark(0);
 		}
 	}
 	
@@ -48,8 +352,13 @@ void main()
 	
 	CyDelay(1);
     if(Button_Read()) {
-        // No button press, run app
+        // No button press, run app, straight away once it's been checked
+		if(!image_marked() && image_valid())
+			image_mark(Bootloader_MD_BTLDB_IS_VERIFIED);
 		Bootloader_SET_RUN_TYPE(Bootloader_START_APP);
+		if(image_marked())
+			CySoftwareReset();
+		// Otherwise Bootloader_Start finds it bad too, and waits for an update
     } else {
         // Button is being pressed; start bootloader
 		Bootloader_SET_RUN_TYPE(Bootloader_START_BTLDR);
@@ -14,6 +14,7 @@
 #include "`$INSTANCE_NAME`_SPI.h"
 #include "`$INSTANCE_NAME`_SS_Reg.h"
 #include <stdbool.h>
+#include <string.h>
 #include <CyLib.h>
 
 #define COMMAND_SET_MODE			0x38
@@ -30,6 +31,7 @@
 #define COMMAND_OSCILLATOR_ON		0xAB
 #define COMMAND_SET_PARTIAL_DISPLAY 0x48
 #define COMMAND_SET_COM0			0x44
+#define COMMAND_SET_DISPLAY_LINE	0x40 // Then the RAM line shown at the top
 #define COMMAND_SELECT_ADC_NORMAL	0xA0
 #define COMMAND_SET_COM_SCAN_DIR_REVERSE 0xC8
 #define COMMAND_EXT_SET_GRAY_LEVEL	0x80
@@ -43,6 +45,12 @@
 #define DEFAULT_CONTRAST_LEVEL		0x20
 #define DEFAULT_COM0				0x12
 
+#if `$INSTANCE_NAME`_USE_PAGE_FLIP
+// Page offsets of the bank on screen and of the one drawn to, 0 or 8. They only
+// differ between BeginFrame and ShowFrame.
+static uint8 shown_bank, draw_bank;
+#endif
+
 static void begin_transaction() {
 	`$INSTANCE_NAME``[SS_Reg]`Write(0);
 }
@@ -78,11 +86,23 @@ static void configure_grays() {
 	}, 2);
 }
 
-static void display_setup() {
+// The LCD's supplies come up in stages, each needing time to settle before the
+// next. StartPowerUp and ContinuePowerUp return how many milliseconds to wait
+// before calling ContinuePowerUp again, or 0 once the display is on, so that a
+// caller can do other work in the meantime.
+static uint8 power_up_stage = 0;
+
+uint8 `$INSTANCE_NAME`_StartPowerUp() {
+	`$INSTANCE_NAME``[SPI]`Start();
+	#if `$INSTANCE_NAME`_USE_PAGE_FLIP
+	shown_bank = draw_bank = 0;
+	#endif
+
 	send_commands((uint8[]) {
 		COMMAND_SET_MODE, MODE_NORMAL, // 68Hz frequency, booster efficiency 2, standard commands
 		COMMAND_OSCILLATOR_ON,
 		COMMAND_SET_COM0, DEFAULT_COM0,
+		COMMAND_SET_DISPLAY_LINE, 0,
 		COMMAND_SELECT_ADC_NORMAL,
 		COMMAND_SET_COM_SCAN_DIR_REVERSE,
 		COMMAND_SELECT_STEPUP | DEFAULT_STEPUP, // 5 x boost
@@ -90,29 +110,60 @@ static void display_setup() {
 		COMMAND_SET_PARTIAL_DISPLAY, 64, // Only use the first 64 lines
 		COMMAND_SELECT_REGULATOR | DEFAULT_REGULATOR_RESISTOR,
 		COMMAND_POWER_CONTROL | 0xC, // VC on
-	}, 13);
+	}, 15);
 
 	`$INSTANCE_NAME`_SetContrast(DEFAULT_CONTRAST_LEVEL);
 	
 	configure_grays();
 
-	CyDelay(200);
+	power_up_stage = 1;
+	return 200;
+}
+
+uint8 `$INSTANCE_NAME`_ContinuePowerUp() {
+	switch(power_up_stage) {
+	case 1:
+		send_commands((uint8[]) {
+			COMMAND_POWER_CONTROL | 0xE, // VC, VR on
+		}, 1);
+		power_up_stage++;
+		return 200;
+	case 2:
+		send_commands((uint8[]) {
+			COMMAND_POWER_CONTROL | 0xF, // VC, VR, VF on
+			COMMAND_DISPLAY_ON | 1, // Display on
+		}, 2);
+		power_up_stage = 0;
+		return 0;
+	default:
+		return 0;
+	}
+}
+
+void `$INSTANCE_NAME`_Start() {
+	for(uint8 ms = `$INSTANCE_NAME`_StartPowerUp(); ms > 0; ms = `$INSTANCE_NAME`_ContinuePowerUp())
+		CyDelay(ms);
+}
+
+// Blanks the panel and turns off the booster, regulator and follower, which
+// draw most of the controller's current. The display RAM keeps its contents
+// and can still be drawn to, so Wake shows whatever is there by then.
+void `$INSTANCE_NAME`_Sleep() {
 	send_commands((uint8[]) {
-		COMMAND_POWER_CONTROL | 0xE, // VC, VR on
-	}, 1);
-	
-	CyDelay(200);
+		COMMAND_DISPLAY_ON | 0, // Display off
+		COMMAND_POWER_CONTROL | 0x0, // VC, VR, VF off
+	}, 2);
+}
+
+// Unlike a power up, the supplies come back together and it doesn't wait for
+// them: the panel shows at once and reaches full contrast as they settle.
+void `$INSTANCE_NAME`_Wake() {
 	send_commands((uint8[]) {
 		COMMAND_POWER_CONTROL | 0xF, // VC, VR, VF on
 		COMMAND_DISPLAY_ON | 1, // Display on
 	}, 2);
 }
 
-void `$INSTANCE_NAME`_Start() {
-	`$INSTANCE_NAME``[SPI]`Start();
-	display_setup();
-}
-
 void write_pixels_begin(uint8 len) {
 	begin_transaction();
 	`$INSTANCE_NAME``[SPI]`PutArray((uint8[]){COMMAND_WRITE_DATA, len - 1}, 2);
@@ -122,6 +173,7 @@ void write_pixels_end() {
 	end_transaction();
 }
 
+// Writes raw 4 byte grayscale columns straight to the LCD at the cursor
 void `$INSTANCE_NAME`_WritePixels(uint8 data[], int len) {
 	for(int i = 0; i < len; i += 255) {
 		int write_size = len - i;
@@ -134,6 +186,9 @@ void `$INSTANCE_NAME`_WritePixels(uint8 data[], int len) {
 }
 
 void `$INSTANCE_NAME`_SetCursorPosition(uint8 page, uint8 col) {
+	#if `$INSTANCE_NAME`_USE_PAGE_FLIP
+	page += draw_bank;
+	#endif
 	send_commands((uint8[]) {
 		COMMAND_SET_PAGE | (page & 0xF),
 		COMMAND_SET_COLUMN_MSB | ((col >> 4) & 0xF),
@@ -147,24 +202,152 @@ void `$INSTANCE_NAME`_SetContrast(uint8 contrast_level) {
 	}, 2);
 }
 
-static void draw_text_slice(char c, uint8 row, uint8 inverse) {
-	write_pixels_begin(FONT_GLYPH_COLUMNS * 4);
-	for(int8 i = 0; i < FONT_GLYPH_COLUMNS; i++) {
-		char col = glyphs[c - FONT_GLYPH_OFFSET][row][i];
-		if(inverse)
-			col = ~col;
-		uint8 pixels[4] = {col, col, col, col};
-		`$INSTANCE_NAME``[SPI]`PutArray(pixels, 4);
+#if `$INSTANCE_NAME`_USE_PAGE_FLIP
+// The partial display shows 64 of the controller's 128 lines of display RAM,
+// so pages 8-15 make a second screen. Moving the display start line between
+// the two swaps them in one command, with no wipe as rows are redrawn.
+
+// Sends the following drawing to the hidden bank, out of sight until
+// ShowFrame. The bank still holds whatever was last there, so the frame should
+// cover the whole screen, starting with ClearAll or a full-screen Clear.
+void `$INSTANCE_NAME`_BeginFrame() {
+	draw_bank = shown_bank ^ `$INSTANCE_NAME`_PAGES;
+}
+
+// Brings a frame begun with BeginFrame into view; otherwise does nothing.
+// Drawing after it goes straight to the screen again.
+void `$INSTANCE_NAME`_ShowFrame() {
+	if(draw_bank == shown_bank)
+		return;
+	shown_bank = draw_bank;
+	send_commands((uint8[]) {
+		COMMAND_SET_DISPLAY_LINE, shown_bank * 8
+	}, 2);
+}
+#else
+void `$INSTANCE_NAME`_BeginFrame() {
+}
+
+void `$INSTANCE_NAME`_ShowFrame() {
+}
+#endif
+
+// Monochrome drawing goes out in runs: the caller says up front how many
+// columns it will draw, and they're sent in as few write transactions as the
+// 255 byte limit allows (63 columns each), rather than one per glyph or column.
+static uint16 run_remaining = 0; // Columns not yet covered by a transaction
+static uint8 run_chunk = 0; // Columns left in the open transaction
+
+static void run_begin(uint16 columns) {
+	run_remaining = columns;
+	run_chunk = 0;
+}
+
+// Draws count columns of planes bytes each (1, 2 or 4). Columns are read from
+// cols, stepping by step bytes each time (0 repeats the first), and inverted if
+// xor is 0xFF. Up to a glyph's worth is expanded to the controller's 4 bit
+// planes per column, repeating planes as needed, and sent as a single burst.
+static void run_columns(const char *cols, uint8 count, uint8 step, uint8 planes, uint8 xor) {
+	uint8 burst[FONT_GLYPH_COLUMNS * 4];
+	while(count > 0) {
+		if(run_chunk == 0) {
+			if(run_remaining == 0)
+				return;
+			run_chunk = (run_remaining > 63)?63:run_remaining;
+			run_remaining -= run_chunk;
+			write_pixels_begin(run_chunk * 4);
+		}
+
+		uint8 n = count;
+		if(n > run_chunk)
+			n = run_chunk;
+		if(n > FONT_GLYPH_COLUMNS)
+			n = FONT_GLYPH_COLUMNS;
+		for(uint8 i = 0; i < n; i++, cols += step) {
+			for(uint8 plane = 0; plane < 4; plane++)
+				burst[i * 4 + plane] = cols[plane & (planes - 1)] ^ xor;
+		}
+		`$INSTANCE_NAME``[SPI]`PutArray(burst, n * 4);
+
+		count -= n;
+		run_chunk -= n;
+		if(run_chunk == 0)
+			write_pixels_end();
+	}
+}
+
+static void run_end() {
+	// Only if the caller drew fewer columns than it promised
+	if(run_chunk > 0)
+		write_pixels_end();
+	run_remaining = 0;
+	run_chunk = 0;
+}
+
+#if FONT_GLYPH_RLE
+#define GLYPH_ROW_BYTES (FONT_GLYPH_COLUMNS * FONT_GLYPH_PLANES)
+
+// Decodes one row of len bytes of a run-length encoded glyph or big character
+// from src. Each row is encoded on its own, so earlier rows are skipped by
+// reading just their control bytes, skip bytes' worth. This is cheap next to
+// sending the row, so there's no cache of decoded glyphs.
+static void decode_row(const unsigned char *src, uint16 skip, uint8 len, char *out) {
+	while(skip > 0) {
+		uint8 control = *src++;
+		if(control & 0x80) {
+			skip -= (control & 0x7F) + 2;
+			src++;
+		} else {
+			skip -= control + 1;
+			src += control + 1;
+		}
+	}
+
+	while(len > 0) {
+		uint8 control = *src++, count;
+		if(control & 0x80) {
+			count = (control & 0x7F) + 2;
+			memset(out, *src++, count);
+		} else {
+			count = control + 1;
+			memcpy(out, src, count);
+			src += count;
+		}
+		out += count;
+		len -= count;
 	}
-	write_pixels_end();
+}
+#endif
+
+static void draw_text_slice(char c, uint8 row, uint8 inverse) {
+	#if FONT_GLYPH_RLE
+	char cols[GLYPH_ROW_BYTES];
+	decode_row(&glyph_data[glyph_offsets[c - FONT_GLYPH_OFFSET]], row * GLYPH_ROW_BYTES, GLYPH_ROW_BYTES, cols);
+	run_columns(cols, FONT_GLYPH_COLUMNS, FONT_GLYPH_PLANES, FONT_GLYPH_PLANES, inverse?0xFF:0);
+	#else
+	run_columns(glyphs[c - FONT_GLYPH_OFFSET][row], FONT_GLYPH_COLUMNS, FONT_GLYPH_PLANES, FONT_GLYPH_PLANES, inverse?0xFF:0);
+	#endif
+}
+
+// Fills count columns from the cursor with value, in as few transactions as possible
+void `$INSTANCE_NAME`_Fill(uint8 value, uint8 count) {
+	run_begin(count);
+	run_columns((const char *)&value, count, 0, 1, 0);
+	run_end();
+}
+
+// Draws count monochrome columns from the cursor, one byte each, such as text
+// pre-rendered by assetpacker.py, in as few transactions as possible
+void `$INSTANCE_NAME`_DrawColumns(const uint8 cols[], uint8 count, uint8 inverse) {
+	run_begin(count);
+	run_columns((const char *)cols, count, 1, 1, inverse?0xFF:0);
+	run_end();
 }
 
 void `$INSTANCE_NAME`_Clear(uint8 start_row, uint8 start_col, uint8 end_row, uint8 end_col, uint8 value) {
 	for(uint8 row = start_row; row < end_row; row++) {
 		`$INSTANCE_NAME`_SetCursorPosition(row, start_col);
-		for(uint8 col = start_col; col < end_col; col++) {
-			`$INSTANCE_NAME`_WritePixels((uint8[]){value, value, value, value}, 4);
-		}
+		`$INSTANCE_NAME`_Fill(value, end_col - start_col);
 	}
 }
 
@@ -175,39 +358,62 @@ void `$INSTANCE_NAME`_ClearAll() {
 void `$INSTANCE_NAME`_DrawText(uint8 start_page, uint8 start_col, const char *text, uint8 inverse) {
 	for(uint8 row = 0; row < 2; row++) {
 		`$INSTANCE_NAME`_SetCursorPosition(start_page + row, start_col);
+		run_begin(strlen(text) * FONT_GLYPH_COLUMNS);
 		for(char *c = text; *c != '\0'; c++) {
 			draw_text_slice(*c, row, inverse);
 		}
+		run_end();
 	}
 }
 
+// Which big character c is, or -1 for one drawn with the ordinary font
+static int8 big_index(char c) {
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	return (c == '.')?FONT_BIG_PERIOD:-1;
+}
+
+// How many columns DrawBigNumbers draws for c. Other characters than big ones
+// are text glyphs, drawn on the bottom glyph row only.
+uint8 `$INSTANCE_NAME`_BigNumberWidth(char c) {
+	int8 index = big_index(c);
+	return (index < 0)?FONT_GLYPH_COLUMNS:big_widths[index];
+}
+
+// Sends one page of a big character, its columns contiguous, in one go
+static void draw_big_slice(uint8 index, uint8 page) {
+	uint8 len = big_widths[index] * FONT_GLYPH_PLANES;
+	#if FONT_GLYPH_RLE
+	char cols[FONT_BIG_COLUMNS * FONT_GLYPH_PLANES];
+	decode_row(&big_data[big_offsets[index]], page * len, len, cols);
+	#else
+	const char *cols = (const char *)&big_data[big_offsets[index] + page * len];
+	#endif
+	run_columns(cols, big_widths[index], FONT_GLYPH_PLANES, FONT_GLYPH_PLANES, 0);
+}
+
 void `$INSTANCE_NAME`_DrawBigNumbers(uint8 start_page, uint8 start_col, const char *nums) {
-	// Big numbers are 3 glyphs tall
-	for(uint8 vglyph = 0; vglyph < 3; vglyph++) {
-		for(uint8 row = 0; row < 2; row++) {
-			`$INSTANCE_NAME`_SetCursorPosition(start_page + vglyph * 2 + row, start_col);
-			// Big numbers are 3 glyphs wide
-			for(char *c = nums; *c != '\0'; c++) {
-				for(uint8 hglyph = 0; hglyph < 3; hglyph++) {
-					if(*c >= '0' && *c <= '9') {
-						// Determine glyph based on provided number, which glyph we're drawing vertically,
-						// and which glyph we're drawing horizontally
-						uint8 glyphnum = FONT_BIGDIGIT_OFFSET
-										 + (*c - '0') * 3
-										 + FONT_BIGDIGIT_ROW_WIDTH * vglyph
-										 + hglyph;
-						draw_text_slice(glyphnum, row, 0);
-					} else  {
-						hglyph = 2; // Other glyphs are only 1 glyph wide
-						if(vglyph == 2) {
-							draw_text_slice((*c == '.')?GLYPH_CHAR(FONT_GLYPH_BIGPERIOD):*c, row, 0);
-						} else if(*c == '.') {
-							draw_text_slice(' ', row, 0);
-						}
-					}
-				}
+	for(uint8 page = 0; page < FONT_BIG_PAGES; page++) {
+		// Text glyphs fill the bottom 2 pages; above them this wraps past
+		// FONT_GLYPH_PAGES
+		uint8 text_row = page - (FONT_BIG_PAGES - FONT_GLYPH_PAGES);
+		uint16 columns = 0;
+		for(const char *c = nums; *c != '\0'; c++) {
+			if(big_index(*c) >= 0 || text_row < FONT_GLYPH_PAGES)
+				columns += `$INSTANCE_NAME`_BigNumberWidth(*c);
+		}
+
+		`$INSTANCE_NAME`_SetCursorPosition(start_page + page, start_col);
+		run_begin(columns);
+		for(const char *c = nums; *c != '\0'; c++) {
+			int8 index = big_index(*c);
+			if(index >= 0) {
+				draw_big_slice(index, page);
+			} else if(text_row < FONT_GLYPH_PAGES) {
+				draw_text_slice(*c, text_row, 0);
 			}
 		}
+		run_end();
 	}
 }
 
@@ -11,13 +11,32 @@
 */
 #include <CyLib.h>
 
+// Set to 0 to keep all drawing on the 64 lines that show. Otherwise the next 64
+// lines of display RAM are a hidden bank: a frame drawn between BeginFrame()
+// and ShowFrame() goes there and appears all at once.
+#ifndef `$INSTANCE_NAME`_USE_PAGE_FLIP
+#define `$INSTANCE_NAME`_USE_PAGE_FLIP 1
+#endif
+
+#define `$INSTANCE_NAME`_PAGES 8
+#define `$INSTANCE_NAME`_COLUMNS 160
+
 void `$INSTANCE_NAME`_Start();
+uint8 `$INSTANCE_NAME`_StartPowerUp();
+uint8 `$INSTANCE_NAME`_ContinuePowerUp();
+void `$INSTANCE_NAME`_Sleep();
+void `$INSTANCE_NAME`_Wake();
 void `$INSTANCE_NAME`_WritePixels(uint8 data[], int len);
 void `$INSTANCE_NAME`_SetCursorPosition(uint8 page, uint8 col);
 void `$INSTANCE_NAME`_SetContrast(uint8 contrast_level);
 void `$INSTANCE_NAME`_DrawText(uint8 start_page, uint8 start_col, const char *text, uint8 inverse);
 void `$INSTANCE_NAME`_DrawBigNumbers(uint8 start_page, uint8 start_col, const char *nums);
+uint8 `$INSTANCE_NAME`_BigNumberWidth(char c);
 void `$INSTANCE_NAME`_ClearAll();
 void `$INSTANCE_NAME`_Clear(uint8 start_row, uint8 start_col, uint8 end_row, uint8 end_col, uint8 value);
+void `$INSTANCE_NAME`_Fill(uint8 value, uint8 count);
+void `$INSTANCE_NAME`_DrawColumns(const uint8 cols[], uint8 count, uint8 inverse);
+void `$INSTANCE_NAME`_BeginFrame();
+void `$INSTANCE_NAME`_ShowFrame();
 
 /* [] END OF FILE */
@@ -1,770 +1,255 @@
-const char glyphs[192][2][12] = {
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0xFE, 0xFE, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x33, 0x33, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x3E, 0x3E, 0x0, 0x0, 0x3E, 0x3E, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x30, 0x30, 0xF0, 0x7E, 0x37, 0xB0, 0xF8, 0x3F, 0x31, 0x30, 0x0},
-        {0x3, 0x23, 0x3F, 0x7, 0x3, 0x33, 0x3F, 0x3, 0x3, 0x3, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x70, 0xF8, 0x8C, 0x8C, 0xFF, 0xC, 0xC, 0x18, 0x0, 0x0, 0x0},
-        {0x0, 0x18, 0x30, 0x30, 0x30, 0xFF, 0x31, 0x31, 0x1F, 0xE, 0x0, 0x0},
-    },
-    {
-        {0x3C, 0x7E, 0x42, 0x42, 0xFE, 0xBC, 0x80, 0x40, 0x40, 0x40, 0x0, 0x0},
-        {0x0, 0x1, 0x1, 0x1, 0x0, 0x1E, 0x3F, 0x21, 0x21, 0x3F, 0x1E, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x80, 0xDC, 0x7E, 0xE6, 0xC6, 0x6, 0x6, 0x80, 0x80, 0x0},
-        {0x0, 0xF, 0x1F, 0x38, 0x30, 0x31, 0x33, 0xF, 0x3E, 0x37, 0x23, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x3E, 0x3E, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xE0, 0xFC, 0xF, 0x1, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x7, 0x3F, 0xF0, 0x80, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x1, 0xF, 0xFC, 0xE0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x80, 0xF0, 0x3F, 0x7, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x84, 0x48, 0x30, 0xFE, 0x30, 0x48, 0x84, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x80, 0x80, 0x80, 0x80, 0xF8, 0xF8, 0x80, 0x80, 0x80, 0x80, 0x0},
-        {0x0, 0x1, 0x1, 0x1, 0x1, 0x1F, 0x1F, 0x1, 0x1, 0x1, 0x1, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0xC0, 0x78, 0x38, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x3, 0x3, 0x3, 0x3, 0x3, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x38, 0x38, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0xC0, 0xF0, 0x3C, 0xE, 0x2, 0x0, 0x0},
-        {0x0, 0x80, 0xE0, 0x78, 0x1F, 0x7, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xFC, 0xE, 0x6, 0xC6, 0xC6, 0xE, 0xFC, 0xF0, 0x0, 0x0},
-        {0x0, 0x7, 0x1F, 0x38, 0x30, 0x30, 0x30, 0x38, 0x1F, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0xC, 0xC, 0x6, 0xFE, 0xFE, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x30, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xC, 0x6, 0x6, 0x6, 0x6, 0x6, 0xCE, 0xFC, 0x78, 0x0, 0x0},
-        {0x0, 0x30, 0x38, 0x3C, 0x36, 0x37, 0x33, 0x31, 0x30, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xC, 0x6, 0xC6, 0xC6, 0xC6, 0xC6, 0xEE, 0xFC, 0x38, 0x0, 0x0},
-        {0x0, 0x18, 0x30, 0x30, 0x30, 0x30, 0x30, 0x39, 0x1F, 0xF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x80, 0xE0, 0x30, 0xC, 0xFE, 0xFE, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x7, 0x7, 0x6, 0x6, 0x6, 0x3F, 0x3F, 0x6, 0x6, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0xFE, 0x7E, 0x66, 0x66, 0x66, 0xE6, 0xC6, 0x80, 0x0, 0x0},
-        {0x0, 0x18, 0x30, 0x30, 0x30, 0x30, 0x30, 0x38, 0x1F, 0xF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xFC, 0x9C, 0xCE, 0xC6, 0xC6, 0xC6, 0x8C, 0x0, 0x0, 0x0},
-        {0x0, 0x7, 0x1F, 0x39, 0x30, 0x30, 0x30, 0x39, 0x1F, 0xF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x6, 0x6, 0x6, 0x6, 0x6, 0xE6, 0xFE, 0x3E, 0x6, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x20, 0x3C, 0x1F, 0x7, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x38, 0xFC, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0xFC, 0x38, 0x0, 0x0},
-        {0x0, 0xF, 0x1F, 0x39, 0x30, 0x30, 0x30, 0x39, 0x1F, 0xF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x78, 0xFC, 0xCE, 0x86, 0x86, 0x86, 0xCE, 0xFC, 0xF0, 0x0, 0x0},
-        {0x0, 0x0, 0x18, 0x31, 0x31, 0x31, 0x39, 0x1C, 0xF, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xE0, 0xE0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x38, 0x38, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xE0, 0xE0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0xC0, 0x78, 0x38, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x80, 0x80, 0xC0, 0x40, 0x60, 0x60, 0x20, 0x30, 0x0, 0x0},
-        {0x0, 0x1, 0x3, 0x2, 0x6, 0x4, 0xC, 0xC, 0x8, 0x18, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x0, 0x0},
-        {0x0, 0x6, 0x6, 0x6, 0x6, 0x6, 0x6, 0x6, 0x6, 0x6, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x30, 0x20, 0x60, 0x60, 0x40, 0xC0, 0x80, 0x80, 0x0, 0x0, 0x0},
-        {0x0, 0x18, 0x8, 0xC, 0xC, 0x4, 0x6, 0x2, 0x3, 0x1, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0xC, 0x6, 0x86, 0xC6, 0xE6, 0x7E, 0x3C, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x37, 0x37, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xFC, 0xE, 0x3, 0xF1, 0xF9, 0xB, 0xFE, 0xFC, 0x0, 0x0},
-        {0x0, 0x7, 0x1F, 0x38, 0x60, 0x43, 0x47, 0x44, 0x7, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0xE0, 0xFE, 0x1E, 0xFE, 0xE0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x30, 0x3E, 0xF, 0x7, 0x6, 0x7, 0xF, 0x3E, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0xFC, 0x38, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x39, 0x1F, 0xF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xF8, 0x1C, 0xE, 0x6, 0x6, 0x6, 0x6, 0xC, 0x0, 0x0},
-        {0x0, 0x7, 0xF, 0x1C, 0x38, 0x30, 0x30, 0x30, 0x30, 0x18, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0x6, 0x6, 0x6, 0xE, 0x1C, 0xF8, 0xF0, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x38, 0x1C, 0xF, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0xC6, 0x6, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xF8, 0x1C, 0xE, 0x6, 0xC6, 0xC6, 0xC6, 0xCC, 0x0, 0x0},
-        {0x0, 0x7, 0xF, 0x1C, 0x30, 0x30, 0x30, 0x30, 0x1F, 0x1F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xFE, 0xFE, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x0, 0x0, 0x0, 0x0, 0x0, 0x3F, 0x3F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x6, 0x6, 0x6, 0xFE, 0xFE, 0x6, 0x6, 0x6, 0x0, 0x0},
-        {0x0, 0x0, 0x30, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x6, 0x6, 0x6, 0xFE, 0xFE, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x18, 0x30, 0x30, 0x30, 0x30, 0x1F, 0xF, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0xC0, 0xE0, 0xF0, 0x18, 0xC, 0x6, 0x2, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x0, 0x0, 0x3, 0x7, 0x1E, 0x38, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0x1E, 0xF0, 0x80, 0xF0, 0x1E, 0xFE, 0xFE, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x0, 0x0, 0x1, 0x0, 0x0, 0x3F, 0x3F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0xE, 0x78, 0xC0, 0x0, 0x0, 0xFE, 0xFE, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x0, 0x0, 0x1, 0xF, 0x38, 0x3F, 0x3F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xFC, 0xE, 0x6, 0x6, 0x6, 0xE, 0xFC, 0xF0, 0x0, 0x0},
-        {0x0, 0x7, 0x1F, 0x38, 0x30, 0x30, 0x30, 0x38, 0x1F, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0x86, 0x86, 0x86, 0x86, 0xCE, 0xFC, 0x78, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x1, 0x1, 0x1, 0x1, 0x1, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xFC, 0xE, 0x6, 0x6, 0x6, 0xE, 0xFC, 0xF0, 0x0, 0x0},
-        {0x0, 0x7, 0x1F, 0x38, 0x30, 0x30, 0x70, 0xF8, 0xDF, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0x86, 0x86, 0x86, 0x86, 0xCE, 0xFC, 0x78, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x1, 0x1, 0x1, 0x1, 0x7, 0x1E, 0x3C, 0x20, 0x0},
-    },
-    {
-        {0x0, 0x38, 0x7C, 0xCE, 0xC6, 0xC6, 0xC6, 0x86, 0x8C, 0x0, 0x0, 0x0},
-        {0x0, 0x18, 0x30, 0x30, 0x30, 0x30, 0x30, 0x39, 0x1F, 0xF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x6, 0x6, 0x6, 0x6, 0xFE, 0xFE, 0x6, 0x6, 0x6, 0x6, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x3F, 0x3F, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFE, 0xFE, 0x0, 0x0, 0x0, 0x0, 0x0, 0xFE, 0xFE, 0x0, 0x0},
-        {0x0, 0xF, 0x1F, 0x38, 0x30, 0x30, 0x30, 0x38, 0x1F, 0xF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x6, 0x7E, 0xF8, 0xC0, 0x0, 0xC0, 0xF8, 0x7E, 0x6, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x3, 0x3F, 0x3C, 0x3F, 0x3, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0xE, 0xFE, 0xF0, 0x0, 0xE0, 0x60, 0xE0, 0x0, 0xF0, 0xFE, 0xE, 0x0},
-        {0x0, 0x7, 0x3F, 0x3C, 0x7, 0x0, 0x7, 0x3C, 0x3F, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x2, 0xE, 0x1E, 0xF8, 0xE0, 0xF8, 0x1E, 0x6, 0x2, 0x0, 0x0},
-        {0x0, 0x20, 0x38, 0x3E, 0xF, 0x3, 0xF, 0x3E, 0x38, 0x20, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x2, 0xE, 0x1E, 0x78, 0xE0, 0xE0, 0x78, 0x1E, 0xE, 0x2, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x3F, 0x3F, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x6, 0x6, 0x6, 0x86, 0xC6, 0xF6, 0x3E, 0x1E, 0x6, 0x0, 0x0},
-        {0x0, 0x30, 0x3C, 0x3E, 0x37, 0x31, 0x30, 0x30, 0x30, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0x3, 0x3, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0xC0, 0xC0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x2, 0xE, 0x3C, 0xF0, 0xC0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x1, 0x7, 0x1F, 0x78, 0xE0, 0x80, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x3, 0x3, 0xFF, 0xFF, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0xC0, 0xC0, 0xFF, 0xFF, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x20, 0x30, 0x18, 0xC, 0x6, 0x6, 0xC, 0x18, 0x30, 0x20, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x1, 0x3, 0x6, 0x4, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x60, 0x30, 0x30, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x0, 0x0},
-        {0x0, 0x1E, 0x3E, 0x33, 0x33, 0x33, 0x33, 0x1B, 0x3F, 0x3F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFF, 0xFF, 0x60, 0x30, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x18, 0x30, 0x30, 0x30, 0x38, 0x1F, 0xF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x80, 0xE0, 0x60, 0x30, 0x30, 0x30, 0x30, 0x60, 0x0, 0x0, 0x0},
-        {0x0, 0x7, 0x1F, 0x18, 0x30, 0x30, 0x30, 0x30, 0x18, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xC0, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x60, 0xFF, 0xFF, 0x0, 0x0},
-        {0x0, 0xF, 0x1F, 0x38, 0x30, 0x30, 0x30, 0x18, 0x3F, 0x3F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x80, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x0, 0x0},
-        {0x0, 0x7, 0x1F, 0x1B, 0x33, 0x33, 0x33, 0x33, 0x33, 0x1B, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x30, 0x30, 0x30, 0xFE, 0xFF, 0x33, 0x33, 0x33, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x3F, 0x3F, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xF8, 0x1C, 0xC, 0xC, 0xC, 0x18, 0xFC, 0xFC, 0x0, 0x0},
-        {0x0, 0x3, 0x67, 0xCE, 0xCC, 0xCC, 0xCC, 0xE6, 0x7F, 0x3F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFF, 0xFF, 0x60, 0x20, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x0, 0x0, 0x0, 0x0, 0x0, 0x3F, 0x3F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x30, 0x30, 0x30, 0xF3, 0xF3, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x30, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x30, 0x30, 0x30, 0xF3, 0xF3, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x30, 0x30, 0x30, 0x30, 0x1F, 0xF, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xFF, 0xFF, 0x0, 0x80, 0xC0, 0xE0, 0x70, 0x30, 0x10, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x3, 0x3, 0x7, 0x1E, 0x38, 0x30, 0x20, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x3, 0x3, 0x3, 0xFF, 0xFF, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0xF, 0x3F, 0x30, 0x30, 0x30, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xF0, 0x20, 0x30, 0xF0, 0xE0, 0x30, 0x30, 0xF0, 0xE0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x0, 0x0, 0x3F, 0x3F, 0x0, 0x0, 0x3F, 0x3F, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xF0, 0x60, 0x20, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x0, 0x0},
-        {0x0, 0x3F, 0x3F, 0x0, 0x0, 0x0, 0x0, 0x0, 0x3F, 0x3F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xC0, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x0, 0x0},
-        {0x0, 0xF, 0x1F, 0x38, 0x30, 0x30, 0x30, 0x38, 0x1F, 0xF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xF0, 0x60, 0x30, 0x30, 0x30, 0x70, 0xE0, 0xC0, 0x0, 0x0},
-        {0x0, 0xFF, 0xFF, 0xC, 0x18, 0x18, 0x18, 0x1C, 0xF, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xC0, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x60, 0xF0, 0xF0, 0x0, 0x0},
-        {0x0, 0x7, 0xF, 0x1C, 0x18, 0x18, 0x18, 0xC, 0xFF, 0xFF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0xF0, 0xF0, 0x40, 0x30, 0x30, 0x30, 0x60, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x3F, 0x3F, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xE0, 0xE0, 0xB0, 0xB0, 0xB0, 0x30, 0x30, 0x30, 0x60, 0x0, 0x0},
-        {0x0, 0x18, 0x31, 0x31, 0x31, 0x31, 0x33, 0x33, 0x1F, 0x1E, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x30, 0x30, 0x30, 0xFE, 0xFE, 0x30, 0x30, 0x30, 0x30, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x1F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF0, 0xF0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xF0, 0xF0, 0x0, 0x0},
-        {0x0, 0xF, 0x1F, 0x38, 0x30, 0x30, 0x10, 0x18, 0x3F, 0x3F, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x10, 0xF0, 0xE0, 0x0, 0x0, 0x0, 0xE0, 0xF0, 0x10, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x7, 0x3F, 0x38, 0x3F, 0x7, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x30, 0xF0, 0xC0, 0x0, 0x0, 0x80, 0x0, 0x0, 0xC0, 0xF0, 0x30, 0x0},
-        {0x0, 0x3, 0x3F, 0x3C, 0xF, 0x1, 0xF, 0x3C, 0x3F, 0x3, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x10, 0x30, 0x70, 0xE0, 0x80, 0xE0, 0x70, 0x30, 0x10, 0x0, 0x0},
-        {0x0, 0x20, 0x30, 0x3C, 0xF, 0x7, 0xF, 0x3C, 0x30, 0x20, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x10, 0xF0, 0xE0, 0x80, 0x0, 0x0, 0xE0, 0xF0, 0x10, 0x0, 0x0},
-        {0x0, 0x0, 0xC0, 0xC3, 0xEF, 0x7C, 0x3F, 0x7, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x30, 0x30, 0x30, 0x30, 0xB0, 0xF0, 0xF0, 0x70, 0x30, 0x0, 0x0},
-        {0x0, 0x30, 0x38, 0x3C, 0x3F, 0x33, 0x31, 0x30, 0x30, 0x30, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x80, 0x80, 0x80, 0xFE, 0x7F, 0x3, 0x3, 0x3, 0x0, 0x0},
-        {0x0, 0x0, 0x1, 0x1, 0x3, 0x7F, 0xFE, 0xC0, 0xC0, 0xC0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x3, 0x3, 0x3, 0x7F, 0xFE, 0x80, 0x80, 0x80, 0x0, 0x0},
-        {0x0, 0x0, 0xC0, 0xC0, 0xC0, 0xFE, 0x7F, 0x3, 0x1, 0x1, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x80, 0x80, 0x80, 0x80, 0x0, 0x0, 0x0, 0x80, 0x0, 0x0},
-        {0x0, 0x3, 0x1, 0x1, 0x1, 0x1, 0x3, 0x3, 0x3, 0x1, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xF8, 0x80, 0xF8, 0x84, 0xF0, 0xF0, 0x84, 0xF8, 0x80, 0xF8, 0x0},
-        {0xE, 0x32, 0x1F, 0x21, 0xF, 0x3F, 0x3F, 0xF, 0x31, 0xE, 0x32, 0xE},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xC0, 0xF0, 0xF8, 0xFC, 0xFC},
-        {0x0, 0x0, 0x0, 0x0, 0x80, 0xFC, 0xFF, 0xFF, 0xFF, 0x7F, 0x7, 0x1},
-    },
-    {
-        {0x7E, 0x3E, 0x3F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x3F, 0x3E, 0x7E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0xFC, 0xFC, 0xF8, 0xF0, 0xC0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x1, 0x7, 0x7F, 0xFF, 0xFF, 0xFF, 0xFC, 0x80, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xF8, 0xF8, 0xFC, 0x7C, 0x7C},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x7C, 0x7C, 0x7E, 0x3E, 0x3E, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xF8, 0xFC, 0xFC, 0x7C, 0x7E, 0x7E, 0x3E, 0x3E},
-        {0x0, 0x0, 0x0, 0x0, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x3F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x3E, 0x3E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x7E, 0xFC, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x7C, 0x7C, 0x3E, 0x3E, 0x3E, 0x3E, 0x1F},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x3E, 0x3E, 0x7E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0xFC, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x81, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x80, 0xE0, 0xF0, 0xFC, 0xFE, 0x3E, 0xFE, 0xFE},
-        {0xE0, 0xF0, 0xFC, 0xFE, 0x3F, 0x1F, 0x7, 0x1, 0x0, 0x0, 0xFF, 0xFF},
-    },
-    {
-        {0xFE, 0xFE, 0xFE, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0xFF, 0xFF, 0xFF, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0x3E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0},
-    },
-    {
-        {0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0xE0, 0xF0, 0xF8, 0xF8},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0xF8, 0xFE, 0xFF, 0xFF, 0x7F, 0xF, 0x3},
-    },
-    {
-        {0xFC, 0x7E, 0x7E, 0x3E, 0x3F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
-        {0x0, 0x0, 0x0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0},
-    },
-    {
-        {0x1F, 0x3E, 0x3E, 0x3E, 0x7C, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xE0, 0xF8},
-    },
-    {
-        {0x3E, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0x7E, 0x1E, 0x0, 0x0, 0x0, 0x0},
-        {0xFE, 0xFF, 0xFF, 0x3F, 0xF, 0x3, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFC, 0x7E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0x81, 0x0},
-    },
-    {
-        {0x3E, 0x3E, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x3E, 0x3E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x7E, 0xFC, 0xFC, 0xF8, 0xF0, 0xE0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x81, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0xE0, 0xF0, 0xF8, 0xFC, 0xFC, 0x7E},
-        {0x0, 0x0, 0x0, 0x0, 0xFC, 0xFF, 0xFF, 0xFF, 0xFF, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x3E, 0x3F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x3F, 0x7E, 0x7E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0xFC, 0xFC, 0xF8, 0xF0, 0xE0, 0x80, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x1, 0x7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFC, 0x80, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xD8, 0xC8, 0xC8, 0xC0, 0xC0, 0xC0, 0xC0},
-        {0x0, 0x1, 0x3, 0x7, 0xF, 0xD, 0x9, 0x9, 0x1, 0x1, 0x1, 0x1},
-    },
-    {
-        {0xC0, 0xC0, 0xC0, 0xC0, 0xC8, 0xC8, 0xD8, 0xF8, 0xF0, 0xE0, 0xC0, 0x80},
-        {0x1, 0x1, 0x1, 0x1, 0x9, 0x9, 0xD, 0xF, 0x7, 0x3, 0x1, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x3F, 0xFF, 0xFF, 0xFF, 0xFF, 0xC0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0xF0, 0xF8, 0xFC, 0xFC, 0xFC, 0xFC, 0xF8, 0xF0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x1, 0x3, 0x3, 0x3, 0x3, 0x1, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0xC0, 0xF0},
-        {0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xF8, 0xFC, 0x7E, 0x7F, 0x3F, 0x1F, 0xF},
-    },
-    {
-        {0xF8, 0xFC, 0xFF, 0xFF, 0x3F, 0x1F, 0x7, 0x1, 0x0, 0x0, 0x0, 0x0},
-        {0x7, 0x3, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xF8},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xFC, 0xFC, 0xFC, 0xFE},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1, 0x1, 0x3},
-    },
-    {
-        {0xDF, 0xDF, 0x8F, 0x8F, 0x7, 0x3, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x3, 0x7, 0x1F, 0xFF, 0xFF, 0xFE, 0xFC, 0xE0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0xE0, 0xF0, 0xFC, 0xFE, 0x7F},
-        {0x0, 0x0, 0x0, 0xF0, 0xFC, 0xFF, 0xFF, 0xFF, 0xEF, 0xE3, 0xE0, 0xE0},
-    },
-    {
-        {0x1F, 0x7, 0x3, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF},
-        {0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xFF, 0xFF},
-    },
-    {
-        {0xFF, 0xFF, 0xFF, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0xFF, 0xFF, 0xFF, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x7F, 0x3F, 0x3F, 0x3F, 0x3F, 0x1E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x3F, 0x3E, 0x3E, 0x7E},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0xFC, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x1, 0x7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFC, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0, 0xF8, 0xFC},
-        {0x0, 0x0, 0x0, 0x0, 0x3F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3, 0x0},
-    },
-    {
-        {0x3E, 0x3F, 0x1F, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0x1F, 0x1F},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x3F, 0x7E, 0xFE, 0xFC, 0xF8, 0xF0, 0xC0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0xE0, 0xFC, 0xFF, 0xFF, 0xFF},
-        {0x0, 0x0, 0x0, 0x80, 0xF0, 0xFC, 0xFF, 0xFF, 0xFF, 0x1F, 0x7, 0x0},
-    },
-    {
-        {0x3F, 0x7, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1, 0x3, 0x87, 0xCF, 0xDF, 0xDE},
-        {0x0, 0x0, 0x0, 0x0, 0xE0, 0xFC, 0xFE, 0xFF, 0xFF, 0x1F, 0x7, 0x3},
-    },
-    {
-        {0xFC, 0xFC, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xFC, 0xFC},
-        {0x1, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1, 0x1},
-    },
-    {
-        {0xDE, 0xDF, 0xCF, 0x87, 0x3, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x3, 0x7, 0x1F, 0xFF, 0xFF, 0xFE, 0xFC, 0xE0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xF, 0x7F, 0xFF, 0xFF, 0xFF, 0xF8, 0xC0, 0x80},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1, 0x3, 0x7, 0xF, 0xF, 0x1F},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0x80},
-        {0x1F, 0x3F, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x1F, 0x1F, 0xF},
-    },
-    {
-        {0xE0, 0xF8, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0, 0x0, 0x0, 0x0},
-        {0x7, 0x3, 0xC1, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xF0, 0xE0, 0xC0, 0x80, 0x0, 0x0},
-        {0x0, 0x7, 0x1, 0x0, 0x7F, 0x7F, 0x7F, 0x0, 0x1, 0x7, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xE0, 0x80, 0x0, 0xFE, 0xFE, 0xFE, 0x0, 0x80, 0xE0, 0x0, 0x0},
-        {0x0, 0x1, 0x3, 0x7, 0xF, 0x1F, 0xF, 0x7, 0x3, 0x1, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x7, 0x1F, 0x7F, 0xFF, 0xFF, 0xFC, 0xF0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1, 0x3, 0x7, 0x7},
-    },
-    {
-        {0xC0, 0x80, 0x80, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0x80, 0xC0},
-        {0xF, 0xF, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0xF, 0xF},
-    },
-    {
-        {0xF0, 0xFC, 0xFF, 0xFF, 0x7F, 0x1F, 0x7, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x7, 0x7, 0x3, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0x80, 0x80, 0x80},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xF, 0xF, 0xF, 0xF},
-    },
-    {
-        {0x80, 0x80, 0x80, 0x80, 0x80, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x80, 0x80},
-        {0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF},
-    },
-    {
-        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE, 0xFF},
-        {0x0, 0x0, 0x0, 0x0, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF},
-    },
-    {
-        {0xBF, 0x9F, 0x8F, 0x87, 0x83, 0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
-        {0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF},
-    },
-    {
-        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0, 0x0, 0x0, 0x0},
-        {0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xE0, 0xC0, 0xC0, 0xC0, 0x80, 0x80, 0x80, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x7, 0x7, 0xF, 0xF, 0xF, 0xF, 0x1F, 0x1F},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0x80, 0xC0},
-        {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0xF, 0xF},
-    },
-    {
-        {0xC0, 0xE0, 0xF8, 0xFF, 0xFF, 0xFF, 0x7F, 0xF, 0x0, 0x0, 0x0, 0x0},
-        {0xF, 0x7, 0x7, 0x3, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0xFF, 0xFF},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xF, 0xF},
-    },
-    {
-        {0xFF, 0xFF, 0xFF, 0x3, 0x3, 0x3, 0x3, 0x3, 0x3, 0x0, 0x0, 0x0},
-        {0xF, 0xF, 0xF, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0xE0, 0xC0, 0xC0, 0x80, 0x80, 0x80, 0x80, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x7, 0xF, 0xF, 0xF, 0xF, 0x1F, 0x1F, 0x1F},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0x80, 0x80, 0xC0},
-        {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0xF, 0xF, 0xF},
-    },
-    {
-        {0xE0, 0xF0, 0xFC, 0xFF, 0xFF, 0x7F, 0x1F, 0x7, 0x0, 0x0, 0x0, 0x0},
-        {0x7, 0x7, 0x3, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x7, 0x3F, 0xFF, 0xFF, 0xFF, 0xFC, 0xF0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1, 0x3, 0x7, 0x7},
-    },
-    {
-        {0xC0, 0xC0, 0x80, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0x80},
-        {0xF, 0xF, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0xF},
-    },
-    {
-        {0xC0, 0xE0, 0xFC, 0xFF, 0xFF, 0xFF, 0x3F, 0x7, 0x0, 0x0, 0x0, 0x0},
-        {0xF, 0x7, 0x7, 0x3, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x8, 0xF},
-    },
-    {
-        {0xC0, 0xF8, 0xFE, 0xFF, 0xFF, 0x7F, 0xF, 0x3, 0x0, 0x0, 0x0, 0x0},
-        {0xF, 0xF, 0xF, 0xF, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x1F, 0x7F, 0xFF, 0xFF, 0xFF, 0xF8, 0xE0, 0xC0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x3, 0x3, 0x7, 0xF, 0xF},
-    },
-    {
-        {0x80, 0x80, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0x80},
-        {0xF, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0xF},
-    },
-    {
-        {0xC0, 0xE0, 0xF8, 0xFF, 0xFF, 0xFF, 0x7F, 0x1F, 0x0, 0x0, 0x0, 0x0},
-        {0xF, 0xF, 0x7, 0x3, 0x3, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xC0, 0x80, 0x80, 0x80, 0x0},
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x7, 0xF, 0xF, 0xF, 0x1F},
-    },
-    {
-        {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x80, 0x80, 0xC0, 0xC0, 0xE0},
-        {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0xF, 0xF, 0xF, 0x7},
-    },
-    {
-        {0xF8, 0xFE, 0xFF, 0xFF, 0x3F, 0xF, 0x3, 0x0, 0x0, 0x0, 0x0, 0x0},
-        {0x3, 0x3, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0x0, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0x0, 0x0, 0x0},
-        {0x0, 0x0, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0x0, 0x0, 0x0},
-    },
-    {
-        {0x0, 0xE0, 0x80, 0x0, 0xFE, 0xFE, 0xFE, 0x0, 0x80, 0xE0, 0x0, 0x0},
-        {0x60, 0x61, 0x63, 0x67, 0x6F, 0x7F, 0x6F, 0x67, 0x63, 0x61, 0x60, 0x0},
-    },
+const unsigned short glyph_offsets[192] = {
+    0, 4, 16, 28, 54, 82, 109, 136, 144, 162, 180, 198, 218, 228, 236, 244,
+    264, 291, 311, 335, 358, 381, 405, 430, 450, 474, 500, 512, 526, 554, 566, 593,
+    611, 637, 660, 683, 707, 733, 749, 765, 789, 809, 829, 847, 875, 889, 917, 945,
+    971, 991, 1018, 1042, 1065, 1081, 1104, 1127, 1153, 1179, 1199, 1223, 1239, 1259, 1275, 1291,
+    1297, 1308, 1332, 1360, 1382, 1408, 1432, 1449, 1475, 1500, 1518, 1535, 1563, 1580, 1609, 1634,
+    1660, 1688, 1714, 1732, 1756, 1775, 1799, 1822, 1850, 1876, 1901, 1926, 1949, 1961, 1984, 2005,
+    2033, 2037, 2041, 2045, 2049, 2053, 2057, 2061, 2065, 2069, 2073, 2077, 2081, 2085, 2089, 2093,
+    2097, 2101, 2105, 2109, 2113, 2117, 2121, 2125, 2129, 2133, 2137, 2141, 2145, 2149, 2153, 2175,
+    2197, 2201, 2205, 2209, 2213, 2217, 2221, 2225, 2229, 2233, 2237, 2241, 2245, 2249, 2253, 2257,
+    2261, 2265, 2269, 2273, 2277, 2281, 2285, 2289, 2293, 2297, 2301, 2305, 2309, 2313, 2317, 2343,
+    2369, 2373, 2377, 2381, 2385, 2389, 2393, 2397, 2401, 2405, 2409, 2413, 2417, 2421, 2425, 2429,
+    2433, 2437, 2441, 2445, 2449, 2453, 2457, 2461, 2465, 2469, 2473, 2477, 2481, 2485, 2489, 2501,
+};
+
+const unsigned char glyph_data[2527] = {
+    0x8A, 0x0, 0x8A, 0x0, 0x83, 0x0, 0x80, 0xFE, 0x83, 0x0, 0x83, 0x0, 0x80, 0x33, 0x83, 0x0,
+    0x81, 0x0, 0x80, 0x3E, 0x80, 0x0, 0x80, 0x3E, 0x81, 0x0, 0x8A, 0x0, 0x0, 0x0, 0x80, 0x30,
+    0x8, 0xF0, 0x7E, 0x37, 0xB0, 0xF8, 0x3F, 0x31, 0x30, 0x0, 0x6, 0x3, 0x23, 0x3F, 0x7, 0x3,
+    0x33, 0x3F, 0x81, 0x3, 0x80, 0x0, 0x2, 0x0, 0x70, 0xF8, 0x80, 0x8C, 0x0, 0xFF, 0x80, 0xC,
+    0x0, 0x18, 0x81, 0x0, 0x1, 0x0, 0x18, 0x81, 0x30, 0x0, 0xFF, 0x80, 0x31, 0x1, 0x1F, 0xE,
+    0x80, 0x0, 0x1, 0x3C, 0x7E, 0x80, 0x42, 0x2, 0xFE, 0xBC, 0x80, 0x81, 0x40, 0x80, 0x0, 0x0,
+    0x0, 0x81, 0x1, 0x2, 0x0, 0x1E, 0x3F, 0x80, 0x21, 0x2, 0x3F, 0x1E, 0x0, 0x80, 0x0, 0x4,
+    0x80, 0xDC, 0x7E, 0xE6, 0xC6, 0x80, 0x6, 0x80, 0x80, 0x0, 0x0, 0xB, 0x0, 0xF, 0x1F, 0x38,
+    0x30, 0x31, 0x33, 0xF, 0x3E, 0x37, 0x23, 0x0, 0x83, 0x0, 0x80, 0x3E, 0x83, 0x0, 0x8A, 0x0,
+    0x82, 0x0, 0x3, 0xE0, 0xFC, 0xF, 0x1, 0x82, 0x0, 0x82, 0x0, 0x3, 0x7, 0x3F, 0xF0, 0x80,
+    0x82, 0x0, 0x81, 0x0, 0x3, 0x1, 0xF, 0xFC, 0xE0, 0x83, 0x0, 0x81, 0x0, 0x3, 0x80, 0xF0,
+    0x3F, 0x7, 0x83, 0x0, 0x80, 0x0, 0x6, 0x84, 0x48, 0x30, 0xFE, 0x30, 0x48, 0x84, 0x81, 0x0,
+    0x83, 0x0, 0x0, 0x1, 0x84, 0x0, 0x0, 0x0, 0x82, 0x80, 0x80, 0xF8, 0x82, 0x80, 0x0, 0x0,
+    0x0, 0x0, 0x82, 0x1, 0x80, 0x1F, 0x82, 0x1, 0x0, 0x0, 0x8A, 0x0, 0x81, 0x0, 0x2, 0xC0,
+    0x78, 0x38, 0x84, 0x0, 0x8A, 0x0, 0x81, 0x0, 0x83, 0x3, 0x82, 0x0, 0x8A, 0x0, 0x82, 0x0,
+    0x80, 0x38, 0x84, 0x0, 0x83, 0x0, 0x4, 0xC0, 0xF0, 0x3C, 0xE, 0x2, 0x80, 0x0, 0x6, 0x0,
+    0x80, 0xE0, 0x78, 0x1F, 0x7, 0x1, 0x83, 0x0, 0x4, 0x0, 0xF0, 0xFC, 0xE, 0x6, 0x80, 0xC6,
+    0x2, 0xE, 0xFC, 0xF0, 0x80, 0x0, 0x3, 0x0, 0x7, 0x1F, 0x38, 0x81, 0x30, 0x2, 0x38, 0x1F,
+    0x7, 0x80, 0x0, 0x80, 0x0, 0x80, 0xC, 0x0, 0x6, 0x80, 0xFE, 0x83, 0x0, 0x80, 0x0, 0x81,
+    0x30, 0x80, 0x3F, 0x81, 0x30, 0x80, 0x0, 0x1, 0x0, 0xC, 0x83, 0x6, 0x2, 0xCE, 0xFC, 0x78,
+    0x80, 0x0, 0x7, 0x0, 0x30, 0x38, 0x3C, 0x36, 0x37, 0x33, 0x31, 0x80, 0x30, 0x80, 0x0, 0x2,
+    0x0, 0xC, 0x6, 0x82, 0xC6, 0x2, 0xEE, 0xFC, 0x38, 0x80, 0x0, 0x1, 0x0, 0x18, 0x83, 0x30,
+    0x2, 0x39, 0x1F, 0xF, 0x80, 0x0, 0x80, 0x0, 0x3, 0x80, 0xE0, 0x30, 0xC, 0x80, 0xFE, 0x82,
+    0x0, 0x0, 0x0, 0x80, 0x7, 0x81, 0x6, 0x80, 0x3F, 0x80, 0x6, 0x80, 0x0, 0x80, 0x0, 0x1,
+    0xFE, 0x7E, 0x81, 0x66, 0x2, 0xE6, 0xC6, 0x80, 0x80, 0x0, 0x1, 0x0, 0x18, 0x83, 0x30, 0x2,
+    0x38, 0x1F, 0xF, 0x80, 0x0, 0x4, 0x0, 0xF0, 0xFC, 0x9C, 0xCE, 0x81, 0xC6, 0x0, 0x8C, 0x81,
+    0x0, 0x3, 0x0, 0x7, 0x1F, 0x39, 0x81, 0x30, 0x2, 0x39, 0x1F, 0xF, 0x80, 0x0, 0x0, 0x0,
+    0x83, 0x6, 0x3, 0xE6, 0xFE, 0x3E, 0x6, 0x80, 0x0, 0x81, 0x0, 0x3, 0x20, 0x3C, 0x1F, 0x7,
+    0x83, 0x0, 0x2, 0x0, 0x38, 0xFC, 0x83, 0xC6, 0x1, 0xFC, 0x38, 0x80, 0x0, 0x3, 0x0, 0xF,
+    0x1F, 0x39, 0x81, 0x30, 0x2, 0x39, 0x1F, 0xF, 0x80, 0x0, 0x3, 0x0, 0x78, 0xFC, 0xCE, 0x81,
+    0x86, 0x2, 0xCE, 0xFC, 0xF0, 0x80, 0x0, 0x80, 0x0, 0x0, 0x18, 0x81, 0x31, 0x3, 0x39, 0x1C,
+    0xF, 0x7, 0x80, 0x0, 0x82, 0x0, 0x80, 0xE0, 0x84, 0x0, 0x82, 0x0, 0x80, 0x38, 0x84, 0x0,
+    0x82, 0x0, 0x80, 0xE0, 0x84, 0x0, 0x81, 0x0, 0x2, 0xC0, 0x78, 0x38, 0x84, 0x0, 0x80, 0x0,
+    0x80, 0x80, 0x1, 0xC0, 0x40, 0x80, 0x60, 0x1, 0x20, 0x30, 0x80, 0x0, 0x5, 0x0, 0x1, 0x3,
+    0x2, 0x6, 0x4, 0x80, 0xC, 0x1, 0x8, 0x18, 0x80, 0x0, 0x0, 0x0, 0x87, 0x60, 0x80, 0x0,
+    0x0, 0x0, 0x87, 0x6, 0x80, 0x0, 0x2, 0x0, 0x30, 0x20, 0x80, 0x60, 0x1, 0x40, 0xC0, 0x80,
+    0x80, 0x81, 0x0, 0x2, 0x0, 0x18, 0x8, 0x80, 0xC, 0x4, 0x4, 0x6, 0x2, 0x3, 0x1, 0x80,
+    0x0, 0x80, 0x0, 0x6, 0xC, 0x6, 0x86, 0xC6, 0xE6, 0x7E, 0x3C, 0x81, 0x0, 0x82, 0x0, 0x80,
+    0x37, 0x84, 0x0, 0x9, 0x0, 0xF0, 0xFC, 0xE, 0x3, 0xF1, 0xF9, 0xB, 0xFE, 0xFC, 0x80, 0x0,
+    0x7, 0x0, 0x7, 0x1F, 0x38, 0x60, 0x43, 0x47, 0x44, 0x80, 0x7, 0x80, 0x0, 0x81, 0x0, 0x4,
+    0xE0, 0xFE, 0x1E, 0xFE, 0xE0, 0x82, 0x0, 0x9, 0x0, 0x30, 0x3E, 0xF, 0x7, 0x6, 0x7, 0xF,
+    0x3E, 0x30, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFE, 0x83, 0xC6, 0x1, 0xFC, 0x38, 0x80, 0x0, 0x0,
+    0x0, 0x80, 0x3F, 0x82, 0x30, 0x2, 0x39, 0x1F, 0xF, 0x80, 0x0, 0x4, 0x0, 0xF0, 0xF8, 0x1C,
+    0xE, 0x82, 0x6, 0x0, 0xC, 0x80, 0x0, 0x4, 0x0, 0x7, 0xF, 0x1C, 0x38, 0x82, 0x30, 0x0,
+    0x18, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFE, 0x81, 0x6, 0x3, 0xE, 0x1C, 0xF8, 0xF0, 0x80, 0x0,
+    0x0, 0x0, 0x80, 0x3F, 0x81, 0x30, 0x3, 0x38, 0x1C, 0xF, 0x7, 0x80, 0x0, 0x0, 0x0, 0x80,
+    0xFE, 0x85, 0xC6, 0x80, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x85, 0x30, 0x80, 0x0, 0x0, 0x0, 0x80,
+    0xFE, 0x84, 0xC6, 0x0, 0x6, 0x80, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x87, 0x0, 0x5, 0x0, 0xF0,
+    0xF8, 0x1C, 0xE, 0x6, 0x81, 0xC6, 0x0, 0xCC, 0x80, 0x0, 0x3, 0x0, 0x7, 0xF, 0x1C, 0x82,
+    0x30, 0x80, 0x1F, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFE, 0x83, 0xC0, 0x80, 0xFE, 0x80, 0x0, 0x0,
+    0x0, 0x80, 0x3F, 0x83, 0x0, 0x80, 0x3F, 0x80, 0x0, 0x80, 0x0, 0x81, 0x6, 0x80, 0xFE, 0x81,
+    0x6, 0x80, 0x0, 0x80, 0x0, 0x81, 0x30, 0x80, 0x3F, 0x81, 0x30, 0x80, 0x0, 0x81, 0x0, 0x81,
+    0x6, 0x80, 0xFE, 0x82, 0x0, 0x1, 0x0, 0x18, 0x82, 0x30, 0x1, 0x1F, 0xF, 0x82, 0x0, 0x0,
+    0x0, 0x80, 0xFE, 0x6, 0xC0, 0xE0, 0xF0, 0x18, 0xC, 0x6, 0x2, 0x80, 0x0, 0x0, 0x0, 0x80,
+    0x3F, 0x80, 0x0, 0x4, 0x3, 0x7, 0x1E, 0x38, 0x30, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFE, 0x87,
+    0x0, 0x0, 0x0, 0x80, 0x3F, 0x85, 0x30, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFE, 0x4, 0x1E, 0xF0,
+    0x80, 0xF0, 0x1E, 0x80, 0xFE, 0x80, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x80, 0x0, 0x0, 0x1, 0x80,
+    0x0, 0x80, 0x3F, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFE, 0x2, 0xE, 0x78, 0xC0, 0x80, 0x0, 0x80,
+    0xFE, 0x80, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x80, 0x0, 0x2, 0x1, 0xF, 0x38, 0x80, 0x3F, 0x80,
+    0x0, 0x3, 0x0, 0xF0, 0xFC, 0xE, 0x81, 0x6, 0x2, 0xE, 0xFC, 0xF0, 0x80, 0x0, 0x3, 0x0,
+    0x7, 0x1F, 0x38, 0x81, 0x30, 0x2, 0x38, 0x1F, 0x7, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFE, 0x82,
+    0x86, 0x2, 0xCE, 0xFC, 0x78, 0x80, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x83, 0x1, 0x82, 0x0, 0x3,
+    0x0, 0xF0, 0xFC, 0xE, 0x81, 0x6, 0x2, 0xE, 0xFC, 0xF0, 0x80, 0x0, 0x3, 0x0, 0x7, 0x1F,
+    0x38, 0x80, 0x30, 0x3, 0x70, 0xF8, 0xDF, 0x7, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFE, 0x82, 0x86,
+    0x2, 0xCE, 0xFC, 0x78, 0x80, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x82, 0x1, 0x4, 0x7, 0x1E, 0x3C,
+    0x20, 0x0, 0x3, 0x0, 0x38, 0x7C, 0xCE, 0x81, 0xC6, 0x1, 0x86, 0x8C, 0x81, 0x0, 0x1, 0x0,
+    0x18, 0x83, 0x30, 0x2, 0x39, 0x1F, 0xF, 0x80, 0x0, 0x0, 0x0, 0x82, 0x6, 0x80, 0xFE, 0x82,
+    0x6, 0x0, 0x0, 0x83, 0x0, 0x80, 0x3F, 0x83, 0x0, 0x0, 0x0, 0x80, 0xFE, 0x83, 0x0, 0x80,
+    0xFE, 0x80, 0x0, 0x3, 0x0, 0xF, 0x1F, 0x38, 0x81, 0x30, 0x2, 0x38, 0x1F, 0xF, 0x80, 0x0,
+    0x9, 0x0, 0x6, 0x7E, 0xF8, 0xC0, 0x0, 0xC0, 0xF8, 0x7E, 0x6, 0x80, 0x0, 0x81, 0x0, 0x4,
+    0x3, 0x3F, 0x3C, 0x3F, 0x3, 0x82, 0x0, 0xB, 0xE, 0xFE, 0xF0, 0x0, 0xE0, 0x60, 0xE0, 0x0,
+    0xF0, 0xFE, 0xE, 0x0, 0x9, 0x0, 0x7, 0x3F, 0x3C, 0x7, 0x0, 0x7, 0x3C, 0x3F, 0x7, 0x80,
+    0x0, 0x9, 0x0, 0x2, 0xE, 0x1E, 0xF8, 0xE0, 0xF8, 0x1E, 0x6, 0x2, 0x80, 0x0, 0x9, 0x0,
+    0x20, 0x38, 0x3E, 0xF, 0x3, 0xF, 0x3E, 0x38, 0x20, 0x80, 0x0, 0x4, 0x0, 0x2, 0xE, 0x1E,
+    0x78, 0x80, 0xE0, 0x4, 0x78, 0x1E, 0xE, 0x2, 0x0, 0x83, 0x0, 0x80, 0x3F, 0x83, 0x0, 0x0,
+    0x0, 0x81, 0x6, 0x5, 0x86, 0xC6, 0xF6, 0x3E, 0x1E, 0x6, 0x80, 0x0, 0x5, 0x0, 0x30, 0x3C,
+    0x3E, 0x37, 0x31, 0x82, 0x30, 0x80, 0x0, 0x82, 0x0, 0x80, 0xFF, 0x80, 0x3, 0x82, 0x0, 0x82,
+    0x0, 0x80, 0xFF, 0x80, 0xC0, 0x82, 0x0, 0x5, 0x0, 0x2, 0xE, 0x3C, 0xF0, 0xC0, 0x84, 0x0,
+    0x82, 0x0, 0x5, 0x1, 0x7, 0x1F, 0x78, 0xE0, 0x80, 0x80, 0x0, 0x81, 0x0, 0x80, 0x3, 0x80,
+    0xFF, 0x83, 0x0, 0x81, 0x0, 0x80, 0xC0, 0x80, 0xFF, 0x83, 0x0, 0x4, 0x0, 0x20, 0x30, 0x18,
+    0xC, 0x80, 0x6, 0x4, 0xC, 0x18, 0x30, 0x20, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x89, 0xC0, 0x0,
+    0x0, 0x80, 0x0, 0x3, 0x1, 0x3, 0x6, 0x4, 0x84, 0x0, 0x8A, 0x0, 0x80, 0x0, 0x0, 0x60,
+    0x82, 0x30, 0x2, 0x70, 0xE0, 0xC0, 0x80, 0x0, 0x2, 0x0, 0x1E, 0x3E, 0x82, 0x33, 0x0, 0x1B,
+    0x80, 0x3F, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFF, 0x0, 0x60, 0x81, 0x30, 0x2, 0x70, 0xE0, 0xC0,
+    0x80, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x0, 0x18, 0x81, 0x30, 0x2, 0x38, 0x1F, 0xF, 0x80, 0x0,
+    0x3, 0x0, 0x80, 0xE0, 0x60, 0x82, 0x30, 0x0, 0x60, 0x81, 0x0, 0x3, 0x0, 0x7, 0x1F, 0x18,
+    0x82, 0x30, 0x0, 0x18, 0x81, 0x0, 0x3, 0x0, 0xC0, 0xE0, 0x70, 0x81, 0x30, 0x0, 0x60, 0x80,
+    0xFF, 0x80, 0x0, 0x3, 0x0, 0xF, 0x1F, 0x38, 0x81, 0x30, 0x0, 0x18, 0x80, 0x3F, 0x80, 0x0,
+    0x3, 0x0, 0x80, 0xE0, 0x70, 0x81, 0x30, 0x2, 0x70, 0xE0, 0xC0, 0x80, 0x0, 0x3, 0x0, 0x7,
+    0x1F, 0x1B, 0x83, 0x33, 0x0, 0x1B, 0x80, 0x0, 0x0, 0x0, 0x81, 0x30, 0x1, 0xFE, 0xFF, 0x81,
+    0x33, 0x81, 0x0, 0x82, 0x0, 0x80, 0x3F, 0x84, 0x0, 0x3, 0x0, 0xF0, 0xF8, 0x1C, 0x81, 0xC,
+    0x0, 0x18, 0x80, 0xFC, 0x80, 0x0, 0x3, 0x0, 0x3, 0x67, 0xCE, 0x81, 0xCC, 0x2, 0xE6, 0x7F,
+    0x3F, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFF, 0x1, 0x60, 0x20, 0x80, 0x30, 0x2, 0x70, 0xE0, 0xC0,
+    0x80, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x83, 0x0, 0x80, 0x3F, 0x80, 0x0, 0x80, 0x0, 0x81, 0x30,
+    0x80, 0xF3, 0x83, 0x0, 0x80, 0x0, 0x81, 0x30, 0x80, 0x3F, 0x81, 0x30, 0x80, 0x0, 0x80, 0x0,
+    0x81, 0x30, 0x80, 0xF3, 0x83, 0x0, 0x0, 0x0, 0x82, 0x30, 0x1, 0x1F, 0xF, 0x83, 0x0, 0x0,
+    0x0, 0x80, 0xFF, 0x6, 0x0, 0x80, 0xC0, 0xE0, 0x70, 0x30, 0x10, 0x80, 0x0, 0x0, 0x0, 0x80,
+    0x3F, 0x80, 0x3, 0x4, 0x7, 0x1E, 0x38, 0x30, 0x20, 0x80, 0x0, 0x0, 0x0, 0x81, 0x3, 0x80,
+    0xFF, 0x84, 0x0, 0x82, 0x0, 0x1, 0xF, 0x3F, 0x81, 0x30, 0x81, 0x0, 0x0, 0x0, 0x80, 0xF0,
+    0x3, 0x20, 0x30, 0xF0, 0xE0, 0x80, 0x30, 0x2, 0xF0, 0xE0, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x80,
+    0x0, 0x80, 0x3F, 0x80, 0x0, 0x80, 0x3F, 0x0, 0x0, 0x0, 0x0, 0x80, 0xF0, 0x1, 0x60, 0x20,
+    0x80, 0x30, 0x2, 0x70, 0xE0, 0xC0, 0x80, 0x0, 0x0, 0x0, 0x80, 0x3F, 0x83, 0x0, 0x80, 0x3F,
+    0x80, 0x0, 0x3, 0x0, 0xC0, 0xE0, 0x70, 0x81, 0x30, 0x2, 0x70, 0xE0, 0xC0, 0x80, 0x0, 0x3,
+    0x0, 0xF, 0x1F, 0x38, 0x81, 0x30, 0x2, 0x38, 0x1F, 0xF, 0x80, 0x0, 0x0, 0x0, 0x80, 0xF0,
+    0x0, 0x60, 0x81, 0x30, 0x2, 0x70, 0xE0, 0xC0, 0x80, 0x0, 0x0, 0x0, 0x80, 0xFF, 0x0, 0xC,
+    0x81, 0x18, 0x2, 0x1C, 0xF, 0x7, 0x80, 0x0, 0x3, 0x0, 0xC0, 0xE0, 0x70, 0x81, 0x30, 0x0,
+    0x60, 0x80, 0xF0, 0x80, 0x0, 0x3, 0x0, 0x7, 0xF, 0x1C, 0x81, 0x18, 0x0, 0xC, 0x80, 0xFF,
+    0x80, 0x0, 0x81, 0x0, 0x80, 0xF0, 0x0, 0x40, 0x81, 0x30, 0x0, 0x60, 0x80, 0x0, 0x81, 0x0,
+    0x80, 0x3F, 0x85, 0x0, 0x0, 0x0, 0x80, 0xE0, 0x81, 0xB0, 0x81, 0x30, 0x0, 0x60, 0x80, 0x0,
+    0x1, 0x0, 0x18, 0x82, 0x31, 0x80, 0x33, 0x1, 0x1F, 0x1E, 0x80, 0x0, 0x0, 0x0, 0x81, 0x30,
+    0x80, 0xFE, 0x82, 0x30, 0x80, 0x0, 0x82, 0x0, 0x1, 0x1F, 0x3F, 0x82, 0x30, 0x80, 0x0, 0x0,
+    0x0, 0x80, 0xF0, 0x83, 0x0, 0x80, 0xF0, 0x80, 0x0, 0x3, 0x0, 0xF, 0x1F, 0x38, 0x80, 0x30,
+    0x1, 0x10, 0x18, 0x80, 0x3F, 0x80, 0x0, 0x3, 0x0, 0x10, 0xF0, 0xE0, 0x81, 0x0, 0x2, 0xE0,
+    0xF0, 0x10, 0x80, 0x0, 0x81, 0x0, 0x4, 0x7, 0x3F, 0x38, 0x3F, 0x7, 0x82, 0x0, 0x2, 0x30,
+    0xF0, 0xC0, 0x80, 0x0, 0x0, 0x80, 0x80, 0x0, 0x3, 0xC0, 0xF0, 0x30, 0x0, 0x9, 0x0, 0x3,
+    0x3F, 0x3C, 0xF, 0x1, 0xF, 0x3C, 0x3F, 0x3, 0x80, 0x0, 0x9, 0x0, 0x10, 0x30, 0x70, 0xE0,
+    0x80, 0xE0, 0x70, 0x30, 0x10, 0x80, 0x0, 0x9, 0x0, 0x20, 0x30, 0x3C, 0xF, 0x7, 0xF, 0x3C,
+    0x30, 0x20, 0x80, 0x0, 0x4, 0x0, 0x10, 0xF0, 0xE0, 0x80, 0x80, 0x0, 0x2, 0xE0, 0xF0, 0x10,
+    0x80, 0x0, 0x80, 0x0, 0x5, 0xC0, 0xC3, 0xEF, 0x7C, 0x3F, 0x7, 0x82, 0x0, 0x0, 0x0, 0x82,
+    0x30, 0x0, 0xB0, 0x80, 0xF0, 0x1, 0x70, 0x30, 0x80, 0x0, 0x6, 0x0, 0x30, 0x38, 0x3C, 0x3F,
+    0x33, 0x31, 0x81, 0x30, 0x80, 0x0, 0x80, 0x0, 0x81, 0x80, 0x1, 0xFE, 0x7F, 0x81, 0x3, 0x80,
+    0x0, 0x80, 0x0, 0x80, 0x1, 0x2, 0x3, 0x7F, 0xFE, 0x81, 0xC0, 0x80, 0x0, 0x83, 0x0, 0x80,
+    0xFF, 0x83, 0x0, 0x83, 0x0, 0x80, 0xFF, 0x83, 0x0, 0x80, 0x0, 0x81, 0x3, 0x1, 0x7F, 0xFE,
+    0x81, 0x80, 0x80, 0x0, 0x80, 0x0, 0x81, 0xC0, 0x2, 0xFE, 0x7F, 0x3, 0x80, 0x1, 0x80, 0x0,
+    0x80, 0x0, 0x82, 0x80, 0x81, 0x0, 0x0, 0x80, 0x80, 0x0, 0x1, 0x0, 0x3, 0x82, 0x1, 0x81,
+    0x3, 0x0, 0x1, 0x80, 0x0, 0x4, 0x0, 0xF8, 0x80, 0xF8, 0x84, 0x80, 0xF0, 0x4, 0x84, 0xF8,
+    0x80, 0xF8, 0x0, 0x4, 0xE, 0x32, 0x1F, 0x21, 0xF, 0x80, 0x3F, 0x4, 0xF, 0x31, 0xE, 0x32,
+    0xE, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x5, 0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xD8,
+    0x80, 0xC8, 0x82, 0xC0, 0x5, 0x0, 0x1, 0x3, 0x7, 0xF, 0xD, 0x80, 0x9, 0x82, 0x1, 0x82,
+    0xC0, 0x80, 0xC8, 0x5, 0xD8, 0xF8, 0xF0, 0xE0, 0xC0, 0x80, 0x82, 0x1, 0x80, 0x9, 0x5, 0xD,
+    0xF, 0x7, 0x3, 0x1, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x9, 0x0, 0x80,
+    0xC0, 0xE0, 0xF0, 0xF8, 0xF0, 0xE0, 0xC0, 0x80, 0x80, 0x0, 0x3, 0x0, 0x7, 0x1, 0x0, 0x81,
+    0x7F, 0x2, 0x0, 0x1, 0x7, 0x80, 0x0, 0x3, 0x0, 0xE0, 0x80, 0x0, 0x81, 0xFE, 0x2, 0x0,
+    0x80, 0xE0, 0x80, 0x0, 0x9, 0x0, 0x1, 0x3, 0x7, 0xF, 0x1F, 0xF, 0x7, 0x3, 0x1, 0x80,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A,
+    0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x80, 0x0, 0x85, 0xF8, 0x81, 0x0, 0x80,
+    0x0, 0x85, 0xF, 0x81, 0x0, 0x3, 0x0, 0xE0, 0x80, 0x0, 0x81, 0xFE, 0x2, 0x0, 0x80, 0xE0,
+    0x80, 0x0, 0xB, 0x60, 0x61, 0x63, 0x67, 0x6F, 0x7F, 0x6F, 0x67, 0x63, 0x61, 0x60, 0x0,
+};
+
+const unsigned char big_widths[11] = {
+    36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 12,
+};
+
+const unsigned short big_offsets[11] = {
+    0, 146, 196, 304, 410, 493, 585, 717, 793, 937, 1076,
+};
+
+const unsigned char big_data[1096] = {
+    0x85, 0x0, 0x2, 0xC0, 0xF0, 0xF8, 0x80, 0xFC, 0x2, 0x7E, 0x3E, 0x3F, 0x84, 0x1F, 0x2, 0x3F,
+    0x3E, 0x7E, 0x80, 0xFC, 0x2, 0xF8, 0xF0, 0xC0, 0x85, 0x0, 0x82, 0x0, 0x1, 0x80, 0xFC, 0x81,
+    0xFF, 0x2, 0x7F, 0x7, 0x1, 0x8A, 0x0, 0x2, 0x1, 0x7, 0x7F, 0x81, 0xFF, 0x1, 0xFC, 0x80,
+    0x82, 0x0, 0x82, 0x0, 0x83, 0xFF, 0x83, 0x0, 0x1, 0xF0, 0xF8, 0x82, 0xFC, 0x1, 0xF8, 0xF0,
+    0x83, 0x0, 0x83, 0xFF, 0x82, 0x0, 0x82, 0x0, 0x0, 0x3F, 0x82, 0xFF, 0x0, 0xC0, 0x83, 0x0,
+    0x0, 0x1, 0x82, 0x3, 0x0, 0x1, 0x83, 0x0, 0x0, 0xC0, 0x82, 0xFF, 0x0, 0x3F, 0x82, 0x0,
+    0x83, 0x0, 0x2, 0x7, 0x1F, 0x7F, 0x80, 0xFF, 0x2, 0xFC, 0xF0, 0xC0, 0x80, 0x80, 0x84, 0x0,
+    0x80, 0x80, 0x2, 0xC0, 0xF0, 0xFC, 0x80, 0xFF, 0x2, 0x7F, 0x1F, 0x7, 0x83, 0x0, 0x86, 0x0,
+    0x1, 0x1, 0x3, 0x80, 0x7, 0x80, 0xF, 0x86, 0x1F, 0x80, 0xF, 0x80, 0x7, 0x1, 0x3, 0x1,
+    0x86, 0x0, 0x85, 0x0, 0x80, 0xF8, 0x0, 0xFC, 0x82, 0x7C, 0x0, 0x7E, 0x80, 0x3E, 0x83, 0xFE,
+    0x8C, 0x0, 0x8F, 0x0, 0x83, 0xFF, 0x8C, 0x0, 0x8F, 0x0, 0x83, 0xFF, 0x8C, 0x0, 0x8F, 0x0,
+    0x83, 0xFF, 0x8C, 0x0, 0x86, 0x0, 0x87, 0x80, 0x83, 0xFF, 0x87, 0x80, 0x83, 0x0, 0x86, 0x0,
+    0x95, 0xF, 0x83, 0x0, 0x82, 0x0, 0x0, 0xF8, 0x80, 0xFC, 0x0, 0x7C, 0x80, 0x7E, 0x80, 0x3E,
+    0x0, 0x3F, 0x87, 0x1F, 0x80, 0x3E, 0x0, 0x7E, 0x80, 0xFC, 0x3, 0xF8, 0xF0, 0xE0, 0xC0, 0x83,
+    0x0, 0x82, 0x0, 0x0, 0x1, 0x93, 0x0, 0x0, 0x3, 0x82, 0xFF, 0x0, 0xFE, 0x82, 0x0, 0x93,
+    0x0, 0x4, 0x80, 0xC0, 0xF0, 0xF8, 0xFC, 0x80, 0xFF, 0x3, 0x3F, 0x1F, 0x7, 0x1, 0x82, 0x0,
+    0x8A, 0x0, 0x3, 0x80, 0xC0, 0xE0, 0xF0, 0x80, 0xF8, 0x8, 0xFC, 0x7E, 0x7F, 0x3F, 0x1F, 0xF,
+    0x7, 0x3, 0x1, 0x87, 0x0, 0x82, 0x0, 0xD, 0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE, 0xFF,
+    0xBF, 0x9F, 0x8F, 0x87, 0x83, 0x81, 0x8C, 0x80, 0x82, 0x0, 0x82, 0x0, 0x9A, 0xF, 0x82, 0x0,
+    0x83, 0x0, 0x80, 0x7C, 0x82, 0x3E, 0x88, 0x1F, 0x80, 0x3E, 0x0, 0x7E, 0x80, 0xFC, 0x3, 0xF8,
+    0xF0, 0xE0, 0xC0, 0x84, 0x0, 0x97, 0x0, 0x0, 0x81, 0x82, 0xFF, 0x0, 0x7F, 0x83, 0x0, 0x89,
+    0x0, 0x87, 0xF8, 0x81, 0xFC, 0x0, 0xFE, 0x80, 0xDF, 0x80, 0x8F, 0x1, 0x7, 0x3, 0x84, 0x0,
+    0x93, 0x0, 0x80, 0x1, 0x80, 0x3, 0x1, 0x7, 0x1F, 0x80, 0xFF, 0x2, 0xFE, 0xFC, 0xE0, 0x82,
+    0x0, 0x82, 0x0, 0x0, 0xE0, 0x81, 0xC0, 0x81, 0x80, 0x88, 0x0, 0x80, 0x80, 0x80, 0xC0, 0x1,
+    0xE0, 0xF8, 0x81, 0xFF, 0x1, 0x7F, 0xF, 0x82, 0x0, 0x82, 0x0, 0x80, 0x7, 0x82, 0xF, 0x8A,
+    0x1F, 0x81, 0xF, 0x80, 0x7, 0x1, 0x3, 0x1, 0x85, 0x0, 0x8E, 0x0, 0x5, 0x80, 0xE0, 0xF0,
+    0xFC, 0xFE, 0x3E, 0x83, 0xFE, 0x87, 0x0, 0x89, 0x0, 0x8, 0x80, 0xE0, 0xF0, 0xFC, 0xFE, 0x3F,
+    0x1F, 0x7, 0x1, 0x80, 0x0, 0x83, 0xFF, 0x87, 0x0, 0x84, 0x0, 0x8, 0x80, 0xE0, 0xF0, 0xFC,
+    0xFE, 0x7F, 0x1F, 0x7, 0x3, 0x85, 0x0, 0x83, 0xFF, 0x87, 0x0, 0x81, 0x0, 0x1, 0xF0, 0xFC,
+    0x81, 0xFF, 0x1, 0xEF, 0xE3, 0x8A, 0xE0, 0x83, 0xFF, 0x84, 0xE0, 0x81, 0x0, 0x81, 0x0, 0x91,
+    0x3, 0x83, 0xFF, 0x84, 0x3, 0x81, 0x0, 0x94, 0x0, 0x83, 0xF, 0x87, 0x0, 0x84, 0x0, 0x83,
+    0xFE, 0x90, 0x3E, 0x85, 0x0, 0x84, 0x0, 0x83, 0xFF, 0x97, 0x0, 0x84, 0x0, 0x0, 0x7F, 0x82,
+    0x3F, 0x0, 0x1E, 0x86, 0x1F, 0x0, 0x3F, 0x80, 0x3E, 0x0, 0x7E, 0x80, 0xFC, 0x3, 0xF8, 0xF0,
+    0xE0, 0xC0, 0x84, 0x0, 0x97, 0x0, 0x1, 0x1, 0x7, 0x82, 0xFF, 0x0, 0xFC, 0x82, 0x0, 0x82,
+    0x0, 0x0, 0xE0, 0x80, 0xC0, 0x82, 0x80, 0x87, 0x0, 0x81, 0x80, 0x3, 0xC0, 0xE0, 0xF0, 0xFC,
+    0x80, 0xFF, 0x2, 0x7F, 0x1F, 0x7, 0x82, 0x0, 0x82, 0x0, 0x0, 0x7, 0x82, 0xF, 0x8A, 0x1F,
+    0x81, 0xF, 0x80, 0x7, 0x1, 0x3, 0x1, 0x86, 0x0, 0x85, 0x0, 0x2, 0x80, 0xE0, 0xF0, 0x80,
+    0xF8, 0x0, 0xFC, 0x80, 0x7E, 0x1, 0x3E, 0x3F, 0x86, 0x1F, 0x81, 0x3E, 0x0, 0x7C, 0x85, 0x0,
+    0x83, 0x0, 0x1, 0xF8, 0xFE, 0x80, 0xFF, 0x2, 0x7F, 0xF, 0x3, 0x81, 0x0, 0x86, 0x80, 0x8B,
+    0x0, 0x82, 0x0, 0x83, 0xFF, 0x5, 0xF0, 0xF8, 0xFC, 0x3E, 0x3F, 0x1F, 0x85, 0xF, 0x80, 0x1F,
+    0x6, 0x3F, 0x7E, 0xFE, 0xFC, 0xF8, 0xF0, 0xC0, 0x83, 0x0, 0x82, 0x0, 0x0, 0x3F, 0x83, 0xFF,
+    0x0, 0x3, 0x8D, 0x0, 0x0, 0x3, 0x82, 0xFF, 0x0, 0xFE, 0x82, 0x0, 0x83, 0x0, 0x1, 0x7,
+    0x3F, 0x81, 0xFF, 0x1, 0xFC, 0xF0, 0x80, 0xC0, 0x0, 0x80, 0x85, 0x0, 0x80, 0x80, 0x2, 0xC0,
+    0xE0, 0xFC, 0x81, 0xFF, 0x1, 0x3F, 0x7, 0x82, 0x0, 0x86, 0x0, 0x1, 0x1, 0x3, 0x80, 0x7,
+    0x80, 0xF, 0x87, 0x1F, 0x80, 0xF, 0x80, 0x7, 0x1, 0x3, 0x1, 0x85, 0x0, 0x82, 0x0, 0x93,
+    0x3E, 0x83, 0xFE, 0x1, 0x7E, 0x1E, 0x82, 0x0, 0x94, 0x0, 0x2, 0xE0, 0xF8, 0xFE, 0x80, 0xFF,
+    0x2, 0x3F, 0xF, 0x3, 0x84, 0x0, 0x90, 0x0, 0x2, 0x80, 0xE0, 0xFC, 0x81, 0xFF, 0x2, 0x3F,
+    0x7, 0x1, 0x87, 0x0, 0x8D, 0x0, 0x2, 0x80, 0xF0, 0xFC, 0x81, 0xFF, 0x1, 0x1F, 0x7, 0x8B,
+    0x0, 0x8A, 0x0, 0x2, 0xC0, 0xF8, 0xFE, 0x80, 0xFF, 0x2, 0x7F, 0xF, 0x3, 0x8E, 0x0, 0x88,
+    0x0, 0x0, 0x8, 0x83, 0xF, 0x0, 0x1, 0x91, 0x0, 0x84, 0x0, 0x2, 0xE0, 0xF0, 0xF8, 0x80,
+    0xFC, 0x0, 0x7E, 0x80, 0x3E, 0x86, 0x1F, 0x80, 0x3E, 0x0, 0x7E, 0x80, 0xFC, 0x2, 0xF8, 0xF0,
+    0xE0, 0x84, 0x0, 0x83, 0x0, 0x0, 0x7F, 0x82, 0xFF, 0x0, 0x81, 0x8C, 0x0, 0x0, 0x81, 0x82,
+    0xFF, 0x0, 0x7F, 0x83, 0x0, 0x84, 0x0, 0x5, 0x1, 0x3, 0x87, 0xCF, 0xDF, 0xDE, 0x80, 0xFC,
+    0x86, 0xF8, 0x80, 0xFC, 0x5, 0xDE, 0xDF, 0xCF, 0x87, 0x3, 0x1, 0x84, 0x0, 0x82, 0x0, 0x2,
+    0xE0, 0xFC, 0xFE, 0x80, 0xFF, 0x2, 0x1F, 0x7, 0x3, 0x80, 0x1, 0x86, 0x0, 0x80, 0x1, 0x2,
+    0x3, 0x7, 0x1F, 0x80, 0xFF, 0x2, 0xFE, 0xFC, 0xE0, 0x82, 0x0, 0x82, 0x0, 0x1, 0x1F, 0x7F,
+    0x81, 0xFF, 0x2, 0xF8, 0xE0, 0xC0, 0x80, 0x80, 0x86, 0x0, 0x80, 0x80, 0x2, 0xC0, 0xE0, 0xF8,
+    0x81, 0xFF, 0x1, 0x7F, 0x1F, 0x82, 0x0, 0x85, 0x0, 0x80, 0x3, 0x0, 0x7, 0x81, 0xF, 0x88,
+    0x1F, 0x81, 0xF, 0x0, 0x7, 0x80, 0x3, 0x85, 0x0, 0x83, 0x0, 0x3, 0x80, 0xE0, 0xF0, 0xF8,
+    0x80, 0xFC, 0x2, 0x7E, 0x3E, 0x3F, 0x85, 0x1F, 0x0, 0x3F, 0x80, 0x7E, 0x80, 0xFC, 0x3, 0xF8,
+    0xF0, 0xE0, 0x80, 0x84, 0x0, 0x82, 0x0, 0x0, 0xFC, 0x82, 0xFF, 0x0, 0x7, 0x8C, 0x0, 0x1,
+    0x1, 0x7, 0x82, 0xFF, 0x1, 0xFC, 0x80, 0x82, 0x0, 0x82, 0x0, 0x1, 0xF, 0x7F, 0x81, 0xFF,
+    0x2, 0xF8, 0xC0, 0x80, 0x88, 0x0, 0x80, 0x80, 0x1, 0xE0, 0xF8, 0x84, 0xFF, 0x82, 0x0, 0x84,
+    0x0, 0x2, 0x1, 0x3, 0x7, 0x80, 0xF, 0x80, 0x1F, 0x0, 0x3F, 0x85, 0x3E, 0x80, 0x1F, 0x3,
+    0xF, 0x7, 0x3, 0xC1, 0x82, 0xFF, 0x0, 0x1F, 0x82, 0x0, 0x85, 0x0, 0x0, 0xC0, 0x81, 0x80,
+    0x86, 0x0, 0x80, 0x80, 0x80, 0xC0, 0x2, 0xE0, 0xF8, 0xFE, 0x80, 0xFF, 0x2, 0x3F, 0xF, 0x3,
+    0x83, 0x0, 0x85, 0x0, 0x0, 0x7, 0x81, 0xF, 0x87, 0x1F, 0x81, 0xF, 0x0, 0x7, 0x80, 0x3,
+    0x0, 0x1, 0x87, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x8A, 0x0, 0x80, 0x0, 0x85, 0xF8,
+    0x81, 0x0, 0x80, 0x0, 0x85, 0xF, 0x81, 0x0,
 };
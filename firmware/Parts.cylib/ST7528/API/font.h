@@ -12,13 +12,22 @@
 
 #define FONT_GLYPH_PAGES 2
 #define FONT_GLYPH_COLUMNS 12
+// Bytes stored per glyph column: 1 for monochrome, or 2 or 4 bit planes (MSB
+// first) for a grayscale font from fontmaker.py --bpp. Must match font.c.
+#define FONT_GLYPH_PLANES 1
+// Whether font.c holds run-length encoded glyphs (fontmaker.py --rle) or a
+// plain glyphs[] array. Must match font.c.
+#define FONT_GLYPH_RLE 1
 #define FONT_GLYPH_COUNT 192
 #define FONT_GLYPH_OFFSET 32
-#define FONT_BIGDIGIT_OFFSET (96 + FONT_GLYPH_OFFSET)
-#define FONT_BIGDIGIT_ROW_WIDTH 32
+// Big numbers: '0' to '9' then '.', each FONT_BIG_PAGES tall and its own
+// width, up to FONT_BIG_COLUMNS, stored as rows of contiguous columns
+#define FONT_BIG_PAGES 6
+#define FONT_BIG_COLUMNS 36
+#define FONT_BIG_COUNT 11
+#define FONT_BIG_PERIOD 10
 
 #define GLYPH_CHAR(x) (x[0])
-#define FONT_GLYPH_BIGPERIOD "\xDE"
 #define FONT_GLYPH_LARR "\x9E"
 #define FONT_GLYPH_RARR "\x9F"
 #define FONT_GLYPH_UARR "\xBE"
@@ -26,6 +35,14 @@
 #define FONT_GLYPH_ENTER "\xDF"
 #define FONT_GLYPH_OHM "\x7F"
 
-extern char glyphs[192][FONT_GLYPH_PAGES][FONT_GLYPH_COLUMNS];
+#if FONT_GLYPH_RLE
+extern const unsigned short glyph_offsets[FONT_GLYPH_COUNT];
+extern const unsigned char glyph_data[];
+#else
+extern const char glyphs[FONT_GLYPH_COUNT][FONT_GLYPH_PAGES][FONT_GLYPH_COLUMNS * FONT_GLYPH_PLANES];
+#endif
+extern const unsigned char big_widths[FONT_BIG_COUNT];
+extern const unsigned short big_offsets[FONT_BIG_COUNT];
+extern const unsigned char big_data[];
 
 /* [] END OF FILE */
@@ -81,11 +81,17 @@
 #define configUSE_PREEMPTION		1
 #define configUSE_IDLE_HOOK			0
 #define configMAX_PRIORITIES		( ( unsigned portBASE_TYPE ) 4 )
-#define configUSE_TICK_HOOK			0
+#define configUSE_TICK_HOOK			1
+#define configUSE_TICKLESS_IDLE		1
+/* The clock at startup; clock.c changes it at run time with vPortSetTickClock(). */
 #define configCPU_CLOCK_HZ			( ( unsigned long ) 24000000L )
 #define configTICK_RATE_HZ			( ( portTickType ) 100 )
 #define configMINIMAL_STACK_SIZE	( ( unsigned short ) 50 )
-#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 2176 ) )
+/* Only TCBs, queues and the UI semaphore come from the heap, all allocated by main()
+   before the scheduler starts (520 bytes); task stacks are static arrays. Builds with
+   USE_SEQUENCE need 152 bytes more, USE_STREAM 208 and USE_DATALOG 104, which main.c
+   checks. */
+#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 536 ) )
 #define configMAX_TASK_NAME_LEN		( 8 )
 #define configUSE_TRACE_FACILITY	0
 #define configUSE_16_BIT_TICKS		0
@@ -99,7 +105,7 @@
 #define configUSE_ALTERNATIVE_API 		0
 #define configCHECK_FOR_STACK_OVERFLOW	2
 #define configUSE_RECURSIVE_MUTEXES		0
-#define configQUEUE_REGISTRY_SIZE		10
+#define configQUEUE_REGISTRY_SIZE		0
 #define configGENERATE_RUN_TIME_STATS	0
 #define configUSE_MALLOC_FAILED_HOOK	1
 
@@ -114,6 +120,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil				1
 #define INCLUDE_vTaskDelay					1
 #define INCLUDE_uxTaskGetStackHighWaterMark	1
+#define INCLUDE_xTaskGetIdleTaskHandle		1
+#define INCLUDE_pcTaskGetTaskName			1
 
 #define configPRIO_BITS       __NVIC_PRIO_BITS        /* 4 priority levels */
 #define MIN_PRIORITY          ((1 << configPRIO_BITS) - 1)
@@ -126,4 +134,11 @@ to exclude the API function. */
 See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY 	( 2 << (8 - configPRIO_BITS) )
 
+/* Per-task run time for the 'stats' command. The kernel's own run time stats
+would need the trace facility's extra TCB fields and a sprintf'd table, so
+profile.c just times each switch, and records it in the event trace when built
+with TRACE. */
+void profile_task_switch(void *task);
+#define traceTASK_SWITCHED_IN() profile_task_switch(pxCurrentTCB)
+
 #endif /* FREERTOS_CONFIG_H */
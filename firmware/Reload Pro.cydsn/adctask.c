@@ -16,53 +16,956 @@
 #include "tasks.h"
 #include "config.h"
 
-static int total_voltage = 0;
-static int total_current = 0;
+// The ISR reads the SAR result registers directly, one load a channel, rather
+// than through ADC_GetResult16()'s call and range check. That needs the
+// adc_channel numbering to match the sequenced channels the fitter placed on
+// the SAR mux: dedicated port P2 for the sense pins, the opamp output on CTB0.
+_Static_assert(ADC_RING_CHANNELS <= ADC_SEQUENCED_CHANNELS_NUM, "ring channels must all be sequenced");
+_Static_assert(ADC_CHAN_CURRENT_SENSE == 0 && ADC_cy_psoc4_sarmux_8__CH_0_PORT == 0 &&
+	ADC_cy_psoc4_sarmux_8__CH_0_PIN == Current_Sense__SHIFT, "ADC channel 0 isn't Current_Sense");
+_Static_assert(ADC_CHAN_VOLTAGE_SENSE == 1 && ADC_cy_psoc4_sarmux_8__CH_1_PORT == 0 &&
+	ADC_cy_psoc4_sarmux_8__CH_1_PIN == Voltage_Sense__SHIFT, "ADC channel 1 isn't Voltage_Sense");
+_Static_assert(ADC_CHAN_OPAMP_OUT == 2 && ADC_cy_psoc4_sarmux_8__CH_2_PORT == Opamp_Out__PORT &&
+	ADC_cy_psoc4_sarmux_8__CH_2_PIN == Opamp_Out__SHIFT, "ADC channel 2 isn't Opamp_Out");
+_Static_assert(ADC_CHAN_FET_IN == 3 && ADC_cy_psoc4_sarmux_8__CH_3_PORT == 0 &&
+	ADC_cy_psoc4_sarmux_8__CH_3_PIN == Gate_Sense_Low__SHIFT, "ADC channel 3 isn't Gate_Sense_Low");
+
+static inline int16 adc_result(adc_channel chan) {
+	return (int16)ADC_SAR_CHAN_RESULT_PTR[chan];
+}
+
+// Raw scans are copied here by the ISR and filtered by the ADC task a block at a time.
+static int16 adc_ring[ADC_RING_SCANS][ADC_RING_CHANNELS];
+static uint8 adc_ring_head = 0;
+static uint32 adc_block_time[ADC_RING_BLOCKS]; // Time each block completed, in microseconds
+static uint8 adc_block_flags[ADC_RING_BLOCKS]; // PULSE_FLAG_* as each block completed
+static uint32 adc_ring_overruns = 0;
+static uint8 adc_ring_peak = 0; // Most blocks ever waiting for the task
+#ifdef USE_STREAM
+static uint8 stream_queue_peak = 0;
+#endif
+
+static xQueueHandle adc_queue;
+
+// The slow channels take turns on the injection channel, a conversion at the
+// end of each block's last scan, so they cost a conversion a block rather
+// than one in every scan. The temperature sensor is taken out of the scan
+// for it, its channel's settings copied to the injection channel on its
+// turn; current set keeps the injection channel settings it was built with.
+// adc_read_slow() holds the rotation off to convert one now.
+#define ADC_INJ_CONFIG_MASK 0x00003FFFu // Pin, port, differential, resolution, averaging and timer
+static uint32 current_set_config;
+static volatile int16 slow_results[ADC_SLOW_CHANNELS];
+static volatile uint8 slow_channel;	// Converting, or last converted
+static volatile uint8 slow_pending = 0;	// A conversion the ISR started hasn't been read yet
+static volatile uint8 slow_hold = 0;
+static uint8 slow_running = 0;	// Once start_adc() has taken temperature out of the scan
+
+// Decimation filter. Each block is boxcar-averaged into a fast reading, and the
+// precise reading is a moving average over the last 2^filter_shift block means.
+// The boxcar and the control loops run in the ISR as each block fills, so
+// regulation keeps pace with the acquisition whatever the tasks are doing. The
+// means go into block_mean alongside the raw block; the slot belongs to the ISR
+// until its index is posted on adc_queue, and to the ADC task after that.
+static int16 fast_reading[FILTER_CHANNELS];
+static int16 block_mean[ADC_RING_BLOCKS][FILTER_CHANNELS];
+static int16 block_history[ADC_FILTER_MAX_BLOCKS][FILTER_CHANNELS];
+static int32 history_sum[FILTER_CHANNELS];
+static uint8 history_idx = 0;
+static uint8 filter_shift = ADC_DEFAULT_FILTER_SHIFT;
+static int8 new_filter_shift = -1;
+
+// The precise readings, published by the ADC task after each block under a
+// sequence count that is odd while an update is in progress. Readers copy the
+// lot and retry if the count moved, so they never mix current and voltage from
+// different blocks and never need to mask interrupts. The ADC task has the
+// highest priority, so a reader can only be interrupted by the writer and
+// the writer never waits on a reader. Not for use from ISRs.
+static volatile measurement latest;
+static volatile uint16 measurement_seq = 0;
+
+// Binary streaming: one record every stream_interval blocks, 0 to disable.
+// With stream_channels set they're channel records, each channel in every
+// stream_every[channel] records. Only in builds with USE_STREAM defined.
+#ifdef USE_STREAM
+xQueueHandle stream_queue;
+static uint8 stream_interval = 0;
+static uint8 stream_countdown = 0;
+static uint16 stream_sequence = 0;
+static uint16 stream_dropped = 0;
+static uint8 stream_channels = 0;
+static uint8 stream_every[STREAM_CHANNELS];
+static uint8 stream_due[STREAM_CHANNELS];
+#endif
+
+// 'monitor' output: the comms task is woken every monitor_interval microseconds
+// of block time, 0 to disable
+static volatile uint32 monitor_interval = 0;
+static uint32 next_monitor;
+
+static uint32 trip_cycles_max = 0;
+
+// scan is the ISR's latest complete scan, or NULL to read the result registers
+RAMFUNC static void trip(uint32 entry_ticks, fault_code code, const int16 *scan) {
+	trip_output();
+	TRACE_EVENT(TRACE_TRIP, code);
+	uint32 cycles = cycles_since(entry_ticks);
+	if(cycles > trip_cycles_max)
+		trip_cycles_max = cycles;
+	if(scan != NULL) {
+		fault_capture(code, scan[ADC_CHAN_CURRENT_SENSE], scan[ADC_CHAN_VOLTAGE_SENSE], scan[ADC_CHAN_OPAMP_OUT], scan[ADC_CHAN_FET_IN]);
+	} else {
+		fault_capture(code, adc_result(ADC_CHAN_CURRENT_SENSE), adc_result(ADC_CHAN_VOLTAGE_SENSE),
+			adc_result(ADC_CHAN_OPAMP_OUT), adc_result(ADC_CHAN_FET_IN));
+	}
+	defer_post(DEFER_FAULT);
+}
+
+// Voltage trip points in counts, from voltage_limits_update. The ISR checks
+// every scan against both, with the lower one being whichever of the
+// undervoltage limit and reverse polarity is higher.
+static volatile int16 voltage_trip_high = INT16_MAX;
+static volatile int16 voltage_trip_low = INT16_MIN;
+static volatile int16 voltage_trip_reverse = INT16_MIN;
+
+// Works out the trip points from the settings and present calibration
+void voltage_limits_update() {
+	int16 offset = settings->adc_voltage_offset;
+	int16 reverse = offset - (voltage_to_raw(FAULT_REVERSE_VOLTAGE) - offset);
+	int16 under = settings->undervoltage_limit ? voltage_to_raw(settings->undervoltage_limit * 1000) : INT16_MIN;
+	int16 over = settings->overvoltage_limit ? voltage_to_raw(settings->overvoltage_limit * 1000) : INT16_MAX;
+
+	uint8 int_state = CyEnterCriticalSection();
+	voltage_trip_reverse = reverse;
+	voltage_trip_low = (under > reverse)?under:reverse;
+	voltage_trip_high = over;
+	CyExitCriticalSection(int_state);
+}
+
+static fault_code voltage_fault(int16 voltage) {
+	if(voltage >= voltage_trip_high)
+		return FAULT_OVERVOLTAGE;
+	if(voltage < voltage_trip_reverse)
+		return FAULT_REVERSE;
+	return FAULT_UNDERVOLTAGE;
+}
+
+// Trips the output from the ADC task, for protection that works from block
+// means rather than single scans
+void fault_trip(fault_code code) {
+	trip_output();
+	fault_capture(code, fast_reading[FILTER_CURRENT], fast_reading[FILTER_VOLTAGE],
+		adc_result(ADC_CHAN_OPAMP_OUT), adc_result(ADC_CHAN_FET_IN));
+	defer_post(DEFER_FAULT);
+}
+
+static uint32 slow_config(adc_slow_channel chan) {
+	if(chan == ADC_SLOW_TEMP)
+		return ADC_SAR_CHAN_CONFIG_PTR[ADC_CHAN_TEMP] & ADC_INJ_CONFIG_MASK;
+	return slow_running?current_set_config:(ADC_SAR_INJ_CHAN_CONFIG_REG & ADC_INJ_CONFIG_MASK);
+}
+
+// Whether temperature is back in the scan, from 'adc chan 4 on', and read
+// from there instead
+static int temp_scanned() {
+	return (ADC_SAR_CHAN_EN_REG & (1u << ADC_CHAN_TEMP)) != 0;
+}
+
+// Runs from the ISR as each block fills: takes the last slow conversion and
+// starts the next channel's
+RAMFUNC static void slow_block() {
+	if(slow_hold || (ADC_SAR_INJ_CHAN_CONFIG_REG & ADC_INJ_CHAN_EN))
+		return;
+	uint8 chan = slow_channel;
+	if(slow_pending)
+		slow_results[chan] = ADC_SAR_INJ_RESULT_REG & ADC_RESULT_MASK;
+	if(++chan >= ADC_SLOW_CHANNELS)
+		chan = 0;
+	if(chan == ADC_SLOW_TEMP && temp_scanned())
+		chan++;
+	slow_channel = chan;
+	ADC_SAR_INJ_CHAN_CONFIG_REG = slow_config(chan) | ADC_INJ_CHAN_EN;
+	slow_pending = 1;
+}
+
+// Converts a slow channel at the end of the next scan and waits for it, for
+// readings that can't wait their turn. Works whether or not the ADC ISR is
+// running, as long as the SAR is converting: polling the enable bit, which
+// clears when the conversion's done, doesn't need the interrupt flag.
+int16 adc_read_slow(adc_slow_channel chan) {
+	if(chan == ADC_SLOW_TEMP && slow_running && temp_scanned())
+		return ADC_GetResult16(ADC_CHAN_TEMP);
+	slow_hold = 1;
+	uint32 start = get_time_us();
+	while((ADC_SAR_INJ_CHAN_CONFIG_REG & ADC_INJ_CHAN_EN) && get_time_us() - start < OPAMP_TRIM_TIMEOUT_US);
+	if(slow_pending) {
+		slow_results[slow_channel] = ADC_SAR_INJ_RESULT_REG & ADC_RESULT_MASK;
+		slow_pending = 0;
+	}
+
+	ADC_SAR_INJ_CHAN_CONFIG_REG = slow_config(chan) | ADC_INJ_CHAN_EN;
+	start = get_time_us();
+	while((ADC_SAR_INJ_CHAN_CONFIG_REG & ADC_INJ_CHAN_EN) && get_time_us() - start < OPAMP_TRIM_TIMEOUT_US);
+	int16 result = ADC_SAR_INJ_RESULT_REG & ADC_RESULT_MASK;
+	slow_results[chan] = result;
+	slow_hold = 0;
+	return result;
+}
+
+// The latest reading of a slow channel, at most a few blocks old
+int16 get_adc_slow(adc_slow_channel chan) {
+	if(chan == ADC_SLOW_TEMP && slow_running && temp_scanned())
+		return ADC_GetResult16(ADC_CHAN_TEMP);
+	return slow_results[chan];
+}
+
+// Runs from the ISR as each block fills
+RAMFUNC static void control_block(uint8 block) {
+	static const uint8 channels[FILTER_CHANNELS] = {ADC_CHAN_CURRENT_SENSE, ADC_CHAN_VOLTAGE_SENSE};
+
+	for(int chan = 0; chan < FILTER_CHANNELS; chan++) {
+		int32 sum = 0;
+		for(int i = 0; i < ADC_BLOCK_SCANS; i++)
+			sum += adc_ring[block + i][channels[chan]];
+		int16 mean = sum / ADC_BLOCK_SCANS;
+		block_mean[block / ADC_BLOCK_SCANS][chan] = mean;
+		fast_reading[chan] = mean;
+	}
+	control_update();
+}
+
+RAMFUNC CY_ISR(ADC_ISR_func) {
+	uint32 entry_ticks = CySysTickGetValue();
+
+	// Hardware limit compare: the opamp driving the gate into its rail means the FET
+	// can't follow the setpoint. This fires as soon as the channel converts, without
+	// waiting for the end of the scan. Worst case trip latency is one channel
+	// conversion, plus interrupt entry and the pin writes in trip_output() (about
+	// 60 cycles, 2.5us at 24MHz). The measured maximum is reported by 'debug'.
+	uint32 range_flags = ADC_SAR_RANGE_INTR_MASKED_REG;
+	if(range_flags) {
+		trip(entry_ticks, FAULT_GATE_LIMIT, NULL);
+		ADC_SAR_RANGE_INTR_REG = range_flags;
+	}
 
-CY_ISR(ADC_ISR_func) {
 	uint32 isr_flags = ADC_SAR_INTR_MASKED_REG;
 	if(isr_flags & ADC_EOS_MASK) {
-		total_current = total_current - (total_current >> ADC_MIX_RATIO) + ADC_GetResult16(ADC_CHAN_CURRENT_SENSE);
-		total_voltage = total_voltage - (total_voltage >> ADC_MIX_RATIO) + ADC_GetResult16(ADC_CHAN_VOLTAGE_SENSE);
-		if(abs(ADC_GetResult16(ADC_CHAN_OPAMP_OUT) - ADC_GetResult16(ADC_CHAN_FET_IN)) > 10) {
-			set_output_mode(OUTPUT_MODE_OFF);
-
-			xQueueSendToBackFromISR(ui_queue, &((ui_event){
-				.type=UI_EVENT_OVERTEMP,
-				.int_arg=0,
-				.when=xTaskGetTickCountFromISR()
-			}), NULL);
-			xQueueOverwriteFromISR(comms_queue, &((comms_event){
-				.type=COMMS_EVENT_OVERTEMP,
-			}), NULL);
+		int16 *scan = adc_ring[adc_ring_head];
+		for(int i = 0; i < ADC_RING_CHANNELS; i++)
+			scan[i] = adc_result(i);
+
+		// A short circuit test forces the gate on, so it does its own checks
+		uint8 shorting = short_scan(scan);
+		if(shorting > 1)
+			trip(entry_ticks, FAULT_SOA, scan);
+		else if(!shorting && abs(scan[ADC_CHAN_OPAMP_OUT] - scan[ADC_CHAN_FET_IN]) > 10)
+			trip(entry_ticks, FAULT_FET_MISMATCH, scan);
+		// One pair of compares unless something's wrong
+		int16 voltage = scan[ADC_CHAN_VOLTAGE_SENSE];
+		int16 low = shorting?voltage_trip_reverse:voltage_trip_low;
+		if((voltage >= voltage_trip_high || voltage < low) && get_output_mode() != OUTPUT_MODE_OFF)
+			trip(entry_ticks, voltage_fault(voltage), scan);
+		capture_scan(scan);
+		dither_scan();
+
+		adc_ring_head = (adc_ring_head + 1) % ADC_RING_SCANS;
+		if(adc_ring_head % ADC_BLOCK_SCANS == 0) {
+			// A block just filled; hand its first scan index to the ADC task
+			portBASE_TYPE woken = pdFALSE;
+			uint8 block = (adc_ring_head + ADC_RING_SCANS - ADC_BLOCK_SCANS) % ADC_RING_SCANS;
+			adc_block_time[block / ADC_BLOCK_SCANS] = get_time_us();
+			adc_block_flags[block / ADC_BLOCK_SCANS] = get_pulse_flags();
+			TRACE_EVENT(TRACE_ADC_BLOCK, block);
+			control_block(block);
+			slow_block();
+			if(xQueueSendToBackFromISR(adc_queue, &block, &woken) != pdPASS) {
+				adc_ring_overruns++;
+			} else {
+				uint8 waiting = uxQueueMessagesWaitingFromISR(adc_queue);
+				if(waiting > adc_ring_peak)
+					adc_ring_peak = waiting;
+			}
+			portEND_SWITCHING_ISR(woken);
 		}
 	}
 	ADC_SAR_INTR_REG = isr_flags;
+	profile_isr(PROFILE_ISR_ADC, entry_ticks);
 }
 
 void start_adc() {
+	adc_queue = xQueueCreate(ADC_RING_BLOCKS - 2, sizeof(uint8));
+#ifdef USE_STREAM
+	stream_queue = xQueueCreate(STREAM_QUEUE_LENGTH, sizeof(stream_sample));
+#endif
+
 	ADC_Start();
 	//ADC_SAR_INTR_MASK_REG = ADC_EOS_MASK;
-	ADC_IRQ_StartEx(ADC_ISR_func);
+	ADC_SetHighLimit(get_opamp_trip_limit());
+	ADC_SetLimitMask(1 << ADC_CHAN_OPAMP_OUT);
+	ADC_SAR_RANGE_INTR_MASK_REG = 1 << ADC_CHAN_OPAMP_OUT;
 	ADC_StartConvert();
+
+	// A first temperature before the ISR starts, so the thermal model never
+	// sees an empty reading, then the scan goes without it
+	current_set_config = ADC_SAR_INJ_CHAN_CONFIG_REG & ADC_INJ_CONFIG_MASK;
+	adc_read_slow(ADC_SLOW_CURRENT_SET);
+	adc_read_slow(ADC_SLOW_TEMP);
+	slow_channel = ADC_SLOW_TEMP;
+	slow_running = 1;
+	ADC_SAR_CHAN_EN_REG &= ~(1u << ADC_CHAN_TEMP);
+
+	ADC_IRQ_StartEx(ADC_ISR_func);
+	ADC_IRQ_SetPriority(IRQ_PRIORITY_PROTECTION);
+}
+
+// Returns a pointer to the most recently completed scan in the ring.
+const int16 *get_last_scan() {
+	return adc_ring[(adc_ring_head + ADC_RING_SCANS - 1) % ADC_RING_SCANS];
+}
+
+uint32 get_adc_overruns() {
+	return adc_ring_overruns;
+}
+
+// In blocks the task can fall behind by before the ISR overruns it
+void get_adc_ring_usage(buffer_usage *usage) {
+	usage->size = ADC_RING_BLOCKS - 2;
+	usage->bytes = sizeof(adc_ring) + sizeof(adc_block_time) + sizeof(adc_block_flags) + sizeof(block_mean);
+	usage->fill = uxQueueMessagesWaiting(adc_queue);
+	usage->peak = adc_ring_peak;
+}
+
+// In records; the queue is on the FreeRTOS heap
+void get_stream_queue_usage(buffer_usage *usage) {
+#ifdef USE_STREAM
+	usage->size = STREAM_QUEUE_LENGTH;
+	usage->bytes = STREAM_QUEUE_LENGTH * sizeof(stream_sample);
+	usage->fill = uxQueueMessagesWaiting(stream_queue);
+	usage->peak = stream_queue_peak;
+#else
+	*usage = (buffer_usage){0};
+#endif
+}
+
+// Runtime SAR timing. TopDesign already averages the precision channels and
+// leaves the protection channels at 8 bits unaveraged; these trade conversion
+// time against resolution within that split. Which channels average stays
+// fixed, since accumulated results are 16 times the scale of single ones and
+// the calibration and trip limits depend on it. Changes take effect from the
+// next conversion.
+
+// Samples averaged on the averaging channels, 2^shift. From 16 up the SAR
+// scales the sum to 16 samples' worth, so the calibration still holds.
+int adc_set_averaging(int shift) {
+	if(shift < ADC_AVG_MIN_SHIFT || shift > ADC_AVG_MAX_SHIFT)
+		return 0;
+	uint8 int_state = CyEnterCriticalSection();
+	ADC_SAR_SAMPLE_CTRL_REG = (ADC_SAR_SAMPLE_CTRL_REG & ~ADC_AVG_CNT_MASK) | ((uint32)(shift - 1) << ADC_AVG_CNT_OFFSET);
+	CyExitCriticalSection(int_state);
+	return 1;
+}
+
+int adc_get_averaging() {
+	return ((ADC_SAR_SAMPLE_CTRL_REG & ADC_AVG_CNT_MASK) >> ADC_AVG_CNT_OFFSET) + 1;
+}
+
+// Sample time of one of the four timers (A to D) that channels select from,
+// in ADC clocks
+int adc_set_sample_time(int timer, int clocks) {
+	if(timer < 0 || timer > 3 || clocks < ADC_SAMPLE_CLOCKS_MIN || clocks > ADC_SAMPLE_CLOCKS_MAX)
+		return 0;
+	reg32 *reg = (timer < 2)?&ADC_SAR_SAMPLE_TIME01_REG:&ADC_SAR_SAMPLE_TIME23_REG;
+	int shift = (timer & 1)?ADC_SAMPLE_TIME13_OFFSET:0;
+	uint8 int_state = CyEnterCriticalSection();
+	*reg = (*reg & ~(ADC_SAMPLE_TIME02_MASK << shift)) | ((uint32)clocks << shift);
+	CyExitCriticalSection(int_state);
+	return 1;
+}
+
+int adc_get_sample_time(int timer) {
+	uint32 reg = (timer < 2)?ADC_SAR_SAMPLE_TIME01_REG:ADC_SAR_SAMPLE_TIME23_REG;
+	return (reg >> ((timer & 1)?ADC_SAMPLE_TIME13_OFFSET:0)) & ADC_SAMPLE_TIME02_MASK;
+}
+
+// Selects the sample timer for one of the sequenced channels
+int adc_set_channel_timer(int channel, int timer) {
+	if(channel < 0 || channel >= ADC_SEQUENCED_CHANNELS_NUM || timer < 0 || timer > 3)
+		return 0;
+	uint8 int_state = CyEnterCriticalSection();
+	ADC_SAR_CHAN_CONFIG_PTR[channel] = (ADC_SAR_CHAN_CONFIG_PTR[channel] & ~ADC_SAMPLE_TIME_SEL_MASK) | ((uint32)timer << ADC_SAMPLE_TIME_SEL_SHIFT);
+	CyExitCriticalSection(int_state);
+	return 1;
+}
+
+int adc_get_channel_timer(int channel) {
+	return (ADC_SAR_CHAN_CONFIG_PTR[channel] & ADC_SAMPLE_TIME_SEL_MASK) >> ADC_SAMPLE_TIME_SEL_SHIFT;
+}
+
+int adc_get_channel_averaged(int channel) {
+	return (ADC_SAR_CHAN_CONFIG_PTR[channel] & ADC_AVERAGING_EN) != 0;
+}
+
+// Bits a single conversion on the channel resolves: the alternate resolution,
+// 8 or 10, for channels that select it, else the SAR's full 12
+int adc_channel_bits(int channel) {
+	if(!(ADC_SAR_CHAN_CONFIG_PTR[channel] & ADC_ALT_RESOLUTION_ON))
+		return ADC_MAX_RESOLUTION;
+	return (ADC_SAR_SAMPLE_CTRL_REG & ADC_ALT_RESOLUTION_10BIT)?10:8;
+}
+
+// OPAMP_OUT_TRIP_LIMIT in the opamp output channel's own counts. TopDesign
+// converts it at 8 bits, where the 12 bit figure could never be reached.
+int16 get_opamp_trip_limit() {
+	return OPAMP_OUT_TRIP_LIMIT >> (ADC_MAX_RESOLUTION - adc_channel_bits(ADC_CHAN_OPAMP_OUT));
+}
+
+// Which sequenced channels the scan converts. The ring's four are required,
+// as every measurement and trip reads them, so of those in the design only
+// temperature can come and go: back in the scan it's read there, out of it
+// it takes turns on the injection channel. A shorter scan is a faster one.
+int adc_set_channel_scanned(int channel, int scanned) {
+	if(channel < 0 || channel >= ADC_SEQUENCED_CHANNELS_NUM || (!scanned && (ADC_SCAN_REQUIRED & (1u << channel))))
+		return 0;
+	uint8 int_state = CyEnterCriticalSection();
+	if(scanned)
+		ADC_SAR_CHAN_EN_REG |= 1u << channel;
+	else
+		ADC_SAR_CHAN_EN_REG &= ~(1u << channel);
+	CyExitCriticalSection(int_state);
+	return 1;
+}
+
+int adc_get_channel_scanned(int channel) {
+	return (ADC_SAR_CHAN_EN_REG & (1u << channel)) != 0;
+}
+
+// Scans a second the present settings should give, from the nominal SAR
+// clock: each enabled channel takes its timer's sample clocks, a clock a bit
+// and ADC_CONVERSION_CLOCKS, times the samples averaged if it averages. The
+// slow channel's one conversion a block is left out. The measured rate is
+// get_ripple_scan_rate().
+uint32 adc_get_scan_rate() {
+	uint32 clocks = 0;
+	uint32 enabled = ADC_SAR_CHAN_EN_REG;
+	for(int i = 0; i < ADC_SEQUENCED_CHANNELS_NUM; i++) {
+		if(!(enabled & (1u << i)))
+			continue;
+		uint32 conversion = adc_get_sample_time(adc_get_channel_timer(i)) + ADC_CONVERSION_CLOCKS
+			+ adc_channel_bits(i);
+		clocks += adc_get_channel_averaged(i)?conversion << adc_get_averaging():conversion;
+	}
+	return (clocks == 0)?0:ADC_NOMINAL_CLOCK_FREQ / clocks;
+}
+
+// Averages as many samples on the averaging channels as still scan at hz or
+// faster. Returns 0 if even the fewest can't.
+int adc_set_scan_rate(uint32 hz) {
+	int old_shift = adc_get_averaging();
+	for(int shift = ADC_AVG_MAX_SHIFT; shift >= ADC_AVG_MIN_SHIFT; shift--) {
+		adc_set_averaging(shift);
+		if(adc_get_scan_rate() >= hz)
+			return 1;
+	}
+	adc_set_averaging(old_shift);
+	return 0;
+}
+
+uint32 get_trip_cycles_max() {
+	return trip_cycles_max;
+}
+
+// Deferred half of a trip: finish shutting the output down and tell everyone.
+// The UI task saves the fault to the log.
+int handle_fault() {
+	fault_code code = fault_take();
+	TRACE_EVENT(TRACE_FAULT, code);
+	sequence_stop();
+	battery_stop();
+	sweep_stop();
+	mppt_stop();
+	ir_stop();
+	tune_stop();
+	impedance_stop();
+	ocp_stop();
+	loadreg_stop();
+	standby_stop();
+	short_stop();
+	if(get_load_mode() == LOAD_MODE_PULSE)
+		set_load_mode(LOAD_MODE_CC);
+	set_output_mode(OUTPUT_MODE_OFF);
+
+	ui_post(UI_POST_FAULT);
+	notify_post(NOTIFY_FAULT, code);
+	return 1;
+}
+
+// Sets the length of the precise averager, in blocks. Must be a power of two.
+int set_filter_length(int blocks) {
+	int8 shift = 0;
+	while((1 << shift) < blocks)
+		shift++;
+	if((1 << shift) != blocks || blocks > ADC_FILTER_MAX_BLOCKS)
+		return 0;
+
+	// Applied by the ADC task so it never races the running sums
+	new_filter_shift = shift;
+	return 1;
+}
+
+int get_filter_length() {
+	return 1 << filter_shift;
+}
+
+static void apply_filter_length() {
+	filter_shift = new_filter_shift;
+	new_filter_shift = -1;
+
+	for(int chan = 0; chan < FILTER_CHANNELS; chan++) {
+		int32 sum = 0;
+		for(int i = 1; i <= (1 << filter_shift); i++)
+			sum += block_history[(history_idx + ADC_FILTER_MAX_BLOCKS - i) % ADC_FILTER_MAX_BLOCKS][chan];
+		history_sum[chan] = sum;
+	}
+}
+
+// Second stage: moving average of the block means from control_block()
+static void process_block(const int16 *mean) {
+	if(new_filter_shift >= 0)
+		apply_filter_length();
+
+	uint8 oldest = (history_idx + ADC_FILTER_MAX_BLOCKS - (1 << filter_shift)) % ADC_FILTER_MAX_BLOCKS;
+	for(int chan = 0; chan < FILTER_CHANNELS; chan++) {
+		history_sum[chan] += mean[chan] - block_history[oldest][chan];
+		block_history[history_idx][chan] = mean[chan];
+	}
+	history_idx = (history_idx + 1) % ADC_FILTER_MAX_BLOCKS;
+}
+
+// Mains synchronous integration, like a bench meter's NPLC: the precise
+// reading is instead the mean over exactly a whole number of power line
+// cycles, which rejects hum at the line frequency and its harmonics. Each
+// block mean is weighted by the time since the previous block, and the block
+// that straddles the end of a period is split between it and the next, so the
+// period needn't be a whole number of blocks. The reading changes once a
+// period; until the first one is done, the moving average stands in.
+static uint32 line_period = 0;	// Microseconds, 0 for the moving average
+static volatile int32 new_line_period = -1;
+static uint8 line_hz = 0, line_cycles = 1;
+static int64 line_sum[FILTER_CHANNELS];	// Counts.us
+static uint32 line_elapsed, line_last_time;
+static int16 line_reading[FILTER_CHANNELS];
+static uint8 line_reading_valid = 0;
+static int32 line_current_fine;	// The last period's current in 256ths of a count
+static uint16 line_periods;		// Counts periods, so a reader sees each new one
+
+// Integrates over cycles periods of hz, 50 or 60; a hz of 0 goes back to the
+// moving average
+int set_line_integration(int hz, int cycles) {
+	if((hz != 0 && hz != 50 && hz != 60) || cycles < 1 || cycles > LINE_MAX_CYCLES)
+		return 0;
+	line_hz = hz;
+	line_cycles = cycles;
+	// Applied by the ADC task, like the filter length
+	new_line_period = hz?(1000000 * cycles) / hz:0;
+	return 1;
+}
+
+int set_line_frequency(int hz) {
+	return set_line_integration(hz, line_cycles);
+}
+
+int get_line_frequency() {
+	return line_hz;
+}
+
+int get_line_cycles() {
+	return line_cycles;
+}
+
+static void integrate_line_cycles(const int16 *mean, uint32 timestamp) {
+	uint32 dt = timestamp - line_last_time;
+	line_last_time = timestamp;
+	if(new_line_period >= 0) {
+		line_period = new_line_period;
+		new_line_period = -1;
+		line_reading_valid = 0;
+		line_elapsed = 0;
+		for(int chan = 0; chan < FILTER_CHANNELS; chan++)
+			line_sum[chan] = 0;
+		return;
+	}
+	if(line_period == 0)
+		return;
+
+	line_elapsed += dt;
+	if(line_elapsed < line_period) {
+		for(int chan = 0; chan < FILTER_CHANNELS; chan++)
+			line_sum[chan] += (int64)mean[chan] * dt;
+		return;
+	}
+
+	// The period ended during this block: its share up to then closes the
+	// period, and the rest opens the next one
+	uint32 excess = line_elapsed - line_period;
+	if(excess >= line_period) {
+		// A gap in the blocks; drop the period and start again
+		line_elapsed = 0;
+		for(int chan = 0; chan < FILTER_CHANNELS; chan++)
+			line_sum[chan] = 0;
+		return;
+	}
+	for(int chan = 0; chan < FILTER_CHANNELS; chan++) {
+		line_sum[chan] += (int64)mean[chan] * (dt - excess);
+		line_reading[chan] = line_sum[chan] / line_period;
+		if(chan == FILTER_CURRENT)
+			line_current_fine = (line_sum[chan] * 256) / line_period;
+		line_sum[chan] = (int64)mean[chan] * excess;
+	}
+	line_elapsed = excess;
+	line_reading_valid = 1;
+	line_periods++;
+}
+
+// The last whole line period's mean current in 256ths of a raw count, finer
+// than the reading's whole counts, for the standby measurement. periods is
+// set to the count of periods so far. Called by the ADC task.
+int32 get_line_current_fine(uint16 *periods) {
+	*periods = line_periods;
+	return line_current_fine;
+}
+
+static void publish_measurement(uint32 timestamp) {
+	int16 raw_current = history_sum[FILTER_CURRENT] >> filter_shift;
+	int16 raw_voltage = history_sum[FILTER_VOLTAGE] >> filter_shift;
+	if(line_period != 0 && line_reading_valid) {
+		raw_current = line_reading[FILTER_CURRENT];
+		raw_voltage = line_reading[FILTER_VOLTAGE];
+	}
+	int current = current_from_raw(raw_current);
+	int voltage = voltage_from_raw(raw_voltage);
+
+	measurement_seq++;
+	latest.timestamp = timestamp;
+	latest.current = current;
+	latest.voltage = voltage;
+	latest.raw_current = raw_current;
+	latest.raw_voltage = raw_voltage;
+	measurement_seq++;
+}
+
+// Charge and energy, integrated from each block's mean over the time since the
+// previous block, by the block timestamps. Kept exact: energy holds whole
+// units of 2^24 pW.us and energy_rem the part of a unit left over, so no
+// rounding piles up however long the test runs. The ADC task is the only
+// writer; readers copy with interrupts masked, and a reset is applied by the
+// ADC task so it never races an update.
+static uint64 charge;		// uA.us
+static uint64 energy;		// 2^24 pW.us, about 16.8pJ
+static uint32 energy_rem;
+static uint64 energy_time;	// us
+static uint32 last_block_time;
+static volatile uint8 energy_reset_pending = 1;
+static energy_totals energy_carried;	// Starts the totals at the next reset, after a power fail
+
+#define ENERGY_SHIFT 24
+
+static void integrate_block(const int16 *mean, uint32 timestamp) {
+	uint32 dt = timestamp - last_block_time;
+	last_block_time = timestamp;
+	if(energy_reset_pending) {
+		energy_reset_pending = 0;
+		charge = (uint64)energy_carried.charge * 3600000000ULL;
+		energy = (uint64)energy_carried.energy * (3600000000000000ULL >> ENERGY_SHIFT);
+		energy_time = (uint64)energy_carried.seconds * 1000000;
+		energy_rem = 0;
+		energy_carried = (energy_totals){0, 0, 0};
+		return;
+	}
+
+	int current = current_from_raw(mean[FILTER_CURRENT]);
+	int voltage = voltage_from_raw(mean[FILTER_VOLTAGE]);
+	if(current < 0)
+		current = 0;
+	if(voltage < 0)
+		voltage = 0;
+
+	// Split the power so neither product can overflow, whatever dt is
+	uint64 power = (uint64)current * (uint32)voltage;	// pW
+	uint64 rem = energy_rem + (uint64)(uint32)(power & ((1 << ENERGY_SHIFT) - 1)) * dt;
+	uint8 int_state = CyEnterCriticalSection();
+	charge += (uint64)(uint32)current * dt;
+	energy += (power >> ENERGY_SHIFT) * dt + (rem >> ENERGY_SHIFT);
+	energy_time += dt;
+	CyExitCriticalSection(int_state);
+	energy_rem = rem & ((1 << ENERGY_SHIFT) - 1);
+}
+
+void get_energy_totals(energy_totals *totals) {
+	uint8 int_state = CyEnterCriticalSection();
+	uint64 c = charge, e = energy, t = energy_time;
+	CyExitCriticalSection(int_state);
+
+	totals->charge = c / 3600000000ULL;
+	// 1uWh is 3.6e15 pW.us
+	totals->energy = e / (3600000000000000ULL >> ENERGY_SHIFT);
+	totals->seconds = t / 1000000;
+}
+
+void reset_energy_totals() {
+	energy_reset_pending = 1;
+}
+
+// Carries totals over from before a power fail. Called before the scheduler
+// starts, so the ADC task applies them with its first block.
+void set_energy_totals(const energy_totals *totals) {
+	energy_carried = *totals;
+	energy_reset_pending = 1;
+}
+
+// Copies out the readings from the most recent block
+// The ADC offsets drift with temperature, so they're tracked while the output
+// is off, the one time the current must read zero. The hardware can't see
+// whether anything is on the terminals, so the voltage is taken as open only
+// then too, and only while it reads within AUTOZERO_WINDOW of the offset.
+// Each update is the mean of AUTOZERO_BLOCKS such blocks, and stays in RAM. An
+// update more than AUTOZERO_RANGE from the calibrated offset is rejected, so
+// an attached source of a few millivolts can't walk the offset away; the
+// calibrated offset is whatever was set other than here.
+static int32 zero_sum[FILTER_CHANNELS];
+static uint8 zero_blocks[FILTER_CHANNELS];
+static int zero_calibrated[FILTER_CHANNELS];
+static int zero_tracked[FILTER_CHANNELS];	// The last update, to tell a calibration from it
+
+static void autozero_reset(int channel) {
+	zero_sum[channel] = zero_blocks[channel] = 0;
+}
+
+static void autozero_channel(int channel, int16 raw, const int *offset) {
+	if(*offset != zero_tracked[channel])
+		zero_calibrated[channel] = zero_tracked[channel] = *offset;
+	if(abs(raw - *offset) > AUTOZERO_WINDOW) {
+		autozero_reset(channel);
+		return;
+	}
+	zero_sum[channel] += raw;
+	if(++zero_blocks[channel] < AUTOZERO_BLOCKS)
+		return;
+
+	int32 sum = zero_sum[channel];
+	int new_offset = (sum + ((sum < 0)?-AUTOZERO_BLOCKS:AUTOZERO_BLOCKS) / 2) / AUTOZERO_BLOCKS;
+	autozero_reset(channel);
+	if(abs(new_offset - zero_calibrated[channel]) > AUTOZERO_RANGE)
+		return;
+	zero_tracked[channel] = new_offset;
+	settings_write_volatile(&new_offset, offset, sizeof(int));
+}
+
+static void autozero_block(const int16 *mean) {
+	if(get_output_mode() != OUTPUT_MODE_OFF) {
+		autozero_reset(FILTER_VOLTAGE);
+		autozero_reset(FILTER_CURRENT);
+		return;
+	}
+	autozero_channel(FILTER_VOLTAGE, mean[FILTER_VOLTAGE], &settings->adc_voltage_offset);
+	autozero_channel(FILTER_CURRENT, mean[FILTER_CURRENT], &settings->adc_current_offset);
+}
+
+void get_measurement(measurement *m) {
+	uint16 seq;
+	do {
+		seq = measurement_seq;
+		*m = latest;
+	} while((seq & 1) || seq != measurement_seq);
+}
+
+#ifdef USE_STREAM
+void set_stream_interval(int blocks) {
+	if(blocks < 0)
+		blocks = 0;
+	if(blocks > 255)
+		blocks = 255;
+	stream_countdown = 0;
+	stream_dropped = 0;
+	stream_interval = blocks;
+}
+
+int get_stream_interval() {
+	return stream_interval;
+}
+
+// Channels is a mask of stream_channel, 0 for plain stream_records, and every
+// has an entry per channel, 1 to 255. Takes effect with the next record.
+void set_stream_channels(uint8 channels, const uint8 *every) {
+	uint8 interval = stream_interval;
+	stream_interval = 0;
+	for(int i = 0; i < STREAM_CHANNELS; i++) {
+		stream_every[i] = every[i]?every[i]:1;
+		stream_due[i] = 0;
+	}
+	stream_channels = channels;
+	stream_interval = interval;
+}
+
+uint8 get_stream_channels() {
+	return stream_channels;
+}
+
+int get_stream_every(int channel) {
+	return stream_every[channel];
+}
+
+// The comms task packs the sample into the record, so the CRC and the
+// channel layout cost this task nothing
+static void stream_block(const int16 (*scans)[ADC_RING_CHANNELS], uint32 timestamp, uint8 flags) {
+	if(stream_interval == 0 || stream_countdown-- > 0)
+		return;
+	stream_countdown = stream_interval - 1;
+
+	stream_sample sample = {
+		.sync = STREAM_SYNC,
+		.sequence = stream_sequence++,
+		.dropped = stream_dropped,
+		.timestamp = timestamp,
+		.current = get_current_usage_fast(),
+		.voltage = get_voltage_fast(),
+		.flags = flags,
+	};
+	if(stream_channels) {
+		sample.sync = STREAM_SYNC_CHANNELS;
+		for(int i = 0; i < STREAM_CHANNELS; i++) {
+			if(!(stream_channels & (1 << i)) || stream_due[i]-- > 0)
+				continue;
+			stream_due[i] = stream_every[i] - 1;
+			sample.present |= 1 << i;
+		}
+		sample.setpoint = state.current_setpoint;
+		sample.temperature = get_temperature();
+		sample.opamp = scans[ADC_BLOCK_SCANS - 1][ADC_CHAN_OPAMP_OUT];
+		sample.fet = scans[ADC_BLOCK_SCANS - 1][ADC_CHAN_FET_IN];
+		sample.mode = state.load_mode | (get_output_mode() << 4);
+	}
+
+	// If the comms task is behind, drop the record; the host sees a sequence gap
+	if(xQueueSendToBack(stream_queue, &sample, 0) == pdPASS) {
+		defer_post(DEFER_STREAM_DATA);
+		uint8 waiting = uxQueueMessagesWaiting(stream_queue);
+		if(waiting > stream_queue_peak)
+			stream_queue_peak = waiting;
+	} else {
+		stream_dropped++;
+	}
+}
+#else
+void set_stream_interval(int blocks) {
+}
+
+int get_stream_interval() {
+	return 0;
+}
+
+void set_stream_channels(uint8 channels, const uint8 *every) {
+}
+
+uint8 get_stream_channels() {
+	return 0;
+}
+
+int get_stream_every(int channel) {
+	return 1;
+}
+#endif
+
+void set_monitor_interval(uint32 interval) {
+	monitor_interval = 0;
+	next_monitor = get_time_us() + interval;
+	monitor_interval = interval;
+}
+
+static void monitor_block(uint32 timestamp) {
+	uint32 interval = monitor_interval;
+	if(interval == 0 || (int32)(timestamp - next_monitor) < 0)
+		return;
+
+	// Stay on the original schedule, unless the interval is shorter than a block
+	next_monitor += interval;
+	if((int32)(timestamp - next_monitor) >= 0)
+		next_monitor = timestamp + interval;
+
+	defer_post(DEFER_MONITOR_DATA);
+}
+
+void vTaskADC(void *pvParameters) {
+	uint8 block;
+
+	while(1) {
+		if(xQueueReceive(adc_queue, &block, portMAX_DELAY)) {
+			watchdog_heartbeat(WATCHDOG_TASK_ADC);
+			defer_run();
+			process_block(block_mean[block / ADC_BLOCK_SCANS]);
+			integrate_line_cycles(block_mean[block / ADC_BLOCK_SCANS], adc_block_time[block / ADC_BLOCK_SCANS]);
+			publish_measurement(adc_block_time[block / ADC_BLOCK_SCANS]);
+			integrate_block(block_mean[block / ADC_BLOCK_SCANS], adc_block_time[block / ADC_BLOCK_SCANS]);
+			autozero_block(block_mean[block / ADC_BLOCK_SCANS]);
+			trim_block(block_mean[block / ADC_BLOCK_SCANS]);
+			statistics_block(&adc_ring[block]);
+			ripple_block(&adc_ring[block], adc_block_time[block / ADC_BLOCK_SCANS]);
+			impedance_block(&adc_ring[block]);
+			thermal_block(block_mean[block / ADC_BLOCK_SCANS], adc_block_time[block / ADC_BLOCK_SCANS]);
+			battery_block(block_mean[block / ADC_BLOCK_SCANS][FILTER_VOLTAGE]);
+			sequence_block(block_mean[block / ADC_BLOCK_SCANS]);
+			sweep_block(block_mean[block / ADC_BLOCK_SCANS]);
+			mppt_block(block_mean[block / ADC_BLOCK_SCANS]);
+			ir_block(block_mean[block / ADC_BLOCK_SCANS], adc_block_flags[block / ADC_BLOCK_SCANS]);
+			tune_block(block_mean[block / ADC_BLOCK_SCANS]);
+			loadreg_block(block_mean[block / ADC_BLOCK_SCANS], adc_block_time[block / ADC_BLOCK_SCANS]);
+			standby_block(block_mean[block / ADC_BLOCK_SCANS]);
+			watch_block(block_mean[block / ADC_BLOCK_SCANS]);
+			ocp_block(&adc_ring[block], block_mean[block / ADC_BLOCK_SCANS], adc_block_time[block / ADC_BLOCK_SCANS]);
+#ifdef USE_STREAM
+			stream_block(&adc_ring[block], adc_block_time[block / ADC_BLOCK_SCANS], adc_block_flags[block / ADC_BLOCK_SCANS]);
+#endif
+			datalog_block();
+			monitor_block(adc_block_time[block / ADC_BLOCK_SCANS]);
+			short_block();
+			notify_block();
+		}
+	}
 }
 
 int16 get_raw_current_usage() {
-	return total_current >> ADC_MIX_RATIO;
+	measurement m;
+	get_measurement(&m);
+	return m.raw_current;
 }
 
 int get_current_usage() {
-	int ret = ((total_current >> ADC_MIX_RATIO) - settings->adc_current_offset) * settings->adc_current_gain;
-	return (ret < 0)?0:ret;
+	measurement m;
+	get_measurement(&m);
+	return m.current;
+}
+
+int get_current_usage_fast() {
+	return current_from_raw(fast_reading[FILTER_CURRENT]);
 }
 
 int16 get_raw_voltage() {
-	return total_voltage >> ADC_MIX_RATIO;
+	measurement m;
+	get_measurement(&m);
+	return m.raw_voltage;
 }
 
 int get_voltage() {
-	int ret = ((total_voltage >> ADC_MIX_RATIO) - settings->adc_voltage_offset) * settings->adc_voltage_gain;
-	return (ret < 0)?0:ret;
+	measurement m;
+	get_measurement(&m);
+	return m.voltage;
+}
+
+int get_voltage_fast() {
+	return voltage_from_raw(fast_reading[FILTER_VOLTAGE]);
+}
+
+int16 get_raw_voltage_fast() {
+	return fast_reading[FILTER_VOLTAGE];
 }
 
 /* [] END OF FILE */
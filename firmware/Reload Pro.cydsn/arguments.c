@@ -0,0 +1,95 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <string.h>
+#include "project.h"
+#include "config.h"
+
+
+// Splits serial command arguments and parses them to a command's spec. Kept
+// apart from comms.c as it doesn't touch the hardware, so it builds and is
+// tested on a PC with the rest of firmware/host.
+
+// Returns the next argument, skipping runs of separators, or NULL at the end
+char *next_argument(char **args) {
+	char *arg;
+	do {
+		arg = strsep(args, ARGUMENT_SEPERATORS);
+	} while(arg != NULL && arg[0] == 0);
+	return arg;
+}
+
+// Matches arg against a spec's {a|b|c}, leaving spec after it, and gives
+// the index of the word matched
+static int parse_keyword(const char *arg, const char **spec, int32 *value) {
+	const char *word = *spec + 1;
+	int found = 0;
+	for(int index = 0; !found; index++) {
+		const char *end = word;
+		while(*end != '|' && *end != '}')
+			end++;
+		if(strncmp(arg, word, end - word) == 0 && arg[end - word] == 0) {
+			*value = index;
+			found = 1;
+		}
+		if(*end == '}')
+			break;
+		word = end + 1;
+	}
+	while(**spec != '}')
+		(*spec)++;
+	(*spec)++;
+	return found;
+}
+
+// Parses args to cmd's spec, or writes the error to answer with and returns 0
+int parse_command_args(const command_def *cmd, char *args, command_args *parsed, char *error) {
+	const char *spec = cmd->args;
+	int optional = 0;
+
+	parsed->count = 0;
+	for(;;) {
+		char *arg = next_argument(&args);
+		for(; *spec == '[' || *spec == ']'; spec++) {
+			if(*spec == '[')
+				optional = 1;
+		}
+		if(*spec == 0) {
+			if(arg == NULL)
+				return 1;
+			format(error, "err %s has too many arguments\r\n", cmd->name);
+			return 0;
+		}
+		if(arg == NULL) {
+			if(optional)
+				return 1;
+			format(error, "err %s expects more arguments\r\n", cmd->name);
+			return 0;
+		}
+
+		int32 *value = &parsed->values[parsed->count];
+		int ok;
+		if(*spec == '{') {
+			ok = parse_keyword(arg, &spec, value);
+		} else {
+			ok = parse_quantity(arg, (*spec == 'i')?0:*spec, value);
+			spec++;
+		}
+		if(!ok) {
+			format(error, "err %s argument %d is invalid\r\n", cmd->name, parsed->count + 1);
+			return 0;
+		}
+		parsed->count++;
+	}
+}
+
+/* [] END OF FILE */
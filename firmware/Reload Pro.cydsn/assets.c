@@ -0,0 +1,579 @@
+#include "assets.h"
+
+const uint8 asset_data[] = {
+    // 0-309: splashscreen 0
+    0x00, 0x00, 0xE0, 0x08, 0x00, 0x02, 0xE0, 0x00, 0xE0, 0xA0,
+    0x00, 0x00, 0x60, 0xE0, 0x10, 0x00, 0x09, 0xA0, 0x60, 0xE0,
+    0xC0, 0xE0, 0xE0, 0xC0, 0x80, 0xE0, 0xC0, 0xC0, 0x35, 0x04,
+    0x00, 0x80, 0x00, 0x80, 0x80, 0x20, 0x03, 0xE0, 0x09, 0x00,
+    0x80, 0x16, 0x20, 0x20, 0xA0, 0x28, 0xC0, 0x24, 0x40, 0x13,
+    0x02, 0xF0, 0x00, 0xF0, 0x40, 0x00, 0x02, 0xE0, 0xF0, 0xF0,
+    0xA0, 0x1C, 0xC0, 0x23, 0x40, 0x01, 0xE0, 0x10, 0x00, 0x40,
+    0x1B, 0x20, 0x23, 0x80, 0x27, 0xE0, 0x14, 0x00, 0x40, 0x20,
+    0x60, 0x28, 0x40, 0x2B, 0xE0, 0x10, 0x2D, 0x02, 0xF0, 0xE0,
+    0xF0, 0x60, 0x00, 0x01, 0x00, 0x00, 0x20, 0x02, 0xE0, 0x0C,
+    0x00, 0x02, 0xE0, 0x00, 0xE0, 0xA0, 0x00, 0x00, 0x60, 0xE0,
+    0x12, 0x00, 0x02, 0xE0, 0xE0, 0xC0, 0x60, 0x01, 0x02, 0x00,
+    0x00, 0xC0, 0xE0, 0x02, 0x2F, 0x00, 0xA0, 0xE0, 0x10, 0x2F,
+    0x40, 0x1B, 0x20, 0x2E, 0x05, 0xE0, 0xC0, 0x80, 0xE0, 0xC0,
+    0x00, 0x20, 0x00, 0x01, 0xC0, 0x80, 0x40, 0x0C, 0x00, 0xC0,
+    0x20, 0x33, 0x00, 0xE0, 0xE0, 0x10, 0x31, 0x40, 0x1B, 0x40,
+    0x23, 0x40, 0x2B, 0x00, 0x00, 0xE0, 0x09, 0x00, 0x03, 0x80,
+    0x80, 0x80, 0x40, 0x20, 0x1D, 0x11, 0x60, 0xE0, 0x30, 0x64,
+    0x7A, 0x74, 0x1A, 0x0C, 0x07, 0x1E, 0x0A, 0x01, 0x08, 0x1A,
+    0x04, 0x0A, 0x0E, 0x0E, 0xE0, 0x02, 0x22, 0x20, 0x24, 0x04,
+    0x00, 0xC0, 0xC0, 0xC0, 0xA0, 0x20, 0x26, 0x18, 0x50, 0xE0,
+    0x30, 0x70, 0x28, 0x30, 0x18, 0x0A, 0x14, 0x3C, 0x0F, 0x04,
+    0x00, 0x0F, 0x01, 0x0C, 0x05, 0x0D, 0x06, 0x01, 0x03, 0x0F,
+    0x00, 0x00, 0x02, 0x80, 0x2A, 0x00, 0xFF, 0xA0, 0x01, 0xC0,
+    0x00, 0x06, 0x02, 0x04, 0x02, 0x07, 0x00, 0x0C, 0x07, 0x40,
+    0x27, 0x16, 0x0E, 0x05, 0x09, 0x0F, 0x18, 0x30, 0x18, 0x1E,
+    0x30, 0x60, 0x70, 0x70, 0xE0, 0xFF, 0x40, 0xFF, 0xC0, 0xFF,
+    0x80, 0xFF, 0x80, 0x00, 0x00, 0x20, 0x02, 0xC0, 0x00, 0x19,
+    0x04, 0x06, 0x0E, 0x00, 0x04, 0x0F, 0x0A, 0x01, 0x18, 0x0A,
+    0x1E, 0x28, 0x10, 0x1E, 0x60, 0x30, 0xF4, 0xF2, 0xC0, 0xE0,
+    0x80, 0xC0, 0x80, 0x00, 0x80, 0xC0, 0x40, 0x1D, 0xC0, 0x00,
+    // 310-652: splashscreen 1
+    0x00, 0x00, 0xE0, 0x08, 0x00, 0x02, 0x7F, 0x00, 0x7F, 0x40,
+    0x00, 0x03, 0x3F, 0x7F, 0x7F, 0x0C, 0xE0, 0x05, 0x00, 0x01,
+    0x1C, 0x1C, 0x20, 0x02, 0x0F, 0x3C, 0x1C, 0x3C, 0x3C, 0x7C,
+    0x2C, 0x27, 0x7C, 0x6F, 0x47, 0x67, 0x6F, 0x47, 0x03, 0x07,
+    0x4F, 0x80, 0x33, 0x03, 0x1E, 0x01, 0x3F, 0x3F, 0x80, 0x33,
+    0x00, 0x6D, 0xE0, 0x08, 0x00, 0x02, 0x6E, 0x6D, 0x6F, 0x40,
+    0x00, 0x02, 0x26, 0x6F, 0x6F, 0x80, 0x2B, 0x02, 0x61, 0x00,
+    0x61, 0x40, 0x00, 0x08, 0x20, 0x61, 0x61, 0x00, 0x00, 0x1F,
+    0x20, 0x3F, 0x7F, 0x20, 0x39, 0x20, 0x37, 0x00, 0x60, 0x40,
+    0x00, 0x02, 0x00, 0x20, 0x60, 0x40, 0x21, 0x01, 0x3F, 0x1E,
+    0x20, 0x10, 0x20, 0x02, 0x03, 0x61, 0x61, 0x7E, 0x61, 0xE0,
+    0x07, 0x00, 0x40, 0x13, 0x60, 0x32, 0x0B, 0x1E, 0x7F, 0x3F,
+    0x00, 0x00, 0x1D, 0x00, 0x3D, 0x3D, 0x7D, 0x7D, 0x7D, 0x20,
+    0x03, 0x00, 0x6D, 0xE0, 0x0A, 0x00, 0x00, 0x7F, 0xA0, 0x00,
+    0x08, 0x00, 0x00, 0x7E, 0x00, 0x3F, 0x1E, 0x3F, 0x7F, 0x7F,
+    0x20, 0x02, 0x40, 0x3F, 0xE0, 0x07, 0x00, 0xE0, 0x01, 0x27,
+    0x20, 0x02, 0xE0, 0x0A, 0x00, 0x40, 0x17, 0x20, 0x1E, 0x60,
+    0x3F, 0x00, 0x0C, 0xE0, 0x12, 0x00, 0x04, 0x0F, 0x07, 0x0F,
+    0x0F, 0x07, 0x20, 0x03, 0x03, 0x00, 0x00, 0x03, 0x04, 0x20,
+    0x2B, 0x20, 0x00, 0x40, 0x2F, 0x00, 0x77, 0xE0, 0x06, 0x25,
+    0x16, 0x1C, 0x0C, 0x1C, 0x1C, 0x2C, 0x1C, 0x3C, 0x1C, 0x7C,
+    0x3C, 0x7C, 0x2C, 0x27, 0x7C, 0x6F, 0x47, 0x67, 0x6F, 0x47,
+    0x03, 0x07, 0x4F, 0x00, 0x20, 0x00, 0x01, 0x3F, 0x1F, 0x20,
+    0x34, 0x04, 0x3F, 0x3F, 0x7F, 0x60, 0x60, 0x20, 0x02, 0xE0,
+    0x0E, 0x00, 0x40, 0x1B, 0x40, 0x23, 0x40, 0x2B, 0x00, 0x00,
+    0xE0, 0x06, 0x00, 0x0F, 0x03, 0x04, 0x08, 0x03, 0x3F, 0x5F,
+    0xCF, 0xFF, 0xFC, 0xFB, 0xF1, 0xFD, 0xC0, 0xA0, 0x70, 0xE0,
+    0x20, 0x12, 0x00, 0x80, 0xE0, 0x04, 0x20, 0x04, 0xFE, 0xFE,
+    0xFF, 0xFF, 0xFF, 0x20, 0x03, 0x20, 0x00, 0x04, 0x01, 0xC1,
+    0x3A, 0xF5, 0x00, 0xE0, 0x17, 0x00, 0x00, 0xFF, 0x80, 0x01,
+    0xE0, 0x19, 0x27, 0x05, 0x01, 0xFF, 0xFF, 0x01, 0xE1, 0xFF,
+    0x60, 0x00, 0x04, 0xFE, 0xFE, 0xFF, 0x00, 0xFE, 0xE0, 0x06,
+    0x1F, 0x12, 0x80, 0x00, 0x00, 0xE0, 0xD0, 0xA8, 0xF0, 0xFD,
+    0xFE, 0x7A, 0xFF, 0x1F, 0x27, 0x4F, 0x3F, 0x00, 0x03, 0x00,
+    0x07, 0xC0, 0x1A,
+    // 653-1045: splashscreen 2
+    0x01, 0x00, 0x03, 0xE0, 0x0D, 0x01, 0x04, 0xF8, 0x03, 0x00,
+    0xFB, 0xF8, 0x20, 0x01, 0x01, 0x20, 0x63, 0xE0, 0x01, 0x01,
+    0x04, 0xE0, 0x23, 0x60, 0xE3, 0xC0, 0x20, 0x01, 0x04, 0xE0,
+    0x03, 0x00, 0xE3, 0xE0, 0x20, 0x01, 0xE0, 0x03, 0x2F, 0xE0,
+    0x09, 0x13, 0xC0, 0x17, 0x07, 0x10, 0xE3, 0xF0, 0xE3, 0xF0,
+    0xF3, 0x90, 0xB3, 0xE0, 0x09, 0x01, 0x40, 0x17, 0x20, 0x1F,
+    0x60, 0x33, 0x09, 0xC0, 0xE3, 0xC0, 0xE3, 0xE0, 0x23, 0x60,
+    0xE3, 0x20, 0x63, 0xE0, 0x01, 0x01, 0x05, 0x00, 0x03, 0x60,
+    0x23, 0x20, 0xE3, 0xE0, 0x09, 0x01, 0x00, 0xE0, 0x20, 0x2B,
+    0x03, 0xC0, 0x03, 0x20, 0xC3, 0x40, 0x03, 0x20, 0x0B, 0x20,
+    0x33, 0xE0, 0x09, 0x01, 0x04, 0xF8, 0x03, 0x00, 0xFB, 0xF8,
+    0x20, 0x01, 0xE0, 0x03, 0x13, 0x02, 0xE0, 0x23, 0x60, 0x40,
+    0x39, 0x06, 0xE3, 0x00, 0x03, 0x00, 0x03, 0xE0, 0xE3, 0x20,
+    0x01, 0x20, 0x0F, 0xE0, 0x04, 0x1F, 0x40, 0x1D, 0x0A, 0x03,
+    0x20, 0xC3, 0xD0, 0x23, 0x08, 0xFB, 0xF0, 0xDB, 0xD0, 0xFB,
+    0x40, 0x0B, 0x40, 0x13, 0xC0, 0x1F, 0xC0, 0x01, 0x01, 0xF8,
+    0xFB, 0x20, 0x01, 0x04, 0x03, 0x00, 0xFB, 0x00, 0x03, 0xE0,
+    0x05, 0x01, 0x01, 0xF0, 0xF3, 0x20, 0x01, 0x02, 0x03, 0x00,
+    0xF3, 0x20, 0x0B, 0xE0, 0x0C, 0x01, 0x04, 0x20, 0x03, 0xC0,
+    0xE3, 0x20, 0xE0, 0x06, 0x01, 0x04, 0xE0, 0x23, 0xE0, 0xE3,
+    0xC0, 0x20, 0x01, 0x40, 0x1F, 0x01, 0xF8, 0xFB, 0x20, 0x01,
+    0x04, 0x23, 0x60, 0xFB, 0x20, 0x63, 0xE0, 0x01, 0x01, 0x60,
+    0x1D, 0x0C, 0x03, 0x20, 0xC3, 0xC0, 0xC3, 0xA0, 0xE3, 0xE0,
+    0x03, 0xE0, 0xE3, 0x20, 0xC3, 0x20, 0x35, 0xA0, 0x03, 0x06,
+    0x60, 0x83, 0x60, 0xE3, 0x40, 0x43, 0x20, 0x20, 0x3B, 0xE0,
+    0x05, 0x01, 0x10, 0x03, 0x0F, 0x05, 0x1F, 0x7F, 0xBF, 0x1F,
+    0xFF, 0xFE, 0xFD, 0xF8, 0xFE, 0xE0, 0xD0, 0xB8, 0xF0, 0x80,
+    0x1F, 0x00, 0x80, 0xC0, 0x00, 0x00, 0x80, 0x00, 0x08, 0x17,
+    0x07, 0x1F, 0x3F, 0x1F, 0x1F, 0x3F, 0x7F, 0x3F, 0x7F, 0xFF,
+    0xF0, 0xFF, 0x6E, 0xFF, 0xE0, 0xC0, 0xE0, 0xE0, 0xC0, 0x80,
+    0xC0, 0xC0, 0x80, 0x40, 0x1C, 0x20, 0x03, 0x02, 0x80, 0xC0,
+    0x40, 0x40, 0x11, 0x02, 0xF0, 0xE0, 0xE0, 0x20, 0x02, 0x40,
+    0x03, 0x20, 0x25, 0x40, 0x03, 0x40, 0x0B, 0xC0, 0x03, 0x40,
+    0x33, 0x02, 0x80, 0x40, 0x80, 0x60, 0x32, 0x20, 0x05, 0x17,
+    0xC0, 0xC0, 0xC0, 0xA0, 0xC0, 0xE0, 0xFF, 0xD0, 0xFF, 0xFF,
+    0x7E, 0xF1, 0xFF, 0x3F, 0x7F, 0x7F, 0x7F, 0x1F, 0x3F, 0x1F,
+    0x3F, 0x00, 0x0F, 0x10, 0x20, 0x1E, 0x20, 0x02, 0x14, 0xC0,
+    0x00, 0x80, 0xF0, 0xE8, 0xF4, 0xF8, 0xFE, 0xFD, 0xFF, 0xFF,
+    0x3F, 0x5F, 0xAF, 0x7F, 0x01, 0x36, 0x03, 0x3B, 0x00, 0x30,
+    0xE0, 0x05, 0x01,
+    // 1046-1378: splashscreen 3
+    0x01, 0x00, 0x80, 0xE0, 0x0D, 0x01, 0x04, 0x07, 0x80, 0x00,
+    0x87, 0x07, 0x20, 0x01, 0x01, 0x04, 0x86, 0xE0, 0x01, 0x01,
+    0x11, 0x07, 0x84, 0x02, 0x87, 0x03, 0x87, 0x03, 0x83, 0x03,
+    0x80, 0x04, 0x83, 0x07, 0x93, 0x37, 0x97, 0x14, 0xB6, 0xE0,
+    0x01, 0x01, 0x07, 0x1F, 0xB4, 0x16, 0xBF, 0x1F, 0x8F, 0x1F,
+    0xBF, 0xC0, 0x3F, 0xC0, 0x01, 0x04, 0x07, 0x80, 0x00, 0x87,
+    0x07, 0x20, 0x01, 0x01, 0x00, 0x81, 0xE0, 0x09, 0x01, 0x40,
+    0x17, 0x40, 0x1F, 0x40, 0x27, 0xC0, 0x0B, 0xE0, 0x07, 0x3F,
+    0x08, 0x03, 0x87, 0x03, 0x83, 0x07, 0x85, 0x03, 0x87, 0x05,
+    0xE0, 0x02, 0x01, 0xC0, 0x2B, 0x09, 0x03, 0x80, 0x04, 0x83,
+    0x07, 0x83, 0x07, 0x87, 0x04, 0x86, 0xE0, 0x09, 0x01, 0x20,
+    0x1F, 0x60, 0x27, 0x01, 0x00, 0x80, 0xE0, 0x01, 0x01, 0xE0,
+    0x03, 0x13, 0x40, 0x07, 0x20, 0x0F, 0xE0, 0x01, 0x1F, 0x20,
+    0x00, 0x00, 0x07, 0x40, 0x00, 0x40, 0x06, 0xA0, 0x0A, 0x09,
+    0x03, 0x00, 0x04, 0x03, 0x07, 0x03, 0x07, 0x07, 0x04, 0x06,
+    0xE0, 0x05, 0x01, 0xC0, 0x27, 0x40, 0x33, 0xC0, 0x00, 0xA0,
+    0x3F, 0x40, 0x2C, 0x20, 0x02, 0xE0, 0x0D, 0x01, 0x08, 0x03,
+    0x00, 0x04, 0x03, 0x07, 0x03, 0x07, 0x07, 0x05, 0xE0, 0x01,
+    0x01, 0x40, 0x0C, 0x60, 0x00, 0xE0, 0x0F, 0x3F, 0x40, 0x2F,
+    0x40, 0x37, 0x02, 0x02, 0x05, 0x02, 0x20, 0x2B, 0x00, 0x05,
+    0xE0, 0x08, 0x3B, 0x02, 0x03, 0x06, 0x03, 0x20, 0x3B, 0xE0,
+    0x0D, 0x00, 0x00, 0x01, 0x20, 0x02, 0x0B, 0x01, 0x83, 0x03,
+    0x03, 0x03, 0x87, 0x03, 0x03, 0x07, 0x07, 0x8E, 0x07, 0x1F,
+    0x0E, 0x0F, 0x96, 0x0F, 0x1E, 0x0C, 0x1C, 0x1E, 0x3C, 0x18,
+    0x3C, 0x3C, 0x78, 0x38, 0x35, 0x78, 0x71, 0xFB, 0x70, 0xF9,
+    0xF3, 0xE7, 0x63, 0xF7, 0xE7, 0xCF, 0xEF, 0xEF, 0xFF, 0xCF,
+    0xCE, 0xFF, 0xE0, 0x03, 0x00, 0x00, 0x7F, 0x40, 0x03, 0x80,
+    0x01, 0x00, 0x7F, 0x20, 0x03, 0x40, 0x0C, 0xE0, 0x04, 0x00,
+    0x0D, 0xCF, 0xFF, 0xEE, 0xFF, 0xE7, 0xEF, 0xC7, 0xE7, 0xF3,
+    0xE3, 0x75, 0xF3, 0x79, 0xF7, 0x1F, 0xFA, 0xFF, 0x7C, 0xBB,
+    0x38, 0xFF, 0x1C, 0x3C, 0x3A, 0x3C, 0x1E, 0x0C, 0x0E, 0x1E,
+    0x0E, 0x07, 0x8F, 0x0F, 0x07, 0x07, 0x83, 0x8F, 0x03, 0x83,
+    0x05, 0x83, 0x01, 0x03, 0x81, 0x81, 0x00, 0x01, 0x20, 0x01,
+    0xE0, 0x0E, 0x00,
+    // 1379-1551: splashscreen 4
+    0x01, 0x00, 0x01, 0xE0, 0xF6, 0x01, 0x00, 0xFF, 0xA0, 0x01,
+    0x00, 0x80, 0xE0, 0xB1, 0x01, 0x01, 0x80, 0x00, 0x20, 0x03,
+    0x19, 0xC0, 0xC0, 0xC0, 0xE0, 0xC0, 0xE0, 0xE0, 0x70, 0x60,
+    0xB0, 0xF8, 0x38, 0x38, 0x54, 0x38, 0x1C, 0x0E, 0x3C, 0x1C,
+    0x0E, 0x07, 0x0F, 0x0F, 0x07, 0x03, 0x03, 0x20, 0x02, 0x07,
+    0x87, 0x07, 0x83, 0x07, 0x83, 0x87, 0x83, 0xC7, 0x20, 0x00,
+    0x12, 0xE3, 0xC6, 0xC7, 0xE7, 0xE7, 0xC2, 0xF7, 0xF7, 0xE6,
+    0xEF, 0xF7, 0xFF, 0xFE, 0xF6, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF,
+    0xE0, 0x05, 0x00, 0x0A, 0x7F, 0xFF, 0x3F, 0x5F, 0x3F, 0xFF,
+    0x0F, 0x00, 0x16, 0x0F, 0x00, 0xE0, 0x01, 0x00, 0x07, 0x06,
+    0x0F, 0x17, 0x0A, 0x3F, 0x7F, 0x3F, 0x9F, 0xE0, 0x06, 0x2B,
+    0xA0, 0x3E, 0x1A, 0xF6, 0xFF, 0xFF, 0xF7, 0xEF, 0xF6, 0xFF,
+    0xE7, 0xC7, 0xE2, 0xE7, 0xC7, 0xC3, 0xA6, 0xC7, 0x83, 0xC7,
+    0x87, 0xC7, 0x83, 0x07, 0x03, 0x87, 0x03, 0x03, 0x07, 0x03,
+    0x1F, 0x07, 0x07, 0x03, 0x0F, 0x0E, 0x0E, 0x15, 0x1F, 0x1C,
+    0x3C, 0x0A, 0x1C, 0x38, 0x70, 0x38, 0x78, 0x70, 0xE0, 0xE0,
+    0xF0, 0xC0, 0xE0, 0xE0, 0xE0, 0x80, 0xC0, 0x80, 0xC0, 0x00,
+    0x00, 0x80, 0x00,
+    // 1552-1721: splashscreen 5
+    0x00, 0x00, 0xE0, 0xF7, 0x00, 0x00, 0x01, 0xE0, 0xB5, 0x01,
+    0x10, 0x01, 0x06, 0x02, 0x03, 0x1F, 0x2F, 0x7F, 0x7F, 0xF9,
+    0x67, 0x97, 0xFF, 0x00, 0x01, 0x80, 0x01, 0x00, 0xE0, 0x02,
+    0x00, 0x11, 0x1C, 0xE6, 0x2A, 0x7E, 0xFE, 0xFF, 0xFE, 0xFE,
+    0xFF, 0xE7, 0x1A, 0xFF, 0x07, 0x03, 0x07, 0x87, 0x03, 0x07,
+    0x20, 0x01, 0x40, 0x02, 0x01, 0x03, 0x01, 0x20, 0x05, 0x0A,
+    0x0B, 0x07, 0x1F, 0x0F, 0x2F, 0x1F, 0x7F, 0x3F, 0xBF, 0x7F,
+    0xFF, 0xA0, 0x00, 0x0F, 0xC7, 0xAB, 0xCF, 0xDF, 0x81, 0x90,
+    0xCA, 0x93, 0x80, 0xBE, 0xDC, 0xFC, 0x80, 0xBE, 0xDF, 0xFF,
+    0x20, 0x03, 0x00, 0xFE, 0x60, 0x07, 0xC0, 0x03, 0x0A, 0xBC,
+    0xDA, 0xFC, 0x81, 0xC3, 0x92, 0x87, 0xEF, 0xD7, 0x87, 0xEF,
+    0x80, 0x31, 0x15, 0x7F, 0xFF, 0x3F, 0x7F, 0x1F, 0x7F, 0x1F,
+    0xEF, 0x07, 0xFF, 0x07, 0xFB, 0x03, 0xFF, 0x03, 0x03, 0x01,
+    0x03, 0x03, 0x03, 0x07, 0x07, 0x20, 0x02, 0x20, 0x04, 0x0E,
+    0xE7, 0x97, 0xFF, 0xFE, 0xF7, 0xFF, 0xFE, 0xFE, 0xFF, 0xFE,
+    0x04, 0x3A, 0x48, 0x9C, 0x00, 0xE0, 0x03, 0x00, 0x0A, 0x81,
+    0x61, 0xC1, 0xFF, 0x79, 0x27, 0xFF, 0x0F, 0x17, 0x3E, 0x3F,
+    // 1722-1874: splashscreen 6
+    0x01, 0x00, 0x8C, 0xE0, 0x1A, 0x01, 0xE0, 0xFF, 0x01, 0x00,
+    0x0C, 0xE0, 0x8D, 0x01, 0x10, 0x04, 0x0A, 0x0C, 0x0E, 0x0F,
+    0x00, 0x09, 0x0F, 0x0A, 0x0D, 0x01, 0x1F, 0x04, 0x0A, 0x06,
+    0x06, 0x00, 0xC0, 0x00, 0x06, 0x00, 0x03, 0x01, 0x7F, 0x8F,
+    0x13, 0xFF, 0x40, 0x00, 0x04, 0x80, 0x70, 0x8C, 0xCB, 0x00,
+    0xE0, 0x0E, 0x00, 0x0D, 0x01, 0x00, 0x02, 0x01, 0x07, 0x03,
+    0x0B, 0x07, 0x0F, 0x07, 0x0F, 0x0F, 0x0F, 0x1F, 0x40, 0x02,
+    0x00, 0x1F, 0x20, 0x00, 0x00, 0x3F, 0x20, 0x01, 0x02, 0x1F,
+    0x3F, 0x3F, 0x20, 0x06, 0x60, 0x05, 0x02, 0x1F, 0x2F, 0x1F,
+    0x60, 0x1A, 0x20, 0x1B, 0x09, 0x0F, 0x07, 0x07, 0x0F, 0x03,
+    0x07, 0x01, 0x07, 0x00, 0x01, 0x20, 0x01, 0x40, 0x00, 0x00,
+    0xFF, 0xA0, 0x01, 0xC0, 0x00, 0x07, 0x00, 0x80, 0x00, 0xE0,
+    0x9F, 0x98, 0xFE, 0xFF, 0x20, 0x00, 0x03, 0x0F, 0x71, 0x96,
+    0x3F, 0x20, 0x10, 0xC0, 0x00, 0x10, 0x04, 0x0E, 0xF0, 0x04,
+    0xFE, 0x09, 0xFA, 0x13, 0xFB, 0x0A, 0x05, 0x07, 0x0F, 0x00,
+    0x04, 0x02, 0x0C,
+    // 1875-1972: splashscreen 7
+    0x01, 0x00, 0x01, 0xE0, 0x12, 0x01, 0xE0, 0xFF, 0x01, 0x00,
+    0x7F, 0xA0, 0x01, 0x00, 0x60, 0xE0, 0xAD, 0x01, 0x00, 0x01,
+    0x1F, 0x60, 0x00, 0x61, 0x03, 0x61, 0x01, 0x63, 0x06, 0x63,
+    0x07, 0x67, 0x0C, 0x64, 0x2A, 0x7E, 0x78, 0x10, 0x20, 0x78,
+    0x40, 0x78, 0x90, 0x70, 0x70, 0x00, 0x78, 0x70, 0x00, 0x20,
+    0x10, 0x60, 0x00, 0xE0, 0x31, 0x00, 0x20, 0x3E, 0x1B, 0x40,
+    0x70, 0x70, 0x8F, 0xD8, 0xFF, 0x58, 0xE7, 0xB0, 0xFF, 0x38,
+    0x40, 0x1C, 0x78, 0x0C, 0x06, 0x06, 0x0E, 0x03, 0x06, 0x07,
+    0x07, 0x01, 0x03, 0x01, 0x03, 0x00, 0x01, 0x20, 0x01, 0xE0,
+    0x07, 0x00, 0x00, 0xFF, 0x80, 0x01, 0xC0, 0x0E,
+    // 1973-2028: label_presets 0
+    0x03, 0x00, 0xFE, 0xFE, 0x86, 0x20, 0x00, 0x03, 0xCE, 0xFC,
+    0x78, 0x00, 0x40, 0x00, 0x06, 0xF0, 0xF0, 0x40, 0x30, 0x30,
+    0x30, 0x60, 0x20, 0x09, 0x02, 0x80, 0xE0, 0x70, 0x20, 0x09,
+    0x02, 0x70, 0xE0, 0xC0, 0x20, 0x0B, 0x04, 0xE0, 0xE0, 0xB0,
+    0xB0, 0xB0, 0xE0, 0x0A, 0x17, 0x20, 0x08, 0x02, 0xFE, 0xFE,
+    0x30, 0x20, 0x00, 0xE0, 0x05, 0x23,
+    // 2029-2079: label_presets 1
+    0x03, 0x00, 0x3F, 0x3F, 0x01, 0x40, 0x00, 0x00, 0x00, 0x60,
+    0x00, 0x20, 0x0D, 0xA0, 0x08, 0x04, 0x00, 0x07, 0x1F, 0x1B,
+    0x33, 0x40, 0x00, 0x00, 0x1B, 0x20, 0x0B, 0x01, 0x18, 0x31,
+    0x20, 0x00, 0x03, 0x33, 0x33, 0x1F, 0x1E, 0xE0, 0x03, 0x17,
+    0x80, 0x26, 0x02, 0x1F, 0x3F, 0x30, 0x20, 0x00, 0xE0, 0x05,
+    0x23,
+    // 2080-2137: label_c_c_load 0
+    0x05, 0x00, 0xF0, 0xF8, 0x1C, 0x0E, 0x06, 0x20, 0x00, 0x01,
+    0x0C, 0x00, 0x80, 0x00, 0x04, 0xC0, 0xF0, 0x3C, 0x0E, 0x02,
+    0x20, 0x07, 0xE0, 0x07, 0x17, 0xC0, 0x00, 0x01, 0xFE, 0xFE,
+    0x20, 0x04, 0xC0, 0x2B, 0x07, 0xE0, 0x70, 0x30, 0x30, 0x30,
+    0x70, 0xE0, 0xC0, 0x40, 0x0C, 0x01, 0x60, 0x30, 0xA0, 0x0B,
+    0xC0, 0x17, 0x04, 0x60, 0xFF, 0xFF, 0x00, 0x00,
+    // 2138-2201: label_c_c_load 1
+    0x05, 0x00, 0x07, 0x0F, 0x1C, 0x38, 0x30, 0x20, 0x00, 0x0A,
+    0x18, 0x00, 0x00, 0x00, 0x80, 0xE0, 0x78, 0x1F, 0x07, 0x01,
+    0x00, 0x40, 0x00, 0xE0, 0x02, 0x17, 0xE0, 0x05, 0x00, 0x02,
+    0x3F, 0x3F, 0x30, 0x80, 0x00, 0x20, 0x0B, 0x01, 0x0F, 0x1F,
+    0x40, 0x22, 0x02, 0x38, 0x1F, 0x0F, 0x20, 0x0B, 0x02, 0x1E,
+    0x3E, 0x33, 0x20, 0x00, 0x02, 0x1B, 0x3F, 0x3F, 0x80, 0x17,
+    0x40, 0x39, 0x40, 0x0B,
+    // 2202-2268: label_c_v_load 0
+    0x05, 0x00, 0xF0, 0xF8, 0x1C, 0x0E, 0x06, 0x20, 0x00, 0x01,
+    0x0C, 0x00, 0x80, 0x00, 0x04, 0xC0, 0xF0, 0x3C, 0x0E, 0x02,
+    0x20, 0x07, 0x08, 0x06, 0x7E, 0xF8, 0xC0, 0x00, 0xC0, 0xF8,
+    0x7E, 0x06, 0xA0, 0x17, 0xC0, 0x00, 0x01, 0xFE, 0xFE, 0x20,
+    0x04, 0xC0, 0x2B, 0x07, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x70,
+    0xE0, 0xC0, 0x40, 0x0C, 0x01, 0x60, 0x30, 0xA0, 0x0B, 0xC0,
+    0x17, 0x04, 0x60, 0xFF, 0xFF, 0x00, 0x00,
+    // 2269-2337: label_c_v_load 1
+    0x05, 0x00, 0x07, 0x0F, 0x1C, 0x38, 0x30, 0x20, 0x00, 0x0A,
+    0x18, 0x00, 0x00, 0x00, 0x80, 0xE0, 0x78, 0x1F, 0x07, 0x01,
+    0x00, 0xA0, 0x00, 0x05, 0x03, 0x3F, 0x3C, 0x3F, 0x03, 0x00,
+    0xE0, 0x07, 0x00, 0x02, 0x3F, 0x3F, 0x30, 0x80, 0x00, 0x20,
+    0x0B, 0x01, 0x0F, 0x1F, 0x40, 0x3A, 0x02, 0x38, 0x1F, 0x0F,
+    0x20, 0x0B, 0x02, 0x1E, 0x3E, 0x33, 0x20, 0x00, 0x02, 0x1B,
+    0x3F, 0x3F, 0xC0, 0x17, 0x01, 0x30, 0x18, 0x40, 0x0B,
+    // 2338-2403: label_c_r_load 0
+    0x05, 0x00, 0xF0, 0xF8, 0x1C, 0x0E, 0x06, 0x20, 0x00, 0x01,
+    0x0C, 0x00, 0x80, 0x00, 0x04, 0xC0, 0xF0, 0x3C, 0x0E, 0x02,
+    0x20, 0x07, 0x02, 0xFE, 0xFE, 0x86, 0x20, 0x00, 0x02, 0xCE,
+    0xFC, 0x78, 0x40, 0x14, 0xC0, 0x00, 0x60, 0x17, 0x20, 0x04,
+    0xC0, 0x2B, 0x07, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x70, 0xE0,
+    0xC0, 0x40, 0x0C, 0x01, 0x60, 0x30, 0xA0, 0x0B, 0xC0, 0x17,
+    0x04, 0x60, 0xFF, 0xFF, 0x00, 0x00,
+    // 2404-2476: label_c_r_load 1
+    0x05, 0x00, 0x07, 0x0F, 0x1C, 0x38, 0x30, 0x20, 0x00, 0x0A,
+    0x18, 0x00, 0x00, 0x00, 0x80, 0xE0, 0x78, 0x1F, 0x07, 0x01,
+    0x00, 0x60, 0x00, 0x02, 0x3F, 0x3F, 0x01, 0x20, 0x00, 0x04,
+    0x07, 0x1E, 0x3C, 0x20, 0x00, 0xA0, 0x00, 0xC0, 0x17, 0x00,
+    0x30, 0x80, 0x00, 0x20, 0x0B, 0x01, 0x0F, 0x1F, 0x40, 0x3A,
+    0x02, 0x38, 0x1F, 0x0F, 0x20, 0x0B, 0x02, 0x1E, 0x3E, 0x33,
+    0x20, 0x00, 0x02, 0x1B, 0x3F, 0x3F, 0xC0, 0x17, 0x01, 0x30,
+    0x18, 0x40, 0x0B,
+    // 2477-2542: label_c_p_load 0
+    0x05, 0x00, 0xF0, 0xF8, 0x1C, 0x0E, 0x06, 0x20, 0x00, 0x01,
+    0x0C, 0x00, 0x80, 0x00, 0x04, 0xC0, 0xF0, 0x3C, 0x0E, 0x02,
+    0x20, 0x07, 0x02, 0xFE, 0xFE, 0x86, 0x20, 0x00, 0x02, 0xCE,
+    0xFC, 0x78, 0x40, 0x14, 0xC0, 0x00, 0x60, 0x17, 0x20, 0x04,
+    0xC0, 0x2B, 0x07, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x70, 0xE0,
+    0xC0, 0x40, 0x0C, 0x01, 0x60, 0x30, 0xA0, 0x0B, 0xC0, 0x17,
+    0x04, 0x60, 0xFF, 0xFF, 0x00, 0x00,
+    // 2543-2611: label_c_p_load 1
+    0x05, 0x00, 0x07, 0x0F, 0x1C, 0x38, 0x30, 0x20, 0x00, 0x0A,
+    0x18, 0x00, 0x00, 0x00, 0x80, 0xE0, 0x78, 0x1F, 0x07, 0x01,
+    0x00, 0x60, 0x00, 0x02, 0x3F, 0x3F, 0x01, 0x20, 0x00, 0x40,
+    0x0C, 0xC0, 0x00, 0xC0, 0x17, 0x00, 0x30, 0x80, 0x00, 0x20,
+    0x0B, 0x01, 0x0F, 0x1F, 0x40, 0x3A, 0x02, 0x38, 0x1F, 0x0F,
+    0x20, 0x0B, 0x02, 0x1E, 0x3E, 0x33, 0x20, 0x00, 0x02, 0x1B,
+    0x3F, 0x3F, 0xC0, 0x17, 0x01, 0x30, 0x18, 0x40, 0x0B,
+    // 2612-2690: label_pulse_load 0
+    0x03, 0x00, 0xFE, 0xFE, 0x86, 0x20, 0x00, 0x07, 0xCE, 0xFC,
+    0x78, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x20, 0x04, 0xA0, 0x06,
+    0x05, 0x03, 0x03, 0x03, 0xFF, 0xFF, 0x00, 0x80, 0x00, 0x08,
+    0xE0, 0xE0, 0xB0, 0xB0, 0xB0, 0x30, 0x30, 0x30, 0x60, 0x20,
+    0x0B, 0x02, 0x80, 0xE0, 0x70, 0x20, 0x09, 0x02, 0x70, 0xE0,
+    0xC0, 0xA0, 0x1B, 0xC0, 0x00, 0x01, 0xFE, 0xFE, 0xE0, 0x01,
+    0x0B, 0x00, 0xC0, 0xE0, 0x03, 0x23, 0x01, 0x60, 0x30, 0xA0,
+    0x0B, 0xC0, 0x17, 0x04, 0x60, 0xFF, 0xFF, 0x00, 0x00,
+    // 2691-2780: label_pulse_load 1
+    0x03, 0x00, 0x3F, 0x3F, 0x01, 0x40, 0x00, 0x00, 0x00, 0x40,
+    0x00, 0x09, 0x0F, 0x1F, 0x38, 0x30, 0x30, 0x10, 0x18, 0x3F,
+    0x3F, 0x00, 0x80, 0x0E, 0x03, 0x3F, 0x30, 0x30, 0x30, 0x40,
+    0x08, 0x01, 0x18, 0x31, 0x20, 0x00, 0x03, 0x33, 0x33, 0x1F,
+    0x1E, 0x20, 0x0B, 0x03, 0x07, 0x1F, 0x1B, 0x33, 0x40, 0x00,
+    0x01, 0x1B, 0x00, 0xE0, 0x05, 0x00, 0x00, 0x3F, 0x20, 0x2C,
+    0x60, 0x00, 0x40, 0x38, 0x01, 0x1F, 0x38, 0x20, 0x08, 0x02,
+    0x38, 0x1F, 0x0F, 0x20, 0x0B, 0x01, 0x1E, 0x3E, 0x60, 0x2D,
+    0x01, 0x3F, 0x3F, 0xC0, 0x17, 0x01, 0x30, 0x18, 0x40, 0x0B,
+    // 2781-2826: label_graph 0
+    0x0A, 0x00, 0xF0, 0xF8, 0x1C, 0x0E, 0x06, 0xC6, 0xC6, 0xC6,
+    0xCC, 0x00, 0x40, 0x00, 0x06, 0xF0, 0xF0, 0x40, 0x30, 0x30,
+    0x30, 0x60, 0x40, 0x0A, 0x00, 0x60, 0x20, 0x08, 0x03, 0x30,
+    0x70, 0xE0, 0xC0, 0x60, 0x15, 0x20, 0x0C, 0xA0, 0x0B, 0x03,
+    0xFF, 0xFF, 0x60, 0x20, 0xA0, 0x0B,
+    // 2827-2870: label_graph 1
+    0x04, 0x00, 0x07, 0x0F, 0x1C, 0x30, 0x20, 0x00, 0x02, 0x1F,
+    0x1F, 0x00, 0x40, 0x00, 0x02, 0x3F, 0x3F, 0x00, 0xA0, 0x00,
+    0x02, 0x1E, 0x3E, 0x33, 0x20, 0x00, 0x00, 0x1B, 0x60, 0x10,
+    0x08, 0xFF, 0xFF, 0x0C, 0x18, 0x18, 0x18, 0x1C, 0x0F, 0x07,
+    0x80, 0x21, 0xC0, 0x28,
+    // 2871-2967: label_battery_test 0
+    0x03, 0x00, 0xFE, 0xFE, 0xC6, 0x40, 0x00, 0x02, 0xFC, 0x38,
+    0x00, 0x20, 0x00, 0x01, 0x60, 0x30, 0x20, 0x00, 0x02, 0x70,
+    0xE0, 0xC0, 0x20, 0x0A, 0x20, 0x08, 0x01, 0xFE, 0xFE, 0x40,
+    0x0E, 0xE0, 0x06, 0x0B, 0x02, 0x80, 0xE0, 0x70, 0xA0, 0x23,
+    0x40, 0x00, 0x02, 0xF0, 0xF0, 0x40, 0x20, 0x0D, 0x00, 0x60,
+    0x20, 0x09, 0x09, 0x10, 0xF0, 0xE0, 0x80, 0x00, 0x00, 0xE0,
+    0xF0, 0x10, 0x00, 0xE0, 0x05, 0x00, 0x00, 0x06, 0x20, 0x00,
+    0x01, 0xFE, 0xFE, 0x40, 0x05, 0xE0, 0x05, 0x3B, 0x04, 0xE0,
+    0xE0, 0xB0, 0xB0, 0xB0, 0xA0, 0x3B, 0x20, 0x06, 0x01, 0xFE,
+    0xFE, 0x20, 0x04, 0x02, 0x30, 0x00, 0x00,
+    // 2968-3050: label_battery_test 1
+    0x03, 0x00, 0x3F, 0x3F, 0x30, 0x20, 0x00, 0x08, 0x39, 0x1F,
+    0x0F, 0x00, 0x00, 0x00, 0x1E, 0x3E, 0x33, 0x20, 0x00, 0x03,
+    0x1B, 0x3F, 0x3F, 0x00, 0x60, 0x00, 0x00, 0x1F, 0x60, 0x1A,
+    0xE0, 0x06, 0x0B, 0x03, 0x07, 0x1F, 0x1B, 0x33, 0x60, 0x25,
+    0x60, 0x16, 0x20, 0x2A, 0xC0, 0x00, 0x06, 0xC0, 0xC3, 0xEF,
+    0x7C, 0x3F, 0x07, 0x00, 0xE0, 0x08, 0x00, 0xC0, 0x25, 0xE0,
+    0x06, 0x3B, 0x01, 0x18, 0x31, 0x20, 0x00, 0x03, 0x33, 0x33,
+    0x1F, 0x1E, 0x80, 0x1A, 0x02, 0x1F, 0x3F, 0x30, 0x20, 0x00,
+    0x01, 0x00, 0x00,
+    // 3051-3121: label_i_v_sweep 0
+    0x06, 0x00, 0x00, 0x06, 0x06, 0x06, 0xFE, 0xFE, 0x20, 0x04,
+    0x00, 0x00, 0xE0, 0x05, 0x00, 0x07, 0x06, 0x7E, 0xF8, 0xC0,
+    0x00, 0xC0, 0xF8, 0x7E, 0xE0, 0x07, 0x17, 0x07, 0x38, 0x7C,
+    0xCE, 0xC6, 0xC6, 0xC6, 0x86, 0x8C, 0x20, 0x0A, 0x0A, 0x30,
+    0xF0, 0xC0, 0x00, 0x00, 0x80, 0x00, 0x00, 0xC0, 0xF0, 0x30,
+    0x20, 0x07, 0x06, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x70, 0xE0,
+    0x20, 0x12, 0xE0, 0x04, 0x0B, 0x02, 0xF0, 0xF0, 0x60, 0xC0,
+    0x0B,
+    // 3122-3193: label_i_v_sweep 1
+    0x06, 0x00, 0x00, 0x30, 0x30, 0x30, 0x3F, 0x3F, 0x20, 0x04,
+    0x00, 0x00, 0x40, 0x00, 0x00, 0x03, 0x40, 0x00, 0x20, 0x07,
+    0x60, 0x0B, 0x02, 0x3F, 0x3C, 0x3F, 0x20, 0x0B, 0xE0, 0x06,
+    0x00, 0x01, 0x18, 0x30, 0x40, 0x00, 0x02, 0x39, 0x1F, 0x0F,
+    0x80, 0x21, 0x02, 0x0F, 0x01, 0x0F, 0x80, 0x25, 0x03, 0x07,
+    0x1F, 0x1B, 0x33, 0x40, 0x00, 0x00, 0x1B, 0xE0, 0x06, 0x0B,
+    0x0A, 0xFF, 0xFF, 0x0C, 0x18, 0x18, 0x18, 0x1C, 0x0F, 0x07,
+    0x00, 0x00,
+    // 3194-3230: label_mppt 0
+    0x0B, 0x00, 0xFE, 0xFE, 0x1E, 0xF0, 0x80, 0xF0, 0x1E, 0xFE,
+    0xFE, 0x00, 0x00, 0x20, 0x0B, 0x00, 0x86, 0x20, 0x00, 0x02,
+    0xCE, 0xFC, 0x78, 0xE0, 0x06, 0x0B, 0x00, 0x06, 0x20, 0x00,
+    0x01, 0xFE, 0xFE, 0x40, 0x05, 0x00, 0x00,
+    // 3231-3255: label_mppt 1
+    0x06, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x01, 0x00, 0x40, 0x06,
+    0x40, 0x04, 0x00, 0x01, 0x20, 0x00, 0x20, 0x0D, 0xE0, 0x05,
+    0x0B, 0xA0, 0x0F, 0x60, 0x06,
+    // 3256-3323: label_ir_test 0
+    0x06, 0x00, 0x00, 0x06, 0x06, 0x06, 0xFE, 0xFE, 0x20, 0x04,
+    0x05, 0x00, 0x00, 0x00, 0xFE, 0xFE, 0x86, 0x20, 0x00, 0x03,
+    0xCE, 0xFC, 0x78, 0x00, 0xE0, 0x03, 0x00, 0x20, 0x22, 0x80,
+    0x23, 0x60, 0x24, 0x08, 0x80, 0xE0, 0x70, 0x30, 0x30, 0x30,
+    0x70, 0xE0, 0xC0, 0x20, 0x17, 0x04, 0xE0, 0xE0, 0xB0, 0xB0,
+    0xB0, 0x20, 0x0D, 0x00, 0x60, 0x20, 0x0B, 0x20, 0x06, 0x01,
+    0xFE, 0xFE, 0x20, 0x04, 0x02, 0x30, 0x00, 0x00,
+    // 3324-3387: label_ir_test 1
+    0x06, 0x00, 0x00, 0x30, 0x30, 0x30, 0x3F, 0x3F, 0x20, 0x04,
+    0x05, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x01, 0x20, 0x00, 0x04,
+    0x07, 0x1E, 0x3C, 0x20, 0x00, 0xE0, 0x05, 0x00, 0x60, 0x1B,
+    0x80, 0x07, 0x03, 0x07, 0x1F, 0x1B, 0x33, 0x40, 0x00, 0x00,
+    0x1B, 0x20, 0x0B, 0x01, 0x18, 0x31, 0x20, 0x00, 0x03, 0x33,
+    0x33, 0x1F, 0x1E, 0x80, 0x1A, 0x02, 0x1F, 0x3F, 0x30, 0x20,
+    0x00, 0x01, 0x00, 0x00,
+    // 3388-3442: label_layout 0
+    0x03, 0x00, 0xFE, 0xFE, 0x00, 0xE0, 0x01, 0x00, 0x01, 0x60,
+    0x30, 0x20, 0x00, 0x02, 0x70, 0xE0, 0xC0, 0x20, 0x0A, 0x08,
+    0x10, 0xF0, 0xE0, 0x80, 0x00, 0x00, 0xE0, 0xF0, 0x10, 0x20,
+    0x0B, 0x02, 0xC0, 0xE0, 0x70, 0xC0, 0x17, 0x02, 0x00, 0xF0,
+    0xF0, 0x20, 0x04, 0xA0, 0x06, 0x20, 0x14, 0x01, 0xFE, 0xFE,
+    0x40, 0x32, 0x01, 0x00, 0x00,
+    // 3443-3499: label_layout 1
+    0x03, 0x00, 0x3F, 0x3F, 0x30, 0x80, 0x00, 0x05, 0x00, 0x00,
+    0x00, 0x1E, 0x3E, 0x33, 0x20, 0x00, 0x02, 0x1B, 0x3F, 0x3F,
+    0x20, 0x0B, 0x06, 0x00, 0xC0, 0xC3, 0xEF, 0x7C, 0x3F, 0x07,
+    0x40, 0x09, 0x03, 0x00, 0x0F, 0x1F, 0x38, 0x20, 0x20, 0x02,
+    0x38, 0x1F, 0x0F, 0xC0, 0x0B, 0x01, 0x10, 0x18, 0x20, 0x23,
+    0x60, 0x00, 0x01, 0x1F, 0x3F, 0x80, 0x3B,
+    // 3500-3570: label_readouts 0
+    0x03, 0x00, 0xFE, 0xFE, 0x86, 0x20, 0x00, 0x0E, 0xCE, 0xFC,
+    0x78, 0x00, 0x00, 0x00, 0x80, 0xE0, 0x70, 0x30, 0x30, 0x30,
+    0x70, 0xE0, 0xC0, 0x20, 0x0B, 0x01, 0x00, 0x60, 0x20, 0x0A,
+    0xA0, 0x0B, 0x00, 0xC0, 0x60, 0x17, 0x02, 0x60, 0xFF, 0xFF,
+    0xA0, 0x0B, 0xC0, 0x17, 0x01, 0xF0, 0xF0, 0x20, 0x04, 0xA0,
+    0x06, 0x20, 0x14, 0x01, 0xFE, 0xFE, 0x40, 0x32, 0x20, 0x0B,
+    0x04, 0xE0, 0xE0, 0xB0, 0xB0, 0xB0, 0x40, 0x31, 0x01, 0x00,
+    0x00,
+    // 3571-3647: label_readouts 1
+    0x03, 0x00, 0x3F, 0x3F, 0x01, 0x20, 0x00, 0x09, 0x07, 0x1E,
+    0x3C, 0x20, 0x00, 0x00, 0x07, 0x1F, 0x1B, 0x33, 0x40, 0x00,
+    0x05, 0x1B, 0x00, 0x00, 0x00, 0x1E, 0x3E, 0x60, 0x09, 0x01,
+    0x3F, 0x3F, 0x20, 0x0B, 0x06, 0x0F, 0x1F, 0x38, 0x30, 0x30,
+    0x30, 0x18, 0xE0, 0x02, 0x0B, 0x02, 0x38, 0x1F, 0x0F, 0xC0,
+    0x0B, 0x00, 0x10, 0x40, 0x17, 0x60, 0x00, 0x02, 0x1F, 0x3F,
+    0x30, 0x20, 0x00, 0x20, 0x08, 0x01, 0x18, 0x31, 0x20, 0x00,
+    0x05, 0x33, 0x33, 0x1F, 0x1E, 0x00, 0x00,
+    // 3648-3722: label_settings 0
+    0x09, 0x00, 0x38, 0x7C, 0xCE, 0xC6, 0xC6, 0xC6, 0x86, 0x8C,
+    0x00, 0x20, 0x00, 0x08, 0x80, 0xE0, 0x70, 0x30, 0x30, 0x30,
+    0x70, 0xE0, 0xC0, 0x20, 0x0B, 0x20, 0x08, 0x02, 0xFE, 0xFE,
+    0x30, 0x20, 0x00, 0xE0, 0x04, 0x0B, 0x80, 0x0C, 0x02, 0xF3,
+    0xF3, 0x00, 0x60, 0x00, 0x03, 0xF0, 0xF0, 0x60, 0x20, 0xC0,
+    0x2F, 0x08, 0xF0, 0xF8, 0x1C, 0x0C, 0x0C, 0x0C, 0x18, 0xFC,
+    0xFC, 0x20, 0x0B, 0x04, 0xE0, 0xE0, 0xB0, 0xB0, 0xB0, 0x20,
+    0x27, 0x02, 0x60, 0x00, 0x00,
+    // 3723-3791: label_settings 1
+    0x02, 0x00, 0x18, 0x30, 0x40, 0x00, 0x09, 0x39, 0x1F, 0x0F,
+    0x00, 0x00, 0x00, 0x07, 0x1F, 0x1B, 0x33, 0x40, 0x00, 0x01,
+    0x1B, 0x00, 0x60, 0x00, 0x01, 0x1F, 0x3F, 0x40, 0x1A, 0xE0,
+    0x07, 0x0B, 0x20, 0x06, 0x01, 0x3F, 0x3F, 0x80, 0x0B, 0x01,
+    0x3F, 0x3F, 0x20, 0x04, 0xA0, 0x06, 0x07, 0x03, 0x67, 0xCE,
+    0xCC, 0xCC, 0xCC, 0xE6, 0x7F, 0x40, 0x0B, 0x01, 0x18, 0x31,
+    0x20, 0x00, 0x05, 0x33, 0x33, 0x1F, 0x1E, 0x00, 0x00,
+    // 3792-3866: label_calibrate 0
+    0x05, 0x00, 0xF0, 0xF8, 0x1C, 0x0E, 0x06, 0x20, 0x00, 0x01,
+    0x0C, 0x00, 0x20, 0x00, 0x01, 0x60, 0x30, 0x20, 0x00, 0x02,
+    0x70, 0xE0, 0xC0, 0x20, 0x0A, 0x05, 0x03, 0x03, 0x03, 0xFF,
+    0xFF, 0x00, 0xA0, 0x00, 0x20, 0x15, 0x01, 0xF3, 0xF3, 0x80,
+    0x0A, 0x02, 0xFF, 0xFF, 0x60, 0x80, 0x23, 0x60, 0x0D, 0x02,
+    0xF0, 0xF0, 0x40, 0x20, 0x0D, 0x00, 0x60, 0xE0, 0x03, 0x3B,
+    0x80, 0x2E, 0x01, 0xFE, 0xFE, 0x40, 0x0E, 0x20, 0x0B, 0x02,
+    0x80, 0xE0, 0x70, 0xC0, 0x17,
+    // 3867-3938: label_calibrate 1
+    0x05, 0x00, 0x07, 0x0F, 0x1C, 0x38, 0x30, 0x20, 0x00, 0x06,
+    0x18, 0x00, 0x00, 0x00, 0x1E, 0x3E, 0x33, 0x20, 0x00, 0x03,
+    0x1B, 0x3F, 0x3F, 0x00, 0x60, 0x00, 0x01, 0x0F, 0x3F, 0x20,
+    0x17, 0x60, 0x09, 0x20, 0x07, 0x00, 0x3F, 0xA0, 0x0C, 0x02,
+    0x3F, 0x3F, 0x18, 0x20, 0x08, 0x02, 0x38, 0x1F, 0x0F, 0x60,
+    0x18, 0xA0, 0x2A, 0xE0, 0x09, 0x3B, 0x00, 0x1F, 0x20, 0x2E,
+    0x60, 0x2F, 0x03, 0x07, 0x1F, 0x1B, 0x33, 0x60, 0x19, 0x01,
+    0x00, 0x00,
+    // 3939-3970: label_set 0
+    0x09, 0x00, 0x38, 0x7C, 0xCE, 0xC6, 0xC6, 0xC6, 0x86, 0x8C,
+    0x00, 0x20, 0x00, 0x02, 0xFE, 0xFE, 0xC6, 0x80, 0x00, 0x20,
+    0x0B, 0x00, 0x06, 0x20, 0x00, 0x01, 0xFE, 0xFE, 0x40, 0x05,
+    0x00, 0x00,
+    // 3971-3996: label_set 1
+    0x02, 0x00, 0x18, 0x30, 0x40, 0x00, 0x08, 0x39, 0x1F, 0x0F,
+    0x00, 0x00, 0x00, 0x3F, 0x3F, 0x30, 0x80, 0x00, 0x00, 0x00,
+    0x20, 0x00, 0x60, 0x0F, 0x60, 0x06,
+    // 3997-4029: label_act 0
+    0x08, 0x00, 0x00, 0x00, 0xE0, 0xFE, 0x1E, 0xFE, 0xE0, 0x00,
+    0x40, 0x00, 0x04, 0xF0, 0xF8, 0x1C, 0x0E, 0x06, 0x20, 0x00,
+    0x00, 0x0C, 0x20, 0x0B, 0x40, 0x07, 0x01, 0xFE, 0xFE, 0x40,
+    0x05, 0x00, 0x00,
+    // 4030-4060: label_act 1
+    0x11, 0x00, 0x30, 0x3E, 0x0F, 0x07, 0x06, 0x07, 0x0F, 0x3E,
+    0x30, 0x00, 0x00, 0x00, 0x07, 0x0F, 0x1C, 0x38, 0x30, 0x20,
+    0x00, 0x01, 0x18, 0x00, 0x80, 0x00, 0x01, 0x3F, 0x3F, 0x60,
+    0x06,
+    // 4061-4078: label_p_p 0
+    0x03, 0x00, 0xFE, 0xFE, 0x86, 0x20, 0x00, 0x03, 0xCE, 0xFC,
+    0x78, 0x00, 0xE0, 0x04, 0x00, 0xE0, 0x03, 0x17,
+    // 4079-4098: label_p_p 1
+    0x03, 0x00, 0x3F, 0x3F, 0x01, 0x40, 0x00, 0x00, 0x00, 0x80,
+    0x00, 0x00, 0x03, 0x40, 0x00, 0x40, 0x08, 0xE0, 0x03, 0x17,
+    // 4099-4134: label_rms 0
+    0x03, 0x00, 0xFE, 0xFE, 0x86, 0x20, 0x00, 0x04, 0xCE, 0xFC,
+    0x78, 0x00, 0x00, 0x20, 0x0B, 0x06, 0x1E, 0xF0, 0x80, 0xF0,
+    0x1E, 0xFE, 0xFE, 0x20, 0x0B, 0x07, 0x38, 0x7C, 0xCE, 0xC6,
+    0xC6, 0xC6, 0x86, 0x8C, 0x20, 0x0A,
+    // 4135-4167: label_rms 1
+    0x03, 0x00, 0x3F, 0x3F, 0x01, 0x20, 0x00, 0x04, 0x07, 0x1E,
+    0x3C, 0x20, 0x00, 0x20, 0x0B, 0x02, 0x00, 0x00, 0x01, 0x80,
+    0x06, 0x02, 0x00, 0x18, 0x30, 0x40, 0x00, 0x04, 0x39, 0x1F,
+    0x0F, 0x00, 0x00,
+    // 4168-4191: label_ac 0
+    0x08, 0x00, 0x00, 0x00, 0xE0, 0xFE, 0x1E, 0xFE, 0xE0, 0x00,
+    0x40, 0x00, 0x04, 0xF0, 0xF8, 0x1C, 0x0E, 0x06, 0x20, 0x00,
+    0x02, 0x0C, 0x00, 0x00,
+    // 4192-4216: label_ac 1
+    0x11, 0x00, 0x30, 0x3E, 0x0F, 0x07, 0x06, 0x07, 0x0F, 0x3E,
+    0x30, 0x00, 0x00, 0x00, 0x07, 0x0F, 0x1C, 0x38, 0x30, 0x20,
+    0x00, 0x02, 0x18, 0x00, 0x00,
+    // 4217-4280: label_next 0
+    0x0A, 0x00, 0xE0, 0x80, 0x00, 0xFE, 0xFE, 0xFE, 0x00, 0x80,
+    0xE0, 0x00, 0x60, 0x00, 0x00, 0xE0, 0x20, 0x07, 0xE0, 0x07,
+    0x00, 0x20, 0x20, 0x02, 0x0E, 0x78, 0xC0, 0x40, 0x06, 0x20,
+    0x0B, 0x07, 0x80, 0xE0, 0x70, 0x30, 0x30, 0x30, 0x70, 0xE0,
+    0x20, 0x0F, 0x01, 0x00, 0x10, 0x20, 0x07, 0x40, 0x0F, 0x00,
+    0x10, 0x20, 0x0B, 0x20, 0x14, 0x01, 0xFE, 0xFE, 0x20, 0x04,
+    0x02, 0x30, 0x00, 0x00,
+    // 4281-4345: label_next 1
+    0x0B, 0x60, 0x61, 0x63, 0x67, 0x6F, 0x7F, 0x6F, 0x67, 0x63,
+    0x61, 0x60, 0x00, 0x40, 0x00, 0x02, 0x38, 0x38, 0x00, 0xE0,
+    0x09, 0x00, 0x06, 0x3F, 0x3F, 0x00, 0x00, 0x01, 0x0F, 0x38,
+    0x40, 0x06, 0x04, 0x00, 0x07, 0x1F, 0x1B, 0x33, 0x40, 0x00,
+    0x00, 0x1B, 0x20, 0x0B, 0x08, 0x20, 0x30, 0x3C, 0x0F, 0x07,
+    0x0F, 0x3C, 0x30, 0x20, 0x80, 0x26, 0x02, 0x1F, 0x3F, 0x30,
+    0x20, 0x00, 0x01, 0x00, 0x00,
+    // 4346-4402: label_done 0
+    0x0A, 0x00, 0xE0, 0x80, 0x00, 0xFE, 0xFE, 0xFE, 0x00, 0x80,
+    0xE0, 0x00, 0x60, 0x00, 0x00, 0xE0, 0x20, 0x07, 0xE0, 0x07,
+    0x00, 0x20, 0x20, 0x06, 0x06, 0x06, 0x06, 0x0E, 0x1C, 0xF8,
+    0xF0, 0x20, 0x0B, 0x08, 0xC0, 0xE0, 0x70, 0x30, 0x30, 0x30,
+    0x70, 0xE0, 0xC0, 0x20, 0x0B, 0x03, 0xF0, 0xF0, 0x60, 0x20,
+    0xC0, 0x0B, 0x00, 0x80, 0xE0, 0x01, 0x17,
+    // 4403-4462: label_done 1
+    0x0B, 0x60, 0x61, 0x63, 0x67, 0x6F, 0x7F, 0x6F, 0x67, 0x63,
+    0x61, 0x60, 0x00, 0x40, 0x00, 0x02, 0x38, 0x38, 0x00, 0xE0,
+    0x09, 0x00, 0x08, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x38, 0x1C,
+    0x0F, 0x07, 0x20, 0x0B, 0x02, 0x0F, 0x1F, 0x38, 0x40, 0x0C,
+    0x01, 0x1F, 0x0F, 0x60, 0x17, 0x20, 0x04, 0xA0, 0x06, 0x03,
+    0x07, 0x1F, 0x1B, 0x33, 0x40, 0x00, 0x02, 0x1B, 0x00, 0x00,
+};
+
+const uint16 asset_offsets[] = {0, 310, 653, 1046, 1379, 1552, 1722, 1875, 1973, 2029, 2080, 2138, 2202, 2269, 2338, 2404, 2477, 2543, 2612, 2691, 2781, 2827, 2871, 2968, 3051, 3122, 3194, 3231, 3256, 3324, 3388, 3443, 3500, 3571, 3648, 3723, 3792, 3867, 3939, 3971, 3997, 4030, 4061, 4079, 4099, 4135, 4168, 4192, 4217, 4281, 4346, 4403, 4463};
+
+const asset_entry asset_table[ASSET_COUNT] = {
+    {0, 8}, // ASSET_SPLASHSCREEN
+    {8, 2}, // ASSET_LABEL_PRESETS
+    {10, 2}, // ASSET_LABEL_C_C_LOAD
+    {12, 2}, // ASSET_LABEL_C_V_LOAD
+    {14, 2}, // ASSET_LABEL_C_R_LOAD
+    {16, 2}, // ASSET_LABEL_C_P_LOAD
+    {18, 2}, // ASSET_LABEL_PULSE_LOAD
+    {20, 2}, // ASSET_LABEL_GRAPH
+    {22, 2}, // ASSET_LABEL_BATTERY_TEST
+    {24, 2}, // ASSET_LABEL_I_V_SWEEP
+    {26, 2}, // ASSET_LABEL_MPPT
+    {28, 2}, // ASSET_LABEL_IR_TEST
+    {30, 2}, // ASSET_LABEL_LAYOUT
+    {32, 2}, // ASSET_LABEL_READOUTS
+    {34, 2}, // ASSET_LABEL_SETTINGS
+    {36, 2}, // ASSET_LABEL_CALIBRATE
+    {38, 2}, // ASSET_LABEL_SET
+    {40, 2}, // ASSET_LABEL_ACT
+    {42, 2}, // ASSET_LABEL_P_P
+    {44, 2}, // ASSET_LABEL_RMS
+    {46, 2}, // ASSET_LABEL_AC
+    {48, 2}, // ASSET_LABEL_NEXT
+    {50, 2}, // ASSET_LABEL_DONE
+};
+
+const asset_label asset_labels[ASSET_LABEL_COUNT] = {
+    {"Presets", ASSET_LABEL_PRESETS},
+    {"C/C Load", ASSET_LABEL_C_C_LOAD},
+    {"C/V Load", ASSET_LABEL_C_V_LOAD},
+    {"C/R Load", ASSET_LABEL_C_R_LOAD},
+    {"C/P Load", ASSET_LABEL_C_P_LOAD},
+    {"Pulse Load", ASSET_LABEL_PULSE_LOAD},
+    {"Graph", ASSET_LABEL_GRAPH},
+    {"Battery Test", ASSET_LABEL_BATTERY_TEST},
+    {"I-V Sweep", ASSET_LABEL_I_V_SWEEP},
+    {"MPPT", ASSET_LABEL_MPPT},
+    {"IR Test", ASSET_LABEL_IR_TEST},
+    {"Layout", ASSET_LABEL_LAYOUT},
+    {"Readouts", ASSET_LABEL_READOUTS},
+    {"Settings", ASSET_LABEL_SETTINGS},
+    {"Calibrate", ASSET_LABEL_CALIBRATE},
+    {"SET", ASSET_LABEL_SET},
+    {"ACT", ASSET_LABEL_ACT},
+    {"P-P", ASSET_LABEL_P_P},
+    {"RMS", ASSET_LABEL_RMS},
+    {"AC", ASSET_LABEL_AC},
+    {"\337: Next", ASSET_LABEL_NEXT},
+    {"\337: Done", ASSET_LABEL_DONE},
+};
@@ -0,0 +1,75 @@
+// Generated by tools/assetpacker.py; add assets to its ASSETS list.
+
+#include <project.h>
+#include "lzfx.h"
+
+typedef enum {
+	ASSET_SPLASHSCREEN,
+	ASSET_LABEL_PRESETS,
+	ASSET_LABEL_C_C_LOAD,
+	ASSET_LABEL_C_V_LOAD,
+	ASSET_LABEL_C_R_LOAD,
+	ASSET_LABEL_C_P_LOAD,
+	ASSET_LABEL_PULSE_LOAD,
+	ASSET_LABEL_GRAPH,
+	ASSET_LABEL_BATTERY_TEST,
+	ASSET_LABEL_I_V_SWEEP,
+	ASSET_LABEL_MPPT,
+	ASSET_LABEL_IR_TEST,
+	ASSET_LABEL_LAYOUT,
+	ASSET_LABEL_READOUTS,
+	ASSET_LABEL_SETTINGS,
+	ASSET_LABEL_CALIBRATE,
+	ASSET_LABEL_SET,
+	ASSET_LABEL_ACT,
+	ASSET_LABEL_P_P,
+	ASSET_LABEL_RMS,
+	ASSET_LABEL_AC,
+	ASSET_LABEL_NEXT,
+	ASSET_LABEL_DONE,
+	ASSET_COUNT
+} asset_id;
+
+#define ASSET_SPLASHSCREEN_SEGMENTS 8
+#define ASSET_LABEL_PRESETS_SEGMENTS 2
+#define ASSET_LABEL_C_C_LOAD_SEGMENTS 2
+#define ASSET_LABEL_C_V_LOAD_SEGMENTS 2
+#define ASSET_LABEL_C_R_LOAD_SEGMENTS 2
+#define ASSET_LABEL_C_P_LOAD_SEGMENTS 2
+#define ASSET_LABEL_PULSE_LOAD_SEGMENTS 2
+#define ASSET_LABEL_GRAPH_SEGMENTS 2
+#define ASSET_LABEL_BATTERY_TEST_SEGMENTS 2
+#define ASSET_LABEL_I_V_SWEEP_SEGMENTS 2
+#define ASSET_LABEL_MPPT_SEGMENTS 2
+#define ASSET_LABEL_IR_TEST_SEGMENTS 2
+#define ASSET_LABEL_LAYOUT_SEGMENTS 2
+#define ASSET_LABEL_READOUTS_SEGMENTS 2
+#define ASSET_LABEL_SETTINGS_SEGMENTS 2
+#define ASSET_LABEL_CALIBRATE_SEGMENTS 2
+#define ASSET_LABEL_SET_SEGMENTS 2
+#define ASSET_LABEL_ACT_SEGMENTS 2
+#define ASSET_LABEL_P_P_SEGMENTS 2
+#define ASSET_LABEL_RMS_SEGMENTS 2
+#define ASSET_LABEL_AC_SEGMENTS 2
+#define ASSET_LABEL_NEXT_SEGMENTS 2
+#define ASSET_LABEL_DONE_SEGMENTS 2
+#define ASSET_LABEL_COUNT 22
+
+typedef struct {
+	uint16 first; // Index into asset_offsets
+	uint16 segments;
+} asset_entry;
+
+// A label asset and the text it was rendered from
+typedef struct {
+	const char *text;
+	asset_id id;
+} asset_label;
+
+extern const uint8 asset_data[];
+extern const uint16 asset_offsets[];
+extern const asset_entry asset_table[ASSET_COUNT];
+extern const asset_label asset_labels[ASSET_LABEL_COUNT];
+
+int asset_segments(asset_id id);
+int asset_decode(asset_id id, int segment, lzfx_sink sink, void *arg);
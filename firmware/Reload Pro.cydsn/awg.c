@@ -0,0 +1,236 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <string.h>
+#include "config.h"
+
+// Arbitrary waveform generator. It plays in the transient generator's load
+// mode, from the same pulse timer: the table holds a shape, each sample a
+// fraction of the amplitude either side of the offset, and starting puts
+// every sample through current_to_dac(), calibration table and all, so the
+// timer ISR only writes the IDACs' codes one sample period after the
+// last. Shapes are uploaded with the binary 'awg' frame, or built here.
+//
+// The codes have a spare entry after the table for the offset, which the ISR
+// plays after the last pass, leaving the output at the offset.
+//
+// Only in builds with USE_AWG defined; otherwise no table can be loaded, so
+// the transient generator never selects one.
+
+#ifdef USE_AWG
+
+static int16 shape[AWG_MAX_SAMPLES];
+static uint8 length = 0;
+static uint8 codes[AWG_MAX_SAMPLES + 1][2]; // [sample][high, low]
+static uint8 play_length; // The table's length when it started
+static volatile uint8 position;
+static volatile uint16 passes;
+static volatile uint8 playing = 0;
+
+static awg_config_t config = {
+	.offset = PULSE_DEFAULT_LOW,
+	.amplitude = PULSE_DEFAULT_LOW,
+	.rate = AWG_DEFAULT_RATE,
+	.loops = 0,
+};
+
+CY_ISR(awg_timer_isr) {
+	timer_clear_interrupt(TIMER_COUNTER_PULSE, TIMER_INTR_TC);
+
+	uint8 i = position;
+	write_dac(codes[i][0], codes[i][1]);
+	if(i == play_length) {
+		// That was the offset, after the last pass
+		timer_stop(TIMER_COUNTER_PULSE);
+		playing = 0;
+		return;
+	}
+	if(++i == play_length) {
+		passes++;
+		if(config.loops == 0 || passes < config.loops)
+			i = 0;
+	}
+	position = i;
+}
+
+static int sample_current(int16 sample) {
+	int current = config.offset + (int)(((int64)config.amplitude * sample) / AWG_FULL_SCALE);
+	if(current < 0)
+		return 0;
+	return (current > CURRENT_FULLRANGE_MAX)?CURRENT_FULLRANGE_MAX:current;
+}
+
+// Called by start_pulse() with the table selected. The samples are held to
+// the SOA's pulse limit for a rectangular pulse of the same peak and mean,
+// repeating each pass of the table.
+void awg_start() {
+	play_length = length;
+	int peak = 1;
+	int64 sum = 0;
+	for(uint8 i = 0; i < play_length; i++) {
+		int current = sample_current(shape[i]);
+		sum += current;
+		if(current > peak)
+			peak = current;
+	}
+	int limit = CURRENT_FULLRANGE_MAX;
+	if(play_length > 0) {
+		uint8 duty = (sum * 100 + (int64)peak * play_length - 1) / ((int64)peak * play_length);
+		if(duty < 1)
+			duty = 1;
+		uint32 pass_us = ((uint32)play_length * 1000000) / config.rate;
+		limit = get_pulse_limit(pass_us * duty / 100, duty, 0);
+	}
+	for(uint8 i = 0; i < play_length; i++) {
+		int current = sample_current(shape[i]);
+		current_to_dac((current > limit)?limit:current, &codes[i][0], &codes[i][1]);
+	}
+	current_to_dac(sample_current(0), &codes[play_length][0], &codes[play_length][1]);
+
+	write_dac(codes[play_length][0], codes[play_length][1]);
+	state.current_setpoint = sample_current(0);
+	position = 0;
+	passes = 0;
+	if(play_length == 0)
+		return;
+
+	playing = 1;
+	timer_start(TIMER_COUNTER_PULSE, TIMER_CLOCK_HZ / config.rate - 1, TIMER_INTR_TC, awg_timer_isr, IRQ_PRIORITY_CONTROL);
+}
+
+// Selects the table for the transient generator, restarting it if it's
+// already playing
+int set_awg_config(const awg_config_t *new_config) {
+	if(new_config->rate < AWG_MIN_RATE || new_config->rate > AWG_MAX_RATE)
+		return 0;
+	if(new_config->offset < 0 || new_config->offset > CURRENT_FULLRANGE_MAX ||
+	   new_config->amplitude < 0 || new_config->amplitude > CURRENT_FULLRANGE_MAX)
+		return 0;
+	if(length == 0)
+		return 0;
+
+	uint8 int_state = CyEnterCriticalSection();
+	config = *new_config;
+	CyExitCriticalSection(int_state);
+	pulse_select_table();
+	return 1;
+}
+
+const awg_config_t *get_awg_config() {
+	return &config;
+}
+
+// Writes count samples from first on, leaving the table that long. The first
+// may be at most the present length, so a table is uploaded in order; a
+// playing table carries on as it was until it's next started.
+int awg_load(int first, const int16 *samples, int count) {
+	if(first < 0 || first > length || count < 0 || first + count > AWG_MAX_SAMPLES)
+		return 0;
+	memcpy(&shape[first], samples, count * sizeof(int16));
+	length = first + count;
+	return 1;
+}
+
+// sin(pi * x / span) for x in 0 to span, by Bhaskara's approximation, which
+// is within 0.2% of full scale and needs no floating point
+static int16 half_sine(int x, int span) {
+	int product = x * (span - x);
+	return (int16)((16 * AWG_FULL_SCALE * product) / (5 * span * span - 4 * product));
+}
+
+// Fills the table with one cycle of shape over samples, starting at zero and
+// rising. A triangle's peaks are exact with samples a multiple of 4.
+int awg_fill(awg_shape kind, int samples) {
+	if(samples < 2 || samples > AWG_MAX_SAMPLES)
+		return 0;
+	for(int i = 0; i < samples; i++) {
+		if(kind == AWG_SHAPE_SINE) {
+			// Each half cycle is samples / 2 long, in units of 1 / 2 sample
+			shape[i] = (2 * i <= samples)?half_sine(2 * i, samples):-half_sine(2 * i - samples, samples);
+		} else {
+			int ramp = (4 * AWG_FULL_SCALE * i) / samples;
+			if(ramp > 3 * AWG_FULL_SCALE) {
+				shape[i] = ramp - 4 * AWG_FULL_SCALE;
+			} else if(ramp > AWG_FULL_SCALE) {
+				shape[i] = 2 * AWG_FULL_SCALE - ramp;
+			} else {
+				shape[i] = ramp;
+			}
+		}
+	}
+	length = samples;
+	return 1;
+}
+
+int get_awg_length() {
+	return length;
+}
+
+int get_awg_playing() {
+	return playing;
+}
+
+// Called from the ADC ISR once per block, through get_pulse_flags(): bit 0 is
+// set in the table's first half, bit 1 if a pass began since the last call
+uint8 get_awg_flags() {
+	static uint16 last_passes = 0;
+	uint8 flags = 0;
+
+	if(playing) {
+		uint16 now = passes;
+		if(position < play_length / 2)
+			flags = PULSE_FLAG_HIGH;
+		if(now != last_passes)
+			flags |= PULSE_FLAG_EDGE;
+		last_passes = now;
+	}
+	return flags;
+}
+
+#else
+
+void awg_start() {
+}
+
+int set_awg_config(const awg_config_t *new_config) {
+	return 0;
+}
+
+const awg_config_t *get_awg_config() {
+	static const awg_config_t config = {.offset = PULSE_DEFAULT_LOW, .amplitude = PULSE_DEFAULT_LOW, .rate = AWG_DEFAULT_RATE};
+	return &config;
+}
+
+int awg_load(int first, const int16 *samples, int count) {
+	return 0;
+}
+
+int awg_fill(awg_shape kind, int samples) {
+	return 0;
+}
+
+int get_awg_length() {
+	return 0;
+}
+
+int get_awg_playing() {
+	return 0;
+}
+
+uint8 get_awg_flags() {
+	return 0;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,210 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <string.h>
+#include "tasks.h"
+#include "config.h"
+
+// Battery discharge test: a C/C or C/P load until the voltage falls below the
+// cutoff, then the output is turned off and the charge and energy totals are
+// latched. The ADC task checks each block's mean against the cutoff, in raw
+// counts, so the load comes off within a few blocks of the knee rather than at
+// the UI's refresh rate. BATTERY_CUTOFF_BLOCKS blocks in a row must be below
+// it, so one noisy block can't end a test. Only in builds with USE_BATTERY_TEST
+// defined.
+
+#ifdef USE_BATTERY_TEST
+
+static volatile battery_state test_state = BATTERY_IDLE;
+static int16 cutoff_raw;
+static int cutoff;
+static uint8 blocks_below;
+static energy_totals result;
+
+// The discharge curve, summarised in at most BATTERY_CURVE_POINTS points
+// however long the test runs. Every BATTERY_CURVE_INTERVAL_US a point goes on
+// the end, the mean voltage of the blocks since the last against the charge
+// so far, and when that makes one too many, the interior point making the
+// smallest triangle with its neighbours goes, as in Visvalingam's line
+// simplification. Points along the flat of the curve go first, so those left
+// crowd around the knee. The first and latest points always stay. The points
+// are kept in the shared scratch buffer.
+static uint8 curve_length;
+static volatile uint8 curve_frozen = 0;	// Being read; samples carry over until it isn't
+static int32 sample_sum;
+static uint16 sample_blocks;
+static uint32 sample_start;
+
+int battery_start(load_mode mode, int target, int new_cutoff) {
+	if((mode != LOAD_MODE_CC && mode != LOAD_MODE_CP) || target <= 0 || new_cutoff <= 0)
+		return 0;
+
+	test_state = BATTERY_IDLE;
+	sequence_stop();
+	sweep_stop();
+	mppt_stop();
+	ocp_stop();
+	scratch_claim(SCRATCH_BATTERY);
+	cutoff = new_cutoff;
+	cutoff_raw = voltage_to_raw(new_cutoff);
+	blocks_below = 0;
+	curve_length = 0;
+	sample_sum = 0;
+	sample_blocks = 0;
+	sample_start = get_time_us();
+	reset_energy_totals();
+	set_load_target(mode, target);
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	test_state = BATTERY_RUNNING;
+	return 1;
+}
+
+static void finish(battery_state end) {
+	if(test_state != BATTERY_RUNNING)
+		return;
+	set_output_mode(OUTPUT_MODE_OFF);
+	get_energy_totals(&result);
+	test_state = end;
+}
+
+// Ends a running test early, for 'battery stop' and on a trip
+void battery_stop() {
+	finish(BATTERY_STOPPED);
+}
+
+// Twice the area of the triangle point i makes with its neighbours
+static uint64 curve_area(int i) {
+	const uint32 *charge = scratch.battery.charge;
+	const int16 *voltage = scratch.battery.voltage;
+	int64 a = (int64)(charge[i] - charge[i - 1]) * (voltage[i + 1] - voltage[i - 1]);
+	int64 b = (int64)(charge[i + 1] - charge[i - 1]) * (voltage[i] - voltage[i - 1]);
+	return (a > b)?a - b:b - a;
+}
+
+static void curve_sample() {
+	uint32 *charge = scratch.battery.charge;
+	int16 *voltage = scratch.battery.voltage;
+	energy_totals totals;
+	get_energy_totals(&totals);
+	charge[curve_length] = totals.charge;
+	voltage[curve_length] = sample_sum / sample_blocks;
+	sample_sum = 0;
+	sample_blocks = 0;
+	sample_start = get_time_us();
+	if(++curve_length <= BATTERY_CURVE_POINTS)
+		return;
+
+	int drop = 1;
+	uint64 least = curve_area(1);
+	for(int i = 2; i < curve_length - 1; i++) {
+		uint64 area = curve_area(i);
+		if(area < least) {
+			least = area;
+			drop = i;
+		}
+	}
+	curve_length--;
+	memmove(&charge[drop], &charge[drop + 1], (curve_length - drop) * sizeof(charge[0]));
+	memmove(&voltage[drop], &voltage[drop + 1], (curve_length - drop) * sizeof(voltage[0]));
+}
+
+// Called by the ADC task with each block's mean voltage
+void battery_block(int16 raw_voltage) {
+	if(test_state != BATTERY_RUNNING)
+		return;
+	sample_sum += raw_voltage;
+	sample_blocks++;
+	if(!curve_frozen && get_time_us() - sample_start >= BATTERY_CURVE_INTERVAL_US)
+		curve_sample();
+
+	if(raw_voltage >= cutoff_raw) {
+		blocks_below = 0;
+	} else if(++blocks_below >= BATTERY_CUTOFF_BLOCKS) {
+		// The knee gets its last point
+		if(!curve_frozen)
+			curve_sample();
+		finish(BATTERY_DONE);
+	}
+}
+
+// Holds the curve still while the comms task reads it. The ADC task, which
+// changes it, has the higher priority, so once this returns the curve can't
+// change underneath the reader.
+void battery_curve_freeze(int freeze) {
+	curve_frozen = freeze;
+}
+
+int get_battery_curve_length() {
+	return scratch_owned(SCRATCH_BATTERY)?curve_length:0;
+}
+
+void get_battery_curve_point(int index, uint32 *charge, int16 *raw_voltage) {
+	*charge = scratch.battery.charge[index];
+	*raw_voltage = scratch.battery.voltage[index];
+}
+
+battery_state get_battery_state() {
+	return test_state;
+}
+
+int get_battery_cutoff() {
+	return cutoff;
+}
+
+// The totals so far while running, or as they stood when the test ended
+void get_battery_result(energy_totals *totals) {
+	if(test_state == BATTERY_RUNNING || test_state == BATTERY_IDLE) {
+		get_energy_totals(totals);
+	} else {
+		*totals = result;
+	}
+}
+
+#else
+
+int battery_start(load_mode mode, int target, int new_cutoff) {
+	return 0;
+}
+
+void battery_stop() {
+}
+
+void battery_block(int16 raw_voltage) {
+}
+
+void battery_curve_freeze(int freeze) {
+}
+
+int get_battery_curve_length() {
+	return 0;
+}
+
+void get_battery_curve_point(int index, uint32 *charge, int16 *raw_voltage) {
+}
+
+battery_state get_battery_state() {
+	return BATTERY_IDLE;
+}
+
+int get_battery_cutoff() {
+	return 0;
+}
+
+void get_battery_result(energy_totals *totals) {
+	get_energy_totals(totals);
+}
+
+#endif
+
+/* [] END OF FILE */
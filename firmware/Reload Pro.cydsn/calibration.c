@@ -0,0 +1,382 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "config.h"
+#include <stddef.h>
+#include <string.h>
+
+// Conversions between physical units and DAC/ADC counts. The M0 has no
+// hardware divider, so every divide by a calibration constant is replaced
+// with a multiply by a reciprocal that calibration_update() precomputes
+// whenever the settings change.
+
+typedef struct {
+	uint32 divisor;
+	uint32 multiplier; // ceil(2^32 / divisor), or 0 if divisor is 1
+} reciprocal_t;
+
+static reciprocal_t dac_high_gain;
+static reciprocal_t dac_low_gain;
+static reciprocal_t adc_voltage_gain;
+// Milliohms per (voltage count / current count), Q8
+static uint32 resistance_scale;
+// The ADC gains corrected for the die temperature
+static int current_gain, voltage_gain;
+static int temperature = THERMAL_DEFAULT_CAL_TEMPERATURE;
+
+static void make_reciprocal(reciprocal_t *r, int divisor) {
+	if(divisor < 1)
+		divisor = 1;
+	r->divisor = divisor;
+	r->multiplier = (divisor == 1)?0:(0xFFFFFFFFu / divisor + 1);
+}
+
+// floor(n / r->divisor). The reciprocal rounds up, so the estimate is never
+// more than one too large; the remainder check corrects it.
+static uint32 divide(uint32 n, const reciprocal_t *r, uint32 *remainder) {
+	uint32 q = n, rem = 0;
+	if(r->multiplier != 0) {
+		q = ((uint64)n * r->multiplier) >> 32;
+		rem = n - q * r->divisor;
+		if((int32)rem < 0) {
+			q--;
+			rem += r->divisor;
+		}
+	}
+	if(remainder)
+		*remainder = rem;
+	return q;
+}
+
+// gain * (1 + tempco ppm * (temperature - calibration temperature))
+static int corrected_gain(int gain, int tempco) {
+	return gain + ((int64)gain * tempco * (temperature - settings->cal_temperature)) / 1000000;
+}
+
+// Every channel shares the SAR's reference, and the current and voltage gains,
+// the protection thresholds in counts and the control loops' scales all assume
+// the bypassed 1.024V one. It's the smallest the SAR has, so there's no finer
+// range for low voltages to switch to: VDDA/2 and VDDA only coarsen the step,
+// and the divider already puts the 60V rating inside 1.024V.
+#if ADC_DEFAULT_VREF_SEL != ADC__INTERNAL1024BYPASSED || ADC_DEFAULT_VREF_MV_VALUE != 1024
+#error "The ADC gains assume the bypassed 1.024V reference"
+#endif
+
+static void update_adc_gains() {
+	int new_current_gain = corrected_gain(settings->adc_current_gain, settings->adc_current_tempco);
+	int new_voltage_gain = corrected_gain(settings->adc_voltage_gain, settings->adc_voltage_tempco);
+	uint32 new_scale = (((uint64)new_voltage_gain * 1000) << 8) / new_current_gain;
+	reciprocal_t new_reciprocal;
+	make_reciprocal(&new_reciprocal, new_voltage_gain);
+
+	// Readers run in the ISR, so they see all of a change or none of it
+	uint8 int_state = CyEnterCriticalSection();
+	current_gain = new_current_gain;
+	voltage_gain = new_voltage_gain;
+	adc_voltage_gain = new_reciprocal;
+	resistance_scale = new_scale;
+	CyExitCriticalSection(int_state);
+	// The voltage trip points are in counts, so they follow the gain
+	voltage_limits_update();
+}
+
+void calibration_update() {
+	make_reciprocal(&dac_high_gain, settings->dac_high_gain);
+	make_reciprocal(&dac_low_gain, settings->dac_low_gain);
+	update_adc_gains();
+}
+
+// Called by the ADC task with each new temperature; the gains only need
+// working out again when it changes
+void calibration_set_temperature(int celsius) {
+	if(celsius == temperature)
+		return;
+	temperature = celsius;
+	update_adc_gains();
+}
+
+uint32 div1000(uint32 n) {
+	// 0x10624DD3 = ceil(2^38 / 1000), exact for all 32 bit n
+	return ((uint64)n * 0x10624DD3u) >> 38;
+}
+
+// Seeds for reciprocal_q30: 1/y in Q14 at the middle of each eighth of [0.5, 1)
+static const uint16 reciprocal_seed[] = {30840, 27594, 24966, 22795, 20972, 19418, 18078, 16912};
+
+// Approximates 2^30 / x for 0 < x < 2^16 without dividing. x is normalised to
+// y in [0.5, 1), seeded from a table and refined with two Newton-Raphson steps,
+// which is good to about 13 bits.
+RAMFUNC uint32 reciprocal_q30(uint32 x) {
+	int shift = 0;
+	while(x < 0x8000) {
+		x <<= 1;
+		shift++;
+	}
+
+	uint32 y = x >> 1; // Q15
+	uint32 r = reciprocal_seed[(x >> 12) & 7]; // Q14
+	for(int i = 0; i < 2; i++) {
+		uint32 e = (2u << 29) - y * r; // 2 - y*r, Q29
+		r = (r * (e >> 15)) >> 14;
+	}
+	return r << shift;
+}
+
+// Each IDAC's measured output minus the linear model's, every
+// 2^DAC_TABLE_SHIFT codes, in DAC_TABLE_UNIT microamps. settings_t is most of
+// a flash row already, so the table has a row of its own. The image programs
+// it to zeros, which correct nothing.
+typedef struct {
+	int16 error[2][DAC_TABLE_POINTS];	// High IDAC, then low
+} dac_table_t;
+
+static const volatile dac_table_t dac_table CY_SECTION(".rodata.dactable") CY_ALIGN(CY_FLASH_SIZEOF_ROW);
+
+// Microamps by which an IDAC at code is off the linear model, interpolated
+// between table points with a shift. Past the last point the error holds.
+static int dac_error(int dac, int code) {
+	const volatile int16 *error = dac_table.error[dac];
+	if(code < 0)
+		code = 0;
+	int i = code >> DAC_TABLE_SHIFT;
+	if(i >= DAC_TABLE_POINTS - 1)
+		return error[DAC_TABLE_POINTS - 1] * DAC_TABLE_UNIT;
+	int frac = code & ((1 << DAC_TABLE_SHIFT) - 1);
+	int e = error[i] + (((error[i + 1] - error[i]) * frac) >> DAC_TABLE_SHIFT);
+	return e * DAC_TABLE_UNIT;
+}
+
+static void dac_table_save(const dac_table_t *table) {
+	CySysFlashWriteRow(((uint32)&dac_table - CYDEV_FLASH_BASE) / CY_FLASH_SIZEOF_ROW, (const uint8*)table);
+}
+
+// Records that an IDAC (0 high, 1 low) at table point i measured error
+// microamps off the linear model. Stalls the CPU for the row write.
+void dac_table_write(int dac, int i, int error) {
+	dac_table_t table;
+	memcpy(&table, (const void*)&dac_table, sizeof(table));
+	error /= DAC_TABLE_UNIT;
+	table.error[dac][i] = (error > 32767)?32767:(error < -32768)?-32768:error;
+	dac_table_save(&table);
+}
+
+// Back to the plain linear model
+void dac_table_clear() {
+	dac_table_t table;
+	memset(&table, 0, sizeof(table));
+	dac_table_save(&table);
+}
+
+_Static_assert(offsetof(settings_t, cal_temperature) - offsetof(settings_t, dac_low_gain) ==
+	(CAL_BLOB_VALUES - 1) * sizeof(int), "cal_blob values must span the calibration settings");
+_Static_assert(sizeof(cal_blob) <= 255, "cal_blob length must fit its byte");
+
+static uint16 cal_blob_crc(const cal_blob *blob) {
+	return crc16_update(0xFFFF, (const uint8*)blob, offsetof(cal_blob, crc));
+}
+
+// Fills the staging blob from this unit's calibration. Exports are built and
+// imports gathered there, in the shared scratch buffer, a frame's worth at a
+// time, since neither fits one frame.
+const cal_blob *cal_export() {
+	cal_blob *staged = &scratch.cal_staged;
+	scratch_claim(SCRATCH_CAL_BLOB);
+	memset(staged, 0, sizeof(cal_blob));
+	staged->magic = CAL_BLOB_MAGIC;
+	staged->version = CAL_BLOB_VERSION;
+	staged->length = sizeof(cal_blob);
+	staged->serial[0] = CY_GET_REG32(CYREG_SFLASH_DIE_LOT0);
+	staged->serial[1] = CY_GET_REG32(CYREG_SFLASH_DIE_X);
+	memcpy(staged->values, &settings->dac_low_gain, sizeof(staged->values));
+	memcpy(staged->dac_table, (const void*)&dac_table, sizeof(staged->dac_table));
+	staged->crc = cal_blob_crc(staged);
+	return staged;
+}
+
+// Writes len bytes of a blob being imported at offset; 0 if they'd run past
+// its end. The first write claims the buffer, starting from zeroes.
+int cal_stage(int offset, const uint8 *data, int len) {
+	if(offset < 0 || len < 0 || offset + len > sizeof(cal_blob))
+		return 0;
+	if(!scratch_owned(SCRATCH_CAL_BLOB)) {
+		scratch_claim(SCRATCH_CAL_BLOB);
+		memset(&scratch.cal_staged, 0, sizeof(cal_blob));
+	}
+	memcpy((uint8*)&scratch.cal_staged + offset, data, len);
+	return 1;
+}
+
+// NULL once a test has claimed the buffer since the last export or import
+const cal_blob *get_cal_staged() {
+	return scratch_owned(SCRATCH_CAL_BLOB)?&scratch.cal_staged:NULL;
+}
+
+// Checks the staged blob and, if it's this unit's or force is set, makes it
+// the calibration, saving it with the settings. Stalls the CPU for the table's
+// row write.
+cal_import_result cal_import(int force) {
+	const cal_blob *staged = get_cal_staged();
+	if(staged == NULL || staged->magic != CAL_BLOB_MAGIC || staged->version != CAL_BLOB_VERSION
+	   || staged->length != sizeof(cal_blob))
+		return CAL_IMPORT_BAD_FORMAT;
+	if(cal_blob_crc(staged) != staged->crc)
+		return CAL_IMPORT_BAD_CRC;
+	if(!force && (staged->serial[0] != CY_GET_REG32(CYREG_SFLASH_DIE_LOT0) ||
+	              staged->serial[1] != CY_GET_REG32(CYREG_SFLASH_DIE_X)))
+		return CAL_IMPORT_WRONG_UNIT;
+
+	settings_write(staged->values, &settings->dac_low_gain, sizeof(staged->values));
+	dac_table_save((const dac_table_t*)staged->dac_table);
+	calibration_update();
+	return CAL_IMPORT_OK;
+}
+
+// Both IDACs run on their 1.2uA a code range, the finer of the two the CSD
+// block has, so there's no finer range for low setpoints to switch to; the
+// other only doubles the step. The default gains and every calibration
+// assume it. The low IDAC has 7 bits, and a code past them would spill into
+// the neighbouring fields of the shared control register.
+#if IDAC_High_IDAC_RANGE != 0 || IDAC_Low_IDAC_RANGE != 0
+#error "The DAC gains assume both IDACs on their 1.2uA range"
+#endif
+#define DAC_HIGH_MAX IDAC_High_IDAC_VALUE_MASK
+#define DAC_LOW_MAX IDAC_Low_IDAC_VALUE_MASK
+
+// The high IDAC takes whole counts of the setpoint and the low IDAC the rest.
+// Where the table says the high code's real output falls short of or
+// overshoots the model, the low IDAC's share moves to match, dropping a high
+// code if need be; the low code is predistorted by its own error in turn.
+// Everything stays multiplies and shifts. Returns what's left below the low
+// IDAC's step, in 256ths of it, for the output dither.
+uint8 current_to_dac(int current, uint8 *high, uint8 *low) {
+	uint32 remainder;
+	int high_value = divide(current, &dac_high_gain, &remainder) + settings->dac_high_offset;
+	int rest = (int)remainder - dac_error(0, high_value);
+	if(rest < 0 && high_value > 0) {
+		high_value--;
+		rest = (int)(remainder + dac_high_gain.divisor) - dac_error(0, high_value);
+	}
+	if(rest < 0)
+		rest = 0;
+
+	int low_value = divide(rest, &dac_low_gain, NULL) + settings->dac_low_offset;
+	rest -= dac_error(1, low_value);
+	uint32 fraction;
+	low_value = divide((rest < 0)?0:rest, &dac_low_gain, &fraction) + settings->dac_low_offset;
+
+	*high = (high_value > DAC_HIGH_MAX)?DAC_HIGH_MAX:high_value;
+	*low = (low_value > DAC_LOW_MAX)?DAC_LOW_MAX:low_value;
+	// No dither at the top code: one more would wrap the 7 bits to zero
+	return (low_value >= DAC_LOW_MAX)?0:divide(fraction << 8, &dac_low_gain, NULL);
+}
+
+int current_from_raw(int16 raw) {
+	int ret = (raw - settings->adc_current_offset) * current_gain;
+	return (ret < 0)?0:ret;
+}
+
+int voltage_from_raw(int16 raw) {
+	int ret = (raw - settings->adc_voltage_offset) * voltage_gain;
+	return (ret < 0)?0:ret;
+}
+
+// For differences and spreads: counts in 256ths, with no offset, to microamps
+int current_span_from_raw(int32 counts) {
+	return ((int64)counts * current_gain) >> 8;
+}
+
+int voltage_span_from_raw(int32 counts) {
+	return ((int64)counts * voltage_gain) >> 8;
+}
+
+int16 voltage_to_raw(int voltage) {
+	if(voltage < 0)
+		voltage = 0;
+	return divide(voltage, &adc_voltage_gain, NULL) + settings->adc_voltage_offset;
+}
+
+// Only the self test needs this, so it just divides
+int16 current_to_raw(int current) {
+	if(current < 0)
+		current = 0;
+	return current / current_gain + settings->adc_current_offset;
+}
+
+// Milliohms, or -1 if there's no current to measure against
+int resistance_from_raw(int16 voltage_raw, int16 current_raw) {
+	int voltage = voltage_raw - settings->adc_voltage_offset;
+	int current = current_raw - settings->adc_current_offset;
+	if(current <= 0)
+		return -1;
+	if(voltage <= 0)
+		return 0;
+
+	uint64 ret = ((((uint64)voltage * resistance_scale) >> 8) * reciprocal_q30(current)) >> 30;
+	return (ret > 0x7FFFFFFF)?0x7FFFFFFF:(int)ret;
+}
+
+// Host driven calibration fits y = gain * (x - offset) by least squares, x in
+// counts and y in microvolts or microamps. Only the running sums are kept, so
+// any number of points costs the same RAM. The sums stay well inside 64 bits
+// for CAL_MAX_POINTS points of 16 bit counts and readings up to 2^31. They
+// live in the shared scratch buffer, which cal_reset() claims, so a test
+// started mid-session leaves no points to add to or solve.
+
+void cal_reset() {
+	scratch_claim(SCRATCH_CAL_FITS);
+	memset(scratch.cal_fits, 0, sizeof(scratch.cal_fits));
+}
+
+int cal_add_point(cal_fit fit, int x, int y) {
+	cal_sums *s = &scratch.cal_fits[fit];
+	if(!scratch_owned(SCRATCH_CAL_FITS) || s->n >= CAL_MAX_POINTS)
+		return 0;
+	s->n++;
+	s->sx += x;
+	s->sy += y;
+	s->sxx += (int64)x * x;
+	s->sxy += (int64)x * y;
+	return 1;
+}
+
+int cal_points(cal_fit fit) {
+	return scratch_owned(SCRATCH_CAL_FITS)?scratch.cal_fits[fit].n:0;
+}
+
+// Rounds to nearest; d must be positive
+static int64 divide_rounded(int64 n, int64 d) {
+	return (n < 0)?-((-n + d / 2) / d):((n + d / 2) / d);
+}
+
+// Leaves gain and offset alone and returns 0 unless there are two or more
+// distinct x values to fit through. The offset is solved against the rounded
+// gain, since that's what will be stored.
+int cal_solve(cal_fit fit, int *gain, int *offset) {
+	const cal_sums *s = &scratch.cal_fits[fit];
+	if(!scratch_owned(SCRATCH_CAL_FITS) || s->n < 2)
+		return 0;
+
+	int64 den = s->n * s->sxx - s->sx * s->sx;
+	int64 num = s->n * s->sxy - s->sx * s->sy;
+	if(den <= 0)
+		return 0;
+	int64 g = divide_rounded(num, den);
+	if(g <= 0 || g > 0x7FFFFFFF)
+		return 0;
+
+	*gain = g;
+	*offset = divide_rounded(s->sx * g - s->sy, s->n * g);
+	return 1;
+}
+
+/* [] END OF FILE */
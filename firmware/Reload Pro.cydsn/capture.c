@@ -0,0 +1,293 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <stdlib.h>
+#include "tasks.h"
+#include "config.h"
+
+// Triggered capture of raw current and voltage at the full scan rate, like a
+// scope's single shot. Once armed, the ADC ISR copies every scan into a
+// circular buffer, so it always holds the last pre samples before the
+// trigger; after it, the rest of the depth fills and the buffer freezes
+// until the host reads it out. The trigger is a change of the C/C setpoint,
+// the voltage crossing a level, a falling edge on the trigger input, or the short
+// circuit test turning the gate on, checked a scan at a time. Idle, it costs the ISR one compare.
+// Only in builds with USE_CAPTURE defined, as is the short circuit test that
+// works through it.
+
+#ifdef USE_CAPTURE
+
+static int16 samples[CAPTURE_MAX_SAMPLES][2];	// Raw current, voltage
+static volatile capture_state status = CAPTURE_IDLE;
+static capture_trigger source;
+static uint8 depth, pre;
+static uint8 deepest;			// Depth armed, at most, since boot
+static uint8 next;				// Where the next scan goes
+static uint8 filled;			// Samples taken since arming, up to pre
+static uint8 remaining;			// Samples still to take after the trigger
+static volatile uint8 external_edge, short_edge;
+static int16 level_raw;			// For the voltage triggers
+static int16 last_voltage;
+static int last_setpoint;
+static uint32 start_time, done_time;
+static uint32 scans;			// Since arming, for the sample interval
+
+// Arms a capture of new_depth samples, new_pre of them from before the
+// trigger. level is in microvolts, for the voltage triggers. Returns 0 if
+// the sizes are out of range.
+int capture_start(capture_trigger trigger, int level, int new_depth, int new_pre) {
+	if(new_depth < 2 || new_depth > CAPTURE_MAX_SAMPLES || new_pre < 0 || new_pre >= new_depth)
+		return 0;
+
+	status = CAPTURE_IDLE;
+	source = trigger;
+	depth = new_depth;
+	pre = new_pre;
+	if(depth > deepest)
+		deepest = depth;
+	next = filled = 0;
+	external_edge = short_edge = 0;
+	level_raw = voltage_to_raw(level);
+	last_voltage = get_raw_voltage_fast();
+	last_setpoint = state.current_setpoint;
+	start_time = get_time_us();
+	scans = 0;
+	status = CAPTURE_ARMED;
+	return 1;
+}
+
+void capture_stop() {
+	status = CAPTURE_IDLE;
+}
+
+static int triggered(int16 voltage) {
+	switch(source) {
+	case CAPTURE_TRIGGER_SETPOINT:
+		return state.current_setpoint != last_setpoint;
+	case CAPTURE_TRIGGER_RISING:
+		return last_voltage < level_raw && voltage >= level_raw;
+	case CAPTURE_TRIGGER_FALLING:
+		return last_voltage >= level_raw && voltage < level_raw;
+	case CAPTURE_TRIGGER_EXTERNAL:
+		return external_edge;
+	case CAPTURE_TRIGGER_SHORT:
+		return short_edge;
+	default:
+		return 0;
+	}
+}
+
+// Called by the ADC ISR with each scan
+void capture_scan(const int16 *scan) {
+	if(status < CAPTURE_ARMED)
+		return;
+
+	int16 voltage = scan[ADC_CHAN_VOLTAGE_SENSE];
+	samples[next][0] = scan[ADC_CHAN_CURRENT_SENSE];
+	samples[next][1] = voltage;
+	next = (next + 1 < depth)?next + 1:0;
+	scans++;
+
+	if(status == CAPTURE_ARMED) {
+		// Only once there's enough history for the pre-trigger samples
+		if(filled < pre) {
+			filled++;
+			external_edge = short_edge = 0;
+		} else if(triggered(voltage)) {
+			status = CAPTURE_TRIGGERED;
+			remaining = depth - pre - 1;
+		}
+		last_voltage = voltage;
+		last_setpoint = state.current_setpoint;
+		if(status == CAPTURE_ARMED || remaining > 0)
+			return;
+	} else if(--remaining > 0) {
+		return;
+	}
+
+	status = CAPTURE_DONE;
+	done_time = get_time_us();
+	defer_post(DEFER_CAPTURE_DONE);
+}
+
+// Called by the trigger input's ISR on each falling edge
+void capture_external_edge() {
+	external_edge = 1;
+}
+
+// Called by the short circuit test as it turns the gate on
+void capture_short_edge() {
+	short_edge = 1;
+}
+
+capture_state get_capture_state() {
+	return status;
+}
+
+int get_capture_depth() {
+	return depth;
+}
+
+// In samples: the depth of the capture armed or held, if there is one
+void get_capture_usage(buffer_usage *usage) {
+	usage->size = CAPTURE_MAX_SAMPLES;
+	usage->bytes = sizeof(samples);
+	usage->fill = (status == CAPTURE_IDLE)?0:depth;
+	usage->peak = deepest;
+}
+
+int get_capture_pre() {
+	return pre;
+}
+
+// Nanoseconds between samples, over the whole capture
+uint32 get_capture_interval() {
+	return (scans > 0)?((uint64)(done_time - start_time) * 1000) / scans:0;
+}
+
+// The i'th sample of a finished capture, oldest first, as {current, voltage}
+const int16 *get_capture_sample(int i) {
+	int index = next + i;
+	return samples[(index < depth)?index:index - depth];
+}
+
+// Mean current and voltage in microamps and microvolts over samples first
+// up to but not including last
+static void capture_mean(int first, int last, int *current, int *voltage) {
+	int32 current_sum = 0, voltage_sum = 0;
+	for(int i = first; i < last; i++) {
+		const int16 *sample = get_capture_sample(i);
+		current_sum += sample[0];
+		voltage_sum += sample[1];
+	}
+	*current = current_from_raw(current_sum / (last - first));
+	*voltage = voltage_from_raw(voltage_sum / (last - first));
+}
+
+// Works out the step response of a finished capture on the device, so a
+// test needs one line over the serial link rather than the whole dump. band
+// is in microvolts either side of the final level, or negative for
+// CAPTURE_STEP_DEFAULT_BAND percent of it. Returns 0 if there's no finished
+// capture with samples from before the trigger.
+int get_capture_step(int band, capture_step_result *result) {
+	if(status != CAPTURE_DONE || pre == 0)
+		return 0;
+
+	int current_before, current_after;
+	int tail = (depth - pre + 3) / 4;
+	capture_mean(0, pre, &current_before, &result->before);
+	capture_mean(depth - tail, depth, &current_after, &result->after);
+	result->current_step = current_after - current_before;
+	if(band < 0)
+		band = abs(result->after) / 100 * CAPTURE_STEP_DEFAULT_BAND;
+
+	int peak = pre;
+	result->deviation = 0;
+	int last_outside = -1;
+	for(int i = pre; i < depth; i++) {
+		int voltage = voltage_from_raw(get_capture_sample(i)[1]);
+		if(abs(voltage - result->before) > abs(result->deviation)) {
+			result->deviation = voltage - result->before;
+			peak = i;
+		}
+		if(abs(voltage - result->after) > band)
+			last_outside = i;
+	}
+
+	// Past the final level the other way, after the peak: ringing back up
+	// after a dip, or down after a rise
+	result->overshoot = 0;
+	for(int i = peak; i < depth; i++) {
+		int past = voltage_from_raw(get_capture_sample(i)[1]) - result->after;
+		if(result->deviation < 0 && past > result->overshoot)
+			result->overshoot = past;
+		if(result->deviation > 0 && -past > result->overshoot)
+			result->overshoot = -past;
+	}
+
+	// The current's edge, between the first samples past 10% and 90% of the
+	// step. Resolved to the interval between samples.
+	int first = -1, last = -1;
+	for(int i = pre; i < depth && last < 0; i++) {
+		int64 moved = (int64)(current_from_raw(get_capture_sample(i)[0]) - current_before) * 10;
+		if(result->current_step < 0)
+			moved = -moved;
+		if(first < 0 && moved >= abs(result->current_step))
+			first = i;
+		if(first >= 0 && moved >= (int64)abs(result->current_step) * 9)
+			last = i;
+	}
+
+	uint32 interval = get_capture_interval();	// Nanoseconds
+	result->edge = (last < 0 || result->current_step == 0)?-1:((uint64)(last - first) * interval) / 1000;
+	if(last_outside == depth - 1) {
+		result->recovery = -1;
+	} else {
+		result->recovery = ((uint64)(last_outside + 1 - pre) * interval) / 1000;
+		if(last_outside < 0)
+			result->recovery = 0;
+	}
+	return 1;
+}
+
+#else
+
+int capture_start(capture_trigger trigger, int level, int new_depth, int new_pre) {
+	return 0;
+}
+
+void capture_stop() {
+}
+
+void capture_scan(const int16 *scan) {
+}
+
+void capture_external_edge() {
+}
+
+void capture_short_edge() {
+}
+
+capture_state get_capture_state() {
+	return CAPTURE_IDLE;
+}
+
+int get_capture_depth() {
+	return 0;
+}
+
+void get_capture_usage(buffer_usage *usage) {
+	*usage = (buffer_usage){0};
+}
+
+int get_capture_pre() {
+	return 0;
+}
+
+uint32 get_capture_interval() {
+	return 0;
+}
+
+const int16 *get_capture_sample(int i) {
+	return NULL;
+}
+
+int get_capture_step(int band, capture_step_result *result) {
+	return 0;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,119 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include "tasks.h"
+#include "config.h"
+
+// CPU clock scaling. Everything is clocked from HFCLK, which is the IMO, through
+// the dividers ClockSetup() in cyfitter_cfg.c programs for the design's rate,
+// CLOCK_ECO_HZ. The IMO is only ever set to whole multiples of that, and each
+// divider is scaled by the same ratio, so the ADC, UART, display SPI and
+// timestamp clocks keep their rates exactly and only the CPU and bus change.
+// SysTick counts CPU cycles and is re-derived to keep the tick rate.
+
+#define CLOCK_DIVIDER_MASK 0x0000FFFF // Divide ratio less one
+#define CLOCK_DIVIDER_CHAIN 0x40000000 // A B divider counting its A divider's output
+#define CLOCK_FRAC_MASK 0x001F0000 // 32nds, in the fractional divider
+#define CLOCK_FRAC_SHIFT 16
+
+// The integer dividers ClockSetup() enables, and start_timers()'s C00. A
+// chained one is left alone: its A divider is scaled already.
+static reg32 *const dividers[] = {
+	(reg32 *)CYREG_CLK_DIVIDER_A00,
+	(reg32 *)CYREG_CLK_DIVIDER_A01,
+	(reg32 *)CYREG_CLK_DIVIDER_B00,
+	(reg32 *)CYREG_CLK_DIVIDER_B01,
+	(reg32 *)CYREG_CLK_DIVIDER_C00,
+};
+
+static clock_mode mode = CLOCK_MODE_AUTO;
+static uint32 cpu_clock = CLOCK_ECO_HZ;
+static portTickType last_busy;
+
+static void scale_dividers(uint32 multiply, uint32 divide) {
+	for(int i = 0; i < sizeof(dividers) / sizeof(dividers[0]); i++) {
+		uint32 value = *dividers[i];
+		if(value & CLOCK_DIVIDER_CHAIN)
+			continue;
+		uint32 ratio = ((value & CLOCK_DIVIDER_MASK) + 1) * multiply / divide;
+		*dividers[i] = (value & ~CLOCK_DIVIDER_MASK) | (ratio - 1);
+	}
+
+	// The UART's, in 32nds
+	reg32 *frac = (reg32 *)CYREG_CLK_DIVIDER_FRAC_A00;
+	uint32 value = *frac;
+	uint32 ratio = ((value & CLOCK_DIVIDER_MASK) + 1) * 32 + ((value & CLOCK_FRAC_MASK) >> CLOCK_FRAC_SHIFT);
+	ratio = ratio * multiply / divide;
+	*frac = (value & ~(CLOCK_DIVIDER_MASK | CLOCK_FRAC_MASK)) | ((ratio & 0x1F) << CLOCK_FRAC_SHIFT) | ((ratio >> 5) - 1);
+}
+
+// Switches HFCLK to hz, CLOCK_ECO_HZ or CLOCK_PERFORMANCE_HZ. Interrupts are
+// off for the few microseconds the IMO takes to retrim. The UART should be
+// idle, as a byte on the wire during the change can be garbled.
+void set_cpu_clock(uint32 hz) {
+	uint32 old_mhz = cpu_clock / 1000000, mhz = hz / 1000000;
+	if(mhz == old_mhz)
+		return;
+
+	uint8 int_state = CyEnterCriticalSection();
+	if(mhz > old_mhz) {
+		// Wait states before speeding up, and the peripherals slowed first so
+		// none of them ever runs fast
+		CySysFlashSetWaitCycles(mhz);
+		scale_dividers(mhz, old_mhz);
+		CySysClkWriteImoFreq(mhz);
+	} else {
+		CySysClkWriteImoFreq(mhz);
+		scale_dividers(mhz, old_mhz);
+		CySysFlashSetWaitCycles(mhz);
+	}
+	vPortSetTickClock(cpu_clock, hz);
+	CyDelayFreq(hz);
+	cpu_clock = hz;
+	CyExitCriticalSection(int_state);
+}
+
+uint32 get_cpu_clock() {
+	return cpu_clock;
+}
+
+void set_clock_mode(clock_mode new_mode) {
+	mode = new_mode;
+}
+
+clock_mode get_clock_mode() {
+	return mode;
+}
+
+// The clock the mode calls for now. Auto runs fast while current is flowing,
+// the binary stream is on or a capture is waiting for its trigger, and drops
+// back once there's been nothing to do for CLOCK_IDLE_MS.
+uint32 get_clock_target() {
+	if(mode == CLOCK_MODE_ECO)
+		return CLOCK_ECO_HZ;
+	if(mode == CLOCK_MODE_PERFORMANCE)
+		return CLOCK_PERFORMANCE_HZ;
+
+	portTickType now = xTaskGetTickCount();
+	if((get_output_mode() != OUTPUT_MODE_OFF && state.current_setpoint > 0)
+	   || get_output_mode() == OUTPUT_MODE_ON || get_stream_interval() > 0
+	   || get_capture_state() >= CAPTURE_ARMED) {
+		last_busy = now;
+		return CLOCK_PERFORMANCE_HZ;
+	}
+	return (now - last_busy < CLOCK_IDLE_MS / portTICK_RATE_MS)?cpu_clock:CLOCK_ECO_HZ;
+}
+
+/* [] END OF FILE */
@@ -1,6 +1,6 @@
 /* ANSI-C code produced by gperf version 3.0.4 */
 /* Command-line: gperf -m 100 tools/serial_keywords  */
-/* Computed positions: -k'1' */
+/* Computed positions: -k'1,2,4' */
 
 #if !((' ' == 32) && ('!' == 33) && ('"' == 34) && ('#' == 35) \
       && ('%' == 37) && ('&' == 38) && ('\'' == 39) && ('(' == 40) \
@@ -31,30 +31,79 @@
 
 #line 1 "tools/serial_keywords"
 
-typedef void (*command_func)(char *);
+// The handlers, taking the command types from config.h
 
-typedef struct command_def {
-    const char *name;
-    command_func handler;
-} command_def;
+void command_mode(char *, const command_args *);
+void command_set(char *, const command_args *);
+void command_reset(char *, const command_args *);
+void command_read(char *, const command_args *);
+void command_monitor(char *, const command_args *);
+void command_credit(char *, const command_args *);
+void command_debug(char *, const command_args *);
+void command_filter(char *, const command_args *);
+void command_stream(char *, const command_args *);
+void command_pulse(char *, const command_args *);
+void command_awg(char *, const command_args *);
+void command_sequence(char *, const command_args *);
+void command_boot(char *, const command_args *);
+void command_remote(char *, const command_args *);
+void command_baud(char *, const command_args *);
+void command_status(char *, const command_args *);
+void command_log(char *, const command_args *);
+void command_address(char *, const command_args *);
+void command_trigger(char *, const command_args *);
+void command_sync(char *, const command_args *);
+void command_stats(char *, const command_args *);
+void command_bench(char *, const command_args *);
+void command_refresh(char *, const command_args *);
+void command_energy(char *, const command_args *);
+void command_standby(char *, const command_args *);
+void command_battery(char *, const command_args *);
+void command_sweep(char *, const command_args *);
+void command_impedance(char *, const command_args *);
+void command_capture(char *, const command_args *);
+void command_ripple(char *, const command_args *);
+void command_ir(char *, const command_args *);
+void command_tune(char *, const command_args *);
+void command_watch(char *, const command_args *);
+void command_ocp(char *, const command_args *);
+void command_loadreg(char *, const command_args *);
+void command_short(char *, const command_args *);
+void command_output(char *, const command_args *);
+void command_mppt(char *, const command_args *);
+void command_cal(char *, const command_args *);
+void command_temp(char *, const command_args *);
+void command_adc(char *, const command_args *);
+void command_slew(char *, const command_args *);
+void command_trim(char *, const command_args *);
+void command_trace(char *, const command_args *);
+void command_ping(char *, const command_args *);
+void command_bootload(char *, const command_args *);
+void command_selftest(char *, const command_args *);
+void command_faults(char *, const command_args *);
+void command_limits(char *, const command_args *);
+void command_events(char *, const command_args *);
+void command_powerfail(char *, const command_args *);
+void command_clock(char *, const command_args *);
+void command_preset(char *, const command_args *);
+void command_poweron(char *, const command_args *);
+void command_id(char *, const command_args *);
+void command_caps(char *, const command_args *);
+void command_macro(char *, const command_args *);
+void command_run(char *, const command_args *);
+void command_config(char *, const command_args *);
+void command_mem(char *, const command_args *);
 
-void command_mode(char*);
-void command_set(char *);
-void command_reset(char *);
-void command_read(char *);
-void command_monitor(char *);
-void command_debug(char *);
-
-#line 17 "tools/serial_keywords"
+#line 66 "tools/serial_keywords"
 struct command_def;
 #include <string.h>
 
-#define TOTAL_KEYWORDS 6
-#define MIN_WORD_LENGTH 3
-#define MAX_WORD_LENGTH 7
-#define MIN_HASH_VALUE 3
-#define MAX_HASH_VALUE 8
-/* maximum key range = 6, duplicates = 0 */
+#define TOTAL_KEYWORDS 60
+#define MIN_WORD_LENGTH 2
+#define MAX_WORD_LENGTH 9
+#define MIN_HASH_VALUE 55
+#define MAX_HASH_VALUE 178
+/* maximum key range = 124, duplicates = 0 */
 
 #if (defined (__STDC_VERSION__) && __STDC_VERSION__ >= 199901L) || defined(__cplusplus) || defined(__GNUC_STDC_INLINE__)
 inline
@@ -66,21 +115,36 @@ hash (register const char *str, register unsigned int len)
 {
   static const unsigned char asso_values[] =
     {
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-      3, 9, 9, 9, 9, 9, 9, 9, 9, 0,
-      9, 9, 9, 9, 1, 0, 9, 9, 9, 9,
-      9, 9, 9, 9, 9, 9, 9, 9
+     179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+     179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+     179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+     179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+     179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+     179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+     179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+     179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+     179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+     179, 179, 179, 179, 179, 179, 179,  50,  66,  42,
+      36,  37,  59,  57,  14,  21, 179, 179,  53,  25,
+      67,  13,  39, 179,  67,  28,  39,  13,  19,   2,
+     179,  41, 179, 179, 179, 179, 179, 179
     };
-  return len + asso_values[(unsigned char)str[0]];
+  register int hval = len;
+
+  switch (hval)
+    {
+      default:
+        hval += asso_values[(unsigned char)str[3]];
+      /*FALLTHROUGH*/
+      case 3:
+      case 2:
+        hval += asso_values[(unsigned char)str[1]];
+      /*FALLTHROUGH*/
+      case 1:
+        hval += asso_values[(unsigned char)str[0]];
+        break;
+    }
+  return hval;
 }
 
 #ifdef __GNUC__
@@ -94,18 +158,126 @@ in_word_set (register const char *str, register unsigned int len)
 {
   static const struct command_def wordlist[] =
     {
-#line 26 "tools/serial_keywords"
-      {"set",command_set},
-#line 25 "tools/serial_keywords"
+#line 84 "tools/serial_keywords"
+      {"awg",command_awg},
+#line 107 "tools/serial_keywords"
+      {"ocp",command_ocp},
+#line 128 "tools/serial_keywords"
+      {"id",command_id},
+#line 133 "tools/serial_keywords"
+      {"mem",command_mem},
+#line 78 "tools/serial_keywords"
+      {"monitor",command_monitor,"i"},
+#line 75 "tools/serial_keywords"
+      {"set",command_set,"[A]"},
+#line 90 "tools/serial_keywords"
+      {"log",command_log},
+#line 110 "tools/serial_keywords"
+      {"output",command_output},
+#line 100 "tools/serial_keywords"
+      {"sweep",command_sweep},
+#line 74 "tools/serial_keywords"
       {"mode",command_mode},
-#line 28 "tools/serial_keywords"
+#line 131 "tools/serial_keywords"
+      {"run",command_run},
+#line 83 "tools/serial_keywords"
+      {"pulse",command_pulse},
+#line 85 "tools/serial_keywords"
+      {"sequence",command_sequence},
+#line 115 "tools/serial_keywords"
+      {"slew",command_slew},
+#line 114 "tools/serial_keywords"
+      {"adc",command_adc},
+#line 104 "tools/serial_keywords"
+      {"ir",command_ir},
+#line 80 "tools/serial_keywords"
+      {"debug",command_debug},
+#line 101 "tools/serial_keywords"
+      {"impedance",command_impedance},
+#line 105 "tools/serial_keywords"
+      {"tune",command_tune},
+#line 112 "tools/serial_keywords"
+      {"cal",command_cal},
+#line 127 "tools/serial_keywords"
+      {"poweron",command_poweron},
+#line 124 "tools/serial_keywords"
+      {"powerfail",command_powerfail},
+#line 106 "tools/serial_keywords"
+      {"watch",command_watch},
+#line 122 "tools/serial_keywords"
+      {"limits",command_limits,"[VV]"},
+#line 111 "tools/serial_keywords"
+      {"mppt",command_mppt},
+#line 108 "tools/serial_keywords"
+      {"loadreg",command_loadreg},
+#line 82 "tools/serial_keywords"
+      {"stream",command_stream},
+#line 94 "tools/serial_keywords"
+      {"stats",command_stats},
+#line 89 "tools/serial_keywords"
+      {"status",command_status},
+#line 109 "tools/serial_keywords"
+      {"short",command_short},
+#line 93 "tools/serial_keywords"
+      {"sync",command_sync},
+#line 113 "tools/serial_keywords"
+      {"temp",command_temp},
+#line 132 "tools/serial_keywords"
+      {"config",command_config,"[{begin|commit|abort}]"},
+#line 118 "tools/serial_keywords"
+      {"ping",command_ping},
+#line 86 "tools/serial_keywords"
+      {"boot",command_boot,"[{normal|fast}]"},
+#line 87 "tools/serial_keywords"
+      {"remote",command_remote,"[{off|on|auto|manual}]"},
+#line 129 "tools/serial_keywords"
+      {"caps",command_caps},
+#line 81 "tools/serial_keywords"
+      {"filter",command_filter},
+#line 119 "tools/serial_keywords"
+      {"bootload",command_bootload},
+#line 123 "tools/serial_keywords"
+      {"events",command_events},
+#line 120 "tools/serial_keywords"
+      {"selftest",command_selftest},
+#line 103 "tools/serial_keywords"
+      {"ripple",command_ripple},
+#line 116 "tools/serial_keywords"
+      {"trim",command_trim},
+#line 102 "tools/serial_keywords"
+      {"capture",command_capture},
+#line 126 "tools/serial_keywords"
+      {"preset",command_preset},
+#line 98 "tools/serial_keywords"
+      {"standby",command_standby},
+#line 125 "tools/serial_keywords"
+      {"clock",command_clock},
+#line 77 "tools/serial_keywords"
       {"read",command_read},
-#line 27 "tools/serial_keywords"
+#line 76 "tools/serial_keywords"
       {"reset",command_reset},
-#line 29 "tools/serial_keywords"
-      {"monitor",command_monitor},
-#line 30 "tools/serial_keywords"
-      {"debug",command_debug}
+#line 130 "tools/serial_keywords"
+      {"macro",command_macro},
+#line 95 "tools/serial_keywords"
+      {"bench",command_bench},
+#line 79 "tools/serial_keywords"
+      {"credit",command_credit,"i"},
+#line 117 "tools/serial_keywords"
+      {"trace",command_trace},
+#line 88 "tools/serial_keywords"
+      {"baud",command_baud},
+#line 91 "tools/serial_keywords"
+      {"address",command_address,"[i]"},
+#line 99 "tools/serial_keywords"
+      {"battery",command_battery},
+#line 121 "tools/serial_keywords"
+      {"faults",command_faults},
+#line 92 "tools/serial_keywords"
+      {"trigger",command_trigger},
+#line 97 "tools/serial_keywords"
+      {"energy",command_energy},
+#line 96 "tools/serial_keywords"
+      {"refresh",command_refresh,"[i]"}
     };
 
   if (len <= MAX_WORD_LENGTH && len >= MIN_WORD_LENGTH)
@@ -116,26 +288,188 @@ in_word_set (register const char *str, register unsigned int len)
         {
           register const struct command_def *resword;
 
-          switch (key - 3)
+          switch (key - 55)
             {
               case 0:
                 resword = &wordlist[0];
                 goto compare;
-              case 1:
+              case 3:
                 resword = &wordlist[1];
                 goto compare;
-              case 2:
+              case 4:
                 resword = &wordlist[2];
                 goto compare;
-              case 3:
+              case 10:
                 resword = &wordlist[3];
                 goto compare;
-              case 4:
+              case 11:
                 resword = &wordlist[4];
                 goto compare;
-              case 5:
+              case 13:
                 resword = &wordlist[5];
                 goto compare;
+              case 14:
+                resword = &wordlist[6];
+                goto compare;
+              case 16:
+                resword = &wordlist[7];
+                goto compare;
+              case 17:
+                resword = &wordlist[8];
+                goto compare;
+              case 24:
+                resword = &wordlist[9];
+                goto compare;
+              case 28:
+                resword = &wordlist[10];
+                goto compare;
+              case 30:
+                resword = &wordlist[11];
+                goto compare;
+              case 31:
+                resword = &wordlist[12];
+                goto compare;
+              case 32:
+                resword = &wordlist[13];
+                goto compare;
+              case 34:
+                resword = &wordlist[14];
+                goto compare;
+              case 35:
+                resword = &wordlist[15];
+                goto compare;
+              case 36:
+                resword = &wordlist[16];
+                goto compare;
+              case 37:
+                resword = &wordlist[17];
+                goto compare;
+              case 38:
+                resword = &wordlist[18];
+                goto compare;
+              case 40:
+                resword = &wordlist[19];
+                goto compare;
+              case 41:
+                resword = &wordlist[20];
+                goto compare;
+              case 43:
+                resword = &wordlist[21];
+                goto compare;
+              case 44:
+                resword = &wordlist[22];
+                goto compare;
+              case 46:
+                resword = &wordlist[23];
+                goto compare;
+              case 52:
+                resword = &wordlist[24];
+                goto compare;
+              case 54:
+                resword = &wordlist[25];
+                goto compare;
+              case 55:
+                resword = &wordlist[26];
+                goto compare;
+              case 56:
+                resword = &wordlist[27];
+                goto compare;
+              case 57:
+                resword = &wordlist[28];
+                goto compare;
+              case 59:
+                resword = &wordlist[29];
+                goto compare;
+              case 60:
+                resword = &wordlist[30];
+                goto compare;
+              case 64:
+                resword = &wordlist[31];
+                goto compare;
+              case 65:
+                resword = &wordlist[32];
+                goto compare;
+              case 66:
+                resword = &wordlist[33];
+                goto compare;
+              case 67:
+                resword = &wordlist[34];
+                goto compare;
+              case 68:
+                resword = &wordlist[35];
+                goto compare;
+              case 69:
+                resword = &wordlist[36];
+                goto compare;
+              case 70:
+                resword = &wordlist[37];
+                goto compare;
+              case 71:
+                resword = &wordlist[38];
+                goto compare;
+              case 74:
+                resword = &wordlist[39];
+                goto compare;
+              case 77:
+                resword = &wordlist[40];
+                goto compare;
+              case 78:
+                resword = &wordlist[41];
+                goto compare;
+              case 80:
+                resword = &wordlist[42];
+                goto compare;
+              case 83:
+                resword = &wordlist[43];
+                goto compare;
+              case 85:
+                resword = &wordlist[44];
+                goto compare;
+              case 86:
+                resword = &wordlist[45];
+                goto compare;
+              case 87:
+                resword = &wordlist[46];
+                goto compare;
+              case 89:
+                resword = &wordlist[47];
+                goto compare;
+              case 91:
+                resword = &wordlist[48];
+                goto compare;
+              case 92:
+                resword = &wordlist[49];
+                goto compare;
+              case 95:
+                resword = &wordlist[50];
+                goto compare;
+              case 96:
+                resword = &wordlist[51];
+                goto compare;
+              case 98:
+                resword = &wordlist[52];
+                goto compare;
+              case 101:
+                resword = &wordlist[53];
+                goto compare;
+              case 105:
+                resword = &wordlist[54];
+                goto compare;
+              case 107:
+                resword = &wordlist[55];
+                goto compare;
+              case 113:
+                resword = &wordlist[56];
+                goto compare;
+              case 115:
+                resword = &wordlist[57];
+                goto compare;
+              case 122:
+                resword = &wordlist[58];
+                goto compare;
+              case 123:
+                resword = &wordlist[59];
+                goto compare;
             }
           return 0;
         compare:
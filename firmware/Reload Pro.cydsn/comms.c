@@ -12,123 +12,3576 @@
 
 #include <FreeRTOS.h>
 #include <task.h>
-#include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include "project.h"
 #include "tasks.h"
 #include "config.h"
 #include "commands.h"
+#include "lzfx.h"
 
-#define ARGUMENT_SEPERATORS " "
+xQueueHandle comms_queue;
+
+// Received lines and binary frames are stored in a ring, so a host can send
+// several commands without waiting for each reply. Each entry is a length byte
+// followed by the data and a NUL, and never wraps, so the comms task parses it
+// where it lies. An entry that reaches the end of the buffer is moved to the
+// start, leaving a zero length byte behind to send the reader there too. The
+// ISR only moves rx_head and rx_line_start; the comms task only moves rx_read
+// and rx_tail, which trails it until the lines read have been dealt with.
+#define RX_ERROR_TOO_LONG 1
+#define RX_ERROR_OVERFLOW 2
+
+static char rx_buffer[COMMS_RX_BUFFER_SIZE];
+static uint8 rx_head = 1;
+static volatile uint8 rx_tail = 0;
+static uint8 rx_read = 0;
+static uint8 rx_line_start = 0; // The length byte of the line being received
+static volatile uint8 rx_lines = 0; // Complete lines waiting in the ring
+static volatile uint8 rx_errors = 0;
+static uint8 rx_peak = 0; // Most bytes ever in use, for 'mem'
+
+// When each waiting line was completed, in the order they were, and when the
+// task took the one it's running, for 'ping'. More lines waiting than there
+// are slots only costs the oldest of them their times.
+static uint32 rx_times[COMMS_RX_TIMES];
+static uint8 rx_times_head = 0, rx_times_read = 0;
+static uint32 line_rx_time, line_start_time;
+
+// Output is queued in another ring and drained into the UART FIFO by the TX
+// interrupt, so the comms task doesn't wait on the serial line. The task only
+// moves tx_head; the ISR only moves tx_tail.
+static uint8 tx_buffer[COMMS_TX_BUFFER_SIZE];
+static volatile uint8 tx_head = 0, tx_tail = 0;
+static uint8 tx_high_water = 0; // Most bytes ever waiting in tx_buffer
+
+static uint8 tx_used() {
+	// Kept in range before the modulo, as the indices promote to int
+	return (tx_head + COMMS_TX_BUFFER_SIZE - tx_tail) % COMMS_TX_BUFFER_SIZE;
+}
+
+static void fill_tx_fifo() {
+	while(tx_tail != tx_head && UART_SpiUartGetTxBufferSize() < UART_FIFO_SIZE) {
+		UART_SpiUartWriteTxData(tx_buffer[tx_tail]);
+		tx_tail = (tx_tail + 1) % COMMS_TX_BUFFER_SIZE;
+	}
+	// Stay quiet until there's more to send
+	if(tx_tail == tx_head)
+		UART_SetTxInterruptMode(0);
+	UART_ClearTxInterruptSource(UART_INTR_TX_NOT_FULL);
+}
+
+// Queues len bytes for sending without waiting. Either all of them are queued
+// and 1 is returned, or there isn't room and nothing is queued.
+int uart_try_write(const uint8 *data, uint8 len) {
+	if(len >= COMMS_TX_BUFFER_SIZE - tx_used())
+		return 0;
+
+	uint8 head = tx_head;
+	for(uint8 i = 0; i < len; i++) {
+		tx_buffer[head] = data[i];
+		head = (head + 1) % COMMS_TX_BUFFER_SIZE;
+	}
+
+	uint8 int_state = CyEnterCriticalSection();
+	tx_head = head;
+	if(tx_used() > tx_high_water)
+		tx_high_water = tx_used();
+	UART_SetTxInterruptMode(UART_INTR_TX_NOT_FULL);
+	CyExitCriticalSection(int_state);
+	return 1;
+}
+
+// Queues len bytes for sending, sleeping only while the buffer is too full
+// Set while handling a broadcast, so units sharing a bus don't all answer,
+// and while 'config commit' runs its lines, which counts the errors instead
+static uint8 tx_muted = 0;
+static uint8 tx_counting = 0;
+static uint8 tx_errors;
+
+void uart_write(const uint8 *data, int len) {
+	if(tx_counting && len >= 4 && memcmp(data, "err ", 4) == 0)
+		tx_errors++;
+	if(tx_muted)
+		return;
+	TRACE_EVENT(TRACE_TX, len);
+	while(len > 0) {
+		uint8 chunk = (len > COMMS_TX_BUFFER_SIZE / 2)?COMMS_TX_BUFFER_SIZE / 2:len;
+		while(!uart_try_write(data, chunk))
+			vTaskDelay(1);
+		data += chunk;
+		len -= chunk;
+	}
+}
+
+void uart_puts(const char *s) {
+	uart_write((const uint8 *)s, strlen(s));
+}
+
+static uint32 current_baud = COMMS_DEFAULT_BAUD;
+
+// Waits for everything queued to be sent, including the last byte's stop bit
+static void uart_drain() {
+	while(tx_used() > 0 || UART_SpiUartGetTxBufferSize() > 0)
+		vTaskDelay(1);
+	vTaskDelay(1);
+}
+
+// Moves to the clock the mode wants, between bytes
+static void apply_clock_target() {
+	uint32 hz = get_clock_target();
+	if(hz != get_cpu_clock()) {
+		uart_drain();
+		set_cpu_clock(hz);
+	}
+}
+
+// Reprograms the UART for the nearest rate to baud that the oversampling
+// factor (8-16) and fractional clock divider can make. Returns 0 without
+// changing anything if none is within 2%.
+static uint32 set_baud(uint32 baud) {
+	uint32 best_div32 = 0, best_rate = 0, best_error = baud / 50;
+	uint8 best_ovs = 0;
+
+	for(uint8 ovs = 16; ovs >= 8; ovs--) {
+		// The divider is in 32nds of HFCLK
+		uint32 div32 = ((get_cpu_clock() * 32u) / ovs + baud / 2) / baud;
+		if(div32 < 32 || div32 >= (0x10000u << 5))
+			continue;
+		uint32 rate = (get_cpu_clock() * 32u) / (div32 * ovs);
+		uint32 error = (rate > baud)?rate - baud:baud - rate;
+		if(error <= best_error) {
+			best_error = error;
+			best_div32 = div32;
+			best_ovs = ovs;
+			best_rate = rate;
+		}
+	}
+	if(best_ovs == 0)
+		return 0;
+
+	// Let the last byte finish at the old rate
+	uart_drain();
+	UART_Stop();
+	UART_Clock_SetFractionalDividerRegister((best_div32 >> 5) - 1, best_div32 & 0x1F);
+	UART_CTRL_REG = (UART_CTRL_REG & ~UART_CTRL_OVS_MASK) | UART_GET_CTRL_OVS(best_ovs);
+	UART_Enable();
+	current_baud = baud;
+	return best_rate;
+}
+
+int get_baud() {
+	return current_baud;
+}
+
+// For the UI: has the comms task switch rates once its output is sent. There's
+// no handshake, so a host has to be told by other means.
+static volatile uint32 requested_baud;
+
+int request_baud(int baud) {
+	requested_baud = baud;
+	xQueueSendToBack(comms_queue, &((comms_event){.type=COMMS_EVENT_BAUD}), portMAX_DELAY);
+	return 1;
+}
+
+// Moves the line being received to the start of the buffer. Returns 0 if the
+// reader hasn't freed enough room there yet.
+static int rx_wrap() {
+	uint8 tail = rx_tail;
+	uint8 used = rx_head - rx_line_start;
+	if((tail != rx_line_start && tail <= used + 2) || used + 2 >= rx_line_start)
+		return 0;
+
+	memmove(rx_buffer, &rx_buffer[rx_line_start], used);
+	rx_buffer[rx_line_start] = 0;
+	rx_line_start = 0;
+	rx_head = used;
+	return 1;
+}
+
+// Adds a received byte to the line being received. Returns 0 if it doesn't fit.
+static int rx_store(char c, uint8 line_length) {
+	if(line_length >= MAX_COMMS_LINE_LENGTH) {
+		rx_errors |= RX_ERROR_TOO_LONG;
+		return 0;
+	}
+	// The byte, the terminator rx_commit() puts after it and the next line's
+	// length byte must all land short of rx_tail. Checking the distance, not
+	// for one exact slot, means head can never reach tail and make a full ring
+	// look empty.
+	uint8 tail = rx_tail;
+	if(rx_head <= tail ? rx_head + 2 >= tail :
+			(rx_head + 2 >= COMMS_RX_BUFFER_SIZE && !rx_wrap())) {
+		rx_errors |= RX_ERROR_OVERFLOW;
+		return 0;
+	}
+	rx_buffer[rx_head++] = c;
+	uint8 used = (rx_head >= tail)?rx_head - tail:rx_head + COMMS_RX_BUFFER_SIZE - tail;
+	if(used > rx_peak)
+		rx_peak = used;
+	return 1;
+}
+
+// Hands the line being received to the comms task
+static void rx_commit(uint8 line_length) {
+	rx_buffer[rx_line_start] = line_length;
+	rx_buffer[rx_head] = '\0';
+	rx_line_start = rx_head + 1;
+	rx_head += 2;
+	rx_lines++;
+	rx_times[rx_times_head++ % COMMS_RX_TIMES] = get_time_us();
+	TRACE_EVENT(TRACE_LINE_RX, line_length);
+	// If the queue is full the task is due to wake anyway, and it handles
+	// every waiting line when it does
+	xQueueSendToBackFromISR(comms_queue, &(comms_event){.type=COMMS_EVENT_LINE_RX}, NULL);
+}
+
+#define OPCODE_FAST_SET 0x10
+
+// Posts a fast set frame for this unit straight to the control loop and
+// returns 1, or returns 0 to leave the frame to the comms task: broadcasts,
+// which arm a synchronised set there, and anything malformed, which gets its
+// FRAME_ERROR there.
+static int take_fast_set(const uint8 *frame, uint8 len) {
+	const uint8 *header = &frame[1];
+	int address = 0;
+	if(frame[0] == FRAME_SYNC_ADDRESSED)
+		address = *header++;
+	uint8 header_length = header + 2 - frame;
+	int32 setpoint;
+	uint16 crc;
+
+	if(address != settings->address || header[0] != OPCODE_FAST_SET ||
+			header[1] != sizeof(setpoint) || len != header_length + sizeof(setpoint) + sizeof(crc))
+		return 0;
+	memcpy(&crc, &frame[header_length + sizeof(setpoint)], sizeof(crc));
+	if(crc16_update(0xFFFF, &frame[1], header_length - 1 + sizeof(setpoint)) != crc)
+		return 0;
+	memcpy(&setpoint, &frame[header_length], sizeof(setpoint));
+	control_post_setpoint(setpoint);
+	return 1;
+}
+
+void UART_ISR_func() {
+	uint32 entry_ticks = CySysTickGetValue();
+	static uint8 line_length = 0;
+	static uint16 frame_remaining = 0; // Bytes still to come of a binary frame
+	static uint8 frame_pos = 0; // Bytes of the binary frame received so far
+	static uint8 frame_header; // Bytes up to and including the length
+	static uint8 discarding = 0; // Skipping the rest of a line that didn't fit
+	
+	uint32 nchars = UART_SpiUartGetRxBufferSize();
+	for(int i = 0; i < nchars; i++) {
+		char c = UART_UartGetChar();
+		if(frame_remaining > 0 || (line_length == 0 && !discarding &&
+				(c == (char)FRAME_SYNC || c == (char)FRAME_SYNC_ADDRESSED))) {
+			// Binary frames are counted out by their length byte, not by newlines
+			if(frame_remaining == 0) {
+				frame_header = (c == (char)FRAME_SYNC)?FRAME_HEADER_LENGTH:FRAME_HEADER_LENGTH + 1;
+				frame_remaining = frame_header;
+				frame_pos = 0;
+			}
+			frame_remaining--;
+			if(++frame_pos == frame_header)
+				frame_remaining = (uint8)c + 2; // Payload and CRC
+
+			if(discarding) {
+				if(frame_remaining == 0) {
+					discarding = 0;
+					xQueueSendToBackFromISR(comms_queue, &(comms_event){.type=COMMS_EVENT_LINE_RX}, NULL);
+				}
+			} else if(rx_store(c, line_length)) {
+				line_length++;
+				if(frame_remaining == 0) {
+					// A fast set never reaches the ring's reader
+					if(take_fast_set((uint8*)&rx_buffer[rx_line_start + 1], line_length))
+						rx_head = rx_line_start + 1;
+					else
+						rx_commit(line_length);
+					line_length = 0;
+				}
+			} else {
+				// Drop the partial frame, skipping what's left of it
+				rx_head = rx_line_start + 1;
+				line_length = 0;
+				discarding = (frame_remaining > 0);
+			}
+			continue;
+		}
+
+		switch(c) {
+		case '\n':
+		case '\r':
+			if(discarding) {
+				discarding = 0;
+				// Let the task report the error
+				xQueueSendToBackFromISR(comms_queue, &(comms_event){.type=COMMS_EVENT_LINE_RX}, NULL);
+			} else if(line_length > 0) {
+				rx_commit(line_length);
+			}
+			line_length = 0;
+			break;
+		case 0:
+			break;
+		default:
+			if(discarding)
+				break;
+			if(rx_store(c, line_length)) {
+				line_length++;
+			} else {
+				// Drop the partial line
+				rx_head = rx_line_start + 1;
+				line_length = 0;
+				discarding = 1;
+			}
+			break;
+		}
+	}
+	
+	UART_ClearRxInterruptSource(UART_GetRxInterruptSourceMasked());
+
+	if(UART_GetTxInterruptSourceMasked() & UART_INTR_TX_NOT_FULL)
+		fill_tx_fifo();
+	profile_isr(PROFILE_ISR_UART, entry_ticks);
+}
+
+// Returns the oldest unread line or frame, NUL terminated, or NULL if there
+// isn't one. It stays in the ring and may be modified until release_lines.
+static char *read_line(uint8 *length) {
+	if(rx_lines == 0)
+		return NULL;
+
+	uint8 int_state = CyEnterCriticalSection();
+	rx_lines--;
+	CyExitCriticalSection(int_state);
+	line_rx_time = rx_times[rx_times_read++ % COMMS_RX_TIMES];
+	line_start_time = get_time_us();
+
+	if(rx_buffer[rx_read] == 0)
+		rx_read = 0; // Moved to the start by rx_wrap
+	char *line = &rx_buffer[rx_read + 1];
+	*length = rx_buffer[rx_read];
+	rx_read += *length + 2;
+	return line;
+}
+
+// Frees every line read so far for more input
+static void release_lines() {
+	rx_tail = rx_read;
+}
+
+static void report_rx_errors() {
+	uint8 int_state = CyEnterCriticalSection();
+	uint8 errors = rx_errors;
+	rx_errors = 0;
+	CyExitCriticalSection(int_state);
+
+	if(errors & RX_ERROR_TOO_LONG)
+		uart_puts("err line too long\r\n");
+	if(errors & RX_ERROR_OVERFLOW)
+		uart_puts("err receive buffer overflow\r\n");
+}
+
+void write_state_data() {
+	char response[32];
+	measurement m;
+	get_measurement(&m);
+	format(response, "read %d %d\r\n", (int)div1000(m.current), (int)div1000(m.voltage));
+	uart_puts(response);
+}
+
+// The channel records' layout: each stream_channel's name in 'stream', and
+// its size on the wire
+static const char *const stream_channel_names[STREAM_CHANNELS] = {"i", "v", "p", "temp", "opamp", "fet", "set", "flags"};
+#ifdef USE_STREAM
+static const uint8 stream_channel_sizes[STREAM_CHANNELS] = {4, 4, 4, 2, 2, 2, 4, 2};
+static uint8 stream_header_due = 0;
+
+// Flow control (see STREAM_DEGRADED_EVERY in tasks.h), and the records it has
+// held back since the stream started
+static uint8 stream_flow = 0;
+static uint16 stream_credits = 0;
+static uint8 stream_degraded_countdown = 0;
+static uint16 stream_withheld = 0;
+
+static void write_stream_header() {
+	uint8 header[3 + 3 * STREAM_CHANNELS + 2];
+	uint8 *p = &header[3];
+	header[0] = STREAM_SYNC_HEADER;
+	header[1] = get_stream_interval();
+	for(int i = 0; i < STREAM_CHANNELS; i++) {
+		if(get_stream_channels() & (1 << i)) {
+			*p++ = i;
+			*p++ = stream_channel_sizes[i];
+			*p++ = get_stream_every(i);
+		}
+	}
+	header[2] = (p - &header[3]) / 3;
+	uint16 crc = crc16_update(0xFFFF, &header[1], p - &header[1]);
+	memcpy(p, &crc, sizeof(crc));
+	uart_write(header, p + sizeof(crc) - header);
+	stream_header_due = 0;
+}
+
+static void write_stream_sample(const stream_sample *sample) {
+	if(sample->sync == STREAM_SYNC) {
+		stream_record record = {
+			.sync = STREAM_SYNC,
+			.sequence = sample->sequence,
+			.timestamp = timesync_convert(sample->timestamp),
+			.current = sample->current,
+			.voltage = sample->voltage,
+			.flags = sample->flags,
+		};
+		record.crc = crc16_update(0xFFFF, (uint8*)&record.sequence, offsetof(stream_record, crc) - offsetof(stream_record, sequence));
+		uart_write((uint8*)&record, sizeof(record));
+		return;
+	}
+
+	if(stream_header_due || sample->sequence % STREAM_HEADER_INTERVAL == 0)
+		write_stream_header();
+
+	int32 values[STREAM_CHANNELS] = {
+		sample->current, sample->voltage, 0, sample->temperature,
+		sample->opamp, sample->fet, sample->setpoint, sample->flags | (sample->mode << 8),
+	};
+	if(sample->present & (1 << STREAM_POWER))
+		values[STREAM_POWER] = ((int64)sample->current * sample->voltage) / 1000000;
+
+	uint16 dropped = sample->dropped + stream_withheld;
+	uint32 timestamp = timesync_convert(sample->timestamp);
+	uint8 record[10 + 4 * STREAM_CHANNELS + 2];
+	uint8 *p = &record[10];
+	record[0] = STREAM_SYNC_CHANNELS;
+	memcpy(&record[1], &sample->sequence, sizeof(sample->sequence));
+	memcpy(&record[3], &timestamp, sizeof(timestamp));
+	record[7] = sample->present;
+	memcpy(&record[8], &dropped, sizeof(dropped));
+	for(int i = 0; i < STREAM_CHANNELS; i++) {
+		if(sample->present & (1 << i)) {
+			// Little-endian, so the low bytes are the narrower channels' values
+			memcpy(p, &values[i], stream_channel_sizes[i]);
+			p += stream_channel_sizes[i];
+		}
+	}
+	uint16 crc = crc16_update(0xFFFF, &record[1], p - &record[1]);
+	memcpy(p, &crc, sizeof(crc));
+	uart_write(record, p + sizeof(crc) - record);
+}
+
+static void write_stream_records() {
+	stream_sample sample;
+	while(xQueueReceive(stream_queue, &sample, 0)) {
+		if(stream_flow) {
+			if(stream_credits > 0) {
+				stream_credits--;
+			} else if(stream_degraded_countdown-- > 0) {
+				stream_withheld++;
+				continue;
+			} else {
+				stream_degraded_countdown = STREAM_DEGRADED_EVERY - 1;
+			}
+		}
+		write_stream_sample(&sample);
+	}
+}
+#else
+// Nothing posts the event in builds without USE_STREAM, which have no queue
+static void write_stream_records() {
+}
+#endif
+
+void write_invalid_command(const char *cmdname) {
+	char response[32];
+	format(response, "err Unknown command '%.7s'\r\n", cmdname);
+	uart_puts(response);
+}
+
+// For the commands of features config.h leaves out
+static void write_not_built(const char *option) {
+	uart_puts("err built without ");
+	uart_puts(option);
+	uart_puts("\r\n");
+}
+
+static void write_mode() {
+	char response[32];
+
+	switch(get_load_mode()) {
+	case LOAD_MODE_CV:
+		format(response, "mode cv %d\r\n", (int)div1000(get_voltage_target()));
+		break;
+	case LOAD_MODE_CR:
+		format(response, "mode cr %d\r\n", (int)div1000(get_resistance_target()));
+		break;
+	case LOAD_MODE_CP:
+		format(response, "mode cp %d\r\n", get_power_target());
+		break;
+	case LOAD_MODE_PULSE:
+		strcpy(response, "mode pulse\r\n");
+		break;
+	default:
+		strcpy(response, "mode cc\r\n");
+		break;
+	}
+	uart_puts(response);
+}
+
+// Parses a mode name as used by 'mode' and 'sequence add'. Returns 0 if unknown.
+static const char *mode_names[] = {"cc", "cv", "cr", "cp", "pulse"};
+
+static int parse_mode(const char *name, load_mode *mode) {
+	// Pulse mode is entered with the 'pulse' command
+	for(int i = 0; i < LOAD_MODE_PULSE; i++) {
+		if(strcmp(name, mode_names[i]) == 0) {
+			*mode = i;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// Parses a target for mode into the units it's held in. Bare numbers are in
+// the wire units, mA, mV, ohms or mW; with a prefix or symbol, as given.
+static int parse_target(load_mode mode, const char *text, int32 *target) {
+	static const char quantities[] = {'A', 'V', 'R', 'W'};
+	return mode < LOAD_MODE_PULSE && parse_quantity(text, quantities[mode], target);
+}
+
+void command_mode(char *args, const command_args *parsed) {
+	char *name = strsep(&args, ARGUMENT_SEPERATORS);
+	if(name == NULL || name[0] == 0) {
+		write_mode();
+		return;
+	}
+
+	load_mode mode;
+	if(!parse_mode(name, &mode)) {
+		uart_puts("err unknown mode\r\n");
+		return;
+	}
+
+	if(mode == LOAD_MODE_CC) {
+		set_load_mode(LOAD_MODE_CC);
+	} else {
+		int32 target;
+		if(!parse_target(mode, strsep(&args, ARGUMENT_SEPERATORS), &target)) {
+			uart_puts("err mode expects a target\r\n");
+			return;
+		}
+		set_load_target(mode, target);
+	}
+	write_mode();
+}
+
+// Broadcast 'set' and 'pulse' are held here until a broadcast 'trigger'
+#define ARMED_SET 1
+#define ARMED_PULSE 2
+static uint8 armed = 0;
+static int armed_setpoint;
+static pulse_config_t armed_pulse;
+
+static void arm_or_set_current(int setpoint) {
+	if(tx_muted) {
+		armed_setpoint = setpoint;
+		armed |= ARMED_SET;
+	} else {
+		set_current(setpoint);
+	}
+}
+
+// set [<current>] sets the C/C current, bare numbers in mA or with a prefix
+// or symbol as given, "1.5A" or "250u", and reports it in mA
+void command_set(char *args, const command_args *parsed) {
+	char response[32];
+	
+	if(parsed->count)
+		arm_or_set_current(parsed->values[0]);
+	
+	format(response, "set %d\r\n", (int)div1000(state.current_setpoint));
+	uart_puts(response);
+}
+
+static int start_pulse_config(const pulse_config_t *config) {
+	if(!set_pulse_config(config))
+		return 0;
+	set_load_mode(LOAD_MODE_PULSE);
+	return 1;
+}
+
+static void write_trigger() {
+	char response[32];
+
+	switch(get_trigger_action()) {
+	case TRIGGER_SET:
+		format(response, "trigger set %d\r\n", (int)div1000(get_trigger_setpoint()));
+		break;
+	case TRIGGER_STEP:
+		strcpy(response, "trigger step\r\n");
+		break;
+	default:
+		strcpy(response, "trigger off\r\n");
+		break;
+	}
+	uart_puts(response);
+}
+
+// Bare 'trigger' applies everything armed by broadcast 'set' and 'pulse', so
+// all the units on a bus change together when its last byte arrives. For
+// tighter timing, 'trigger set <mA>' and 'trigger step' arm the trigger input
+// pin instead, to apply a setpoint or start the sequencer's next step, and
+// 'trigger pulse' fires the trigger output, so the host can have one unit step
+// every unit wired to it, itself included, on the same edge.
+void command_trigger(char *args, const command_args *parsed) {
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg == NULL || arg[0] == 0) {
+		if(armed & ARMED_PULSE)
+			start_pulse_config(&armed_pulse);
+		if(armed & ARMED_SET)
+			set_current(armed_setpoint);
+		armed = 0;
+		uart_puts("ok\r\n");
+		return;
+	}
+
+	if(strcmp(arg, "set") == 0) {
+		int32 setpoint;
+		if(!parse_quantity(strsep(&args, ARGUMENT_SEPERATORS), 'A', &setpoint)) {
+			uart_puts("err trigger set expects a current\r\n");
+			return;
+		}
+		trigger_arm(TRIGGER_SET, setpoint);
+	} else if(strcmp(arg, "step") == 0) {
+		trigger_arm(TRIGGER_STEP, 0);
+	} else if(strcmp(arg, "off") == 0) {
+		trigger_arm(TRIGGER_OFF, 0);
+	} else if(strcmp(arg, "pulse") == 0) {
+		trigger_output_pulse();
+	} else {
+		uart_puts("err trigger expects 'set', 'step', 'off' or 'pulse'\r\n");
+		return;
+	}
+	write_trigger();
+}
+
+// Time sync over the trigger line (see timesync.c). 'sync pulse', to the
+// leader, fires the trigger output and reports "sync pulse <us>", its time of the
+// edge; 'sync <us>' to every unit then puts their stream timestamps on the
+// leader's clock. 'sync off' goes back to their own. Reports "sync <on|off>
+// <drift ppb> <last error us> <edges>", as does sync alone.
+void command_sync(char *args, const command_args *parsed) {
+	char response[48];
+
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg != NULL && strcmp(arg, "pulse") == 0) {
+		format(response, "sync pulse %u\r\n", timesync_pulse());
+		uart_puts(response);
+		return;
+	} else if(arg != NULL && strcmp(arg, "off") == 0) {
+		timesync_stop();
+	} else if(arg != NULL && arg[0] != 0) {
+		if(arg[0] < '0' || arg[0] > '9') {
+			uart_puts("err sync expects 'pulse', 'off' or the leader's time\r\n");
+			return;
+		}
+		if(!timesync_set(strtoul(arg, NULL, 10))) {
+			uart_puts("err sync has seen no edge since the last\r\n");
+			return;
+		}
+	}
+
+	timesync_status status;
+	get_timesync_status(&status);
+	format(response, "sync %s %d %d %u\r\n", status.synced?"on":"off", (int)status.drift_ppb,
+		(int)status.last_error, status.edges);
+	uart_puts(response);
+}
+
+// address <n> puts the unit on a shared bus as unit n, 1 to 254, after which
+// it ignores lines not prefixed "@n " or "@* "; 0 answers everything again
+void command_address(char *args, const command_args *parsed) {
+	char response[32];
+	if(parsed->count) {
+		int address = parsed->values[0];
+		if(address < 0 || address >= FRAME_BROADCAST) {
+			uart_puts("err address out of range\r\n");
+			return;
+		}
+		uint8 value = address;
+		settings_write(&value, &settings->address, sizeof(value));
+	}
+
+	format(response, "address %d\r\n", settings->address);
+	uart_puts(response);
+}
+
+void command_reset(char *args, const command_args *parsed) {
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	uart_puts("ok\r\n");
+}
+
+// output on and output off switch the output with a current ramp, unlike
+// reset; output ramp <ms> sets its length, 0 to switch at once. All forms
+// report "output <off|on|feedback> <ramp ms> <1 while ramping>". output opamp
+// [auto|low|medium|high] sets or reports the opamp's power level, as "output
+// opamp <setting> <level in effect>", until the next reset.
+void command_output(char *args, const command_args *parsed) {
+	static const char *mode_names[] = {"off", "on", "feedback"};
+	static const char *const power_names[] = {"auto", "low", "medium", "high"};
+	char response[32];
+
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	if(action != NULL && strcmp(action, "opamp") == 0) {
+		char *power = next_argument(&args);
+		if(power != NULL) {
+			int i = 0;
+			while(i < 4 && strcmp(power, power_names[i]) != 0)
+				i++;
+			if(i == 4) {
+				uart_puts("err output opamp expects auto, low, medium or high\r\n");
+				return;
+			}
+			set_opamp_power(i);
+		}
+		format(response, "output opamp %s %s\r\n", power_names[get_opamp_power()], power_names[get_opamp_power_level()]);
+		uart_puts(response);
+		return;
+	}
+	if(action == NULL || action[0] == 0) {
+		// Just report
+	} else if(strcmp(action, "on") == 0) {
+		output_on();
+	} else if(strcmp(action, "off") == 0) {
+		output_off();
+	} else if(strcmp(action, "ramp") == 0) {
+		char *ms = strsep(&args, ARGUMENT_SEPERATORS);
+		if(ms == NULL || ms[0] == 0 || !set_output_ramp(atoi(ms))) {
+			uart_puts("err output ramp expects ms\r\n");
+			return;
+		}
+	} else {
+		uart_puts("err output expects on, off, ramp or opamp\r\n");
+		return;
+	}
+
+	format(response, "output %s %d %d\r\n", mode_names[get_output_mode()], get_output_ramp(), get_output_ramping());
+	uart_puts(response);
+}
+
+void command_read(char *args, const command_args *parsed) {
+	write_state_data();
+}
+
+static void get_status(status_snapshot *status) {
+	measurement m;
+	get_measurement(&m);
+
+	// Take the last scan with the modes so they agree with each other; the
+	// conversions can wait until interrupts are back on
+	uint8 int_state = CyEnterCriticalSection();
+	const int16 *scan = get_last_scan();
+	status->setpoint = state.current_setpoint;
+	status->load_mode = get_load_mode();
+	status->output_mode = get_output_mode();
+	status->opamp_out = scan[ADC_CHAN_OPAMP_OUT];
+	status->fet_in = scan[ADC_CHAN_FET_IN];
+	status->dither_fraction = get_dither_fraction();
+	CyExitCriticalSection(int_state);
+
+	uint32 rate = status->dither_fraction?get_ripple_scan_rate():0;
+	status->dither_rate = (rate > 0xFFFF)?0xFFFF:rate;
+
+	status->current = m.current;
+	status->voltage = m.voltage;
+	status->power = div1000(m.current) * div1000(m.voltage);
+	status->resistance = resistance_from_raw(m.raw_voltage, m.raw_current);
+	status->temperature = get_temperature();
+}
+
+// Replaces polling 'set', 'read', 'mode' and 'debug' with a single line:
+// status <setpoint mA> <current mA> <voltage mV> <power mW> <resistance ohms>
+//        <mode> <output> <opamp out> <fet in> <temperature C>
+//        <dither Hz> <dither 256ths of a low IDAC code>
+void command_status(char *args, const command_args *parsed) {
+	static const char *output_names[] = {"off", "on", "feedback"};
+	char response[32];
+	status_snapshot status;
+	get_status(&status);
+
+	format(response, "status %d %d %d ", (int)div1000(status.setpoint),
+		(int)div1000(status.current), (int)div1000(status.voltage));
+	uart_puts(response);
+	format(response, "%d %d %s %s ", (int)div1000(status.power),
+		(status.resistance < 0)?-1:(int)div1000(status.resistance),
+		mode_names[status.load_mode], output_names[status.output_mode]);
+	uart_puts(response);
+	format(response, "%d %d %d ", status.opamp_out, status.fet_in, status.temperature);
+	uart_puts(response);
+	format(response, "%u %u\r\n", status.dither_rate, status.dither_fraction);
+	uart_puts(response);
+}
+
+// credit <records> lets a stream send that many more records at full rate and
+// turns flow control on, until the next 'stream'. Like 'monitor', it doesn't
+// answer, so a host can grant credit as often as it likes.
+#ifdef USE_STREAM
+void command_credit(char *args, const command_args *parsed) {
+	int32 grant = parsed->values[0];
+	if(grant > STREAM_CREDIT_MAX)
+		grant = STREAM_CREDIT_MAX;
+	int credits = stream_credits + grant;
+	if(credits < 0)
+		credits = 0;
+	stream_credits = (credits > STREAM_CREDIT_MAX)?STREAM_CREDIT_MAX:credits;
+	stream_flow = 1;
+}
+#else
+void command_credit(char *args, const command_args *parsed) {
+}
+#endif
+
+void command_monitor(char *args, const command_args *parsed) {
+	// Timed by the ADC task, so intervals aren't limited to whole ticks
+	set_monitor_interval(parsed->values[0] * 1000);
+}
+
+// Switches baud rate with a handshake, so a host that can't follow doesn't
+// lose the device: "baud <rate>" is answered at the old rate, then the host
+// must send the same line again at the new rate within COMMS_BAUD_CONFIRM_MS.
+// The device answers "baud <rate> ok", or goes back to the old rate.
+void command_baud(char *args, const command_args *parsed) {
+	char response[32];
+	char *rate = strsep(&args, ARGUMENT_SEPERATORS);
+
+	if(rate == NULL || rate[0] == 0) {
+		format(response, "baud %u\r\n", current_baud);
+		uart_puts(response);
+		return;
+	}
+
+	uint32 old_baud = current_baud, baud = atoi(rate);
+	format(response, "baud %u\r\n", baud);
+	uart_puts(response);
+	if(set_baud(baud) == 0) {
+		uart_puts("err baud rate not possible\r\n");
+		return;
+	}
+
+	// Anything received during the switch is garbage
+	char *line;
+	uint8 len;
+	response[strlen(response) - 2] = '\0';
+	portTickType start = xTaskGetTickCount();
+	while(xTaskGetTickCount() - start < COMMS_BAUD_CONFIRM_MS / portTICK_RATE_MS) {
+		while((line = read_line(&len)) != NULL) {
+			int confirmed = (strcmp(line, response) == 0);
+			release_lines();
+			if(confirmed) {
+				rx_errors = 0;
+				format(response, "baud %u ok\r\n", baud);
+				uart_puts(response);
+				return;
+			}
+		}
+		vTaskDelay(1);
+	}
+
+	set_baud(old_baud);
+	rx_errors = 0;
+	uart_puts("err baud not confirmed\r\n");
+}
+
+#ifdef USE_SWEEP
+// Sends the last sweep's table, "sweep point <setpoint mA> <mA> <mV>" a line,
+// then "sweep done <points> <unsettled>"
+static void write_sweep() {
+	char response[32];
+	int length = get_sweep_length();
+	for(int i = 0; i < length; i++) {
+		const sweep_point *point = get_sweep_point(i);
+		format(response, "sweep point %d ", get_sweep_setpoint(i) / 1000);
+		uart_puts(response);
+		format(response, "%d %d\r\n", current_from_raw(point->raw_current) / 1000, voltage_from_raw(point->raw_voltage) / 1000);
+		uart_puts(response);
+	}
+	format(response, "sweep done %d %d\r\n", length, get_sweep_unsettled());
+	uart_puts(response);
+}
+#endif
+
+#ifdef USE_IMPEDANCE
+// "impedance point <Hz> <milliohms> <tenths of a degree>" per point, then
+// "impedance done <points>"
+static void write_impedance() {
+	char response[40];
+	int length = get_impedance_length();
+	for(int i = 0; i < length; i++) {
+		const impedance_point *point = get_impedance_point(i);
+		format(response, "impedance point %d %d %d\r\n", point->hz, (int)point->impedance, point->phase);
+		uart_puts(response);
+	}
+	format(response, "impedance done %d\r\n", length);
+	uart_puts(response);
+}
+#endif
+
+#ifdef USE_CAPTURE
+// Sends a finished capture: "capture data <depth> <pre> <ns per sample>", a
+// "<mA> <mV>" line per sample, oldest first, then "capture done"
+static void write_capture() {
+	char response[32];
+	if(get_capture_state() != CAPTURE_DONE) {
+		uart_puts("err capture not done\r\n");
+		return;
+	}
+	int depth = get_capture_depth();
+	format(response, "capture data %d %d ", depth, get_capture_pre());
+	uart_puts(response);
+	format(response, "%u\r\n", get_capture_interval());
+	uart_puts(response);
+	for(int i = 0; i < depth; i++) {
+		const int16 *sample = get_capture_sample(i);
+		format(response, "%d %d\r\n", current_from_raw(sample[0]) / 1000, voltage_from_raw(sample[1]) / 1000);
+		uart_puts(response);
+	}
+	uart_puts("capture done\r\n");
+}
+
+// Sends "capture step <before mV> <after mV> <deviation mV> <overshoot mV>
+// <recovery us> <current step mA> <edge us>" for a finished capture
+static void write_capture_step(int32 band) {
+	char response[48];
+	capture_step_result step;
+	if(!get_capture_step(band, &step)) {
+		uart_puts("err capture not done\r\n");
+		return;
+	}
+	format(response, "capture step %d %d %d ", step.before / 1000, step.after / 1000, step.deviation / 1000);
+	uart_puts(response);
+	format(response, "%d %d %d %d\r\n", step.overshoot / 1000, step.recovery, step.current_step / 1000, step.edge);
+	uart_puts(response);
+}
+
+static const char *const capture_state_names[] = {"idle", "done", "armed", "triggered"};
+
+// Whether the capture being taken is reported as its step response rather
+// than dumped, and the band for it
+static uint8 capture_summary;
+static int32 capture_band;
+
+static void write_finished_capture() {
+	if(capture_summary)
+		write_capture_step(capture_band);
+	else
+		write_capture();
+}
+
+// capture setpoint|external [depth [pre]] or capture rise|fall <mV> [depth
+// [pre]] arms a single shot capture of every scan, pre of them from before
+// the trigger, and sends it when it's done. capture stop disarms it, capture
+// dump sends the last one again, and capture alone reports
+// "capture <idle|armed|triggered|done> <depth> <pre>". capture step [<mV>]
+// works out the step response of the last one, taking the trigger as the
+// step and recovery as staying within <mV> of the final level (2% of it by
+// default); given while a capture is armed, that's sent instead of the dump.
+void command_capture(char *args, const command_args *parsed) {
+	static const char *const triggers[] = {"setpoint", "rise", "fall", "external", NULL};
+	char response[32];
+
+	char *trigger = strsep(&args, ARGUMENT_SEPERATORS);
+	if(trigger == NULL || trigger[0] == 0) {
+		// Just report
+	} else if(strcmp(trigger, "stop") == 0) {
+		capture_stop();
+	} else if(strcmp(trigger, "dump") == 0) {
+		write_capture();
+		return;
+	} else if(strcmp(trigger, "step") == 0) {
+		char *band = next_argument(&args);
+		capture_band = -1;
+		if(band != NULL && !parse_quantity(band, 'V', &capture_band)) {
+			uart_puts("err capture step expects [mV]\r\n");
+			return;
+		}
+		if(get_capture_state() == CAPTURE_DONE) {
+			write_capture_step(capture_band);
+			return;
+		}
+		capture_summary = get_capture_state() != CAPTURE_IDLE;
+	} else {
+		int source = 0;
+		while(triggers[source] != NULL && strcmp(trigger, triggers[source]) != 0)
+			source++;
+		int32 level = 0;
+		if((source == CAPTURE_TRIGGER_RISING || source == CAPTURE_TRIGGER_FALLING)
+		   && !parse_quantity(strsep(&args, ARGUMENT_SEPERATORS), 'V', &level))
+			level = -1;
+		char *depth = strsep(&args, ARGUMENT_SEPERATORS);
+		char *pre = strsep(&args, ARGUMENT_SEPERATORS);
+		if(triggers[source] == NULL || level < 0
+		   || !capture_start(source, level,
+				(depth == NULL || depth[0] == 0)?CAPTURE_DEFAULT_DEPTH:atoi(depth),
+				(pre == NULL || pre[0] == 0)?CAPTURE_DEFAULT_PRE:atoi(pre))) {
+			uart_puts("err capture expects setpoint|external|rise <mV>|fall <mV> [depth [pre]]\r\n");
+			return;
+		}
+		capture_summary = 0;
+	}
+
+	format(response, "capture %s %d %d\r\n", capture_state_names[get_capture_state()], get_capture_depth(), get_capture_pre());
+	uart_puts(response);
+}
+#else
+void command_capture(char *args, const command_args *parsed) {
+	write_not_built("USE_CAPTURE");
+}
+#endif
+
+// ripple reports "ripple window <blocks> <scan rate Hz>", then "ripple bin
+// <n> <Hz> <uV peak, -1 if none>" for each bin. ripple <bin> <Hz> sets a bin,
+// 0 to turn it off, and ripple window <blocks> the window length.
+#ifdef USE_RIPPLE
+void command_ripple(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *first = strsep(&args, ARGUMENT_SEPERATORS);
+	char *value = strsep(&args, ARGUMENT_SEPERATORS);
+	if(first != NULL && first[0] != 0) {
+		int ok;
+		if(strcmp(first, "window") == 0) {
+			ok = value != NULL && value[0] != 0 && set_ripple_window(atoi(value));
+		} else {
+			ok = value != NULL && value[0] != 0 && set_ripple_bin(atoi(first), atoi(value));
+		}
+		if(!ok) {
+			uart_puts("err ripple expects <bin> <Hz> or window <blocks>\r\n");
+			return;
+		}
+	}
+
+	format(response, "ripple window %d %u\r\n", get_ripple_window(), get_ripple_scan_rate());
+	uart_puts(response);
+	for(int i = 0; i < RIPPLE_BINS; i++) {
+		format(response, "ripple bin %d %d %d\r\n", i, get_ripple_bin(i), get_ripple_amplitude(i));
+		uart_puts(response);
+	}
+}
+#else
+void command_ripple(char *args, const command_args *parsed) {
+	write_not_built("USE_RIPPLE");
+}
+#endif
+
+#ifdef USE_CAPTURE
+// short <ms> [depth [pre]] shorts the input by turning the gate fully on for
+// 1 to 1000ms, and sends the capture of its start once it's full; short stop
+// ends it early with the output off. All forms report "short <state> <ms>
+// <peak mA>".
+void command_short(char *args, const command_args *parsed) {
+	static const char *state_names[] = {"idle", "arming", "on", "on", "done", "stopped"};
+	char response[32];
+
+	char *ms = strsep(&args, ARGUMENT_SEPERATORS);
+	if(ms == NULL || ms[0] == 0) {
+		// Just report
+	} else if(strcmp(ms, "stop") == 0) {
+		short_stop();
+	} else {
+		char *depth = strsep(&args, ARGUMENT_SEPERATORS);
+		char *pre = strsep(&args, ARGUMENT_SEPERATORS);
+		if(!short_start(atoi(ms) * 1000,
+				(depth == NULL || depth[0] == 0)?CAPTURE_DEFAULT_DEPTH:atoi(depth),
+				(pre == NULL || pre[0] == 0)?CAPTURE_DEFAULT_PRE:atoi(pre))) {
+			uart_puts("err short expects ms [depth [pre]], with a voltage to short\r\n");
+			return;
+		}
+	}
+
+	format(response, "short %s %d %d\r\n", state_names[get_short_state()], get_short_duration() / 1000, get_short_peak_current() / 1000);
+	uart_puts(response);
+}
+#else
+void command_short(char *args, const command_args *parsed) {
+	write_not_built("USE_CAPTURE");
+}
+#endif
+
+#ifdef USE_SWEEP
+// sweep <from mA> <to mA> <points> [settle blocks] steps the C/C setpoint
+// across a range and sends the table when it's done. sweep stop abandons it,
+// sweep dump sends the last table again, and sweep alone reports
+// "sweep <point being measured, -1 if idle> <points taken>".
+void command_sweep(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *from = strsep(&args, ARGUMENT_SEPERATORS);
+	if(from == NULL || from[0] == 0) {
+		// Just report
+	} else if(strcmp(from, "stop") == 0) {
+		sweep_stop();
+	} else if(strcmp(from, "dump") == 0) {
+		write_sweep();
+		return;
+	} else {
+		int32 start, end;
+		char *to = strsep(&args, ARGUMENT_SEPERATORS);
+		char *count = strsep(&args, ARGUMENT_SEPERATORS);
+		char *settle = strsep(&args, ARGUMENT_SEPERATORS);
+		if(count == NULL || count[0] == 0
+		   || !parse_quantity(from, 'A', &start) || !parse_quantity(to, 'A', &end)
+		   || !sweep_start(start, end, atoi(count), (settle == NULL || settle[0] == 0)?SWEEP_DEFAULT_SETTLE:atoi(settle))) {
+			uart_puts("err sweep expects from to points [settle]\r\n");
+			return;
+		}
+	}
+
+	format(response, "sweep %d %d\r\n", get_sweep_index(), get_sweep_length());
+	uart_puts(response);
+}
+#else
+void command_sweep(char *args, const command_args *parsed) {
+	write_not_built("USE_SWEEP");
+}
+#endif
+
+#ifdef USE_IMPEDANCE
+// impedance <dc> <amplitude> <from Hz> <to Hz> <points> sweeps the output
+// impedance, impedance stop abandons it and impedance dump sends the points.
+// The points also follow "impedance done" unasked when a sweep finishes.
+void command_impedance(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *dc = next_argument(&args);
+	if(dc == NULL) {
+		// Just report
+	} else if(strcmp(dc, "stop") == 0) {
+		impedance_stop();
+	} else if(strcmp(dc, "dump") == 0) {
+		write_impedance();
+		return;
+	} else {
+		int32 level, amplitude, from, to, count;
+		if(!parse_quantity(dc, 'A', &level) || !parse_quantity(next_argument(&args), 'A', &amplitude)
+		   || !parse_quantity(next_argument(&args), 0, &from) || !parse_quantity(next_argument(&args), 0, &to)
+		   || !parse_quantity(next_argument(&args), 0, &count)) {
+			uart_puts("err impedance expects dc amplitude from to points\r\n");
+			return;
+		}
+		if(!impedance_start(level, amplitude, from, to, count)) {
+			uart_puts("err impedance out of range or no scan rate yet\r\n");
+			return;
+		}
+	}
+
+	format(response, "impedance %d %d\r\n", get_impedance_index(), get_impedance_length());
+	uart_puts(response);
+}
+#else
+void command_impedance(char *args, const command_args *parsed) {
+	write_not_built("USE_IMPEDANCE");
+}
+#endif
+
+#ifdef USE_MPPT
+// mppt start [step mA] [interval blocks] tracks the maximum power point,
+// mppt stop ends it. Both report "mppt <running> <mA> <mV> <mW>" and then
+// "mppt max <mW> <mV> <efficiency %>".
+void command_mppt(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	if(action == NULL || action[0] == 0) {
+		// Just report
+	} else if(strcmp(action, "start") == 0) {
+		int32 step = MPPT_DEFAULT_STEP;
+		char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+		char *interval = strsep(&args, ARGUMENT_SEPERATORS);
+		if((arg != NULL && arg[0] != 0 && !parse_quantity(arg, 'A', &step))
+		   || !mppt_start(step, (interval == NULL || interval[0] == 0)?MPPT_DEFAULT_INTERVAL:atoi(interval))) {
+			uart_puts("err mppt start expects [step] [interval]\r\n");
+			return;
+		}
+	} else if(strcmp(action, "stop") == 0) {
+		mppt_stop();
+	} else {
+		uart_puts("err unknown mppt action\r\n");
+		return;
+	}
+
+	mppt_status status;
+	get_mppt_status(&status);
+	format(response, "mppt %d %d ", get_mppt_running(), status.current / 1000);
+	uart_puts(response);
+	format(response, "%d %d\r\n", status.voltage / 1000, status.power / 1000);
+	uart_puts(response);
+	format(response, "mppt max %d %d ", status.max_power / 1000, status.max_voltage / 1000);
+	uart_puts(response);
+	format(response, "%d\r\n", status.efficiency);
+	uart_puts(response);
+}
+#else
+void command_mppt(char *args, const command_args *parsed) {
+	write_not_built("USE_MPPT");
+}
+#endif
+
+// Mean of CAL_SAMPLES filtered readings, a tick apart
+static void cal_capture(int *raw_current, int *raw_voltage) {
+	int32 current_sum = 0, voltage_sum = 0;
+	for(int i = 0; i < CAL_SAMPLES; i++) {
+		measurement m;
+		vTaskDelay(1);
+		get_measurement(&m);
+		current_sum += m.raw_current;
+		voltage_sum += m.raw_voltage;
+	}
+	*raw_current = current_sum / CAL_SAMPLES;
+	*raw_voltage = voltage_sum / CAL_SAMPLES;
+}
+
+// Fits what the points support and reports "cal fit <voltage gain> <offset>
+// <current gain> <offset>" and "cal dac <high gain> <offset> <low gain>
+// <offset>"; anything with too few points keeps its present calibration.
+// With save set the results go to the settings, in one go, along with the
+// present temperature for the tempco corrections to work from.
+static void cal_fit_all(int save) {
+	static const uint8 fields[CAL_FIT_COUNT][2] = {
+		{offsetof(settings_t, adc_voltage_gain), offsetof(settings_t, adc_voltage_offset)},
+		{offsetof(settings_t, adc_current_gain), offsetof(settings_t, adc_current_offset)},
+		{offsetof(settings_t, dac_high_gain), offsetof(settings_t, dac_high_offset)},
+		{offsetof(settings_t, dac_low_gain), offsetof(settings_t, dac_low_offset)},
+	};
+	char response[32];
+	int results[CAL_FIT_COUNT][2];
+
+	for(int i = 0; i < CAL_FIT_COUNT; i++) {
+		int *gain = (int *)((uint8 *)settings + fields[i][0]);
+		int *offset = (int *)((uint8 *)settings + fields[i][1]);
+		results[i][0] = *gain;
+		results[i][1] = *offset;
+		cal_solve(i, &results[i][0], &results[i][1]);
+		if(save) {
+			settings_write(&results[i][0], gain, sizeof(int));
+			settings_write(&results[i][1], offset, sizeof(int));
+		}
+	}
+	if(save) {
+		int temperature = get_temperature();
+		settings_write(&temperature, &settings->cal_temperature, sizeof(int));
+		calibration_update();
+	}
+
+	for(int i = 0; i < CAL_FIT_COUNT; i += 2) {
+		format(response, "cal %s %d %d ", i?"dac":"fit", results[i][0], results[i][1]);
+		uart_puts(response);
+		format(response, "%d %d\r\n", results[i + 1][0], results[i + 1][1]);
+		uart_puts(response);
+	}
+}
+
+// Calibration against reference instruments, driven by a host:
+//   cal start              takes over the load in C/C with the DACs at zero
+//   cal zero               with nothing connected, pins both ADC fits at zero
+//   cal voltage <uV>       adds the measured terminal voltage as a point
+//   cal dac <high|low> <n> drives one IDAC at code n, the other at zero
+//   cal current <uA>       adds the measured current as a point, to the
+//                          current ADC fit and to the driven IDAC's fit
+//   cal trim               searches for the opamp offset trim with a
+//                          source attached, and saves it
+//   cal autozero [on|off]  sets whether that search also runs at boot
+//   cal tempco <I> <V>     sets the current and voltage gains' changes in
+//                          ppm per degree C
+//   cal fit                reports the fits without keeping them
+//   cal save               stores the fits and ends calibration; they
+//                          start a fresh linearisation table
+//   cal table <uA>         after a save, records the driven IDAC's error
+//                          off its fit in the table, at codes that are a
+//                          multiple of 2^DAC_TABLE_SHIFT
+//   cal stop               ends calibration without storing anything
+//   cal export             stages this unit's calibration as a cal_blob,
+//                          to be read with 'cal' frames, and reports
+//                          "cal export <version> <bytes> <serial> <crc>"
+//   cal import [force]     makes a cal_blob written with 'cal' frames the
+//                          calibration and saves it; force takes one
+//                          exported by another die, after an MCU swap
+// Points report "cal <kind> <averaged counts> <points in that fit>", and
+// table entries "cal table <high|low> <point> <error uA>".
+// References are in microvolts and microamps so the low IDAC, at under 200uA
+// a count, can be fitted from a good meter's readings.
+void command_cal(char *args, const command_args *parsed) {
+	static cal_fit dac_fit = CAL_FIT_DAC_HIGH;
+	static uint8 dac_code = 0;
+	char response[32];
+	int raw_current, raw_voltage;
+
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	char *value = strsep(&args, ARGUMENT_SEPERATORS);
+	if(action == NULL || action[0] == 0) {
+		uart_puts("err cal expects an action\r\n");
+	} else if(strcmp(action, "start") == 0) {
+		sequence_stop();
+		battery_stop();
+		sweep_stop();
+		mppt_stop();
+		ir_stop();
+		tune_stop();
+		impedance_stop();
+		ocp_stop();
+		loadreg_stop();
+		standby_stop();
+		set_load_mode(LOAD_MODE_CC);
+		set_current(0);
+		set_output_mode(OUTPUT_MODE_FEEDBACK);
+		cal_reset();
+		dac_fit = CAL_FIT_DAC_HIGH;
+		dac_code = 0;
+		uart_puts("ok\r\n");
+	} else if(strcmp(action, "zero") == 0) {
+		cal_capture(&raw_current, &raw_voltage);
+		cal_add_point(CAL_FIT_CURRENT, raw_current, 0);
+		cal_add_point(CAL_FIT_VOLTAGE, raw_voltage, 0);
+		format(response, "cal zero %d %d\r\n", raw_current, raw_voltage);
+		uart_puts(response);
+	} else if(strcmp(action, "voltage") == 0 && value != NULL && value[0] != 0) {
+		cal_capture(&raw_current, &raw_voltage);
+		if(!cal_add_point(CAL_FIT_VOLTAGE, raw_voltage, atoi(value))) {
+			uart_puts("err cal points full\r\n");
+			return;
+		}
+		format(response, "cal voltage %d %d\r\n", raw_voltage, cal_points(CAL_FIT_VOLTAGE));
+		uart_puts(response);
+	} else if(strcmp(action, "dac") == 0 && value != NULL && (strcmp(value, "high") == 0 || strcmp(value, "low") == 0)) {
+		char *code = strsep(&args, ARGUMENT_SEPERATORS);
+		// The low IDAC has 7 bits
+		int top = (value[0] == 'h')?IDAC_High_IDAC_VALUE_MASK:IDAC_Low_IDAC_VALUE_MASK;
+		if(code == NULL || code[0] == 0 || atoi(code) < 0 || atoi(code) > top) {
+			uart_puts("err cal dac expects high|low code\r\n");
+			return;
+		}
+		dac_fit = (value[0] == 'h')?CAL_FIT_DAC_HIGH:CAL_FIT_DAC_LOW;
+		dac_code = atoi(code);
+		dither_stop();
+		write_dac((dac_fit == CAL_FIT_DAC_HIGH)?dac_code:0, (dac_fit == CAL_FIT_DAC_LOW)?dac_code:0);
+		uart_puts("ok\r\n");
+	} else if(strcmp(action, "current") == 0 && value != NULL && value[0] != 0) {
+		cal_capture(&raw_current, &raw_voltage);
+		if(!cal_add_point(CAL_FIT_CURRENT, raw_current, atoi(value))
+		   || !cal_add_point(dac_fit, dac_code, atoi(value))) {
+			uart_puts("err cal points full\r\n");
+			return;
+		}
+		format(response, "cal current %d %d\r\n", raw_current, cal_points(CAL_FIT_CURRENT));
+		uart_puts(response);
+	} else if(strcmp(action, "table") == 0 && value != NULL && value[0] != 0) {
+		if(dac_code & ((1 << DAC_TABLE_SHIFT) - 1)) {
+			uart_puts("err cal table needs a table point code\r\n");
+			return;
+		}
+		int dac = (dac_fit == CAL_FIT_DAC_HIGH)?0:1;
+		int error = atoi(value) - (dac?
+			settings->dac_low_gain * (dac_code - settings->dac_low_offset):
+			settings->dac_high_gain * (dac_code - settings->dac_high_offset));
+		dac_table_write(dac, dac_code >> DAC_TABLE_SHIFT, error);
+		format(response, "cal table %s %d %d\r\n", dac?"low":"high", dac_code >> DAC_TABLE_SHIFT, error);
+		uart_puts(response);
+	} else if(strcmp(action, "trim") == 0) {
+		int trim = opamp_trim_search(OPAMP_TRIM_CURRENT);
+		if(trim < 0) {
+			uart_puts("err cal trim drew no current\r\n");
+			return;
+		}
+		settings_write(&trim, &settings->opamp_offset_trim, sizeof(int));
+		format(response, "cal trim %d\r\n", trim);
+		uart_puts(response);
+	} else if(strcmp(action, "autozero") == 0) {
+		if(value != NULL && value[0] != 0) {
+			uint8 autozero;
+			if(strcmp(value, "on") == 0) {
+				autozero = 1;
+			} else if(strcmp(value, "off") == 0) {
+				autozero = 0;
+			} else {
+				uart_puts("err cal autozero expects 'on' or 'off'\r\n");
+				return;
+			}
+			settings_write(&autozero, &settings->opamp_autozero, sizeof(autozero));
+		}
+		uart_puts(settings->opamp_autozero?"cal autozero on\r\n":"cal autozero off\r\n");
+	} else if(strcmp(action, "tempco") == 0) {
+		char *voltage = strsep(&args, ARGUMENT_SEPERATORS);
+		if(value != NULL && value[0] != 0 && voltage != NULL && voltage[0] != 0) {
+			int tempco[2] = {atoi(value), atoi(voltage)};
+			settings_write(&tempco[0], &settings->adc_current_tempco, sizeof(int));
+			settings_write(&tempco[1], &settings->adc_voltage_tempco, sizeof(int));
+			calibration_update();
+		}
+		format(response, "cal tempco %d %d\r\n", settings->adc_current_tempco, settings->adc_voltage_tempco);
+		uart_puts(response);
+	} else if(strcmp(action, "fit") == 0) {
+		cal_fit_all(0);
+	} else if(strcmp(action, "save") == 0) {
+		cal_fit_all(1);
+		dac_table_clear();
+		set_current(0);
+	} else if(strcmp(action, "stop") == 0) {
+		set_current(0);
+		uart_puts("ok\r\n");
+	} else if(strcmp(action, "export") == 0) {
+		const cal_blob *blob = cal_export();
+		format(response, "cal export %d %d ", blob->version, blob->length);
+		uart_puts(response);
+		format(response, "%08x%08x %d\r\n", blob->serial[0], blob->serial[1], blob->crc);
+		uart_puts(response);
+	} else if(strcmp(action, "import") == 0) {
+		if(value != NULL && value[0] != 0 && strcmp(value, "force") != 0) {
+			uart_puts("err cal import expects nothing or 'force'\r\n");
+			return;
+		}
+		switch(cal_import(value != NULL && value[0] != 0)) {
+		case CAL_IMPORT_OK:
+			uart_puts("ok\r\n");
+			break;
+		case CAL_IMPORT_BAD_FORMAT:
+			uart_puts("err cal import has no blob of this version\r\n");
+			break;
+		case CAL_IMPORT_BAD_CRC:
+			uart_puts("err cal import failed its crc\r\n");
+			break;
+		case CAL_IMPORT_WRONG_UNIT:
+			uart_puts("err cal import is for another unit\r\n");
+			break;
+		}
+	} else {
+		uart_puts("err unknown cal action\r\n");
+	}
+}
+
+// Reads count positive integers from args, or returns 0
+static int read_positive(char *args, int *values, int count) {
+	for(int i = 0; i < count; i++) {
+		char *value = strsep(&args, ARGUMENT_SEPERATORS);
+		if(value == NULL || value[0] == 0 || (values[i] = atoi(value)) <= 0)
+			return 0;
+	}
+	return 1;
+}
+
+// adc reports the SAR timing: "adc avg <log2 samples> <timer A> <B> <C> <D>"
+// in ADC clocks, then "adc chan <n> <averaged> <timer> <scanned>" for each
+// sequenced channel, then "adc rate <estimated Hz> <measured Hz>" for the
+// scan, then "adc slow <temperature> <current set>", the latest raw readings
+// of the channels on the injection channel. Temperature's settings are still
+// channel 4's. adc avg <log2 samples>, adc time <a-d> <clocks>,
+// adc chan <n> <a-d>|on|off and adc rate <Hz> change it until the next reset;
+// the rate is met by averaging fewer samples, and only temperature can leave
+// the scan.
+void command_adc(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	char *first = strsep(&args, ARGUMENT_SEPERATORS);
+	char *second = strsep(&args, ARGUMENT_SEPERATORS);
+	int ok = 1;
+	if(action == NULL || action[0] == 0) {
+		// Just report
+	} else if(strcmp(action, "avg") == 0 && first != NULL && first[0] != 0) {
+		ok = adc_set_averaging(atoi(first));
+	} else if(strcmp(action, "time") == 0 && first != NULL && second != NULL && second[0] != 0) {
+		ok = adc_set_sample_time(first[0] - 'a', atoi(second));
+	} else if(strcmp(action, "chan") == 0 && first != NULL && first[0] != 0 && second != NULL) {
+		if(strcmp(second, "on") == 0 || strcmp(second, "off") == 0)
+			ok = adc_set_channel_scanned(atoi(first), second[1] == 'n');
+		else
+			ok = adc_set_channel_timer(atoi(first), second[0] - 'a');
+	} else if(strcmp(action, "rate") == 0 && first != NULL && first[0] != 0) {
+		ok = atoi(first) > 0 && adc_set_scan_rate(atoi(first));
+	} else {
+		ok = 0;
+	}
+	if(!ok) {
+		uart_puts("err adc expects avg n, time a-d clocks, chan n a-d|on|off or rate Hz\r\n");
+		return;
+	}
+
+	format(response, "adc avg %d %d %d ", adc_get_averaging(), adc_get_sample_time(0), adc_get_sample_time(1));
+	uart_puts(response);
+	format(response, "%d %d\r\n", adc_get_sample_time(2), adc_get_sample_time(3));
+	uart_puts(response);
+	for(int i = 0; i < ADC_SEQUENCED_CHANNELS_NUM; i++) {
+		format(response, "adc chan %d %d %c %d\r\n", i, adc_get_channel_averaged(i), 'a' + adc_get_channel_timer(i),
+			adc_get_channel_scanned(i));
+		uart_puts(response);
+	}
+	format(response, "adc rate %u %u\r\n", adc_get_scan_rate(), get_ripple_scan_rate());
+	uart_puts(response);
+	format(response, "adc slow %d %d\r\n", get_adc_slow(ADC_SLOW_TEMP), get_adc_slow(ADC_SLOW_CURRENT_SET));
+	uart_puts(response);
+}
+
+// One "<prefix> <check> ok|fail <value>" line per self test check, then
+// "<prefix> time <us>"
+static void write_selftest(const char *prefix) {
+	static const char *checks[] = {"fet", "dac_low", "dac_high", "opamp", "display"};
+	char response[32];
+
+	for(int i = 0; i < SELFTEST_COUNT; i++) {
+		format(response, "%s %s %s %d\r\n", prefix, checks[i],
+			(selftest_failures() & (1 << i))?"fail":"ok", (int)selftest_value(i));
+		uart_puts(response);
+	}
+	format(response, "%s time %u\r\n", prefix, selftest_time());
+	uart_puts(response);
+}
+
+// selftest reports the power on self test as above. selftest run stops
+// whatever is running and repeats it; selftest override lets the output on
+// despite a failure, until the next run.
+void command_selftest(char *args, const command_args *parsed) {
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	if(action != NULL && strcmp(action, "run") == 0) {
+		sequence_stop();
+		battery_stop();
+		sweep_stop();
+		mppt_stop();
+		ir_stop();
+		tune_stop();
+		impedance_stop();
+		ocp_stop();
+		loadreg_stop();
+		standby_stop();
+		set_load_mode(LOAD_MODE_CC);
+		selftest_run();
+	} else if(action != NULL && strcmp(action, "override") == 0) {
+		selftest_override();
+		set_output_mode(OUTPUT_MODE_FEEDBACK);
+	} else if(action != NULL && action[0] != 0) {
+		uart_puts("err selftest expects run or override\r\n");
+		return;
+	}
+	write_selftest("selftest");
+	uart_puts(selftest_passed()?"selftest ok\r\n":"selftest failed\r\n");
+}
+
+// slew [<mA/ms>|off] sets or reports the setpoint slew limit, as "slew <mA/ms>"
+// with 0 for off. It applies in every mode but pulse, until the next reset.
+// slew dither [on|off] likewise sets or reports dithering the low IDAC for
+// setpoints finer than its step, as "slew dither <on|off> <Hz> <256ths>".
+void command_slew(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *rate = strsep(&args, ARGUMENT_SEPERATORS);
+	if(rate != NULL && strcmp(rate, "dither") == 0) {
+		char *enable = next_argument(&args);
+		if(enable != NULL) {
+			if(strcmp(enable, "on") != 0 && strcmp(enable, "off") != 0) {
+				uart_puts("err slew dither expects on or off\r\n");
+				return;
+			}
+			set_dither(enable[1] == 'n');
+			// Takes effect from the setpoint written now
+			if(get_load_mode() != LOAD_MODE_PULSE)
+				set_current(get_current_setpoint());
+		}
+		status_snapshot status;
+		get_status(&status);
+		format(response, "slew dither %s %u %u\r\n", get_dither()?"on":"off", status.dither_rate, status.dither_fraction);
+		uart_puts(response);
+		return;
+	}
+	if(rate != NULL && rate[0] != 0) {
+		int ok;
+		if(strcmp(rate, "off") == 0) {
+			ok = set_slew_rate(0);
+		} else {
+			int value = atoi(rate);
+			ok = value > 0 && value <= SLEW_MAX_RATE / 1000 && set_slew_rate(value * 1000);
+		}
+		if(!ok) {
+			uart_puts("err slew expects mA/ms or off\r\n");
+			return;
+		}
+	}
+	format(response, "slew %d\r\n", get_slew_rate() / 1000);
+	uart_puts(response);
+}
+
+// trim [<blocks>|off] sets or reports the closed loop C/C trim, as "trim
+// <time constant in blocks, 0 for off> <uA added to the setpoint>". The time
+// constant is a power of two; a new one starts the trim again from nothing.
+void command_trim(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *blocks = next_argument(&args);
+	if(blocks != NULL) {
+		int shift = -1;
+		if(strcmp(blocks, "off") != 0) {
+			int value = atoi(blocks);
+			shift = 0;
+			while((1 << shift) < value && shift <= TRIM_MAX_SHIFT)
+				shift++;
+			if(value < 1 || (1 << shift) != value)
+				shift = TRIM_MAX_SHIFT + 1;
+		}
+		if(!set_trim_shift(shift)) {
+			uart_puts("err trim expects a power of two number of blocks or off\r\n");
+			return;
+		}
+	}
+	int shift = get_trim_shift();
+	format(response, "trim %d %d\r\n", (shift < 0)?0:1 << shift, get_current_trim());
+	uart_puts(response);
+}
+
+// temp reports "temp <degrees C> <predicted degrees C> <current limit mA>
+// <heatsink degrees C> <junction degrees C>". temp model [<mC/W> <tau s>] and temp soa [<junction
+// mC/W> <junction max C> <knee mV>] set or report the heatsink model and the
+// MOSFET SOA, as "temp model ..." and "temp soa ..." with the same fields.
+// With a fan fitted, temp fan [auto [<target C>] | <percent>] hands the fan
+// to the thermal loop or fixes its duty, and reports "temp fan <duty percent>
+// <target C> <auto or manual>".
+void command_temp(char *args, const command_args *parsed) {
+	char response[32];
+	int values[3];
+
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	if(action == NULL || action[0] == 0) {
+		format(response, "temp %d %d ", get_temperature(), get_predicted_temperature());
+		uart_puts(response);
+		format(response, "%d %d %d\r\n", get_current_limit() / 1000, get_heatsink_temperature(),
+			get_junction_temperature());
+		uart_puts(response);
+	} else if(strcmp(action, "model") == 0) {
+		if(args != NULL && args[0] != 0) {
+			if(!read_positive(args, values, 2)) {
+				uart_puts("err temp model expects mC/W tau\r\n");
+				return;
+			}
+			settings_write(values, &settings->thermal_resistance, sizeof(int));
+			settings_write(&values[1], &settings->thermal_tau, sizeof(int));
+		}
+		format(response, "temp model %d %d\r\n", settings->thermal_resistance, settings->thermal_tau);
+		uart_puts(response);
+	} else if(strcmp(action, "soa") == 0) {
+		if(args != NULL && args[0] != 0) {
+			if(!read_positive(args, values, 3)) {
+				uart_puts("err temp soa expects mC/W max knee\r\n");
+				return;
+			}
+			settings_write(values, &settings->junction_resistance, sizeof(int));
+			settings_write(&values[1], &settings->junction_max, sizeof(int));
+			settings_write(&values[2], &settings->soa_knee, sizeof(int));
+		}
+		format(response, "temp soa %d %d ", settings->junction_resistance, settings->junction_max);
+		uart_puts(response);
+		format(response, "%d\r\n", settings->soa_knee);
+		uart_puts(response);
+#ifdef USE_FAN
+	} else if(strcmp(action, "fan") == 0) {
+		char *mode = strsep(&args, ARGUMENT_SEPERATORS);
+		if(mode != NULL && strcmp(mode, "auto") == 0) {
+			if(args != NULL && args[0] != 0) {
+				if(!read_positive(args, values, 1)) {
+					uart_puts("err temp fan auto expects a target\r\n");
+					return;
+				}
+				set_fan_target(values[0]);
+			}
+			set_fan_override(-1);
+		} else if(mode != NULL && mode[0] != 0) {
+			int percent = atoi(mode);
+			if(percent < 0 || percent > 100 || (percent == 0 && mode[0] != '0')) {
+				uart_puts("err temp fan expects auto or percent\r\n");
+				return;
+			}
+			set_fan_override(percent);
+		}
+		format(response, "temp fan %d %d ", get_fan_duty(), get_fan_target());
+		uart_puts(response);
+		uart_puts((get_fan_override() < 0)?"auto\r\n":"manual\r\n");
+#endif
+	} else {
+		uart_puts("err unknown temp action\r\n");
+	}
+}
+
+#ifdef USE_BATTERY_TEST
+// Sends the discharge curve of the running or last battery test, "battery
+// point <uAh> <mV>" a line, then "battery curve <points>"
+static void write_battery_curve() {
+	char response[32];
+	battery_curve_freeze(1);
+	int length = get_battery_curve_length();
+	for(int i = 0; i < length; i++) {
+		uint32 charge;
+		int16 raw_voltage;
+		get_battery_curve_point(i, &charge, &raw_voltage);
+		format(response, "battery point %u %d\r\n", charge, voltage_from_raw(raw_voltage) / 1000);
+		uart_puts(response);
+	}
+	battery_curve_freeze(0);
+	format(response, "battery curve %d\r\n", length);
+	uart_puts(response);
+}
+
+// battery start <cc|cp> <target> <cutoff mV> runs a discharge test until the
+// voltage falls below the cutoff; battery stop ends it early. All forms but
+// battery curve report "battery <state> <cutoff mV> <uAh> <uWh> <seconds>",
+// with the totals so far or as they stood at the end; battery curve sends the
+// test's discharge curve, thinned to BATTERY_CURVE_POINTS points.
+void command_battery(char *args, const command_args *parsed) {
+	static const char *state_names[] = {"idle", "run", "done", "stopped"};
+	char response[32];
+
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	if(action == NULL || action[0] == 0) {
+		// Just report
+	} else if(strcmp(action, "curve") == 0) {
+		write_battery_curve();
+		return;
+	} else if(strcmp(action, "start") == 0) {
+		char *name = strsep(&args, ARGUMENT_SEPERATORS);
+		char *target = strsep(&args, ARGUMENT_SEPERATORS);
+		char *cutoff = strsep(&args, ARGUMENT_SEPERATORS);
+		load_mode mode;
+		int32 setpoint, cutoff_voltage;
+		if(name == NULL || !parse_mode(name, &mode) || !parse_target(mode, target, &setpoint)
+		   || !parse_quantity(cutoff, 'V', &cutoff_voltage)
+		   || !battery_start(mode, setpoint, cutoff_voltage)) {
+			uart_puts("err battery start expects cc|cp target cutoff\r\n");
+			return;
+		}
+	} else if(strcmp(action, "stop") == 0) {
+		battery_stop();
+	} else {
+		uart_puts("err unknown battery action\r\n");
+		return;
+	}
+
+	energy_totals totals;
+	get_battery_result(&totals);
+	format(response, "battery %s %d ", state_names[get_battery_state()], get_battery_cutoff() / 1000);
+	uart_puts(response);
+	format(response, "%u %u %u\r\n", totals.charge, totals.energy, totals.seconds);
+	uart_puts(response);
+}
+#else
+void command_battery(char *args, const command_args *parsed) {
+	write_not_built("USE_BATTERY_TEST");
+}
+#endif
+
+#ifdef USE_IR_TEST
+// ir <low mA> <high mA> [pulses] [delay blocks] measures the DC internal
+// resistance with the transient generator, at its present frequency and
+// duty; ir stop ends it early. All forms report "ir <state> <pulses>
+// <missed> <micro-ohms> <uV drop> <uA step>", the figures once done.
+void command_ir(char *args, const command_args *parsed) {
+	static const char *state_names[] = {"idle", "run", "done", "stopped"};
+	char response[32];
+
+	char *low = strsep(&args, ARGUMENT_SEPERATORS);
+	if(low == NULL || low[0] == 0) {
+		// Just report
+	} else if(strcmp(low, "stop") == 0) {
+		ir_stop();
+	} else {
+		int32 low_current, high_current;
+		char *high = strsep(&args, ARGUMENT_SEPERATORS);
+		char *pulses = strsep(&args, ARGUMENT_SEPERATORS);
+		char *delay = strsep(&args, ARGUMENT_SEPERATORS);
+		if(!parse_quantity(low, 'A', &low_current) || !parse_quantity(high, 'A', &high_current)
+		   || !ir_start(low_current, high_current,
+				(pulses == NULL || pulses[0] == 0)?IR_DEFAULT_PULSES:atoi(pulses),
+				(delay == NULL || delay[0] == 0)?IR_DEFAULT_DELAY:atoi(delay))) {
+			uart_puts("err ir expects low high [pulses] [delay]\r\n");
+			return;
+		}
+	}
+
+	ir_result result;
+	get_ir_result(&result);
+	format(response, "ir %s %d %d ", state_names[get_ir_state()], result.pulses, result.missed);
+	uart_puts(response);
+	format(response, "%d %d %d\r\n", result.resistance, result.voltage_drop, result.current_step);
+	uart_puts(response);
+}
+#else
+void command_ir(char *args, const command_args *parsed) {
+	write_not_built("USE_IR_TEST");
+}
+#endif
+
+#ifdef USE_TUNE
+// tune start [step] [cycles] tunes the CV loop's gains by relay feedback
+// around the present target, swinging the current step either side of the
+// setpoint, in mA or with a prefix or symbol; the load has to be in CV mode
+// and settled. tune stop ends it early. All forms report "tune <state>
+// <cycles> <kp> <ki> <critical gain uA/count> <critical period blocks>", the
+// gains once done, when they're also saved as the settings' and go with the
+// next 'preset save'.
+void command_tune(char *args, const command_args *parsed) {
+	static const char *state_names[] = {"idle", "run", "done", "failed", "stopped"};
+	char response[32];
+
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	if(action == NULL || action[0] == 0) {
+		// Just report
+	} else if(strcmp(action, "stop") == 0) {
+		tune_stop();
+	} else if(strcmp(action, "start") == 0) {
+		int32 step = TUNE_DEFAULT_STEP;
+		char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+		char *cycles = strsep(&args, ARGUMENT_SEPERATORS);
+		if((arg != NULL && arg[0] != 0 && !parse_quantity(arg, 'A', &step))
+		   || !tune_start(step, (cycles == NULL || cycles[0] == 0)?TUNE_DEFAULT_CYCLES:atoi(cycles))) {
+			uart_puts("err tune start expects CV mode and [step] [cycles], the step below the setpoint\r\n");
+			return;
+		}
+	} else {
+		uart_puts("err unknown tune action\r\n");
+		return;
+	}
+
+	tune_result result;
+	get_tune_result(&result);
+	format(response, "tune %s %d %d ", state_names[get_tune_state()], result.cycles, result.kp);
+	uart_puts(response);
+	format(response, "%d %d %d\r\n", result.ki, result.ku, result.tu);
+	uart_puts(response);
+}
+#else
+void command_tune(char *args, const command_args *parsed) {
+	write_not_built("USE_TUNE");
+}
+#endif
+
+#ifdef USE_WATCH
+static const char *const watch_quantity_names[] = {"none", "v", "i", "p", "temp", "time"};
+static const char quantity_symbols[] = {0, 'V', 'A', 'W', 0, 0};
+static const char *const watch_action_names[] = {"notify", "off", "step", "trigger"};
+
+// "watch <slot> <quantity> <above|below> <level> <action> <hysteresis>
+// <debounce> <1 if fired> <times fired>", the level and hysteresis in wire
+// units, or "watch <slot> none". A step action is "step <n>".
+static void write_watch(int slot) {
+	char response[48];
+	const watch_config *w = get_watch(slot);
+	if(w->quantity == WATCH_NONE) {
+		format(response, "watch %d none\r\n", slot + 1);
+		uart_puts(response);
+		return;
+	}
+	// Microvolts and microamps go out in mV and mA
+	int scale = (w->quantity == WATCH_VOLTAGE || w->quantity == WATCH_CURRENT)?1000:1;
+	char *out = format(response, "watch %d %s %s %d %s", slot + 1, watch_quantity_names[w->quantity],
+		w->below?"below":"above", w->level / scale, watch_action_names[w->action]);
+	if(w->action == WATCH_STEP)
+		out = format(out, " %d", w->step);
+	format(out, " %d ", w->hysteresis / scale);
+	uart_puts(response);
+	format(response, "%d %d %u\r\n", w->debounce, get_watch_fired(slot), get_watch_count(slot));
+	uart_puts(response);
+}
+
+// watch lists the limit watches, numbered from 1, after "watches <count>".
+// watch <n> <v|i|p|temp|time> <above|below> <level> [notify|off|trigger|step
+// <step>] [hysteresis] [debounce blocks] sets one, the level and hysteresis
+// in mV, mA, mW, degrees C or ms since it was set, or with a prefix or symbol,
+// and subscribes to its events; watch <n> clear removes it. Both reply as
+// the list does for that slot.
+void command_watch(char *args, const command_args *parsed) {
+	char response[16];
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg == NULL || arg[0] == 0) {
+		format(response, "watches %d\r\n", WATCH_COUNT);
+		uart_puts(response);
+		for(int i = 0; i < WATCH_COUNT; i++)
+			write_watch(i);
+		return;
+	}
+
+	int slot = atoi(arg) - 1;
+	if(slot < 0 || slot >= WATCH_COUNT) {
+		uart_puts("err watch expects a slot number\r\n");
+		return;
+	}
+	arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg != NULL && strcmp(arg, "clear") == 0) {
+		watch_clear(slot);
+		write_watch(slot);
+		return;
+	}
+
+	watch_config w = {.action = WATCH_NOTIFY, .debounce = WATCH_DEFAULT_DEBOUNCE};
+	for(w.quantity = WATCH_VOLTAGE; w.quantity < WATCH_QUANTITY_MAX; w.quantity++)
+		if(arg != NULL && strcmp(arg, watch_quantity_names[w.quantity]) == 0)
+			break;
+	arg = strsep(&args, ARGUMENT_SEPERATORS);
+	w.below = arg != NULL && strcmp(arg, "below") == 0;
+	int ok = w.quantity < WATCH_QUANTITY_MAX && arg != NULL && (w.below || strcmp(arg, "above") == 0)
+		&& parse_quantity(strsep(&args, ARGUMENT_SEPERATORS), quantity_symbols[w.quantity], &w.level);
+
+	arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(ok && arg != NULL && arg[0] != 0) {
+		for(w.action = 0; w.action < WATCH_ACTION_MAX && strcmp(arg, watch_action_names[w.action]) != 0; w.action++);
+		if(w.action == WATCH_STEP) {
+			arg = strsep(&args, ARGUMENT_SEPERATORS);
+			ok = arg != NULL && arg[0] != 0;
+			w.step = ok?atoi(arg):0;
+		}
+		char *hysteresis = strsep(&args, ARGUMENT_SEPERATORS);
+		char *debounce = strsep(&args, ARGUMENT_SEPERATORS);
+		if(hysteresis != NULL && hysteresis[0] != 0)
+			ok = ok && parse_quantity(hysteresis, quantity_symbols[w.quantity], &w.hysteresis);
+		if(debounce != NULL && debounce[0] != 0)
+			w.debounce = atoi(debounce);
+	}
+	if(!ok || !watch_set(slot, &w)) {
+		uart_puts("err watch expects v|i|p|temp|time above|below level [action] [hysteresis] [debounce]\r\n");
+		return;
+	}
+	set_notify_mask(get_notify_mask() | (1 << NOTIFY_WATCH));
+	write_watch(slot);
+}
+#else
+void command_watch(char *args, const command_args *parsed) {
+	write_not_built("USE_WATCH");
+}
+#endif
+
+#ifdef USE_OCP
+static const char *const ocp_state_names[] = {"idle", "settling", "ramp", "tripped", "notrip", "stopped"};
+
+// Sends "ocp <state> <reference mV> <mV> <trip mA> <setpoint mA> <ms>"
+static void write_ocp() {
+	char response[32];
+	ocp_result result;
+	get_ocp_result(&result);
+	format(response, "ocp %s %d %d ", ocp_state_names[get_ocp_state()], result.reference / 1000, result.voltage / 1000);
+	uart_puts(response);
+	format(response, "%d %d %u\r\n", result.trip_current / 1000, result.trip_setpoint / 1000, result.ms);
+	uart_puts(response);
+}
+
+// ocp <from mA> <to mA> <mA per second> [drop %] tests a supply's overcurrent
+// protection, ramping the current until its voltage falls by drop percent
+// (OCP_DEFAULT_DROP unless given) and turning the output off at once. ocp
+// stop abandons it. The result follows unasked when it finishes; ocp alone
+// reports it again, the trip current measured the block before the collapse.
+void command_ocp(char *args, const command_args *parsed) {
+	char *from = next_argument(&args);
+	if(from == NULL) {
+		// Just report
+	} else if(strcmp(from, "stop") == 0) {
+		ocp_stop();
+	} else {
+		int32 from_current, to_current, rate, drop = OCP_DEFAULT_DROP;
+		char *percent;
+		if(!parse_quantity(from, 'A', &from_current) || !parse_quantity(next_argument(&args), 'A', &to_current)
+		   || !parse_quantity(next_argument(&args), 'A', &rate)
+		   || ((percent = next_argument(&args)) != NULL && !parse_quantity(percent, 0, &drop))
+		   || !ocp_start(from_current, to_current, rate, drop)) {
+			uart_puts("err ocp expects from to rate [drop %]\r\n");
+			return;
+		}
+	}
+	write_ocp();
+}
+#else
+void command_ocp(char *args, const command_args *parsed) {
+	write_not_built("USE_OCP");
+}
+#endif
+
+#ifdef USE_LOADREG
+// Sends the last load regulation table, "loadreg point <setpoint mA> <uA>
+// <uV> <settle ms> <1 if unsettled>" a line, then "loadreg done <points>
+// <unsettled> <regulation ppm>"
+static void write_loadreg() {
+	char response[40];
+	int length = get_loadreg_length(), unsettled = 0;
+	for(int i = 0; i < length; i++) {
+		const loadreg_point *point = get_loadreg_point(i);
+		format(response, "loadreg point %d %d ", point->setpoint / 1000, point->current);
+		uart_puts(response);
+		format(response, "%d %u %d\r\n", point->voltage, point->settle_ms, point->unsettled);
+		uart_puts(response);
+		unsettled += point->unsettled;
+	}
+	format(response, "loadreg done %d %d %d\r\n", length, unsettled, get_loadreg_regulation());
+	uart_puts(response);
+}
+
+// loadreg <full load mA> [points] [settled mV/s] [average ms] steps a
+// supply's load from none to full, LOADREG_DEFAULT_POINTS steps unless
+// given, and reads its voltage at each once it settles. The table follows
+// unasked when it's done; loadreg dump sends it again and loadreg stop
+// abandons the test. Otherwise it reports "loadreg <state> <point being
+// measured, -1 if idle> <points taken>".
+void command_loadreg(char *args, const command_args *parsed) {
+	static const char *state_names[] = {"idle", "run", "done", "stopped"};
+	char response[32];
+
+	char *full = next_argument(&args);
+	if(full == NULL) {
+		// Just report
+	} else if(strcmp(full, "stop") == 0) {
+		loadreg_stop();
+	} else if(strcmp(full, "dump") == 0) {
+		write_loadreg();
+		return;
+	} else {
+		int32 full_load, points = LOADREG_DEFAULT_POINTS, slope = LOADREG_DEFAULT_SLOPE, average = LOADREG_DEFAULT_AVERAGE;
+		char *arg;
+		if(!parse_quantity(full, 'A', &full_load)
+		   || ((arg = next_argument(&args)) != NULL && !parse_quantity(arg, 0, &points))
+		   || ((arg = next_argument(&args)) != NULL && !parse_quantity(arg, 'V', &slope))
+		   || ((arg = next_argument(&args)) != NULL && !parse_quantity(arg, 0, &average))
+		   || !loadreg_start(full_load, points, slope, average)) {
+			uart_puts("err loadreg expects full [points] [mV/s] [ms]\r\n");
+			return;
+		}
+	}
+
+	format(response, "loadreg %s %d %d\r\n", state_names[get_loadreg_state()], get_loadreg_index(), get_loadreg_length());
+	uart_puts(response);
+}
+#else
+void command_loadreg(char *args, const command_args *parsed) {
+	write_not_built("USE_LOADREG");
+}
+#endif
+
+#ifdef USE_STANDBY
+// standby start [setpoint mA] measures a small current as finely as the load
+// can: the offset is zeroed with the output off, then the setpoint, the
+// present one unless given, is sunk dithered, each reading integrated over
+// STANDBY_LINE_CYCLES of the line. standby stop puts everything back. All
+// forms report "standby <state> <setpoint uA> <uA> <+/- uA> <readings>",
+// the reading changing once a period.
+void command_standby(char *args, const command_args *parsed) {
+	static const char *state_names[] = {"idle", "zero", "run"};
+	char response[40];
+
+	char *arg = next_argument(&args);
+	if(arg == NULL) {
+		// Just report
+	} else if(strcmp(arg, "stop") == 0) {
+		standby_stop();
+	} else if(strcmp(arg, "start") == 0) {
+		int32 current = get_current_setpoint();
+		arg = next_argument(&args);
+		if((arg != NULL && !parse_quantity(arg, 'A', &current)) || !standby_start(current)) {
+			uart_puts("err standby start expects a setpoint up to the low range\r\n");
+			return;
+		}
+	} else {
+		uart_puts("err unknown standby action\r\n");
+		return;
+	}
+
+	standby_reading r;
+	get_standby_reading(&r);
+	format(response, "standby %s %d ", state_names[get_standby_state()], get_standby_setpoint());
+	uart_puts(response);
+	format(response, "%d %d %u\r\n", r.current, r.uncertainty, r.readings);
+	uart_puts(response);
+}
+#else
+void command_standby(char *args, const command_args *parsed) {
+	write_not_built("USE_STANDBY");
+}
+#endif
+
+// energy reports the charge and energy taken since power up in microamp hours
+// and microwatt hours, and the seconds integrated over; 'energy reset' zeroes
+// them for a new test
+void command_energy(char *args, const command_args *parsed) {
+	char response[32];
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg != NULL && arg[0] != 0) {
+		if(strcmp(arg, "reset") != 0) {
+			uart_puts("err energy expects 'reset'\r\n");
+			return;
+		}
+		reset_energy_totals();
+		uart_puts("energy 0 0 0\r\n");
+		return;
+	}
+
+	energy_totals totals;
+	get_energy_totals(&totals);
+	format(response, "energy %u %u ", totals.charge, totals.energy);
+	uart_puts(response);
+	format(response, "%u\r\n", totals.seconds);
+	uart_puts(response);
+}
+
+// refresh <hz> sets how often the status screen checks its readouts
+void command_refresh(char *args, const command_args *parsed) {
+	char response[32];
+	if(parsed->count) {
+		int rate = parsed->values[0];
+		if(rate < 1 || rate > UI_REFRESH_MAX) {
+			uart_puts("err refresh out of range\r\n");
+			return;
+		}
+		uint8 value = rate;
+		settings_write(&value, &settings->ui_refresh_rate, sizeof(value));
+	}
+
+	format(response, "refresh %d\r\n", settings->ui_refresh_rate);
+	uart_puts(response);
+}
+
+// limits [<over mV> <under mV>] sets or reports the voltage trip points, as
+// "limits <over> <under>", 0 for none. The undervoltage limit only trips a
+// running load.
+void command_limits(char *args, const command_args *parsed) {
+	char response[32];
+	if(parsed->count) {
+		int32 over = parsed->values[0];
+		int32 under = (parsed->count > 1)?parsed->values[1]:MILLIVOLTS(settings->undervoltage_limit);
+		int over_mv = (over < 0)?-1:(int)div1000(over), under_mv = (under < 0)?-1:(int)div1000(under);
+		if(over_mv < 0 || over_mv > 0xFFFF || under_mv < 0 || under_mv > 0xFFFF || (over_mv && under_mv >= over_mv)) {
+			uart_puts("err limits out of range\r\n");
+			return;
+		}
+		uint16 value = over_mv;
+		settings_write(&value, &settings->overvoltage_limit, sizeof(value));
+		value = under_mv;
+		settings_write(&value, &settings->undervoltage_limit, sizeof(value));
+		voltage_limits_update();
+	}
+
+	format(response, "limits %d %d\r\n", settings->overvoltage_limit, settings->undervoltage_limit);
+	uart_puts(response);
+}
+
+// "preset <slot> <mode> <target> <over mV> <under mV> <CV kp> <CV ki>", the
+// target in the mode's wire units, or "preset <slot> empty"
+static void write_preset(int slot) {
+	char response[64];
+	const preset *p = get_preset(slot);
+	if(p == NULL) {
+		format(response, "preset %d empty\r\n", slot + 1);
+	} else {
+		format(response, "preset %d %s %d %u %u %d %d\r\n", slot + 1, mode_names[p->mode],
+			(p->mode == LOAD_MODE_CP)?p->target:p->target / 1000, p->overvoltage_limit, p->undervoltage_limit,
+			p->cv_kp, p->cv_ki);
+	}
+	uart_puts(response);
+}
+
+// preset lists the slots, numbered from 1, after "presets <count>". preset
+// <n> applies one, and preset save <n> stores the present mode, target,
+// limits and CV gains in it.
+void command_preset(char *args, const command_args *parsed) {
+	char response[16];
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg == NULL || arg[0] == 0) {
+		format(response, "presets %d\r\n", PRESET_COUNT);
+		uart_puts(response);
+		for(int i = 0; i < PRESET_COUNT; i++)
+			write_preset(i);
+		return;
+	}
+
+	int save = strcmp(arg, "save") == 0;
+	if(save)
+		arg = strsep(&args, ARGUMENT_SEPERATORS);
+	int slot = (arg != NULL)?atoi(arg) - 1:-1;
+	if(slot < 0 || slot >= PRESET_COUNT) {
+		uart_puts("err preset expects a slot number\r\n");
+		return;
+	}
+
+	if(save) {
+		if(!preset_store(slot)) {
+			uart_puts("err preset can't store pulse mode\r\n");
+			return;
+		}
+	} else if(!preset_recall(slot)) {
+		uart_puts("err preset is empty\r\n");
+		return;
+	}
+	write_preset(slot);
+}
+
+// poweron reports the power-on profile as "poweron <slot|none> <on|off>
+// <blocks> [<channel> ...]", or "poweron clear" if there isn't one. poweron
+// <slot|none> <on|off> [<blocks> [<channel> ...]] saves one: the preset
+// recalled, the output state and, as 'stream' takes them, streaming from
+// boot. poweron clear removes it.
+void command_poweron(char *args, const command_args *parsed) {
+	char response[80];
+	char *arg = next_argument(&args);
+	if(arg != NULL && strcmp(arg, "clear") == 0) {
+		poweron_store(NULL);
+	} else if(arg != NULL) {
+		poweron_profile profile = {.preset = POWERON_NO_PRESET};
+		char *output = next_argument(&args);
+		char *blocks = next_argument(&args);
+		int none = strcmp(arg, "none") == 0;
+		int slot = none?0:atoi(arg);
+		int interval = (blocks != NULL)?atoi(blocks):0;
+		if((!none && slot < 1) || slot > PRESET_COUNT || interval < 0 || interval > 255 ||
+				output == NULL || (strcmp(output, "on") != 0 && strcmp(output, "off") != 0)) {
+			uart_puts("err poweron expects <slot|none> <on|off> [blocks [channels]]\r\n");
+			return;
+		}
+#ifndef USE_STREAM
+		if(interval > 0) {
+			write_not_built("USE_STREAM");
+			return;
+		}
+#endif
+		if(slot > 0)
+			profile.preset = slot - 1;
+		profile.output = (output[1] == 'n');
+		profile.stream_blocks = interval;
+		for(char *name = next_argument(&args); name != NULL; name = next_argument(&args)) {
+			int i;
+			for(i = 0; i < STREAM_CHANNELS && strcmp(name, stream_channel_names[i]) != 0; i++);
+			if(i == STREAM_CHANNELS) {
+				uart_puts("err stream channels are i v p temp opamp fet set flags\r\n");
+				return;
+			}
+			profile.stream_channels |= 1 << i;
+		}
+		poweron_store(&profile);
+	}
+
+	const poweron_profile *profile = get_poweron();
+	if(profile == NULL) {
+		uart_puts("poweron clear\r\n");
+		return;
+	}
+	char *p = response;
+	if(profile->preset == POWERON_NO_PRESET) {
+		p = format(p, "poweron none");
+	} else {
+		p = format(p, "poweron %d", profile->preset + 1);
+	}
+	p = format(p, " %s %d", profile->output?"on":"off", profile->stream_blocks);
+	for(int i = 0; i < STREAM_CHANNELS; i++)
+		if(profile->stream_channels & (1 << i))
+			p = format(p, " %s", stream_channel_names[i]);
+	format(p, "\r\n");
+	uart_puts(response);
+}
+
+// The macro running, if any: the offset of its next line, the tick a wait
+// ends, whether it was started by a broadcast, and the loops it's in
+static int8 macro_slot = -1;
+static uint8 macro_position;
+static portTickType macro_resume;
+static uint8 macro_muted;
+static struct {
+	uint8 start;		// Offset of the loop's first line
+	uint16 remaining;	// Passes left, 0 for ever
+} macro_loops[MACRO_LOOP_DEPTH];
+static uint8 macro_depth;
+
+// The macro 'macro record' is adding lines to, empty if none
+static char recording[MACRO_NAME_LENGTH + 1];
+
+static void macro_start(int slot) {
+	macro_slot = slot;
+	macro_position = 0;
+	macro_resume = xTaskGetTickCount();
+	macro_muted = tx_muted;
+	macro_depth = 0;
+}
+
+static void macro_end(const char *response) {
+	macro_slot = -1;
+	uart_puts(response);
+}
+
+// "macro <slot> <name> <bytes>", or "macro <slot> empty"
+static void write_macro(int slot) {
+	char response[40];
+	uint8 length;
+	const char *name = get_macro_name(slot);
+	if(name == NULL) {
+		format(response, "macro %d empty\r\n", slot + 1);
+	} else {
+		get_macro_text(slot, &length);
+		format(response, "macro %d %s %d\r\n", slot + 1, name, length);
+	}
+	uart_puts(response);
+}
+
+static void append_macro_line(const char *name, const char *line) {
+	int slot = macro_append(name, line);
+	if(slot < 0) {
+		uart_puts("err macro is full\r\n");
+		return;
+	}
+	if(slot == macro_slot)
+		macro_slot = -1;
+	write_macro(slot);
+}
+
+// macro lists the slots, numbered from 1, after "macros <count>". macro add
+// <name> <line> appends a line to a macro, starting it if need be, and macro
+// record <name> appends each line that follows, until "macro end". macro show
+// <name> sends "steps <lines>" and the lines, macro delete <name> empties its
+// slot and macro stop ends the one running. A line is a command, wait <ms>,
+// or loop <n> or end around lines to repeat n times, 0 for ever.
+void command_macro(char *args, const command_args *parsed) {
+	char response[24];
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	if(action == NULL || action[0] == 0) {
+		format(response, "macros %d\r\n", MACRO_COUNT);
+		uart_puts(response);
+		for(int i = 0; i < MACRO_COUNT; i++)
+			write_macro(i);
+		return;
+	}
+	if(strcmp(action, "stop") == 0) {
+		macro_slot = -1;
+		uart_puts("ok\r\n");
+		return;
+	}
+	if(strcmp(action, "end") == 0) {
+		recording[0] = '\0';
+		uart_puts("ok\r\n");
+		return;
+	}
+
+	char *name = strsep(&args, ARGUMENT_SEPERATORS);
+	if(name == NULL || name[0] == 0 || strlen(name) > MACRO_NAME_LENGTH) {
+		uart_puts("err macro expects a name\r\n");
+		return;
+	}
+	int slot = find_macro(name);
+	if(strcmp(action, "add") == 0) {
+		if(args == NULL || args[0] == 0) {
+			uart_puts("err macro add expects a line\r\n");
+			return;
+		}
+		append_macro_line(name, args);
+	} else if(strcmp(action, "record") == 0) {
+		strcpy(recording, name);
+		uart_puts("ok\r\n");
+	} else if(strcmp(action, "show") == 0 || strcmp(action, "delete") == 0) {
+		if(slot < 0) {
+			uart_puts("err no such macro\r\n");
+			return;
+		}
+		if(action[0] == 'd') {
+			if(slot == macro_slot)
+				macro_slot = -1;
+			macro_delete(slot);
+			write_macro(slot);
+			return;
+		}
+		uint8 length;
+		const char *text = get_macro_text(slot, &length);
+		int lines = 0;
+		for(int i = 0; i < length; i++)
+			lines += (text[i] == '\n');
+		format(response, "steps %d\r\n", lines);
+		uart_puts(response);
+		for(int start = 0, i = 0; i < length; i++) {
+			if(text[i] == '\n') {
+				uart_write((const uint8*)&text[start], i - start);
+				uart_puts("\r\n");
+				start = i + 1;
+			}
+		}
+	} else {
+		uart_puts("err macro expects add, record, show, delete, stop or end\r\n");
+	}
+}
+
+// run <name> starts a macro, in place of any running, and run alone reports
+// "run <name|idle>". A macro that finishes sends "event macro done".
+void command_run(char *args, const command_args *parsed) {
+	char response[24];
+	char *name = strsep(&args, ARGUMENT_SEPERATORS);
+	if(name != NULL && name[0] != 0) {
+		int slot = find_macro(name);
+		if(slot < 0) {
+			uart_puts("err no such macro\r\n");
+			return;
+		}
+		macro_start(slot);
+	}
+
+	format(response, "run %s\r\n", (macro_slot < 0)?"idle":get_macro_name(macro_slot));
+	uart_puts(response);
+}
+
+void command_boot(char *args, const command_args *parsed) {
+	if(parsed->count) {
+		uint8 fast_boot = parsed->values[0];
+		settings_write(&fast_boot, &settings->fast_boot, sizeof(fast_boot));
+	}
+
+	uart_puts(settings->fast_boot?"boot fast\r\n":"boot normal\r\n");
+}
+
+// remote [on|off|auto|manual] locks the front panel to the REMOTE screen or
+// releases it, or sets whether the first command of a session locks it. The
+// auto setting lasts until reset. Reports "remote <on|off> <auto|manual>".
+void command_remote(char *args, const command_args *parsed) {
+	char response[24];
+	if(parsed->count) {
+		uint8 choice = parsed->values[0];
+		if(choice < 2) {
+			ui_set_remote(choice);
+		} else {
+			ui_set_remote_auto(choice == 2);
+		}
+	}
+
+	format(response, "remote %s %s\r\n", ui_get_remote()?"on":"off", ui_get_remote_auto()?"auto":"manual");
+	uart_puts(response);
+}
+
+// powerfail [on|off] or powerfail resume <on|off> sets whether a supply
+// failure is snapshotted, and whether the snapshot is applied at the next
+// boot. Reports "powerfail <on|off> resume <on|off> <resumed>", resumed being
+// 1 if this boot carried on from a snapshot.
+void command_powerfail(char *args, const command_args *parsed) {
+	char response[40];
+	uint8 flags = get_powerfail_flags();
+	uint8 flag = POWERFAIL_FLAG_ON;
+
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg != NULL && strcmp(arg, "resume") == 0) {
+		flag = POWERFAIL_FLAG_RESUME;
+		arg = strsep(&args, ARGUMENT_SEPERATORS);
+	} else if(arg == NULL || arg[0] == 0) {
+		flag = 0;
+	}
+	if(flag != 0) {
+		if(arg != NULL && strcmp(arg, "on") == 0) {
+			flags |= flag;
+		} else if(arg != NULL && strcmp(arg, "off") == 0) {
+			flags &= ~flag;
+		} else {
+			uart_puts("err powerfail expects on or off\r\n");
+			return;
+		}
+		set_powerfail_flags(flags);
+	}
+
+	format(response, "powerfail %s resume %s %d\r\n", (flags & POWERFAIL_FLAG_ON)?"on":"off",
+		(flags & POWERFAIL_FLAG_RESUME)?"on":"off", get_powerfail_resumed());
+	uart_puts(response);
+}
+
+// clock [auto|eco|performance] sets how fast the CPU runs: eco at the design's
+// rate, performance at twice it, or auto to switch between them with the work
+// on hand. Reports "clock <mode> <MHz>".
+void command_clock(char *args, const command_args *parsed) {
+	static const char *clock_mode_names[] = {"auto", "eco", "performance", NULL};
+	char response[32];
+
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg != NULL && arg[0] != 0) {
+		int i;
+		for(i = 0; clock_mode_names[i] != NULL && strcmp(arg, clock_mode_names[i]) != 0; i++);
+		if(clock_mode_names[i] == NULL) {
+			uart_puts("err clock expects auto, eco or performance\r\n");
+			return;
+		}
+		set_clock_mode(i);
+		apply_clock_target();
+	}
+
+	format(response, "clock %s %u\r\n", clock_mode_names[get_clock_mode()], get_cpu_clock() / 1000000);
+	uart_puts(response);
+}
+
+// bootload answers "bootload <code>" with a fresh code; bootload <code> with
+// that code, within COMMS_BOOTLOAD_CONFIRM_MS, answers "bootload ok", turns
+// the output off and restarts into the bootloader. A stray or repeated line
+// can't do it, and neither can a code from an earlier request.
+void command_bootload(char *args, const command_args *parsed) {
+	static uint32 code = 0;
+	static portTickType issued;
+	char response[32];
+
+	char *given = strsep(&args, ARGUMENT_SEPERATORS);
+	if(given == NULL || given[0] == 0) {
+		code = 10000 + (get_time_us() ^ (xTaskGetTickCount() << 7)) % 90000;
+		issued = xTaskGetTickCount();
+		format(response, "bootload %u\r\n", code);
+		uart_puts(response);
+		return;
+	}
+
+	int confirmed = code != 0 && (uint32)atoi(given) == code
+		&& xTaskGetTickCount() - issued < COMMS_BOOTLOAD_CONFIRM_MS / portTICK_RATE_MS;
+	code = 0;
+	if(!confirmed) {
+		uart_puts("err bootload code wrong or expired\r\n");
+		return;
+	}
+
+	set_output_mode(OUTPUT_MODE_OFF);
+	uart_puts("bootload ok\r\n");
+	while(tx_used() > 0 || UART_SpiUartGetTxBufferSize() > 0)
+		vTaskDelay(1);
+	vTaskDelay(1);
+	watchdog_stop();
+	CyGlobalIntDisable;
+	BOOTLOADER_RUN_TYPE = BOOTLOADER_SCHEDULE_BTLDR;
+	CySoftwareReset();
+}
+
+// id answers "id reloadpro <version> <protocol> <serial>", the serial being
+// the die's unique ID from supervisory flash, in hex
+void command_id(char *args, const command_args *parsed) {
+	char response[48];
+	format(response, "id reloadpro %s %d %08x%08x\r\n", FIRMWARE_VERSION, PROTOCOL_VERSION,
+		CY_GET_REG32(CYREG_SFLASH_DIE_LOT0), CY_GET_REG32(CYREG_SFLASH_DIE_X));
+	uart_puts(response);
+}
+
+// What a host needs to set itself up, fixed when the firmware is built:
+// ranges in wire units, buffers in bytes and the rest in entries
+static const struct {
+	const char *name;
+	int32 value;
+} capabilities[] = {
+	{"current_max", CURRENT_FULLRANGE_MAX / 1000},
+	{"voltage_max", DEFAULT_OVERVOLTAGE_LIMIT},
+	{"slew_max", SLEW_MAX_RATE / 1000},
+	{"refresh_max", UI_REFRESH_MAX},
+	{"line_max", MAX_COMMS_LINE_LENGTH},
+	{"rx_buffer", COMMS_RX_BUFFER_SIZE},
+	{"tx_buffer", COMMS_TX_BUFFER_SIZE},
+	{"stream_record", sizeof(stream_record)},
+#ifdef USE_STREAM
+	{"stream_channels", STREAM_CHANNELS},
+#else
+	{"stream_channels", 0},
+#endif
+	{"stream_credit_max", STREAM_CREDIT_MAX},
+	{"block_scans", ADC_BLOCK_SCANS},
+	{"filter_max", ADC_FILTER_MAX_BLOCKS},
+#ifdef USE_SEQUENCE
+	{"sequence_steps", SEQUENCE_MAX_STEPS},
+#else
+	{"sequence_steps", 0},
+#endif
+	{"sequence_step_max", SEQUENCE_MAX_DURATION},
+#ifdef USE_AWG
+	{"awg_samples", AWG_MAX_SAMPLES},
+#else
+	{"awg_samples", 0},
+#endif
+	{"awg_rate_max", AWG_MAX_RATE},
+#ifdef USE_SWEEP
+	{"sweep_points", SWEEP_MAX_POINTS},
+#else
+	{"sweep_points", 0},
+#endif
+#ifdef USE_IMPEDANCE
+	{"impedance_points", IMPEDANCE_MAX_POINTS},
+#else
+	{"impedance_points", 0},
+#endif
+#ifdef USE_LOADREG
+	{"loadreg_points", LOADREG_MAX_POINTS},
+#else
+	{"loadreg_points", 0},
+#endif
+#ifdef USE_CAPTURE
+	{"capture_samples", CAPTURE_MAX_SAMPLES},
+#else
+	{"capture_samples", 0},
+#endif
+#ifdef USE_DATALOG
+	{"log_rows", DATALOG_ROWS},
+#else
+	{"log_rows", 0},
+#endif
+#ifdef USE_WATCH
+	{"watches", WATCH_COUNT},
+#else
+	{"watches", 0},
+#endif
+	{"fault_log", FAULT_LOG_LENGTH},
+	{"presets", PRESET_COUNT},
+	{"macros", MACRO_COUNT},
+#ifdef USE_STAGING
+	{"config_stage", CONFIG_STAGE_BYTES},
+#else
+	{"config_stage", 0},
+#endif
+#ifdef USE_FAN
+	{"fan", 1},
+#else
+	{"fan", 0},
+#endif
+#ifdef USE_TRIGGER
+	{"trigger", 1},
+#else
+	{"trigger", 0},
+#endif
+#ifdef USE_BATTERY_TEST
+	{"battery", 1},
+#else
+	{"battery", 0},
+#endif
+#ifdef USE_MPPT
+	{"mppt", 1},
+#else
+	{"mppt", 0},
+#endif
+#ifdef USE_IR_TEST
+	{"ir", 1},
+#else
+	{"ir", 0},
+#endif
+#ifdef USE_STANDBY
+	{"standby", 1},
+#else
+	{"standby", 0},
+#endif
+#ifdef USE_TUNE
+	{"tune", 1},
+#else
+	{"tune", 0},
+#endif
+#ifdef USE_OCP
+	{"ocp", 1},
+#else
+	{"ocp", 0},
+#endif
+#ifdef USE_PROFILE
+	{"profile", 1},
+#else
+	{"profile", 0},
+#endif
+#ifdef USE_RIPPLE
+	{"ripple", 1},
+#else
+	{"ripple", 0},
+#endif
+#ifdef USE_STATISTICS
+	{"statistics", 1},
+#else
+	{"statistics", 0},
+#endif
+#ifdef USE_SCPI
+	{"scpi", 1},
+#else
+	{"scpi", 0},
+#endif
+#ifdef TRACE
+	{"trace_records", TRACE_RECORDS},
+#else
+	{"trace_records", 0},
+#endif
+};
+#define CAPABILITY_COUNT (sizeof(capabilities) / sizeof(capabilities[0]))
+
+// caps lists, after "caps <count>", "cap modes <name>...", a "cap <name>
+// <value>" line for each of capabilities, and the measured scan rate as "cap
+// scan_rate <Hz>", 0 until there's been a ripple window
+void command_caps(char *args, const command_args *parsed) {
+	char response[32];
+	format(response, "caps %d\r\n", CAPABILITY_COUNT + 2);
+	uart_puts(response);
+
+	uart_puts("cap modes");
+	for(int i = 0; i <= LOAD_MODE_PULSE; i++) {
+		uart_puts(" ");
+		uart_puts(mode_names[i]);
+	}
+	uart_puts("\r\n");
+
+	for(int i = 0; i < CAPABILITY_COUNT; i++) {
+		format(response, "cap %s %d\r\n", capabilities[i].name, capabilities[i].value);
+		uart_puts(response);
+	}
+	format(response, "cap scan_rate %u\r\n", get_ripple_scan_rate());
+	uart_puts(response);
+}
+
+// filter <blocks> sets the precise reading's moving average, a power of two.
+// filter line <50|60> [cycles] integrates it over whole power line cycles
+// instead, and filter line off goes back to the average. filter alone reports
+// "filter <blocks> <line Hz, 0 if off> <cycles>".
+void command_filter(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *length = strsep(&args, ARGUMENT_SEPERATORS);
+	if(length != NULL && strcmp(length, "line") == 0) {
+		char *hz = strsep(&args, ARGUMENT_SEPERATORS);
+		char *cycles = strsep(&args, ARGUMENT_SEPERATORS);
+		if(hz == NULL || hz[0] == 0
+		   || !set_line_integration((strcmp(hz, "off") == 0)?0:atoi(hz), (cycles == NULL || cycles[0] == 0)?get_line_cycles():atoi(cycles))) {
+			uart_puts("err filter line expects 50, 60 or off, and cycles\r\n");
+			return;
+		}
+	} else if(length != NULL && length[0] != 0) {
+		if(!set_filter_length(atoi(length))) {
+			uart_puts("err filter length must be a power of two\r\n");
+			return;
+		}
+	}
+
+	format(response, "filter %d %d %d\r\n", get_filter_length(), get_line_frequency(), get_line_cycles());
+	uart_puts(response);
+}
+
+// stream <blocks> [<channel>[/<every>] ...] streams a record every blocks ADC
+// blocks, 0 to stop. Without channels they're stream_records; with them,
+// channel records of just those channels, each in every so many records (see
+// STREAM_SYNC_CHANNELS in tasks.h). Reports "stream <blocks> [<channel>[/<every>]
+// ...]", as does stream alone.
+#ifdef USE_STREAM
+void command_stream(char *args, const command_args *parsed) {
+	char response[80];
+
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg != NULL && arg[0] != 0) {
+		int blocks = atoi(arg);
+		uint8 channels = 0;
+		uint8 every[STREAM_CHANNELS] = {0};
+		while((arg = strsep(&args, ARGUMENT_SEPERATORS)) != NULL) {
+			if(arg[0] == 0)
+				continue;
+			char *divider = strchr(arg, '/');
+			if(divider != NULL)
+				*divider++ = 0;
+			int i;
+			for(i = 0; i < STREAM_CHANNELS && strcmp(arg, stream_channel_names[i]) != 0; i++);
+			int n = (divider != NULL)?atoi(divider):1;
+			if(i == STREAM_CHANNELS || n < 1 || n > 255) {
+				uart_puts("err stream channels are i v p temp opamp fet set flags, each /1 to /255\r\n");
+				return;
+			}
+			channels |= 1 << i;
+			every[i] = n;
+		}
+		set_stream_channels(channels, every);
+		stream_header_due = 1;
+		stream_flow = 0;
+		stream_withheld = 0;
+		set_stream_interval(blocks);
+	}
+
+	char *p = format(response, "stream %d", get_stream_interval());
+	for(int i = 0; i < STREAM_CHANNELS; i++) {
+		if(!(get_stream_channels() & (1 << i)))
+			continue;
+		p = format(p, " %s", stream_channel_names[i]);
+		if(get_stream_every(i) > 1)
+			p = format(p, "/%d", get_stream_every(i));
+	}
+	format(p, "\r\n");
+	uart_puts(response);
+}
+#else
+void command_stream(char *args, const command_args *parsed) {
+	write_not_built("USE_STREAM");
+}
+#endif
+
+void command_pulse(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg != NULL && strcmp(arg, "off") == 0) {
+		if(get_load_mode() == LOAD_MODE_PULSE)
+			set_load_mode(LOAD_MODE_CC);
+	} else if(arg != NULL && arg[0] != 0) {
+		pulse_config_t config;
+		int32 low_current, high_current;
+		char *high = strsep(&args, ARGUMENT_SEPERATORS);
+		char *frequency = strsep(&args, ARGUMENT_SEPERATORS);
+		char *duty = strsep(&args, ARGUMENT_SEPERATORS);
+		if(!parse_quantity(arg, 'A', &low_current) || !parse_quantity(high, 'A', &high_current)
+		   || frequency == NULL || frequency[0] == 0 || duty == NULL || duty[0] == 0) {
+			uart_puts("err pulse expects low high freq duty\r\n");
+			return;
+		}
+		config.low_current = low_current;
+		config.high_current = high_current;
+		config.frequency = atoi(frequency);
+		config.duty = atoi(duty);
+		if(tx_muted) {
+			// A broadcast; waits for 'trigger' like 'set'
+			armed_pulse = config;
+			armed |= ARMED_PULSE;
+			return;
+		}
+		if(!start_pulse_config(&config)) {
+			uart_puts("err pulse out of range\r\n");
+			return;
+		}
+	}
 
-xQueueHandle comms_queue;
-static char *current_line;
+	const pulse_config_t *config = get_pulse_config();
+	format(response, "pulse %d %d %d %d\r\n", (int)div1000(config->low_current), (int)div1000(config->high_current), config->frequency, config->duty);
+	uart_puts(response);
+}
 
-void UART_ISR_func() {
-	static char lines[2][MAX_COMMS_LINE_LENGTH];
-	static uint8 bufidx = 0;
-	static uint8 lineidx = 0;
-	
-	uint32 nchars = UART_SpiUartGetRxBufferSize();
-	for(int i = 0; i < nchars; i++) {
-		char c = UART_UartGetChar();
-		switch(c) {
-		case '\n':
-		case '\r':
-			if(bufidx > 0) {
-				lines[lineidx][bufidx] = 0;
-				if(xQueueSendToBackFromISR(comms_queue, &(comms_event){.type=COMMS_EVENT_LINE_RX}, NULL) == pdPASS) {
-					current_line = lines[lineidx];
-					lineidx = (lineidx + 1) % 2;
-				}
-				bufidx = 0;
+#ifdef USE_AWG
+// awg <offset> <amplitude> <rate> [<loops>] plays the waveform table about
+// offset, at rate samples a second, for loops passes or forever. awg sine and
+// awg triangle <samples> build a table; others are uploaded by binary frame.
+// awg off goes back to CC. Each answers "awg <samples> <offset mA>
+// <amplitude mA> <rate> <loops> <playing>".
+void command_awg(char *args, const command_args *parsed) {
+	char response[48];
+
+	char *arg = next_argument(&args);
+	if(arg == NULL) {
+		// Just report
+	} else if(strcmp(arg, "off") == 0) {
+		if(get_load_mode() == LOAD_MODE_PULSE)
+			set_load_mode(LOAD_MODE_CC);
+	} else if(strcmp(arg, "sine") == 0 || strcmp(arg, "triangle") == 0) {
+		int32 samples;
+		if(!parse_quantity(next_argument(&args), 0, &samples) ||
+		   !awg_fill((arg[0] == 's')?AWG_SHAPE_SINE:AWG_SHAPE_TRIANGLE, samples)) {
+			uart_puts("err awg shape expects a sample count\r\n");
+			return;
+		}
+	} else {
+		awg_config_t config;
+		int32 offset, amplitude, rate, loops = 0;
+		char *loop_arg;
+		if(!parse_quantity(arg, 'A', &offset) || !parse_quantity(next_argument(&args), 'A', &amplitude) ||
+		   !parse_quantity(next_argument(&args), 0, &rate) ||
+		   ((loop_arg = next_argument(&args)) != NULL && !parse_quantity(loop_arg, 0, &loops))) {
+			uart_puts("err awg expects offset amplitude rate [loops]\r\n");
+			return;
+		}
+		config.offset = offset;
+		config.amplitude = amplitude;
+		config.rate = (rate < 0 || rate > 0xFFFF)?0:rate;
+		config.loops = (loops < 0 || loops > 0xFFFF)?0xFFFF:loops;
+		if(!set_awg_config(&config)) {
+			uart_puts("err awg out of range or table empty\r\n");
+			return;
+		}
+		set_load_mode(LOAD_MODE_PULSE);
+	}
+
+	const awg_config_t *config = get_awg_config();
+	format(response, "awg %d %d %d %d %d %d\r\n", get_awg_length(), (int)div1000(config->offset),
+		(int)div1000(config->amplitude), config->rate, config->loops, get_awg_playing());
+	uart_puts(response);
+}
+#else
+void command_awg(char *args, const command_args *parsed) {
+	write_not_built("USE_AWG");
+}
+#endif
+
+#ifdef USE_SEQUENCE
+// What can follow 'until': a reading compared with lt or gt, or a total
+// reached since the step started. Power and energy are given in mW and mWh.
+static const struct {
+	const char *name;
+	uint8 until;	// The below condition for a reading, which above follows
+	char quantity;
+	uint8 compared;
+} until_names[] = {
+	{"v", SEQUENCE_UNTIL_VOLTAGE_BELOW, 'V', 1},
+	{"i", SEQUENCE_UNTIL_CURRENT_BELOW, 'A', 1},
+	{"p", SEQUENCE_UNTIL_POWER_BELOW, 'W', 1},
+	{"ah", SEQUENCE_UNTIL_CHARGE, 'A', 0},
+	{"wh", SEQUENCE_UNTIL_ENERGY, 'W', 0},
+};
+
+// Parses "until <v|i|p> <lt|gt> <value>" or "until <ah|wh> <value>" and
+// "goto <step> [<times>]", either or both, onto step
+static int parse_step_end(char *args, sequence_step *step) {
+	char *word;
+	while((word = next_argument(&args)) != NULL) {
+		if(strcmp(word, "until") == 0) {
+			char *name = next_argument(&args);
+			int i = 0;
+			while(i < sizeof(until_names) / sizeof(until_names[0]) && (name == NULL || strcmp(name, until_names[i].name) != 0))
+				i++;
+			if(i == sizeof(until_names) / sizeof(until_names[0]))
+				return 0;
+			step->until = until_names[i].until;
+			if(until_names[i].compared) {
+				char *compare = next_argument(&args);
+				if(compare == NULL || (strcmp(compare, "lt") != 0 && strcmp(compare, "gt") != 0))
+					return 0;
+				if(compare[0] == 'g')
+					step->until++;
 			}
+			char *value = next_argument(&args);
+			// "1.5Ah" is taken as "1.5A"
+			int length = (value == NULL)?0:strlen(value);
+			if(!until_names[i].compared && length > 1 && value[length - 1] == 'h')
+				value[length - 1] = 0;
+			if(!parse_quantity(value, until_names[i].quantity, &step->threshold) || step->threshold < 0)
+				return 0;
+			if(until_names[i].quantity == 'W')
+				step->threshold = mul_saturate(step->threshold, 1000);
+		} else if(strcmp(word, "goto") == 0) {
+			char *target = next_argument(&args);
+			char *times = next_argument(&args);
+			int32 jump, jumps = 0;
+			if(!parse_quantity(target, 0, &jump) || (times != NULL && !parse_quantity(times, 0, &jumps)))
+				return 0;
+			if(jump < 0 || jump >= SEQUENCE_MAX_STEPS || jumps < 0 || jumps > 255)
+				return 0;
+			step->jump = jump;
+			step->jumps = jumps;
+		} else {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+// Sends "results <steps>", then for each step its last run since the
+// sequence started: "result <step> <runs> <time|until|trigger|watch|stop>
+// <ms> <uAh> <uWh> <min mA> <mean mA> <max mA> <min mV> <mean mV> <max mV>",
+// runs 0 for a step that hasn't ended yet
+static void write_sequence_results() {
+	static const char *end_names[] = {"time", "until", "trigger", "watch", "stop"};
+	char response[40];
+	int length = get_sequence_length();
+	format(response, "results %d\r\n", length);
+	uart_puts(response);
+	for(int i = 0; i < length; i++) {
+		// The ADC task can finish one meanwhile
+		sequence_result r;
+		uint8 int_state = CyEnterCriticalSection();
+		const sequence_result *results = get_sequence_results();
+		if(results) {
+			r = results[i];
+		} else {
+			memset(&r, 0, sizeof(r));
+		}
+		CyExitCriticalSection(int_state);
+		format(response, "result %d %u %s ", i, r.runs, end_names[r.end]);
+		uart_puts(response);
+		format(response, "%u %u %u ", r.duration, r.charge, r.energy);
+		uart_puts(response);
+		const raw_statistics *current = &r.channel[FILTER_CURRENT], *voltage = &r.channel[FILTER_VOLTAGE];
+		format(response, "%d %d %d ", current_from_raw(current->min) / 1000,
+			current_from_raw(current->mean) / 1000, current_from_raw(current->max) / 1000);
+		uart_puts(response);
+		format(response, "%d %d %d\r\n", voltage_from_raw(voltage->min) / 1000,
+			voltage_from_raw(voltage->mean) / 1000, voltage_from_raw(voltage->max) / 1000);
+		uart_puts(response);
+	}
+}
+
+// sequence add <ms> <mode> <target> [until ...] [goto ...] appends a step;
+// with a condition the duration is its timeout. sequence start [<loops>]
+// plays the steps, sequence stop and clear end and empty it. Each answers
+// "sequence <steps> <current step>". sequence results sends each step's
+// figures from its last run instead (write_sequence_results).
+void command_sequence(char *args, const command_args *parsed) {
+	char response[32];
+
+	char *action = strsep(&args, ARGUMENT_SEPERATORS);
+	if(action == NULL || action[0] == 0) {
+		// Just report
+	} else if(strcmp(action, "clear") == 0) {
+		sequence_clear();
+	} else if(strcmp(action, "add") == 0) {
+		char *duration = strsep(&args, ARGUMENT_SEPERATORS);
+		char *name = strsep(&args, ARGUMENT_SEPERATORS);
+		char *target = strsep(&args, ARGUMENT_SEPERATORS);
+		load_mode mode;
+		int32 setpoint;
+		if(name == NULL || !parse_mode(name, &mode) || !parse_target(mode, target, &setpoint)) {
+			uart_puts("err sequence add expects ms mode target\r\n");
+			return;
+		}
+		sequence_step step = {.duration = atoi(duration), .setpoint = setpoint, .mode = mode, .jump = -1};
+		if(!parse_step_end(args, &step)) {
+			uart_puts("err sequence add expects until <quantity> <value> or goto <step>\r\n");
+			return;
+		}
+		if(!sequence_add(&step)) {
+			uart_puts("err sequence step rejected\r\n");
+			return;
+		}
+	} else if(strcmp(action, "start") == 0) {
+		char *loops = strsep(&args, ARGUMENT_SEPERATORS);
+		if(!sequence_start((loops == NULL || loops[0] == 0)?1:atoi(loops))) {
+			uart_puts("err sequence is empty or jumps past its end\r\n");
+			return;
+		}
+	} else if(strcmp(action, "stop") == 0) {
+		sequence_stop();
+	} else if(strcmp(action, "results") == 0) {
+		write_sequence_results();
+		return;
+	} else {
+		uart_puts("err unknown sequence action\r\n");
+		return;
+	}
+
+	format(response, "sequence %d %d\r\n", get_sequence_length(), get_sequence_step());
+	uart_puts(response);
+}
+#else
+void command_sequence(char *args, const command_args *parsed) {
+	write_not_built("USE_SEQUENCE");
+}
+#endif
+
+#ifdef USE_DATALOG
+// log <interval ms> starts logging to flash, log stop ends it, log reports the
+// interval and rows stored. log dump sends "log dump <rows>" and then that many
+// datalog_rows, oldest first, straight out of flash.
+void command_log(char *args, const command_args *parsed) {
+	char response[32];
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+
+	int rows = 0;
+	for(int i = 0; i < DATALOG_ROWS; i++)
+		if(get_datalog_row(i) != NULL)
+			rows++;
+
+	if(arg == NULL || arg[0] == 0) {
+		format(response, "log %u %d\r\n", get_datalog_interval(), rows);
+		uart_puts(response);
+	} else if(strcmp(arg, "dump") == 0) {
+		format(response, "log dump %d\r\n", rows);
+		uart_puts(response);
+		for(int i = 0; i < DATALOG_ROWS; i++) {
+			const uint8 *row = get_datalog_row(i);
+			if(row != NULL)
+				uart_write(row, sizeof(datalog_row));
+		}
+	} else if(strcmp(arg, "stop") == 0) {
+		datalog_stop();
+		uart_puts("ok\r\n");
+	} else {
+		datalog_start(atoi(arg));
+		format(response, "log %u\r\n", get_datalog_interval());
+		uart_puts(response);
+	}
+}
+#else
+void command_log(char *args, const command_args *parsed) {
+	write_not_built("USE_DATALOG");
+}
+#endif
+
+// trace reports "trace <records> <capacity>" for the event ring, trace clear
+// empties it, and trace dump sends "trace dump <records>" and then that many
+// trace_records, oldest first, recording paused meanwhile. Only in builds with
+// TRACE defined.
+void command_trace(char *args, const command_args *parsed) {
+#ifdef TRACE
+	char response[32];
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+
+	if(arg == NULL || arg[0] == 0) {
+		format(response, "trace %d %d\r\n", get_trace_count(), TRACE_RECORDS);
+		uart_puts(response);
+	} else if(strcmp(arg, "dump") == 0) {
+		trace_pause(1);
+		int count = get_trace_count();
+		format(response, "trace dump %d\r\n", count);
+		uart_puts(response);
+		for(int i = 0; i < count; i++)
+			uart_write((const uint8 *)get_trace_record(i), sizeof(trace_record));
+		trace_pause(0);
+	} else if(strcmp(arg, "clear") == 0) {
+		trace_clear();
+		uart_puts("ok\r\n");
+	} else {
+		uart_puts("err trace expects dump or clear\r\n");
+	}
+#else
+	uart_puts("err built without TRACE\r\n");
+#endif
+}
+
+// "fault <number> <cause> <uptime ms> <mA> <mV> <degrees C>", the readings
+// being those at the moment the output tripped
+static void write_fault(const fault_record *fault) {
+	char response[56];
+	format(response, "fault %u %s %u %d %d %d\r\n", fault->number, fault_name(fault->code), fault->uptime,
+		current_from_raw(fault->raw_current) / 1000, voltage_from_raw(fault->raw_voltage) / 1000, fault->temperature);
+	uart_puts(response);
+}
+
+// faults lists the fault log, newest first, after "faults <count>". faults
+// clear empties it.
+void command_faults(char *args, const command_args *parsed) {
+	char response[16];
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg != NULL && strcmp(arg, "clear") == 0) {
+		fault_log_clear();
+		uart_puts("ok\r\n");
+		return;
+	}
+
+	int count = 0;
+	while(count < FAULT_LOG_LENGTH && get_fault(count) != NULL)
+		count++;
+	format(response, "faults %d\r\n", count);
+	uart_puts(response);
+	for(int i = 0; i < count; i++)
+		write_fault(get_fault(i));
+}
+
+static const char *notify_names[NOTIFY_COUNT] = {"fault", "step", "cutoff", "mode", "set", "watch"};
+
+// "fault ..." as above for a trip, otherwise "event <type> <value>" with
+// values in wire units: the step index, the cutoff in mV, the mode's name,
+// the target in the mode's units as 'mode' takes them, or the watch's slot
+static void write_notifications() {
+	char response[32];
+	notification n;
+
+	while(notify_take(&n)) {
+		switch(n.type) {
+		case NOTIFY_FAULT:
+			if(get_last_fault() != NULL)
+				write_fault(get_last_fault());
+			continue;
+		case NOTIFY_CUTOFF:
+			format(response, "event cutoff %d\r\n", n.value / 1000);
 			break;
-		case 0:
+		case NOTIFY_MODE:
+			format(response, "event mode %s\r\n", mode_names[n.value]);
+			break;
+		case NOTIFY_SETPOINT:
+			format(response, "event set %d\r\n", (get_load_mode() == LOAD_MODE_CP)?n.value:n.value / 1000);
+			break;
+		case NOTIFY_WATCH:
+			format(response, "event watch %d\r\n", n.value + 1);
 			break;
 		default:
-			lines[lineidx][bufidx++] = c;
+			format(response, "event %s %d\r\n", notify_names[n.type], n.value);
 			break;
 		}
+		uart_puts(response);
 	}
-	
-	UART_ClearRxInterruptSource(UART_GetRxInterruptSourceMasked());
-}
 
-static portTickType tick_interval = portMAX_DELAY;
+	uint8 lost = notify_take_overflows();
+	if(lost) {
+		format(response, "event lost %u\r\n", lost);
+		uart_puts(response);
+	}
+}
 
-static void next_event(comms_event *event, portTickType interval) {
-	static portTickType last_tick = 0;
-	
-	portTickType now = xTaskGetTickCount();
-	if(now - last_tick > interval || !xQueueReceive(comms_queue, event, interval - (now - last_tick))) {
-		last_tick = xTaskGetTickCount();
-		event->type = COMMS_EVENT_MONITOR_DATA;
+// events [all|none|<type> ...] subscribes to the named notifications, from
+// fault, step, cutoff, mode, set and watch, replacing the previous choice,
+// and replies with "events" and what's subscribed. Faults alone are the
+// default.
+void command_events(char *args, const command_args *parsed) {
+	char response[48];
+	char *arg = strsep(&args, ARGUMENT_SEPERATORS);
+	if(arg != NULL && arg[0] != 0) {
+		uint8 mask = 0;
+		for(; arg != NULL && arg[0] != 0; arg = strsep(&args, ARGUMENT_SEPERATORS)) {
+			if(strcmp(arg, "all") == 0) {
+				mask = (1 << NOTIFY_COUNT) - 1;
+				continue;
+			}
+			if(strcmp(arg, "none") == 0)
+				continue;
+			int i;
+			for(i = 0; i < NOTIFY_COUNT && strcmp(arg, notify_names[i]) != 0; i++);
+			if(i == NOTIFY_COUNT) {
+				uart_puts("err unknown event\r\n");
+				return;
+			}
+			mask |= 1 << i;
+		}
+		set_notify_mask(mask);
 	}
+
+	char *out = format(response, "events");
+	for(int i = 0; i < NOTIFY_COUNT; i++)
+		if(get_notify_mask() & (1 << i))
+			out = format(out, " %s", notify_names[i]);
+	format(out, "\r\n");
+	uart_puts(response);
 }
 
-void write_state_data() {
+// Nothing posts the event in builds without USE_SEQUENCE, which have no queue
+static void write_sequence_log() {
+#ifdef USE_SEQUENCE
 	char response[32];
-	sprintf(response, "read %d %d\r\n", get_current_usage() / 1000, get_voltage() / 1000);
-	UART_UartPutString(response);
+	sequence_log_entry entry;
+
+	while(xQueueReceive(sequence_log_queue, &entry, 0)) {
+		format(response, "seq %d %u %d %d\r\n", entry.step, entry.timestamp, (int)div1000(entry.current), (int)div1000(entry.voltage));
+		uart_puts(response);
+	}
+#endif
 }
 
-void write_invalid_command(const char *cmdname) {
+static void write_last_crash() {
+	static const char *crash_names[] = {"none", "hardfault", "stack", "malloc", "heartbeat", "watchdog", "lockup"};
+	const crash_record *crash = get_last_crash();
+	char response[40];
+
+	format(response, "info crash %s %s\n", crash_names[crash->type], crash->type == CRASH_NONE?"":crash->task);
+	uart_puts(response);
+	if(crash->type == CRASH_HARD_FAULT) {
+		format(response, "info crash pc %08x lr %08x\n", crash->pc, crash->lr);
+		uart_puts(response);
+	}
+}
+
+void command_debug(char *args, const command_args *parsed) {
 	char response[32];
-	sprintf(response, "err Unknown command '%.7s'\r\n", cmdname);
-	UART_UartPutString(response);
+	
+	format(response, "info ui stack %d\n", (int)uxTaskGetStackHighWaterMark(ui_task));
+	uart_puts(response);
+ 	format(response, "info comms stack %d\n", (int)uxTaskGetStackHighWaterMark(comms_task));
+	uart_puts(response);
+	format(response, "info adc stack %d\n", (int)uxTaskGetStackHighWaterMark(adc_task));
+	uart_puts(response);
+	format(response, "info idle stack %d\n", (int)uxTaskGetStackHighWaterMark(xTaskGetIdleTaskHandle()));
+	uart_puts(response);
+	format(response, "info isr stack %d\n", get_main_stack_free());
+	uart_puts(response);
+	format(response, "info heap free %d\n", (int)xPortGetFreeHeapSize());
+	uart_puts(response);
+	format(response, "info tx highwater %d\n", tx_high_water);
+	uart_puts(response);
+	format(response, "info adc overruns %d\n", (int)get_adc_overruns());
+	uart_puts(response);
+	format(response, "info trip cycles %d\n", (int)get_trip_cycles_max());
+	uart_puts(response);
+	format(response, "info trigger cycles %d\n", (int)get_trigger_cycles_max());
+	uart_puts(response);
+	format(response, "info fet %d %d\n", (int)ADC_GetResult16(ADC_CHAN_OPAMP_OUT), (int)ADC_GetResult16(ADC_CHAN_FET_IN));
+	uart_puts(response);
+	write_selftest("info post");
+	write_last_crash();
+
+	static const char *milestones[] = {"display", "splash", "scheduler", "comms", "ui"};
+	for(int i = 0; i < BOOT_MILESTONE_COUNT; i++) {
+		format(response, "info boot %s %u\n", milestones[i], get_boot_milestone(i));
+		uart_puts(response);
+	}
+}
+
+static uint8 events_peak = 0; // Most comms events ever waiting, this one included
+
+static void write_buffer_usage(const char *name, const buffer_usage *usage) {
+	char response[40];
+	format(response, "mem %s %u %u ", name, usage->size, usage->bytes);
+	uart_puts(response);
+	format(response, "%u %u\r\n", usage->fill, usage->peak);
+	uart_puts(response);
 }
 
-void command_mode(char *args) {
-	UART_UartPutString("mode cc\r\n");
+static void write_stack_usage(const char *name, int words, int free) {
+	char response[32];
+	format(response, "mem stack %s %d %d\r\n", name, words, words - free);
+	uart_puts(response);
 }
 
-void command_set(char *args) {
+// mem reports what RAM each fixed buffer and ring has and how much of it gets
+// used, to size them by: "mem <buffer> <size> <bytes> <fill> <peak>" for
+// each, in its own entries (blocks, bytes, events, records, notifications or
+// samples), fill now and peak since boot; then "mem stack <task> <words>
+// <peak words>" for each task's stack and the ISRs' main stack; then "mem
+// heap <bytes> <free>".
+void command_mem(char *args, const command_args *parsed) {
 	char response[32];
-	
-	char *newsetpoint = strsep(&args, ARGUMENT_SEPERATORS);
-	if(newsetpoint[0] != 0) {
-		set_current(atoi(newsetpoint) * 1000);
+	buffer_usage usage;
+
+	get_adc_ring_usage(&usage);
+	write_buffer_usage("adc", &usage);
+	usage = (buffer_usage){COMMS_RX_BUFFER_SIZE, COMMS_RX_BUFFER_SIZE,
+		(rx_head + COMMS_RX_BUFFER_SIZE - rx_tail) % COMMS_RX_BUFFER_SIZE, rx_peak};
+	write_buffer_usage("rx", &usage);
+	usage = (buffer_usage){COMMS_TX_BUFFER_SIZE - 1, COMMS_TX_BUFFER_SIZE, tx_used(), tx_high_water};
+	write_buffer_usage("tx", &usage);
+	usage = (buffer_usage){COMMS_QUEUE_LENGTH, COMMS_QUEUE_LENGTH * sizeof(comms_event),
+		uxQueueMessagesWaiting(comms_queue), events_peak};
+	write_buffer_usage("events", &usage);
+	get_stream_queue_usage(&usage);
+	write_buffer_usage("stream", &usage);
+	get_notify_usage(&usage);
+	write_buffer_usage("notify", &usage);
+	get_capture_usage(&usage);
+	write_buffer_usage("capture", &usage);
+#ifdef TRACE
+	get_trace_usage(&usage);
+	write_buffer_usage("trace", &usage);
+#endif
+
+	write_stack_usage("ui", UI_TASK_STACK_SIZE, uxTaskGetStackHighWaterMark(ui_task));
+	write_stack_usage("comms", COMMS_TASK_STACK_SIZE, uxTaskGetStackHighWaterMark(comms_task));
+	write_stack_usage("adc", ADC_TASK_STACK_SIZE, uxTaskGetStackHighWaterMark(adc_task));
+	write_stack_usage("idle", configMINIMAL_STACK_SIZE, uxTaskGetStackHighWaterMark(xTaskGetIdleTaskHandle()));
+	write_stack_usage("isr", CYDEV_STACK_SIZE / sizeof(uint32), get_main_stack_free());
+
+	format(response, "mem heap %d %d\r\n", configTOTAL_HEAP_SIZE, (int)xPortGetFreeHeapSize());
+	uart_puts(response);
+}
+
+// Scales part/whole to a percentage without overflowing
+static int percent_of(uint32 part, uint32 whole) {
+	while(whole > 0x1000000) {
+		part >>= 1;
+		whole >>= 1;
 	}
-	
-	sprintf(response, "set %d\r\n", state.current_setpoint / 1000);
-	UART_UartPutString(response);
+	return whole?(part * 100) / whole:0;
 }
 
-void command_reset(char *args) {
-	set_output_mode(OUTPUT_MODE_FEEDBACK);
-	UART_UartPutString("ok\r\n");
+#ifdef USE_STATISTICS
+// "stats iv <window blocks> <scans>", then "stats <current|voltage> <min>
+// <max> <mean> <deviation> <peak to peak>" in microamps and microvolts
+static void write_iv_statistics() {
+	static const char *channel_names[] = {"current", "voltage"};
+	char response[40];
+	statistics stats;
+	get_statistics(&stats);
+
+	format(response, "stats iv %u %u\r\n", get_statistics_window(), stats.scans);
+	uart_puts(response);
+	for(int i = 0; i < FILTER_CHANNELS; i++) {
+		const channel_statistics *c = &stats.channel[i];
+		format(response, "stats %s %d %d ", channel_names[i], c->min, c->max);
+		uart_puts(response);
+		format(response, "%d %d %d\r\n", c->mean, c->deviation, c->ripple);
+		uart_puts(response);
+	}
 }
 
-void command_read(char *args) {
-	write_state_data();
+// "stats hold <scans>", then "stats <current|voltage> <peak> <valley>
+// <average>" in microamps and microvolts, held since the last reset
+static void write_holds() {
+	static const char *channel_names[] = {"current", "voltage"};
+	char response[40];
+	hold_readings holds;
+	get_holds(&holds);
+
+	format(response, "stats hold %u\r\n", holds.scans);
+	uart_puts(response);
+	for(int i = 0; i < FILTER_CHANNELS; i++) {
+		format(response, "stats %s %d %d ", channel_names[i], holds.peak[i], holds.valley[i]);
+		uart_puts(response);
+		format(response, "%d\r\n", holds.average[i]);
+		uart_puts(response);
+	}
 }
+#endif
 
-void command_monitor(char *args) {
-	char *newinterval = strsep(&args, ARGUMENT_SEPERATORS);
-	if(newinterval[0] == 0) {
-		UART_UartPutString("err monitor expects at least one argument\r\n");
-	} else {
-		int interval = atoi(newinterval);
-		if(interval == 0) {
-			tick_interval = portMAX_DELAY;
+// Run time since the last 'stats': each task's share, and each ISR's call
+// count, total and worst case cycles, and share. stats iv reports the scan
+// statistics instead, stats iv reset starts a new window and stats iv window
+// <blocks> sets its length, 0 to run until reset. stats hold reports the
+// hold readouts' figures and stats hold reset restarts them. The run times
+// are only in builds with USE_PROFILE defined, and iv and hold with
+// USE_STATISTICS.
+void command_stats(char *args, const command_args *parsed) {
+	char *which = strsep(&args, ARGUMENT_SEPERATORS);
+#ifdef USE_STATISTICS
+	if(which != NULL && strcmp(which, "iv") == 0) {
+		char *action = strsep(&args, ARGUMENT_SEPERATORS);
+		if(action == NULL || action[0] == 0) {
+			write_iv_statistics();
+		} else if(strcmp(action, "reset") == 0) {
+			statistics_reset();
+			uart_puts("ok\r\n");
+		} else if(strcmp(action, "window") == 0) {
+			char *blocks = strsep(&args, ARGUMENT_SEPERATORS);
+			if(blocks == NULL || blocks[0] == 0 || atoi(blocks) < 0 || atoi(blocks) > UINT16_MAX) {
+				uart_puts("err stats iv window expects blocks\r\n");
+				return;
+			}
+			set_statistics_window(atoi(blocks));
+			uart_puts("ok\r\n");
+		} else {
+			uart_puts("err stats iv expects reset or window\r\n");
+		}
+		return;
+	}
+	if(which != NULL && strcmp(which, "hold") == 0) {
+		char *action = strsep(&args, ARGUMENT_SEPERATORS);
+		if(action == NULL || action[0] == 0) {
+			write_holds();
+		} else if(strcmp(action, "reset") == 0) {
+			holds_reset();
+			uart_puts("ok\r\n");
 		} else {
-			tick_interval = (configTICK_RATE_HZ * interval) / 1000;
+			uart_puts("err stats hold expects reset\r\n");
 		}
+		return;
+	}
+#else
+	if(which != NULL && (strcmp(which, "iv") == 0 || strcmp(which, "hold") == 0)) {
+		write_not_built("USE_STATISTICS");
+		return;
+	}
+#endif
+
+#ifdef USE_PROFILE
+	static const char *task_names[] = {"ui", "comms", "adc", "idle"};
+	static const char *isr_names[] = {"adc", "uart", "button", "trigger", "timestamp", "quad"};
+	char response[32];
+	profile_snapshot snapshot;
+	take_profile_snapshot(&snapshot);
+
+	format(response, "stats window %u\r\n", snapshot.window / 1000);
+	uart_puts(response);
+	for(int i = 0; i < PROFILE_TASK_COUNT; i++) {
+		format(response, "stats task %s %d\r\n", task_names[i], percent_of(snapshot.task_time[i], snapshot.window));
+		uart_puts(response);
 	}
+	for(int i = 0; i < PROFILE_ISR_COUNT; i++) {
+		const isr_profile *isr = &snapshot.isr[i];
+		format(response, "stats isr %s %u ", isr_names[i], isr->count);
+		uart_puts(response);
+		format(response, "%u %u %d\r\n", isr->cycles, isr->max_cycles,
+			percent_of(isr->cycles / (get_cpu_clock() / 1000000), snapshot.window));
+		uart_puts(response);
+	}
+	format(response, "stats ui %u %u\r\n", snapshot.ui_refreshes, snapshot.ui_skipped);
+	uart_puts(response);
+#else
+	write_not_built("USE_PROFILE");
+#endif
+}
+
+static volatile int bench_sink;
+static char bench_buf[8];
+
+static void bench_set_current() {
+	// Rewrites the present setpoint, so the output doesn't change
+	set_current(state.current_setpoint);
+}
+
+static void bench_current() {
+	bench_sink = get_current_usage();
 }
 
-void command_debug(char *args) {
+static void bench_voltage() {
+	bench_sink = get_voltage();
+}
+
+static void bench_format_number() {
+	format_number(1234567, 'A', bench_buf);
+}
+
+static void bench_lookup() {
+	bench_sink = (int)in_word_set("status", 6);
+}
+
+static void bench_reciprocal() {
+	bench_sink = reciprocal_q30((bench_sink & 0xFFFF) | 1);
+}
+
+// The same loop from flash and, with RAM_FUNCTIONS, from SRAM
+#define BENCH_LOOP_BODY { \
+	uint32 x = bench_sink; \
+	for(int i = 0; i < 16; i++) \
+		x = x * 3 + (x >> 5); \
+	bench_sink = x; \
+}
+static void bench_flash_loop() BENCH_LOOP_BODY
+#ifdef RAM_FUNCTIONS
+RAMFUNC static void bench_ram_loop() BENCH_LOOP_BODY
+#endif
+
+// 64 bytes of the splashscreen, a mix of literal runs and short and long
+// back references like the bootloader's compressed rows
+#define BENCH_LZFX_BYTES 64
+static const uint8 bench_lzfx_data[] = {
+	0x00, 0x00, 0xc0, 0x00, 0x1b, 0x00, 0x04, 0x06, 0x0e, 0x00, 0x04, 0x0f,
+	0x0a, 0x01, 0x18, 0x0a, 0x1e, 0x28, 0x10, 0x1e, 0x60, 0x30, 0xf4, 0xf2,
+	0xc0, 0xe0, 0x80, 0xc0, 0x80, 0x00, 0x80, 0xc0, 0x00, 0xe0, 0x12, 0x00,
+};
+
+static void bench_lzfx() {
+	uint8 out[BENCH_LZFX_BYTES];
+	unsigned int len = sizeof(out);
+	bench_sink = lzfx_decompress(bench_lzfx_data, sizeof(bench_lzfx_data), out, &len);
+}
+
+static void write_bench(const char *name, uint32 cycles) {
 	char response[32];
-	
-	sprintf(response, "info ui stack %d\n", (int)uxTaskGetStackHighWaterMark(ui_task));
-	UART_UartPutString(response);
- 	sprintf(response, "info comms stack %d\n", (int)uxTaskGetStackHighWaterMark(comms_task));
-	UART_UartPutString(response);
-	sprintf(response, "info heap free %d\n", (int)xPortGetFreeHeapSize());
-	UART_UartPutString(response);
-	sprintf(response, "info fet %d %d\n", (int)ADC_GetResult16(ADC_CHAN_OPAMP_OUT), (int)ADC_GetResult16(ADC_CHAN_FET_IN));
-	UART_UartPutString(response);
+	format(response, "bench %s %u\r\n", name, cycles);
+	uart_puts(response);
+}
+
+// ping [<sequence>] answers "ping <sequence> <rx us> <start us> <tx us>": when
+// the line was completed in the UART ISR, when the comms task took it from the
+// ring and when the reply was queued, all on get_time_us(). Start less rx is
+// the wait for the task, tx less start the processing, and the rest of the
+// host's round trip is the wire and the host. tools/latency.py collects them.
+void command_ping(char *args, const command_args *parsed) {
+	char response[56];
+	char *sequence = strsep(&args, ARGUMENT_SEPERATORS);
+	uint32 value = (sequence != NULL)?strtoul(sequence, NULL, 10):0;
+	format(response, "ping %u %u %u %u\r\n", value, line_rx_time, line_start_time, get_time_us());
+	uart_puts(response);
+}
+
+// Times the hot paths on the target and prints cycles per call. The display
+// figures follow once the UI task has run them. Load step edges at each
+// opamp power level need a supply, so tools/edges.py measures those.
+void command_bench(char *args, const command_args *parsed) {
+	static const struct {
+		const char *name;
+		bench_func func;
+		uint16 iterations;
+	} cases[] = {
+		{"set_current", bench_set_current, 100},
+		{"current", bench_current, 100},
+		{"voltage", bench_voltage, 100},
+		{"format_number", bench_format_number, 100},
+		{"lookup", bench_lookup, 100},
+		{"reciprocal", bench_reciprocal, 100},
+		{"flash_loop", bench_flash_loop, 100},
+#ifdef RAM_FUNCTIONS
+		{"ram_loop", bench_ram_loop, 100},
+#endif
+#ifdef USE_SPLASHSCREEN
+		{"splash", decode_splashscreen, 1},
+#endif
+	};
+
+	for(int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+		write_bench(cases[i].name, bench_cycles(cases[i].func, cases[i].iterations));
+	// Cycles per decoded byte rather than per call
+	write_bench("lzfx_byte", bench_cycles(bench_lzfx, 10) / BENCH_LZFX_BYTES);
+
+	ui_post(UI_POST_BENCH);
+}
+
+static void write_ui_bench() {
+	for(int i = 0; i < UI_BENCH_COUNT; i++)
+		write_bench(ui_bench_results[i].name, ui_bench_results[i].cycles);
+}
+
+// Parses args to cmd's spec, or answers with an error and returns 0
+static int parse_arguments(const command_def *cmd, char *args, command_args *parsed) {
+	char error[COMMAND_ERROR_LENGTH];
+	if(parse_command_args(cmd, args, parsed, error))
+		return 1;
+	uart_puts(error);
+	return 0;
+}
+
+// Runs a command, parsing its arguments first if it has a spec
+static void run_command(const command_def *cmd, char *args) {
+	command_args parsed;
+	TRACE_EVENT(TRACE_COMMAND, ((uint8)cmd->name[0] << 8) | (uint8)cmd->name[1]);
+	if(cmd->args == NULL) {
+		cmd->handler(args, NULL);
+	} else if(parse_arguments(cmd, args, &parsed)) {
+		cmd->handler(args, &parsed);
+	}
 }
 
 void handle_command(char *buf) {
@@ -136,33 +3589,551 @@ void handle_command(char *buf) {
 	const command_def *cmd = in_word_set(cmdname, strlen(cmdname));
 	
 	if(cmd == NULL) {
-		write_invalid_command(cmdname);
+		// Not ours; put the line back together and see if it's SCPI
+		if(buf != NULL)
+			buf[-1] = ARGUMENT_SEPERATORS[0];
+		if(!scpi_handle(cmdname))
+			write_invalid_command(cmdname);
+	} else {
+		run_command(cmd, buf);
+	}
+}
+
+static void write_frame(uint8 opcode, const void *payload, uint8 len) {
+	uint8 header[FRAME_HEADER_LENGTH] = {FRAME_SYNC, opcode, len};
+	uint16 crc = crc16_update(0xFFFF, &header[1], 2);
+	crc = crc16_update(crc, payload, len);
+	uart_write(header, sizeof(header));
+	uart_write(payload, len);
+	uart_write((uint8*)&crc, sizeof(crc));
+}
+
+// Binary set: payload is the new setpoint in microamps, reply is the setpoint
+static void frame_set(uint8 opcode, const uint8 *payload, uint8 len) {
+	int32 setpoint;
+	if(len == sizeof(setpoint)) {
+		memcpy(&setpoint, payload, sizeof(setpoint));
+		arm_or_set_current(setpoint);
+	}
+	setpoint = state.current_setpoint;
+	write_frame(opcode | FRAME_REPLY, &setpoint, sizeof(setpoint));
+}
+
+// Fast set, when the UART ISR left it to the task: a broadcast, which arms a
+// synchronised set as 'set' does, or a frame with the wrong length
+static void frame_fast_set(uint8 opcode, const uint8 *payload, uint8 len) {
+	int32 setpoint;
+	if(len != sizeof(setpoint)) {
+		write_frame(FRAME_ERROR, &opcode, 1);
+		return;
+	}
+	memcpy(&setpoint, payload, sizeof(setpoint));
+	arm_or_set_current(setpoint);
+}
+
+// Acknowledges the fast set last applied: the setpoint it went to, in
+// microamps, then when, as get_time_us() microseconds
+static void write_setpoint_ack() {
+	struct {
+		int32 setpoint;
+		uint32 time;
+	} ack;
+	if(!control_take_applied(&ack.setpoint, &ack.time))
+		return;
+	ui_activity();
+	ui_remote_command();
+	write_frame(OPCODE_FAST_SET | FRAME_REPLY, &ack, sizeof(ack));
+}
+
+// Binary read: reply is current in microamps then voltage in microvolts
+static void frame_read(uint8 opcode, const uint8 *payload, uint8 len) {
+	measurement m;
+	get_measurement(&m);
+	int32 reading[2] = {m.current, m.voltage};
+	write_frame(opcode | FRAME_REPLY, reading, sizeof(reading));
+}
+
+// Binary status: reply is a status_snapshot
+static void frame_status(uint8 opcode, const uint8 *payload, uint8 len) {
+	status_snapshot status;
+	get_status(&status);
+	write_frame(opcode | FRAME_REPLY, &status, sizeof(status));
+}
+
+// Binary waveform upload: payload is the index of the first sample, then
+// int16 samples to write from there on, as awg_load() takes them; reply is
+// the table's length
+static void frame_awg(uint8 opcode, const uint8 *payload, uint8 len) {
+	int16 samples[(MAX_COMMS_LINE_LENGTH - FRAME_HEADER_LENGTH) / 2];
+	int count = (len - 1) / 2;
+	if(len < 1 || (len - 1) % 2 != 0 || count > sizeof(samples) / sizeof(samples[0])) {
+		write_frame(FRAME_ERROR, &opcode, 1);
+		return;
+	}
+	memcpy(samples, &payload[1], count * sizeof(int16));
+	if(!awg_load(payload[0], samples, count)) {
+		write_frame(FRAME_ERROR, &opcode, 1);
+		return;
+	}
+	uint8 length = get_awg_length();
+	write_frame(opcode | FRAME_REPLY, &length, sizeof(length));
+}
+
+// Binary calibration transfer, through the blob 'cal export' and 'cal import'
+// stage: payload is a byte offset into it, then bytes to write there; with
+// none, the reply is the offset then up to CAL_BLOB_CHUNK bytes from it, and
+// otherwise the offset after the last byte written
+static void frame_cal(uint8 opcode, const uint8 *payload, uint8 len) {
+	if(len < 1 || len > 1 + CAL_BLOB_CHUNK) {
+		write_frame(FRAME_ERROR, &opcode, 1);
+		return;
+	}
+	uint8 reply[1 + CAL_BLOB_CHUNK] = {payload[0]};
+	if(len > 1) {
+		if(!cal_stage(payload[0], &payload[1], len - 1)) {
+			write_frame(FRAME_ERROR, &opcode, 1);
+			return;
+		}
+		reply[0] = payload[0] + len - 1;
+		write_frame(opcode | FRAME_REPLY, reply, 1);
+		return;
+	}
+	const cal_blob *staged = get_cal_staged();
+	int count = sizeof(cal_blob) - payload[0];
+	if(count < 0 || staged == NULL)
+		count = 0;
+	if(count > CAL_BLOB_CHUNK)
+		count = CAL_BLOB_CHUNK;
+	if(count > 0)
+		memcpy(&reply[1], (const uint8*)staged + payload[0], count);
+	write_frame(opcode | FRAME_REPLY, reply, 1 + count);
+}
+
+// Binary step table upload: payload is the index of the first step, then
+// sequence_steps to append from there, checked as 'sequence add' checks them.
+// Index 0 clears the table first; any other has to follow on from its end, so
+// a table goes up in a few frames instead of a command a step. Reply is the
+// table's length.
+static void frame_sequence(uint8 opcode, const uint8 *payload, uint8 len) {
+	int count = (len - 1) / sizeof(sequence_step);
+	if(len < 1 || (len - 1) % sizeof(sequence_step) != 0 ||
+			(payload[0] != 0 && payload[0] != get_sequence_length())) {
+		write_frame(FRAME_ERROR, &opcode, 1);
+		return;
+	}
+	if(payload[0] == 0)
+		sequence_clear();
+	for(int i = 0; i < count; i++) {
+		sequence_step step;
+		memcpy(&step, &payload[1 + i * sizeof(step)], sizeof(step));
+		if(!sequence_add(&step)) {
+			write_frame(FRAME_ERROR, &opcode, 1);
+			return;
+		}
+	}
+	uint8 length = get_sequence_length();
+	write_frame(opcode | FRAME_REPLY, &length, sizeof(length));
+}
+
+typedef void (*frame_func)(uint8 opcode, const uint8 *payload, uint8 len);
+
+// Frame opcodes, each naming a text command. Frames for commands without a
+// binary handler carry that command's arguments as text, and get its usual
+// text reply.
+static const struct {
+	const char *name;
+	frame_func handler;
+} frame_commands[] = {
+	{"mode", NULL},		// 0x00
+	{"set", frame_set},	// 0x01
+	{"reset", NULL},	// 0x02
+	{"read", frame_read},	// 0x03
+	{"monitor", NULL},	// 0x04
+	{"debug", NULL},	// 0x05
+	{"filter", NULL},	// 0x06
+	{"stream", NULL},	// 0x07
+	{"pulse", NULL},	// 0x08
+	{"sequence", NULL},	// 0x09
+	{"boot", NULL},		// 0x0A
+	{"baud", NULL},		// 0x0B
+	{"status", frame_status},	// 0x0C
+	{"awg", frame_awg},	// 0x0D
+	{"cal", frame_cal},	// 0x0E
+	{"sequence", frame_sequence},	// 0x0F, the step table in binary
+	{"set", frame_fast_set},	// 0x10, applied by the UART ISR; see take_fast_set
+};
+
+#ifdef USE_STAGING
+// A configuration being staged by 'config begin': its lines, each ending in
+// '\n', and whether lines are going to it rather than being run
+static char staged_config[CONFIG_STAGE_BYTES];
+static uint8 staged_length;
+static uint8 staged_lines;
+static uint8 staging = 0;
+
+static void write_config(const char *state) {
+	char response[32];
+	format(response, "config %s %d\r\n", state, staged_lines);
+	uart_puts(response);
+}
+
+// Adds a line to the staged configuration once it's checked as far as it can
+// be without running it: that it names a command and, for one with a spec,
+// that its arguments parse. A line that fails gets the error it would have.
+static void stage_config_line(const char *line) {
+	char copy[MACRO_LINE_MAX + 1];
+	int length = strlen(line);
+	if(length > MACRO_LINE_MAX || staged_length + length + 1 > CONFIG_STAGE_BYTES) {
+		uart_puts("err config is full\r\n");
+		return;
+	}
+	strcpy(copy, line);
+	char *args = copy;
+	char *name = strsep(&args, ARGUMENT_SEPERATORS);
+	const command_def *cmd = in_word_set(name, strlen(name));
+	if(cmd == NULL) {
+		write_invalid_command(name);
+		return;
+	}
+	command_args parsed;
+	if(cmd->args != NULL && !parse_arguments(cmd, args, &parsed))
+		return;
+
+	memcpy(&staged_config[staged_length], line, length);
+	staged_length += length;
+	staged_config[staged_length++] = '\n';
+	staged_lines++;
+	write_config("staged");
+}
+
+// Runs the staged lines in order with the control loops held and their
+// replies muted, counting the errors among them. A CC setpoint still goes
+// out as its line runs; the feedback modes take up everything together on
+// the next block.
+static void commit_config() {
+	char line[MACRO_LINE_MAX + 1];
+	uint8 muted = tx_muted;
+	staging = 0;
+	tx_errors = 0;
+	tx_counting = 1;
+	set_control_hold(1);
+	for(uint8 start = 0, i = 0; i < staged_length; i++) {
+		if(staged_config[i] == '\n') {
+			memcpy(line, &staged_config[start], i - start);
+			line[i - start] = '\0';
+			tx_muted = 1;
+			handle_command(line);
+			start = i + 1;
+		}
+	}
+	set_control_hold(0);
+	tx_counting = 0;
+	tx_muted = muted;
+
+	char response[40];
+	format(response, "config committed %d %d\r\n", staged_lines, tx_errors);
+	uart_puts(response);
+	staged_length = staged_lines = 0;
+}
+
+// config begin stages the lines that follow instead of running them, each
+// answered "config staged <lines>" once checked; a line with a bad command or
+// arguments gets its error and is left out. config commit runs them together,
+// so the control loops never act on part of them, and answers only "config
+// committed <lines> <errors>", errors being the lines that answered with one
+// as they ran. Settings they change go to flash in the one save, as
+// any run of changes does. config abort drops them, and config alone reports
+// "config <staging|idle> <lines>". Binary frames with text arguments are
+// staged too; other frames run as they come.
+void command_config(char *args, const command_args *parsed) {
+	if(parsed->count == 0) {
+		write_config(staging?"staging":"idle");
+		return;
+	}
+	switch(parsed->values[0]) {
+	case 0:
+		staging = 1;
+		staged_length = staged_lines = 0;
+		write_config("staging");
+		break;
+	case 1:
+		if(!staging) {
+			uart_puts("err config commit without begin\r\n");
+			return;
+		}
+		commit_config();
+		break;
+	default:
+		staging = 0;
+		staged_length = staged_lines = 0;
+		write_config("idle");
+		break;
+	}
+}
+#else
+void command_config(char *args, const command_args *parsed) {
+	write_not_built("USE_STAGING");
+}
+#endif
+
+// Returns 1 if a command sent to address is for this unit, muting replies
+// to broadcasts
+static int accept_address(int address) {
+	tx_muted = (address == FRAME_BROADCAST);
+	if(!tx_muted && address != settings->address)
+		return 0;
+	ui_activity();
+	ui_remote_command();
+	return 1;
+}
+
+// Handles a frame in place in the receive ring
+static void handle_frame(uint8 *frame, uint8 len) {
+	uint8 *header = &frame[1];
+	int address = 0;
+	if(frame[0] == FRAME_SYNC_ADDRESSED)
+		address = *header++;
+	uint8 header_length = header + 2 - frame;
+
+	uint8 opcode = header[0];
+	uint8 payload_length = header[1];
+	uint8 *payload = &frame[header_length];
+	uint16 crc;
+
+	if(!accept_address(address))
+		return;
+	if(len != header_length + payload_length + sizeof(crc)) {
+		write_frame(FRAME_ERROR, &opcode, 1);
+		return;
+	}
+	memcpy(&crc, &payload[payload_length], sizeof(crc));
+	if(crc16_update(0xFFFF, &frame[1], header_length - 1 + payload_length) != crc ||
+			opcode >= sizeof(frame_commands) / sizeof(frame_commands[0])) {
+		write_frame(FRAME_ERROR, &opcode, 1);
+		return;
+	}
+
+	if(frame_commands[opcode].handler != NULL) {
+		frame_commands[opcode].handler(opcode, payload, payload_length);
+	} else {
+		const char *name = frame_commands[opcode].name;
+		payload[payload_length] = '\0'; // Overwrites the CRC
+#ifdef USE_STAGING
+		if(staging) {
+			char line[MACRO_LINE_MAX + 1];
+			if(strlen(name) + 1 + payload_length > MACRO_LINE_MAX) {
+				uart_puts("err config is full\r\n");
+				return;
+			}
+			format(line, "%s %s", name, (char*)payload);
+			stage_config_line(line);
+			return;
+		}
+#endif
+		run_command(in_word_set(name, strlen(name)), (char*)payload);
+	}
+}
+
+// Runs the running macro's next line and returns the ticks until the one
+// after. Each command, and each pass of a loop, takes a tick at least, so a
+// macro without waits can't starve the UI task.
+static portTickType macro_line() {
+	uint8 length;
+	const char *text = get_macro_text(macro_slot, &length);
+	if(text == NULL || macro_position >= length) {
+		macro_end("event macro done\r\n");
+		return configTICK_RATE_HZ;
+	}
+
+	char line[MACRO_LINE_MAX + 1];
+	int used = 0;
+	for(; macro_position < length && text[macro_position] != '\n'; macro_position++) {
+		if(used < MACRO_LINE_MAX)
+			line[used++] = text[macro_position];
+	}
+	line[used] = '\0';
+	macro_position++;
+
+	char *args = line;
+	char *word = strsep(&args, ARGUMENT_SEPERATORS);
+	int32 value;
+	if(strcmp(word, "wait") == 0) {
+		if(!parse_quantity(args, 0, &value) || value < 0) {
+			macro_end("err macro wait expects ms\r\n");
+		} else {
+			macro_resume = xTaskGetTickCount() + value / portTICK_RATE_MS;
+		}
+		return 0;
+	} else if(strcmp(word, "loop") == 0) {
+		if(!parse_quantity(args, 0, &value) || value < 0 || value > UINT16_MAX || macro_depth == MACRO_LOOP_DEPTH) {
+			macro_end("err macro loop expects a count, nested twice at most\r\n");
+		} else {
+			macro_loops[macro_depth].start = macro_position;
+			macro_loops[macro_depth].remaining = value;
+			macro_depth++;
+		}
+		return 0;
+	} else if(strcmp(word, "end") == 0) {
+		if(macro_depth == 0) {
+			macro_end("err macro end without loop\r\n");
+		} else if(macro_loops[macro_depth - 1].remaining == 0 || --macro_loops[macro_depth - 1].remaining > 0) {
+			macro_position = macro_loops[macro_depth - 1].start;
+			return 1;
+		} else {
+			macro_depth--;
+		}
+		return 0;
+	}
+
+	if(args != NULL)
+		args[-1] = ARGUMENT_SEPERATORS[0];
+	handle_command(line);
+	return 1;
+}
+
+// Runs the running macro's next line if its wait is over, replying as the
+// line that started it would, and returns the ticks until it's worth calling
+// again
+static portTickType macro_step() {
+	if(macro_slot < 0)
+		return configTICK_RATE_HZ;
+	portTickType wait = macro_resume - xTaskGetTickCount();
+	if((int32)wait > 0)
+		return (wait < configTICK_RATE_HZ)?wait:configTICK_RATE_HZ;
+
+	tx_muted = macro_muted;
+	wait = macro_line();
+	tx_muted = 0;
+	return wait;
+}
+
+// Strips an "@n " or "@* " address prefix and handles the line if it's for
+// this unit
+static void handle_line(char *line) {
+	int address = 0;
+	if(line[0] == '@') {
+		char *prefix = strsep(&line, ARGUMENT_SEPERATORS);
+		address = (prefix[1] == '*')?FRAME_BROADCAST:atoi(&prefix[1]);
+		if(line == NULL)
+			return;
+	}
+	if(!accept_address(address))
+		return;
+	if(recording[0] != '\0' && strcmp(line, "macro end") != 0) {
+		append_macro_line(recording, line);
+#ifdef USE_STAGING
+	} else if(staging && strncmp(line, "config", 6) != 0) {
+		stage_config_line(line);
+#endif
 	} else {
-		cmd->handler(buf);
+		handle_command(line);
 	}
 }
 
+// Called by main() before the scheduler starts, as heap_1 can't free and the
+// malloc failed hook is fatal, and so the queues exist before anything posts
+// to them: a sequence resumed by poweron_apply() logs to its queue at once.
+void start_comms() {
+	comms_queue = xQueueCreate(COMMS_QUEUE_LENGTH, sizeof(comms_event));
+#ifdef USE_SEQUENCE
+	sequence_log_queue = xQueueCreate(SEQUENCE_LOG_LENGTH, sizeof(sequence_log_entry));
+#endif
+	datalog_init();
+}
+
 void vTaskComms(void *pvParameters) {
-	comms_queue = xQueueCreate(1, sizeof(comms_event));
+	powerfail_start();
 
 	UART_ISR_StartEx(UART_ISR_func);
+	UART_ISR_SetPriority(IRQ_PRIORITY_COMMS);
 	UART_Start();
+	mark_boot_milestone(BOOT_MILESTONE_COMMS);
 
 	while(1) {
 		comms_event event;
 		
-		next_event(&event, tick_interval);
+		// Everything the task does is started by an event, so it sleeps until
+		// one, waking once a second anyway for the watchdog, and sooner when a
+		// running macro's next line is due
+		portTickType timeout = macro_step();
+		watchdog_heartbeat(WATCHDOG_TASK_COMMS);
+		if(!xQueueReceive(comms_queue, &event, timeout))
+			continue;
+		uint8 waiting = uxQueueMessagesWaiting(comms_queue) + 1;
+		if(waiting > events_peak)
+			events_peak = waiting;
 		switch(event.type) {
 		case COMMS_EVENT_MONITOR_DATA:
 			write_state_data();
 			break;
 		case COMMS_EVENT_LINE_RX:
-			handle_command(current_line);
+			// Handled below
+			break;
+		case COMMS_EVENT_NOTIFY:
+			// Handled below
+			break;
+		case COMMS_EVENT_STREAM_DATA:
+			write_stream_records();
+			break;
+		case COMMS_EVENT_SEQUENCE_LOG:
+			write_sequence_log();
+			break;
+		case COMMS_EVENT_DATALOG:
+			datalog_write_pending();
+			break;
+		case COMMS_EVENT_BENCH:
+			write_ui_bench();
 			break;
-		case COMMS_EVENT_OVERTEMP:
-			UART_UartPutString("overtemp\r\n");
+		case COMMS_EVENT_SWEEP_DONE:
+			#ifdef USE_SWEEP
+			write_sweep();
+			#endif
 			break;
+		case COMMS_EVENT_CAPTURE_DONE:
+			#ifdef USE_CAPTURE
+			write_finished_capture();
+			#endif
+			break;
+		case COMMS_EVENT_IMPEDANCE_DONE:
+			#ifdef USE_IMPEDANCE
+			write_impedance();
+			#endif
+			break;
+		case COMMS_EVENT_OCP_DONE:
+			#ifdef USE_OCP
+			write_ocp();
+			#endif
+			break;
+		case COMMS_EVENT_LOADREG_DONE:
+			#ifdef USE_LOADREG
+			write_loadreg();
+			#endif
+			break;
+		case COMMS_EVENT_BAUD:
+			set_baud(requested_baud);
+			break;
+		case COMMS_EVENT_SETPOINT_ACK:
+			// Handled below
+			break;
+		}
+
+		// Line and notification events can be dropped when the queue is full,
+		// so every wakeup handles all the lines and notifications waiting, and
+		// acknowledges any fast set
+		write_setpoint_ack();
+		write_notifications();
+		report_rx_errors();
+		char *line;
+		uint8 len;
+		while((line = read_line(&len)) != NULL) {
+			if(line[0] == (char)FRAME_SYNC || line[0] == (char)FRAME_SYNC_ADDRESSED)
+				handle_frame((uint8*)line, len);
+			else
+				handle_line(line);
+			tx_muted = 0;
+			release_lines();
 		}
+		apply_clock_target();
 	}		
 }
 
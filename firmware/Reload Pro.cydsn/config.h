@@ -11,6 +11,7 @@
 */
 
 #include <project.h>
+#include "units.h"
 
 typedef enum {
 	ADC_CHAN_CURRENT_SENSE = 0,
@@ -21,15 +22,318 @@ typedef enum {
 	ADC_CHAN_CURRENT_SET = 5,
 } adc_channel;
 
-#define UI_TASK_FREQUENCY 20 // hz
+// Channels converted on the SAR's injection channel rather than in every scan
+typedef enum {
+	ADC_SLOW_TEMP,
+	ADC_SLOW_CURRENT_SET,
+	ADC_SLOW_CHANNELS,
+} adc_slow_channel;
+
+// Status screen refresh rate, a setting. Readouts are only sent to the
+// display when their text changes, whatever the rate.
+#define UI_REFRESH_DEFAULT 10 // Hz
+#define UI_REFRESH_MAX 50 // Hz, refreshes are whole ticks apart
+
+// The backlight is switched in software from a timer (set_backlight), in 63
+// steps of a BACKLIGHT_PWM_PERIOD_US cycle
+#define BACKLIGHT_MAX_BRIGHTNESS 63
+#define BACKLIGHT_PWM_PERIOD_US 4000 // 250Hz, two interrupts a cycle while dimmed
+#define BACKLIGHT_DIM_BRIGHTNESS 4 // After backlight_timeout minutes without input
+#define BACKLIGHT_DEFAULT_TIMEOUT 10 // Minutes
+#define DISPLAY_SLEEP_FACTOR 3 // The LCD sleeps after this many backlight timeouts without input
+#define DISPLAY_REMOTE_SLEEP_MS 10000 // And this long into the remote lockout
+#define DISPLAY_ASLEEP_REFRESH_HZ 1 // The UI redraws this often while it sleeps
+
+// Trend graph of current and voltage
+#define GRAPH_WIDTH 150 // Samples, one per pixel column
+#define GRAPH_PAGES 6 // Display pages the plot takes, 8 pixels each
+#define GRAPH_HEIGHT (GRAPH_PAGES * 8)
+#define GRAPH_INTERVAL_US 200000 // So the graph spans 30 seconds
+#define GRAPH_VOLTAGE_MAX VOLTS(60) // At the top of the plot
+
+// Task stacks in words, allocated statically in main.c
+#define UI_TASK_STACK_SIZE 178
+#define COMMS_TASK_STACK_SIZE 173
+#define ADC_TASK_STACK_SIZE 64
+
+// Task priorities, all distinct. The control loops and the hardware trips run
+// in ISRs and don't depend on any of these. The ADC task does the filtering,
+// the published readings and the fault handling, and it preempts the others,
+// so its latency from a block completing is its own run time plus any
+// critical section: well inside one block. Comms comes next, so that streaming
+// and frame replies aren't held up behind a display redraw. The UI only has to
+// keep up with the user.
+#define ADC_TASK_PRIORITY (tskIDLE_PRIORITY + 3)
+#define COMMS_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
+#define UI_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+
+// Interrupt priorities, 0 highest of the four the NVIC implements. The ADC
+// ISR is the trip path as well as the control loop, so it shares the top level
+// with the supply monitor and is held off by nothing but a critical section.
+// The timers that pace the output come next: transient, slew and the alarm
+// all program the IDACs, and so does the trigger, and being at one level none
+// of them interrupts another. The UART has an 8 byte FIFO to ride out both of
+// those, and the user's button shares the lowest level with SysTick and
+// PendSV (configKERNEL_INTERRUPT_PRIORITY). The CM0 port masks every interrupt
+// in a critical section, so any of these may use the FromISR calls.
+#define IRQ_PRIORITY_PROTECTION 0 // ADC, power fail
+#define IRQ_PRIORITY_CONTROL 1    // Pulse timer, timestamp alarm, trigger
+#define IRQ_PRIORITY_COMMS 2      // UART
+#define IRQ_PRIORITY_UI 3         // Encoder button
+
+#define BUTTON_DEBOUNCE_US 100000
+#define BUTTON_HOLD_US 500000 // A press this long is a long press, which opens the menu
+#define BUTTON_DOUBLE_US 300000 // From a click's release to the next press for a double click
+
+// After this long without a command, the next one starts a new remote session
+// and, with auto lockout on, locks the front panel again
+#define REMOTE_QUIET_MS 10000
+
+// QuadratureISR counts every edge of both phases, four to a detent
+#define QUADRATURE_COUNTS_PER_DETENT 4
+#define QUADRATURE_POLL_TICKS 2 // 20ms
+
+// Setpoint knob acceleration: each detent counts for
+// 1 + ENCODER_ACCEL_US / (microseconds per detent) steps, up to
+// ENCODER_ACCEL_MAX. Slower than about 20 detents/s is always one step.
+#define ENCODER_ACCEL_US 50000
+#define ENCODER_ACCEL_MAX 10
 
 // How much does one encoder detent adjust the current?
-#define CURRENT_LOWRANGE_STEP 5000 // 5mA
-#define CURRENT_FULLRANGE_STEP 20000 // 20mA
+#define CURRENT_LOWRANGE_STEP MILLIAMPS(5)
+#define CURRENT_FULLRANGE_STEP MILLIAMPS(20)
+
+// How much does one encoder detent adjust the voltage in CV mode?
+#define VOLTAGE_STEP MILLIVOLTS(10)
+// ...and the resistance in CR mode, and the power in CP mode?
+#define RESISTANCE_STEP 100 // 100 milliohms
+#define POWER_STEP 100 // 100mW
+
+// Transient load generator
+#define PULSE_MIN_FREQUENCY 1 // Hz
+#define PULSE_MAX_FREQUENCY 1000 // Hz
+#define PULSE_MIN_PHASE_US 50
+#define PULSE_DEFAULT_LOW MILLIAMPS(100)
+#define PULSE_DEFAULT_HIGH AMPS(1)
+#define PULSE_DEFAULT_FREQUENCY 100 // Hz
+#define PULSE_DEFAULT_DUTY 50 // Percent
+#define PULSE_FLAG_HIGH 0x01
+#define PULSE_FLAG_EDGE 0x02
+
+// Arbitrary waveform generator
+#define AWG_MAX_SAMPLES 32 // 4 bytes each, shape and codes, in static RAM
+#define AWG_FULL_SCALE 32767 // A shape sample of this is the offset plus the amplitude
+#define AWG_MIN_RATE 16 // Samples a second, the least the pulse timer's 16 bits reach at 1MHz
+#define AWG_MAX_RATE 10000
+#define AWG_DEFAULT_RATE 1000
+
+// Setpoint slew limiter, in microamps per millisecond; 0 is off
+#define SLEW_STEP_US 100 // Pulse timer period while ramping
+#define SLEW_MAX_RATE 6000000 // Full range in 1ms
+#define OUTPUT_DEFAULT_RAMP 10 // Milliseconds for output on and off to ramp over
+#define OUTPUT_MAX_RAMP 1000
+
+// Load profile sequencer
+#define SEQUENCE_MAX_STEPS 8 // Each costs 28 bytes of scratch and 17 more of RAM
+#define SEQUENCE_UNTIL_BLOCKS 2 // Blocks in a row a step's condition must hold for
+#define BATTERY_CUTOFF_BLOCKS 4 // Blocks in a row below the cutoff that end a test
+#define BATTERY_DEFAULT_CUTOFF 3000000 // 3V, where the battery screen starts
+#define BATTERY_CURVE_POINTS 32 // Kept of the discharge curve, however long the test
+#define BATTERY_CURVE_INTERVAL_US 1000000 // Between the samples thinned down to them
+
+#define SWEEP_MAX_POINTS 40
+#define SWEEP_DEFAULT_SETTLE 2 // Blocks to wait after each step, at least
+#define SWEEP_SETTLE_COUNTS 2 // Raw voltage change between blocks that counts as settled
+#define SWEEP_SETTLE_TIMEOUT 64 // Blocks before a point is taken anyway
+#define SWEEP_DEFAULT_TO 1000000 // 1A, where the sweep screen starts
+
+#define IMPEDANCE_MAX_POINTS 20
+#define IMPEDANCE_MIN_SAMPLES 8 // Generator samples a cycle at the highest frequency
+#define IMPEDANCE_WINDOW_SCANS 4096 // Scans each point takes, rounded to whole cycles
+#define IMPEDANCE_SETTLE_CYCLES 2
+
+#define CAPTURE_MAX_SAMPLES 32 // 4 bytes each, in static RAM
+#define CAPTURE_DEFAULT_DEPTH 32
+#define CAPTURE_DEFAULT_PRE 8
+#define CAPTURE_STEP_DEFAULT_BAND 2 // Percent of the final voltage a step must recover to
+
+#define STATISTICS_DEFAULT_WINDOW 256 // Blocks
+
+#define RIPPLE_BINS 4
+#define RIPPLE_DEFAULT_WINDOW 256 // Blocks
+#define RIPPLE_MAX_WINDOW 4096 // Keeps the Goertzel state within 32 bits
+
+// Pulsed internal resistance test, on the transient generator
+#define IR_MAX_PULSES 100
+#define IR_MAX_DELAY 64 // Blocks from an edge to the reading after it
+#define IR_MAX_MISSED 8 // Pulses too short for the delay that abandon a test
+#define IR_DEFAULT_PULSES 10
+#define IR_DEFAULT_DELAY 4
+#define IR_DEFAULT_HIGH 1000000 // 1A, where the IR screen starts
+
+// CV loop auto-tuning by relay feedback ('tune')
+#define TUNE_DEFAULT_STEP 50000 // Microamps either side of the setpoint
+#define TUNE_DEFAULT_CYCLES 4 // Measured and averaged
+#define TUNE_MAX_CYCLES 20
+#define TUNE_SETTLE_CYCLES 2 // Left to build up before measuring
+#define TUNE_HYSTERESIS 2 // ADC counts of voltage error either side of the target
+#define TUNE_MAX_BLOCKS 4000 // Without the cycles done, there's no oscillation to find
+#define TUNE_MAX_GAIN 30000 // Microamps a count, and a count per block: the most a preset holds
+
+// Limit watches checked against every block ('watch')
+#define WATCH_COUNT 4
+#define WATCH_DEFAULT_DEBOUNCE 2 // Blocks in a row past the level before it fires
+#define WATCH_MAX_DEBOUNCE 250
+
+// Power supply overcurrent protection trip test
+#define OCP_SETTLE_BLOCKS 4 // At the starting current, before the reference voltage
+#define OCP_TRIP_SCANS 2 // Scans in a row below the threshold that count as a trip
+#define OCP_DEFAULT_DROP 20 // Percent of the reference voltage lost at a trip
+#define OCP_MIN_RATE 1000 // Microamps a second
+#define OCP_MAX_RATE AMPS(100)
+
+// Standby current measurement ('standby')
+#define STANDBY_LINE_CYCLES 50 // Line cycles a reading integrates, a second at 50Hz
+#define STANDBY_DEFAULT_HZ 50 // Without a line frequency in the settings
+#define STANDBY_ZERO_BLOCKS 256 // Averaged with the output off for the current offset
+#define STANDBY_HISTORY 8 // Readings the mean and its uncertainty are taken over
+#define STANDBY_STEP 100 // Microamps a knob detent on the standby screen
+#define STANDBY_MAX_SETPOINT CURRENT_LOWRANGE_MAX
+
+// Power supply load regulation test ('loadreg')
+#define LOADREG_MAX_POINTS 11
+#define LOADREG_DEFAULT_POINTS 5 // 0, 25, 50, 75 and 100% of the full load
+#define LOADREG_DEFAULT_SLOPE 1000 // Microvolts a second that count as settled
+#define LOADREG_DEFAULT_AVERAGE 500 // Milliseconds each reading is averaged over
+#define LOADREG_MAX_AVERAGE 10000
+#define LOADREG_WINDOW_MS 100 // The slope is between the means of windows this long
+#define LOADREG_SETTLE_TIMEOUT 10000 // Milliseconds before a point is averaged anyway
+
+// Timed short circuit test
+#define SHORT_MIN_DURATION 1000 // Microseconds
+#define SHORT_MAX_DURATION 1000000
+
+#define MPPT_DEFAULT_STEP MILLIAMPS(10)
+#define MPPT_DEFAULT_INTERVAL 8 // Blocks averaged between perturbations
+#define MPPT_MAX_INTERVAL 255
+
+// Host driven calibration ('cal')
+#define CAL_MAX_POINTS 32 // Per fit
+#define CAL_SAMPLES 16 // Readings averaged for each point, a tick apart
+#define DAC_TABLE_POINTS 32 // Per IDAC, so both tables fill one flash row
+#define DAC_TABLE_SHIFT 3 // log2 of the codes between table points
+#define DAC_TABLE_UNIT 4 // Microamps per table count, a range of +/-131mA
+
+// Background ADC offset tracking while the load is idle
+#define AUTOZERO_BLOCKS 128 // Idle blocks averaged for each update
+#define AUTOZERO_WINDOW 8 // Counts from the present offset that still read as zero
+#define AUTOZERO_RANGE 16 // Counts from the calibrated offset an update may move it
+
+// Die temperature and thermal derating
+#define THERMAL_FILTER_SHIFT 6 // The temperature filter averages about 2^n blocks
+#define THERMAL_INTERVAL_US 1000000 // Conversion to degrees and everything after it
+#define THERMAL_RATE_SHIFT 3 // Smoothing of the temperature trend, about 2^n intervals
+#define THERMAL_LOOKAHEAD 30 // Seconds the trend is projected ahead for derating
+#define THERMAL_DERATE_START 60 // Predicted degrees C where the current limit starts to fall
+#define THERMAL_DERATE_END 85 // Predicted degrees C where it reaches zero
+#define THERMAL_DEFAULT_CAL_TEMPERATURE 25 // Degrees C the default gains are for
+#define THERMAL_MODEL_US 100000 // Heatsink model step and SOA limit update
+#define THERMAL_SOA_MIN_VOLTAGE 100 // Millivolts below which the SOA doesn't limit
+// Heatsink model and MOSFET SOA defaults, to be measured for each build
+#define THERMAL_DEFAULT_RESISTANCE 2000 // Millidegrees C per watt, heatsink to ambient
+#define THERMAL_DEFAULT_TAU 120 // Seconds
+#define THERMAL_DEFAULT_JUNCTION_RESISTANCE 1500 // Millidegrees C per watt, junction to heatsink
+#define THERMAL_DEFAULT_JUNCTION_MAX 150 // Degrees C
+#define THERMAL_DEFAULT_SOA_KNEE 20000 // Millivolts
+#define THERMAL_JUNCTION_TAU_US 10000 // Junction to heatsink time constant, for pulses
+#define THERMAL_JUNCTION_MARGIN 5 // Degrees C past junction_max the per block model trips at
+// Fan cooling, for builds with USE_FAN defined and a Fan_PWM component on a
+// fan header, which the stock schematic doesn't have. The spare TCPWM's line
+// output needs a fixed pin, so it's a UDB PWM with a period of 100, the
+// compare being the duty in percent.
+#define FAN_DEFAULT_TARGET 45 // Degrees C the loop holds the modelled heatsink at
+#define FAN_KP 10 // Percent per degree over the target
+#define FAN_KI 1 // Percent per degree second
+#define FAN_MIN_DUTY 20 // Percent; fans stall below about this, so it's off instead
+
+// Opamp offset trim search
+#define OPAMP_TRIM_CODES 32 // Searched from 0, as the old linear scan did
+#define OPAMP_TRIM_SAMPLES 2 // Scans averaged at each step, after one to settle
+#define OPAMP_TRIM_TIMEOUT_US 50000 // Longest wait for a current set conversion
+#define OPAMP_TRIM_CURRENT MILLIAMPS(100) // Setpoint for a calibration pass
+#define OPAMP_AUTOZERO_CURRENT MILLIAMPS(10) // Setpoint for the boot search, kept small
+
+// Power on self test. The DAC points are read back with the gate held off, so
+// nothing flows even with a source attached.
+#define SELFTEST_DAC_LOW_CURRENT MILLIAMPS(20) // Within the low IDAC alone
+#define SELFTEST_DAC_HIGH_CURRENT MILLIAMPS(500)
+#define SELFTEST_DAC_TOLERANCE 10 // Percent of the expected current set counts...
+#define SELFTEST_DAC_SLACK 8 // ...plus this many counts either way
+#define SELFTEST_FET_OFF_LIMIT 50 // Counts the gate may read when driven low
+#define SELFTEST_FET_TRACK_LIMIT 10 // Gate and opamp output difference, as the ADC ISR trips at
+#define SELFTEST_DISPLAY_TIMEOUT_US 5000 // Longest the display's SPI may stay busy
+#define SEQUENCE_LOG_LENGTH 4
+#define SEQUENCE_MAX_DURATION 1800000 // 30 minutes, well inside the timestamp's range
+
+// Hardware trigger
+#define TRIGGER_PULSE_US 5 // Width of the pulse on the trigger output
+// The trigger lines, for builds with USE_TRIGGER defined and them wired to
+// spare pins; trigger.c sets them up itself, as the schematic has no pins for
+// them. The input's port interrupt is its line, so ports 0 and 4, whose lines
+// QuadratureISR and QuadButtonISR have, are out for it.
+#define TRIGGER_IN_PORT 1
+#define TRIGGER_IN_PIN 3
+#define TRIGGER_OUT_PORT 1
+#define TRIGGER_OUT_PIN 4
+
+// Time sync over the trigger line ('sync')
+#define TIMESYNC_MAX_DRIFT_PPB 1000000 // 1000ppm, far more than two crystals differ by
+#define TIMESYNC_DRIFT_SHIFT 2 // Each edge's drift estimate counts for 1/2^n
+
+// On-device logger, kept in spare flash rows like the settings
+#define DATALOG_ROWS 16 // 2KB of flash; a steady reading packs 50 or so samples a row
+#define DATALOG_QUEUE_LENGTH 2
+#define DATALOG_MIN_INTERVAL 100 // Milliseconds
+#define DATALOG_MAX_INTERVAL 60000 // Fits the row header's uint16
+
+// Fault history, in a flash row of its own
+#define FAULT_LOG_LENGTH 7 // The most records a row holds
+#define FAULT_OVERTEMP_LIMIT 90 // Degrees C of die temperature that trips the output
+#define FAULT_REVERSE_VOLTAGE MILLIVOLTS(500) // Reversed input that trips the output
+#define DEFAULT_OVERVOLTAGE_LIMIT 60000 // Millivolts, the rated maximum
+#define DEFAULT_UNDERVOLTAGE_LIMIT 0
+
+// Setpoint presets, in a flash row of their own
+#define PRESET_COUNT 8
+
+// Command macros, a flash row each
+#define MACRO_COUNT 4
+#define MACRO_NAME_LENGTH 8
+#define MACRO_LINE_MAX 40 // Copied onto the comms task's stack to run
+#define MACRO_LOOP_DEPTH 2 // Loops that can nest
+#define CONFIG_STAGE_BYTES 80 // Command lines 'config begin' holds for the commit, '\n' after each
+
+// Asynchronous notifications for the host
+#define NOTIFY_RING_LENGTH 4 // One slot is always empty
+
+// Settings are shadowed in RAM and saved to a rotating set of flash rows
+#define SETTINGS_ROWS 4
+#define SETTINGS_VERSION 8 // Bump when settings_t changes, so old rows are ignored
+#define SETTINGS_SAVE_DELAY 2000 // Milliseconds after the last change
+
+// Limits for CR mode
+#define CR_MIN_RESISTANCE 100 // 100 milliohms
+#define CR_DEFAULT_RESISTANCE OHMS(100)
+
+// Closed loop trim of the C/C output against the current sense reading
+#define TRIM_MAX_SHIFT 12 // Time constant of 2^shift blocks at the slowest
+#define TRIM_LIMIT MILLIAMPS(50) // Either way
+#define TRIM_SETTLE_BLOCKS 16 // After a setpoint change, before trimming again
+#define TRIM_MAX_ERROR_SHIFT 3 // Errors over 1/8 of the setpoint, like a supply that can't keep up, aren't trimmed
 
 // What's the maximum current?
-#define CURRENT_LOWRANGE_MAX 250000 // 250mA
-#define CURRENT_FULLRANGE_MAX 6000000 // 6A
+#define CURRENT_LOWRANGE_MAX MILLIAMPS(250)
+#define CURRENT_FULLRANGE_MAX AMPS(6)
 
 #define DEFAULT_DAC_HIGH_GAIN		21157//23718	// 1.2uA over 996 ohms, 0.05 ohm shunt = 23.718 milliamps per count
 #define DEFAULT_DAC_LOW_GAIN		186		// 1.2uA over 996 ohms, 0.05 ohm shunt = 0.186 milliamps per count
@@ -39,21 +343,158 @@ typedef enum {
 #define DEFAULT_ADC_CURRENT_GAIN 	599		// 1.024 volts / (1 microamp * 0.05 ohms) / 2048 / 16 = 625 microamps per count
 #define DEFAULT_ADC_VOLTAGE_OFFSET	0		
 #define DEFAULT_ADC_VOLTAGE_GAIN	2008	// 1.024 volts / (1 microvolt * (5.23 kiloohms / 205.23 kiloohms)) / 2048 / 16 = 1226 microvolts per count
+#define DEFAULT_CV_KP				2000
+#define DEFAULT_CV_KI				200
 
-#define ADC_MIX_RATIO 4 // 1 / 2^4 = 6.25%
+// ADC capture ring: scans are grouped into blocks that the ADC task filters in one go
+#define ADC_RING_CHANNELS 4 // Current, voltage, opamp out, FET in
+#define ADC_BLOCK_SCANS 8
+#define ADC_RING_BLOCKS 4
+#define ADC_RING_SCANS (ADC_BLOCK_SCANS * ADC_RING_BLOCKS)
+
+// Runtime SAR timing ('adc')
+#define ADC_AVG_MIN_SHIFT 4 // 16 samples; fewer would change the averaged channels' scale
+#define ADC_AVG_MAX_SHIFT 8 // 256 samples, the SAR's most
+#define ADC_SAMPLE_CLOCKS_MIN 2
+#define ADC_SAMPLE_CLOCKS_MAX 1023
+#define ADC_CONVERSION_CLOCKS 2 // Beyond the sample time and a clock a bit, for the scan rate estimate
+// The ring's channels, which the measurements and trips all read, stay in the scan
+#define ADC_SCAN_REQUIRED ((1u << ADC_CHAN_CURRENT_SENSE) | (1u << ADC_CHAN_VOLTAGE_SENSE) \
+	| (1u << ADC_CHAN_OPAMP_OUT) | (1u << ADC_CHAN_FET_IN))
+
+// The SAR range detector trips the output when the opamp output exceeds this,
+// in 12 bit counts; get_opamp_trip_limit() scales it to the channel's resolution
+#define OPAMP_OUT_TRIP_LIMIT 1900
+
+// Precise readings average the last 2^n block means; fast readings are a single block
+#define ADC_FILTER_MAX_BLOCKS 16
+#define ADC_DEFAULT_FILTER_SHIFT 4 // 16 blocks
+#define LINE_MAX_CYCLES 100 // Longest mains synchronous integration, 2s at 50Hz
+
+typedef enum {
+	FILTER_CURRENT = 0,
+	FILTER_VOLTAGE = 1,
+	FILTER_CHANNELS = 2,
+} filter_channel;
 
 #ifndef DEBUG
 // No splashscreen in debug builds
 #define USE_SPLASHSCREEN 1
 #endif
 
+// Optional features, each built in by uncommenting its line. A feature
+// left out keeps its functions as stubs, so the rest of the firmware calls
+// them as before; its commands answer "err built without USE_...", 'caps'
+// reports its table size or flag as 0 and the UI drops its screen. The
+// figures are the static RAM each adds, besides any scratch table. They're
+// all out by default, as the CY8C4245's 4 KB of SRAM has no room for them;
+// the ones with queues also need configTOTAL_HEAP_SIZE raising.
+// #define USE_AWG 1			// Waveform table for the transient generator, 204 bytes
+// #define USE_IMPEDANCE 1		// Output impedance sweep, 76 bytes; needs USE_AWG
+// #define USE_SWEEP 1			// I-V sweep, command and screen, 20 bytes
+// #define USE_LOADREG 1		// Load regulation test, 64 bytes
+// #define USE_BATTERY_TEST 1	// Battery discharge test, command and screen, 44 bytes
+// #define USE_MPPT 1			// Maximum power point tracker, command and screen, 64 bytes
+// #define USE_IR_TEST 1		// Pulsed internal resistance, command and screen, 36 bytes
+// #define USE_STANDBY 1		// Standby current measurement, command and screen, 108 bytes
+// #define USE_TUNE 1			// CV loop auto-tuning, 56 bytes
+// #define USE_OCP 1			// Overcurrent protection trip test, 52 bytes
+// #define USE_CAPTURE 1		// Triggered capture and the short circuit test on it, 216 bytes
+// #define USE_WATCH 1			// Limit watches, 96 bytes
+// #define USE_DATALOG 1		// Logging to flash, 160 bytes and DATALOG_ROWS of flash
+// #define USE_PROFILE 1		// Run times for 'stats', 128 bytes; TRACE's task switches need it
+// #define USE_GRAPH 1			// The trend graph screen, 392 bytes, chiefly its samples
+// #define USE_SEQUENCE 1		// Load profile sequencer, 193 bytes and its log queue
+// #define USE_SCPI 1			// The SCPI subset, 8 bytes
+// #define USE_STATISTICS 1	// Window statistics and the hold readouts, 238 bytes
+// #define USE_RIPPLE 1		// Ripple tones and the measured scan rate, 112 bytes
+// #define USE_STREAM 1		// Binary streaming, 36 bytes and its 120 byte queue
+// #define USE_STAGING 1		// Staged configurations, 'config begin' and 'commit', 83 bytes
+
+#if defined(USE_IMPEDANCE) && !defined(USE_AWG)
+#error "USE_IMPEDANCE plays its sines on the waveform generator, so needs USE_AWG"
+#endif
+#if defined(USE_SEQUENCE) && !defined(USE_STATISTICS)
+#error "USE_SEQUENCE takes each step's results from the statistics, so needs USE_STATISTICS"
+#endif
+
+// Build with RAM_FUNCTIONS defined to run the per scan code from SRAM, out of
+// the flash wait state the 48MHz clock adds: the ADC ISR, the regulators, the
+// trip and reciprocal_q30, about 600 bytes. The generated linker script
+// already gathers .ram into .data, which the startup code copies from flash,
+// and the linker's long branch veneers cover calls between the two. 'bench'
+// reports ram_loop against flash_loop to show what it saves.
+#ifdef RAM_FUNCTIONS
+#define RAMFUNC CY_SECTION(".ram") __attribute__((noinline))
+#else
+#define RAMFUNC
+#endif
+
+typedef enum {
+	LOAD_MODE_CC,
+	LOAD_MODE_CV,
+	LOAD_MODE_CR,
+	LOAD_MODE_CP,
+	LOAD_MODE_PULSE,
+} load_mode;
+
 typedef struct {
 	int current_setpoint;
 	int8 current_range;
+	load_mode load_mode;
+	int voltage_setpoint;	// Microvolts, for CV mode
+	int resistance_setpoint;	// Milliohms, for CR mode
+	int power_setpoint;		// Milliwatts, for CP mode
 } state_t;
 
 extern state_t state;
 
+typedef enum {
+	READOUT_NONE = 0,
+	READOUT_CURRENT_SETPOINT = 1,
+	READOUT_CURRENT_USAGE = 2,
+	READOUT_VOLTAGE = 3,
+	READOUT_POWER = 4,
+	READOUT_RESISTANCE = 5,
+	READOUT_VOLTAGE_SETPOINT = 6,
+	READOUT_RESISTANCE_SETPOINT = 7,
+	READOUT_POWER_SETPOINT = 8,
+	READOUT_CHARGE = 9,
+	READOUT_ENERGY = 10,
+	READOUT_CURRENT_RIPPLE = 11,	// Peak to peak, from the statistics window
+	READOUT_CURRENT_DEVIATION = 12,	// RMS ripple
+	READOUT_VOLTAGE_RIPPLE = 13,
+	READOUT_VOLTAGE_DEVIATION = 14,
+	READOUT_RIPPLE_TONE = 15,	// The first ripple analyser bin
+	READOUT_CURRENT_PEAK = 16,	// Held from every scan since the holds were reset
+	READOUT_CURRENT_VALLEY = 17,
+	READOUT_CURRENT_AVERAGE = 18,
+	READOUT_VOLTAGE_PEAK = 19,
+	READOUT_VOLTAGE_VALLEY = 20,
+	READOUT_VOLTAGE_AVERAGE = 21,
+	READOUT_CURRENT_BAR = 22,	// A bar of the current against its setpoint
+	READOUT_THERMAL_BAR = 23,	// A bar of the die temperature towards the trip
+	READOUT_COUNT,
+} readout_function;
+
+// Configuration for one display readout
+typedef struct {
+	uint8 readouts[3];	// readout_function, a byte each so the settings fit a flash row
+} display_config_t;
+
+// Layouts each load mode can switch between. settings_t.display_layouts has a
+// bit per mode for which is showing, so this can't go past 2 without widening it.
+#define DISPLAY_LAYOUTS 2
+
+// Configuration for all displays
+typedef struct {
+	display_config_t cc[DISPLAY_LAYOUTS];
+	display_config_t cv[DISPLAY_LAYOUTS];
+	display_config_t cr[DISPLAY_LAYOUTS];
+	display_config_t cp[DISPLAY_LAYOUTS];
+	display_config_t pulse[DISPLAY_LAYOUTS];
+} display_settings_t;
+
 typedef struct {
 	int dac_low_gain;		// Microamps per DAC count
 	int dac_high_gain;		// Microamps per DAC count
@@ -66,38 +507,601 @@ typedef struct {
 	
 	int adc_voltage_offset;	// ADC voltage reading offset in counts
 	int adc_voltage_gain;	// Microvolts per ADC count
+	int adc_current_tempco;	// Current gain change, ppm per degree C
+	int adc_voltage_tempco;	// Voltage gain change, ppm per degree C
+	int cal_temperature;	// Degrees C the gains were calibrated at
+
+	int thermal_resistance;	// Heatsink to ambient, millidegrees C per watt
+	int thermal_tau;		// Heatsink time constant, seconds
+	int junction_resistance; // MOSFET junction to heatsink, millidegrees C per watt
+	int junction_max;		// MOSFET junction limit, degrees C
+	int soa_knee;			// Millivolts above which the SOA allows less than full power
+	
+	int cv_kp;				// CV loop proportional gain, microamps per ADC count
+	int cv_ki;				// CV loop integral gain, microamps per ADC count per block
+
+	uint16 overvoltage_limit;	// Millivolts that trip the output, 0 for none
+	uint16 undervoltage_limit;	// Millivolts below which a running load trips, 0 for none
 	
-	int backlight_brightness; // 0-63
-	int lcd_contrast; // 0-63
+	// Small values are a byte each, so the settings fit a flash row
+	uint8 backlight_brightness; // 0 to BACKLIGHT_MAX_BRIGHTNESS
+	uint8 backlight_timeout; // Minutes without input before dimming, 0 for never
+	uint8 lcd_contrast; // 0-63
+	uint8 fast_boot;		// Nonzero to skip the splashscreen and power the LCD up in the background
+	uint8 address;			// Unit address on a shared serial bus, 0 if the bus isn't shared
+	uint8 ui_refresh_rate;	// Hz, 1 to UI_REFRESH_MAX
+	uint8 opamp_autozero;	// Nonzero to search for the opamp trim at boot
+
+	// Bit n set shows load_mode n's second layout. Switching is written with
+	// settings_write_volatile, so it never costs a flash write of its own.
+	uint8 display_layouts;
+	display_settings_t display;
 } settings_t;
 
 extern const settings_t *settings;
+void settings_init(const settings_t *defaults);
+void settings_write(const void *src, const void *field, int len);
+void settings_write_volatile(const void *src, const void *field, int len);
+void settings_save_pending();
+void settings_save();
 
+// What can end a sequence step before its duration runs out, checked by the
+// ADC task against each block. Charge and energy count from the step's start.
 typedef enum {
-	READOUT_NONE = 0,
-	READOUT_CURRENT_SETPOINT = 1,
-	READOUT_CURRENT_USAGE = 2,
-	READOUT_VOLTAGE = 3,
-	READOUT_POWER = 4,
-	READOUT_RESISTANCE = 5,
-} readout_function;
+	SEQUENCE_UNTIL_NONE,
+	SEQUENCE_UNTIL_VOLTAGE_BELOW,	// Threshold in microvolts
+	SEQUENCE_UNTIL_VOLTAGE_ABOVE,
+	SEQUENCE_UNTIL_CURRENT_BELOW,	// Microamps
+	SEQUENCE_UNTIL_CURRENT_ABOVE,
+	SEQUENCE_UNTIL_POWER_BELOW,		// Microwatts
+	SEQUENCE_UNTIL_POWER_ABOVE,
+	SEQUENCE_UNTIL_CHARGE,			// Microamp hours
+	SEQUENCE_UNTIL_ENERGY,			// Microwatt hours
+	SEQUENCE_UNTIL_MAX,
+} sequence_until;
 
-// Configuration for one display readout
+// One step of a load profile. Setpoint units follow the mode: microamps,
+// microvolts, milliohms or milliwatts. A step with a jump goes to that step
+// instead of the next when its condition holds or, with no condition, when
+// its duration runs out; the duration is then the condition's timeout.
 typedef struct {
-		const readout_function readouts[3];
-} display_config_t;
+	uint32 duration;	// Milliseconds
+	int32 setpoint;
+	int32 threshold;	// In the condition's units
+	uint8 mode;			// load_mode, CC to CP
+	uint8 until;		// sequence_until
+	int8 jump;			// Step to go to, or -1 for the next
+	uint8 jumps;		// Times the jump is taken before falling through, 0 for always
+} sequence_step;
 
-// Configuration for all displays
+// How a sequence step came to end
+typedef enum {
+	SEQUENCE_END_DURATION,	// It ran its time
+	SEQUENCE_END_CONDITION,	// Its condition held
+	SEQUENCE_END_TRIGGER,	// A trigger moved it on
+	SEQUENCE_END_WATCH,		// A limit watch jumped from it
+	SEQUENCE_END_STOP,		// The sequence was stopped or restarted
+} sequence_end;
+
+// The extremes and mean of a channel's scans over a span, in raw counts
 typedef struct {
-	display_config_t cc;
-} display_settings_t;
+	int16 min, max, mean;
+} raw_statistics;
+
+// A step's last run, which the ADC task keeps as it ends
+typedef struct {
+	raw_statistics channel[FILTER_CHANNELS];
+	uint32 charge;		// Microamp hours
+	uint32 energy;		// Microwatt hours
+	uint32 duration;	// Milliseconds
+	uint8 end;			// sequence_end
+	uint8 runs;			// Times it's ended since the sequence started, up to 255
+} sequence_result;
+
+typedef struct {
+	int low_current;	// Microamps
+	int high_current;	// Microamps
+	int frequency;		// Hz
+	int duty;			// Percent of the period spent at high_current
+} pulse_config_t;
+
+typedef struct {
+	int offset;			// Microamps, the level a shape sample of 0 plays at
+	int amplitude;		// Microamps either side of it at AWG_FULL_SCALE
+	uint16 rate;		// Samples a second
+	uint16 loops;		// Passes through the table, 0 for forever
+} awg_config_t;
+
+typedef enum {
+	AWG_SHAPE_SINE,
+	AWG_SHAPE_TRIANGLE,
+} awg_shape;
+
+// Precise readings from one ADC block, all taken together
+typedef struct {
+	uint32 timestamp;	// Microseconds, when the block completed
+	int current;		// Microamps
+	int voltage;		// Microvolts
+	int16 raw_current;	// Averaged ADC counts
+	int16 raw_voltage;
+} measurement;
 
 void set_current(int setpoint);
 int get_current_setpoint();
+int opamp_trim_search(int setpoint);
+int16 read_current_set();
+
+typedef enum {
+	SELFTEST_FET,		// Gate and opamp output both low with the output off
+	SELFTEST_DAC_LOW,	// Current set reads back the low IDAC's point
+	SELFTEST_DAC_HIGH,	// And the high IDAC's
+	SELFTEST_OPAMP,		// Loop holds the gate off at zero setpoint
+	SELFTEST_DISPLAY,	// SPI to the LCD goes idle
+	SELFTEST_COUNT,
+} selftest_check;
+
+uint8 selftest_run();
+void selftest_check_display();
+uint8 selftest_failures();
+int16 selftest_value(selftest_check check);
+uint32 selftest_time();
+void selftest_override();
+int selftest_passed();
+
+typedef enum {
+	FAULT_NONE,
+	FAULT_FET_MISMATCH,	// Gate and opamp output disagree: the FET isn't following
+	FAULT_GATE_LIMIT,	// Opamp output at the SAR's range limit
+	FAULT_OVERTEMP,		// Die reached FAULT_OVERTEMP_LIMIT
+	FAULT_SOA,			// Modelled junction at junction_max
+	FAULT_OVERVOLTAGE,	// Above overvoltage_limit
+	FAULT_UNDERVOLTAGE,	// Below undervoltage_limit
+	FAULT_REVERSE,		// Input reversed by FAULT_REVERSE_VOLTAGE or more
+	FAULT_COUNT,
+} fault_code;
+
+// The cause of a trip and the raw readings at the moment of it
+typedef struct {
+	uint32 uptime;		// Milliseconds since boot
+	uint16 number;		// Faults logged since the log was cleared, this one included
+	uint8 code;			// fault_code
+	int8 temperature;	// Degrees C
+	int16 raw_current;	// ADC counts
+	int16 raw_voltage;
+	int16 raw_opamp;
+	int16 raw_fet;
+} fault_record;
+
+void fault_capture(fault_code code, int16 raw_current, int16 raw_voltage, int16 raw_opamp, int16 raw_fet);
+fault_code fault_take();
+const fault_record *get_last_fault();
+const fault_record *get_fault(int age);
+const char *fault_name(fault_code code);
+void fault_save_pending();
+void fault_log_clear();
+
+// A stored setpoint: a load mode other than pulse, its target in the mode's
+// units, the voltage trip points in millivolts that go with it, and for CV the
+// loop gains it was stored with. Packed, so eight fit the row with the gains.
+typedef struct __attribute__((packed)) {
+	int32 target;
+	uint16 overvoltage_limit;
+	uint16 undervoltage_limit;
+	uint8 mode;			// load_mode
+	int16 cv_kp;		// As settings->cv_kp and cv_ki were when stored
+	int16 cv_ki;
+} preset;
+
+const preset *get_preset(int slot);
+int preset_recall(int slot);
+int preset_store(int slot);
+
+// What a unit sets itself up with at power on, before the UI task starts, so
+// a fixture can measure straight away: a preset's mode, target, trip points
+// and gains, whether the output comes on, and streaming. Kept in the preset
+// row's spare bytes.
+#define POWERON_NO_PRESET 0xFF
+typedef struct {
+	uint8 preset;			// Slot recalled, or POWERON_NO_PRESET for none
+	uint8 output;			// Nonzero to turn the output on, ramping as 'output on' does
+	uint8 stream_blocks;	// Blocks per record to stream from boot, 0 for none
+	uint8 stream_channels;	// As set_stream_channels() takes, each in every record
+} poweron_profile;
+
+const poweron_profile *get_poweron();
+int poweron_store(const poweron_profile *profile);
+void poweron_apply();
+
+const char *get_macro_name(int slot);
+const char *get_macro_text(int slot, uint8 *length);
+int find_macro(const char *name);
+int macro_append(const char *name, const char *line);
+void macro_delete(int slot);
+
+void thermal_block(const int16 *mean, uint32 timestamp);
+int get_temperature();
+int get_predicted_temperature();
+int get_heatsink_temperature();
+int get_soa_limit();
+int get_current_limit();
+int get_pulse_limit(uint32 width_us, uint8 duty, int low);
+int get_junction_temperature();
+#ifdef USE_FAN
+void fan_init();
+void set_fan_target(int celsius);
+int get_fan_target();
+void set_fan_override(int percent);
+int get_fan_override();
+int get_fan_duty();
+#endif
+void get_measurement(measurement *m);
+
+// A ring or buffer's use, for 'mem': entries it holds, the RAM they take,
+// and how many are in use now and at most since boot
+typedef struct {
+	uint16 size;
+	uint16 bytes;
+	uint16 fill;
+	uint16 peak;
+} buffer_usage;
+
+// Totals since power up or the last reset. Each wraps at 2^32.
+typedef struct {
+	uint32 charge;		// Microamp hours
+	uint32 energy;		// Microwatt hours
+	uint32 seconds;		// Time integrated over
+} energy_totals;
+
+void get_energy_totals(energy_totals *totals);
+void reset_energy_totals();
+void set_energy_totals(const energy_totals *totals);
+
+typedef enum {
+	BATTERY_IDLE,
+	BATTERY_RUNNING,
+	BATTERY_DONE,		// Reached the cutoff
+	BATTERY_STOPPED,	// Stopped early, by command or a trip
+} battery_state;
+
+// One point of an I-V sweep, as averaged ADC counts
+typedef struct {
+	int16 raw_current;
+	int16 raw_voltage;
+} sweep_point;
+
+int sweep_start(int from, int to, int count, int settle);
+void sweep_stop();
+void sweep_block(const int16 *mean);
+int get_sweep_index();
+int get_sweep_length();
+int get_sweep_unsettled();
+int get_sweep_setpoint(int i);
+const sweep_point *get_sweep_point(int i);
+
+// One point of an output impedance sweep
+typedef struct {
+	uint16 hz;
+	int16 phase;		// Tenths of a degree
+	int32 impedance;	// Milliohms, -1 if the current didn't move
+} impedance_point;
+
+int impedance_start(int dc, int amplitude, int from, int to, int count);
+void impedance_stop();
+void impedance_block(const int16 (*scans)[ADC_RING_CHANNELS]);
+int get_impedance_index();
+int get_impedance_length();
+const impedance_point *get_impedance_point(int i);
+
+typedef enum {
+	CAPTURE_IDLE,
+	CAPTURE_DONE,
+	CAPTURE_ARMED,		// Keeping the pre-trigger history, watching for the trigger
+	CAPTURE_TRIGGERED,	// Filling the rest of the buffer
+} capture_state;
+
+typedef enum {
+	CAPTURE_TRIGGER_SETPOINT,	// Any change of the C/C setpoint
+	CAPTURE_TRIGGER_RISING,		// Voltage crossing the level upwards
+	CAPTURE_TRIGGER_FALLING,
+	CAPTURE_TRIGGER_EXTERNAL,	// Falling edge on the trigger input
+	CAPTURE_TRIGGER_SHORT,		// The short circuit test turning the gate on
+} capture_trigger;
+
+int capture_start(capture_trigger trigger, int level, int depth, int pre);
+void capture_stop();
+void capture_scan(const int16 *scan);
+void capture_external_edge();
+void capture_short_edge();
+capture_state get_capture_state();
+int get_capture_depth();
+void get_capture_usage(buffer_usage *usage);
+int get_capture_pre();
+uint32 get_capture_interval();
+const int16 *get_capture_sample(int i);
+
+// A finished capture's load step response, taking the trigger as the step
+typedef struct {
+	int before;			// Microvolts, the mean of the pre-trigger samples
+	int after;			// Microvolts, the mean of the last quarter
+	int deviation;		// Microvolts from before to the furthest sample, signed
+	int overshoot;		// Microvolts past after, the other way from the deviation
+	int recovery;		// Microseconds until the voltage stays within the band of after, -1 if it never does
+	int current_step;	// Microamps, the same means' difference
+	int edge;			// Microseconds for the current to go from 10% to 90% of the step, -1 if it never does
+} capture_step_result;
+
+int get_capture_step(int band, capture_step_result *result);
+
+// Figures for one channel over a statistics window, in microamps or microvolts
+typedef struct {
+	int min;
+	int max;
+	int mean;
+	int deviation;	// Standard deviation, the RMS of the ripple
+	int ripple;		// Peak to peak
+} channel_statistics;
+
+typedef struct {
+	uint32 scans;	// In the window, 0 if there are no figures yet
+	channel_statistics channel[FILTER_CHANNELS];
+} statistics;
+
+void statistics_block(const int16 (*scans)[ADC_RING_CHANNELS]);
+void set_statistics_window(uint16 blocks);
+uint16 get_statistics_window();
+void statistics_reset();
+void get_statistics(statistics *stats);
+
+// Every scan's extremes and mean since the holds were last reset, in
+// microamps or microvolts by FILTER_CHANNELS
+typedef struct {
+	uint32 scans;	// Since the reset, 0 if there are no figures yet
+	int peak[FILTER_CHANNELS];
+	int valley[FILTER_CHANNELS];
+	int average[FILTER_CHANNELS];
+} hold_readings;
+
+void holds_reset();
+void get_holds(hold_readings *holds);
+void take_step_statistics(raw_statistics *stats);
+
+uint32 isqrt(uint64 n);
+
+void ripple_block(const int16 (*scans)[ADC_RING_CHANNELS], uint32 timestamp);
+int set_ripple_bin(int bin, int hz);
+int get_ripple_bin(int bin);
+int get_ripple_amplitude(int bin);
+int set_ripple_window(int blocks);
+int get_ripple_window();
+uint32 get_ripple_scan_rate();
+
+typedef enum {
+	IR_IDLE,
+	IR_RUNNING,
+	IR_DONE,
+	IR_STOPPED,		// By command, a trip, or too many missed pulses
+} ir_state;
+
+typedef struct {
+	int resistance;		// Micro-ohms, -1 if the current didn't step
+	int voltage_drop;	// Microvolts, mean over the pulses
+	int current_step;	// Microamps
+	uint8 pulses;		// Measured so far
+	uint8 missed;
+} ir_result;
+
+typedef enum {
+	TUNE_IDLE,
+	TUNE_RUNNING,
+	TUNE_DONE,
+	TUNE_FAILED,	// No oscillation to measure, too small or in too long
+	TUNE_STOPPED,	// By command, a trip, or something else taking the load
+} tune_state;
+
+typedef struct {
+	int kp;			// The gains set, as settings->cv_kp and cv_ki
+	int ki;
+	int ku;			// Critical gain, microamps a count
+	int tu;			// Critical period, blocks
+	uint8 cycles;	// Measured so far
+} tune_result;
+
+typedef enum {
+	WATCH_NONE,
+	WATCH_VOLTAGE,		// Microvolts
+	WATCH_CURRENT,		// Microamps
+	WATCH_POWER,		// Milliwatts
+	WATCH_TEMPERATURE,	// Degrees C
+	WATCH_TIME,			// Milliseconds since the watch was set
+	WATCH_QUANTITY_MAX,
+} watch_quantity;
+
+typedef enum {
+	WATCH_NOTIFY,		// Only the notification, which every action sends
+	WATCH_OFF,			// Turns the output off
+	WATCH_STEP,			// Jumps the sequencer to a step
+	WATCH_TRIGGER,		// Pulses the trigger output
+	WATCH_ACTION_MAX,
+} watch_action;
+
+typedef struct {
+	uint8 quantity;		// watch_quantity
+	uint8 below;		// Fires below the level rather than above it
+	uint8 action;		// watch_action
+	uint8 step;			// For WATCH_STEP
+	uint8 debounce;		// Blocks
+	int32 level;		// In the quantity's units
+	int32 hysteresis;	// How far back from the level re-arms it
+} watch_config;
+
+int watch_set(int slot, const watch_config *config);
+void watch_clear(int slot);
+const watch_config *get_watch(int slot);
+int get_watch_fired(int slot);
+uint16 get_watch_count(int slot);
+void watch_block(const int16 *mean);
+
+int tune_start(int step, int cycles);
+void tune_stop();
+void tune_block(const int16 *mean);
+tune_state get_tune_state();
+void get_tune_result(tune_result *r);
+
+int ir_start(int low, int high, int pulses, int delay);
+void ir_stop();
+void ir_block(const int16 *mean, uint8 flags);
+ir_state get_ir_state();
+void get_ir_result(ir_result *r);
+
+typedef enum {
+	OCP_IDLE,
+	OCP_SETTLING,	// At the starting current, for the reference voltage
+	OCP_RAMPING,
+	OCP_TRIPPED,
+	OCP_NO_TRIP,	// Reached the end of the ramp
+	OCP_STOPPED,	// By command, a fault, or another mode taking the load
+} ocp_state;
+
+typedef struct {
+	int reference;		// Microvolts, at the starting current
+	int voltage;		// Microvolts, the last whole block before the trip
+	int trip_current;	// Microamps, measured over that block
+	int trip_setpoint;	// Microamps, the ramp's setpoint at the trip
+	uint32 ms;			// From the start of the ramp to the trip
+} ocp_result;
+
+typedef enum {
+	LOADREG_IDLE,
+	LOADREG_RUNNING,
+	LOADREG_DONE,
+	LOADREG_STOPPED,	// By command, a fault, or another mode taking the load
+} loadreg_state;
+
+typedef struct {
+	int setpoint;		// Microamps
+	int current;		// Microamps, averaged once settled
+	int voltage;		// Microvolts, likewise
+	uint16 settle_ms;	// From the step to the slope's falling below the threshold
+	uint8 unsettled;	// Timed out and averaged anyway
+} loadreg_point;
+
+typedef enum {
+	STANDBY_IDLE,
+	STANDBY_ZEROING,	// Output off, taking the current offset
+	STANDBY_MEASURING,
+} standby_state;
+
+typedef struct {
+	int current;		// Microamps, mean of the last STANDBY_HISTORY readings
+	int uncertainty;	// Microamps, standard uncertainty of the mean and the zero
+	uint16 readings;	// Since the zero
+} standby_reading;
+
+int standby_start(int setpoint);
+void standby_stop();
+void standby_block(const int16 *mean);
+standby_state get_standby_state();
+int get_standby_setpoint();
+void get_standby_reading(standby_reading *r);
+
+int loadreg_start(int full, int points, int slope, int average);
+void loadreg_stop();
+void loadreg_block(const int16 *mean, uint32 timestamp);
+loadreg_state get_loadreg_state();
+int get_loadreg_index();
+int get_loadreg_length();
+const loadreg_point *get_loadreg_point(int i);
+int get_loadreg_regulation();
+
+int ocp_start(int from, int to, int rate, int drop);
+void ocp_stop();
+void ocp_block(const int16 (*scans)[ADC_RING_CHANNELS], const int16 *mean, uint32 now);
+ocp_state get_ocp_state();
+void get_ocp_result(ocp_result *r);
+
+typedef enum {
+	SHORT_IDLE,
+	SHORT_ARMING,		// Letting the capture fill its pre-trigger history
+	SHORT_ON,			// Gate forced on
+	SHORT_RECOVERING,	// Back in feedback, for the gate to settle
+	SHORT_DONE,
+	SHORT_STOPPED,		// By command or a trip
+} short_state;
+
+int short_start(int duration, int depth, int pre);
+void short_stop();
+void short_block();
+uint8 short_scan(const int16 *scan);
+short_state get_short_state();
+int get_short_duration();
+int get_short_peak_current();
+
+// The tracker's latest interval and its best since the start
+typedef struct {
+	int current;		// Microamps
+	int voltage;		// Microvolts
+	int power;			// Microwatts
+	int max_power;		// Microwatts
+	int max_voltage;	// Microvolts, at max_power
+	int efficiency;		// Percent, mean power over max_power
+} mppt_status;
+
+int mppt_start(int step, int interval);
+void mppt_stop();
+void mppt_block(const int16 *mean);
+int get_mppt_running();
+void get_mppt_status(mppt_status *status);
+
+int battery_start(load_mode mode, int target, int cutoff);
+void battery_stop();
+void battery_block(int16 raw_voltage);
+battery_state get_battery_state();
+int get_battery_cutoff();
+void get_battery_result(energy_totals *totals);
+void battery_curve_freeze(int freeze);
+int get_battery_curve_length();
+void get_battery_curve_point(int index, uint32 *charge, int16 *raw_voltage);
 int16 get_raw_current_usage();
 int get_current_usage();
+int get_current_usage_fast();
 int16 get_raw_voltage();
 int get_voltage();
+int get_voltage_fast();
+int16 get_raw_voltage_fast();
+int set_filter_length(int blocks);
+int get_filter_length();
+int set_line_integration(int hz, int cycles);
+int set_line_frequency(int hz);
+int get_line_frequency();
+int get_line_cycles();
+int32 get_line_current_fine(uint16 *periods);
+void set_stream_interval(int blocks);
+int get_stream_interval();
+void set_stream_channels(uint8 channels, const uint8 *every);
+uint8 get_stream_channels();
+int get_stream_every(int channel);
+void set_monitor_interval(uint32 interval);
+uint16 crc16_update(uint16 crc, const uint8 *data, int len);
+const int16 *get_last_scan();
+uint32 get_adc_overruns();
+void get_adc_ring_usage(buffer_usage *usage);
+void get_stream_queue_usage(buffer_usage *usage);
+int16 adc_read_slow(adc_slow_channel chan);
+int16 get_adc_slow(adc_slow_channel chan);
+int adc_set_averaging(int shift);
+int adc_get_averaging();
+int adc_set_sample_time(int timer, int clocks);
+int adc_get_sample_time(int timer);
+int adc_set_channel_timer(int channel, int timer);
+int adc_get_channel_timer(int channel);
+int adc_get_channel_averaged(int channel);
+int adc_channel_bits(int channel);
+int16 get_opamp_trip_limit();
+int adc_set_channel_scanned(int channel, int scanned);
+int adc_get_channel_scanned(int channel);
+uint32 adc_get_scan_rate();
+int adc_set_scan_rate(uint32 hz);
+uint32 get_trip_cycles_max();
 int get_power();
 
 typedef enum {
@@ -107,8 +1111,520 @@ typedef enum {
 } output_mode;
 
 void set_output_mode(output_mode);
+void trip_output();
+
+// The opamp's power level, trading its bandwidth, and so the edges of a load
+// step, against supply current and noise. Auto runs it at high power while the
+// transient generator is running, for pulse, AWG and the pulsed tests, and at
+// low power for a static load.
+typedef enum {
+	OPAMP_POWER_AUTO,
+	OPAMP_POWER_LOW,
+	OPAMP_POWER_MEDIUM,
+	OPAMP_POWER_HIGH,
+} opamp_power;
+
+void set_opamp_power(opamp_power power);
+opamp_power get_opamp_power();
+opamp_power get_opamp_power_level();
+void set_opamp_fast(int fast);
+void fault_trip(fault_code code);
+int handle_fault();
+void voltage_limits_update();
+
+// Work an ISR or task leaves for the ADC task, in defer.c; run in this order
+typedef enum {
+	DEFER_FAULT,		// Finish a trip: stop everything and tell the UI and host
+	DEFER_CAPTURE_DONE,	// Tell the comms task a capture is ready to send
+	DEFER_SEQUENCE_LOG,	// And that sequence log entries are waiting
+	DEFER_SETPOINT_ACK,	// And that a fast set frame's setpoint went out
+	DEFER_DATALOG,		// And that log records are queued to write
+	DEFER_SWEEP_DONE,	// And that a sweep has finished
+	DEFER_IMPEDANCE_DONE,	// Or an impedance sweep
+	DEFER_OCP_DONE,		// Or an overcurrent trip test
+	DEFER_LOADREG_DONE,	// Or a load regulation test
+	DEFER_STREAM_DATA,	// And that stream records are queued to send
+	DEFER_MONITOR_DATA,	// And that a monitor line is due
+	DEFER_COUNT,
+} defer_work;
+
+void defer_post(defer_work work);
+void defer_run();
+
+// Bit positions in the notify mask
+typedef enum {
+	NOTIFY_FAULT,		// Value is the fault_code; the log has the rest
+	NOTIFY_STEP,		// A sequence step finished; value is its index
+	NOTIFY_CUTOFF,		// A battery test reached its cutoff; value in microvolts
+	NOTIFY_MODE,		// Value is the new load_mode
+	NOTIFY_SETPOINT,	// The active mode's target changed; value in its units
+	NOTIFY_WATCH,		// A limit watch fired; value is its slot
+	NOTIFY_COUNT,
+} notify_type;
+
+typedef struct {
+	uint8 type;			// notify_type
+	int value;
+} notification;
+
+void notify_post(notify_type type, int value);
+int notify_take(notification *n);
+uint8 notify_take_overflows();
+void get_notify_usage(buffer_usage *usage);
+void notify_block();
+void set_notify_mask(uint8 mask);
+uint8 get_notify_mask();
 output_mode get_output_mode();
 
+void set_load_mode(load_mode mode);
+load_mode get_load_mode();
+void set_voltage_target(int target);
+int get_voltage_target();
+void set_resistance_target(int target);
+int get_resistance_target();
+void set_power_target(int target);
+int get_power_target();
+void set_load_target(load_mode mode, int target);
+void control_update();
+void set_control_hold(uint8 hold);
+void control_post_setpoint(int32 setpoint);
+int control_take_applied(int32 *setpoint, uint32 *when);
+int set_trim_shift(int shift);
+int get_trim_shift();
+int get_current_trim();
+void trim_block(const int16 *mean);
+
+int set_pulse_config(const pulse_config_t *new_config);
+const pulse_config_t *get_pulse_config();
+void start_pulse();
+void stop_pulse();
+void pulse_select_table();
+void pulse_update_limit();
+uint8 get_pulse_flags();
+
+int set_awg_config(const awg_config_t *new_config);
+const awg_config_t *get_awg_config();
+int awg_load(int first, const int16 *samples, int count);
+int awg_fill(awg_shape shape, int samples);
+int get_awg_length();
+int get_awg_playing();
+void awg_start();
+uint8 get_awg_flags();
+
+void slew_to(int current);
+void slew_stop();
+int set_slew_rate(int rate);
+void output_on();
+void output_off();
+int get_output_ramping();
+int set_output_ramp(int ms);
+int get_output_ramp();
+int get_slew_rate();
+int get_slewing();
+void set_dither(int enabled);
+int get_dither();
+void dither_stop();
+void dither_scan();
+uint8 get_dither_fraction();
+
+void sequence_clear();
+int sequence_add(const sequence_step *step);
+int sequence_start(int loops);
+void sequence_stop();
+void sequence_next_step();
+int sequence_resume(int step, int loops, uint32 elapsed);
+int sequence_jump(int step);
+int get_sequence_length();
+int get_sequence_step();
+int get_sequence_loops();
+uint32 get_sequence_step_elapsed();
+const sequence_step *get_sequence_steps();
+const sequence_result *get_sequence_results();
+void sequence_block(const int16 *mean);
+
+// Power fail snapshot and resume, in powerfail.c
+#define POWERFAIL_IRQ 9 // The SRSS interrupt, for the low voltage detect
+#define POWERFAIL_FLAG_ON 0x01 // Watch for the supply failing
+#define POWERFAIL_FLAG_RESUME 0x02 // Apply the snapshot at the next boot
+
+void powerfail_init();
+void powerfail_start();
+void set_powerfail_flags(uint8 flags);
+uint8 get_powerfail_flags();
+int get_powerfail_resumed();
+
+typedef enum {
+	TRIGGER_OFF,
+	TRIGGER_SET,	// The next edge applies a preloaded setpoint, once
+	TRIGGER_STEP,	// Every edge starts the sequencer's next step
+} trigger_action;
+
+void trigger_init();
+void trigger_arm(trigger_action action, int setpoint);
+trigger_action get_trigger_action();
+int get_trigger_setpoint();
+void trigger_output_write(uint8 level);
+void trigger_output_pulse();
+uint32 get_trigger_cycles_max();
+
+typedef struct {
+	uint8 synced;
+	int32 drift_ppb;	// The leader's clock's gain on ours
+	int32 last_error;	// Microseconds the last edge was off its predicted time
+	uint16 edges;		// Seen on the trigger, or pulsed
+} timesync_status;
+
+void timesync_edge();
+uint32 timesync_pulse();
+int timesync_set(uint32 common);
+void timesync_stop();
+uint32 timesync_convert(uint32 local);
+void get_timesync_status(timesync_status *status);
+
+void datalog_init();
+void datalog_start(uint32 interval);
+void datalog_stop();
+uint32 get_datalog_interval();
+void datalog_block();
+void datalog_write_pending();
+const uint8 *get_datalog_row(int age);
+
+void calibration_update();
+uint32 div1000(uint32 n);
+uint32 reciprocal_q30(uint32 x);
+uint8 current_to_dac(int current, uint8 *high, uint8 *low);
+void write_dac(uint8 high, uint8 low);
+int current_from_raw(int16 raw);
+int voltage_from_raw(int16 raw);
+int current_span_from_raw(int32 counts);
+int voltage_span_from_raw(int32 counts);
+int16 voltage_to_raw(int voltage);
+int16 current_to_raw(int current);
+int resistance_from_raw(int16 voltage_raw, int16 current_raw);
+
+// Least squares fits collected by the 'cal' command
+typedef enum {
+	CAL_FIT_VOLTAGE,	// ADC voltage counts to microvolts
+	CAL_FIT_CURRENT,	// ADC current counts to microamps
+	CAL_FIT_DAC_HIGH,	// High IDAC code to microamps
+	CAL_FIT_DAC_LOW,	// Low IDAC code to microamps
+	CAL_FIT_COUNT,
+} cal_fit;
+
+void cal_reset();
+int cal_add_point(cal_fit fit, int x, int y);
+int cal_points(cal_fit fit);
+int cal_solve(cal_fit fit, int *gain, int *offset);
+void calibration_set_temperature(int celsius);
+void dac_table_write(int dac, int i, int error);
+void dac_table_clear();
+
+// A unit's calibration as 'cal export' hands it to a host and 'cal import'
+// takes it back: settings_t from dac_low_gain to cal_temperature, then the
+// IDAC linearisation table. Little endian as the M0 lays it out, with the
+// CRC, over every byte before it, last.
+#define CAL_BLOB_MAGIC 0xCA1B
+#define CAL_BLOB_VERSION 1
+#define CAL_BLOB_VALUES 12
+#define CAL_BLOB_CHUNK 64 // Bytes a 'cal' frame moves, so one fits a line
+
+typedef struct {
+	uint16 magic;		// CAL_BLOB_MAGIC
+	uint8 version;		// CAL_BLOB_VERSION
+	uint8 length;		// sizeof(cal_blob)
+	uint32 serial[2];	// Die ID of the unit calibrated, as 'id' reports it
+	int32 values[CAL_BLOB_VALUES];
+	int16 dac_table[2][DAC_TABLE_POINTS];
+	uint16 reserved;	// Zero
+	uint16 crc;
+} cal_blob;
+
+typedef enum {
+	CAL_IMPORT_OK,
+	CAL_IMPORT_BAD_FORMAT,	// Wrong magic, version or length
+	CAL_IMPORT_BAD_CRC,
+	CAL_IMPORT_WRONG_UNIT,	// Another unit's serial, and not forced
+} cal_import_result;
+
+const cal_blob *cal_export();
+int cal_stage(int offset, const uint8 *data, int len);
+const cal_blob *get_cal_staged();
+cal_import_result cal_import(int force);
+
+// Running sums of one of the 'cal' least squares fits
+typedef struct {
+	int32 n;
+	int64 sx, sy, sxx, sxy;
+} cal_sums;
+
+// The tables of the tests that take over the load, and of a host calibration
+// session, which would fight over the output if they ran at once, so they
+// share one buffer in scratch.c. Starting one claims it, stopping whichever
+// had it; a table stays readable after its test ends, until another claims
+// the buffer, and then reads as empty. Tests left out of the build leave
+// their tables out too.
+typedef enum {
+	SCRATCH_NONE,
+	SCRATCH_SEQUENCE,
+	SCRATCH_SWEEP,
+	SCRATCH_IMPEDANCE,
+	SCRATCH_LOADREG,
+	SCRATCH_BATTERY,
+	SCRATCH_CAL_FITS,
+	SCRATCH_CAL_BLOB,
+} scratch_owner;
+
+typedef union {
+#ifdef USE_SEQUENCE
+	sequence_result sequence[SEQUENCE_MAX_STEPS];
+#endif
+#ifdef USE_SWEEP
+	sweep_point sweep[SWEEP_MAX_POINTS];
+#endif
+#ifdef USE_IMPEDANCE
+	impedance_point impedance[IMPEDANCE_MAX_POINTS];
+#endif
+#ifdef USE_LOADREG
+	loadreg_point loadreg[LOADREG_MAX_POINTS];
+#endif
+#ifdef USE_BATTERY_TEST
+	struct {
+		uint32 charge[BATTERY_CURVE_POINTS + 1];	// Microamp hours
+		int16 voltage[BATTERY_CURVE_POINTS + 1];	// Raw
+	} battery;
+#endif
+	cal_sums cal_fits[CAL_FIT_COUNT];
+	cal_blob cal_staged;
+} scratch_t;
+
+extern scratch_t scratch;
+void scratch_claim(scratch_owner owner);
+int scratch_owned(scratch_owner owner);
+
+char *format_uint(char *out, uint32 value, uint8 width);
+char *format_int(char *out, int value, uint8 width);
+char *format_hex(char *out, uint32 value, uint8 width);
+char *format(char *out, const char *fmt, ...);
+void format_number(int num, const char suffix, char *out);
+int parse_quantity(const char *text, char quantity, int32 *value);
+
+// Serial commands, looked up in the table gperf builds from tools/serial_keywords
+#define COMMAND_MAX_ARGS 3
+
+// Arguments parsed to a command's spec, in the order given
+typedef struct {
+	uint8 count;
+	int32 values[COMMAND_MAX_ARGS];
+} command_args;
+
+// parsed is NULL for commands without a spec, which parse args themselves
+typedef void (*command_func)(char *args, const command_args *parsed);
+
+// A spec is a letter per argument: i for an integer, A, V, W or R for a
+// current, voltage, power or resistance as parse_quantity() takes them, or
+// {a|b|c} for one of a list of words, giving its index. Arguments after a
+// [ may be left off.
+typedef struct command_def {
+	const char *name;
+	command_func handler;
+	const char *args;
+} command_def;
+
+#define ARGUMENT_SEPERATORS " "
+#define COMMAND_ERROR_LENGTH 40 // Room for the longest error parse_command_args() writes
+
+char *next_argument(char **args);
+int parse_command_args(const command_def *cmd, char *args, command_args *parsed, char *error);
+
+// TCPWM counters timer.c drives itself, none being placed in the schematic.
+// Counter 0 is the free-running timestamp; counter 1 paces whichever of the
+// transient generator, AWG and slew limiter is running, which are mutually
+// exclusive; counter 2 switches the backlight. Each counter's clock selector
+// and interrupt line follow counter 0's.
+#define TIMER_COUNTER_TIMESTAMP 0
+#define TIMER_COUNTER_PULSE 1
+#define TIMER_COUNTER_BACKLIGHT 2
+#define TIMER_CLOCK_HZ 1000000
+#define TIMER_CLK_SELECT CYREG_CLK_SELECT08 // TCPWM counter 0's peripheral clock
+#define TIMER_IRQ_BASE 16 // TCPWM counter 0's interrupt
+#define TIMER_INTR_TC 1 // Terminal count
+#define TIMER_INTR_CC_MATCH 2
+
+void start_timers();
+void timer_start(uint8 counter, uint16 period, uint32 mask, cyisraddress isr, uint8 priority);
+void timer_stop(uint8 counter);
+void timer_write_period(uint8 counter, uint16 period);
+void timer_write_counter(uint8 counter, uint16 value);
+void timer_write_compare(uint8 counter, uint16 value);
+uint16 timer_read_counter(uint8 counter);
+uint32 timer_get_interrupt(uint8 counter);
+void timer_clear_interrupt(uint8 counter, uint32 source);
+
 void setup();
+void load_splashscreen();
+void decode_splashscreen();
+void draw_text(uint8 page, uint8 col, const char *text, uint8 inverse);
+// Pixels on their way to the display: a label's row, or a burst of bar or
+// graph columns. Only the UI task draws, and none of them nests in another.
+#define DRAW_BUFFER_SIZE Display_COLUMNS
+extern uint8 draw_buffer[DRAW_BUFFER_SIZE];
+void start_timestamp();
+uint32 get_time_us();
+void set_backlight(uint8 brightness);
+uint32 cycles_since(uint32 start);
+typedef void (*bench_func)();
+uint32 bench_cycles(bench_func func, int iterations);
+
+// Points in startup whose time is recorded for the 'debug' command
+typedef enum {
+	BOOT_MILESTONE_DISPLAY,		// LCD powered up
+	BOOT_MILESTONE_SPLASHSCREEN,	// Splashscreen drawn (normal boot only)
+	BOOT_MILESTONE_SCHEDULER,	// About to start the scheduler
+	BOOT_MILESTONE_COMMS,		// Serial commands accepted
+	BOOT_MILESTONE_UI,			// First load screen shown
+	BOOT_MILESTONE_COUNT,
+} boot_milestone;
+
+void mark_boot_milestone(boot_milestone milestone);
+uint32 get_boot_milestone(boot_milestone milestone);
+void paint_main_stack();
+int get_main_stack_free();
+
+// Supervision, in watchdog.c. A task that hasn't checked in for the timeout
+// resets the unit with the output off. The hardware watchdog runs from the
+// ILO, which is only good to +/-60%, so its full count is 0.8 to 5 seconds;
+// it's fed every tick.
+#define WATCHDOG_TIMEOUT_MS 5000 // Longer than the 3 second splashscreen
+#define WATCHDOG_HARDWARE_MATCH 0xFFFF
+#define WATCHDOG_RES_CAUSE_WDT 0x01
+#define WATCHDOG_RES_CAUSE_LOCKUP 0x04
+
+typedef enum {
+	WATCHDOG_TASK_UI,
+	WATCHDOG_TASK_COMMS,
+	WATCHDOG_TASK_ADC,
+	WATCHDOG_TASK_COUNT,
+} watchdog_task;
+
+typedef enum {
+	CRASH_NONE,
+	CRASH_HARD_FAULT,
+	CRASH_STACK_OVERFLOW,
+	CRASH_MALLOC_FAILED,
+	CRASH_HEARTBEAT,	// The task named stopped checking in
+	CRASH_WATCHDOG,		// The hardware watchdog, with nothing recorded
+	CRASH_LOCKUP,		// A fault while handling a fault
+} crash_type;
+
+typedef struct {
+	uint32 magic;
+	uint32 pc;			// Where it faulted, for CRASH_HARD_FAULT
+	uint32 lr;
+	uint8 type;			// crash_type
+	char task[8];		// Running at the time, or "isr"; configMAX_TASK_NAME_LEN
+} crash_record;
+
+void watchdog_init();
+void watchdog_start();
+void watchdog_stop();
+void watchdog_heartbeat(watchdog_task task);
+void watchdog_tick();
+void watchdog_crash(crash_type type, const signed char *task, uint32 pc, uint32 lr);
+const crash_record *get_last_crash();
+
+// CPU clock scaling, in clock.c. The design runs at CLOCK_ECO_HZ; performance
+// doubles the CPU, with the peripheral dividers doubled to match.
+#define CLOCK_ECO_HZ CYDEV_BCLK__HFCLK__HZ
+#define CLOCK_PERFORMANCE_HZ (2 * CYDEV_BCLK__HFCLK__HZ)
+#define CLOCK_IDLE_MS 2000 // Idle time before auto slows down again
+
+typedef enum {
+	CLOCK_MODE_AUTO,	// Performance while there's work on, eco otherwise
+	CLOCK_MODE_ECO,
+	CLOCK_MODE_PERFORMANCE,
+} clock_mode;
+
+void set_cpu_clock(uint32 hz);
+uint32 get_cpu_clock();
+void set_clock_mode(clock_mode mode);
+clock_mode get_clock_mode();
+uint32 get_clock_target();
+
+// Run time accounting for the 'stats' command
+typedef enum {
+	PROFILE_TASK_UI,
+	PROFILE_TASK_COMMS,
+	PROFILE_TASK_ADC,
+	PROFILE_TASK_IDLE,
+	PROFILE_TASK_COUNT,
+} profile_task;
+
+typedef enum {
+	PROFILE_ISR_ADC,
+	PROFILE_ISR_UART,
+	PROFILE_ISR_BUTTON,
+	PROFILE_ISR_TRIGGER,
+	PROFILE_ISR_TIMESTAMP,	// Including the alarm callbacks, such as sequencer steps
+	PROFILE_ISR_QUADRATURE,
+	PROFILE_ISR_COUNT,
+} profile_isr_id;
+
+typedef struct {
+	uint32 count;
+	uint32 cycles;		// Total over the window
+	uint32 max_cycles;
+} isr_profile;
+
+typedef struct {
+	uint32 window;		// Microseconds since the last snapshot
+	uint32 task_time[PROFILE_TASK_COUNT];	// Microseconds
+	isr_profile isr[PROFILE_ISR_COUNT];
+	uint32 ui_refreshes;	// Status screen refreshes
+	uint32 ui_skipped;		// Of those, ones where no readout had changed
+} profile_snapshot;
+
+void profile_isr(profile_isr_id id, uint32 entry_ticks);
+void profile_ui_refresh(uint8 drawn);
+void take_profile_snapshot(profile_snapshot *snapshot);
+
+// Event trace for latency debugging, in trace.c. Build with TRACE defined to
+// record; without it TRACE_EVENT() compiles to nothing. tools/trace.py
+// decodes 'trace dump' and knows these ids, in this order.
+typedef enum {
+	TRACE_TASK_SWITCH,	// arg is the profile_task switched to
+	TRACE_ADC_BLOCK,	// arg is the block's first scan in the ring
+	TRACE_TRIP,			// The ISR has turned the gate off; arg is the fault_code
+	TRACE_FAULT,		// The ADC task handles the trip; arg is the fault_code
+	TRACE_BUTTON,		// arg is 1 for down, 0 for up
+	TRACE_LINE_RX,		// A whole line is in the RX ring; arg is its length
+	TRACE_COMMAND,		// Starting a command; arg is the first two letters of its name
+	TRACE_TX,			// Queued for sending; arg is the bytes
+	TRACE_DAC,			// arg is the high IDAC code << 8 | the low code
+} trace_event_id;
+
+typedef struct {
+	uint32 time;		// get_time_us()
+	uint16 arg;
+	uint8 id;			// trace_event_id
+	uint8 reserved;
+} trace_record;
+
+#ifdef TRACE
+#ifndef TRACE_RECORDS
+#define TRACE_RECORDS 64 // 512 bytes of RAM
+#endif
+#define TRACE_EVENT(id, arg) trace_event((id), (arg))
+void trace_event(trace_event_id id, uint16 arg);
+void trace_pause(uint8 paused);
+void trace_clear();
+int get_trace_count();
+void get_trace_usage(buffer_usage *usage);
+const trace_record *get_trace_record(int i);
+#else
+#define TRACE_EVENT(id, arg) do {} while(0)
+#endif
+typedef void (*alarm_func)(uint32 when);
+void set_alarm(uint32 when, alarm_func callback);
+void cancel_alarm();
 
 /* [] END OF FILE */
@@ -0,0 +1,292 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <stdlib.h>
+#include "config.h"
+
+// Control loops for the load modes other than constant current. These run once
+// per ADC block from the ADC ISR, so their rate is fixed by the acquisition
+// rather than by the RTOS tick or task scheduling. Anything that needs a divide is precomputed when
+// the target changes, since the M0 has no hardware divider.
+
+static int16 cv_target_raw = 0;
+static int16 cv_last_error = 0;
+
+// Microamps per ADC voltage count, Q16. Set from the resistance target.
+static uint32 cr_scale = 0;
+// Microamps times ADC voltage counts, scaled by 2^-6. Set from the power target.
+static uint32 cp_scale = 0;
+
+// The C/C trim: microamps added to the setpoint on its way to the IDACs,
+// times 2^trim_shift
+static int32 trim_sum = 0;
+static int8 trim_shift = -1;	// -1 is off
+static int trim_setpoint = 0;	// The setpoint last trimmed at
+static uint8 trim_settling = 0;
+
+
+static int clamp_current(int current) {
+	if(current < 0)
+		return 0;
+	if(current > CURRENT_FULLRANGE_MAX)
+		return CURRENT_FULLRANGE_MAX;
+	return current;
+}
+
+void set_load_mode(load_mode mode) {
+	if(mode == state.load_mode)
+		return;
+
+	// Start regulators from the present setpoint so the switch is bumpless
+	cv_last_error = 0;
+	if(mode == LOAD_MODE_CV && state.voltage_setpoint == 0)
+		// No target yet; hold whatever the terminals are at now. The sequencer
+		// and trigger switch modes from interrupts, which could preempt the ADC
+		// task mid-publish and spin forever on get_voltage()'s seqlock.
+		set_voltage_target(get_voltage_fast());
+	if(mode == LOAD_MODE_CR && state.resistance_setpoint == 0)
+		set_resistance_target(CR_DEFAULT_RESISTANCE);
+	if(state.load_mode == LOAD_MODE_PULSE)
+		stop_pulse();
+	state.load_mode = mode;
+	if(mode == LOAD_MODE_PULSE)
+		start_pulse();
+}
+
+load_mode get_load_mode() {
+	return state.load_mode;
+}
+
+void set_voltage_target(int target) {
+	if(target < 0)
+		target = 0;
+	state.voltage_setpoint = target;
+	// Convert to ADC counts once here so the loop works in counts
+	cv_target_raw = voltage_to_raw(target);
+}
+
+int get_voltage_target() {
+	return state.voltage_setpoint;
+}
+
+// Target is in milliohms
+void set_resistance_target(int target) {
+	if(target < CR_MIN_RESISTANCE)
+		target = CR_MIN_RESISTANCE;
+	state.resistance_setpoint = target;
+	// I = V / R, so fold the voltage gain and 1/R into a single multiplier
+	cr_scale = (((uint64)settings->adc_voltage_gain * 1000) << 16) / target;
+}
+
+int get_resistance_target() {
+	return state.resistance_setpoint;
+}
+
+// Target is in milliwatts
+void set_power_target(int target) {
+	if(target < 0)
+		target = 0;
+	state.power_setpoint = target;
+	// I = P / V; the loop supplies 1/V from reciprocal_q30()
+	cp_scale = ((uint64)target * 1000000000) / ((uint32)settings->adc_voltage_gain << 6);
+}
+
+int get_power_target() {
+	return state.power_setpoint;
+}
+
+// Incremental PI: sinking more current pulls the terminal voltage down, so a
+// reading above the target raises the current setpoint.
+RAMFUNC static void regulate_cv() {
+	int16 error = get_raw_voltage_fast() - cv_target_raw;
+	int current = state.current_setpoint
+		+ settings->cv_kp * (error - cv_last_error)
+		+ settings->cv_ki * error;
+	cv_last_error = error;
+	set_current(clamp_current(current));
+}
+
+RAMFUNC static void regulate_cr() {
+	int counts = get_raw_voltage_fast() - settings->adc_voltage_offset;
+	if(counts <= 0) {
+		set_current(0);
+		return;
+	}
+
+	uint64 current = ((uint64)counts * cr_scale) >> 16;
+	set_current((current > CURRENT_FULLRANGE_MAX)?CURRENT_FULLRANGE_MAX:(int)current);
+}
+
+RAMFUNC static void regulate_cp() {
+	int counts = get_raw_voltage_fast() - settings->adc_voltage_offset;
+	if(counts <= 0) {
+		// Nothing to draw power from
+		set_current(0);
+		return;
+	}
+
+	uint64 current = ((uint64)cp_scale * reciprocal_q30(counts)) >> 24;
+	set_current((current > CURRENT_FULLRANGE_MAX)?CURRENT_FULLRANGE_MAX:(int)current);
+}
+
+// Sets the target for a mode in its own units (microamps, microvolts, milliohms
+// or milliwatts) and then switches to it.
+void set_load_target(load_mode mode, int target) {
+	switch(mode) {
+	case LOAD_MODE_CV:
+		set_voltage_target(target);
+		break;
+	case LOAD_MODE_CR:
+		set_resistance_target(target);
+		break;
+	case LOAD_MODE_CP:
+		set_power_target(target);
+		break;
+	default:
+		break;
+	}
+	set_load_mode(mode);
+	if(mode == LOAD_MODE_CC)
+		set_current(target);
+}
+
+// The analog loop regulates to the IDACs' current, so whatever error is left
+// in their calibration is an error at the terminals. With a trim shift set,
+// the ADC task compares each block's measured current with the C/C setpoint
+// and integrates the difference into an offset that write_output() adds to
+// every setpoint, nulling it over a time constant of 2^shift blocks. It only
+// runs when nothing else is moving the setpoint anyway: in C/C mode with the
+// output on, not slewing, within the current limit, and TRIM_SETTLE_BLOCKS
+// after a change. The offset is kept meanwhile, as most of the error is the
+// same near any setpoint. An error beyond a fraction of the setpoint is a
+// supply that can't deliver it rather than a trim, so it's left alone.
+int set_trim_shift(int shift) {
+	if(shift < -1 || shift > TRIM_MAX_SHIFT)
+		return 0;
+	uint8 int_state = CyEnterCriticalSection();
+	trim_shift = shift;
+	trim_sum = 0;
+	trim_settling = TRIM_SETTLE_BLOCKS;
+	CyExitCriticalSection(int_state);
+	return 1;
+}
+
+int get_trim_shift() {
+	return trim_shift;
+}
+
+// Microamps
+RAMFUNC int get_current_trim() {
+	return (trim_shift < 0)?0:trim_sum >> trim_shift;
+}
+
+// Called by the ADC task with each block's means
+void trim_block(const int16 *mean) {
+	if(trim_shift < 0)
+		return;
+	int setpoint = state.current_setpoint;
+	if(setpoint != trim_setpoint) {
+		trim_setpoint = setpoint;
+		trim_settling = TRIM_SETTLE_BLOCKS;
+	}
+	if(state.load_mode != LOAD_MODE_CC || get_output_mode() != OUTPUT_MODE_FEEDBACK || setpoint <= 0
+	   || setpoint > get_current_limit() || get_slewing()) {
+		trim_settling = TRIM_SETTLE_BLOCKS;
+		return;
+	}
+	if(trim_settling > 0) {
+		trim_settling--;
+		return;
+	}
+
+	int error = setpoint - current_from_raw(mean[FILTER_CURRENT]);
+	if(abs(error) > (setpoint >> TRIM_MAX_ERROR_SHIFT))
+		return;
+	int old_trim = get_current_trim();
+	int32 sum = trim_sum + error;
+	int32 limit = (int32)TRIM_LIMIT << trim_shift;
+	trim_sum = (sum > limit)?limit:(sum < -limit)?-limit:sum;
+	if(get_current_trim() != old_trim)
+		slew_to(setpoint);
+}
+
+// Set while 'config commit' runs a batch of commands, so the feedback loops
+// don't regulate to a half applied configuration. The first update after it
+// clears works from all of it.
+static volatile uint8 control_held = 0;
+
+void set_control_hold(uint8 hold) {
+	control_held = hold;
+}
+
+// Setpoint mailbox for fast set frames, which the UART ISR posts to without
+// waiting on the comms task. The next update applies it whatever the mode, so
+// a set waits at most a block, and a later post replaces one not yet applied;
+// the comms task acknowledges the last applied, with when it went out.
+static volatile int32 posted_setpoint;
+static volatile uint8 setpoint_posted = 0;
+static int32 applied_setpoint;
+static uint32 applied_time;
+static uint8 setpoint_applied = 0;
+
+void control_post_setpoint(int32 setpoint) {
+	uint8 int_state = CyEnterCriticalSection();
+	posted_setpoint = setpoint;
+	setpoint_posted = 1;
+	CyExitCriticalSection(int_state);
+}
+
+// Returns 1 with the setpoint last applied and its get_time_us(), once
+int control_take_applied(int32 *setpoint, uint32 *when) {
+	uint8 int_state = CyEnterCriticalSection();
+	int taken = setpoint_applied;
+	*setpoint = applied_setpoint;
+	*when = applied_time;
+	setpoint_applied = 0;
+	CyExitCriticalSection(int_state);
+	return taken;
+}
+
+RAMFUNC static void apply_posted_setpoint() {
+	setpoint_posted = 0;
+	set_current(posted_setpoint);
+	applied_setpoint = state.current_setpoint;
+	applied_time = get_time_us();
+	setpoint_applied = 1;
+	defer_post(DEFER_SETPOINT_ACK);
+}
+
+RAMFUNC void control_update() {
+	if(control_held)
+		return;
+	if(setpoint_posted)
+		apply_posted_setpoint();
+	if(get_output_mode() != OUTPUT_MODE_FEEDBACK)
+		return;
+
+	switch(state.load_mode) {
+	case LOAD_MODE_CV:
+		regulate_cv();
+		break;
+	case LOAD_MODE_CR:
+		regulate_cr();
+		break;
+	case LOAD_MODE_CP:
+		regulate_cp();
+		break;
+	default:
+		break;
+	}
+}
+
+/* [] END OF FILE */
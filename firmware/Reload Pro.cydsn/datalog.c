@@ -0,0 +1,213 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <string.h>
+#include <stddef.h>
+#include "tasks.h"
+#include "config.h"
+
+// Long running logger. The ADC task takes a sample every log_interval ticks,
+// as the scheduler's datalog job falls due, and queues it for the comms task, which encodes samples into a row in RAM
+// and writes each full row to flash as one operation. The CPU stalls while a
+// row is written, as it does for a settings save, so that happens at most once
+// a row's worth of samples. Old rows are overwritten once the area is full.
+// Only in builds with USE_DATALOG defined, which otherwise leave its flash
+// area free.
+
+#ifdef USE_DATALOG
+
+xQueueHandle datalog_queue;
+
+// In flash with the other constants, like the saved settings. Volatile because the
+// compiler can't know the rows change under it.
+static const volatile datalog_row log_area[DATALOG_ROWS] CY_SECTION(".rodata.datalog") CY_ALIGN(CY_FLASH_SIZEOF_ROW);
+
+static datalog_row row_buffer;
+static uint8 next_row = 0;
+static uint32 last_sequence = 0;
+static uint32 next_timestamp;	// Where the next sample in row_buffer would fall
+static uint16 last_current, last_voltage;
+
+static volatile portTickType log_interval = 0; // 0 when not logging
+static portTickType log_start;
+
+static uint16 row_crc(const datalog_row *row) {
+	uint16 crc = crc16_update(0xFFFF, (const uint8*)&row->sequence, sizeof(row->sequence) + sizeof(row->count));
+	return crc16_update(crc, &row->format, sizeof(datalog_row) - offsetof(datalog_row, format));
+}
+
+static int row_valid(const datalog_row *row) {
+	return row->sequence != 0 && row->format == DATALOG_FORMAT && row->used <= DATALOG_ROW_DATA && row->crc == row_crc(row);
+}
+
+// Carries on after the newest row written before the last reset
+void datalog_init() {
+	datalog_queue = xQueueCreate(DATALOG_QUEUE_LENGTH, sizeof(datalog_record));
+
+	for(int i = 0; i < DATALOG_ROWS; i++) {
+		const datalog_row *row = (const datalog_row*)&log_area[i];
+		if(row_valid(row) && row->sequence > last_sequence) {
+			last_sequence = row->sequence;
+			next_row = (i + 1) % DATALOG_ROWS;
+		}
+	}
+}
+
+static void flush_row() {
+	if(row_buffer.count == 0)
+		return;
+
+	row_buffer.sequence = ++last_sequence;
+	row_buffer.crc = row_crc(&row_buffer);
+	CySysFlashWriteRow(((uint32)&log_area[next_row] - CYDEV_FLASH_BASE) / CY_FLASH_SIZEOF_ROW, (const uint8*)&row_buffer);
+	next_row = (next_row + 1) % DATALOG_ROWS;
+	memset(&row_buffer, 0, sizeof(row_buffer));
+}
+
+// Starts a new run, sampling every interval milliseconds
+void datalog_start(uint32 interval) {
+	datalog_stop();
+	if(interval < DATALOG_MIN_INTERVAL)
+		interval = DATALOG_MIN_INTERVAL;
+	if(interval > DATALOG_MAX_INTERVAL)
+		interval = DATALOG_MAX_INTERVAL;
+	log_interval = interval / portTICK_RATE_MS;
+	// Timestamps count from the first sample, at the job's first slot
+	log_start = schedule_set(SCHEDULE_DATALOG, log_interval);
+}
+
+// Stops logging, writing out any partly filled row
+void datalog_stop() {
+	log_interval = 0;
+	schedule_set(SCHEDULE_DATALOG, 0);
+	datalog_write_pending();
+	flush_row();
+}
+
+uint32 get_datalog_interval() {
+	return log_interval * portTICK_RATE_MS;
+}
+
+static uint16 to_milli(int value) {
+	if(value < 0)
+		return 0;
+	value = div1000(value);
+	return (value > 0xFFFF)?0xFFFF:value;
+}
+
+// Called by the ADC task after each block
+void datalog_block() {
+	// Stamped with when it was due, so the times stay on the row's grid
+	portTickType due;
+	if(!schedule_take(SCHEDULE_DATALOG, &due))
+		return;
+
+	measurement m;
+	get_measurement(&m);
+	datalog_record record = {
+		.timestamp = (due - log_start) * portTICK_RATE_MS,
+		.current = to_milli(m.current),
+		.voltage = to_milli(m.voltage),
+	};
+
+	// If the comms task is behind, the sample is lost; the next starts a row
+	// of its own, so the gap shows in the timestamps. The comms task writes
+	// every record queued when it's told, so one latched event covers them all.
+	if(xQueueSendToBack(datalog_queue, &record, 0) == pdPASS)
+		defer_post(DEFER_DATALOG);
+}
+
+static uint8 put_varint(uint8 *out, uint32 value) {
+	uint8 len = 0;
+	while(value >= 0x80) {
+		out[len++] = value | 0x80;
+		value >>= 7;
+	}
+	out[len++] = value;
+	return len;
+}
+
+static uint32 zigzag(int32 value) {
+	return ((uint32)value << 1) ^ (uint32)(value >> 31);
+}
+
+static void append_record(const datalog_record *record) {
+	// A uint16 or a difference of two takes at most 3 bytes
+	uint8 encoded[6];
+	uint8 len = 0;
+
+	if(row_buffer.count > 0 && record->timestamp == next_timestamp) {
+		len = put_varint(encoded, zigzag((int32)record->current - last_current));
+		len += put_varint(encoded + len, zigzag((int32)record->voltage - last_voltage));
+	}
+	if(row_buffer.count == 0 || record->timestamp != next_timestamp || row_buffer.used + len > DATALOG_ROW_DATA) {
+		// Start a row, with the sample in full as its keyframe
+		flush_row();
+		row_buffer.format = DATALOG_FORMAT;
+		row_buffer.interval = get_datalog_interval();
+		row_buffer.timestamp = record->timestamp;
+		len = put_varint(encoded, record->current);
+		len += put_varint(encoded + len, record->voltage);
+	}
+
+	memcpy(&row_buffer.data[row_buffer.used], encoded, len);
+	row_buffer.used += len;
+	row_buffer.count++;
+	last_current = record->current;
+	last_voltage = record->voltage;
+	next_timestamp = record->timestamp + row_buffer.interval;
+}
+
+// Called by the comms task to move queued samples into flash
+void datalog_write_pending() {
+	datalog_record record;
+	while(xQueueReceive(datalog_queue, &record, 0))
+		append_record(&record);
+}
+
+// Returns the age'th oldest row in flash, or NULL if that row holds no data
+const uint8 *get_datalog_row(int age) {
+	const datalog_row *row = (const datalog_row*)&log_area[(next_row + age) % DATALOG_ROWS];
+	return row_valid(row)?(const uint8*)row:NULL;
+}
+
+#else
+
+void datalog_init() {
+}
+
+void datalog_start(uint32 interval) {
+}
+
+void datalog_stop() {
+}
+
+uint32 get_datalog_interval() {
+	return 0;
+}
+
+void datalog_block() {
+}
+
+void datalog_write_pending() {
+}
+
+const uint8 *get_datalog_row(int age) {
+	return NULL;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,116 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include "tasks.h"
+#include "config.h"
+
+// Deferred work. An ISR does only what can't wait, such as turning the gate
+// off, and latches the rest with defer_post(). The ADC task, the highest
+// priority one, runs whatever is latched as it takes each block, so within a
+// block of the ISR. Posting is a masked OR: it can't block or be lost, and
+// costs the ISR the same few cycles whatever the work. A handler that can't
+// finish, such as a comms event the full queue wouldn't take, returns 0 to
+// stay latched, and runs again with the next block.
+//
+// Tasks post here too, for any comms event the comms task must not miss.
+// Only line and notification events go straight to the queue: every wakeup
+// reads all the lines and notifications waiting, so a dropped one is picked
+// up by whatever event did get through.
+
+typedef int (*defer_handler)();
+
+static int post_comms(comms_event_type type) {
+	return xQueueSendToBack(comms_queue, &((comms_event){.type=type}), 0) == pdPASS;
+}
+
+static int capture_done() {
+	return post_comms(COMMS_EVENT_CAPTURE_DONE);
+}
+
+static int sequence_logged() {
+	return post_comms(COMMS_EVENT_SEQUENCE_LOG);
+}
+
+static int setpoint_applied() {
+	return post_comms(COMMS_EVENT_SETPOINT_ACK);
+}
+
+static int datalog_queued() {
+	return post_comms(COMMS_EVENT_DATALOG);
+}
+
+static int sweep_done() {
+	return post_comms(COMMS_EVENT_SWEEP_DONE);
+}
+
+static int impedance_done() {
+	return post_comms(COMMS_EVENT_IMPEDANCE_DONE);
+}
+
+static int ocp_done() {
+	return post_comms(COMMS_EVENT_OCP_DONE);
+}
+
+static int loadreg_done() {
+	return post_comms(COMMS_EVENT_LOADREG_DONE);
+}
+
+static int stream_queued() {
+	return post_comms(COMMS_EVENT_STREAM_DATA);
+}
+
+static int monitor_due() {
+	return post_comms(COMMS_EVENT_MONITOR_DATA);
+}
+
+// In bit order, which is the order they run in
+static const defer_handler handlers[DEFER_COUNT] = {
+	[DEFER_FAULT] = handle_fault,
+	[DEFER_CAPTURE_DONE] = capture_done,
+	[DEFER_SEQUENCE_LOG] = sequence_logged,
+	[DEFER_SETPOINT_ACK] = setpoint_applied,
+	[DEFER_DATALOG] = datalog_queued,
+	[DEFER_SWEEP_DONE] = sweep_done,
+	[DEFER_IMPEDANCE_DONE] = impedance_done,
+	[DEFER_OCP_DONE] = ocp_done,
+	[DEFER_LOADREG_DONE] = loadreg_done,
+	[DEFER_STREAM_DATA] = stream_queued,
+	[DEFER_MONITOR_DATA] = monitor_due,
+};
+
+static volatile uint16 pending;
+_Static_assert(DEFER_COUNT <= 16, "defer work must fit the pending mask");
+
+// Callable from any ISR or task
+RAMFUNC void defer_post(defer_work work) {
+	uint8 int_state = CyEnterCriticalSection();
+	pending |= 1u << work;
+	CyExitCriticalSection(int_state);
+}
+
+// Called by the ADC task as it takes each block, before the block's own work
+void defer_run() {
+	uint8 int_state = CyEnterCriticalSection();
+	uint16 work = pending;
+	pending = 0;
+	CyExitCriticalSection(int_state);
+
+	for(int i = 0; work != 0; i++, work >>= 1) {
+		if((work & 1) && !handlers[i]())
+			defer_post(i);
+	}
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,131 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <string.h>
+#include "config.h"
+
+// Fault history. Whatever trips the output captures the cause and the
+// readings at that moment with fault_capture, from ISR or task context. The
+// ADC task takes the capture when it finishes the shutdown, and the UI task
+// appends it to the last FAULT_LOG_LENGTH faults in a flash row, as it saves
+// the settings. Until the capture is taken, later trips keep the first cause.
+
+typedef struct {
+	uint16 count;		// Faults logged since the log was cleared; 0 if never written
+	uint16 crc;			// Over count and records
+	fault_record records[FAULT_LOG_LENGTH];	// Record n is at n % FAULT_LOG_LENGTH
+	uint8 padding[CY_FLASH_SIZEOF_ROW - 4 - FAULT_LOG_LENGTH * sizeof(fault_record)];
+} fault_row;
+
+static const volatile fault_row fault_area CY_SECTION(".rodata.faults") CY_ALIGN(CY_FLASH_SIZEOF_ROW);
+
+static fault_record latest;
+static volatile uint8 captured;	// latest holds a trip the ADC task hasn't taken
+static volatile uint8 unsaved;	// latest has been taken but isn't in flash yet
+
+static const char *const names[FAULT_COUNT] = {
+	[FAULT_NONE] = "none",
+	[FAULT_FET_MISMATCH] = "fet",
+	[FAULT_GATE_LIMIT] = "gate",
+	[FAULT_OVERTEMP] = "overtemp",
+	[FAULT_SOA] = "soa",
+	[FAULT_OVERVOLTAGE] = "overvoltage",
+	[FAULT_UNDERVOLTAGE] = "undervoltage",
+	[FAULT_REVERSE] = "reverse",
+};
+
+static uint16 row_crc(const fault_row *row) {
+	uint16 crc = crc16_update(0xFFFF, (const uint8*)&row->count, sizeof(row->count));
+	return crc16_update(crc, (const uint8*)row->records, sizeof(row->records));
+}
+
+static const fault_row *valid_row() {
+	const fault_row *row = (const fault_row*)&fault_area;
+	return (row->count != 0 && row->crc == row_crc(row))?row:NULL;
+}
+
+// Records what tripped the output. Safe from ISRs; cheap enough for the trip path.
+void fault_capture(fault_code code, int16 raw_current, int16 raw_voltage, int16 raw_opamp, int16 raw_fet) {
+	uint8 int_state = CyEnterCriticalSection();
+	if(!captured && !unsaved) {
+		latest.uptime = xTaskGetTickCountFromISR() * portTICK_RATE_MS;
+		latest.code = code;
+		latest.temperature = get_temperature();
+		latest.raw_current = raw_current;
+		latest.raw_voltage = raw_voltage;
+		latest.raw_opamp = raw_opamp;
+		latest.raw_fet = raw_fet;
+		captured = 1;
+	}
+	CyExitCriticalSection(int_state);
+}
+
+// Called by the ADC task as it handles a trip. Returns the cause.
+fault_code fault_take() {
+	if(!captured)
+		return FAULT_NONE;
+	const fault_row *row = valid_row();
+	latest.number = ((row != NULL)?row->count:0) + 1;
+	unsaved = 1;
+	captured = 0;
+	return latest.code;
+}
+
+// The most recent fault, saved or not, or NULL if there's never been one
+const fault_record *get_last_fault() {
+	if(unsaved)
+		return &latest;
+	return get_fault(0);
+}
+
+// The age'th most recent fault in flash, or NULL past the oldest
+const fault_record *get_fault(int age) {
+	const fault_row *row = valid_row();
+	if(row == NULL || age >= row->count || age >= FAULT_LOG_LENGTH)
+		return NULL;
+	return &row->records[(row->count - 1 - age) % FAULT_LOG_LENGTH];
+}
+
+const char *fault_name(fault_code code) {
+	return (code < FAULT_COUNT)?names[code]:"unknown";
+}
+
+// Called regularly by the UI task. The CPU stalls for the row write, as for
+// a settings save, but the output is already off.
+void fault_save_pending() {
+	if(!unsaved)
+		return;
+
+	fault_row row;
+	const fault_row *old = valid_row();
+	if(old != NULL) {
+		memcpy(&row, old, sizeof(row));
+	} else {
+		memset(&row, 0, sizeof(row));
+	}
+	row.records[row.count % FAULT_LOG_LENGTH] = latest;
+	row.count++;
+	row.crc = row_crc(&row);
+	CySysFlashWriteRow(((uint32)&fault_area - CYDEV_FLASH_BASE) / CY_FLASH_SIZEOF_ROW, (const uint8*)&row);
+	unsaved = 0;
+}
+
+void fault_log_clear() {
+	fault_row row;
+	memset(&row, 0, sizeof(row));
+	CySysFlashWriteRow(((uint32)&fault_area - CYDEV_FLASH_BASE) / CY_FLASH_SIZEOF_ROW, (const uint8*)&row);
+}
+
+/* [] END OF FILE */
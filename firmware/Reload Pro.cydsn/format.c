@@ -0,0 +1,256 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <stdarg.h>
+#include <string.h>
+#include "project.h"
+#include "config.h"
+
+// A small replacement for sprintf, shared by the UI and the serial protocol.
+// The M0 has no divide instruction, so digits are found by subtracting powers
+// of ten rather than by dividing by 10 once per digit.
+
+static const uint32 powers_of_ten[] = {
+	1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10
+};
+
+// Writes value in decimal, zero padded to at least width digits, and returns
+// a pointer to the terminating NUL so calls can be chained.
+char *format_uint(char *out, uint32 value, uint8 width) {
+	uint8 started = 0;
+	for(uint8 i = 0; i < sizeof(powers_of_ten) / sizeof(powers_of_ten[0]); i++) {
+		char digit = '0';
+		while(value >= powers_of_ten[i]) {
+			value -= powers_of_ten[i];
+			digit++;
+		}
+		if(started || digit != '0' || width >= 10 - i) {
+			*out++ = digit;
+			started = 1;
+		}
+	}
+	*out++ = '0' + value;
+	*out = '\0';
+	return out;
+}
+
+// As format_uint, in lower case hex
+char *format_hex(char *out, uint32 value, uint8 width) {
+	int shift = 28;
+	while(shift > 0 && shift >= width * 4 && (value >> shift) == 0)
+		shift -= 4;
+	for(; shift >= 0; shift -= 4)
+		*out++ = "0123456789abcdef"[(value >> shift) & 0xF];
+	*out = '\0';
+	return out;
+}
+
+char *format_int(char *out, int value, uint8 width) {
+	if(value < 0) {
+		// As with printf, the sign counts towards the width
+		*out++ = '-';
+		return format_uint(out, -(uint32)value, (width > 0)?width - 1:0);
+	}
+	return format_uint(out, value, width);
+}
+
+// Formats like sprintf, but only understands %d, %u, %x, %s and %c, with an
+// optional zero padded width for numbers (%03d) or a maximum length for
+// strings (%.7s). Returns a pointer to the terminating NUL.
+char *format(char *out, const char *fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+
+	for(; *fmt != '\0'; fmt++) {
+		if(*fmt != '%') {
+			*out++ = *fmt;
+			continue;
+		}
+
+		uint8 width = 0, precision = 0xFF;
+		fmt++;
+		if(*fmt == '.') {
+			precision = 0;
+			for(fmt++; *fmt >= '0' && *fmt <= '9'; fmt++)
+				precision = precision * 10 + (*fmt - '0');
+		} else {
+			for(; *fmt >= '0' && *fmt <= '9'; fmt++)
+				width = width * 10 + (*fmt - '0');
+		}
+
+		switch(*fmt) {
+		case 'd':
+			out = format_int(out, va_arg(args, int), width);
+			break;
+		case 'u':
+			out = format_uint(out, va_arg(args, uint32), width);
+			break;
+		case 'x':
+			out = format_hex(out, va_arg(args, uint32), width);
+			break;
+		case 's':
+			for(const char *s = va_arg(args, const char *); *s != '\0' && precision > 0; s++, precision--)
+				*out++ = *s;
+			break;
+		case 'c':
+			*out++ = va_arg(args, int);
+			break;
+		default:
+			*out++ = *fmt;
+			break;
+		}
+	}
+	*out = '\0';
+
+	va_end(args);
+	return out;
+}
+
+// Formats a value in micro-units as 4 significant characters and a unit, picking
+// the prefix to suit: "1.23mA", "12.3V ", "123W ".
+void format_number(int num, const char suffix, char *out) {
+	if(num < 0)
+		num = 0;
+
+	int magnitude = 1;
+	while(num >= 1000000) {
+		num = div1000(num);
+		magnitude++;
+	}
+
+	int whole = div1000(num), remainder = num - whole * 1000;
+	if(whole < 10) {
+		// Format: x.xx
+		out = format(out, "%1d.%02d", whole, (int)div1000(remainder * 100));
+	} else if(whole < 100) {
+		// Format: xx.x
+		out = format(out, "%02d.%1d", whole, (int)div1000(remainder * 10));
+	} else {
+		// Format: xxx
+		out = format_int(out, whole, 3);
+	}
+
+	if(magnitude == 1) {
+		format(out, "m%c", suffix);
+	} else {
+		format(out, "%c ", suffix);
+	}
+}
+
+// What each quantity parse_quantity() knows is given in: its symbol, the
+// power of ten of the unit it's held in, and of the unit a bare number is
+// taken to be in, the serial protocol's units from before prefixes
+static const struct {
+	char quantity;
+	const char *symbol;
+	int8 held;
+	int8 bare;
+} quantities[] = {
+	{'A', "A", -6, -3},	// Microamps, bare milliamps
+	{'V', "V", -6, -3},	// Microvolts, bare millivolts
+	{'W', "W", -3, -3},	// Milliwatts
+	{'R', "R", -3, 0},	// Milliohms, bare ohms
+	// The same with bare numbers in whole units, as SCPI takes them
+	{'a', "A", -6, 0},
+	{'v', "V", -6, 0},
+	{'w', "W", -3, 0},
+	{'r', "R", -3, 0},
+};
+
+// Parses a decimal such as "1.5A", "500m" or "12V" in one pass, with no
+// floating point, into the units quantity ('A', 'V', 'W' or 'R', or in lower
+// case for bare whole units) is held in; "R" and "ohm" are both taken for
+// ohms. Quantity 0 is a plain integer with no prefix or symbol. Returns 0 for a NULL or malformed text, a value that
+// overflows, or digits finer than the unit it's held in.
+int parse_quantity(const char *text, char quantity, int32 *value) {
+	const char *symbol = NULL;
+	int held = 0, scale = 0;
+	for(int i = 0; i < sizeof(quantities) / sizeof(quantities[0]); i++) {
+		if(quantities[i].quantity == quantity) {
+			symbol = quantities[i].symbol;
+			held = quantities[i].held;
+			scale = quantities[i].bare;
+		}
+	}
+	if(text == NULL)
+		return 0;
+
+	int negative = (*text == '-');
+	if(negative || *text == '+')
+		text++;
+
+	uint32 mantissa = 0;
+	int exponent = 0, digits = 0, zeros = 0, point = 0;
+	for(;; text++) {
+		if(*text == '.' && !point) {
+			point = 1;
+			continue;
+		}
+		if(*text < '0' || *text > '9')
+			break;
+		digits++;
+		if(point && *text == '0') {
+			// Only counted once a digit follows, so trailing zeros never
+			// make a value too fine to hold
+			zeros++;
+			continue;
+		}
+		for(zeros++; zeros > 0; zeros--) {
+			if(mantissa > 214748364)
+				return 0;
+			mantissa *= 10;
+			if(point)
+				exponent--;
+		}
+		mantissa += *text - '0';
+	}
+	if(digits == 0)
+		return 0;
+
+	if(symbol != NULL) {
+		int prefixed = 1;
+		switch(*text) {
+		case 'u':
+			scale = -6;
+			break;
+		case 'm':
+			scale = -3;
+			break;
+		case 'k':
+			scale = 3;
+			break;
+		default:
+			prefixed = 0;
+			break;
+		}
+		text += prefixed;
+		if(strcmp(text, symbol) == 0 || (symbol[0] == 'R' && strcmp(text, "ohm") == 0)) {
+			if(!prefixed)
+				scale = 0;
+			text += strlen(text);
+		}
+	}
+	if(*text != 0)
+		return 0;
+
+	for(exponent += scale - held; exponent > 0; exponent--) {
+		if(mantissa > 214748364)
+			return 0;
+		mantissa *= 10;
+	}
+	if(exponent < 0 || mantissa > INT32_MAX)
+		return 0;
+	*value = negative?-(int32)mantissa:(int32)mantissa;
+	return 1;
+}
+
+/* [] END OF FILE */
@@ -115,6 +115,16 @@ extern void vPortYield( void );
 #define portYIELD_FROM_ISR( x ) portEND_SWITCHING_ISR( x )
 /*-----------------------------------------------------------*/
 
+/* Tickless idle/low power functionality. */
+#ifndef portSUPPRESS_TICKS_AND_SLEEP
+	extern void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+
+/* For a core clock changed at run time; call with interrupts disabled. */
+extern void vPortSetTickClock( unsigned long ulOldClockHz, unsigned long ulNewClockHz );
+/*-----------------------------------------------------------*/
+
 
 /* Critical section management. */
 extern void vPortEnterCritical( void );
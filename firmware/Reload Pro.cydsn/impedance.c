@@ -0,0 +1,304 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include "tasks.h"
+#include "config.h"
+
+// Output impedance against frequency. At each point the waveform generator
+// plays a small sine about a DC current, and the ADC task correlates every
+// raw current and voltage scan with a sine and cosine at that frequency: a
+// single bin DFT, like the ripple analyser's Goertzel filters but with no
+// resonator to outgrow 32 bits at low frequencies, and keeping the phase.
+// The ratio of the voltage's phasor to the current's is the DUT's output
+// impedance, its sign flipped since the voltage falls as the load draws
+// more. Each point settles for IMPEDANCE_SETTLE_CYCLES and then takes whole
+// cycles, about IMPEDANCE_WINDOW_SCANS scans' worth, so only the table of
+// results ever goes over the serial link, from the shared scratch buffer.
+// Frequencies are spaced evenly on a log scale, and the scan rate is the
+// ripple analyser's measurement.
+//
+// Only in builds with USE_IMPEDANCE defined, which needs USE_AWG and
+// USE_RIPPLE too.
+
+#ifdef USE_IMPEDANCE
+
+// A quarter cycle of sine in Q14, so 256 steps a cycle
+static const int16 quarter_sine[65] = {
+	0, 402, 804, 1205, 1606, 2006, 2404, 2801, 3196, 3590,
+	3981, 4370, 4756, 5139, 5520, 5897, 6270, 6639, 7005, 7366,
+	7723, 8076, 8423, 8765, 9102, 9434, 9760, 10080, 10394, 10702,
+	11003, 11297, 11585, 11866, 12140, 12406, 12665, 12916, 13160, 13395,
+	13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978, 15137, 15286,
+	15426, 15557, 15679, 15791, 15893, 15986, 16069, 16143, 16207, 16261,
+	16305, 16340, 16364, 16379, 16384,
+};
+
+// atan(2^-i) in hundredths of a degree, for CORDIC
+static const int16 atan_table[] = {4500, 2657, 1404, 713, 358, 179, 90, 45, 22, 11, 6, 3, 1, 1};
+
+static uint8 point_count = 0;	// Points measured
+static uint8 points_wanted;
+static volatile int8 impedance_index = -1;	// Point being measured, -1 when idle
+static int dc, amplitude;
+static uint32 scan_rate;
+static uint32 phase, phase_step;	// A whole cycle is 2^32
+static uint32 settle_left, measure_left, window;	// Scans
+static int64 voltage_sin, voltage_cos, current_sin, current_cos;
+static int16 voltage_reference, current_reference;
+
+static int sine_of(uint8 index) {
+	uint8 step = index & 63;
+	int value = (index & 64)?quarter_sine[64 - step]:quarter_sine[step];
+	return (index & 128)?-value:value;
+}
+
+static void start_point() {
+	uint16 hz = scratch.impedance[impedance_index].hz;
+	int samples = AWG_MAX_RATE / hz;
+	if(samples > AWG_MAX_SAMPLES)
+		samples = AWG_MAX_SAMPLES;
+	awg_fill(AWG_SHAPE_SINE, samples);
+	awg_config_t config = {.offset = dc, .amplitude = amplitude, .rate = hz * samples, .loops = 0};
+	set_awg_config(&config);
+	set_load_mode(LOAD_MODE_PULSE);
+
+	uint32 cycles = (IMPEDANCE_WINDOW_SCANS * hz + scan_rate / 2) / scan_rate;
+	if(cycles == 0)
+		cycles = 1;
+	window = ((uint64)cycles * scan_rate + hz / 2) / hz;
+	measure_left = window;
+	settle_left = (IMPEDANCE_SETTLE_CYCLES * scan_rate) / hz + ADC_BLOCK_SCANS;
+	phase_step = ((uint64)hz << 32) / scan_rate;
+	phase = 0;
+	voltage_sin = voltage_cos = current_sin = current_cos = 0;
+}
+
+// from to to Hz over count points, about dc with a sine of amplitude, all in
+// microamps
+int impedance_start(int new_dc, int new_amplitude, int from, int to, int count) {
+	scan_rate = get_ripple_scan_rate();
+	if(scan_rate == 0 || count < 1 || count > IMPEDANCE_MAX_POINTS || from < 1 || to < from || (count > 1 && to == from))
+		return 0;
+	// The DFT wants a few scans a cycle, and the generator a few samples
+	if(to > scan_rate / 4 || to > AWG_MAX_RATE / IMPEDANCE_MIN_SAMPLES)
+		return 0;
+	if(new_amplitude <= 0 || new_dc < new_amplitude || new_dc + new_amplitude > CURRENT_FULLRANGE_MAX)
+		return 0;
+
+	impedance_stop();
+	scratch_claim(SCRATCH_IMPEDANCE);
+	point_count = 0;
+
+	// Each point is the last times the ratio, in Q16; the ratio's found by
+	// bisection, as count - 1 multiplies must take from to to
+	uint32 ratio = 1 << 16;
+	if(count > 1) {
+		uint32 low = 1 << 16, high = (uint32)(to / from + 1) << 16;
+		while(high - low > 1) {
+			uint32 middle = (low + high) / 2;
+			uint64 hz = (uint64)from << 16;
+			for(int i = 1; i < count && hz <= ((uint64)to << 16); i++)
+				hz = (hz * middle) >> 16;
+			if(hz > ((uint64)to << 16)) {
+				high = middle;
+			} else {
+				low = middle;
+			}
+		}
+		ratio = low;
+	}
+	uint64 hz = (uint64)from << 16;
+	for(int i = 0; i < count; i++) {
+		uint32 rounded = (hz + (1 << 15)) >> 16;
+		// Rounding can't be allowed to repeat a frequency
+		if(i > 0 && rounded <= scratch.impedance[i - 1].hz)
+			rounded = scratch.impedance[i - 1].hz + 1;
+		if(rounded > to)
+			return 0;
+		scratch.impedance[i].hz = rounded;
+		hz = (hz * ratio) >> 16;
+	}
+
+	sequence_stop();
+	battery_stop();
+	sweep_stop();
+	mppt_stop();
+	ir_stop();
+	ocp_stop();
+	dc = new_dc;
+	amplitude = new_amplitude;
+	points_wanted = count;
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	impedance_index = 0;
+	start_point();
+	return 1;
+}
+
+static void finish() {
+	impedance_index = -1;
+	if(get_load_mode() == LOAD_MODE_PULSE)
+		set_load_mode(LOAD_MODE_CC);
+	set_current(0);
+	defer_post(DEFER_IMPEDANCE_DONE);
+}
+
+// Abandons a sweep, keeping the points taken so far
+void impedance_stop() {
+	if(impedance_index < 0)
+		return;
+	impedance_index = -1;
+	if(get_load_mode() == LOAD_MODE_PULSE)
+		set_load_mode(LOAD_MODE_CC);
+	set_current(0);
+}
+
+// Shifts re and im down until both are within limit, returning the shift
+static int narrow(int64 *re, int64 *im, int64 limit) {
+	int shift = 0;
+	while(*re >= limit || *re <= -limit || *im >= limit || *im <= -limit) {
+		*re >>= 1;
+		*im >>= 1;
+		shift++;
+	}
+	return shift;
+}
+
+// The phasor's amplitude in Q8 counts. A sine of amplitude A correlates to
+// A N 2^14 / 2 over N scans with the Q14 table.
+static uint32 amplitude_q8(int64 re, int64 im) {
+	int shift = narrow(&re, &im, 1ll << 31);
+	uint64 magnitude = (uint64)isqrt((uint64)(re * re) + (uint64)(im * im)) << shift;
+	return magnitude / ((uint64)window * 32);
+}
+
+// atan2(y, x) in hundredths of a degree, -18000 to 18000, by CORDIC
+static int32 angle_of(int64 y, int64 x) {
+	narrow(&x, &y, 1 << 29);
+	int32 cx = x, cy = y, angle = 0;
+	if(cx < 0) {
+		cx = -cx;
+		cy = -cy;
+		angle = 18000;
+	}
+	for(int i = 0; i < sizeof(atan_table) / sizeof(atan_table[0]); i++) {
+		int32 dx = cy >> i, dy = cx >> i;
+		if(cy > 0) {
+			cx += dx;
+			cy -= dy;
+			angle += atan_table[i];
+		} else {
+			cx -= dx;
+			cy += dy;
+			angle -= atan_table[i];
+		}
+	}
+	return (angle > 18000)?angle - 36000:angle;
+}
+
+static void take_point() {
+	impedance_point *point = &scratch.impedance[point_count++];
+	// Phasors are cos - j sin; flipping the voltage's sign is half a turn
+	int voltage = voltage_span_from_raw(amplitude_q8(voltage_cos, voltage_sin));
+	int current = current_span_from_raw(amplitude_q8(current_cos, current_sin));
+	point->impedance = (current > 0)?((int64)voltage * 1000) / current:-1;
+	int32 angle = angle_of(-voltage_sin, voltage_cos) - angle_of(-current_sin, current_cos) + 18000;
+	while(angle > 18000)
+		angle -= 36000;
+	while(angle <= -18000)
+		angle += 36000;
+	point->phase = (angle >= 0)?(angle + 5) / 10:(angle - 5) / 10;
+}
+
+// Called by the ADC task with each block of raw scans
+void impedance_block(const int16 (*scans)[ADC_RING_CHANNELS]) {
+	if(impedance_index < 0)
+		return;
+	if(get_load_mode() != LOAD_MODE_PULSE) {
+		// Something else took over the load
+		impedance_stop();
+		return;
+	}
+
+	for(int j = 0; j < ADC_BLOCK_SCANS; j++) {
+		if(settle_left > 0) {
+			if(--settle_left == 0) {
+				voltage_reference = scans[j][ADC_CHAN_VOLTAGE_SENSE];
+				current_reference = scans[j][ADC_CHAN_CURRENT_SENSE];
+			}
+			continue;
+		}
+
+		uint8 index = phase >> 24;
+		int32 sine = sine_of(index), cosine = sine_of(index + 64);
+		int32 voltage = scans[j][ADC_CHAN_VOLTAGE_SENSE] - voltage_reference;
+		int32 current = scans[j][ADC_CHAN_CURRENT_SENSE] - current_reference;
+		voltage_sin += voltage * sine;
+		voltage_cos += voltage * cosine;
+		current_sin += current * sine;
+		current_cos += current * cosine;
+		phase += phase_step;
+
+		if(--measure_left == 0) {
+			take_point();
+			if(++impedance_index >= points_wanted) {
+				finish();
+			} else {
+				start_point();
+			}
+			return;
+		}
+	}
+}
+
+// The point being measured, or -1 when no sweep is running
+int get_impedance_index() {
+	return impedance_index;
+}
+
+int get_impedance_length() {
+	return scratch_owned(SCRATCH_IMPEDANCE)?point_count:0;
+}
+
+const impedance_point *get_impedance_point(int i) {
+	return &scratch.impedance[i];
+}
+
+#else
+
+int impedance_start(int new_dc, int new_amplitude, int from, int to, int count) {
+	return 0;
+}
+
+void impedance_stop() {
+}
+
+void impedance_block(const int16 (*scans)[ADC_RING_CHANNELS]) {
+}
+
+int get_impedance_index() {
+	return -1;
+}
+
+int get_impedance_length() {
+	return 0;
+}
+
+const impedance_point *get_impedance_point(int i) {
+	return NULL;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,150 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include "tasks.h"
+#include "config.h"
+
+// DC internal resistance by current pulses. The transient generator steps
+// between the low and high currents at its configured frequency and duty,
+// and the ADC task follows its edges through the block flags: the voltage is
+// the mean of the last whole block before a rising edge and of the block a
+// fixed number after it, so the timing is set by the hardware timer and the
+// ADC rather than by the serial link. The drops and steps over all the pulses
+// are summed before dividing. A pulse whose high phase ends before its
+// second reading is skipped, as is the whole test after too many of those.
+// Only in builds with USE_IR_TEST defined.
+
+#ifdef USE_IR_TEST
+
+static volatile ir_state test_state = IR_IDLE;
+static uint8 pulses, delay;
+static uint8 countdown;		// Blocks until the reading after an edge; 0 while waiting for one
+static uint8 last_flags;
+static int16 before[FILTER_CHANNELS];	// The last block's means
+static int32 drop_sum, step_sum;	// Counts, over the pulses so far
+static ir_result result;
+
+int ir_start(int low, int high, int new_pulses, int new_delay) {
+	if(low < 0 || high <= low || new_pulses < 1 || new_pulses > IR_MAX_PULSES || new_delay < 1 || new_delay > IR_MAX_DELAY)
+		return 0;
+
+	test_state = IR_IDLE;
+	sequence_stop();
+	battery_stop();
+	sweep_stop();
+	mppt_stop();
+	impedance_stop();
+	ocp_stop();
+	pulse_config_t config = *get_pulse_config();
+	config.low_current = low;
+	config.high_current = high;
+	if(!set_pulse_config(&config))
+		return 0;
+
+	pulses = new_pulses;
+	delay = new_delay;
+	countdown = 0;
+	last_flags = PULSE_FLAG_EDGE;	// So the first block can't count as before an edge
+	drop_sum = step_sum = 0;
+	result = (ir_result){0};
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	set_load_mode(LOAD_MODE_PULSE);
+	test_state = IR_RUNNING;
+	return 1;
+}
+
+static void finish(ir_state end) {
+	if(test_state != IR_RUNNING)
+		return;
+	if(end == IR_DONE) {
+		int drop = voltage_span_from_raw(((int64)drop_sum << 8) / result.pulses);
+		int step = current_span_from_raw(((int64)step_sum << 8) / result.pulses);
+		result.voltage_drop = drop;
+		result.current_step = step;
+		result.resistance = (step > 0)?((int64)drop * 1000000) / step:-1;
+	}
+	if(get_load_mode() == LOAD_MODE_PULSE)
+		set_load_mode(LOAD_MODE_CC);
+	test_state = end;
+}
+
+// Ends a running test early, for 'ir stop' and on a trip
+void ir_stop() {
+	finish(IR_STOPPED);
+}
+
+// Called by the ADC task with each block's means and pulse flags
+void ir_block(const int16 *mean, uint8 flags) {
+	if(test_state != IR_RUNNING)
+		return;
+	if(get_load_mode() != LOAD_MODE_PULSE) {
+		// Something else took over the load
+		finish(IR_STOPPED);
+		return;
+	}
+
+	if(countdown > 0) {
+		if(flags & PULSE_FLAG_EDGE) {
+			// The high phase is shorter than the delay
+			countdown = 0;
+			if(++result.missed >= IR_MAX_MISSED)
+				finish(IR_STOPPED);
+		} else if(--countdown == 0) {
+			drop_sum += before[FILTER_VOLTAGE] - mean[FILTER_VOLTAGE];
+			step_sum += mean[FILTER_CURRENT] - before[FILTER_CURRENT];
+			if(++result.pulses >= pulses)
+				finish(IR_DONE);
+		}
+	} else if((flags & PULSE_FLAG_EDGE) && (flags & PULSE_FLAG_HIGH) && last_flags == 0) {
+		// A rising edge, with a whole low block just before it in before
+		countdown = delay;
+	} else {
+		for(int chan = 0; chan < FILTER_CHANNELS; chan++)
+			before[chan] = mean[chan];
+	}
+	last_flags = flags;
+}
+
+ir_state get_ir_state() {
+	return test_state;
+}
+
+// Pulses and misses so far while running; the figures once done
+void get_ir_result(ir_result *r) {
+	*r = result;
+}
+
+#else
+
+int ir_start(int low, int high, int new_pulses, int new_delay) {
+	return 0;
+}
+
+void ir_stop() {
+}
+
+void ir_block(const int16 *mean, uint8 flags) {
+}
+
+ir_state get_ir_state() {
+	return IR_IDLE;
+}
+
+void get_ir_result(ir_result *r) {
+	*r = (ir_result){0};
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,209 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include "tasks.h"
+#include "config.h"
+
+// Power supply load regulation test: steps a C/C setpoint through evenly
+// spaced fractions of a full load, 0 to 100%, and records the supply's
+// voltage at each once it has settled. It runs in the ADC task, so a point
+// takes as long as the supply does to settle rather than a host's guess at
+// it. The block means are summed into windows of LOADREG_WINDOW_MS; a point
+// has settled once the slope between two windows' mean voltages is within
+// the threshold, and its reading is then the mean over the averaging time.
+// A supply that never settles has its point averaged after
+// LOADREG_SETTLE_TIMEOUT, flagged. Timing is from the blocks' timestamps, so
+// it holds whatever the ADC's scan rate. The points are kept in the shared
+// scratch buffer. Only in builds with USE_LOADREG defined.
+
+#ifdef USE_LOADREG
+
+static volatile loadreg_state test_state = LOADREG_IDLE;
+static uint8 points_wanted;
+static volatile uint8 point_count;
+static int full_load;		// Microamps
+static int slope_limit;		// Microvolts a second
+static uint32 average_us;
+static uint8 averaging;		// Settled, and taking the reading
+static uint8 fresh;			// The point's first block is yet to come
+static uint8 have_window;
+static uint32 point_start, window_start, last_window_start;	// Microseconds
+static uint16 window_blocks;
+static int64 voltage_sum, current_sum;
+static int last_window;		// Mean microvolts
+
+static void start_point() {
+	int setpoint = ((int64)full_load * point_count) / (points_wanted - 1);
+	scratch.loadreg[point_count] = (loadreg_point){.setpoint = setpoint};
+	set_current(setpoint);
+	averaging = 0;
+	fresh = 1;
+	have_window = 0;
+	window_blocks = 0;
+}
+
+int loadreg_start(int full, int count, int slope, int average) {
+	if(full <= 0 || full > CURRENT_FULLRANGE_MAX || count < 2 || count > LOADREG_MAX_POINTS || slope <= 0
+	   || average < LOADREG_WINDOW_MS || average > LOADREG_MAX_AVERAGE)
+		return 0;
+
+	test_state = LOADREG_IDLE;
+	sequence_stop();
+	battery_stop();
+	sweep_stop();
+	mppt_stop();
+	ir_stop();
+	tune_stop();
+	impedance_stop();
+	ocp_stop();
+	scratch_claim(SCRATCH_LOADREG);
+	full_load = full;
+	points_wanted = count;
+	slope_limit = slope;
+	average_us = average * 1000;
+	point_count = 0;
+	set_load_mode(LOAD_MODE_CC);
+	start_point();
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	// Last, as the ADC task takes over from here
+	test_state = LOADREG_RUNNING;
+	return 1;
+}
+
+static void finish(loadreg_state end) {
+	if(test_state != LOADREG_RUNNING)
+		return;
+	set_current(0);
+	test_state = end;
+	if(end == LOADREG_DONE)
+		defer_post(DEFER_LOADREG_DONE);
+}
+
+// Ends a running test early, keeping the points taken so far, for 'loadreg
+// stop' and on a fault
+void loadreg_stop() {
+	finish(LOADREG_STOPPED);
+}
+
+// Called by the ADC task with each block's means and start time
+void loadreg_block(const int16 *mean, uint32 timestamp) {
+	if(test_state != LOADREG_RUNNING)
+		return;
+
+	if(window_blocks == 0) {
+		window_start = timestamp;
+		if(fresh) {
+			point_start = timestamp;
+			fresh = 0;
+		}
+		voltage_sum = current_sum = 0;
+	}
+	voltage_sum += voltage_from_raw(mean[FILTER_VOLTAGE]);
+	current_sum += current_from_raw(mean[FILTER_CURRENT]);
+	window_blocks++;
+	if(timestamp - window_start < (averaging?average_us:LOADREG_WINDOW_MS * 1000))
+		return;
+
+	int voltage = voltage_sum / window_blocks;
+	loadreg_point *point = &scratch.loadreg[point_count];
+	if(averaging) {
+		point->voltage = voltage;
+		point->current = current_sum / window_blocks;
+		if(++point_count >= points_wanted)
+			finish(LOADREG_DONE);
+		else
+			start_point();
+		return;
+	}
+	window_blocks = 0;
+
+	uint32 settling = timestamp - point_start;
+	if(have_window) {
+		// Between the windows' starts, so the two means are a window apart
+		int64 slope = ((int64)(voltage - last_window) * 1000000) / (int32)(window_start - last_window_start);
+		int settled = slope <= slope_limit && slope >= -slope_limit;
+		if(settled || settling >= LOADREG_SETTLE_TIMEOUT * 1000) {
+			point->settle_ms = div1000(settling);
+			point->unsettled = !settled;
+			averaging = 1;
+			return;
+		}
+	}
+	last_window = voltage;
+	last_window_start = window_start;
+	have_window = 1;
+}
+
+loadreg_state get_loadreg_state() {
+	return test_state;
+}
+
+// The point being measured, or -1 when no test is running
+int get_loadreg_index() {
+	return (test_state == LOADREG_RUNNING)?point_count:-1;
+}
+
+int get_loadreg_length() {
+	return scratch_owned(SCRATCH_LOADREG)?point_count:0;
+}
+
+const loadreg_point *get_loadreg_point(int i) {
+	return &scratch.loadreg[i];
+}
+
+// Load regulation in parts per million, the no load voltage's excess over
+// the full load's, or 0 without both
+int get_loadreg_regulation() {
+	const loadreg_point *points = scratch.loadreg;
+	if(!scratch_owned(SCRATCH_LOADREG) || point_count < points_wanted || points[point_count - 1].voltage <= 0)
+		return 0;
+	return ((int64)(points[0].voltage - points[point_count - 1].voltage) * 1000000) / points[point_count - 1].voltage;
+}
+
+#else
+
+int loadreg_start(int full, int count, int slope, int average) {
+	return 0;
+}
+
+void loadreg_stop() {
+}
+
+void loadreg_block(const int16 *mean, uint32 timestamp) {
+}
+
+loadreg_state get_loadreg_state() {
+	return LOADREG_IDLE;
+}
+
+int get_loadreg_index() {
+	return -1;
+}
+
+int get_loadreg_length() {
+	return 0;
+}
+
+const loadreg_point *get_loadreg_point(int i) {
+	return NULL;
+}
+
+int get_loadreg_regulation() {
+	return 0;
+}
+
+#endif
+
+/* [] END OF FILE */
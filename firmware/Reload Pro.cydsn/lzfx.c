@@ -53,6 +53,19 @@
 typedef unsigned char u8;
 typedef const u8 *LZSTATE[LZFX_HSIZE];
 
+/* Word copies for the decoder. The Cortex-M0 faults on unaligned word
+   accesses, so they're only used when source and destination share an
+   alignment; sharing it also means a back reference is at least a word
+   behind, so copying forwards a word at a time still repeats the pattern
+   correctly. Everything else is copied bytewise, unrolled by four. */
+#if __GNUC__ >= 3
+# define LZFX_WORD_COPY 1
+typedef unsigned int __attribute__((__may_alias__)) fx_word;
+#else
+# define LZFX_WORD_COPY 0
+#endif
+#define LZFX_WORD_MIN       8   /* Shorter copies aren't worth aligning */
+
 /* Define the hash function */
 #define LZFX_FRST(p)     (((p[0]) << 8) | p[1])
 #define LZFX_NEXT(v,p)   (((v) << 8) | p[2])
@@ -223,6 +236,36 @@ int lzfx_compress(const void *const ibuf, const unsigned int ilen,
 }
 
 /* Decompressor */
+/* Copies len bytes forwards from ip to op, which may overlap if op > ip. */
+static void fx_copy(u8 *op, const u8 *ip, unsigned int len){
+
+#if LZFX_WORD_COPY
+    if(len >= LZFX_WORD_MIN && (((size_t)op ^ (size_t)ip) & 3) == 0) {
+        while((size_t)op & 3) {
+            *op++ = *ip++;
+            len--;
+        }
+        while(len >= 4) {
+            *(fx_word *)op = *(const fx_word *)ip;
+            op += 4;
+            ip += 4;
+            len -= 4;
+        }
+    }
+#endif
+    while(len >= 4) {
+        op[0] = ip[0];
+        op[1] = ip[1];
+        op[2] = ip[2];
+        op[3] = ip[3];
+        op += 4;
+        ip += 4;
+        len -= 4;
+    }
+    while(len--)
+        *op++ = *ip++;
+}
+
 int lzfx_decompress(const void* ibuf, unsigned int ilen,
                           void* obuf, unsigned int *olen){
 
@@ -259,9 +302,9 @@ int lzfx_decompress(const void* ibuf, unsigned int ilen,
             }
             if(fx_expect_false(ip + ctrl > in_end)) return LZFX_ECORRUPT;
 
-            do
-                *op++ = *ip++;
-            while(--ctrl);
+            fx_copy(op, ip, ctrl);
+            op += ctrl;
+            ip += ctrl;
 
         /*  Format #1 [LLLooooo oooooooo]: backref of length L+1+2
                           ^^^^^ ^^^^^^^^
@@ -293,9 +336,15 @@ int lzfx_decompress(const void* ibuf, unsigned int ilen,
 
             if(fx_expect_false(ref < (u8*)obuf)) return LZFX_ECORRUPT;
 
-            do
-                *op++ = *ref++;
-            while (--len);
+            /* Most matches are short; copy those without the set up */
+            if(len <= LZFX_WORD_MIN) {
+                do
+                    *op++ = *ref++;
+                while (--len);
+            } else {
+                fx_copy(op, ref, len);
+                op += len;
+            }
         }
 
     } while (ip < in_end);
@@ -310,6 +359,52 @@ guess:
     return rc;
 }
 
+/* Streaming decompressor */
+int lzfx_decompress_stream(const void* ibuf, unsigned int ilen,
+                          lzfx_sink sink, void *arg){
+
+    u8 window[LZFX_STREAM_WINDOW];
+    u8 const *ip = (const u8 *)ibuf;
+    u8 const *const in_end = ip + ilen;
+    unsigned int op = 0;        /* Bytes output so far */
+    unsigned int sent = 0;      /* Bytes passed to sink so far */
+
+    if(ibuf == NULL || sink == NULL) return LZFX_EARGS;
+
+    while(ip < in_end) {
+        unsigned int ctrl = *ip++;
+        unsigned int len, off = 0;
+
+        /* See lzfx_decompress for the format */
+        if(ctrl < (1 << 5)) {
+            len = ctrl + 1;
+            if(fx_expect_false(ip + len > in_end)) return LZFX_ECORRUPT;
+        } else {
+            len = ctrl >> 5;
+            if(len == 7) len += *ip++;
+            len += 2;
+            if(fx_expect_false(ip >= in_end)) return LZFX_ECORRUPT;
+            off = (((ctrl & 0x1f) << 8) | *ip++) + 1;
+            if(fx_expect_false(off > LZFX_STREAM_WINDOW || off > op))
+                return LZFX_ECORRUPT;
+        }
+
+        do {
+            window[op % LZFX_STREAM_WINDOW] = off ? window[(op - off) % LZFX_STREAM_WINDOW] : *ip++;
+            op++;
+            if(op - sent == LZFX_STREAM_CHUNK) {
+                sink(window + sent % LZFX_STREAM_WINDOW, LZFX_STREAM_CHUNK, arg);
+                sent = op;
+            }
+        } while(--len);
+    }
+
+    if(op > sent)
+        sink(window + sent % LZFX_STREAM_WINDOW, op - sent, arg);
+
+    return op;
+}
+
 /* Guess len. No parameters may be NULL; this is not checked. */
 static
 int lzfx_getsize(const void* ibuf, unsigned int ilen, unsigned int *olen){
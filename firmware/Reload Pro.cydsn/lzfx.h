@@ -90,6 +90,24 @@ int lzfx_compress(const void* ibuf, unsigned int ilen,
 int lzfx_decompress(const void* ibuf, unsigned int ilen,
                           void* obuf, unsigned int *olen);
 
+/*  Streaming decompressor, for targets without room for the whole output.
+
+    Output goes to sink in chunks of LZFX_STREAM_CHUNK bytes (the last one
+    may be shorter), decoded into a window of LZFX_STREAM_WINDOW bytes on the
+    stack.  Back references may therefore reach at most LZFX_STREAM_WINDOW
+    bytes back, which the compressor must respect; lzfx_compress does not.
+
+    Returns the uncompressed size in bytes, or a negative value on failure.
+    Chunks already passed to sink when an error is found are not retracted.
+*/
+#define LZFX_STREAM_WINDOW      64
+#define LZFX_STREAM_CHUNK       32
+
+typedef void (*lzfx_sink)(const void *data, unsigned int len, void *arg);
+
+int lzfx_decompress_stream(const void* ibuf, unsigned int ilen,
+                          lzfx_sink sink, void *arg);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -0,0 +1,110 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <string.h>
+#include "config.h"
+
+// Command macros: MACRO_COUNT named scripts of command lines, a flash row
+// each, run by the comms task. A row is read straight from flash, so a macro
+// costs no RAM, and is rewritten whole for each line added.
+
+typedef struct {
+	uint16 crc;			// Over the rest of the row
+	uint8 length;		// Bytes of text used
+	char name[MACRO_NAME_LENGTH + 1];	// NUL terminated
+	char text[CY_FLASH_SIZEOF_ROW - 4 - MACRO_NAME_LENGTH];	// Lines, each ending in '\n'
+} macro_row;
+
+static const volatile macro_row macro_area[MACRO_COUNT] CY_SECTION(".rodata.macros") CY_ALIGN(CY_FLASH_SIZEOF_ROW);
+
+static uint16 row_crc(const macro_row *row) {
+	return crc16_update(0xFFFF, (const uint8*)row + sizeof(row->crc), sizeof(*row) - sizeof(row->crc));
+}
+
+// The row in slot if it holds a macro, else NULL
+static const macro_row *valid_row(int slot) {
+	if(slot < 0 || slot >= MACRO_COUNT)
+		return NULL;
+	const macro_row *row = (const macro_row*)&macro_area[slot];
+	return (row->name[0] != 0 && row->crc == row_crc(row))?row:NULL;
+}
+
+static void write_row(int slot, macro_row *row) {
+	row->crc = row_crc(row);
+	CySysFlashWriteRow(((uint32)&macro_area[slot] - CYDEV_FLASH_BASE) / CY_FLASH_SIZEOF_ROW, (const uint8*)row);
+}
+
+// The name of the macro in slot, or NULL if it's empty
+const char *get_macro_name(int slot) {
+	const macro_row *row = valid_row(slot);
+	return (row == NULL)?NULL:row->name;
+}
+
+// The text of the macro in slot, its lines each ending in '\n', or NULL if
+// it's empty
+const char *get_macro_text(int slot, uint8 *length) {
+	const macro_row *row = valid_row(slot);
+	if(row == NULL)
+		return NULL;
+	*length = row->length;
+	return row->text;
+}
+
+// The slot holding the macro called name, or -1
+int find_macro(const char *name) {
+	for(int i = 0; i < MACRO_COUNT; i++) {
+		const char *found = get_macro_name(i);
+		if(found != NULL && strcmp(found, name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+// Adds line to the end of the macro called name, starting it in a free slot
+// if there's none. Returns the slot, or -1 if the name or line is too long or
+// there's no room. The CPU stalls for the row write, as for a settings save.
+int macro_append(const char *name, const char *line) {
+	int name_length = strlen(name), line_length = strlen(line);
+	if(name_length == 0 || name_length > MACRO_NAME_LENGTH || line_length > MACRO_LINE_MAX)
+		return -1;
+
+	macro_row row;
+	int slot = find_macro(name);
+	if(slot >= 0) {
+		memcpy(&row, valid_row(slot), sizeof(row));
+	} else {
+		for(slot = 0; slot < MACRO_COUNT && valid_row(slot) != NULL; slot++);
+		if(slot == MACRO_COUNT)
+			return -1;
+		memset(&row, 0, sizeof(row));
+		memcpy(row.name, name, name_length);
+	}
+
+	if(row.length + line_length + 1 > sizeof(row.text))
+		return -1;
+	memcpy(&row.text[row.length], line, line_length);
+	row.length += line_length;
+	row.text[row.length++] = '\n';
+	write_row(slot, &row);
+	return slot;
+}
+
+void macro_delete(int slot) {
+	if(valid_row(slot) == NULL)
+		return;
+	macro_row row;
+	memset(&row, 0, sizeof(row));
+	write_row(slot, &row);
+}
+
+/* [] END OF FILE */
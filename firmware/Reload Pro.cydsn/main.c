@@ -4,13 +4,13 @@
 #include <stdio.h>
 #include "tasks.h"
 #include "config.h"
-#include "splashscreen.h"
 
 state_t state;
 xTaskHandle adc_task;
 xTaskHandle comms_task;
 xTaskHandle ui_task;
 
+// Used until the settings have been saved for the first time
 static const settings_t settings_data = {
 	.dac_low_gain = DEFAULT_DAC_LOW_GAIN,
 	.dac_high_gain = DEFAULT_DAC_HIGH_GAIN,
@@ -23,46 +23,159 @@ static const settings_t settings_data = {
 	
 	.adc_voltage_offset = DEFAULT_ADC_VOLTAGE_OFFSET,
 	.adc_voltage_gain = DEFAULT_ADC_VOLTAGE_GAIN,
+	.adc_current_tempco = 0,
+	.adc_voltage_tempco = 0,
+	.cal_temperature = THERMAL_DEFAULT_CAL_TEMPERATURE,
+
+	.thermal_resistance = THERMAL_DEFAULT_RESISTANCE,
+	.thermal_tau = THERMAL_DEFAULT_TAU,
+	.junction_resistance = THERMAL_DEFAULT_JUNCTION_RESISTANCE,
+	.junction_max = THERMAL_DEFAULT_JUNCTION_MAX,
+	.soa_knee = THERMAL_DEFAULT_SOA_KNEE,
 	
 	.backlight_brightness = 32,
+	.backlight_timeout = BACKLIGHT_DEFAULT_TIMEOUT,
 	.lcd_contrast = 32,
+	
+	.cv_kp = DEFAULT_CV_KP,
+	.cv_ki = DEFAULT_CV_KI,
+
+	.overvoltage_limit = DEFAULT_OVERVOLTAGE_LIMIT,
+	.undervoltage_limit = DEFAULT_UNDERVOLTAGE_LIMIT,
+	
+	.fast_boot = 0,
+	.address = 0,
+	.ui_refresh_rate = UI_REFRESH_DEFAULT,
+	.opamp_autozero = 0,
+
+	// The second layout of each mode leans towards what's being dissipated
+	.display_layouts = 0,
+	.display = {
+		.cc = {
+			{.readouts = {READOUT_CURRENT_SETPOINT, READOUT_CURRENT_USAGE, READOUT_VOLTAGE}},
+			{.readouts = {READOUT_CURRENT_USAGE, READOUT_POWER, READOUT_CHARGE}},
+		},
+		.cv = {
+			{.readouts = {READOUT_VOLTAGE, READOUT_VOLTAGE_SETPOINT, READOUT_CURRENT_USAGE}},
+			{.readouts = {READOUT_CURRENT_USAGE, READOUT_VOLTAGE, READOUT_POWER}},
+		},
+		.cr = {
+			{.readouts = {READOUT_CURRENT_USAGE, READOUT_RESISTANCE_SETPOINT, READOUT_VOLTAGE}},
+			{.readouts = {READOUT_RESISTANCE, READOUT_RESISTANCE_SETPOINT, READOUT_POWER}},
+		},
+		.cp = {
+			{.readouts = {READOUT_POWER, READOUT_POWER_SETPOINT, READOUT_VOLTAGE}},
+			{.readouts = {READOUT_POWER, READOUT_CURRENT_USAGE, READOUT_ENERGY}},
+		},
+		.pulse = {
+			{.readouts = {READOUT_CURRENT_SETPOINT, READOUT_CURRENT_USAGE, READOUT_VOLTAGE}},
+			{.readouts = {READOUT_CURRENT_USAGE, READOUT_VOLTAGE, READOUT_POWER}},
+		},
+	},
 };
-const settings_t *settings;
+
+// Statically allocated so the stacks show up in the link map instead of the heap
+portSTACK_TYPE ui_stack[UI_TASK_STACK_SIZE];
+static portSTACK_TYPE comms_stack[COMMS_TASK_STACK_SIZE];
+static portSTACK_TYPE adc_stack[ADC_TASK_STACK_SIZE];
+
+// What comes from the heap before the scheduler starts: a TCB for each task,
+// the idle task's included, and each queue's header and its storage, which
+// is a byte longer than its items. heap_1 rounds each to its 8 byte blocks
+// and keeps one block back to align the heap. The TCB and queue header sizes
+// are this kernel's with FreeRTOSConfig.h's options.
+#define HEAP_BLOCK(bytes) (((bytes) + portBYTE_ALIGNMENT - 1) & ~(portBYTE_ALIGNMENT - 1))
+#define HEAP_TCB HEAP_BLOCK(60)
+#define HEAP_QUEUE(length, size) (HEAP_BLOCK(76) + HEAP_BLOCK((length) * (size) + 1))
+#ifdef USE_SEQUENCE
+#define HEAP_SEQUENCE HEAP_QUEUE(SEQUENCE_LOG_LENGTH, sizeof(sequence_log_entry))
+#else
+#define HEAP_SEQUENCE 0
+#endif
+#ifdef USE_STREAM
+#define HEAP_STREAM HEAP_QUEUE(STREAM_QUEUE_LENGTH, sizeof(stream_sample))
+#else
+#define HEAP_STREAM 0
+#endif
+#ifdef USE_DATALOG
+#define HEAP_DATALOG HEAP_QUEUE(DATALOG_QUEUE_LENGTH, sizeof(datalog_record))
+#else
+#define HEAP_DATALOG 0
+#endif
+#define HEAP_NEEDED (4 * HEAP_TCB + HEAP_QUEUE(ADC_RING_BLOCKS - 2, sizeof(uint8)) \
+	+ HEAP_QUEUE(COMMS_QUEUE_LENGTH, sizeof(comms_event)) + HEAP_QUEUE(1, 0) \
+	+ HEAP_SEQUENCE + HEAP_STREAM + HEAP_DATALOG)
+_Static_assert(HEAP_NEEDED < configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT, "configTOTAL_HEAP_SIZE is too small for this build's queues");
 
 void prvHardwareSetup();
 
 void main()
 {
-	settings = &settings_data;
+	paint_main_stack();
+	watchdog_init();
+	settings_init(&settings_data);
+	calibration_update();
 	
     CyGlobalIntEnable;
 
-	Backlight_Write(1);
+	// Started first so that boot milestones can be timed
+	start_timers();
+	start_timestamp();
+
+	set_backlight(settings->backlight_brightness);
+#ifdef USE_FAN
+	fan_init();
+#endif
 	
 	disp_reset_Write(0);
 	CyDelayUs(10);
 	disp_reset_Write(1);
 	CyDelayUs(10);
-	Display_Start();
-	Display_SetContrast(settings->lcd_contrast);
-	
-	#ifdef USE_SPLASHSCREEN
-	load_splashscreen();
-	#endif
-	
+	if(!settings->fast_boot) {
+		Display_Start();
+		Display_SetContrast(settings->lcd_contrast);
+		selftest_check_display();
+		mark_boot_milestone(BOOT_MILESTONE_DISPLAY);
+		
+		#ifdef USE_SPLASHSCREEN
+		load_splashscreen();
+		mark_boot_milestone(BOOT_MILESTONE_SPLASHSCREEN);
+		#endif
+	}
+	// Otherwise the UI task powers the display up once the scheduler is running
 
 	IDAC_High_Start();
 	IDAC_Low_Start();
 	set_output_mode(OUTPUT_MODE_FEEDBACK);
-		
-	start_adc();
-
 	setup();
+
+	// The self test and autozero have the SAR to themselves until start_adc()
+	ADC_Start();
+	ADC_StartConvert();
+	selftest_run();
+
+	if(settings->opamp_autozero && selftest_passed()) {
+		// Retrim for today's temperature while nothing else is using the ADC.
+		// The result isn't saved, so it can't wear the flash.
+		opamp_trim_search(OPAMP_AUTOZERO_CURRENT);
+	}
+
+	start_adc();
+	start_comms();
+	start_ui();
+	trigger_init();
+	// Ahead of powerfail_init(), so a sequence resuming after a power failure
+	// takes over from the profile
+	poweron_apply();
+	powerfail_init();
 	
-	xTaskCreate(vTaskUI, (signed portCHAR *) "UI", 178, NULL, tskIDLE_PRIORITY + 2, &ui_task);
-	xTaskCreate(vTaskComms, (signed portCHAR *) "UART", 141, NULL, tskIDLE_PRIORITY + 2, &comms_task);
+	xTaskGenericCreate(vTaskUI, (signed portCHAR *) "UI", UI_TASK_STACK_SIZE, NULL, UI_TASK_PRIORITY, &ui_task, ui_stack, NULL);
+	xTaskGenericCreate(vTaskComms, (signed portCHAR *) "UART", COMMS_TASK_STACK_SIZE, NULL, COMMS_TASK_PRIORITY, &comms_task, comms_stack, NULL);
+	xTaskGenericCreate(vTaskADC, (signed portCHAR *) "ADC", ADC_TASK_STACK_SIZE, NULL, ADC_TASK_PRIORITY, &adc_task, adc_stack, NULL);
 	
 	prvHardwareSetup();
+	watchdog_start();
+	mark_boot_milestone(BOOT_MILESTONE_SCHEDULER);
 	vTaskStartScheduler();
 }
 
@@ -87,15 +200,22 @@ void prvHardwareSetup( void )
 void vApplicationStackOverflowHook( xTaskHandle pxTask, signed char *pcTaskName )
 {
 	/* The stack space has been execeeded for a task, considering allocating more. */
-	taskDISABLE_INTERRUPTS();
-	for( ;; );
+	watchdog_crash( CRASH_STACK_OVERFLOW, pcTaskName, 0, ( uint32 ) __builtin_return_address( 0 ) );
 }
 
 void vApplicationMallocFailedHook( void )
 {
-	/* The heap space has been execeeded. */
-	taskDISABLE_INTERRUPTS();
-	for( ;; );
+	/* The heap space has been execeeded. Only TCBs, queues and semaphores come
+	from the heap now, all created by main() before the scheduler starts
+	(start_adc(), start_comms() and start_ui()), so this fires at boot if
+	configTOTAL_HEAP_SIZE is too small. */
+	watchdog_crash( CRASH_MALLOC_FAILED, NULL, 0, ( uint32 ) __builtin_return_address( 0 ) );
+}
+
+void vApplicationTickHook( void )
+{
+	watchdog_tick();
+	schedule_tick();
 }
 
 /* [] END OF FILE */
@@ -0,0 +1,139 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include "tasks.h"
+#include "config.h"
+
+// Maximum power point tracking by perturb and observe, for solar panels. It
+// runs in the ADC task on a C/C setpoint: every interval blocks it averages
+// the readings, and if the power fell since the last perturbation the
+// direction reverses, then the setpoint moves one step. Tracking efficiency
+// is the mean power since the start as a share of the best seen. Only in
+// builds with USE_MPPT defined.
+
+#ifdef USE_MPPT
+
+static volatile uint8 running = 0;
+static int step;			// Microamps, signed for the direction
+static uint8 interval, blocks;
+static int32 current_sum, voltage_sum;
+static int last_power;
+static mppt_status status;
+static uint64 power_sum;	// Microwatts, one per interval
+static uint32 intervals;
+
+int mppt_start(int step_size, int new_interval) {
+	if(step_size <= 0 || new_interval < 1 || new_interval > MPPT_MAX_INTERVAL)
+		return 0;
+
+	running = 0;
+	sequence_stop();
+	sweep_stop();
+	battery_stop();
+	ocp_stop();
+	set_load_mode(LOAD_MODE_CC);
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	step = step_size;
+	interval = new_interval;
+	blocks = 0;
+	current_sum = voltage_sum = 0;
+	last_power = 0;
+	power_sum = 0;
+	intervals = 0;
+	status = (mppt_status){0};
+	running = 1;
+	return 1;
+}
+
+void mppt_stop() {
+	running = 0;
+}
+
+// Called by the ADC task with each block's means
+void mppt_block(const int16 *mean) {
+	if(!running)
+		return;
+	if(get_load_mode() != LOAD_MODE_CC) {
+		// Something else took over the load
+		running = 0;
+		return;
+	}
+	current_sum += mean[FILTER_CURRENT];
+	voltage_sum += mean[FILTER_VOLTAGE];
+	if(++blocks < interval)
+		return;
+
+	int current = current_from_raw(current_sum / blocks);
+	int voltage = voltage_from_raw(voltage_sum / blocks);
+	int power = power_from(current, voltage);
+	blocks = 0;
+	current_sum = voltage_sum = 0;
+
+	if(power < last_power)
+		step = -step;
+	last_power = power;
+
+	int setpoint = get_current_setpoint() + step;
+	if(setpoint < 0) {
+		setpoint = 0;
+	} else if(setpoint > CURRENT_FULLRANGE_MAX) {
+		setpoint = CURRENT_FULLRANGE_MAX;
+	}
+	set_current(setpoint);
+
+	power_sum += power;
+	intervals++;
+	status.current = current;
+	status.voltage = voltage;
+	status.power = power;
+	if(power > status.max_power) {
+		status.max_power = power;
+		status.max_voltage = voltage;
+	}
+	status.efficiency = status.max_power ? (power_sum / intervals) * 100 / status.max_power : 0;
+}
+
+int get_mppt_running() {
+	return running;
+}
+
+void get_mppt_status(mppt_status *out) {
+	uint8 int_state = CyEnterCriticalSection();
+	*out = status;
+	CyExitCriticalSection(int_state);
+}
+
+#else
+
+int mppt_start(int step_size, int new_interval) {
+	return 0;
+}
+
+void mppt_stop() {
+}
+
+void mppt_block(const int16 *mean) {
+}
+
+int get_mppt_running() {
+	return 0;
+}
+
+void get_mppt_status(mppt_status *out) {
+	*out = (mppt_status){0};
+}
+
+#endif
+
+/* [] END OF FILE */
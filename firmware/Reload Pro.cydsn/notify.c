@@ -0,0 +1,148 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include "tasks.h"
+#include "config.h"
+
+// Asynchronous notifications for the host. Everything is raised by the ADC
+// task: trips as it handles them, and the rest by notify_block comparing the
+// state with the last block's, which catches changes however they were made
+// without anything in the ISRs or setters. Notifications the host has
+// subscribed to go in a ring of their own, so they never displace a command
+// line, and the comms task drains it whenever it wakes. A setpoint change
+// replaces an unread one, so turning the knob can't flood the ring.
+
+static notification ring[NOTIFY_RING_LENGTH];
+static volatile uint8 ring_head, ring_tail;	// Written by the ADC and comms tasks respectively
+static volatile uint8 subscribed = 1 << NOTIFY_FAULT;
+static volatile uint8 overflows;
+static uint8 ring_peak;	// Most notifications ever waiting
+
+static load_mode last_mode;
+static int last_setpoint;
+static int8 last_step = -1;
+static battery_state last_battery;
+
+void notify_post(notify_type type, int value) {
+	if(!(subscribed & (1 << type)))
+		return;
+
+	uint8 head = ring_head;
+	uint8 newest = (head + NOTIFY_RING_LENGTH - 1) % NOTIFY_RING_LENGTH;
+	if(type == NOTIFY_SETPOINT && head != ring_tail && ring[newest].type == NOTIFY_SETPOINT) {
+		// The comms task may be reading it, but a torn value is overwritten by
+		// the next block's change or was going to be stale anyway
+		ring[newest].value = value;
+		return;
+	}
+
+	uint8 next = (head + 1) % NOTIFY_RING_LENGTH;
+	if(next == ring_tail) {
+		overflows++;
+		return;
+	}
+	ring[head].type = type;
+	ring[head].value = value;
+	ring_head = next;
+	uint8 waiting = (next + NOTIFY_RING_LENGTH - ring_tail) % NOTIFY_RING_LENGTH;
+	if(waiting > ring_peak)
+		ring_peak = waiting;
+	// If the queue's full the task is due to wake anyway, and drains the ring when it does
+	xQueueSendToBack(comms_queue, &((comms_event){.type=COMMS_EVENT_NOTIFY}), 0);
+}
+
+// Called by the comms task. Returns 0 once the ring is empty.
+int notify_take(notification *n) {
+	uint8 tail = ring_tail;
+	if(tail == ring_head)
+		return 0;
+	*n = ring[tail];
+	ring_tail = (tail + 1) % NOTIFY_RING_LENGTH;
+	return 1;
+}
+
+// One slot is always empty, so it holds one less than its length
+void get_notify_usage(buffer_usage *usage) {
+	usage->size = NOTIFY_RING_LENGTH - 1;
+	usage->bytes = sizeof(ring);
+	usage->fill = (ring_head + NOTIFY_RING_LENGTH - ring_tail) % NOTIFY_RING_LENGTH;
+	usage->peak = ring_peak;
+}
+
+// Notifications lost to a full ring since the last call
+uint8 notify_take_overflows() {
+	uint8 lost = overflows;
+	overflows -= lost;
+	return lost;
+}
+
+static int active_setpoint(load_mode mode) {
+	switch(mode) {
+	case LOAD_MODE_CV:
+		return get_voltage_target();
+	case LOAD_MODE_CR:
+		return get_resistance_target();
+	case LOAD_MODE_CP:
+		return get_power_target();
+	default:
+		return get_current_setpoint();
+	}
+}
+
+// Called by the ADC task after each block
+void notify_block() {
+	if(subscribed == 0 || subscribed == (1 << NOTIFY_FAULT))
+		return;
+
+	load_mode mode = get_load_mode();
+	if(mode != last_mode) {
+		last_mode = mode;
+		notify_post(NOTIFY_MODE, mode);
+	}
+	int setpoint = active_setpoint(mode);
+	if(setpoint != last_setpoint) {
+		last_setpoint = setpoint;
+		notify_post(NOTIFY_SETPOINT, setpoint);
+	}
+	int8 step = get_sequence_step();
+	if(step != last_step) {
+		// Reports the step that just finished, including the last
+		if(last_step >= 0)
+			notify_post(NOTIFY_STEP, last_step);
+		last_step = step;
+	}
+	battery_state battery = get_battery_state();
+	if(battery != last_battery) {
+		last_battery = battery;
+		if(battery == BATTERY_DONE)
+			notify_post(NOTIFY_CUTOFF, get_battery_cutoff());
+	}
+}
+
+// Subscribes to the notify_types with their bits set in mask, unsubscribing
+// from the rest. Changes from before a subscription are not reported.
+void set_notify_mask(uint8 mask) {
+	last_mode = get_load_mode();
+	last_setpoint = active_setpoint(last_mode);
+	last_step = get_sequence_step();
+	last_battery = get_battery_state();
+	subscribed = mask;
+}
+
+uint8 get_notify_mask() {
+	return subscribed;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,170 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include "tasks.h"
+#include "config.h"
+
+// Overcurrent protection trip test for a power supply: ramps a C/C setpoint
+// up at a fixed rate until the supply's voltage collapses, the way a supply
+// folds back or shuts off at its limit. It runs in the ADC task, setting the
+// ramp from each block's timestamp and watching every scan of the block, so
+// the output is dropped within a block of the trip rather than a host's round
+// trip later. The reference voltage is taken at the starting current after
+// OCP_SETTLE_BLOCKS; a collapse is OCP_TRIP_SCANS scans in a row below the
+// given fraction of it. The trip current is the measured mean of the last
+// whole block before it. Only in builds with USE_OCP defined.
+
+#ifdef USE_OCP
+
+static volatile ocp_state test_state = OCP_IDLE;
+static int ramp_from, ramp_to, ramp_rate;	// Microamps, and microamps a second
+static uint8 drop_percent;
+static uint8 settling;			// Blocks still to wait before the ramp starts
+static uint8 low_scans;
+static int16 threshold_raw;
+static int16 last_current;		// The last whole block's mean, raw
+static int16 last_voltage;
+static uint32 ramp_start;		// Microseconds
+static ocp_result result;
+
+int ocp_start(int from, int to, int rate, int drop) {
+	if(from < 0 || to <= from || to > CURRENT_FULLRANGE_MAX || rate < OCP_MIN_RATE || rate > OCP_MAX_RATE
+	   || drop < 1 || drop > 99)
+		return 0;
+
+	test_state = OCP_IDLE;
+	sequence_stop();
+	battery_stop();
+	sweep_stop();
+	mppt_stop();
+	ir_stop();
+	impedance_stop();
+	ramp_from = from;
+	ramp_to = to;
+	ramp_rate = rate;
+	drop_percent = drop;
+	settling = OCP_SETTLE_BLOCKS;
+	low_scans = 0;
+	result = (ocp_result){0};
+	set_load_mode(LOAD_MODE_CC);
+	set_current(from);
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	// Last, as the ADC task takes over from here
+	test_state = OCP_SETTLING;
+	return 1;
+}
+
+static void finish(ocp_state end) {
+	// Off first, then the setpoint, so the load lets go at once whatever the
+	// slew limit
+	slew_stop();
+	set_output_mode(OUTPUT_MODE_OFF);
+	set_current(0);
+	test_state = end;
+	defer_post(DEFER_OCP_DONE);
+}
+
+// Ends a running test early, for 'ocp stop' and on a fault
+void ocp_stop() {
+	if(test_state != OCP_SETTLING && test_state != OCP_RAMPING)
+		return;
+	test_state = OCP_STOPPED;
+	set_current(0);
+}
+
+// Called by the ADC task with each block's scans, means and timestamp
+void ocp_block(const int16 (*scans)[ADC_RING_CHANNELS], const int16 *mean, uint32 now) {
+	if(test_state == OCP_SETTLING) {
+		if(get_load_mode() != LOAD_MODE_CC) {
+			// Something else took over the load
+			test_state = OCP_STOPPED;
+		} else if(--settling == 0) {
+			int reference = voltage_from_raw(mean[FILTER_VOLTAGE]);
+			result.reference = reference;
+			threshold_raw = voltage_to_raw(reference - reference / 100 * drop_percent);
+			last_current = mean[FILTER_CURRENT];
+			last_voltage = mean[FILTER_VOLTAGE];
+			ramp_start = now;
+			test_state = OCP_RAMPING;
+		}
+		return;
+	}
+	if(test_state != OCP_RAMPING)
+		return;
+	if(get_load_mode() != LOAD_MODE_CC) {
+		test_state = OCP_STOPPED;
+		return;
+	}
+
+	for(int i = 0; i < ADC_BLOCK_SCANS; i++) {
+		if(scans[i][ADC_CHAN_VOLTAGE_SENSE] >= threshold_raw) {
+			low_scans = 0;
+		} else if(++low_scans >= OCP_TRIP_SCANS) {
+			result.trip_current = current_from_raw(last_current);
+			result.trip_setpoint = get_current_setpoint();
+			result.voltage = voltage_from_raw(last_voltage);
+			result.ms = (now - ramp_start) / 1000;
+			finish(OCP_TRIPPED);
+			return;
+		}
+	}
+	last_current = mean[FILTER_CURRENT];
+	last_voltage = mean[FILTER_VOLTAGE];
+
+	int setpoint = ramp_from + ((int64)ramp_rate * ((now - ramp_start) / 1000)) / 1000;
+	if(setpoint >= ramp_to) {
+		// Reached the end without a trip
+		result.trip_current = current_from_raw(last_current);
+		result.trip_setpoint = ramp_to;
+		result.voltage = voltage_from_raw(last_voltage);
+		result.ms = (now - ramp_start) / 1000;
+		finish(OCP_NO_TRIP);
+		return;
+	}
+	set_current(setpoint);
+}
+
+ocp_state get_ocp_state() {
+	return test_state;
+}
+
+// The figures once a test has finished; the reference voltage once ramping
+void get_ocp_result(ocp_result *r) {
+	*r = result;
+}
+
+#else
+
+int ocp_start(int from, int to, int rate, int drop) {
+	return 0;
+}
+
+void ocp_stop() {
+}
+
+void ocp_block(const int16 (*scans)[ADC_RING_CHANNELS], const int16 *mean, uint32 now) {
+}
+
+ocp_state get_ocp_state() {
+	return OCP_IDLE;
+}
+
+void get_ocp_result(ocp_result *r) {
+	*r = (ocp_result){0};
+}
+
+#endif
+
+/* [] END OF FILE */
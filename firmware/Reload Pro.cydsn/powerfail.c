@@ -0,0 +1,220 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <string.h>
+#include "tasks.h"
+#include "config.h"
+
+// Power fail snapshot. The low voltage detect interrupts as VDDD falls through
+// 4.5V, at the highest priority. The ISR pulls the gate low, sheds the
+// backlight, and writes what a long test needs to carry on into a flash row of
+// its own: the mode and target, the output state, the charge and energy
+// totals, and the sequencer with its steps. That's one row write, about 20ms
+// of the hold-up time. Then it resets, so a blip that never gets as far as a
+// brown-out reset comes back the same way as a real power cut.
+//
+// At boot main() applies the snapshot if resume is on, and the comms task
+// clears it once running, so it's only ever applied once. Row writes need
+// more stack than main() has to spare. The settings row is full, so the on
+// and resume flags live in this row too. Detection is off by default: on USB
+// power the rail can dip below 4.5V without anything being wrong.
+
+typedef struct {
+	uint32 duration_mode;	// Milliseconds in the low 24 bits, load_mode in the top 8
+	int32 setpoint;
+} powerfail_step;
+
+typedef struct {
+	uint8 output_mode;
+	uint8 load_mode;
+	int8 sequence_step;		// -1 with the sequencer idle
+	uint8 step_count;
+	int32 target;			// In the load mode's units
+	uint32 step_elapsed;	// Milliseconds into the current step
+	int32 loops;			// Sequence loops left, 0 for forever
+	energy_totals totals;
+	powerfail_step steps[SEQUENCE_MAX_STEPS];
+} powerfail_snapshot;
+
+// Exactly a row
+typedef struct {
+	uint16 crc;				// Over everything after it
+	uint8 flags;			// POWERFAIL_FLAG_*
+	uint8 saved;			// Nonzero while the snapshot is waiting to be resumed
+	powerfail_snapshot snapshot;
+	uint8 padding[CY_FLASH_SIZEOF_ROW - 4 - sizeof(powerfail_snapshot)];
+} powerfail_row;
+
+static const volatile powerfail_row powerfail_area CY_SECTION(".rodata.powerfail") CY_ALIGN(CY_FLASH_SIZEOF_ROW);
+
+static uint8 flags = 0;
+static uint8 resumed = 0;
+static uint8 clear_pending = 0;
+
+static uint16 row_crc(const powerfail_row *row) {
+	return crc16_update(0xFFFF, (const uint8*)row + 2, sizeof(powerfail_row) - 2);
+}
+
+static void write_row(powerfail_row *row) {
+	row->flags = flags;
+	row->crc = row_crc(row);
+	CySysFlashWriteRow(((uint32)&powerfail_area - CYDEV_FLASH_BASE) / CY_FLASH_SIZEOF_ROW, (const uint8*)row);
+}
+
+static int get_target(load_mode mode) {
+	switch(mode) {
+	case LOAD_MODE_CV:
+		return get_voltage_target();
+	case LOAD_MODE_CR:
+		return get_resistance_target();
+	case LOAD_MODE_CP:
+		return get_power_target();
+	default:
+		return get_current_setpoint();
+	}
+}
+
+static void take_snapshot(powerfail_snapshot *s) {
+	s->output_mode = get_output_mode();
+	s->load_mode = get_load_mode();
+	s->target = get_target(s->load_mode);
+	get_energy_totals(&s->totals);
+
+	s->sequence_step = get_sequence_step();
+	s->step_count = get_sequence_length();
+	s->loops = get_sequence_loops();
+	s->step_elapsed = get_sequence_step_elapsed();
+	const sequence_step *steps = get_sequence_steps();
+	for(uint8 i = 0; i < s->step_count; i++) {
+		s->steps[i].duration_mode = steps[i].duration | ((uint32)steps[i].mode << 24);
+		s->steps[i].setpoint = steps[i].setpoint;
+		// Step conditions and jumps don't fit in the row, and a step resumed
+		// without its cutoff could run a battery flat, so a sequence with
+		// any comes back stopped, with the output off
+		if(steps[i].until != SEQUENCE_UNTIL_NONE || steps[i].jump >= 0) {
+			s->sequence_step = -1;
+			s->output_mode = OUTPUT_MODE_OFF;
+		}
+	}
+}
+
+__attribute__((noreturn, noinline)) static void save_and_reset() {
+	powerfail_row row;
+	memset(&row, 0, sizeof(row));
+	take_snapshot(&row.snapshot);
+	row.saved = 1;
+	write_row(&row);
+	CySysLvdClearInterrupt();
+	CySoftwareReset();
+	for(;;);
+}
+
+CY_ISR(powerfail_isr) {
+	trip_output();
+	set_backlight(0);
+	// The row write needs more than the main stack has, and nothing returns
+	// from here, so carry on at the top of the UI task's stack
+	__set_MSP((uint32)&ui_stack[UI_TASK_STACK_SIZE]);
+	save_and_reset();
+}
+
+static void resume(const powerfail_snapshot *s) {
+	energy_totals totals = s->totals;
+	set_energy_totals(&totals);
+
+	sequence_clear();
+	for(uint8 i = 0; i < s->step_count && i < SEQUENCE_MAX_STEPS; i++) {
+		sequence_step step = {
+			.duration = s->steps[i].duration_mode & 0xFFFFFF,
+			.setpoint = s->steps[i].setpoint,
+			.mode = s->steps[i].duration_mode >> 24,
+		};
+		sequence_add(&step);
+	}
+
+	if(s->sequence_step >= 0) {
+		sequence_resume(s->sequence_step, s->loops, s->step_elapsed);
+	} else if(s->load_mode <= LOAD_MODE_PULSE) {
+		set_load_target(s->load_mode, s->target);
+	}
+	// A forced on gate was a short circuit test, which isn't resumed
+	if(s->output_mode != OUTPUT_MODE_FEEDBACK)
+		set_output_mode(OUTPUT_MODE_OFF);
+}
+
+static void start_detect() {
+	CySysLvdDisable();
+	CySysLvdClearInterrupt();
+	CyIntDisable(POWERFAIL_IRQ);
+	if(!(flags & POWERFAIL_FLAG_ON))
+		return;
+	CyIntSetVector(POWERFAIL_IRQ, powerfail_isr);
+	CyIntSetPriority(POWERFAIL_IRQ, IRQ_PRIORITY_PROTECTION);
+	CyIntClearPending(POWERFAIL_IRQ);
+	CySysLvdEnable(CY_LVD_THRESHOLD_4_50_V);
+	CyIntEnable(POWERFAIL_IRQ);
+}
+
+// Called once the ADC and the timestamp are running, before the scheduler,
+// so a resumed test is back in control before the display has powered up on
+// a fast boot
+void powerfail_init() {
+	const powerfail_row *row = (const powerfail_row*)&powerfail_area;
+	if(row->crc != row_crc(row))
+		return;
+
+	flags = row->flags;
+	if(row->saved) {
+		if(flags & POWERFAIL_FLAG_RESUME) {
+			resume(&row->snapshot);
+			resumed = 1;
+		}
+		clear_pending = 1;
+	}
+}
+
+// Called by the comms task as it starts: drops the snapshot main() found, and
+// starts watching the supply
+void powerfail_start() {
+	if(clear_pending) {
+		powerfail_row row;
+		memset(&row, 0, sizeof(row));
+		write_row(&row);
+		clear_pending = 0;
+	}
+	start_detect();
+}
+
+// POWERFAIL_FLAG_* bits; saved only if they change. Called from the comms task.
+void set_powerfail_flags(uint8 new_flags) {
+	if(new_flags == flags)
+		return;
+	flags = new_flags;
+
+	powerfail_row row;
+	memset(&row, 0, sizeof(row));
+	write_row(&row);
+	start_detect();
+}
+
+uint8 get_powerfail_flags() {
+	return flags;
+}
+
+// Whether this boot carried on from a snapshot
+int get_powerfail_resumed() {
+	return resumed;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,170 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <string.h>
+#include <FreeRTOS.h>
+#include <queue.h>
+#include "tasks.h"
+#include "config.h"
+
+// Setpoint presets: PRESET_COUNT slots of a load mode, its target, the
+// voltage trip points and the CV gains, kept in a flash row of their own
+// because the settings row is full. Slots are read straight from flash, so
+// they cost no RAM. The power-on profile has the row's spare bytes, with a
+// CRC of its own so rows written before it keep their presets.
+
+typedef struct {
+	uint16 used;		// Bit n set if slot n holds a preset
+	uint16 crc;			// Over used and slots
+	preset slots[PRESET_COUNT];
+	poweron_profile poweron;
+	uint16 poweron_crc;
+	uint8 padding[CY_FLASH_SIZEOF_ROW - 6 - PRESET_COUNT * sizeof(preset) - sizeof(poweron_profile)];
+} preset_row;
+
+static const volatile preset_row preset_area CY_SECTION(".rodata.presets") CY_ALIGN(CY_FLASH_SIZEOF_ROW);
+
+static uint16 row_crc(const preset_row *row) {
+	uint16 crc = crc16_update(0xFFFF, (const uint8*)&row->used, sizeof(row->used));
+	return crc16_update(crc, (const uint8*)row->slots, sizeof(row->slots));
+}
+
+static const preset_row *valid_row() {
+	const preset_row *row = (const preset_row*)&preset_area;
+	return (row->crc == row_crc(row))?row:NULL;
+}
+
+// The preset in slot, or NULL if it's empty or there's no such slot
+const preset *get_preset(int slot) {
+	const preset_row *row = valid_row();
+	if(row == NULL || slot < 0 || slot >= PRESET_COUNT || !(row->used & (1 << slot)))
+		return NULL;
+	return &row->slots[slot];
+}
+
+// Applies a preset in one go: the trip points, gains, target and mode all change
+// inside the one critical section, so the control loop never runs a mix of
+// old and new. A CC target still goes through the slew limiter. Returns 0 if
+// the slot is empty.
+int preset_recall(int slot) {
+	const preset *p = get_preset(slot);
+	if(p == NULL)
+		return 0;
+
+	uint8 int_state = CyEnterCriticalSection();
+	settings_write_volatile(&p->overvoltage_limit, &settings->overvoltage_limit, sizeof(p->overvoltage_limit));
+	settings_write_volatile(&p->undervoltage_limit, &settings->undervoltage_limit, sizeof(p->undervoltage_limit));
+	if(p->mode == LOAD_MODE_CV && p->cv_kp > 0) {
+		int kp = p->cv_kp, ki = p->cv_ki;
+		settings_write_volatile(&kp, &settings->cv_kp, sizeof(kp));
+		settings_write_volatile(&ki, &settings->cv_ki, sizeof(ki));
+	}
+	voltage_limits_update();
+	set_load_target(p->mode, p->target);
+	CyExitCriticalSection(int_state);
+	return 1;
+}
+
+// Saves the present mode, target and trip points to slot. The CPU stalls for
+// the row write, as for a settings save. Returns 0 for a slot that doesn't
+// exist, or in pulse mode, whose setup is more than one target.
+int preset_store(int slot) {
+	load_mode mode = get_load_mode();
+	if(slot < 0 || slot >= PRESET_COUNT || mode == LOAD_MODE_PULSE)
+		return 0;
+
+	preset_row row;
+	memcpy(&row, (const void*)&preset_area, sizeof(row));
+	if(valid_row() == NULL) {
+		row.used = 0;
+		memset(row.slots, 0, sizeof(row.slots));
+	}
+
+	preset *p = &row.slots[slot];
+	p->mode = mode;
+	switch(mode) {
+	case LOAD_MODE_CV:
+		p->target = get_voltage_target();
+		break;
+	case LOAD_MODE_CR:
+		p->target = get_resistance_target();
+		break;
+	case LOAD_MODE_CP:
+		p->target = get_power_target();
+		break;
+	default:
+		p->target = get_current_setpoint();
+		break;
+	}
+	p->overvoltage_limit = settings->overvoltage_limit;
+	p->undervoltage_limit = settings->undervoltage_limit;
+	p->cv_kp = settings->cv_kp;
+	p->cv_ki = settings->cv_ki;
+	row.used |= 1 << slot;
+	row.crc = row_crc(&row);
+	CySysFlashWriteRow(((uint32)&preset_area - CYDEV_FLASH_BASE) / CY_FLASH_SIZEOF_ROW, (const uint8*)&row);
+	return 1;
+}
+
+static uint16 poweron_crc(const poweron_profile *profile) {
+	return crc16_update(0xFFFF, (const uint8*)profile, sizeof(*profile));
+}
+
+// The power-on profile, or NULL if there isn't one
+const poweron_profile *get_poweron() {
+	const preset_row *row = (const preset_row*)&preset_area;
+	return (row->poweron_crc == poweron_crc(&row->poweron))?&row->poweron:NULL;
+}
+
+// Saves profile for the next power on, or with NULL stops there being one,
+// leaving the presets as they are. The CPU stalls for the row write. Returns
+// 0 for a preset slot that doesn't exist.
+int poweron_store(const poweron_profile *profile) {
+	if(profile != NULL && profile->preset != POWERON_NO_PRESET && profile->preset >= PRESET_COUNT)
+		return 0;
+
+	preset_row row;
+	memcpy(&row, (const void*)&preset_area, sizeof(row));
+	if(profile != NULL) {
+		row.poweron = *profile;
+		row.poweron_crc = poweron_crc(profile);
+	} else {
+		memset(&row.poweron, 0, sizeof(row.poweron));
+		row.poweron_crc = ~poweron_crc(&row.poweron);
+	}
+	CySysFlashWriteRow(((uint32)&preset_area - CYDEV_FLASH_BASE) / CY_FLASH_SIZEOF_ROW, (const uint8*)&row);
+	return 1;
+}
+
+// Sets the unit up as the power-on profile says. Runs from main() once the
+// ADC is running and before the scheduler starts; the output is off while
+// the preset goes in, so turning it on ramps to the preset's target rather
+// than jumping there. An empty preset slot leaves the load at zero.
+void poweron_apply() {
+	const poweron_profile *profile = get_poweron();
+	if(profile == NULL)
+		return;
+
+	set_output_mode(OUTPUT_MODE_OFF);
+	if(profile->preset != POWERON_NO_PRESET)
+		preset_recall(profile->preset);
+	if(profile->output)
+		output_on();
+	if(profile->stream_blocks) {
+		uint8 every[STREAM_CHANNELS] = {0};
+		set_stream_channels(profile->stream_channels, every);
+		set_stream_interval(profile->stream_blocks);
+	}
+}
+
+/* [] END OF FILE */
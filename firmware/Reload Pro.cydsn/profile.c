@@ -0,0 +1,105 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <string.h>
+#include "tasks.h"
+#include "config.h"
+
+// Profiling for the 'stats' command. Task run time is measured on the
+// microsecond timestamp at each context switch. ISRs count their cycles on the
+// SysTick down-counter, from entry to exit. Everything covers the window since
+// the last snapshot. Time spent in an ISR also counts towards the task it
+// interrupted. Only in builds with USE_PROFILE defined.
+
+#ifdef USE_PROFILE
+
+static uint32 task_time[PROFILE_TASK_COUNT];
+static uint8 running_task = PROFILE_TASK_IDLE;
+static uint32 last_switch = 0, window_start = 0;
+static isr_profile isr_stats[PROFILE_ISR_COUNT];
+static uint32 ui_refreshes, ui_skipped;
+
+// Called by the kernel with the task about to run
+void profile_task_switch(void *task) {
+	uint32 now = get_time_us();
+	task_time[running_task] += now - last_switch;
+	last_switch = now;
+
+	if(task == ui_task) {
+		running_task = PROFILE_TASK_UI;
+	} else if(task == comms_task) {
+		running_task = PROFILE_TASK_COMMS;
+	} else if(task == adc_task) {
+		running_task = PROFILE_TASK_ADC;
+	} else {
+		running_task = PROFILE_TASK_IDLE;
+	}
+	TRACE_EVENT(TRACE_TASK_SWITCH, running_task);
+}
+
+// Called last thing in an ISR with the SysTick value from its first line
+void profile_isr(profile_isr_id id, uint32 entry_ticks) {
+	uint32 cycles = cycles_since(entry_ticks);
+	isr_profile *stats = &isr_stats[id];
+	stats->count++;
+	stats->cycles += cycles;
+	if(cycles > stats->max_cycles)
+		stats->max_cycles = cycles;
+}
+
+// Called by the UI after each status refresh, with whether it drew anything
+void profile_ui_refresh(uint8 drawn) {
+	ui_refreshes++;
+	if(!drawn)
+		ui_skipped++;
+}
+
+// Copies out the figures for the window just ended and starts a new one
+void take_profile_snapshot(profile_snapshot *snapshot) {
+	uint8 int_state = CyEnterCriticalSection();
+	uint32 now = get_time_us();
+	task_time[running_task] += now - last_switch;
+	last_switch = now;
+
+	snapshot->window = now - window_start;
+	memcpy(snapshot->task_time, task_time, sizeof(task_time));
+	memcpy(snapshot->isr, isr_stats, sizeof(isr_stats));
+	memset(task_time, 0, sizeof(task_time));
+	memset(isr_stats, 0, sizeof(isr_stats));
+	snapshot->ui_refreshes = ui_refreshes;
+	snapshot->ui_skipped = ui_skipped;
+	ui_refreshes = ui_skipped = 0;
+	window_start = now;
+	CyExitCriticalSection(int_state);
+}
+
+#else
+
+void profile_task_switch(void *task) {
+}
+
+void profile_isr(profile_isr_id id, uint32 entry_ticks) {
+}
+
+void profile_ui_refresh(uint8 drawn) {
+}
+
+void take_profile_snapshot(profile_snapshot *snapshot) {
+	memset(snapshot, 0, sizeof(*snapshot));
+}
+
+#endif
+
+/* [] END OF FILE */
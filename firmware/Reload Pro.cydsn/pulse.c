@@ -0,0 +1,174 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "config.h"
+
+// Transient load generator. TIMER_COUNTER_PULSE is a 16 bit TCPWM counter
+// clocked at 1MHz; its terminal count interrupt switches the IDACs between two sets of
+// codes that were worked out in advance, so each edge is a pair of register
+// writes at a fixed latency from the timer. Phases longer than the counter's
+// range are split into several timer periods. The same mode can play the
+// waveform generator's table instead, from awg.c.
+
+static pulse_config_t config = {
+	.low_current = PULSE_DEFAULT_LOW,
+	.high_current = PULSE_DEFAULT_HIGH,
+	.frequency = PULSE_DEFAULT_FREQUENCY,
+	.duty = PULSE_DEFAULT_DUTY,
+};
+
+static uint8 dac_codes[2][2]; // [phase][high, low]
+static uint32 phase_length[2]; // Microseconds
+static volatile uint32 phase_remaining;
+static volatile uint8 pulse_phase = 0;
+static volatile uint16 pulse_edges = 0;
+static uint8 running = 0;
+static uint8 table = 0; // Playing the waveform table rather than the square wave
+
+// The high level, held to what the SOA allows a pulse of its width and duty,
+// which for short pulses can be well above the steady state limit
+static int limited_high() {
+	int limit = get_pulse_limit(phase_length[1], config.duty, config.low_current);
+	return (config.high_current > limit)?limit:config.high_current;
+}
+
+// The next timer period of the phase, less one as the counter wants it
+static uint16 next_period() {
+	uint32 chunk = (phase_remaining > 0x10000)?0x10000:phase_remaining;
+	phase_remaining -= chunk;
+	return chunk - 1;
+}
+
+CY_ISR(pulse_timer_isr) {
+	timer_clear_interrupt(TIMER_COUNTER_PULSE, TIMER_INTR_TC);
+
+	if(phase_remaining == 0) {
+		uint8 phase = pulse_phase ^ 1;
+		write_dac(dac_codes[phase][0], dac_codes[phase][1]);
+		pulse_phase = phase;
+		pulse_edges++;
+		phase_remaining = phase_length[phase];
+	}
+	timer_write_period(TIMER_COUNTER_PULSE, next_period());
+}
+
+int set_pulse_config(const pulse_config_t *new_config) {
+	if(new_config->frequency < PULSE_MIN_FREQUENCY || new_config->frequency > PULSE_MAX_FREQUENCY)
+		return 0;
+	if(new_config->duty < 1 || new_config->duty > 99)
+		return 0;
+
+	uint32 period = 1000000 / new_config->frequency;
+	uint32 high = (period * new_config->duty) / 100;
+	if(high < PULSE_MIN_PHASE_US || period - high < PULSE_MIN_PHASE_US)
+		return 0;
+
+	uint8 was_running = running;
+	if(was_running)
+		stop_pulse();
+	config = *new_config;
+	table = 0;
+	if(config.low_current < 0)
+		config.low_current = 0;
+	if(config.high_current > CURRENT_FULLRANGE_MAX)
+		config.high_current = CURRENT_FULLRANGE_MAX;
+	phase_length[0] = period - high;
+	phase_length[1] = high;
+	if(was_running)
+		start_pulse();
+	return 1;
+}
+
+const pulse_config_t *get_pulse_config() {
+	return &config;
+}
+
+// Plays the waveform table from now on, restarting the generator from its
+// first sample if it's running
+void pulse_select_table() {
+	table = 1;
+	if(running) {
+		// Straight over, without stop_pulse() dropping to zero in between
+		timer_stop(TIMER_COUNTER_PULSE);
+		start_pulse();
+	}
+}
+
+void start_pulse() {
+	slew_stop();
+	set_opamp_fast(1);
+	if(table) {
+		awg_start();
+		running = 1;
+		return;
+	}
+	if(phase_length[0] == 0)
+		// First run with the defaults
+		set_pulse_config(&config);
+	int high = limited_high();
+	current_to_dac((config.low_current > high)?high:config.low_current, &dac_codes[0][0], &dac_codes[0][1]);
+	current_to_dac(high, &dac_codes[1][0], &dac_codes[1][1]);
+
+	// Start in the low phase; the first terminal count is the rising edge
+	pulse_phase = 0;
+	write_dac(dac_codes[0][0], dac_codes[0][1]);
+	state.current_setpoint = config.high_current;
+
+	phase_remaining = phase_length[0];
+	timer_start(TIMER_COUNTER_PULSE, next_period(), TIMER_INTR_TC, pulse_timer_isr, IRQ_PRIORITY_CONTROL);
+	running = 1;
+}
+
+void stop_pulse() {
+	if(!running)
+		return;
+	timer_stop(TIMER_COUNTER_PULSE);
+	running = 0;
+	set_current(0);
+	set_opamp_fast(0);
+}
+
+// Called by the thermal model as its limits move: brings the high level
+// within them while the square wave plays, straight away if it's high now
+void pulse_update_limit() {
+	if(!running || table)
+		return;
+	uint8 codes[2];
+	current_to_dac(limited_high(), &codes[0], &codes[1]);
+	uint8 int_state = CyEnterCriticalSection();
+	dac_codes[1][0] = codes[0];
+	dac_codes[1][1] = codes[1];
+	if(pulse_phase == 1)
+		write_dac(codes[0], codes[1]);
+	CyExitCriticalSection(int_state);
+}
+
+// Called from the ADC ISR once per block: bit 0 is the present phase, bit 1 is
+// set if there was an edge since the last call.
+uint8 get_pulse_flags() {
+	static uint16 last_edges = 0;
+	uint8 flags = 0;
+
+	if(running && table)
+		return get_awg_flags();
+	if(running) {
+		uint16 edges = pulse_edges;
+		flags = pulse_phase;
+		if(edges != last_edges)
+			flags |= PULSE_FLAG_EDGE;
+		last_edges = edges;
+	}
+	return flags;
+}
+
+/* [] END OF FILE */
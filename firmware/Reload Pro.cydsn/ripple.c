@@ -0,0 +1,200 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "tasks.h"
+#include "config.h"
+
+// Ripple amplitude at a few chosen frequencies, by a Goertzel filter per bin
+// run over every raw voltage scan in the ADC task. That's one multiply a bin
+// per scan, instead of shipping the samples to the host for an FFT. Each
+// window of blocks gives a result per bin and then starts again; the scan
+// rate is measured over each window and sets the next one's coefficients,
+// so nothing assumes the SAR timing. The very first window only measures.
+// Scans go in relative to the window's first, so the voltage's DC level
+// doesn't eat into the filters' range. Only in builds with USE_RIPPLE
+// defined; without it the scan rate is the one the SAR's timing gives.
+
+#ifdef USE_RIPPLE
+
+#define COEFF_SHIFT 29
+#define TWO_PI_Q30 6746518852ull
+#define ONE_Q30 (1 << 30)
+
+typedef struct {
+	int32 coeff;	// 2cos(2 pi f / fs) in Q29, which is cos in Q30; 0 when off
+	int32 s1, s2;
+} goertzel_bin;
+
+static volatile uint16 bin_hz[RIPPLE_BINS] = {100, 120};
+static volatile int amplitude[RIPPLE_BINS] = {-1, -1, -1, -1};	// Microvolts peak, -1 for none
+static goertzel_bin bins[RIPPLE_BINS];
+static uint16 window = RIPPLE_DEFAULT_WINDOW;
+static volatile int32 new_window = RIPPLE_DEFAULT_WINDOW;	// Starts the first window
+static uint16 window_blocks;
+static uint32 window_time, last_time;	// Microseconds
+static uint32 scan_rate = 0;	// Hz, from the last window; 0 before there is one
+static uint8 coeffs_valid;		// The running window's coefficients were set from scan_rate
+static int16 reference;
+
+// cos(theta) for theta in Q30 radians from 0 to pi, in Q30, by its Taylor
+// series. Only run at the start of a window, so the divides don't matter.
+static int32 cos_q30(uint32 theta) {
+	static const uint32 HALF_PI_Q30 = TWO_PI_Q30 / 4;
+	int negate = 0;
+	if(theta > HALF_PI_Q30) {
+		theta = 2 * HALF_PI_Q30 - theta;
+		negate = 1;
+	}
+	uint64 theta2 = ((uint64)theta * theta) >> 30;
+	int64 sum = ONE_Q30;
+	uint64 term = ONE_Q30;
+	for(int k = 1; k <= 7; k++) {
+		term = ((term * theta2) >> 30) / ((2 * k - 1) * (2 * k));
+		sum += (k & 1)?-(int64)term:(int64)term;
+	}
+	return negate?-sum:sum;
+}
+
+static void restart(uint32 now) {
+	coeffs_valid = (scan_rate != 0);
+	for(int i = 0; i < RIPPLE_BINS; i++) {
+		uint16 hz = bin_hz[i];
+		bins[i].s1 = bins[i].s2 = 0;
+		bins[i].coeff = 0;
+		if(coeffs_valid && hz != 0 && hz <= scan_rate / 2)
+			bins[i].coeff = cos_q30((TWO_PI_Q30 * hz) / scan_rate);
+	}
+	window_blocks = 0;
+	window_time = 0;
+	last_time = now;
+}
+
+static void finish() {
+	uint32 scans = (uint32)window_blocks * ADC_BLOCK_SCANS;
+	if(window_time > 0)
+		scan_rate = ((uint64)scans * 1000000) / window_time;
+
+	for(int i = 0; i < RIPPLE_BINS; i++) {
+		goertzel_bin *b = &bins[i];
+		if(!coeffs_valid || b->coeff == 0) {
+			amplitude[i] = -1;
+			continue;
+		}
+		int64 cross = ((int64)b->coeff * b->s1) >> COEFF_SHIFT;
+		int64 power = (int64)b->s1 * b->s1 + (int64)b->s2 * b->s2 - cross * b->s2;
+		// A sine of amplitude A gives a magnitude of A N / 2; the span wants Q8 counts
+		uint32 magnitude = isqrt((power > 0)?power:0);
+		amplitude[i] = voltage_span_from_raw(((uint64)magnitude * 512) / scans);
+	}
+}
+
+void ripple_block(const int16 (*scans)[ADC_RING_CHANNELS], uint32 timestamp) {
+	if(new_window >= 0) {
+		window = new_window;
+		new_window = -1;
+		restart(timestamp);
+	}
+	if(window_blocks == 0)
+		reference = scans[0][ADC_CHAN_VOLTAGE_SENSE];
+	window_time += timestamp - last_time;
+	last_time = timestamp;
+
+	if(coeffs_valid) {
+		for(int i = 0; i < RIPPLE_BINS; i++) {
+			goertzel_bin *b = &bins[i];
+			if(b->coeff == 0)
+				continue;
+			int32 s1 = b->s1, s2 = b->s2;
+			for(int j = 0; j < ADC_BLOCK_SCANS; j++) {
+				int32 s0 = (scans[j][ADC_CHAN_VOLTAGE_SENSE] - reference) + (int32)(((int64)b->coeff * s1) >> COEFF_SHIFT) - s2;
+				s2 = s1;
+				s1 = s0;
+			}
+			b->s1 = s1;
+			b->s2 = s2;
+		}
+	}
+
+	if(++window_blocks >= window) {
+		finish();
+		restart(timestamp);
+	}
+}
+
+// Sets a bin's frequency, 0 to turn it off. Takes effect from a new window.
+int set_ripple_bin(int bin, int hz) {
+	if(bin < 0 || bin >= RIPPLE_BINS || hz < 0 || hz > UINT16_MAX)
+		return 0;
+	bin_hz[bin] = hz;
+	amplitude[bin] = -1;
+	new_window = get_ripple_window();
+	return 1;
+}
+
+int get_ripple_bin(int bin) {
+	return bin_hz[bin];
+}
+
+// Microvolts peak from the last window, or -1 if there's no result
+int get_ripple_amplitude(int bin) {
+	return amplitude[bin];
+}
+
+// The window length in blocks, applied by the ADC task
+int set_ripple_window(int blocks) {
+	if(blocks < 1 || blocks > RIPPLE_MAX_WINDOW)
+		return 0;
+	new_window = blocks;
+	return 1;
+}
+
+int get_ripple_window() {
+	return (new_window >= 0)?new_window:window;
+}
+
+uint32 get_ripple_scan_rate() {
+	return scan_rate;
+}
+
+#else
+
+void ripple_block(const int16 (*scans)[ADC_RING_CHANNELS], uint32 timestamp) {
+}
+
+int set_ripple_bin(int bin, int hz) {
+	return 0;
+}
+
+int get_ripple_bin(int bin) {
+	return 0;
+}
+
+int get_ripple_amplitude(int bin) {
+	return -1;
+}
+
+int set_ripple_window(int blocks) {
+	return 0;
+}
+
+int get_ripple_window() {
+	return 0;
+}
+
+uint32 get_ripple_scan_rate() {
+	return adc_get_scan_rate();
+}
+
+#endif
+
+/* [] END OF FILE */
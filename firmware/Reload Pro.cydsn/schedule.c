@@ -0,0 +1,97 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include "tasks.h"
+#include "config.h"
+
+// Periodic jobs, timed from the tick hook rather than by each task keeping
+// its own last tick. A job falls due on the ticks where the tick count less
+// its phase is a whole number of periods; the phases differ, so jobs on the
+// usual periods don't all land on one tick. Falling due only latches the
+// job and, where its task may be asleep, wakes it; the task does the work
+// when it takes the job. The timer service would need its own task and
+// queue, more RAM than the heap has to spare, for the same thing.
+
+typedef struct {
+	uint8 phase;		// Ticks
+	void (*wake)();		// From the tick ISR as the job falls due, or NULL if its task looks often anyway
+} schedule_job_info;
+
+static void wake_ui() {
+	ui_post_from_isr(0);
+}
+
+static const schedule_job_info jobs[SCHEDULE_JOBS] = {
+	[SCHEDULE_UI_REFRESH] = {0, wake_ui},
+	[SCHEDULE_DATALOG] = {6, NULL},		// Looked at after every ADC block
+};
+
+static portTickType periods[SCHEDULE_JOBS];	// 0 when stopped
+static portTickType next_due[SCHEDULE_JOBS];
+static portTickType last_due[SCHEDULE_JOBS];
+static volatile uint8 pending;	// A bit per job that's due and not yet taken
+
+// The first tick after now on the job's grid
+static portTickType next_slot(schedule_job job, portTickType now, portTickType period) {
+	return now + period - (now - jobs[job].phase) % period;
+}
+
+// Sets a job's period in ticks, 0 to stop it, and returns the tick it's
+// first due. Setting the period it already has leaves it be.
+portTickType schedule_set(schedule_job job, portTickType period) {
+	uint8 int_state = CyEnterCriticalSection();
+	if(period != periods[job]) {
+		periods[job] = period;
+		pending &= ~(1u << job);
+		if(period != 0)
+			next_due[job] = next_slot(job, xTaskGetTickCount(), period);
+	}
+	portTickType first = next_due[job];
+	CyExitCriticalSection(int_state);
+	return first;
+}
+
+// Whether the job has fallen due since it was last taken, and if so the tick
+// it was due at, in *due if that's not NULL. Runs that fell due while one
+// was waiting merge into it.
+int schedule_take(schedule_job job, portTickType *due) {
+	uint8 int_state = CyEnterCriticalSection();
+	int taken = (pending & (1u << job)) != 0;
+	pending &= ~(1u << job);
+	if(taken && due != NULL)
+		*due = last_due[job];
+	CyExitCriticalSection(int_state);
+	return taken;
+}
+
+// From the tick hook, so in the tick ISR
+void schedule_tick() {
+	portTickType now = xTaskGetTickCountFromISR();
+	for(int i = 0; i < SCHEDULE_JOBS; i++) {
+		portTickType period = periods[i];
+		if(period == 0 || (portBASE_TYPE)(now - next_due[i]) < 0)
+			continue;
+		last_due[i] = next_due[i];
+		pending |= 1u << i;
+		next_due[i] += period;
+		// Ticks stepped over in tickless idle: back onto the grid
+		if((portBASE_TYPE)(now - next_due[i]) >= 0)
+			next_due[i] = next_slot(i, now, period);
+		if(jobs[i].wake != NULL)
+			jobs[i].wake();
+	}
+}
+
+/* [] END OF FILE */
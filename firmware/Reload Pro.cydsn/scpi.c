@@ -0,0 +1,374 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <string.h>
+#include "tasks.h"
+#include "config.h"
+
+// A SCPI subset, for test executives that already drive other instruments
+// that way. Lines the text protocol doesn't know are handed here; headers are
+// matched in short or long form, in any case, through the gperf table made
+// from tools/scpi_keywords, and commands can be chained with ';'. Query
+// replies in a line are joined with ';' and end it, and errors go to a queue
+// read with SYST:ERR?, as the standard has it. Only in builds with USE_SCPI
+// defined; without it those lines are unknown commands.
+
+#ifdef USE_SCPI
+
+#include "scpi_commands.h"
+
+#define SCPI_HEADER_MAX 24 // Longest header, in short form, with its path
+#define SCPI_ERROR_QUEUE 4
+
+typedef enum {
+	SCPI_ERROR_NONE,
+	SCPI_ERROR_UNDEFINED_HEADER,
+	SCPI_ERROR_MISSING_PARAMETER,
+	SCPI_ERROR_ILLEGAL_VALUE,
+	SCPI_ERROR_QUEUE_OVERFLOW,
+} scpi_error;
+
+static const struct {
+	int16 code;
+	const char *message;
+} scpi_errors[] = {
+	{0, "No error"},
+	{-113, "Undefined header"},
+	{-109, "Missing parameter"},
+	{-224, "Illegal parameter value"},
+	{-350, "Queue overflow"},
+};
+
+static uint8 errors[SCPI_ERROR_QUEUE];
+static uint8 error_count = 0;
+static uint8 replied; // Set once a query in this line has answered
+
+static void scpi_push_error(scpi_error error) {
+	if(error_count < SCPI_ERROR_QUEUE) {
+		errors[error_count++] = error;
+	} else {
+		// The last entry records that some were lost
+		errors[SCPI_ERROR_QUEUE - 1] = SCPI_ERROR_QUEUE_OVERFLOW;
+	}
+}
+
+static void scpi_reply(const char *text) {
+	if(replied)
+		uart_puts(";");
+	uart_puts(text);
+	replied = 1;
+}
+
+// Replies with a value held in millionths (decimals 6) or thousandths (3)
+// of its unit, as a decimal in the whole unit
+static void scpi_reply_fixed(int32 value, int decimals) {
+	char response[16];
+	uint32 magnitude = (value < 0)?-(uint32)value:(uint32)value;
+	uint32 whole = div1000(magnitude), fraction = magnitude - whole * 1000;
+	if(decimals == 6) {
+		uint32 millions = div1000(whole);
+		fraction += (whole - millions * 1000) * 1000;
+		whole = millions;
+	}
+	format(response, (decimals == 6)?"%s%u.%06u":"%s%u.%03u", (value < 0)?"-":"", whole, fraction);
+	scpi_reply(response);
+}
+
+static char scpi_upper(char c) {
+	return (c >= 'a' && c <= 'z')?c - 'a' + 'A':c;
+}
+
+static int scpi_is_vowel(char c) {
+	return c == 'A' || c == 'E' || c == 'I' || c == 'O' || c == 'U';
+}
+
+// Checks the mnemonic of length given against one mnemonic of a SCPI form,
+// "CURRent": it must be the short part, in upper case in the form, or the
+// whole, either in any case
+static int scpi_mnemonic_matches(const char *given, int length, const char *form, int form_length) {
+	int short_length = 0;
+	while(short_length < form_length && (form[short_length] < 'a' || form[short_length] > 'z'))
+		short_length++;
+	if(length != short_length && length != form_length)
+		return 0;
+	for(int i = 0; i < length; i++) {
+		if(scpi_upper(given[i]) != scpi_upper(form[i]))
+			return 0;
+	}
+	return 1;
+}
+
+// Checks each mnemonic of header against the last of form's, so a header given relative to an earlier one's path is checked too
+static int scpi_matches(const char *header, const char *form) {
+	const char *given_end = header + strlen(header), *form_end = form + strlen(form);
+	if(given_end > header && given_end[-1] == '?') {
+		given_end--;
+		form_end--;
+	}
+	while(given_end > header) {
+		const char *given = given_end, *mnemonic = form_end;
+		while(given > header && given[-1] != ':')
+			given--;
+		while(mnemonic > form && mnemonic[-1] != ':')
+			mnemonic--;
+		if(!scpi_mnemonic_matches(given, given_end - given, mnemonic, form_end - mnemonic))
+			return 0;
+		if(given == header)
+			break;
+		given_end = given - 1;
+		form_end = mnemonic - 1;
+		if(form_end < form)
+			return 0;
+	}
+	return 1;
+}
+
+// Appends header's short form to key, which holds the path it's relative to.
+// A mnemonic over four letters is cut to four, or three if the fourth is a
+// vowel, the standard's rule for short forms; scpi_matches() then rejects
+// those that weren't a long form. Returns 0 if it doesn't fit.
+static int scpi_short_header(const char *header, char *key) {
+	int length = strlen(key);
+	while(*header != 0) {
+		int mnemonic = 0;
+		for(; *header != 0 && *header != ':' && *header != '?'; header++, mnemonic++) {
+			if(mnemonic < 4 && length < SCPI_HEADER_MAX - 1)
+				key[length++] = scpi_upper(*header);
+		}
+		if(mnemonic > 4 && scpi_is_vowel(key[length - 1]))
+			length--;
+		if(*header != 0 && length < SCPI_HEADER_MAX - 1)
+			key[length++] = *header++;
+	}
+	key[length] = 0;
+	return length < SCPI_HEADER_MAX - 1;
+}
+
+// Handles one of a line's ';' separated commands, updating path, the short
+// form of the nodes later commands in the line are relative to. Returns 0 if
+// the header is undefined.
+static int scpi_command(char *command, char *path) {
+	while(*command == ' ')
+		command++;
+	if(*command == 0)
+		return 1;
+
+	char *header = strsep(&command, " ");
+	char key[SCPI_HEADER_MAX];
+	if(header[0] == ':') {
+		path[0] = 0;
+		header++;
+	}
+	strcpy(key, (header[0] == '*')?"":path);
+	if(!scpi_short_header(header, key))
+		return 0;
+
+	const scpi_def *def = scpi_lookup(key, strlen(key));
+	if(def == NULL || !scpi_matches(header, def->form))
+		return 0;
+	if(header[0] != '*') {
+		char *last = strrchr(key, ':');
+		int length = (last == NULL)?0:last + 1 - key;
+		memcpy(path, key, length);
+		path[length] = 0;
+	}
+
+	while(command != NULL && *command == ' ')
+		command++;
+	def->handler((command == NULL || *command == 0)?NULL:command);
+	return 1;
+}
+
+// Handles a line of SCPI commands. Returns 0, having done nothing, if the
+// first header is undefined, so the line can be answered as an unknown text
+// protocol command instead.
+int scpi_handle(char *line) {
+	char path[SCPI_HEADER_MAX] = "";
+	char *command;
+
+	replied = 0;
+	for(int first = 1; (command = strsep(&line, ";")) != NULL; first = 0) {
+		if(!scpi_command(command, path)) {
+			if(first)
+				return 0;
+			scpi_push_error(SCPI_ERROR_UNDEFINED_HEADER);
+		}
+	}
+	if(replied)
+		uart_puts("\r\n");
+	return 1;
+}
+
+// Parses a quantity parameter for a setting, queuing an error if it's bad
+static int scpi_parameter(const char *args, char quantity, int32 *value) {
+	if(args == NULL) {
+		scpi_push_error(SCPI_ERROR_MISSING_PARAMETER);
+		return 0;
+	}
+	if(!parse_quantity(args, quantity, value) || *value < 0) {
+		scpi_push_error(SCPI_ERROR_ILLEGAL_VALUE);
+		return 0;
+	}
+	return 1;
+}
+
+void scpi_idn(char *args) {
+	char response[48];
+	format(response, "Arachnid Labs,Reload Pro,%08x%08x,%s",
+		CY_GET_REG32(CYREG_SFLASH_DIE_LOT0), CY_GET_REG32(CYREG_SFLASH_DIE_X), FIRMWARE_VERSION);
+	scpi_reply(response);
+}
+
+void scpi_rst(char *args) {
+	set_load_mode(LOAD_MODE_CC);
+	set_current(0);
+}
+
+void scpi_cls(char *args) {
+	error_count = 0;
+}
+
+void scpi_opc(char *args) {
+	// Commands complete before the next is read
+	scpi_reply("1");
+}
+
+void scpi_measure_current(char *args) {
+	measurement m;
+	get_measurement(&m);
+	scpi_reply_fixed(m.current, 6);
+}
+
+void scpi_measure_voltage(char *args) {
+	measurement m;
+	get_measurement(&m);
+	scpi_reply_fixed(m.voltage, 6);
+}
+
+void scpi_measure_power(char *args) {
+	measurement m;
+	get_measurement(&m);
+	scpi_reply_fixed(power_from(m.current, m.voltage), 6);
+}
+
+// Setting a level selects its mode, as FUNC would
+void scpi_current(char *args) {
+	int32 value;
+	if(scpi_parameter(args, 'a', &value))
+		set_load_target(LOAD_MODE_CC, value);
+}
+
+void scpi_current_query(char *args) {
+	scpi_reply_fixed(state.current_setpoint, 6);
+}
+
+void scpi_voltage(char *args) {
+	int32 value;
+	if(scpi_parameter(args, 'v', &value))
+		set_load_target(LOAD_MODE_CV, value);
+}
+
+void scpi_voltage_query(char *args) {
+	scpi_reply_fixed(get_voltage_target(), 6);
+}
+
+void scpi_resistance(char *args) {
+	int32 value;
+	if(scpi_parameter(args, 'r', &value))
+		set_load_target(LOAD_MODE_CR, value);
+}
+
+void scpi_resistance_query(char *args) {
+	scpi_reply_fixed(get_resistance_target(), 3);
+}
+
+void scpi_power(char *args) {
+	int32 value;
+	if(scpi_parameter(args, 'w', &value))
+		set_load_target(LOAD_MODE_CP, value);
+}
+
+void scpi_power_query(char *args) {
+	scpi_reply_fixed(get_power_target(), 3);
+}
+
+// In load_mode order
+static const char *const function_forms[] = {"CURRent", "VOLTage", "RESistance", "POWer", "PULSe"};
+
+void scpi_function(char *args) {
+	if(args == NULL) {
+		scpi_push_error(SCPI_ERROR_MISSING_PARAMETER);
+		return;
+	}
+	// Pulse mode needs its configuration, so is only reported
+	for(int mode = LOAD_MODE_CC; mode < LOAD_MODE_PULSE; mode++) {
+		if(scpi_mnemonic_matches(args, strlen(args), function_forms[mode], strlen(function_forms[mode]))) {
+			set_load_mode(mode);
+			return;
+		}
+	}
+	scpi_push_error(SCPI_ERROR_ILLEGAL_VALUE);
+}
+
+void scpi_function_query(char *args) {
+	char response[8];
+	const char *form = function_forms[get_load_mode()];
+	int length = 0;
+	while(form[length] >= 'A' && form[length] <= 'Z') {
+		response[length] = form[length];
+		length++;
+	}
+	response[length] = 0;
+	scpi_reply(response);
+}
+
+void scpi_input(char *args) {
+	if(args == NULL) {
+		scpi_push_error(SCPI_ERROR_MISSING_PARAMETER);
+	} else if(strcmp(args, "1") == 0 || scpi_mnemonic_matches(args, strlen(args), "ON", 2)) {
+		output_on();
+	} else if(strcmp(args, "0") == 0 || scpi_mnemonic_matches(args, strlen(args), "OFF", 3)) {
+		output_off();
+	} else {
+		scpi_push_error(SCPI_ERROR_ILLEGAL_VALUE);
+	}
+}
+
+void scpi_input_query(char *args) {
+	scpi_reply((get_output_mode() == OUTPUT_MODE_OFF)?"0":"1");
+}
+
+void scpi_error_query(char *args) {
+	char response[32];
+	scpi_error error = SCPI_ERROR_NONE;
+	if(error_count > 0) {
+		error = errors[0];
+		memmove(errors, errors + 1, --error_count);
+	}
+	format(response, "%d,\"%s\"", scpi_errors[error].code, scpi_errors[error].message);
+	scpi_reply(response);
+}
+
+void scpi_version_query(char *args) {
+	scpi_reply("1999.0");
+}
+
+#else
+
+int scpi_handle(char *line) {
+	return 0;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,262 @@
+/* ANSI-C code produced by gperf version 3.0.4 */
+/* Command-line: gperf -m 100 tools/scpi_keywords  */
+/* Computed positions: -k'2,3,7' */
+
+#if !((' ' == 32) && ('!' == 33) && ('"' == 34) && ('#' == 35) \
+      && ('%' == 37) && ('&' == 38) && ('\'' == 39) && ('(' == 40) \
+      && (')' == 41) && ('*' == 42) && ('+' == 43) && (',' == 44) \
+      && ('-' == 45) && ('.' == 46) && ('/' == 47) && ('0' == 48) \
+      && ('1' == 49) && ('2' == 50) && ('3' == 51) && ('4' == 52) \
+      && ('5' == 53) && ('6' == 54) && ('7' == 55) && ('8' == 56) \
+      && ('9' == 57) && (':' == 58) && (';' == 59) && ('<' == 60) \
+      && ('=' == 61) && ('>' == 62) && ('?' == 63) && ('A' == 65) \
+      && ('B' == 66) && ('C' == 67) && ('D' == 68) && ('E' == 69) \
+      && ('F' == 70) && ('G' == 71) && ('H' == 72) && ('I' == 73) \
+      && ('J' == 74) && ('K' == 75) && ('L' == 76) && ('M' == 77) \
+      && ('N' == 78) && ('O' == 79) && ('P' == 80) && ('Q' == 81) \
+      && ('R' == 82) && ('S' == 83) && ('T' == 84) && ('U' == 85) \
+      && ('V' == 86) && ('W' == 87) && ('X' == 88) && ('Y' == 89) \
+      && ('Z' == 90) && ('[' == 91) && ('\\' == 92) && (']' == 93) \
+      && ('^' == 94) && ('_' == 95) && ('a' == 97) && ('b' == 98) \
+      && ('c' == 99) && ('d' == 100) && ('e' == 101) && ('f' == 102) \
+      && ('g' == 103) && ('h' == 104) && ('i' == 105) && ('j' == 106) \
+      && ('k' == 107) && ('l' == 108) && ('m' == 109) && ('n' == 110) \
+      && ('o' == 111) && ('p' == 112) && ('q' == 113) && ('r' == 114) \
+      && ('s' == 115) && ('t' == 116) && ('u' == 117) && ('v' == 118) \
+      && ('w' == 119) && ('x' == 120) && ('y' == 121) && ('z' == 122) \
+      && ('{' == 123) && ('|' == 124) && ('}' == 125) && ('~' == 126))
+/* The character set is not based on ISO-646.  */
+#error "gperf generated tables don't work with this execution character set. Please report a bug to <bug-gnu-gperf@gnu.org>."
+#endif
+
+#line 1 "tools/scpi_keywords"
+
+typedef void (*scpi_func)(char *args);
+
+// name is the header's short form in upper case, as looked up; form is the
+// SCPI form, short part in upper case, that long mnemonics are checked against
+typedef struct scpi_def {
+    const char *name;
+    const char *form;
+    scpi_func handler;
+} scpi_def;
+
+void scpi_idn(char *);
+void scpi_rst(char *);
+void scpi_cls(char *);
+void scpi_opc(char *);
+void scpi_measure_current(char *);
+void scpi_measure_voltage(char *);
+void scpi_measure_power(char *);
+void scpi_current(char *);
+void scpi_current_query(char *);
+void scpi_voltage(char *);
+void scpi_voltage_query(char *);
+void scpi_resistance(char *);
+void scpi_resistance_query(char *);
+void scpi_power(char *);
+void scpi_power_query(char *);
+void scpi_function(char *);
+void scpi_function_query(char *);
+void scpi_input(char *);
+void scpi_input_query(char *);
+void scpi_error_query(char *);
+void scpi_version_query(char *);
+#line 34 "tools/scpi_keywords"
+struct scpi_def;
+#include <string.h>
+
+#define TOTAL_KEYWORDS 21
+#define MIN_WORD_LENGTH 3
+#define MAX_WORD_LENGTH 10
+#define MIN_HASH_VALUE 8
+#define MAX_HASH_VALUE 29
+/* maximum key range = 22, duplicates = 0 */
+
+#if (defined (__STDC_VERSION__) && __STDC_VERSION__ >= 199901L) || defined(__cplusplus) || defined(__GNUC_STDC_INLINE__)
+inline
+#elif defined(__GNUC__)
+__inline
+#endif
+static unsigned int
+scpi_hash (register const char *str, register unsigned int len)
+{
+  static const unsigned char asso_values[] =
+    {
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30,  0, 30,  7,  1, 13,
+     30, 30, 30, 16, 30, 30, 15, 30,  0,  5,
+     11, 30,  9,  0, 30,  6, 30,  0, 30,  0,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30
+    };
+  register int hval = len;
+
+  switch (hval)
+    {
+      default:
+        hval += asso_values[(unsigned char)str[6]];
+      /*FALLTHROUGH*/
+      case 6:
+      case 5:
+      case 4:
+      case 3:
+        hval += asso_values[(unsigned char)str[2]];
+      /*FALLTHROUGH*/
+      case 2:
+        hval += asso_values[(unsigned char)str[1]];
+      /*FALLTHROUGH*/
+      case 1:
+        break;
+    }
+  return hval;
+}
+
+#ifdef __GNUC__
+__inline
+#if defined __GNUC_STDC_INLINE__ || defined __GNUC_GNU_INLINE__
+__attribute__ ((__gnu_inline__))
+#endif
+#endif
+const struct scpi_def *
+scpi_lookup (register const char *str, register unsigned int len)
+{
+  static const struct scpi_def wordlist[] =
+    {
+#line 57 "tools/scpi_keywords"
+      {"POW","POWer",scpi_power},
+#line 58 "tools/scpi_keywords"
+      {"POW?","POWer?",scpi_power_query},
+#line 59 "tools/scpi_keywords"
+      {"FUNC","FUNCtion",scpi_function},
+#line 60 "tools/scpi_keywords"
+      {"FUNC?","FUNCtion?",scpi_function_query},
+#line 45 "tools/scpi_keywords"
+      {"*RST","*RST",scpi_rst},
+#line 61 "tools/scpi_keywords"
+      {"INP","INPut",scpi_input},
+#line 62 "tools/scpi_keywords"
+      {"INP?","INPut?",scpi_input_query},
+#line 55 "tools/scpi_keywords"
+      {"RES","RESistance",scpi_resistance},
+#line 56 "tools/scpi_keywords"
+      {"RES?","RESistance?",scpi_resistance_query},
+#line 63 "tools/scpi_keywords"
+      {"SYST:ERR?","SYSTem:ERRor?",scpi_error_query},
+#line 51 "tools/scpi_keywords"
+      {"CURR","CURRent",scpi_current},
+#line 52 "tools/scpi_keywords"
+      {"CURR?","CURRent?",scpi_current_query},
+#line 47 "tools/scpi_keywords"
+      {"*OPC?","*OPC?",scpi_opc},
+#line 44 "tools/scpi_keywords"
+      {"*IDN?","*IDN?",scpi_idn},
+#line 64 "tools/scpi_keywords"
+      {"SYST:VERS?","SYSTem:VERSion?",scpi_version_query},
+#line 53 "tools/scpi_keywords"
+      {"VOLT","VOLTage",scpi_voltage},
+#line 54 "tools/scpi_keywords"
+      {"VOLT?","VOLTage?",scpi_voltage_query},
+#line 46 "tools/scpi_keywords"
+      {"*CLS","*CLS",scpi_cls},
+#line 50 "tools/scpi_keywords"
+      {"MEAS:POW?","MEASure:POWer?",scpi_measure_power},
+#line 49 "tools/scpi_keywords"
+      {"MEAS:VOLT?","MEASure:VOLTage?",scpi_measure_voltage},
+#line 48 "tools/scpi_keywords"
+      {"MEAS:CURR?","MEASure:CURRent?",scpi_measure_current}
+    };
+
+  if (len <= MAX_WORD_LENGTH && len >= MIN_WORD_LENGTH)
+    {
+      register int key = scpi_hash (str, len);
+
+      if (key <= MAX_HASH_VALUE && key >= MIN_HASH_VALUE)
+        {
+          register const struct scpi_def *resword;
+
+          switch (key - 8)
+            {
+              case 0:
+                resword = &wordlist[0];
+                goto compare;
+              case 1:
+                resword = &wordlist[1];
+                goto compare;
+              case 2:
+                resword = &wordlist[2];
+                goto compare;
+              case 3:
+                resword = &wordlist[3];
+                goto compare;
+              case 5:
+                resword = &wordlist[4];
+                goto compare;
+              case 6:
+                resword = &wordlist[5];
+                goto compare;
+              case 7:
+                resword = &wordlist[6];
+                goto compare;
+              case 8:
+                resword = &wordlist[7];
+                goto compare;
+              case 9:
+                resword = &wordlist[8];
+                goto compare;
+              case 10:
+                resword = &wordlist[9];
+                goto compare;
+              case 11:
+                resword = &wordlist[10];
+                goto compare;
+              case 12:
+                resword = &wordlist[11];
+                goto compare;
+              case 13:
+                resword = &wordlist[12];
+                goto compare;
+              case 14:
+                resword = &wordlist[13];
+                goto compare;
+              case 15:
+                resword = &wordlist[14];
+                goto compare;
+              case 16:
+                resword = &wordlist[15];
+                goto compare;
+              case 17:
+                resword = &wordlist[16];
+                goto compare;
+              case 18:
+                resword = &wordlist[17];
+                goto compare;
+              case 19:
+                resword = &wordlist[18];
+                goto compare;
+              case 20:
+                resword = &wordlist[19];
+                goto compare;
+              case 21:
+                resword = &wordlist[20];
+                goto compare;
+            }
+          return 0;
+        compare:
+          {
+            register const char *s = resword->name;
+
+            if (*str == *s && !strcmp (str + 1, s + 1))
+              return resword;
+          }
+        }
+    }
+  return 0;
+}
@@ -0,0 +1,58 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "config.h"
+
+// The buffer scratch_t's tables share, as big as the biggest of them rather
+// than all of them together. The owner changes only from the tasks, and the
+// old owner is stopped first, so the ADC task, which fills most of the tables
+// and preempts everything else that claims, has finished with it by the time
+// the new owner starts writing.
+
+scratch_t scratch;
+static volatile uint8 owner = SCRATCH_NONE;
+
+// Makes the buffer owner's. Whatever the last owner left is still in it, so
+// owners set up their own tables; they keep their lengths apart from it.
+void scratch_claim(scratch_owner new_owner) {
+	if(owner == new_owner)
+		return;
+
+	switch(owner) {
+	case SCRATCH_SEQUENCE:
+		sequence_stop();
+		break;
+	case SCRATCH_SWEEP:
+		sweep_stop();
+		break;
+	case SCRATCH_IMPEDANCE:
+		impedance_stop();
+		break;
+	case SCRATCH_LOADREG:
+		loadreg_stop();
+		break;
+	case SCRATCH_BATTERY:
+		battery_stop();
+		break;
+	default:
+		// A calibration session has nothing running
+		break;
+	}
+	owner = new_owner;
+}
+
+int scratch_owned(scratch_owner check) {
+	return owner == check;
+}
+
+/* [] END OF FILE */
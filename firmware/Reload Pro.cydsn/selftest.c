@@ -0,0 +1,128 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <stdlib.h>
+#include "project.h"
+#include "config.h"
+
+// Power on self test. main() runs it once the IDACs and opamp are started and
+// before the ADC ISR takes over the SAR, and 'selftest' runs it again on
+// demand. Each check records a value for 'debug', and any failure keeps the
+// output off until a run passes or the result is overridden. The display is
+// checked separately, whenever it's powered up; until then it counts as passed.
+
+static uint8 failures = 0;
+static uint8 overridden = 0;
+static int16 values[SELFTEST_COUNT];
+static uint32 elapsed = 0;
+
+static void record(uint8 *mask, selftest_check check, int16 value, int pass) {
+	values[check] = value;
+	if(!pass)
+		*mask |= 1 << check;
+}
+
+// Programs setpoint with the gate held off and returns how far current set
+// reads from where the calibration puts it, in counts
+static int16 dac_error(int setpoint, int *tolerance) {
+	set_current(setpoint);
+	read_current_set(); // One scan to settle
+	int16 expected = current_to_raw(setpoint);
+	*tolerance = (abs(expected) * SELFTEST_DAC_TOLERANCE) / 100 + SELFTEST_DAC_SLACK;
+	return read_current_set() - expected;
+}
+
+// Returns the mask of failed checks. Leaves the setpoint at zero, and the
+// output in feedback if everything passed or off if not. The SAR must already
+// be converting.
+uint8 selftest_run() {
+	uint8 mask = failures & (1 << SELFTEST_DISPLAY);
+	uint32 start = get_time_us();
+	int slew_rate = get_slew_rate();
+	int tolerance;
+	int16 error, gate, fet;
+
+	// Nothing is known until this run finishes; clearing the last result lets
+	// the loop check below turn feedback on
+	failures = 0;
+	overridden = 0;
+	set_slew_rate(0);
+
+	set_output_mode(OUTPUT_MODE_OFF);
+	read_current_set();
+	gate = ADC_GetResult16(ADC_CHAN_OPAMP_OUT);
+	fet = ADC_GetResult16(ADC_CHAN_FET_IN);
+	record(&mask, SELFTEST_FET, (gate > fet)?gate:fet,
+		gate < SELFTEST_FET_OFF_LIMIT && fet < SELFTEST_FET_OFF_LIMIT);
+
+	error = dac_error(SELFTEST_DAC_LOW_CURRENT, &tolerance);
+	record(&mask, SELFTEST_DAC_LOW, error, abs(error) <= tolerance);
+	error = dac_error(SELFTEST_DAC_HIGH_CURRENT, &tolerance);
+	record(&mask, SELFTEST_DAC_HIGH, error, abs(error) <= tolerance);
+	set_current(0);
+
+	// With no setpoint the opamp should sit low, and the gate follow it
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	read_current_set();
+	read_current_set();
+	gate = ADC_GetResult16(ADC_CHAN_OPAMP_OUT);
+	fet = ADC_GetResult16(ADC_CHAN_FET_IN);
+	record(&mask, SELFTEST_OPAMP, gate,
+		gate < get_opamp_trip_limit() && abs(gate - fet) <= SELFTEST_FET_TRACK_LIMIT);
+
+	set_slew_rate(slew_rate);
+	elapsed = get_time_us() - start;
+	failures = mask;
+	if(failures)
+		set_output_mode(OUTPUT_MODE_OFF);
+	return failures;
+}
+
+// Runs once the display has been powered up. It can't be read back, so this
+// only checks that the SPI master finishes sending; a stuck bus never does.
+void selftest_check_display() {
+	uint32 start = get_time_us();
+	int idle;
+	while(!(idle = Display_SPI_GetTxBufferSize() == 0 && (Display_SPI_ReadTxStatus() & Display_SPI_STS_SPI_IDLE))
+	      && get_time_us() - start < SELFTEST_DISPLAY_TIMEOUT_US);
+	values[SELFTEST_DISPLAY] = idle;
+	if(idle) {
+		failures &= ~(1 << SELFTEST_DISPLAY);
+	} else {
+		failures |= 1 << SELFTEST_DISPLAY;
+		set_output_mode(OUTPUT_MODE_OFF);
+	}
+}
+
+uint8 selftest_failures() {
+	return failures;
+}
+
+int16 selftest_value(selftest_check check) {
+	return values[check];
+}
+
+// Microseconds the last selftest_run took
+uint32 selftest_time() {
+	return elapsed;
+}
+
+// Allows the output on despite the failures, until the next run
+void selftest_override() {
+	overridden = 1;
+}
+
+int selftest_passed() {
+	return failures == 0 || overridden;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,412 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <string.h>
+#include "tasks.h"
+#include "config.h"
+
+// Load profile sequencer. Steps are uploaded over serial into RAM and played
+// back from the timestamp alarm, so step edges land within interrupt latency
+// of their scheduled time. Each edge is scheduled from the previous edge's
+// scheduled time rather than the time the ISR ran, so errors don't accumulate.
+//
+// A step can also end on a condition, a threshold on the readings or the
+// charge or energy drawn since it started, which the ADC task checks against
+// every block's mean, so a step ends within a couple of blocks of it rather
+// than at the UI's refresh rate. Its duration is then the timeout. Jumps with
+// a count make loops: "2A until below 3V, then rest for a minute and go back",
+// which a fixed duration can't express.
+//
+// Each step's last run is kept as a result: the extremes and mean of every
+// scan in it, the charge and energy it drew, how long it ran and what ended
+// it. The ISRs that end steps only note how; the ADC task gathers the rest
+// at the next block, so a step shorter than a block can go uncounted. The
+// results table is in the shared scratch buffer, claimed at each start.
+// Only in builds with USE_SEQUENCE defined.
+
+#ifdef USE_SEQUENCE
+
+xQueueHandle sequence_log_queue;
+
+static sequence_step steps[SEQUENCE_MAX_STEPS];
+static uint8 step_count = 0;
+static volatile int8 current_step = -1;
+static int loops_remaining; // 0 repeats forever
+static uint32 step_started; // Scheduled time of the current step's edge
+static uint8 jumps_left[SEQUENCE_MAX_STEPS];
+static volatile uint8 steps_begun; // Counts step edges, so a jump to the same step is seen
+
+// The ADC task's view of the step whose condition it's checking
+static uint8 until_begun;
+static uint8 blocks_met;
+static energy_totals until_base;
+
+// The last step end the ISRs saw, and the results the ADC task made of them
+static volatile uint8 steps_ended;
+static int8 ended_step;
+static uint8 ended_how;
+static uint32 ended_elapsed;	// Microseconds
+static volatile uint8 results_reset_due;
+static uint8 results_seen;
+static energy_totals result_base;
+
+// With interrupts off or from an ISR, before the next step begins
+static void note_end(uint32 when, sequence_end how) {
+	ended_step = current_step;
+	ended_how = how;
+	ended_elapsed = when - step_started;
+	steps_ended++;
+}
+
+static void log_boundary(uint32 when) {
+	sequence_log_entry entry = {
+		.timestamp = when,
+		.current = get_current_usage_fast(),
+		.voltage = get_voltage_fast(),
+		.step = current_step,
+	};
+
+	// Telling the comms task is left to the ADC task, which retries until the
+	// event gets through
+	portBASE_TYPE woken = pdFALSE;
+	if(xQueueSendToBackFromISR(sequence_log_queue, &entry, &woken) == pdPASS)
+		defer_post(DEFER_SEQUENCE_LOG);
+	portEND_SWITCHING_ISR(woken);
+}
+
+static void next_step(uint32 when);
+
+static void begin_step(int8 step, uint32 when) {
+	current_step = step;
+	step_started = when;
+	steps_begun++;
+	set_load_target(steps[step].mode, steps[step].setpoint);
+	set_alarm(when + steps[step].duration * 1000, next_step);
+}
+
+// Moves on from the current step at when, ended by its duration, its
+// condition or a trigger. Runs from an ISR, or from sequence_block() with
+// interrupts off.
+static void end_step(uint32 when, sequence_end how) {
+	int met = (how == SEQUENCE_END_CONDITION);
+	log_boundary(when);
+	note_end(when, how);
+
+	const sequence_step *current = &steps[current_step];
+	int8 step = current_step + 1;
+	if(current->jump >= 0 && met == (current->until != SEQUENCE_UNTIL_NONE)) {
+		if(current->jumps == 0) {
+			step = current->jump;
+		} else if(jumps_left[current_step] > 0) {
+			jumps_left[current_step]--;
+			step = current->jump;
+		} else {
+			// Ready for the next time an outer loop comes round
+			jumps_left[current_step] = current->jumps;
+		}
+	}
+
+	if(step >= step_count) {
+		if(loops_remaining == 1) {
+			current_step = -1;
+			set_load_mode(LOAD_MODE_CC);
+			set_current(0);
+			return;
+		}
+		if(loops_remaining > 1)
+			loops_remaining--;
+		step = 0;
+	}
+
+	begin_step(step, when);
+	trigger_output_pulse();
+}
+
+// Runs from the timestamp ISR at each step boundary
+static void next_step(uint32 when) {
+	end_step(when, SEQUENCE_END_DURATION);
+}
+
+static void start_at(int8 step, int loops, uint32 started) {
+	sequence_stop();
+	scratch_claim(SCRATCH_SEQUENCE);
+	results_reset_due = 1;
+
+	loops_remaining = loops;
+	for(uint8 i = 0; i < step_count; i++)
+		jumps_left[i] = steps[i].jumps;
+	begin_step(step, started);
+}
+
+// Every jump lands on a step that exists
+static int jumps_valid() {
+	for(uint8 i = 0; i < step_count; i++)
+		if(steps[i].jump >= step_count)
+			return 0;
+	return 1;
+}
+
+void sequence_clear() {
+	sequence_stop();
+	step_count = 0;
+}
+
+int sequence_add(const sequence_step *step) {
+	if(current_step >= 0 || step_count >= SEQUENCE_MAX_STEPS)
+		return 0;
+	if(step->mode > LOAD_MODE_CP || step->duration == 0 || step->duration > SEQUENCE_MAX_DURATION)
+		return 0;
+	if(step->until >= SEQUENCE_UNTIL_MAX || step->jump >= SEQUENCE_MAX_STEPS || step->jump < -1)
+		return 0;
+	steps[step_count++] = *step;
+	return 1;
+}
+
+int sequence_start(int loops) {
+	if(step_count == 0 || loops < 0 || !jumps_valid())
+		return 0;
+	start_at(0, loops, get_time_us());
+	return 1;
+}
+
+// Picks up elapsed milliseconds into step, as a power fail snapshot left it
+int sequence_resume(int step, int loops, uint32 elapsed) {
+	if(step < 0 || step >= step_count || loops < 0 || !jumps_valid())
+		return 0;
+	if(elapsed > steps[step].duration)
+		elapsed = steps[step].duration;
+	start_at(step, loops, get_time_us() - elapsed * 1000);
+	return 1;
+}
+
+void sequence_stop() {
+	uint8 int_state = CyEnterCriticalSection();
+	if(current_step >= 0) {
+		cancel_alarm();
+		note_end(get_time_us(), SEQUENCE_END_STOP);
+		current_step = -1;
+	}
+	CyExitCriticalSection(int_state);
+}
+
+// Starts the next step now rather than when the current one runs out. Called
+// from the trigger ISR.
+void sequence_next_step() {
+	if(current_step < 0)
+		return;
+	cancel_alarm();
+	end_step(get_time_us(), SEQUENCE_END_TRIGGER);
+}
+
+// Starts step now, the current step ending there as a jump would take it, for
+// a limit watch. An idle sequencer starts at step and plays through once.
+// Called by the ADC task.
+int sequence_jump(int step) {
+	if(step < 0 || step >= step_count)
+		return 0;
+	if(current_step < 0)
+		return sequence_resume(step, 1, 0);
+
+	uint8 int_state = CyEnterCriticalSection();
+	if(current_step >= 0) {
+		uint32 now = get_time_us();
+		cancel_alarm();
+		log_boundary(now);
+		note_end(now, SEQUENCE_END_WATCH);
+		begin_step(step, now);
+		trigger_output_pulse();
+	}
+	CyExitCriticalSection(int_state);
+	return 1;
+}
+
+// Makes a result of the last step end, or empties the table for a new start
+static void keep_result() {
+	energy_totals totals;
+	raw_statistics stats[FILTER_CHANNELS];
+	get_energy_totals(&totals);
+	take_step_statistics(stats);
+
+	uint8 int_state = CyEnterCriticalSection();
+	uint8 ended = steps_ended;
+	int8 step = ended_step;
+	uint8 how = ended_how;
+	uint32 elapsed = ended_elapsed;
+	uint8 reset = results_reset_due;
+	results_reset_due = 0;
+	CyExitCriticalSection(int_state);
+
+	if(!scratch_owned(SCRATCH_SEQUENCE)) {
+		// Another test has the table
+	} else if(reset) {
+		memset(scratch.sequence, 0, sizeof(scratch.sequence));
+	} else if(step >= 0) {
+		sequence_result *r = &scratch.sequence[step];
+		memcpy(r->channel, stats, sizeof(stats));
+		r->charge = totals.charge - result_base.charge;
+		r->energy = totals.energy - result_base.energy;
+		r->duration = div1000(elapsed);
+		r->end = how;
+		if(r->runs < 255)
+			r->runs++;
+	}
+	results_seen = ended;
+	result_base = totals;
+}
+
+// Called by the ADC task with each block's means. A condition must hold for
+// SEQUENCE_UNTIL_BLOCKS blocks in a row, so one noisy block can't end a step.
+void sequence_block(const int16 *mean) {
+	if(results_reset_due || results_seen != steps_ended)
+		keep_result();
+
+	int8 step = current_step;
+	if(step < 0 || steps[step].until == SEQUENCE_UNTIL_NONE)
+		return;
+	if(until_begun != steps_begun) {
+		until_begun = steps_begun;
+		blocks_met = 0;
+		get_energy_totals(&until_base);
+	}
+
+	const sequence_step *s = &steps[step];
+	energy_totals totals;
+	int32 value;
+	switch(s->until) {
+	case SEQUENCE_UNTIL_VOLTAGE_BELOW:
+	case SEQUENCE_UNTIL_VOLTAGE_ABOVE:
+		value = voltage_from_raw(mean[FILTER_VOLTAGE]);
+		break;
+	case SEQUENCE_UNTIL_CURRENT_BELOW:
+	case SEQUENCE_UNTIL_CURRENT_ABOVE:
+		value = current_from_raw(mean[FILTER_CURRENT]);
+		break;
+	case SEQUENCE_UNTIL_POWER_BELOW:
+	case SEQUENCE_UNTIL_POWER_ABOVE:
+		value = power_from(current_from_raw(mean[FILTER_CURRENT]), voltage_from_raw(mean[FILTER_VOLTAGE]));
+		break;
+	case SEQUENCE_UNTIL_CHARGE:
+		get_energy_totals(&totals);
+		value = totals.charge - until_base.charge;
+		break;
+	default:
+		get_energy_totals(&totals);
+		value = totals.energy - until_base.energy;
+		break;
+	}
+
+	int below = s->until == SEQUENCE_UNTIL_VOLTAGE_BELOW || s->until == SEQUENCE_UNTIL_CURRENT_BELOW
+		|| s->until == SEQUENCE_UNTIL_POWER_BELOW;
+	if(below?(value >= s->threshold):(value < s->threshold)) {
+		blocks_met = 0;
+		return;
+	}
+	if(++blocks_met < SEQUENCE_UNTIL_BLOCKS)
+		return;
+
+	// The alarm or a trigger may have moved the step on since this block
+	uint8 int_state = CyEnterCriticalSection();
+	if(current_step == step && steps_begun == until_begun) {
+		cancel_alarm();
+		end_step(get_time_us(), SEQUENCE_END_CONDITION);
+	}
+	CyExitCriticalSection(int_state);
+}
+
+int get_sequence_length() {
+	return step_count;
+}
+
+// The step being played, or -1 if the sequencer is idle
+int get_sequence_step() {
+	return current_step;
+}
+
+int get_sequence_loops() {
+	return loops_remaining;
+}
+
+// Milliseconds since the current step started
+uint32 get_sequence_step_elapsed() {
+	return (current_step < 0)?0:div1000(get_time_us() - step_started);
+}
+
+const sequence_step *get_sequence_steps() {
+	return steps;
+}
+
+// By step, since the sequence last started; a step that hasn't ended has no
+// runs. NULL once another test has claimed the table.
+const sequence_result *get_sequence_results() {
+	return scratch_owned(SCRATCH_SEQUENCE)?scratch.sequence:NULL;
+}
+
+#else
+
+void sequence_clear() {
+}
+
+int sequence_add(const sequence_step *step) {
+	return 0;
+}
+
+int sequence_start(int loops) {
+	return 0;
+}
+
+int sequence_resume(int step, int loops, uint32 elapsed) {
+	return 0;
+}
+
+void sequence_stop() {
+}
+
+void sequence_next_step() {
+}
+
+int sequence_jump(int step) {
+	return 0;
+}
+
+void sequence_block(const int16 *mean) {
+}
+
+int get_sequence_length() {
+	return 0;
+}
+
+int get_sequence_step() {
+	return -1;
+}
+
+int get_sequence_loops() {
+	return 0;
+}
+
+uint32 get_sequence_step_elapsed() {
+	return 0;
+}
+
+const sequence_step *get_sequence_steps() {
+	return NULL;
+}
+
+const sequence_result *get_sequence_results() {
+	return NULL;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,111 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <string.h>
+#include "config.h"
+
+// Settings live in RAM, so changes take effect at once and readers never go to
+// flash. A change is saved SETTINGS_SAVE_DELAY after the last one, so a run of
+// adjustments costs a single row write. Each save goes to the next of
+// SETTINGS_ROWS flash rows in turn, wearing them evenly, with a sequence number
+// and CRC. At boot the newest valid row wins, so a reset during a write loses
+// only that write; with no valid row the defaults are used.
+
+typedef struct {
+	uint32 sequence;	// 0 in a row that has never been written
+	uint16 version;		// SETTINGS_VERSION when written
+	uint16 crc;			// Over version and data
+	settings_t data;
+	uint8 padding[CY_FLASH_SIZEOF_ROW - 8 - sizeof(settings_t)];
+} settings_row;
+
+static const volatile settings_row settings_area[SETTINGS_ROWS] CY_SECTION(".rodata.settings") CY_ALIGN(CY_FLASH_SIZEOF_ROW);
+
+static settings_t current;
+const settings_t *settings = &current;
+
+static uint8 next_row = 0;
+static uint32 last_sequence = 0;
+static uint8 dirty = 0;
+static portTickType save_due;
+
+static uint16 row_crc(const settings_row *row) {
+	uint16 crc = crc16_update(0xFFFF, (const uint8*)&row->version, sizeof(row->version));
+	return crc16_update(crc, (const uint8*)&row->data, sizeof(row->data));
+}
+
+// Loads the newest saved settings, or defaults if none are valid. Called
+// before the scheduler starts.
+void settings_init(const settings_t *defaults) {
+	const settings_row *newest = NULL;
+	for(int i = 0; i < SETTINGS_ROWS; i++) {
+		const settings_row *row = (const settings_row*)&settings_area[i];
+		if(row->sequence != 0 && row->sequence > last_sequence && row->version == SETTINGS_VERSION && row->crc == row_crc(row)) {
+			newest = row;
+			last_sequence = row->sequence;
+			next_row = (i + 1) % SETTINGS_ROWS;
+		}
+	}
+	memcpy(&current, (newest != NULL)?&newest->data:defaults, sizeof(settings_t));
+}
+
+// Changes len bytes of the settings at field, which points into *settings,
+// and schedules a save
+void settings_write(const void *src, const void *field, int len) {
+	uint8 int_state = CyEnterCriticalSection();
+	memcpy((uint8*)&current + ((const uint8*)field - (const uint8*)&current), src, len);
+	dirty = 1;
+	save_due = xTaskGetTickCount() + SETTINGS_SAVE_DELAY / portTICK_RATE_MS;
+	CyExitCriticalSection(int_state);
+}
+
+// Like settings_write, but the change is for this session only: no save is
+// scheduled, though a later save for some other change will include it
+void settings_write_volatile(const void *src, const void *field, int len) {
+	uint8 int_state = CyEnterCriticalSection();
+	memcpy((uint8*)&current + ((const uint8*)field - (const uint8*)&current), src, len);
+	CyExitCriticalSection(int_state);
+}
+
+// Writes the settings to flash now if anything has changed. The CPU stalls for
+// the row write.
+void settings_save() {
+	settings_row row;
+	memset(&row, 0, sizeof(row));
+
+	uint8 int_state = CyEnterCriticalSection();
+	if(!dirty) {
+		CyExitCriticalSection(int_state);
+		return;
+	}
+	memcpy(&row.data, &current, sizeof(settings_t));
+	dirty = 0;
+	CyExitCriticalSection(int_state);
+
+	row.sequence = ++last_sequence;
+	row.version = SETTINGS_VERSION;
+	row.crc = row_crc(&row);
+	CySysFlashWriteRow(((uint32)&settings_area[next_row] - CYDEV_FLASH_BASE) / CY_FLASH_SIZEOF_ROW, (const uint8*)&row);
+	next_row = (next_row + 1) % SETTINGS_ROWS;
+}
+
+// Called regularly by the UI task; saves once the settings have been left
+// alone for SETTINGS_SAVE_DELAY
+void settings_save_pending() {
+	if(dirty && (portBASE_TYPE)(xTaskGetTickCount() - save_due) >= 0)
+		settings_save();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,192 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include "tasks.h"
+#include "config.h"
+
+// Timed short circuit, for checking a supply's short circuit protection. The
+// gate is driven hard on with OUTPUT_MODE_ON, bypassing the opamp, and the
+// timestamp alarm puts it back in feedback from its ISR once the duration is
+// up, so the length is set by the hardware timer rather than a task. The
+// triggered capture is armed first and fires at the moment the gate goes on,
+// with the pre-trigger part showing the load before it.
+//
+// With the gate forced high the opamp checks would trip at once, so while
+// it's on the gate limit compare is masked and the ADC ISR asks short_scan()
+// instead: every scan's power is held to what the SOA model allowed at the
+// start, and the current to full range, either tripping the output as
+// FAULT_SOA. Undervoltage is expected and doesn't trip. The checks go back to
+// normal a block after the opamp takes over again, when the gate has settled.
+// It arms a triggered capture, so it's only in builds with USE_CAPTURE
+// defined.
+
+#ifdef USE_CAPTURE
+
+static volatile short_state test_state = SHORT_IDLE;
+static uint32 duration;			// Microseconds
+static uint8 countdown;			// Blocks left to fill the capture's history
+static int16 current_offset, voltage_offset;
+static int32 power_limit;		// Product of counts above the offsets
+static int16 current_limit;		// Counts
+static volatile int16 peak_current;	// Counts
+
+static void restore_checks() {
+	ADC_SAR_RANGE_INTR_REG = ADC_SAR_RANGE_INTR_REG;
+	ADC_SAR_RANGE_INTR_MASK_REG = 1 << ADC_CHAN_OPAMP_OUT;
+}
+
+// From the timestamp ISR
+static void short_end(uint32 when) {
+	if(test_state != SHORT_ON)
+		return;
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	test_state = SHORT_RECOVERING;
+}
+
+// Shorts the input for new_duration microseconds, capturing depth samples,
+// pre of them from before. Returns 0 if the duration or capture is out of
+// range, or there's no voltage to short.
+int short_start(int new_duration, int depth, int pre) {
+	if(new_duration < SHORT_MIN_DURATION || new_duration > SHORT_MAX_DURATION || test_state == SHORT_ON)
+		return 0;
+	int voltage = get_voltage();
+	int soa = get_soa_limit();
+	if(voltage < THERMAL_SOA_MIN_VOLTAGE * 1000 || soa <= 0 || !selftest_passed())
+		return 0;
+	if(!capture_start(CAPTURE_TRIGGER_SHORT, 0, depth, pre))
+		return 0;
+
+	test_state = SHORT_IDLE;
+	sequence_stop();
+	battery_stop();
+	sweep_stop();
+	mppt_stop();
+	ir_stop();
+	impedance_stop();
+	ocp_stop();
+	set_load_mode(LOAD_MODE_CC);
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+
+	// The SOA allowance at the present voltage, as a constant power
+	current_offset = settings->adc_current_offset;
+	voltage_offset = settings->adc_voltage_offset;
+	power_limit = (int32)(current_to_raw(soa) - current_offset) * (voltage_to_raw(voltage) - voltage_offset);
+	current_limit = current_to_raw(CURRENT_FULLRANGE_MAX);
+	peak_current = current_offset;
+	duration = new_duration;
+	countdown = (pre + ADC_BLOCK_SCANS - 1) / ADC_BLOCK_SCANS + 1;
+	test_state = SHORT_ARMING;
+	return 1;
+}
+
+// Ends a test early, for 'short stop' and on a trip. A short cut off part
+// way leaves the output off.
+void short_stop() {
+	uint8 int_state = CyEnterCriticalSection();
+	short_state was = test_state;
+	if(was == SHORT_ON) {
+		set_alarm(get_time_us(), NULL);
+		set_output_mode(OUTPUT_MODE_OFF);
+	}
+	if(was != SHORT_IDLE && was != SHORT_DONE)
+		test_state = SHORT_STOPPED;
+	CyExitCriticalSection(int_state);
+	if(was == SHORT_ON || was == SHORT_RECOVERING)
+		restore_checks();
+	if(was == SHORT_ARMING)
+		capture_stop();
+}
+
+// Called by the ADC task with each block
+void short_block() {
+	switch(test_state) {
+	case SHORT_ARMING:
+		if(--countdown > 0)
+			break;
+		ADC_SAR_RANGE_INTR_MASK_REG = 0;
+		uint8 int_state = CyEnterCriticalSection();
+		capture_short_edge();
+		set_output_mode(OUTPUT_MODE_ON);
+		test_state = SHORT_ON;
+		set_alarm(get_time_us() + duration, short_end);
+		CyExitCriticalSection(int_state);
+		break;
+	case SHORT_RECOVERING:
+		restore_checks();
+		test_state = SHORT_DONE;
+		break;
+	default:
+		break;
+	}
+}
+
+// Called by the ADC ISR with each scan: 0 normally, 1 while the gate is
+// forced on or settling afterwards, or 2 if this scan is past the limits
+uint8 short_scan(const int16 *scan) {
+	short_state s = test_state;
+	if(s != SHORT_ON && s != SHORT_RECOVERING)
+		return 0;
+	int16 current = scan[ADC_CHAN_CURRENT_SENSE];
+	if(current > peak_current)
+		peak_current = current;
+	int32 i = current - current_offset, v = scan[ADC_CHAN_VOLTAGE_SENSE] - voltage_offset;
+	if(current >= current_limit || (i > 0 && v > 0 && i * v >= power_limit))
+		return 2;
+	return 1;
+}
+
+short_state get_short_state() {
+	return test_state;
+}
+
+int get_short_duration() {
+	return duration;
+}
+
+// Microamps, the highest single scan since the test started
+int get_short_peak_current() {
+	return current_from_raw(peak_current);
+}
+
+#else
+
+int short_start(int new_duration, int depth, int pre) {
+	return 0;
+}
+
+void short_stop() {
+}
+
+void short_block() {
+}
+
+uint8 short_scan(const int16 *scan) {
+	return 0;
+}
+
+short_state get_short_state() {
+	return SHORT_IDLE;
+}
+
+int get_short_duration() {
+	return 0;
+}
+
+int get_short_peak_current() {
+	return 0;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,281 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "config.h"
+
+// Setpoint slew limiter. When a rate is set, set_current hands its new value
+// here instead of writing the IDACs, and the pulse timer steps the output towards
+// it every SLEW_STEP_US. The timer is otherwise only used by the transient
+// generator, which programs its edges directly and stops any ramp first.
+//
+// The same ramp soft starts the output: output_on() puts the opamp in
+// feedback at zero and ramps up to the setpoint over the ramp time, and
+// output_off() ramps down to zero before the timer ISR turns the output off
+// and puts the setpoint's codes back for next time. A new setpoint part way
+// through abandons either ramp, as it does a slew.
+//
+// The low IDAC's step is a couple of hundred microamps, coarse for standby
+// currents, so with dither on the setpoint's remainder below it is made up
+// on average: the ADC ISR, which paces the control loops, adds one to the low
+// code on that fraction of scans, spread evenly by a first order sigma-delta
+// accumulator. That puts the pattern at the highest rate the scans allow,
+// and the block means, like the load, see the average. Anything else that
+// writes the IDACs directly stops the dither first.
+
+static volatile int slew_output = 0; // Microamps, as last programmed
+static volatile int slew_target = 0;
+static int slew_step = 0; // Microamps per timer period; 0 is off
+static volatile uint8 ramping = 0;
+static volatile int ramp_step = 0; // Overrides slew_step while turning the output on or off
+static volatile int ramp_off_restore = -1; // Setpoint to put back once the output is off; -1 if not turning off
+static uint16 output_ramp = OUTPUT_DEFAULT_RAMP; // Milliseconds
+static uint8 dither_enabled = 0;
+static volatile uint8 dither_fraction = 0; // 256ths of a low code added on average; 0 is not dithering
+static uint8 dither_low; // The low code it's added to
+static uint8 dither_sum, dither_carry;
+
+// Called with interrupts off, so the ADC ISR never sees half an update
+static void write_output(int current) {
+	uint8 high_value, low_value;
+	if(current > 0) {
+		current += get_current_trim();
+		if(current < 0)
+			current = 0;
+	}
+	uint8 fraction = current_to_dac(current, &high_value, &low_value);
+	write_dac(high_value, low_value);
+	dither_low = low_value;
+	dither_carry = 0;
+	dither_fraction = (dither_enabled && get_load_mode() != LOAD_MODE_PULSE)?fraction:0;
+}
+
+static void stop_ramp() {
+	timer_stop(TIMER_COUNTER_PULSE);
+	ramping = 0;
+	ramp_step = 0;
+}
+
+CY_ISR(slew_timer_isr);
+
+static void start_ramp() {
+	ramping = 1;
+	timer_start(TIMER_COUNTER_PULSE, SLEW_STEP_US - 1, TIMER_INTR_TC, slew_timer_isr, IRQ_PRIORITY_CONTROL);
+}
+
+// Runs as a critical section, as the control loop in the ADC ISR can preempt
+// it with a new setpoint. That costs the trip path a few microseconds.
+CY_ISR(slew_timer_isr) {
+	timer_clear_interrupt(TIMER_COUNTER_PULSE, TIMER_INTR_TC);
+
+	uint8 int_state = CyEnterCriticalSection();
+	int output = slew_output, target = slew_target;
+	int step = ramp_step?ramp_step:slew_step;
+	if(target > output + step) {
+		output += step;
+	} else if(target < output - step) {
+		output -= step;
+	} else {
+		output = target;
+	}
+	write_output(output);
+	slew_output = output;
+	if(output != target) {
+		CyExitCriticalSection(int_state);
+		return;
+	}
+
+	stop_ramp();
+	int restore = ramp_off_restore;
+	if(restore >= 0) {
+		ramp_off_restore = -1;
+		set_output_mode(OUTPUT_MODE_OFF);
+		write_output(restore);
+		slew_output = slew_target = restore;
+	}
+	CyExitCriticalSection(int_state);
+}
+
+// Programs the IDACs for current, immediately or as a ramp.
+void slew_to(int current) {
+	uint8 int_state = CyEnterCriticalSection();
+	slew_target = current;
+	int step = slew_step;
+	ramp_off_restore = -1;
+	ramp_step = 0;
+	if(step == 0 || get_load_mode() == LOAD_MODE_PULSE ||
+	   (current <= slew_output + step && current >= slew_output - step)) {
+		if(ramping)
+			stop_ramp();
+		slew_output = current;
+		write_output(current);
+		CyExitCriticalSection(int_state);
+		return;
+	}
+	if(!ramping)
+		start_ramp();
+	CyExitCriticalSection(int_state);
+}
+
+// Abandons any ramp where it is, for the transient generator to take the timer.
+void slew_stop() {
+	uint8 int_state = CyEnterCriticalSection();
+	if(ramping)
+		stop_ramp();
+	slew_target = slew_output;
+	ramp_off_restore = -1;
+	dither_fraction = 0;
+	CyExitCriticalSection(int_state);
+}
+
+// Turns the dither on or off from the next setpoint written
+void set_dither(int enabled) {
+	dither_enabled = enabled;
+	if(!enabled)
+		dither_stop();
+}
+
+int get_dither() {
+	return dither_enabled;
+}
+
+// Leaves the IDACs alone until the next setpoint, for anything that writes
+// them itself. The low code stays where the ISR last put it.
+void dither_stop() {
+	dither_fraction = 0;
+}
+
+// Called by the ADC ISR after every scan
+RAMFUNC void dither_scan() {
+	uint8 fraction = dither_fraction;
+	if(fraction == 0)
+		return;
+	uint16 sum = dither_sum + fraction;
+	dither_sum = sum;
+	uint8 carry = sum >> 8;
+	if(carry != dither_carry) {
+		dither_carry = carry;
+		IDAC_Low_SetValue(dither_low + carry);
+	}
+}
+
+// The dither's average share of a low code now, in 256ths; 0 when it's not
+// dithering
+uint8 get_dither_fraction() {
+	return dither_fraction;
+}
+
+// Rate in microamps per millisecond; 0 turns the limiter off.
+int set_slew_rate(int rate) {
+	if(rate < 0 || rate > SLEW_MAX_RATE)
+		return 0;
+	int step = (rate * SLEW_STEP_US) / 1000;
+	if(rate > 0 && step == 0)
+		return 0;
+	uint8 int_state = CyEnterCriticalSection();
+	slew_step = step;
+	CyExitCriticalSection(int_state);
+	if(step == 0)
+		// Finish any ramp at once
+		slew_to(slew_target);
+	return 1;
+}
+
+int get_slew_rate() {
+	return (slew_step * 1000) / SLEW_STEP_US;
+}
+
+// Whether the output is still on its way to the setpoint, by slew or ramp
+int get_slewing() {
+	return ramping;
+}
+
+// Timer periods' worth of current to cover span in the ramp time, at least 1uA
+static int ramp_step_for(int span) {
+	int step = span / ((output_ramp * 1000) / SLEW_STEP_US);
+	return (step > 0)?step:1;
+}
+
+// Turns the output on, ramping up from zero unless the ramp time is 0
+void output_on() {
+	uint8 int_state = CyEnterCriticalSection();
+	uint8 turning_off = (ramp_off_restore >= 0);
+	if(get_output_mode() == OUTPUT_MODE_FEEDBACK && !turning_off) {
+		CyExitCriticalSection(int_state);
+		return;
+	}
+	if(ramping)
+		stop_ramp();
+	ramp_off_restore = -1;
+	int target = slew_target;
+	if(get_load_mode() == LOAD_MODE_PULSE) {
+		// The transient generator owns the IDACs
+		set_output_mode(OUTPUT_MODE_FEEDBACK);
+	} else if(output_ramp == 0 || target == 0) {
+		slew_output = target;
+		write_output(target);
+		set_output_mode(OUTPUT_MODE_FEEDBACK);
+	} else {
+		if(!turning_off) {
+			slew_output = 0;
+			write_output(0);
+		}
+		set_output_mode(OUTPUT_MODE_FEEDBACK);
+		ramp_step = ramp_step_for(target);
+		start_ramp();
+	}
+	CyExitCriticalSection(int_state);
+}
+
+// Turns the output off, ramping down to zero first unless the ramp time is 0
+void output_off() {
+	uint8 int_state = CyEnterCriticalSection();
+	if(get_output_mode() == OUTPUT_MODE_OFF || ramp_off_restore >= 0) {
+		CyExitCriticalSection(int_state);
+		return;
+	}
+	int restore = slew_target;
+	if(ramping)
+		stop_ramp();
+	if(get_load_mode() == LOAD_MODE_PULSE) {
+		set_output_mode(OUTPUT_MODE_OFF);
+	} else if(output_ramp == 0 || get_output_mode() != OUTPUT_MODE_FEEDBACK || slew_output == 0) {
+		set_output_mode(OUTPUT_MODE_OFF);
+		slew_output = restore;
+		write_output(restore);
+	} else {
+		ramp_off_restore = restore;
+		slew_target = 0;
+		ramp_step = ramp_step_for(slew_output);
+		start_ramp();
+	}
+	CyExitCriticalSection(int_state);
+}
+
+// Whether output_on or output_off is still ramping
+int get_output_ramping() {
+	return ramping && (ramp_step != 0);
+}
+
+// Milliseconds for the on and off ramps, 0 to switch at once
+int set_output_ramp(int ms) {
+	if(ms < 0 || ms > OUTPUT_MAX_RAMP)
+		return 0;
+	output_ramp = ms;
+	return 1;
+}
+
+int get_output_ramp() {
+	return output_ramp;
+}
+
+/* [] END OF FILE */
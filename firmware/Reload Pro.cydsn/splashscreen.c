@@ -1,208 +0,0 @@
-#include "splashscreen.h"
-
-const uint8 splashscreen_data[] = {
-    // 0-299: Page 0
-    0x01, 0x00, 0x00, 0xE0, 0x07, 0x00, 0x02, 0xE0, 0x00, 0xE0,
-    0xA0, 0x00, 0x00, 0x60, 0xE0, 0x10, 0x00, 0x09, 0xA0, 0x60,
-    0xE0, 0xC0, 0xE0, 0xE0, 0xC0, 0x80, 0xE0, 0xC0, 0xE0, 0x00,
-    0x3D, 0x03, 0x80, 0x00, 0x80, 0x80, 0x60, 0x03, 0xE0, 0x0A,
-    0x00, 0x20, 0x1A, 0x40, 0x20, 0x80, 0x00, 0x40, 0x0D, 0x80,
-    0x00, 0x04, 0x00, 0x00, 0xF0, 0x00, 0xF0, 0x40, 0x00, 0x02,
-    0xE0, 0xF0, 0xF0, 0x80, 0x1B, 0xC0, 0x00, 0x20, 0x23, 0x20,
-    0x33, 0xE0, 0x10, 0x00, 0x20, 0x1B, 0x40, 0x23, 0x40, 0x03,
-    0xE0, 0x10, 0x23, 0x60, 0x00, 0x40, 0x46, 0x20, 0x01, 0x60,
-    0x00, 0x40, 0x08, 0x60, 0x14, 0xE0, 0x08, 0x00, 0x40, 0x7F,
-    0x40, 0x00, 0x40, 0x8F, 0xE0, 0x0D, 0x00, 0xE1, 0x1B, 0x13,
-    0x01, 0x60, 0x60, 0x21, 0x11, 0x60, 0x01, 0x02, 0x00, 0x00,
-    0xC0, 0xE1, 0x02, 0x43, 0x00, 0xA0, 0x20, 0x19, 0xE0, 0x0F,
-    0x00, 0xE1, 0x05, 0x47, 0x01, 0xC0, 0x80, 0x41, 0x54, 0x00,
-    0xC0, 0x21, 0x77, 0x20, 0x02, 0xE0, 0x10, 0x00, 0x00, 0xE0,
-    0x21, 0x7B, 0x20, 0x67, 0x20, 0x2B, 0xE0, 0x0A, 0xAB, 0x20,
-    0xDB, 0x00, 0x40, 0x20, 0x1D, 0x11, 0x60, 0xE0, 0x30, 0x64,
-    0x7A, 0x74, 0x1A, 0x0C, 0x07, 0x1E, 0x0A, 0x01, 0x08, 0x1A,
-    0x04, 0x0A, 0x0E, 0x0E, 0xE0, 0x01, 0x2B, 0x41, 0x05, 0x04,
-    0x00, 0xC0, 0xC0, 0xC0, 0xA0, 0x20, 0x26, 0x18, 0x50, 0xE0,
-    0x30, 0x70, 0x28, 0x30, 0x18, 0x0A, 0x14, 0x3C, 0x0F, 0x04,
-    0x00, 0x0F, 0x01, 0x0C, 0x05, 0x0D, 0x06, 0x01, 0x03, 0x0F,
-    0x00, 0x00, 0x02, 0x80, 0x2E, 0x00, 0xFF, 0xA0, 0x01, 0xC0,
-    0x00, 0x06, 0x02, 0x04, 0x02, 0x07, 0x00, 0x0C, 0x07, 0x40,
-    0x27, 0x13, 0x0E, 0x05, 0x09, 0x0F, 0x18, 0x30, 0x18, 0x1E,
-    0x30, 0x60, 0x70, 0x70, 0xE0, 0xFF, 0x40, 0xFF, 0xC0, 0xFF,
-    0x80, 0xFF, 0x21, 0x68, 0x20, 0x02, 0xC0, 0x00, 0x15, 0x04,
-    0x06, 0x0E, 0x00, 0x04, 0x0F, 0x0A, 0x01, 0x18, 0x0A, 0x1E,
-    0x28, 0x10, 0x1E, 0x60, 0x30, 0xF4, 0xF2, 0xC0, 0xE0, 0x80,
-    0xC0, 0x20, 0x7D, 0xE2, 0x01, 0x33, 0x02, 0x00, 0x00, 0x00,
-    // 300-624: Page 1
-    0x01, 0x00, 0x00, 0xE0, 0x07, 0x00, 0x02, 0x7F, 0x00, 0x7F,
-    0x40, 0x00, 0x03, 0x3F, 0x7F, 0x7F, 0x0C, 0xE0, 0x05, 0x00,
-    0x01, 0x1C, 0x1C, 0x20, 0x02, 0x0F, 0x3C, 0x1C, 0x3C, 0x3C,
-    0x7C, 0x2C, 0x27, 0x7C, 0x6F, 0x47, 0x67, 0x6F, 0x47, 0x03,
-    0x07, 0x4F, 0x80, 0x3D, 0x02, 0x1E, 0x01, 0x3F, 0x20, 0x2F,
-    0x40, 0x33, 0x00, 0x6D, 0xE0, 0x08, 0x00, 0x02, 0x6E, 0x6D,
-    0x6F, 0x40, 0x00, 0x02, 0x26, 0x6F, 0x6F, 0x80, 0x2B, 0x02,
-    0x61, 0x00, 0x61, 0x40, 0x00, 0x08, 0x20, 0x61, 0x61, 0x00,
-    0x00, 0x1F, 0x20, 0x3F, 0x7F, 0x20, 0x39, 0x20, 0x3B, 0x00,
-    0x60, 0x40, 0x00, 0x02, 0x00, 0x20, 0x60, 0x40, 0x23, 0x01,
-    0x3F, 0x1E, 0x20, 0x10, 0x20, 0x02, 0x02, 0x61, 0x61, 0x7E,
-    0x40, 0x29, 0xE0, 0x06, 0x00, 0x01, 0x7E, 0x61, 0x60, 0x32,
-    0x0B, 0x1E, 0x7F, 0x3F, 0x00, 0x00, 0x1D, 0x00, 0x3D, 0x3D,
-    0x7D, 0x7D, 0x7D, 0x20, 0x03, 0xE0, 0x08, 0x76, 0x20, 0x00,
-    0x20, 0x91, 0x60, 0x00, 0x02, 0x00, 0x00, 0x7E, 0xE0, 0x14,
-    0x53, 0x60, 0x24, 0x20, 0x00, 0x40, 0xFB, 0xE0, 0x0D, 0x00,
-    0xE1, 0x10, 0x13, 0xE0, 0x04, 0x00, 0x04, 0x0F, 0x07, 0x0F,
-    0x0F, 0x07, 0x20, 0x03, 0x03, 0x00, 0x00, 0x03, 0x04, 0x40,
-    0xBF, 0x40, 0x00, 0x02, 0x0C, 0x0C, 0x77, 0xE0, 0x04, 0x23,
-    0x21, 0x46, 0x21, 0x45, 0x00, 0x2C, 0x21, 0x47, 0x00, 0x7C,
-    0xE1, 0x08, 0x47, 0x01, 0x3F, 0x1F, 0x20, 0xF4, 0x21, 0x0E,
-    0x01, 0x60, 0x60, 0x20, 0x02, 0xE0, 0x10, 0x00, 0x01, 0x7F,
-    0x60, 0x40, 0x23, 0x40, 0x2B, 0xE0, 0x07, 0xAB, 0x0F, 0x03,
-    0x04, 0x08, 0x03, 0x3F, 0x5F, 0xCF, 0xFF, 0xFC, 0xFB, 0xF1,
-    0xFD, 0xC0, 0xA0, 0x70, 0xE0, 0x20, 0x1F, 0x00, 0x80, 0x20,
-    0x03, 0xE0, 0x01, 0x00, 0x04, 0xFE, 0xFE, 0xFF, 0xFF, 0xFF,
-    0x40, 0x03, 0x05, 0xFF, 0xFF, 0x01, 0xC1, 0x3A, 0xF5, 0xE0,
-    0x01, 0x18, 0xE0, 0x0E, 0x00, 0x00, 0xFF, 0xA0, 0x01, 0xE0,
-    0x17, 0x00, 0x01, 0xFF, 0x01, 0x20, 0x50, 0x00, 0xE1, 0x20,
-    0x55, 0x20, 0x00, 0x20, 0x63, 0x01, 0x00, 0xFE, 0xE0, 0x06,
-    0x30, 0x20, 0x85, 0x0F, 0xE0, 0xD0, 0xA8, 0xF0, 0xFD, 0xFE,
-    0x7A, 0xFF, 0x1F, 0x27, 0x4F, 0x3F, 0x00, 0x03, 0x00, 0x07,
-    0x80, 0x21, 0x01, 0x00, 0x00,
-    // 625-980: Page 2
-    0x02, 0x00, 0x03, 0x00, 0xE0, 0x0C, 0x01, 0x04, 0xF8, 0x03,
-    0x00, 0xFB, 0xF8, 0x20, 0x01, 0x01, 0x20, 0x63, 0xE0, 0x01,
-    0x01, 0x04, 0xE0, 0x23, 0x60, 0xE3, 0xC0, 0x20, 0x01, 0x04,
-    0xE0, 0x03, 0x00, 0xE3, 0xE0, 0x20, 0x01, 0xE0, 0x03, 0x39,
-    0xE0, 0x0B, 0x13, 0x40, 0x01, 0x09, 0xE0, 0x03, 0x10, 0xE3,
-    0xF0, 0xE3, 0xF0, 0xF3, 0x90, 0xB3, 0xE0, 0x09, 0x01, 0x40,
-    0x17, 0x40, 0x1F, 0x40, 0x27, 0x60, 0x57, 0x20, 0x5F, 0xE0,
-    0x01, 0x6D, 0x07, 0x20, 0x63, 0x00, 0x03, 0x60, 0x23, 0x20,
-    0xE3, 0xE0, 0x09, 0x01, 0x00, 0xE0, 0x20, 0x83, 0x03, 0xC0,
-    0x03, 0x20, 0xC3, 0x40, 0x03, 0x40, 0x0B, 0x40, 0x2B, 0xE0,
-    0x07, 0x01, 0xE0, 0x13, 0xBF, 0x40, 0x6F, 0x40, 0xBF, 0xE0,
-    0x07, 0x6F, 0x40, 0x4B, 0x40, 0x53, 0x07, 0xD0, 0x23, 0x08,
-    0xFB, 0xF0, 0xDB, 0xD0, 0xFB, 0x40, 0x0B, 0x40, 0x13, 0xE0,
-    0x08, 0x5B, 0x21, 0x17, 0x40, 0x5F, 0x40, 0x47, 0xE0, 0x03,
-    0x01, 0x01, 0xF0, 0xF3, 0x20, 0x01, 0x02, 0x03, 0x00, 0xF3,
-    0xE0, 0x03, 0x13, 0xE0, 0x03, 0x01, 0x00, 0x20, 0x20, 0xE5,
-    0xE0, 0x07, 0xCD, 0x01, 0xE0, 0x23, 0x40, 0x61, 0x80, 0x93,
-    0x20, 0x55, 0x03, 0xFB, 0xF8, 0x23, 0x60, 0xE1, 0x05, 0x73,
-    0x20, 0x1B, 0x40, 0x87, 0x02, 0xC0, 0xC3, 0xA0, 0x21, 0x77,
-    0x03, 0xE0, 0xE3, 0x20, 0xC3, 0x20, 0x41, 0xA0, 0x03, 0x06,
-    0x60, 0x83, 0x60, 0xE3, 0x40, 0x43, 0x20, 0x60, 0xCF, 0xE0,
-    0x03, 0x01, 0x1F, 0x03, 0x0F, 0x05, 0x1F, 0x7F, 0xBF, 0x1F,
-    0xFF, 0xFE, 0xFD, 0xF8, 0xFE, 0xE0, 0xD0, 0xB8, 0xF0, 0x80,
-    0x00, 0x80, 0xC0, 0x00, 0x00, 0x80, 0x00, 0x08, 0x17, 0x07,
-    0x1F, 0x3F, 0x1F, 0x1F, 0x3F, 0x10, 0x7F, 0x3F, 0x7F, 0xFF,
-    0xF0, 0xFF, 0x6E, 0xFF, 0xE0, 0xC0, 0xE0, 0xE0, 0xC0, 0x80,
-    0xC0, 0xC0, 0x80, 0x40, 0x1C, 0x20, 0x03, 0x02, 0x80, 0xC0,
-    0x40, 0x40, 0x11, 0x02, 0xF0, 0xE0, 0xE0, 0x20, 0x02, 0x40,
-    0x03, 0x20, 0x25, 0x60, 0x03, 0x40, 0x0B, 0xC0, 0x03, 0x20,
-    0x21, 0x02, 0x80, 0x40, 0x80, 0x20, 0x2F, 0x20, 0x55, 0x12,
-    0x80, 0x00, 0xC0, 0xC0, 0xC0, 0xA0, 0xC0, 0xE0, 0xFF, 0xD0,
-    0xFF, 0xFF, 0x7E, 0xF1, 0xFF, 0x3F, 0x7F, 0x7F, 0x7F, 0x20,
-    0x60, 0x03, 0x3F, 0x00, 0x0F, 0x10, 0x40, 0x1E, 0x40, 0x75,
-    0x12, 0x80, 0xF0, 0xE8, 0xF4, 0xF8, 0xFE, 0xFD, 0xFF, 0xFF,
-    0x3F, 0x5F, 0xAF, 0x7F, 0x01, 0x36, 0x03, 0x3B, 0x00, 0x30,
-    0xE0, 0x03, 0x01, 0x01, 0x00, 0x30,
-    // 981-1313: Page 3
-    0x02, 0x00, 0x80, 0x00, 0xE0, 0x0C, 0x01, 0x04, 0x07, 0x80,
-    0x00, 0x87, 0x07, 0x20, 0x01, 0x01, 0x04, 0x86, 0xE0, 0x01,
-    0x01, 0x11, 0x07, 0x84, 0x02, 0x87, 0x03, 0x87, 0x03, 0x83,
-    0x03, 0x80, 0x04, 0x83, 0x07, 0x93, 0x37, 0x97, 0x14, 0xB6,
-    0xE0, 0x01, 0x01, 0x07, 0x1F, 0xB4, 0x16, 0xBF, 0x1F, 0x8F,
-    0x1F, 0xBF, 0xE0, 0x07, 0x4D, 0xC0, 0x47, 0x01, 0x00, 0x81,
-    0xE0, 0x09, 0x01, 0x40, 0x5F, 0x40, 0x1F, 0x40, 0x33, 0x20,
-    0x09, 0xE0, 0x00, 0x0B, 0xE0, 0x03, 0x01, 0x40, 0x6F, 0x04,
-    0x07, 0x85, 0x03, 0x87, 0x05, 0xE0, 0x02, 0x01, 0x20, 0x29,
-    0x60, 0x2B, 0x60, 0x87, 0x00, 0x83, 0xE0, 0x05, 0xA3, 0xC0,
-    0x01, 0x40, 0x57, 0x20, 0x25, 0x60, 0x5B, 0xC0, 0x01, 0xE0,
-    0x03, 0x13, 0x40, 0x1B, 0x40, 0x0F, 0xC0, 0x1B, 0x00, 0x00,
-    0x20, 0x00, 0x00, 0x07, 0x40, 0x00, 0x40, 0x06, 0x40, 0x03,
-    0x20, 0x00, 0x09, 0x03, 0x00, 0x04, 0x03, 0x07, 0x03, 0x07,
-    0x07, 0x04, 0x06, 0xE0, 0x05, 0x01, 0x20, 0x1A, 0x60, 0x23,
-    0x20, 0x32, 0xE0, 0x04, 0x00, 0x20, 0x15, 0x40, 0x2C, 0xE0,
-    0x08, 0x2F, 0xC0, 0x01, 0xC0, 0x4F, 0x00, 0x05, 0xE0, 0x02,
-    0x01, 0x20, 0x0A, 0x60, 0x00, 0x40, 0x48, 0x60, 0x08, 0xE0,
-    0x06, 0x3F, 0x40, 0x7F, 0x40, 0x37, 0x02, 0x02, 0x05, 0x02,
-    0x20, 0x2B, 0xE0, 0x03, 0x39, 0x20, 0x38, 0x20, 0x02, 0x02,
-    0x03, 0x06, 0x03, 0x60, 0x3B, 0xE0, 0x0B, 0x00, 0x00, 0x01,
-    0x20, 0x02, 0x03, 0x01, 0x83, 0x03, 0x03, 0x21, 0x43, 0x20,
-    0xC5, 0x1F, 0x8E, 0x07, 0x0E, 0x0F, 0x96, 0x0F, 0x1E, 0x0C,
-    0x1C, 0x1E, 0x3C, 0x18, 0x3C, 0x3C, 0x78, 0x38, 0x35, 0x78,
-    0x71, 0xFB, 0x70, 0xF9, 0xF3, 0xE7, 0x63, 0xF7, 0xE7, 0xCF,
-    0xEF, 0xEF, 0xFF, 0xCF, 0x01, 0xCE, 0xFF, 0xE0, 0x03, 0x00,
-    0x00, 0x7F, 0x20, 0x0C, 0x00, 0x7F, 0x80, 0x01, 0x00, 0x7F,
-    0x40, 0x07, 0x20, 0x0A, 0xE0, 0x04, 0x00, 0x1F, 0xCF, 0xFF,
-    0xEE, 0xFF, 0xE7, 0xEF, 0xC7, 0xE7, 0xF3, 0xE3, 0x75, 0xF3,
-    0x79, 0xF7, 0xFA, 0xFF, 0x7C, 0xBB, 0x38, 0xFF, 0x1C, 0x3C,
-    0x3A, 0x3C, 0x1E, 0x0C, 0x0E, 0x1E, 0x0E, 0x07, 0x8F, 0x0F,
-    0x0B, 0x07, 0x07, 0x83, 0x8F, 0x03, 0x83, 0x05, 0x83, 0x01,
-    0x03, 0x81, 0x81, 0x20, 0x88, 0x20, 0x8A, 0xE0, 0x0B, 0x00,
-    0x01, 0x00, 0x00,
-    // 1314-1487: Page 4
-    0x02, 0x00, 0x01, 0x00, 0xE0, 0xF5, 0x01, 0x00, 0xFF, 0xA0,
-    0x01, 0x00, 0x80, 0xE0, 0xB1, 0x01, 0x01, 0x80, 0x00, 0x20,
-    0x03, 0x19, 0xC0, 0xC0, 0xC0, 0xE0, 0xC0, 0xE0, 0xE0, 0x70,
-    0x60, 0xB0, 0xF8, 0x38, 0x38, 0x54, 0x38, 0x1C, 0x0E, 0x3C,
-    0x1C, 0x0E, 0x07, 0x0F, 0x0F, 0x07, 0x03, 0x03, 0x20, 0x02,
-    0x07, 0x87, 0x07, 0x83, 0x07, 0x83, 0x87, 0x83, 0xC7, 0x20,
-    0x00, 0x11, 0xE3, 0xC6, 0xC7, 0xE7, 0xE7, 0xC2, 0xF7, 0xF7,
-    0xE6, 0xEF, 0xF7, 0xFF, 0xFE, 0xF6, 0xFF, 0xFF, 0xFF, 0xFE,
-    0x20, 0x03, 0xE0, 0x03, 0x00, 0x0A, 0x7F, 0xFF, 0x3F, 0x5F,
-    0x3F, 0xFF, 0x0F, 0x00, 0x16, 0x0F, 0x00, 0xE0, 0x01, 0x00,
-    0x07, 0x06, 0x0F, 0x17, 0x0A, 0x3F, 0x7F, 0x3F, 0x9F, 0xE0,
-    0x03, 0x28, 0x80, 0x00, 0x40, 0x3E, 0x20, 0x46, 0x13, 0xF7,
-    0xEF, 0xF6, 0xFF, 0xE7, 0xC7, 0xE2, 0xE7, 0xC7, 0xC3, 0xA6,
-    0xC7, 0x83, 0xC7, 0x87, 0xC7, 0x83, 0x07, 0x03, 0x87, 0x40,
-    0x7A, 0x13, 0x07, 0x07, 0x03, 0x0F, 0x0E, 0x0E, 0x15, 0x1F,
-    0x1C, 0x3C, 0x0A, 0x1C, 0x38, 0x70, 0x38, 0x78, 0x70, 0xE0,
-    0xE0, 0xF0, 0x20, 0xA6, 0x08, 0xE0, 0x80, 0xC0, 0x80, 0xC0,
-    0x00, 0x00, 0x80, 0x00,
-    // 1488-1656: Page 5
-    0x01, 0x00, 0x00, 0xE0, 0xF6, 0x00, 0x00, 0x01, 0xE0, 0xB5,
-    0x01, 0x0F, 0x01, 0x06, 0x02, 0x03, 0x1F, 0x2F, 0x7F, 0x7F,
-    0xF9, 0x67, 0x97, 0xFF, 0x00, 0x01, 0x80, 0x01, 0xE1, 0x03,
-    0xCD, 0x10, 0x1C, 0xE6, 0x2A, 0x7E, 0xFE, 0xFF, 0xFE, 0xFE,
-    0xFF, 0xE7, 0x1A, 0xFF, 0x07, 0x03, 0x07, 0x87, 0x03, 0x20,
-    0x04, 0x00, 0x03, 0x40, 0x02, 0x01, 0x03, 0x01, 0x20, 0x05,
-    0x0A, 0x0B, 0x07, 0x1F, 0x0F, 0x2F, 0x1F, 0x7F, 0x3F, 0xBF,
-    0x7F, 0xFF, 0xA0, 0x00, 0x0F, 0xC7, 0xAB, 0xCF, 0xDF, 0x81,
-    0x90, 0xCA, 0x93, 0x80, 0xBE, 0xDC, 0xFC, 0x80, 0xBE, 0xDF,
-    0xFF, 0x20, 0x03, 0x00, 0xFE, 0x20, 0x03, 0x40, 0x07, 0x80,
-    0x03, 0x0A, 0xBC, 0xDA, 0xFC, 0x81, 0xC3, 0x92, 0x87, 0xEF,
-    0xD7, 0x87, 0xEF, 0x80, 0x32, 0x0D, 0x7F, 0xFF, 0x3F, 0x7F,
-    0x1F, 0x7F, 0x1F, 0xEF, 0x07, 0xFF, 0x07, 0xFB, 0x03, 0xFF,
-    0x40, 0x57, 0x20, 0x5F, 0x20, 0x65, 0x20, 0x00, 0x05, 0x03,
-    0xE7, 0x97, 0xFF, 0xFE, 0xF7, 0x40, 0x7D, 0x04, 0xFE, 0x04,
-    0x3A, 0x48, 0x9C, 0xE0, 0x03, 0x97, 0x0B, 0x00, 0x81, 0x61,
-    0xC1, 0xFF, 0x79, 0x27, 0xFF, 0x0F, 0x17, 0x3E, 0x3F,
-    // 1657-1812: Page 6
-    0x02, 0x00, 0x8C, 0x00, 0xE0, 0xFF, 0x01, 0xE0, 0x19, 0x01,
-    0x00, 0x0C, 0xE0, 0x8D, 0x01, 0x10, 0x04, 0x0A, 0x0C, 0x0E,
-    0x0F, 0x00, 0x09, 0x0F, 0x0A, 0x0D, 0x01, 0x1F, 0x04, 0x0A,
-    0x06, 0x06, 0x00, 0xE0, 0x00, 0x00, 0x05, 0x03, 0x01, 0x7F,
-    0x8F, 0x13, 0xFF, 0x40, 0x00, 0x03, 0x80, 0x70, 0x8C, 0xCB,
-    0xE0, 0x00, 0x16, 0xE0, 0x06, 0x00, 0x0D, 0x01, 0x00, 0x02,
-    0x01, 0x07, 0x03, 0x0B, 0x07, 0x0F, 0x07, 0x0F, 0x0F, 0x0F,
-    0x1F, 0x40, 0x02, 0x00, 0x1F, 0x20, 0x00, 0x00, 0x3F, 0x20,
-    0x01, 0x02, 0x1F, 0x3F, 0x3F, 0x40, 0x06, 0x40, 0x05, 0x02,
-    0x1F, 0x2F, 0x1F, 0x60, 0x1A, 0x20, 0x1B, 0x07, 0x0F, 0x07,
-    0x07, 0x0F, 0x03, 0x07, 0x01, 0x07, 0x20, 0x38, 0x00, 0x01,
-    0x60, 0x4A, 0x00, 0xFF, 0xA0, 0x01, 0xE0, 0x00, 0x00, 0x05,
-    0x80, 0x00, 0xE0, 0x9F, 0x98, 0xFE, 0x40, 0x77, 0x03, 0x0F,
-    0x71, 0x96, 0x3F, 0xE0, 0x00, 0x16, 0x12, 0x00, 0x00, 0x04,
-    0x0E, 0xF0, 0x04, 0xFE, 0x09, 0xFA, 0x13, 0xFB, 0x0A, 0x05,
-    0x07, 0x0F, 0x00, 0x04, 0x02, 0x0C,
-    // 1813-1912: Page 7
-    0x02, 0x00, 0x01, 0x00, 0xE0, 0xFF, 0x01, 0xE0, 0x11, 0x01,
-    0x00, 0x7F, 0xA0, 0x01, 0x00, 0x60, 0xE0, 0xAD, 0x01, 0x1F,
-    0x01, 0x60, 0x00, 0x61, 0x03, 0x61, 0x01, 0x63, 0x06, 0x63,
-    0x07, 0x67, 0x0C, 0x64, 0x2A, 0x7E, 0x78, 0x10, 0x20, 0x78,
-    0x40, 0x78, 0x90, 0x70, 0x70, 0x00, 0x78, 0x70, 0x00, 0x20,
-    0x10, 0x60, 0x00, 0x00, 0xE0, 0x32, 0x00, 0x1B, 0x20, 0x10,
-    0x40, 0x70, 0x70, 0x8F, 0xD8, 0xFF, 0x58, 0xE7, 0xB0, 0xFF,
-    0x38, 0x40, 0x1C, 0x78, 0x0C, 0x06, 0x06, 0x0E, 0x03, 0x06,
-    0x07, 0x07, 0x01, 0x03, 0x01, 0x03, 0x61, 0x51, 0xE0, 0x07,
-    0x00, 0x00, 0xFF, 0xA0, 0x01, 0x60, 0x00, 0x01, 0x00, 0x00,
-};
-
-const int16 splashscreen_indexes[] = {0, 300, 625, 981, 1314, 1488, 1657, 1813, 1913};
@@ -1,22 +0,0 @@
-/* ========================================
- *
- * Copyright YOUR COMPANY, THE YEAR
- * All Rights Reserved
- * UNPUBLISHED, LICENSED SOFTWARE.
- *
- * CONFIDENTIAL AND PROPRIETARY INFORMATION
- * WHICH IS THE PROPERTY OF your company.
- *
- * ========================================
-*/
-
-#include <project.h>
-
-extern const uint8 splashscreen_data[];
-extern const int16 splashscreen_indexes[];
-
-#define SPLASHSCREEN_PAGES 8
-
-void load_splashscreen();
-
-/* [] END OF FILE */
@@ -0,0 +1,203 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include "tasks.h"
+#include "config.h"
+
+// Standby current measurement: everything that helps at a few hundred
+// microamps, set up together. The output starts off while the ADC task takes
+// the current offset as the mean of STANDBY_ZERO_BLOCKS blocks, to a fraction
+// of a count, rather than the whole counts the auto-zero keeps. Then the load
+// sinks the setpoint, with the dither on so it can be finer than the low
+// IDAC's step, and each reading is a mains synchronous integration over
+// STANDBY_LINE_CYCLES, kept to 256ths of a count so the noise averages below
+// one. The reported current is the mean of the last STANDBY_HISTORY readings,
+// and its uncertainty their standard error combined with the zero's. The
+// dither and line integration are put back as they were when it stops. Only
+// in builds with USE_STANDBY defined.
+
+#ifdef USE_STANDBY
+
+static volatile standby_state mode_state = STANDBY_IDLE;
+static int setpoint;			// Microamps
+static uint8 saved_dither, saved_hz, saved_cycles;
+static uint16 zero_blocks;
+static int32 zero_sum;
+static uint64 zero_squares;
+static int32 zero_fine;			// The offset, in 256ths of a count
+static uint32 zero_variance;	// Of zero_fine, in 65536ths of a count squared
+static uint16 last_period;
+static uint8 skip;				// Periods still to pass before the first reading
+static int32 history[STANDBY_HISTORY];	// 256ths of a count
+static uint16 readings;
+static standby_reading reading;	// Read under a critical section
+
+int standby_start(int new_setpoint) {
+	if(new_setpoint < 0 || new_setpoint > STANDBY_MAX_SETPOINT)
+		return 0;
+
+	if(mode_state == STANDBY_IDLE) {
+		saved_dither = get_dither();
+		saved_hz = get_line_frequency();
+		saved_cycles = get_line_cycles();
+	}
+	mode_state = STANDBY_IDLE;
+	sequence_stop();
+	battery_stop();
+	sweep_stop();
+	mppt_stop();
+	ir_stop();
+	tune_stop();
+	impedance_stop();
+	ocp_stop();
+	loadreg_stop();
+
+	setpoint = new_setpoint;
+	set_load_mode(LOAD_MODE_CC);
+	set_dither(1);
+	set_line_integration(saved_hz?saved_hz:STANDBY_DEFAULT_HZ, STANDBY_LINE_CYCLES);
+	set_output_mode(OUTPUT_MODE_OFF);
+	set_current(setpoint);
+	zero_blocks = 0;
+	zero_sum = 0;
+	zero_squares = 0;
+	readings = 0;
+	uint8 int_state = CyEnterCriticalSection();
+	reading = (standby_reading){0};
+	CyExitCriticalSection(int_state);
+	// Last, as the ADC task takes over from here
+	mode_state = STANDBY_ZEROING;
+	return 1;
+}
+
+void standby_stop() {
+	if(mode_state == STANDBY_IDLE)
+		return;
+	mode_state = STANDBY_IDLE;
+	set_current(0);
+	set_dither(saved_dither);
+	set_line_integration(saved_hz, saved_cycles);
+}
+
+static void finish_zero() {
+	uint32 n = STANDBY_ZERO_BLOCKS;
+	zero_fine = ((int64)zero_sum * 256) / (int32)n;
+	// The mean's variance, the blocks' over n
+	uint64 spread = zero_squares * n - (int64)zero_sum * zero_sum;
+	zero_variance = (spread << 16) / ((uint64)n * n * (n - 1));
+
+	uint16 periods;
+	get_line_current_fine(&periods);
+	last_period = periods;
+	// The period the output comes on in is part zero
+	skip = 1;
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	mode_state = STANDBY_MEASURING;
+}
+
+static void take_reading(int32 value) {
+	history[readings % STANDBY_HISTORY] = value;
+	readings++;
+	int n = (readings < STANDBY_HISTORY)?readings:STANDBY_HISTORY;
+
+	int32 sum = 0;
+	for(int i = 0; i < n; i++)
+		sum += history[i];
+	int32 mean = sum / n;
+	uint64 variance = zero_variance;
+	if(n > 1) {
+		uint64 squares = 0;
+		for(int i = 0; i < n; i++)
+			squares += (int64)(history[i] - mean) * (history[i] - mean);
+		variance += squares / (n * (n - 1));
+	}
+
+	standby_reading r = {
+		.current = current_span_from_raw(mean),
+		.uncertainty = current_span_from_raw(isqrt(variance)),
+		.readings = readings,
+	};
+	uint8 int_state = CyEnterCriticalSection();
+	reading = r;
+	CyExitCriticalSection(int_state);
+}
+
+// Called by the ADC task with each block's means
+void standby_block(const int16 *mean) {
+	switch(mode_state) {
+	case STANDBY_ZEROING:
+		zero_sum += mean[FILTER_CURRENT];
+		zero_squares += (int32)mean[FILTER_CURRENT] * mean[FILTER_CURRENT];
+		if(++zero_blocks >= STANDBY_ZERO_BLOCKS)
+			finish_zero();
+		break;
+	case STANDBY_MEASURING: {
+		uint16 periods;
+		int32 fine = get_line_current_fine(&periods);
+		if(periods == last_period)
+			break;
+		last_period = periods;
+		if(skip) {
+			skip--;
+			break;
+		}
+		take_reading(fine - zero_fine);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+standby_state get_standby_state() {
+	return mode_state;
+}
+
+int get_standby_setpoint() {
+	return setpoint;
+}
+
+void get_standby_reading(standby_reading *r) {
+	uint8 int_state = CyEnterCriticalSection();
+	*r = reading;
+	CyExitCriticalSection(int_state);
+}
+
+#else
+
+int standby_start(int new_setpoint) {
+	return 0;
+}
+
+void standby_stop() {
+}
+
+void standby_block(const int16 *mean) {
+}
+
+standby_state get_standby_state() {
+	return STANDBY_IDLE;
+}
+
+int get_standby_setpoint() {
+	return 0;
+}
+
+void get_standby_reading(standby_reading *r) {
+	*r = (standby_reading){0};
+}
+
+#endif
+
+/* [] END OF FILE */
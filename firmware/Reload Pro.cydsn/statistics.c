@@ -0,0 +1,292 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <string.h>
+#include "tasks.h"
+#include "config.h"
+
+// Running statistics of every raw current and voltage scan, so peaks between
+// readings aren't missed. The ADC task takes each block's sum and squares
+// exactly, then folds them into the window's mean and squared deviations the
+// way Welford's method does a sample at a time (Chan's pairwise form), which
+// keeps the variance accurate with a 16 bit mean behind it and costs two
+// divides a channel per block rather than one per scan. Windows are a number
+// of blocks; when one ends its figures are kept for the readers and the next
+// starts afresh. A window of 0 runs until reset. Only in builds with
+// USE_STATISTICS defined; without it there are no figures, and the hold
+// readouts show dashes.
+
+#ifdef USE_STATISTICS
+
+typedef struct {
+	uint32 scans;
+	int32 mean;		// Counts, Q8
+	uint64 m2;		// Sum of squared deviations, in eighths of a count squared
+	int16 min, max;
+} running_statistics;
+
+static running_statistics running[FILTER_CHANNELS];
+static running_statistics finished[FILTER_CHANNELS];	// Read under a critical section
+static uint16 window = STATISTICS_DEFAULT_WINDOW;
+static uint16 window_blocks = 0;
+static volatile int32 new_window = -1;	// Applied by the ADC task, which also resets
+
+// The hold readouts: the same scans' extremes and sum, but running from one
+// reset to the next whatever the window, so a sag between redraws stays on
+// the panel. Updated and read under a critical section.
+typedef struct {
+	uint32 scans;
+	int64 sum;
+	int16 min, max;
+} hold_statistics;
+
+static hold_statistics hold[FILTER_CHANNELS];
+static volatile uint8 hold_reset_due = 0;
+
+#ifdef USE_SEQUENCE
+// And the sequencer's, from one take_step_statistics() to the next, so each
+// step's results cover its scans. Kept only while a sequence runs, and only
+// by the ADC task, so without a critical section.
+static hold_statistics step_hold[FILTER_CHANNELS];
+#endif
+
+static void restart() {
+	for(int chan = 0; chan < FILTER_CHANNELS; chan++)
+		running[chan].scans = 0;
+	window_blocks = 0;
+}
+
+void statistics_block(const int16 (*scans)[ADC_RING_CHANNELS]) {
+	static const uint8 channels[FILTER_CHANNELS] = {ADC_CHAN_CURRENT_SENSE, ADC_CHAN_VOLTAGE_SENSE};
+
+	if(new_window >= 0) {
+		window = new_window;
+		new_window = -1;
+		restart();
+		taskENTER_CRITICAL();
+		memset(finished, 0, sizeof(finished));
+		taskEXIT_CRITICAL();
+	}
+
+	if(hold_reset_due) {
+		hold_reset_due = 0;
+		taskENTER_CRITICAL();
+		memset(hold, 0, sizeof(hold));
+		taskEXIT_CRITICAL();
+	}
+
+	for(int chan = 0; chan < FILTER_CHANNELS; chan++) {
+		running_statistics *r = &running[chan];
+		int32 sum = 0;
+		uint64 squares = 0;
+		int16 min = INT16_MAX, max = INT16_MIN;
+		for(int i = 0; i < ADC_BLOCK_SCANS; i++) {
+			int16 x = scans[i][channels[chan]];
+			sum += x;
+			squares += (int32)x * x;
+			if(x < min)
+				min = x;
+			if(x > max)
+				max = x;
+		}
+		// The block's own squared deviations times its length, so they stay whole
+		uint64 block_m2 = squares * ADC_BLOCK_SCANS - (int64)sum * sum;
+		int32 block_mean = sum * (256 / ADC_BLOCK_SCANS);
+
+		if(r->scans == 0) {
+			r->mean = block_mean;
+			r->m2 = block_m2;
+			r->min = min;
+			r->max = max;
+		} else {
+			uint32 total = r->scans + ADC_BLOCK_SCANS;
+			int32 delta = block_mean - r->mean;
+			// Rounded, or truncation would drag the mean towards zero block by block
+			int32 step = delta * ADC_BLOCK_SCANS;
+			r->mean += (step + ((step < 0)?-(int32)(total / 2):(int32)(total / 2))) / (int32)total;
+			// delta^2 * n * blocksize / total, with n / total as 1 - blocksize / total in Q16
+			uint32 weight = 65536 - (ADC_BLOCK_SCANS << 16) / total;
+			uint64 delta2 = (uint64)((int64)delta * delta) >> 10;
+			r->m2 += block_m2 + ((delta2 * weight) >> 16);
+			if(min < r->min)
+				r->min = min;
+			if(max > r->max)
+				r->max = max;
+		}
+		r->scans += ADC_BLOCK_SCANS;
+
+		hold_statistics *h = &hold[chan];
+		taskENTER_CRITICAL();
+		if(h->scans == 0 || min < h->min)
+			h->min = min;
+		if(h->scans == 0 || max > h->max)
+			h->max = max;
+		h->sum += sum;
+		h->scans += ADC_BLOCK_SCANS;
+		taskEXIT_CRITICAL();
+
+#ifdef USE_SEQUENCE
+		if(get_sequence_step() >= 0) {
+			h = &step_hold[chan];
+			if(h->scans == 0 || min < h->min)
+				h->min = min;
+			if(h->scans == 0 || max > h->max)
+				h->max = max;
+			h->sum += sum;
+			h->scans += ADC_BLOCK_SCANS;
+		}
+#endif
+	}
+
+	window_blocks++;
+	if(window == 0 || window_blocks >= window) {
+		taskENTER_CRITICAL();
+		memcpy(finished, running, sizeof(finished));
+		taskEXIT_CRITICAL();
+		if(window != 0)
+			restart();
+	}
+}
+
+// Starts a new window of blocks, 0 to run until reset
+void set_statistics_window(uint16 blocks) {
+	new_window = blocks;
+}
+
+uint16 get_statistics_window() {
+	return (new_window >= 0)?new_window:window;
+}
+
+void statistics_reset() {
+	set_statistics_window(get_statistics_window());
+}
+
+// Starts the holds afresh from the next block
+void holds_reset() {
+	hold_reset_due = 1;
+}
+
+// Zeros if there's nothing since the reset yet
+void get_holds(hold_readings *holds) {
+	hold_statistics copy[FILTER_CHANNELS];
+	taskENTER_CRITICAL();
+	memcpy(copy, hold, sizeof(copy));
+	taskEXIT_CRITICAL();
+
+	memset(holds, 0, sizeof(*holds));
+	holds->scans = copy[FILTER_CURRENT].scans;
+	if(holds->scans == 0)
+		return;
+	for(int chan = 0; chan < FILTER_CHANNELS; chan++) {
+		const hold_statistics *h = &copy[chan];
+		int16 offset = (chan == FILTER_CURRENT)?settings->adc_current_offset:settings->adc_voltage_offset;
+		int (*span)(int32) = (chan == FILTER_CURRENT)?current_span_from_raw:voltage_span_from_raw;
+		holds->peak[chan] = span((int32)(h->max - offset) << 8);
+		holds->valley[chan] = span((int32)(h->min - offset) << 8);
+		holds->average[chan] = span((int32)(((h->sum << 8) + h->scans / 2) / h->scans) - ((int32)offset << 8));
+	}
+}
+
+#ifdef USE_SEQUENCE
+// The step so far by FILTER_CHANNELS, zeros if it had no blocks, and starts
+// the next. Called by the ADC task.
+void take_step_statistics(raw_statistics *stats) {
+	for(int chan = 0; chan < FILTER_CHANNELS; chan++) {
+		hold_statistics *h = &step_hold[chan];
+		raw_statistics *out = &stats[chan];
+		memset(out, 0, sizeof(*out));
+		if(h->scans != 0) {
+			out->min = h->min;
+			out->max = h->max;
+			out->mean = (h->sum + (int64)(h->scans / 2)) / (int64)h->scans;
+		}
+		h->scans = 0;
+		h->sum = 0;
+	}
+}
+#endif
+
+static void convert(const running_statistics *r, int16 offset, int (*span)(int32), channel_statistics *out) {
+	out->min = span((int32)(r->min - offset) << 8);
+	out->max = span((int32)(r->max - offset) << 8);
+	out->mean = span(r->mean - ((int32)offset << 8));
+	out->ripple = span((int32)(r->max - r->min) << 8);
+	// Variance in counts squared, Q16, for a Q8 deviation
+	uint64 variance = (r->m2 < ((uint64)1 << 50))?(r->m2 << 13) / r->scans:(r->m2 / r->scans) << 13;
+	out->deviation = span(isqrt(variance));
+}
+
+// The last finished window, or the one so far with a window of 0. Zeros if
+// there's nothing yet.
+void get_statistics(statistics *stats) {
+	running_statistics copy[FILTER_CHANNELS];
+	taskENTER_CRITICAL();
+	memcpy(copy, finished, sizeof(copy));
+	taskEXIT_CRITICAL();
+
+	memset(stats, 0, sizeof(*stats));
+	stats->scans = copy[FILTER_CURRENT].scans;
+	if(stats->scans == 0)
+		return;
+	convert(&copy[FILTER_CURRENT], settings->adc_current_offset, current_span_from_raw, &stats->channel[FILTER_CURRENT]);
+	convert(&copy[FILTER_VOLTAGE], settings->adc_voltage_offset, voltage_span_from_raw, &stats->channel[FILTER_VOLTAGE]);
+}
+
+#else
+
+void statistics_block(const int16 (*scans)[ADC_RING_CHANNELS]) {
+}
+
+void set_statistics_window(uint16 blocks) {
+}
+
+uint16 get_statistics_window() {
+	return 0;
+}
+
+void statistics_reset() {
+}
+
+void holds_reset() {
+}
+
+void get_holds(hold_readings *holds) {
+	memset(holds, 0, sizeof(*holds));
+}
+
+void get_statistics(statistics *stats) {
+	memset(stats, 0, sizeof(*stats));
+}
+
+#endif
+
+uint32 isqrt(uint64 n) {
+	uint64 root = 0;
+	uint64 bit = (uint64)1 << 62;
+	while(bit > n)
+		bit >>= 2;
+	while(bit != 0) {
+		if(n >= root + bit) {
+			n -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,167 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <stdlib.h>
+#include "tasks.h"
+#include "config.h"
+
+// I-V sweep: steps a C/C setpoint from one current to another and records the
+// settled current and voltage at each step. It runs in the ADC task, a step
+// per settled block, so a sweep takes a fixed number of blocks rather than a
+// host's round trips. After each step it waits at least settle_blocks, then
+// until the block mean voltage moves by no more than SWEEP_SETTLE_COUNTS
+// between blocks, giving up after SWEEP_SETTLE_TIMEOUT blocks. Readings are
+// kept raw, in the shared scratch buffer, and converted when they're reported.
+// Only in builds with USE_SWEEP defined.
+
+#ifdef USE_SWEEP
+
+static uint8 point_count = 0;	// Points in the table
+static uint8 points_wanted;
+static volatile int8 sweep_index = -1;	// Point being measured, -1 when idle
+static int sweep_from, sweep_step;
+static uint8 settle_blocks, blocks_waited;
+static uint8 unsettled;
+static int16 last_voltage;
+
+static void start_point() {
+	set_current(sweep_from + sweep_step * sweep_index);
+	blocks_waited = 0;
+}
+
+int sweep_start(int from, int to, int count, int settle) {
+	if(count < 2 || count > SWEEP_MAX_POINTS || from < 0 || to < 0 || settle < 1 || settle > SWEEP_SETTLE_TIMEOUT)
+		return 0;
+
+	sweep_stop();
+	sequence_stop();
+	mppt_stop();
+	battery_stop();
+	ocp_stop();
+	scratch_claim(SCRATCH_SWEEP);
+	set_load_mode(LOAD_MODE_CC);
+	set_output_mode(OUTPUT_MODE_FEEDBACK);
+	sweep_from = from;
+	sweep_step = (to - from) / (count - 1);
+	settle_blocks = settle;
+	points_wanted = count;
+	point_count = 0;
+	unsettled = 0;
+	set_current(from);
+	blocks_waited = 0;
+	// Last, as the ADC task takes over from here
+	sweep_index = 0;
+	return 1;
+}
+
+static void finish() {
+	sweep_index = -1;
+	set_current(0);
+	defer_post(DEFER_SWEEP_DONE);
+}
+
+// Abandons a sweep, keeping the points taken so far
+void sweep_stop() {
+	if(sweep_index < 0)
+		return;
+	sweep_index = -1;
+	set_current(0);
+}
+
+// Called by the ADC task with each block's means
+void sweep_block(const int16 *mean) {
+	if(sweep_index < 0)
+		return;
+
+	int16 voltage = mean[FILTER_VOLTAGE];
+	int16 change = voltage - last_voltage;
+	last_voltage = voltage;
+	if(++blocks_waited < settle_blocks)
+		return;
+	if(abs(change) > SWEEP_SETTLE_COUNTS) {
+		if(blocks_waited < SWEEP_SETTLE_TIMEOUT)
+			return;
+		unsettled++;
+	}
+
+	scratch.sweep[point_count].raw_current = mean[FILTER_CURRENT];
+	scratch.sweep[point_count].raw_voltage = voltage;
+	point_count++;
+
+	if(++sweep_index >= points_wanted) {
+		finish();
+	} else {
+		start_point();
+	}
+}
+
+// The point being measured, or -1 when no sweep is running
+int get_sweep_index() {
+	return sweep_index;
+}
+
+int get_sweep_length() {
+	return scratch_owned(SCRATCH_SWEEP)?point_count:0;
+}
+
+// Points that timed out before settling in the last sweep
+int get_sweep_unsettled() {
+	return unsettled;
+}
+
+// The setpoint of point i in the last sweep
+int get_sweep_setpoint(int i) {
+	return sweep_from + sweep_step * i;
+}
+
+const sweep_point *get_sweep_point(int i) {
+	return &scratch.sweep[i];
+}
+
+#else
+
+int sweep_start(int from, int to, int count, int settle) {
+	return 0;
+}
+
+void sweep_stop() {
+}
+
+void sweep_block(const int16 *mean) {
+}
+
+int get_sweep_index() {
+	return -1;
+}
+
+int get_sweep_length() {
+	return 0;
+}
+
+int get_sweep_unsettled() {
+	return 0;
+}
+
+int get_sweep_setpoint(int i) {
+	return 0;
+}
+
+const sweep_point *get_sweep_point(int i) {
+	return NULL;
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -14,41 +14,287 @@
 #include <queue.h>
 #include <task.h>
 
+extern xTaskHandle adc_task;
 extern xTaskHandle comms_task;
 extern xTaskHandle ui_task;
+extern portSTACK_TYPE ui_stack[];
 
-extern xQueueHandle ui_queue;
 extern xQueueHandle comms_queue;
+extern xQueueHandle stream_queue;
+extern xQueueHandle sequence_log_queue;
+extern xQueueHandle datalog_queue;
 
 typedef enum {
 	UI_EVENT_NONE,
 	UI_EVENT_BUTTONPRESS,
 	UI_EVENT_UPDOWN,
 	UI_EVENT_ADC_READING,
-	UI_EVENT_OVERTEMP,
+	UI_EVENT_FAULT,		// The output has tripped; get_last_fault() says why
+	UI_EVENT_BENCH,		// Run the display benchmarks for 'bench'
+	UI_EVENT_GESTURE,	// int_arg is the ui_gesture the button made
 } ui_event_type;
 
+typedef enum {
+	GESTURE_CLICK,
+	GESTURE_DOUBLE_CLICK,
+	GESTURE_LONG_PRESS,	// As soon as the press has lasted BUTTON_HOLD_US
+	GESTURE_PRESS_TURN,	// The release of a press the knob turned during
+} ui_gesture;
+
 typedef struct {
 	ui_event_type type;
 	int int_arg;
-	portTickType when;
+	uint32 when; // Microseconds, from get_time_us()
 } ui_event;
 
-#define MAX_COMMS_LINE_LENGTH 40
+// Input for the UI task, latched until next_event takes it. Lower bits are
+// delivered first.
+typedef enum {
+	UI_POST_FAULT = 0x1,
+	UI_POST_BENCH = 0x2,
+	UI_POST_BUTTONDOWN = 0x4,
+	UI_POST_BUTTONUP = 0x8,
+	// A bit per ui_gesture, in order; a click comes before whatever the
+	// press after it turns into
+	UI_POST_CLICK = 0x10,
+	UI_POST_DOUBLE_CLICK = 0x20,
+	UI_POST_LONG_PRESS = 0x40,
+	UI_POST_PRESS_TURN = 0x80,
+} ui_post_flag;
+
+void ui_post(uint8 flags);
+void ui_post_from_isr(uint8 flags);
+void ui_activity();
+void ui_remote_command();
+void ui_set_remote(uint8 locked);
+uint8 ui_get_remote();
+void ui_set_remote_auto(uint8 enabled);
+uint8 ui_get_remote_auto();
+
+#define MAX_COMMS_LINE_LENGTH 72 // Less than half COMMS_RX_BUFFER_SIZE
+#define COMMS_RX_BUFFER_SIZE 160 // Up to 255; holds several pipelined lines
+#define COMMS_TX_BUFFER_SIZE 64 // Power of two
+#define COMMS_QUEUE_LENGTH 1 // Events; the lines and notifications they announce wait in rings of their own
+#define COMMS_RX_TIMES 8 // Power of two; receive times kept for lines waiting in the ring, for 'ping'
+#define COMMS_DEFAULT_BAUD 115200 // As configured in the UART component
+#define COMMS_BAUD_CONFIRM_MS 1000 // How long the host has to confirm a new baud rate
+#define COMMS_BOOTLOAD_CONFIRM_MS 5000 // How long the host has to echo the bootload code
+// The bootloader's run type, which a software reset leaves alone: the word
+// after its RAM vector table. This application isn't built as a Bootloadable,
+// so 'bootload' asks for the bootloader there itself, as Bootloadable_Load()
+// would, and resets.
+#define BOOTLOADER_RUN_TYPE (*(reg32 *)(CYDEV_SRAM_BASE + (CY_INT_IRQ_BASE + CY_NUM_INTERRUPTS) * sizeof(cyisraddress)))
+#define BOOTLOADER_SCHEDULE_BTLDR 0x40
+
+// Reported by 'id'. The protocol number goes up with any change a host has to
+// know about, so tools can check that rather than the version.
+#define FIRMWARE_VERSION "1.0"
+#define PROTOCOL_VERSION 1
 
 typedef enum {
 	COMMS_EVENT_LINE_RX,
 	COMMS_EVENT_MONITOR_DATA,
-	COMMS_EVENT_OVERTEMP,
+	COMMS_EVENT_NOTIFY,	// Notifications are waiting in their ring
+	COMMS_EVENT_STREAM_DATA,
+	COMMS_EVENT_SEQUENCE_LOG,
+	COMMS_EVENT_DATALOG,
+	COMMS_EVENT_BENCH,	// The UI has finished its benchmarks
+	COMMS_EVENT_SWEEP_DONE,	// The table is ready to send
+	COMMS_EVENT_CAPTURE_DONE,	// So is a triggered capture
+	COMMS_EVENT_IMPEDANCE_DONE,	// And an impedance sweep's
+	COMMS_EVENT_OCP_DONE,	// An OCP test has tripped or run out of ramp
+	COMMS_EVENT_LOADREG_DONE,	// A load regulation table is ready to send
+	COMMS_EVENT_BAUD,	// Switch to the rate passed to request_baud
+	COMMS_EVENT_SETPOINT_ACK,	// A fast set frame's setpoint has been applied
 } comms_event_type;
 
 typedef struct {
 	comms_event_type type;
 } comms_event;
 
+// One 'bench' figure
+typedef struct {
+	const char *name;
+	uint32 cycles; // Per call
+} bench_result;
+
+#define UI_BENCH_COUNT 3
+extern bench_result ui_bench_results[UI_BENCH_COUNT];
+
+// Binary stream record, as sent on the wire (little-endian, no padding):
+//   sync:u8 (0xA5) | sequence:u16 | timestamp:u32 (us) | current:i32 (uA) | voltage:i32 (uV) | flags:u8 | crc:u16
+// flags bit 0 is set while a pulse is in its high phase, and bit 1 if a pulse
+// edge fell inside the block. The CRC is CRC-16/CCITT (polynomial 0x1021, initial
+// value 0xFFFF) over everything from sequence to flags. Gaps in the sequence number
+// mean records were dropped because the UART couldn't keep up. Once 'sync' has
+// paired an edge, timestamps are on the leading unit's clock (timesync.c).
+#define STREAM_SYNC 0xA5
+#define STREAM_QUEUE_LENGTH 4
+
+// Naming channels in 'stream' switches to channel records instead, which carry
+// only the channels asked for, each in every so many records ('every'):
+//   sync:u8 (0xAA) | sequence:u16 | timestamp:u32 (us) | present:u8 | dropped:u16 | values | crc:u16
+// present has a bit per stream_channel in this record, and values has each of
+// those in channel order, at the size in stream_channel_sizes (comms.c).
+// dropped counts, since 'stream' started it, the records that weren't sent,
+// whether the comms task fell behind or the host ran out of credit. The
+// layout is described by a header, sent before the first record and again
+// before every record whose sequence number is a multiple of 256:
+//   sync:u8 (0xAB) | blocks:u8 | count:u8 | count * (channel:u8 | size:u8 | every:u8) | crc:u16
+// Both CRCs are the same as stream records', over everything after sync.
+#define STREAM_SYNC_CHANNELS 0xAA
+#define STREAM_SYNC_HEADER 0xAB
+#define STREAM_HEADER_INTERVAL 256 // Records
+
+// Flow control, for hosts that can stall without losing the port. Once a host
+// sends 'credit <records>', each record sent uses one credit and the host
+// grants more as it reads them. Out of credit, only every
+// STREAM_DEGRADED_EVERY-th record is sent, so a stalled host overruns its
+// buffers that much later and a slow one still sees the trend. Starting a
+// stream turns flow control off until the next grant.
+#define STREAM_DEGRADED_EVERY 16
+#define STREAM_CREDIT_MAX 1024 // Records, however much is granted
+
+typedef enum {
+	STREAM_CURRENT,		// i32, uA, the block's
+	STREAM_VOLTAGE,		// i32, uV
+	STREAM_POWER,		// i32, uW, of the two
+	STREAM_TEMPERATURE,	// i16, degrees C
+	STREAM_OPAMP,		// i16, counts, the opamp output in the block's last scan
+	STREAM_FET,			// i16, counts, and the FET's input
+	STREAM_SETPOINT,	// i32, uA, the current setpoint
+	STREAM_FLAGS,		// u16, as stream_record's flags, then load_mode | output_mode << 4
+	STREAM_CHANNELS,
+} stream_channel;
+
+// Binary command frame, accepted alongside text commands (little-endian):
+//   sync:u8 (0xA6) | opcode:u8 | len:u8 | payload[len] | crc:u16
+// or, to a unit on a shared bus (see the 'address' command):
+//   sync:u8 (0xA7) | address:u8 | opcode:u8 | len:u8 | payload[len] | crc:u16
+// The CRC is the same CRC-16/CCITT as stream records, over everything after
+// sync. Address FRAME_BROADCAST reaches every unit, and none of them reply.
+// A frame has to fit in MAX_COMMS_LINE_LENGTH bytes. Opcodes are listed in
+// comms.c; replies carry the opcode with FRAME_REPLY set, and FRAME_ERROR
+// answers a frame that was corrupt or had an unknown opcode. A fast set
+// frame is taken by the UART ISR itself and acknowledged once it's applied,
+// so its reply can come between others'.
+#define FRAME_SYNC 0xA6
+#define FRAME_SYNC_ADDRESSED 0xA7
+#define FRAME_BROADCAST 0xFF
+#define FRAME_HEADER_LENGTH 3
+#define FRAME_REPLY 0x80
+#define FRAME_ERROR 0xFF
+
+typedef struct __attribute__((packed)) {
+	uint8 sync;
+	uint16 sequence;
+	uint32 timestamp;
+	int32 current;
+	int32 voltage;
+	uint8 flags;
+	uint16 crc;
+} stream_record;
+
+// One record's worth, as queued by the ADC task for the comms task to send
+// as a stream_record or a channel record
+typedef struct __attribute__((packed)) {
+	uint8 sync;			// STREAM_SYNC or STREAM_SYNC_CHANNELS
+	uint8 present;		// Channels in a channel record
+	uint16 sequence;
+	uint16 dropped;		// Records the ADC task couldn't queue, so far
+	uint32 timestamp;
+	int32 current;
+	int32 voltage;
+	int32 setpoint;
+	int16 temperature;
+	int16 opamp;
+	int16 fet;
+	uint8 flags;
+	uint8 mode;
+} stream_sample;
+
+// Measurements taken by the sequencer just before each step boundary
+typedef struct {
+	uint32 timestamp;	// Microseconds, from get_time_us()
+	int32 current;		// Microamps
+	int32 voltage;		// Microvolts
+	int8 step;			// The step that just ended
+} sequence_log_entry;
+
+// One logger sample, as queued by the ADC task
+typedef struct __attribute__((packed)) {
+	uint32 timestamp;	// Milliseconds since logging started
+	uint16 current;		// Milliamps
+	uint16 voltage;		// Millivolts
+} datalog_record;
+
+#define DATALOG_FORMAT 2 // Compact rows; format 1 was fixed 8 byte records
+#define DATALOG_ROW_DATA 112
+
+// A flash row of the log, as stored and as sent by 'log dump' (little-endian).
+// Rows are written oldest to newest with an increasing sequence number, so
+// after a reset the logger carries on after the newest one. The CRC is the
+// same CRC-16/CCITT as stream records, over everything but itself.
+//
+// Each row stands alone. Sample times are implicit: the first is at
+// timestamp, the rest interval apart, and a missed sample starts a new row.
+// data holds count samples, each a current then a voltage as LEB128 varints:
+// the first sample as is, the rest as zig-zag encoded differences from the
+// sample before, so a slowly changing reading takes a byte or two a sample.
+// tools/datalog.py decodes them.
+typedef struct __attribute__((packed)) {
+	uint32 sequence;	// 0 for a row that was never written
+	uint16 count;		// Samples in data
+	uint16 crc;
+	uint8 format;		// DATALOG_FORMAT
+	uint8 used;			// Bytes of data in use
+	uint16 interval;	// Milliseconds between samples
+	uint32 timestamp;	// Milliseconds since logging started, of the first sample
+	uint8 data[DATALOG_ROW_DATA];
+} datalog_row;
+
+// Everything the 'status' command reports, sampled at one instant. The status
+// frame replies with this as its payload (little-endian, no padding).
+typedef struct __attribute__((packed)) {
+	int32 setpoint;		// Microamps
+	int32 current;		// Microamps
+	int32 voltage;		// Microvolts
+	int32 power;		// Microwatts
+	int32 resistance;	// Milliohms, or -1 with no current flowing
+	uint8 load_mode;	// load_mode
+	uint8 output_mode;	// output_mode
+	int16 opamp_out;	// Raw ADC counts, as 'info fet' in 'debug'
+	int16 fet_in;
+	int16 temperature;	// Die temperature, degrees C
+	uint16 dither_rate;	// Hz the low IDAC is dithered at, 0 when it isn't
+	uint8 dither_fraction;	// 256ths of a low IDAC code it adds on average
+} status_snapshot;
 
 void vTaskUI(void *pvParameters);
 void vTaskComms(void *pvParameters);
+void vTaskADC(void *pvParameters);
 void start_adc();
+void start_comms();
+void start_ui();
+
+// Periodic jobs, timed by the tick hook and done by the task that takes them
+typedef enum {
+	SCHEDULE_UI_REFRESH,	// Redraw the readings, every 1 / ui_refresh_rate
+	SCHEDULE_DATALOG,		// Take a datalog sample
+	SCHEDULE_JOBS,
+} schedule_job;
+
+portTickType schedule_set(schedule_job job, portTickType period);
+int schedule_take(schedule_job job, portTickType *due);
+void schedule_tick();
+
+// Serial output, for the comms task only
+int uart_try_write(const uint8 *data, uint8 len);
+void uart_write(const uint8 *data, int len);
+void uart_puts(const char *s);
+int get_baud();
+int request_baud(int baud);
+
+int scpi_handle(char *line);
 
 /* [] END OF FILE */
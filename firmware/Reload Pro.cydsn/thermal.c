@@ -0,0 +1,304 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "config.h"
+
+// Die temperature, from the SAR's ADC_CHAN_TEMP settings on the injection
+// channel, in turn with the other slow channels. The ADC task filters the
+// latest reading each block and converts the result to degrees
+// once every THERMAL_INTERVAL_US, when it also refreshes the temperature
+// corrections to the ADC gains and the derating limit. The limit works from
+// the temperature projected THERMAL_LOOKAHEAD seconds ahead on its present
+// trend, so the current comes down while the unit is still heating rather
+// than after a trip.
+//
+// The die only sees the heatsink second hand, so a first order RC model of
+// the heatsink runs alongside, driven by the measured power: it rises towards
+// power * thermal_resistance above the die temperature with time constant
+// thermal_tau. Every THERMAL_MODEL_US the MOSFET's safe operating area at the
+// modelled heatsink temperature and the present voltage gives a second
+// current limit: the power that takes the junction to junction_max through
+// junction_resistance, cut back in proportion above soa_knee where second
+// breakdown sets in. set_current applies the lower of the two limits.
+//
+// Pulses get more than that: the die heats through its own thermal mass,
+// with time constant THERMAL_JUNCTION_TAU_US, so a pulse t long at duty D
+// rises by only D + (1 - D)(1 - e^(-t / tau)) of its steady state rise over
+// the heatsink. get_pulse_limit() allows the peak that takes the junction to
+// junction_max by that fraction, which the transient generator holds its
+// high level to. 1 - e^(-x) is taken as 2x / (2 + x), never below it, so the
+// limit errs low. Behind that, a model of the die over the heatsink steps
+// every block on the block's mean power with the same time constant, and
+// trips FAULT_SOA THERMAL_JUNCTION_MARGIN past junction_max, for waveforms
+// the pulse limit doesn't foresee.
+
+static int32 filtered = -1;	// Counts << THERMAL_FILTER_SHIFT, -1 until the first block
+static uint32 last_update;
+static volatile int temperature, predicted;
+static int last_temperature;
+static int rate;			// Degrees per second, Q4
+static volatile int current_limit = CURRENT_FULLRANGE_MAX;
+static int derate_limit = CURRENT_FULLRANGE_MAX;
+static volatile int soa_limit = CURRENT_FULLRANGE_MAX;
+
+static uint32 last_model;
+static uint64 power_sum;	// Microwatts, one per block
+static uint32 voltage_sum;	// Millivolts, one per block
+static uint16 model_blocks;
+static volatile int32 rise;	// Modelled heatsink rise over the die, microdegrees
+static int32 commanded_rise; // Where the present setpoint would take it, microdegrees
+static volatile int64 pulse_headroom; // Microdegrees the junction may rise, as of the last step
+static volatile int pulse_voltage; // Millivolts, the last step's mean
+static int32 junction_rise;	// Modelled die over the heatsink, microdegrees
+static uint32 last_block;
+
+static int derate(int celsius) {
+	if(celsius <= THERMAL_DERATE_START)
+		return CURRENT_FULLRANGE_MAX;
+	if(celsius >= THERMAL_DERATE_END)
+		return 0;
+	return (int64)CURRENT_FULLRANGE_MAX * (THERMAL_DERATE_END - celsius) / (THERMAL_DERATE_END - THERMAL_DERATE_START);
+}
+
+static void apply_limit() {
+	int limit = (derate_limit < soa_limit)?derate_limit:soa_limit;
+	if(limit != current_limit) {
+		current_limit = limit;
+		// Feedback modes set the current every block anyway; C/C needs a nudge
+		if(get_load_mode() == LOAD_MODE_CC)
+			set_current(get_current_setpoint());
+	}
+	pulse_update_limit();
+}
+
+// Steps the heatsink model over the last THERMAL_MODEL_US and works out the
+// SOA limit at that temperature and the mean voltage
+static void update_model() {
+	uint32 power = power_sum / model_blocks;
+	int voltage = voltage_sum / model_blocks;
+	power_sum = voltage_sum = model_blocks = 0;
+
+	int32 target = ((int64)power * settings->thermal_resistance) / 1000;
+	rise += ((int64)(target - rise) * THERMAL_MODEL_US) / ((int64)settings->thermal_tau * 1000000);
+	uint32 commanded = (get_output_mode() == OUTPUT_MODE_OFF)?0:power_from(get_current_setpoint(), MILLIVOLTS(voltage));
+	commanded_rise = ((int64)commanded * settings->thermal_resistance) / 1000;
+
+	int64 headroom = (int64)settings->junction_max * 1000000 - ((int64)temperature * 1000000 + rise);
+	uint8 int_state = CyEnterCriticalSection();
+	pulse_headroom = headroom;
+	pulse_voltage = voltage;
+	CyExitCriticalSection(int_state);
+	if(headroom <= 0) {
+		soa_limit = 0;
+		// The limit only stops new current; anything already flowing is a fault
+		if(get_output_mode() != OUTPUT_MODE_OFF && power > 0)
+			fault_trip(FAULT_SOA);
+		return;
+	}
+	if(voltage < THERMAL_SOA_MIN_VOLTAGE) {
+		// Too little across the FET to dissipate anything that matters
+		soa_limit = CURRENT_FULLRANGE_MAX;
+		return;
+	}
+	int64 allowed = headroom * 1000 / settings->junction_resistance; // Microwatts
+	if(voltage > settings->soa_knee)
+		allowed = allowed * settings->soa_knee / voltage;
+	int64 limit = allowed * 1000 / voltage; // Microamps
+	soa_limit = (limit > CURRENT_FULLRANGE_MAX)?CURRENT_FULLRANGE_MAX:(int)limit;
+}
+
+// Steps the die over the heatsink on one block's power, and trips if it's
+// well past junction_max
+static void step_junction(uint32 power, uint32 timestamp) {
+	uint32 elapsed = timestamp - last_block;
+	last_block = timestamp;
+	int32 target = ((int64)power * settings->junction_resistance) / 1000;
+	if(elapsed >= THERMAL_JUNCTION_TAU_US)
+		junction_rise = target;
+	else
+		junction_rise += ((int64)(target - junction_rise) * elapsed) / THERMAL_JUNCTION_TAU_US;
+
+	int64 junction = (int64)temperature * 1000000 + rise + junction_rise;
+	if(junction >= (int64)(settings->junction_max + THERMAL_JUNCTION_MARGIN) * 1000000
+	   && get_output_mode() != OUTPUT_MODE_OFF)
+		fault_trip(FAULT_SOA);
+}
+
+#ifdef USE_FAN
+// A PI loop holds the modelled heatsink at fan_target. It works from the
+// larger of the model's present rise and the steady state rise of the power
+// now commanded, so a step up in setpoint spins the fan up straight away
+// rather than once the heatsink has spent minutes warming. The model's
+// thermal_resistance is for still air, so with the fan running it reads high
+// and errs towards more cooling.
+static int fan_target = FAN_DEFAULT_TARGET;	// Degrees C
+static int fan_override = -1;	// Percent from 'temp fan', or -1 for the loop
+static int32 fan_integral;		// Millipercent
+static uint8 fan_duty;
+
+void fan_init() {
+	Fan_PWM_Start();
+	Fan_PWM_WriteCompare(0);
+}
+
+static void update_fan() {
+	int32 projected = (commanded_rise > rise)?commanded_rise:rise;
+	int32 error = temperature * 1000 + projected / 1000 - fan_target * 1000; // Millidegrees
+	fan_integral += ((int64)error * FAN_KI * THERMAL_MODEL_US) / 1000000;
+	if(fan_integral < 0)
+		fan_integral = 0;
+	if(fan_integral > 100000)
+		fan_integral = 100000;
+
+	int32 duty = (error * FAN_KP + fan_integral) / 1000;
+	if(duty > 100)
+		duty = 100;
+	if(duty < FAN_MIN_DUTY)
+		// Once running it stays at the minimum until the loop wants nothing
+		duty = (fan_duty > 0 && duty > 0)?FAN_MIN_DUTY:0;
+	if(fan_override >= 0)
+		duty = fan_override;
+	if(duty != fan_duty) {
+		fan_duty = duty;
+		Fan_PWM_WriteCompare(duty);
+	}
+}
+
+void set_fan_target(int celsius) {
+	fan_target = celsius;
+}
+
+int get_fan_target() {
+	return fan_target;
+}
+
+// Percent, or -1 to hand the fan back to the loop
+void set_fan_override(int percent) {
+	fan_override = percent;
+}
+
+int get_fan_override() {
+	return fan_override;
+}
+
+int get_fan_duty() {
+	return fan_duty;
+}
+#endif
+
+// Called by the ADC task after each block
+void thermal_block(const int16 *mean, uint32 timestamp) {
+	int16 raw = get_adc_slow(ADC_SLOW_TEMP);
+	if(filtered < 0) {
+		filtered = (int32)raw << THERMAL_FILTER_SHIFT;
+		last_update = timestamp - THERMAL_INTERVAL_US;
+		last_model = last_block = timestamp;
+		last_temperature = temperature = DieTemp_1_CountsTo_Celsius(raw);
+	}
+	filtered += raw - (filtered >> THERMAL_FILTER_SHIFT);
+
+	int voltage = voltage_from_raw(mean[FILTER_VOLTAGE]);
+	uint32 power = power_from(current_from_raw(mean[FILTER_CURRENT]), voltage);
+	power_sum += power;
+	step_junction(power, timestamp);
+	voltage_sum += div1000(voltage);
+	model_blocks++;
+	if(timestamp - last_model >= THERMAL_MODEL_US) {
+		last_model = timestamp;
+		update_model();
+		apply_limit();
+#ifdef USE_FAN
+		update_fan();
+#endif
+	}
+
+	if(timestamp - last_update < THERMAL_INTERVAL_US)
+		return;
+	last_update = timestamp;
+
+	int now = DieTemp_1_CountsTo_Celsius(filtered >> THERMAL_FILTER_SHIFT);
+	rate += (((now - last_temperature) << 4) - rate) >> THERMAL_RATE_SHIFT;
+	last_temperature = now;
+	temperature = now;
+	predicted = now + ((rate > 0)?(rate * THERMAL_LOOKAHEAD) >> 4:0);
+	calibration_set_temperature(now);
+	if(now >= FAULT_OVERTEMP_LIMIT && get_output_mode() != OUTPUT_MODE_OFF)
+		fault_trip(FAULT_OVERTEMP);
+
+	derate_limit = derate(predicted);
+	apply_limit();
+}
+
+// Degrees C, filtered
+int get_temperature() {
+	return temperature;
+}
+
+// Degrees C, THERMAL_LOOKAHEAD seconds ahead on the present trend
+int get_predicted_temperature() {
+	return predicted;
+}
+
+// Degrees C, the modelled heatsink
+int get_heatsink_temperature() {
+	return temperature + rise / 1000000;
+}
+
+// Microamps the safe operating area allows at the present voltage
+int get_soa_limit() {
+	return soa_limit;
+}
+
+// Microamps set_current allows: the lower of the derating and SOA limits
+int get_current_limit() {
+	return current_limit;
+}
+
+// Microamps the high phase of a pulse width_us long at duty percent may be,
+// with low microamps between pulses, held to the derating limit too. At a
+// duty of 100 it's the SOA limit.
+int get_pulse_limit(uint32 width_us, uint8 duty, int low) {
+	uint8 int_state = CyEnterCriticalSection();
+	int64 headroom = pulse_headroom;
+	int voltage = pulse_voltage;
+	CyExitCriticalSection(int_state);
+
+	int limit = CURRENT_FULLRANGE_MAX;
+	if(headroom <= 0) {
+		limit = 0;
+	} else if(voltage >= THERMAL_SOA_MIN_VOLTAGE) {
+		// Parts per million of the steady state rise a pulse reaches
+		uint32 transient = ((uint64)2000000 * width_us) / (2 * THERMAL_JUNCTION_TAU_US + width_us);
+		uint32 fraction = duty * 10000 + (uint32)(((uint64)(100 - duty) * transient) / 100);
+		// The low level heats the junction all the time, the rest of the peak
+		// only by the fraction
+		int64 low_power = (int64)low * voltage / 1000; // Microwatts
+		int64 spare = headroom - low_power * settings->junction_resistance / 1000;
+		int64 allowed = low_power;
+		if(spare > 0)
+			allowed += spare * 1000 / settings->junction_resistance * 1000000 / fraction;
+		if(voltage > settings->soa_knee)
+			allowed = allowed * settings->soa_knee / voltage;
+		int64 current = allowed * 1000 / voltage;
+		if(current < limit)
+			limit = current;
+	}
+	return (derate_limit < limit)?derate_limit:limit;
+}
+
+// Degrees C, the modelled die, pulses and all
+int get_junction_temperature() {
+	return temperature + (rise + junction_rise) / 1000000;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,92 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "config.h"
+
+// TCPWM counters in timer mode, driven here by register. None of them is
+// placed in the schematic, so there are no generated APIs and nothing for the
+// fitter to route: each counts its peripheral clock with both trigger inputs
+// tied off, and its interrupt is the counter's fixed NVIC line. The clock is
+// integer divider C00 at 1MHz, which clock.c scales along with the others.
+
+#define TIMER_REG(counter, reg) (*(reg32 *)(CYDEV_TCPWM_CNT0_BASE + (counter) * CYDEV_TCPWM_CNT0_SIZE + \
+	(CYREG_TCPWM_CNT0_##reg - CYDEV_TCPWM_CNT0_BASE)))
+
+#define TIMER_CLOCK_ENABLE 0x80000000
+#define TIMER_CLOCK_DIVIDER_C00 0x30 // The CLK_SELECT code for it
+#define TIMER_COUNT_ALWAYS 0x10 // TR_CTRL0: count input tied to '1'
+#define TIMER_TRIGGERS_LEVEL 0x3FF // TR_CTRL1: every input used as a level, so the tied-off ones stay idle
+#define TIMER_CMD_START_SHIFT 24
+
+// Sets C00 to 1MHz at the current CPU clock; called once, before any counter
+// starts. HFCLK is a whole number of MHz, so the division is exact.
+void start_timers() {
+	CY_SET_REG32(CYREG_CLK_DIVIDER_C00, TIMER_CLOCK_ENABLE | (get_cpu_clock() / TIMER_CLOCK_HZ - 1));
+}
+
+// Starts counter from zero, counting up to period and wrapping, with the
+// interrupts in mask (TIMER_INTR_*) calling isr at priority.
+void timer_start(uint8 counter, uint16 period, uint32 mask, cyisraddress isr, uint8 priority) {
+	uint8 irq = TIMER_IRQ_BASE + counter;
+
+	CY_SET_REG32(CYREG_TCPWM_CTRL, CY_GET_REG32(CYREG_TCPWM_CTRL) & ~(1u << counter));
+	CY_SET_REG32(TIMER_CLK_SELECT + counter * sizeof(reg32), TIMER_CLOCK_DIVIDER_C00);
+	TIMER_REG(counter, CTRL) = 0; // Timer mode, counting up, no prescaler
+	TIMER_REG(counter, TR_CTRL0) = TIMER_COUNT_ALWAYS;
+	TIMER_REG(counter, TR_CTRL1) = TIMER_TRIGGERS_LEVEL;
+	TIMER_REG(counter, PERIOD) = period;
+	TIMER_REG(counter, COUNTER) = 0;
+	TIMER_REG(counter, INTR) = TIMER_INTR_TC | TIMER_INTR_CC_MATCH;
+	TIMER_REG(counter, INTR_MASK) = mask;
+
+	CyIntDisable(irq);
+	CyIntSetVector(irq, isr);
+	CyIntSetPriority(irq, priority);
+	CyIntClearPending(irq);
+	CyIntEnable(irq);
+
+	CY_SET_REG32(CYREG_TCPWM_CTRL, CY_GET_REG32(CYREG_TCPWM_CTRL) | (1u << counter));
+	CY_SET_REG32(CYREG_TCPWM_CMD, 1u << (TIMER_CMD_START_SHIFT + counter));
+}
+
+void timer_stop(uint8 counter) {
+	CyIntDisable(TIMER_IRQ_BASE + counter);
+	CY_SET_REG32(CYREG_TCPWM_CTRL, CY_GET_REG32(CYREG_TCPWM_CTRL) & ~(1u << counter));
+}
+
+void timer_write_period(uint8 counter, uint16 period) {
+	TIMER_REG(counter, PERIOD) = period;
+}
+
+void timer_write_counter(uint8 counter, uint16 value) {
+	TIMER_REG(counter, COUNTER) = value;
+}
+
+void timer_write_compare(uint8 counter, uint16 value) {
+	TIMER_REG(counter, CC) = value;
+}
+
+uint16 timer_read_counter(uint8 counter) {
+	return TIMER_REG(counter, COUNTER);
+}
+
+// The pending TIMER_INTR_* causes, whether or not they're enabled
+uint32 timer_get_interrupt(uint8 counter) {
+	return TIMER_REG(counter, INTR);
+}
+
+void timer_clear_interrupt(uint8 counter, uint32 source) {
+	TIMER_REG(counter, INTR) = source;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,114 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "config.h"
+
+// Time sync between units. Each unit's microsecond clock runs at its own
+// crystal's rate, so the streams of a rack drift apart. One unit leads: 'sync
+// pulse' pulses its trigger output and reports its own time of the edge, which
+// every unit wired to the trigger notes from its trigger input's interrupt. The
+// host then passes the leader's time on to all of them, leader included, with
+// 'sync <us>'. Each unit pairs it with its own time of the same edge, so they
+// agree to within the edge's interrupt latency however late the host is. From
+// successive edges each estimates its rate against the leader's clock, and
+// timesync_convert() maps its times onto the leader's in between.
+//
+// Any edge counts, so the sequencer's step pulses and the trigger actions
+// mustn't run between a pulse and its 'sync', and a sync pulse fires whatever
+// is armed on the other units.
+
+static volatile uint32 edge_time;	// Ours, of the latest edge
+static volatile uint16 edge_count = 0;
+static uint16 paired_count = 0;
+static uint8 pairs = 0;			// Edges paired, up to 2: none, the offset, and the drift
+static uint32 ref_local, ref_common;	// The last edge, paired
+static int32 drift_ppb = 0;			// The leader's clock's gain on ours, parts per billion
+static int32 last_error = 0;		// How far off the last edge was predicted, microseconds
+
+// From the trigger pin's interrupt
+void timesync_edge() {
+	edge_time = get_time_us();
+	edge_count++;
+}
+
+// Pulses the trigger output as the leader, returning our time of the edge
+uint32 timesync_pulse() {
+	uint8 int_state = CyEnterCriticalSection();
+	uint32 now = get_time_us();
+	trigger_output_write(1);
+	edge_time = now;
+	edge_count++;
+	CyExitCriticalSection(int_state);
+	CyDelayUs(TRIGGER_PULSE_US);
+	trigger_output_write(0);
+	return now;
+}
+
+// Pairs the latest edge with the leader's time of it. Returns 0 if there's
+// been no edge since the last one paired.
+int timesync_set(uint32 common) {
+	uint8 int_state = CyEnterCriticalSection();
+	uint32 local = edge_time;
+	uint16 count = edge_count;
+	CyExitCriticalSection(int_state);
+	if(count == paired_count)
+		return 0;
+	paired_count = count;
+
+	if(pairs) {
+		int32 elapsed = local - ref_local;
+		last_error = common - timesync_convert(local);
+		if(elapsed > 0) {
+			int32 measured = ((int64)(int32)(common - ref_common) - elapsed) * 1000000000 / elapsed;
+			if(measured > TIMESYNC_MAX_DRIFT_PPB)
+				measured = TIMESYNC_MAX_DRIFT_PPB;
+			if(measured < -TIMESYNC_MAX_DRIFT_PPB)
+				measured = -TIMESYNC_MAX_DRIFT_PPB;
+			// The first estimate is taken as it is; after that they're smoothed
+			if(pairs == 1)
+				drift_ppb = measured;
+			else
+				drift_ppb += (measured - drift_ppb) >> TIMESYNC_DRIFT_SHIFT;
+			pairs = 2;
+		}
+	} else {
+		pairs = 1;
+	}
+	ref_local = local;
+	ref_common = common;
+	return 1;
+}
+
+void timesync_stop() {
+	pairs = 0;
+	drift_ppb = 0;
+	last_error = 0;
+}
+
+// One of our get_time_us() times on the leader's clock, or as it is before
+// the first 'sync'. Good for times up to half an hour either side of an edge.
+uint32 timesync_convert(uint32 local) {
+	if(!pairs)
+		return local;
+	int32 elapsed = local - ref_local;
+	return ref_common + elapsed + (int32)((int64)elapsed * drift_ppb / 1000000000);
+}
+
+void get_timesync_status(timesync_status *status) {
+	status->synced = pairs != 0;
+	status->drift_ppb = drift_ppb;
+	status->last_error = last_error;
+	status->edges = edge_count;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,80 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "config.h"
+
+// A ring of timestamped events for chasing latency, from TRACE_EVENT() in the
+// ISRs and tasks and from the kernel's context switch hook. Built only with
+// TRACE defined; otherwise TRACE_EVENT() is empty and this file is too.
+// 'trace dump' sends the ring and tools/trace.py decodes it.
+
+#ifdef TRACE
+
+#if (TRACE_RECORDS & (TRACE_RECORDS - 1)) != 0
+#error "TRACE_RECORDS must be a power of two"
+#endif
+
+static trace_record trace_ring[TRACE_RECORDS];
+static uint16 trace_head = 0;
+static uint16 trace_count = 0;
+static uint16 trace_peak = 0;	// Of trace_count, before the last clear
+static uint8 trace_paused = 0;
+
+// Safe from tasks and from ISRs at any priority. The oldest record is
+// overwritten once the ring is full.
+RAMFUNC void trace_event(trace_event_id id, uint16 arg) {
+	uint8 int_state = CyEnterCriticalSection();
+	if(!trace_paused) {
+		trace_record *record = &trace_ring[trace_head];
+		record->time = get_time_us();
+		record->arg = arg;
+		record->id = id;
+		trace_head = (trace_head + 1) & (TRACE_RECORDS - 1);
+		if(trace_count < TRACE_RECORDS)
+			trace_count++;
+	}
+	CyExitCriticalSection(int_state);
+}
+
+// Stops recording while the ring is read out, so it doesn't move underneath
+void trace_pause(uint8 paused) {
+	trace_paused = paused;
+}
+
+void trace_clear() {
+	uint8 int_state = CyEnterCriticalSection();
+	if(trace_count > trace_peak)
+		trace_peak = trace_count;
+	trace_head = trace_count = 0;
+	CyExitCriticalSection(int_state);
+}
+
+int get_trace_count() {
+	return trace_count;
+}
+
+void get_trace_usage(buffer_usage *usage) {
+	usage->size = TRACE_RECORDS;
+	usage->bytes = sizeof(trace_ring);
+	usage->fill = trace_count;
+	usage->peak = (trace_count > trace_peak)?trace_count:trace_peak;
+}
+
+// The ith oldest record
+const trace_record *get_trace_record(int i) {
+	return &trace_ring[(trace_head + TRACE_RECORDS - trace_count + i) & (TRACE_RECORDS - 1)];
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,140 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include "config.h"
+
+// Hardware trigger for keeping several loads in step. A falling edge on
+// the trigger input runs the armed action straight from its pin interrupt. For a
+// preloaded setpoint the IDAC codes are worked out when it's armed, as the
+// pulse generator does, so the edge costs the interrupt entry and a
+// write_dac(): well under 100 cycles, or about 4us at 24MHz. get_trigger_cycles_max
+// reports the worst case seen, as 'info trigger cycles' in 'debug'. The trigger output pulses high whenever the sequencer steps,
+// so one unit can lead the others. Every edge is also offered to a capture
+// armed on the external trigger, and timed for 'sync' (timesync.c).
+//
+// The lines are only fitted to builds with USE_TRIGGER defined. They aren't
+// in the schematic, so the pins config.h names are set up here by register:
+// firmware controlled in HSIOM, the output driven strong and the input pulled
+// up, interrupting on its port's line. Without them the actions can still be
+// armed, but no edge ever comes and the output pulses go nowhere.
+
+#define TRIGGER_PORT_REG(port, reg) (CYDEV_PRT0_BASE + (port) * CYDEV_PRT0_SIZE + (CYREG_PRT0_##reg - CYDEV_PRT0_BASE))
+#define TRIGGER_HSIOM_REG(port) (CYREG_HSIOM_PORT_SEL0 + (port) * sizeof(reg32))
+#define TRIGGER_HSIOM_MASK 0xF // 4 bits a pin; 0 is firmware controlled
+#define TRIGGER_INTCFG_MASK 0x3 // 2 bits a pin
+#define TRIGGER_INTCFG_FALLING 0x2
+
+static volatile trigger_action action = TRIGGER_OFF;
+static int armed_setpoint;
+static uint8 armed_codes[2]; // high, low
+static uint32 trigger_cycles_max = 0;
+
+CY_ISR(trigger_isr) {
+	uint32 entry_ticks = CySysTickGetValue();
+	CY_SET_REG32(TRIGGER_PORT_REG(TRIGGER_IN_PORT, INTSTAT), 1u << TRIGGER_IN_PIN);
+	timesync_edge();
+	capture_external_edge();
+
+	uint8 acted = 1;
+	switch(action) {
+	case TRIGGER_SET:
+		dither_stop();
+		write_dac(armed_codes[0], armed_codes[1]);
+		state.current_setpoint = armed_setpoint;
+		action = TRIGGER_OFF;
+		break;
+	case TRIGGER_STEP:
+		sequence_next_step();
+		break;
+	default:
+		acted = 0;
+		break;
+	}
+
+	uint32 cycles = cycles_since(entry_ticks);
+	if(acted && cycles > trigger_cycles_max)
+		trigger_cycles_max = cycles;
+	profile_isr(PROFILE_ISR_TRIGGER, entry_ticks);
+}
+
+#ifdef USE_TRIGGER
+static void trigger_pin_setup(uint8 port, uint8 pin, uint32 drive_mode) {
+	CY_SET_REG32(TRIGGER_HSIOM_REG(port), CY_GET_REG32(TRIGGER_HSIOM_REG(port)) & ~(TRIGGER_HSIOM_MASK << (pin * 4)));
+	CY_SYS_PINS_SET_DRIVE_MODE(TRIGGER_PORT_REG(port, PC), pin, drive_mode);
+}
+#endif
+
+void trigger_init() {
+#ifdef USE_TRIGGER
+	trigger_output_write(0);
+	trigger_pin_setup(TRIGGER_OUT_PORT, TRIGGER_OUT_PIN, CY_SYS_PINS_DM_STRONG);
+	CY_SYS_PINS_SET_PIN(TRIGGER_PORT_REG(TRIGGER_IN_PORT, DR), TRIGGER_IN_PIN);
+	trigger_pin_setup(TRIGGER_IN_PORT, TRIGGER_IN_PIN, CY_SYS_PINS_DM_RES_UP);
+
+	reg32 *intcfg = (reg32 *)TRIGGER_PORT_REG(TRIGGER_IN_PORT, INTCFG);
+	*intcfg = (*intcfg & ~(TRIGGER_INTCFG_MASK << (TRIGGER_IN_PIN * 2))) | (TRIGGER_INTCFG_FALLING << (TRIGGER_IN_PIN * 2));
+	CY_SET_REG32(TRIGGER_PORT_REG(TRIGGER_IN_PORT, INTSTAT), 1u << TRIGGER_IN_PIN);
+	CyIntSetVector(TRIGGER_IN_PORT, trigger_isr);
+	CyIntSetPriority(TRIGGER_IN_PORT, IRQ_PRIORITY_CONTROL);
+	CyIntClearPending(TRIGGER_IN_PORT);
+	CyIntEnable(TRIGGER_IN_PORT);
+#endif
+}
+
+// Arms the action for the next edge. A setpoint is only used by TRIGGER_SET,
+// which also puts the load in CC mode so the feedback loops leave it alone.
+// The edge bypasses set_current, so the setpoint is held to the thermal and
+// SOA limit here, as it stands when armed.
+void trigger_arm(trigger_action new_action, int setpoint) {
+	action = TRIGGER_OFF;
+	if(new_action == TRIGGER_SET) {
+		if(setpoint < 0)
+			setpoint = 0;
+		if(setpoint > get_current_limit())
+			setpoint = get_current_limit();
+		set_load_mode(LOAD_MODE_CC);
+		armed_setpoint = setpoint;
+		current_to_dac(setpoint, &armed_codes[0], &armed_codes[1]);
+	}
+	action = new_action;
+}
+
+trigger_action get_trigger_action() {
+	return action;
+}
+
+// Microamps, as last armed for TRIGGER_SET
+int get_trigger_setpoint() {
+	return armed_setpoint;
+}
+
+void trigger_output_write(uint8 level) {
+#ifdef USE_TRIGGER
+	if(level)
+		CY_SYS_PINS_SET_PIN(TRIGGER_PORT_REG(TRIGGER_OUT_PORT, DR), TRIGGER_OUT_PIN);
+	else
+		CY_SYS_PINS_CLEAR_PIN(TRIGGER_PORT_REG(TRIGGER_OUT_PORT, DR), TRIGGER_OUT_PIN);
+#endif
+}
+
+void trigger_output_pulse() {
+	trigger_output_write(1);
+	CyDelayUs(TRIGGER_PULSE_US);
+	trigger_output_write(0);
+}
+
+uint32 get_trigger_cycles_max() {
+	return trigger_cycles_max;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,183 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include "tasks.h"
+#include "config.h"
+
+// CV loop auto-tuning by relay feedback. Started from CV mode, it holds the
+// voltage target and in its place switches the current between the present
+// setpoint plus and minus a step, up whenever the voltage is above the target
+// and down when below, with a little hysteresis against noise. Whatever the
+// source, that settles into an oscillation whose period Tu is the loop's
+// critical period, and whose amplitude a gives the critical gain,
+// Ku = 4d / (pi * sqrt(a^2 - h^2)) for a step d and hysteresis h. The gains
+// follow Tyreus-Luyben, Kp = Ku / 3.2 and Ti = 2.2 Tu, which settle a little
+// slower than Ziegler-Nichols but keep their margin on the stiff and soft
+// sources alike. Everything is in ADC counts and blocks, as regulate_cv works.
+// CR mode has no gains to tune: it works out its current from each reading.
+// Only in builds with USE_TUNE defined.
+
+#ifdef USE_TUNE
+
+static volatile tune_state test_state = TUNE_IDLE;
+static int step, bias;		// Microamps
+static int16 target_raw;
+static uint8 cycles;
+static uint8 high;			// Which side of the relay the current is on
+static uint16 blocks;		// Since the test started
+static uint16 cycle_start;	// Block of the last upward switch
+static int16 peak_high, peak_low;	// Of the error, this cycle
+static uint8 seen;			// Upward switches so far
+static uint32 period_sum, amplitude_sum;	// Blocks and counts, over the measured cycles
+static tune_result result;
+
+int tune_start(int new_step, int new_cycles) {
+	if(get_load_mode() != LOAD_MODE_CV || new_step <= 0 || new_cycles < 1 || new_cycles > TUNE_MAX_CYCLES)
+		return 0;
+	// The relay has to swing both ways from where the loop has settled
+	bias = get_current_setpoint();
+	if(bias < new_step)
+		return 0;
+
+	test_state = TUNE_IDLE;
+	sequence_stop();
+	battery_stop();
+	sweep_stop();
+	mppt_stop();
+	ir_stop();
+	impedance_stop();
+	ocp_stop();
+
+	step = new_step;
+	cycles = new_cycles;
+	target_raw = voltage_to_raw(get_voltage_target());
+	blocks = cycle_start = 0;
+	seen = 0;
+	period_sum = amplitude_sum = 0;
+	peak_high = peak_low = 0;
+	result = (tune_result){0};
+	high = 1;
+	set_load_mode(LOAD_MODE_CC);
+	set_current(bias + step);
+	test_state = TUNE_RUNNING;
+	return 1;
+}
+
+static void finish(tune_state end) {
+	if(test_state != TUNE_RUNNING)
+		return;
+	if(end == TUNE_DONE) {
+		int32 h = TUNE_HYSTERESIS;
+		int32 a = amplitude_sum / (2 * result.cycles);
+		if(a <= h) {
+			// Too stiff a source to tell the swing from the noise
+			end = TUNE_FAILED;
+		} else {
+			int32 swing = isqrt((uint64)a * a - h * h);
+			// Ku = 4d / (pi * swing), in microamps a count; Kp = Ku / 3.2
+			result.ku = ((int64)step * 4000) / (3142 * swing);
+			result.tu = period_sum / result.cycles;
+			int32 kp = ((int64)step * 1250) / (3142 * swing);
+			// Ki = Kp / Ti, per block, with Ti = 2.2 Tu
+			int32 ki = (kp * 10) / (22 * result.tu);
+			result.kp = (kp < 1)?1:(kp > TUNE_MAX_GAIN)?TUNE_MAX_GAIN:kp;
+			result.ki = (ki < 1)?1:(ki > TUNE_MAX_GAIN)?TUNE_MAX_GAIN:ki;
+			settings_write(&result.kp, &settings->cv_kp, sizeof(settings->cv_kp));
+			settings_write(&result.ki, &settings->cv_ki, sizeof(settings->cv_ki));
+		}
+	}
+	// Back to the loop, starting from where the relay was centred
+	set_current(bias);
+	set_load_mode(LOAD_MODE_CV);
+	test_state = end;
+}
+
+// Ends a running test early, for 'tune stop' and on a trip
+void tune_stop() {
+	finish(TUNE_STOPPED);
+}
+
+// Called by the ADC task with each block's means
+void tune_block(const int16 *mean) {
+	if(test_state != TUNE_RUNNING)
+		return;
+	if(get_load_mode() != LOAD_MODE_CC || get_current_setpoint() != bias + (high?step:-step)) {
+		// Something else took over the load
+		finish(TUNE_STOPPED);
+		return;
+	}
+	if(++blocks >= TUNE_MAX_BLOCKS) {
+		finish(TUNE_FAILED);
+		return;
+	}
+
+	int16 error = mean[FILTER_VOLTAGE] - target_raw;
+	if(error > peak_high)
+		peak_high = error;
+	if(error < peak_low)
+		peak_low = error;
+
+	if(!high && error > TUNE_HYSTERESIS) {
+		// A whole cycle since the last upward switch. The first few are the
+		// oscillation building up, and aren't counted.
+		if(++seen > TUNE_SETTLE_CYCLES) {
+			period_sum += blocks - cycle_start;
+			amplitude_sum += peak_high - peak_low;
+			if(++result.cycles >= cycles) {
+				finish(TUNE_DONE);
+				return;
+			}
+		}
+		cycle_start = blocks;
+		peak_high = peak_low = error;
+		high = 1;
+		set_current(bias + step);
+	} else if(high && error < -TUNE_HYSTERESIS) {
+		high = 0;
+		set_current(bias - step);
+	}
+}
+
+tune_state get_tune_state() {
+	return test_state;
+}
+
+// Cycles measured so far while running; the figures once done
+void get_tune_result(tune_result *r) {
+	*r = result;
+}
+
+#else
+
+int tune_start(int new_step, int new_cycles) {
+	return 0;
+}
+
+void tune_stop() {
+}
+
+void tune_block(const int16 *mean) {
+}
+
+tune_state get_tune_state() {
+	return TUNE_IDLE;
+}
+
+void get_tune_result(tune_result *r) {
+	*r = (tune_result){0};
+}
+
+#endif
+
+/* [] END OF FILE */
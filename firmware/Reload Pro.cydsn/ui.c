@@ -16,82 +16,207 @@
 #include <FreeRTOS.h>
 #include <task.h>
 #include <queue.h>
-#include <stdio.h>
+#include <semphr.h>
 #include <stdlib.h>
+#include <stddef.h>
 
-xQueueHandle ui_queue;
+// Input waiting for the UI task. Each kind is a latched bit rather than a
+// queue entry, so nothing is dropped however long a redraw takes and
+// repeats of the same kind merge. ui_wake only gets next_event out of its
+// wait early.
+static volatile uint8 ui_pending;
+static xSemaphoreHandle ui_wake;
+
+// The UI is a state machine driven from vTaskUI, one event at a time. A
+// screen's enter draws it and sets up what it keeps in screen_data; its event
+// handles one event without waiting for another, and returns 1 having set
+// *next to move on, or 0 to stay. Faults and changes made over the serial
+// port are dealt with in ui_dispatch for every screen, so no screen has its
+// own loop and the time spent on any one event is bounded.
+typedef struct state_func_t state_func;
 
 typedef struct {
-	void (*func)(char *);
-	char *label;
-} readout_function_impl;
-
-const display_settings_t display_settings = {
-	.cc = {
-		.readouts = {READOUT_CURRENT_SETPOINT, READOUT_CURRENT_USAGE, READOUT_VOLTAGE},
-	},
-};
+	void (*enter)(const void *arg);
+	int (*event)(const ui_event *event, state_func *next);
+} ui_screen;
 
-typedef struct state_func_t {
-	struct state_func_t (*func)(const void*);
+// A transition: the screen to show and its argument. A NULL screen goes back
+// to the last main state, the last screen entered that had is_main_state set.
+struct state_func_t {
+	const ui_screen *screen;
 	const void *arg;
 	const int8 is_main_state;
-} state_func;
+};
 
 typedef enum {
-	VALUE_TYPE_CURRENT_RANGE,
+	VALUE_TYPE_NUMBER,	// min to max in steps of step
+	VALUE_TYPE_CHOICE,	// One of choices
 } value_type;
 
+typedef struct {
+	const char *label;
+	int value;
+} valuechoice;
+
 typedef struct {
 	const char *caption;
 	const state_func new_state;
 } menuitem;
 
+// choose, if set, is told which item was picked and where to go instead of
+// the item's new_state, for menus that pick a value rather than a screen
 typedef struct {
 	const char *title;
+	int (*choose)(const menuitem *item, state_func *next);
 	const menuitem items[];
 } menudata;
 
+// A tunable for edit_value. It's bound to a field of settings_t when size is
+// nonzero, and otherwise read and written through get and set, which returns
+// 0 to refuse a value. preview, if set, is called as the knob changes the
+// value, before it's kept.
 typedef struct {
 	const value_type type;
-	const void *target;
-	const int value;
+	const char *title;
+	size_t offset;		// Into settings_t
+	uint8 size;			// Of the field, 1, 2 or 4 bytes
+	int (*get)();
+	int (*set)(int);
+	void (*preview)(int);
+	void (*changed)();	// Called once a value is kept
+	int min, max, step;	// VALUE_TYPE_NUMBER
+	char unit;			// Shown with format_number, the value times scale in micro-units...
+	const char *suffix;	// ...or if unit is 0, as an integer over scale with this after
+	int scale;
+	const valuechoice *choices;	// VALUE_TYPE_CHOICE
+	uint8 choice_count;
 } valueconfig;
 
-static state_func cc_load(const void*);
-static state_func menu(const void*);
-static state_func calibrate(const void*);
-static state_func display_config(const void*);
-static state_func set_contrast(const void *);
-static state_func overtemp(const void*);
+#define SETTING(field) .offset = offsetof(settings_t, field), .size = sizeof(((settings_t*)0)->field)
+#define CHOICES(list) .choices = list, .choice_count = sizeof(list) / sizeof(list[0])
+
+// Configuration for one of the load states
+typedef struct {
+	const load_mode mode;
+	size_t display;	// Offset of its DISPLAY_LAYOUTS display_config_t in settings_t
+	void (*adjust)(int);
+	void (*adjust_digit)(int decade, int delta);	// NULL if there's no digit cursor
+} loadconfig;
+
+// The layout showing for a loadconfig
+#define LOAD_DISPLAY(config) ((const display_config_t*)((const uint8*)settings + (config)->display) + \
+	((settings->display_layouts >> (config)->mode) & 1))
+
+static const ui_screen load_screen, menu_screen, calibrate_screen, preset_screen, edit_screen, fault_screen;
+#ifdef USE_GRAPH
+static const ui_screen graph_screen;
+#endif
+#ifdef USE_BATTERY_TEST
+static const ui_screen battery_screen;
+#endif
+#ifdef USE_SWEEP
+static const ui_screen sweep_screen;
+#endif
+#ifdef USE_MPPT
+static const ui_screen mppt_screen;
+#endif
+#ifdef USE_IR_TEST
+static const ui_screen ir_screen;
+#endif
+#ifdef USE_STANDBY
+static const ui_screen standby_screen;
+#endif
+static const ui_screen remote_screen;
+static int choose_display(const menuitem *item, state_func *next);
+static int choose_readout(const menuitem *item, state_func *next);
+static int choose_layout(const menuitem *item, state_func *next);
+
+static void adjust_current_setpoint(int delta);
+static void adjust_voltage_setpoint(int delta);
+static void adjust_resistance_setpoint(int delta);
+static void adjust_power_setpoint(int delta);
+static void adjust_pulse_high(int delta);
+static void adjust_current_digit(int decade, int delta);
+
+// Indexed by load_mode
+const loadconfig load_configs[] = {
+	{LOAD_MODE_CC, offsetof(settings_t, display.cc), adjust_current_setpoint, adjust_current_digit},
+	{LOAD_MODE_CV, offsetof(settings_t, display.cv), adjust_voltage_setpoint, NULL},
+	{LOAD_MODE_CR, offsetof(settings_t, display.cr), adjust_resistance_setpoint, NULL},
+	{LOAD_MODE_CP, offsetof(settings_t, display.cp), adjust_power_setpoint, NULL},
+	{LOAD_MODE_PULSE, offsetof(settings_t, display.pulse), adjust_pulse_high, NULL},
+};
+
+// Digits the cursor steps through, and the label shown while each is selected
+static const struct {
+	int decade;
+	char label[4];
+} load_digits[] = {
+	{1000000, "1A"},
+	{100000, "0.1"},
+	{10000, ".01"},
+};
+#define LOAD_DIGIT_COUNT (sizeof(load_digits) / sizeof(load_digits[0]))
 
 #define STATE_MAIN {NULL, NULL, 0}
-#define STATE_CC_LOAD {cc_load, NULL, 1}
-#define STATE_CALIBRATE {calibrate, NULL, 0}
-#define STATE_CONFIGURE_CC_DISPLAY {display_config, &display_settings.cc, 0}
-#define STATE_SET_CONTRAST {set_contrast, NULL, 0}
-#define STATE_OVERTEMP {overtemp, NULL, 0}
+#define STATE_LOAD(mode) {&load_screen, &load_configs[mode], 1}
+#define STATE_CC_LOAD STATE_LOAD(LOAD_MODE_CC)
+#define STATE_MENU(menu) {&menu_screen, &(menu), 0}
+#define STATE_CALIBRATE {&calibrate_screen, NULL, 0}
+#define STATE_CONFIGURE_DISPLAY STATE_MENU(choose_readout_menu)
+#define STATE_CHOOSE_LAYOUT STATE_MENU(layout_menu)
+#define STATE_PRESETS {&preset_screen, NULL, 0}
+#define STATE_EDIT(config) {&edit_screen, &(config), 0}
+#define STATE_FAULT {&fault_screen, NULL, 0}
+#define STATE_REMOTE {&remote_screen, NULL, 0}
+#define STATE_GRAPH {&graph_screen, NULL, 1}
+#define STATE_BATTERY {&battery_screen, NULL, 1}
+#define STATE_SWEEP {&sweep_screen, NULL, 1}
+#define STATE_MPPT {&mppt_screen, NULL, 1}
+#define STATE_IR {&ir_screen, NULL, 1}
+#define STATE_STANDBY {&standby_screen, NULL, 1}
 
 #ifdef USE_SPLASHSCREEN
-static state_func splashscreen(const void*);
-#define STATE_SPLASHSCREEN {splashscreen, NULL, 0}
+static const ui_screen splash_screen;
+#define STATE_SPLASHSCREEN {&splash_screen, NULL, 0}
 #endif
 
 const menudata set_readout_menu = {
 	"Choose value",
+	choose_readout,
 	{
 		{"Set Current", {NULL, (void*)READOUT_CURRENT_SETPOINT, 0}},
+		{"Set Voltage", {NULL, (void*)READOUT_VOLTAGE_SETPOINT, 0}},
+		{"Set Resist.", {NULL, (void*)READOUT_RESISTANCE_SETPOINT, 0}},
+		{"Set Power", {NULL, (void*)READOUT_POWER_SETPOINT, 0}},
 		{"Act. Current", {NULL, (void*)READOUT_CURRENT_USAGE, 0}},
 		{"Voltage", {NULL, (void*)READOUT_VOLTAGE, 0}},
 		{"Power", {NULL, (void*)READOUT_POWER, 0}},
 		{"Resistance", {NULL, (void*)READOUT_RESISTANCE, 0}},
+		{"Charge", {NULL, (void*)READOUT_CHARGE, 0}},
+		{"Energy", {NULL, (void*)READOUT_ENERGY, 0}},
+		{"I ripple p-p", {NULL, (void*)READOUT_CURRENT_RIPPLE, 0}},
+		{"I ripple RMS", {NULL, (void*)READOUT_CURRENT_DEVIATION, 0}},
+		{"V ripple p-p", {NULL, (void*)READOUT_VOLTAGE_RIPPLE, 0}},
+		{"V ripple RMS", {NULL, (void*)READOUT_VOLTAGE_DEVIATION, 0}},
+		{"Ripple tone", {NULL, (void*)READOUT_RIPPLE_TONE, 0}},
+		{"I max hold", {NULL, (void*)READOUT_CURRENT_PEAK, 0}},
+		{"I min hold", {NULL, (void*)READOUT_CURRENT_VALLEY, 0}},
+		{"I avg hold", {NULL, (void*)READOUT_CURRENT_AVERAGE, 0}},
+		{"V max hold", {NULL, (void*)READOUT_VOLTAGE_PEAK, 0}},
+		{"V min hold", {NULL, (void*)READOUT_VOLTAGE_VALLEY, 0}},
+		{"V avg hold", {NULL, (void*)READOUT_VOLTAGE_AVERAGE, 0}},
+		{"Current bar", {NULL, (void*)READOUT_CURRENT_BAR, 0}},
+		{"Thermal bar", {NULL, (void*)READOUT_THERMAL_BAR, 0}},
 		{"None", {NULL, (void*)READOUT_NONE, 0}},
 		{NULL, {NULL, NULL, 0}},
 	}
 };
 
+// Then set_readout_menu for what it shows
 const menudata choose_readout_menu = {
 	"Readouts",
+	choose_display,
 	{
 		{"Main display", {NULL, (void*)0, 0}},
 		{"Left display", {NULL, (void*)1, 0}},
@@ -100,83 +225,449 @@ const menudata choose_readout_menu = {
 	}
 };
 
+// Indexed by layout, so one item per DISPLAY_LAYOUTS
+const menudata layout_menu = {
+	"Layout",
+	choose_layout,
+	{
+		{"Layout A", {NULL, (void*)0, 0}},
+		{"Layout B", {NULL, (void*)1, 0}},
+		{NULL, {NULL, NULL, 0}},
+	}
+};
+
+static void preview_contrast(int contrast) {
+	Display_SetContrast(contrast);
+}
+
+static void preview_brightness(int brightness) {
+	set_backlight(brightness);
+}
+
+#ifdef USE_BATTERY_TEST
+static int get_cutoff();
+static int set_cutoff(int cutoff);
+#endif
+
+static const valuechoice on_off_choices[] = {{"Off", 0}, {"On", 1}};
+static const valuechoice boot_choices[] = {{"Normal", 0}, {"Fast", 1}};
+static const valuechoice filter_choices[] = {
+	{"1 block", 1}, {"2 blocks", 2}, {"4 blocks", 4}, {"8 blocks", 8}, {"16 blocks", 16},
+};
+_Static_assert(ADC_FILTER_MAX_BLOCKS == 16, "filter_choices goes up to ADC_FILTER_MAX_BLOCKS");
+static const valuechoice line_choices[] = {{"Off", 0}, {"50Hz", 50}, {"60Hz", 60}};
+static const valuechoice baud_choices[] = {
+	{"9600", 9600}, {"19200", 19200}, {"38400", 38400}, {"57600", 57600}, {"115200", 115200}, {"230400", 230400},
+};
+
+static const valueconfig contrast_value = {
+	VALUE_TYPE_NUMBER, "Contrast", SETTING(lcd_contrast), .preview = preview_contrast,
+	.min = 0, .max = 0x3F, .step = 1, .scale = 1, .suffix = "",
+};
+static const valueconfig brightness_value = {
+	VALUE_TYPE_NUMBER, "Backlight", SETTING(backlight_brightness), .preview = preview_brightness,
+	.min = 0, .max = BACKLIGHT_MAX_BRIGHTNESS, .step = 1, .scale = 1, .suffix = "",
+};
+static const valueconfig dim_value = {
+	VALUE_TYPE_NUMBER, "Dim after", SETTING(backlight_timeout),
+	.min = 0, .max = 120, .step = 1, .scale = 1, .suffix = "min",
+};
+static const valueconfig refresh_value = {
+	VALUE_TYPE_NUMBER, "Refresh", SETTING(ui_refresh_rate),
+	.min = 1, .max = UI_REFRESH_MAX, .step = 1, .scale = 1, .suffix = "Hz",
+};
+static const valueconfig filter_value = {
+	VALUE_TYPE_CHOICE, "Filter", .get = get_filter_length, .set = set_filter_length, CHOICES(filter_choices),
+};
+// Mains synchronous integration of the precise readings
+static const valueconfig line_value = {
+	VALUE_TYPE_CHOICE, "Line sync", .get = get_line_frequency, .set = set_line_frequency, CHOICES(line_choices),
+};
+static const valueconfig slew_value = {
+	VALUE_TYPE_NUMBER, "Slew rate", .get = get_slew_rate, .set = set_slew_rate,
+	.min = 0, .max = SLEW_MAX_RATE, .step = 1000, .scale = 1000, .suffix = "mA/ms",
+};
+#ifdef USE_BATTERY_TEST
+static const valueconfig cutoff_value = {
+	VALUE_TYPE_NUMBER, "Batt. cutoff", .get = get_cutoff, .set = set_cutoff,
+	.min = VOLTAGE_STEP, .max = GRAPH_VOLTAGE_MAX, .step = VOLTAGE_STEP, .unit = 'V', .scale = 1,
+};
+#endif
+// Millivolts, 0 for no limit
+static const valueconfig overvoltage_value = {
+	VALUE_TYPE_NUMBER, "Overvolt", SETTING(overvoltage_limit), .changed = voltage_limits_update,
+	.min = 0, .max = 65000, .step = 100, .unit = 'V', .scale = 1000,
+};
+static const valueconfig undervoltage_value = {
+	VALUE_TYPE_NUMBER, "Undervolt", SETTING(undervoltage_limit), .changed = voltage_limits_update,
+	.min = 0, .max = 65000, .step = 100, .unit = 'V', .scale = 1000,
+};
+static const valueconfig baud_value = {
+	VALUE_TYPE_CHOICE, "Baud", .get = get_baud, .set = request_baud, CHOICES(baud_choices),
+};
+static const valueconfig address_value = {
+	VALUE_TYPE_NUMBER, "Address", SETTING(address),
+	.min = 0, .max = FRAME_BROADCAST - 1, .step = 1, .scale = 1, .suffix = "",
+};
+static const valueconfig boot_value = {
+	VALUE_TYPE_CHOICE, "Boot", SETTING(fast_boot), CHOICES(boot_choices),
+};
+static const valueconfig autozero_value = {
+	VALUE_TYPE_CHOICE, "Autozero", SETTING(opamp_autozero), CHOICES(on_off_choices),
+};
+
+extern const menudata main_menu;
+
+// Adding a tunable takes a valueconfig above and an item here
+const menudata settings_menu = {
+	"Settings",
+	NULL,
+	{
+		{"Contrast", STATE_EDIT(contrast_value)},
+		{"Backlight", STATE_EDIT(brightness_value)},
+		{"Dim after", STATE_EDIT(dim_value)},
+		{"Refresh rate", STATE_EDIT(refresh_value)},
+		{"Filter", STATE_EDIT(filter_value)},
+		{"Line sync", STATE_EDIT(line_value)},
+		{"Slew rate", STATE_EDIT(slew_value)},
+#ifdef USE_BATTERY_TEST
+		{"Batt. cutoff", STATE_EDIT(cutoff_value)},
+#endif
+		{"Overvolt", STATE_EDIT(overvoltage_value)},
+		{"Undervolt", STATE_EDIT(undervoltage_value)},
+		{"Baud rate", STATE_EDIT(baud_value)},
+		{"Address", STATE_EDIT(address_value)},
+		{"Boot", STATE_EDIT(boot_value)},
+		{"Autozero", STATE_EDIT(autozero_value)},
+		{"Back", STATE_MENU(main_menu)},
+		{NULL, {NULL, NULL, 0}},
+	}
+};
+
 const menudata main_menu = {
+	NULL,
 	NULL,
 	{
+		// First, so a preset is a long press and a click away from a load.
+		// Press-and-turn on a load recalls one without the menu.
+		{"Presets", STATE_PRESETS},
 		{"C/C Load", STATE_CC_LOAD},
-		{"Readouts", STATE_CONFIGURE_CC_DISPLAY},
-		{"Contrast", STATE_SET_CONTRAST},
+		{"C/V Load", STATE_LOAD(LOAD_MODE_CV)},
+		{"C/R Load", STATE_LOAD(LOAD_MODE_CR)},
+		{"C/P Load", STATE_LOAD(LOAD_MODE_CP)},
+		{"Pulse Load", STATE_LOAD(LOAD_MODE_PULSE)},
+#ifdef USE_GRAPH
+		{"Graph", STATE_GRAPH},
+#endif
+#ifdef USE_BATTERY_TEST
+		{"Battery Test", STATE_BATTERY},
+#endif
+#ifdef USE_SWEEP
+		{"I-V Sweep", STATE_SWEEP},
+#endif
+#ifdef USE_MPPT
+		{"MPPT", STATE_MPPT},
+#endif
+#ifdef USE_IR_TEST
+		{"IR Test", STATE_IR},
+#endif
+#ifdef USE_STANDBY
+		{"Standby", STATE_STANDBY},
+#endif
+		{"Layout", STATE_CHOOSE_LAYOUT},
+		{"Readouts", STATE_CONFIGURE_DISPLAY},
+		{"Settings", STATE_MENU(settings_menu)},
 		{"Calibrate", STATE_CALIBRATE},
 		{NULL, {NULL, NULL, 0}},
 	}
 };
 
-#define STATE_MAIN_MENU {menu, &main_menu, 0}
+#define STATE_MAIN_MENU STATE_MENU(main_menu)
 
-CY_ISR(button_press_isr) {
-	static ui_event event = {.type = UI_EVENT_BUTTONPRESS, .when = 0};
-	event.int_arg = QuadButton_Read();
-	QuadButton_ClearInterrupt();
-	
-	portTickType now = xTaskGetTickCountFromISR();
-	if(now - event.when > configTICK_RATE_HZ / 10) {
-		event.when = now;
-		xQueueSendToBackFromISR(ui_queue, &event, NULL);
+void ui_post(uint8 flags) {
+	uint8 int_state = CyEnterCriticalSection();
+	ui_pending |= flags;
+	CyExitCriticalSection(int_state);
+	if(ui_wake)
+		xSemaphoreGive(ui_wake);
+}
+
+// When the knob, button or serial port was last used, for dimming the backlight
+static portTickType last_activity;
+static uint8 backlight_dimmed;
+static uint8 display_asleep;
+
+// Restores the backlight and restarts the idle timeout. Called from the UI
+// task for input and from the comms task for commands addressed to us.
+void ui_activity() {
+	taskENTER_CRITICAL();
+	last_activity = xTaskGetTickCount();
+	if(backlight_dimmed && !display_asleep) {
+		set_backlight(settings->backlight_brightness);
+		backlight_dimmed = 0;
 	}
+	taskEXIT_CRITICAL();
 }
 
-// Maps current state (index) to next state for a forward transition.
-const int8 quadrature_states[] = {0x1, 0x3, 0x0, 0x2};
+// The LCD sleeps, backlight and all, after DISPLAY_SLEEP_FACTOR backlight
+// timeouts without the knob or button, or DISPLAY_REMOTE_SLEEP_MS into the
+// remote lockout. Serial commands don't keep it awake, so a rack polled all
+// day still sleeps. Only those inputs and a trip wake it.
+static portTickType last_input;
+static volatile uint8 remote_locked;
 
-CY_ISR(quadrature_event_isr) {
-	static int8 last_levels = 3;
-	static int8 count = 0;
-	
-	int levels = Quadrature_Read();
-	Quadrature_ClearInterrupt();
+static void display_wake() {
+	if(!display_asleep)
+		return;
+	Display_Wake();
+	taskENTER_CRITICAL();
+	display_asleep = 0;
+	backlight_dimmed = 0;
+	set_backlight(settings->backlight_brightness);
+	taskEXIT_CRITICAL();
+}
+
+// Input from the knob or button: wakes the display, and restarts the timeouts
+static void local_input() {
+	last_input = xTaskGetTickCount();
+	display_wake();
+	ui_activity();
+}
 
-	if(quadrature_states[last_levels] == levels) {
-		count += 1;
-		last_levels = levels;
-	} else if(quadrature_states[levels] == last_levels) {
-		count -= 1;
-		last_levels = levels;
+static void check_idle(portTickType now) {
+	portTickType timeout = settings->backlight_timeout * 60 * configTICK_RATE_HZ;
+	taskENTER_CRITICAL();
+	if(timeout && !backlight_dimmed && now - last_activity >= timeout
+			&& settings->backlight_brightness > BACKLIGHT_DIM_BRIGHTNESS) {
+		set_backlight(BACKLIGHT_DIM_BRIGHTNESS);
+		backlight_dimmed = 1;
 	}
-	
-	if(abs(count) >= 4) {
-		ui_event event = {.type = UI_EVENT_UPDOWN, .when = xTaskGetTickCountFromISR(), .int_arg = count / 4};
-		xQueueSendToBackFromISR(ui_queue, &event, NULL);
-		count = count % 4;
+	taskEXIT_CRITICAL();
+
+	uint8 sleep = (timeout && now - last_input >= timeout * DISPLAY_SLEEP_FACTOR)
+		|| (remote_locked && now - last_input >= DISPLAY_REMOTE_SLEEP_MS / portTICK_RATE_MS);
+	if(sleep && !display_asleep) {
+		Display_Sleep();
+		taskENTER_CRITICAL();
+		set_backlight(0);
+		display_asleep = 1;
+		taskEXIT_CRITICAL();
+	} else if(!sleep) {
+		// As when the lockout ends over the serial port
+		display_wake();
 	}
 }
 
-static void format_number(int num, const char suffix, char *out) {
-	if(num < 0)
-		num = 0;
-	
-	int magnitude = 1;
-	while(num >= 1000000) {
-		num /= 1000;
-		magnitude++;
+void ui_post_from_isr(uint8 flags) {
+	uint8 int_state = CyEnterCriticalSection();
+	ui_pending |= flags;
+	CyExitCriticalSection(int_state);
+	if(ui_wake)
+		xSemaphoreGiveFromISR(ui_wake, NULL);
+}
+
+// Button gestures, decoded in the UI task from the edge times the button ISR
+// reads off the timestamp timer. The timer's one alarm belongs to the
+// sequencer and short test, so the timeouts are checked by next_event, which
+// wakes at least every QUADRATURE_POLL_TICKS.
+// - A press held for BUTTON_HOLD_US is a long press as soon as it's that old.
+// - A shorter one is a click. Where the screen takes double clicks the click
+//   waits BUTTON_DOUBLE_US for another press, and the pair is a double click.
+// - Turning the knob with the button down makes the press a press-and-turn.
+//   The detents come as usual, button_held() telling them apart, and the
+//   release is the gesture.
+// Gestures are posted like any other input, so they coalesce the same way.
+static struct {
+	uint8 down;		// As of the last edge taken
+	uint8 ignore;	// The press down began before gesture_start
+	uint8 held;		// The press down has been a long press
+	uint8 turned;	// The knob has turned during the press down
+	uint8 doubles;	// The screen takes double clicks
+	uint8 clicks;	// 1 for a click waiting for another press, 2 while that's down
+	uint32 down_when, up_when;
+} gesture;
+
+// Edge times from the ISR: the last release, then the last press
+static volatile uint32 button_edges[2];
+
+// Called as a screen opens, so it gets no gestures meant for the last one:
+// the rest of a press already down is ignored.
+static void gesture_start(uint8 doubles) {
+	uint8 int_state = CyEnterCriticalSection();
+	ui_pending &= ~(UI_POST_CLICK | UI_POST_DOUBLE_CLICK | UI_POST_LONG_PRESS | UI_POST_PRESS_TURN);
+	CyExitCriticalSection(int_state);
+	gesture.doubles = doubles;
+	gesture.clicks = 0;
+	gesture.ignore = gesture.down;
+}
+
+static uint8 button_held() {
+	return gesture.down && !gesture.ignore && !gesture.held;
+}
+
+// A click held back for a second press is a click after all
+static void gesture_flush_click() {
+	if(gesture.clicks) {
+		gesture.clicks = 0;
+		ui_post(UI_POST_CLICK);
 	}
-	
-	int whole = num / 1000, remainder = num % 1000;
-	if(whole < 10) {
-		// Format: x.xx
-		sprintf(out, "%1d.%02d", whole, remainder / 10);
-	} else if(whole < 100) {
-		// Format: xx.x
-		sprintf(out, "%02d.%1d", whole, remainder / 100);
+}
+
+static void gesture_edge(uint8 down, uint32 when) {
+	gesture.down = down;
+	if(down) {
+		// Also ends an ignored press whose release was missed
+		gesture.ignore = gesture.held = gesture.turned = 0;
+		gesture.down_when = when;
+		if(gesture.clicks && when - gesture.up_when < BUTTON_DOUBLE_US) {
+			gesture.clicks = 2;
+		} else {
+			gesture_flush_click();
+		}
+		return;
+	}
+
+	if(gesture.ignore) {
+		gesture.ignore = 0;
+	} else if(gesture.turned) {
+		ui_post(UI_POST_PRESS_TURN);
+	} else if(gesture.held) {
+		// Posted when the time was up
+	} else if(gesture.clicks) {
+		gesture.clicks = 0;
+		ui_post(UI_POST_DOUBLE_CLICK);
+	} else if(gesture.doubles) {
+		gesture.clicks = 1;
+		gesture.up_when = when;
 	} else {
-		// Format: xxx
-		sprintf(out, "%03d", whole);
+		ui_post(UI_POST_CLICK);
+	}
+}
+
+static void gesture_poll(uint32 now) {
+	if(button_held() && !gesture.turned && now - gesture.down_when >= BUTTON_HOLD_US) {
+		gesture_flush_click();
+		gesture.held = 1;
+		ui_post(UI_POST_LONG_PRESS);
+	}
+	// A press not yet taken may have come in time; its edge decides
+	if(gesture.clicks == 1 && !(ui_pending & UI_POST_BUTTONDOWN) && now - gesture.up_when >= BUTTON_DOUBLE_US)
+		gesture_flush_click();
+}
+
+static void gesture_turn() {
+	if(button_held() && !gesture.turned) {
+		gesture_flush_click();
+		gesture.turned = 1;
+	}
+}
+
+// Takes the most urgent pending input as an event
+static int take_pending(ui_event *event) {
+	uint8 int_state = CyEnterCriticalSection();
+	uint8 flag = ui_pending & -ui_pending;
+	ui_pending &= ~flag;
+	CyExitCriticalSection(int_state);
+
+	event->int_arg = 0;
+	event->when = get_time_us();
+	switch(flag) {
+	case 0:
+		return 0;
+	case UI_POST_FAULT:
+		event->type = UI_EVENT_FAULT;
+		break;
+	case UI_POST_BENCH:
+		event->type = UI_EVENT_BENCH;
+		break;
+	case UI_POST_BUTTONDOWN:
+		event->type = UI_EVENT_BUTTONPRESS;
+		event->int_arg = 1;
+		event->when = button_edges[1];
+		gesture_edge(1, event->when);
+		break;
+	case UI_POST_BUTTONUP:
+		event->type = UI_EVENT_BUTTONPRESS;
+		event->when = button_edges[0];
+		gesture_edge(0, event->when);
+		break;
+	default:
+		// One of the gestures
+		event->type = UI_EVENT_GESTURE;
+		for(flag /= UI_POST_CLICK; flag > 1; flag >>= 1)
+			event->int_arg++;
+		break;
 	}
+	return 1;
+}
+
+CY_ISR(button_press_isr) {
+	uint32 entry_ticks = CySysTickGetValue();
+	static uint32 last_when = 0;
+	uint8 level = QuadButton_Read();
+	QuadButton_ClearInterrupt();
 	
-	if(magnitude == 1) {
-		strcat(out, (const char[]){'m', suffix, '\0'});
-	} else {
-		strcat(out, (const char[]){suffix, ' ', '\0'});
+	uint32 now = get_time_us();
+	if(now - last_when > BUTTON_DEBOUNCE_US) {
+		last_when = now;
+		button_edges[level ? 1 : 0] = now;
+		TRACE_EVENT(TRACE_BUTTON, level ? 1 : 0);
+		ui_post_from_isr(level ? UI_POST_BUTTONDOWN : UI_POST_BUTTONUP);
 	}
+	profile_isr(PROFILE_ISR_BUTTON, entry_ticks);
+}
+
+// Maps current state (index) to next state for a forward transition.
+static const int8 quadrature_states[] = {0x1, 0x3, 0x0, 0x2};
+static uint8 quadrature_levels;
+static volatile uint16 quadrature_count; // Edges, forward less back
+static uint16 quadrature_last;
+
+// Runs on every edge of the Quadrature pins, but only keeps count: the UI
+// diffs the count every QUADRATURE_POLL_TICKS and turns whole detents into
+// events, so a fast turn or contact bounce never costs a queue send.
+CY_ISR(quadrature_event_isr) {
+	uint32 entry_ticks = CySysTickGetValue();
+	uint8 levels = Quadrature_Read();
+	Quadrature_ClearInterrupt();
+
+	if(quadrature_states[quadrature_levels] == levels) {
+		quadrature_count++;
+		quadrature_levels = levels;
+	} else if(quadrature_states[levels] == quadrature_levels) {
+		quadrature_count--;
+		quadrature_levels = levels;
+	}
+	profile_isr(PROFILE_ISR_QUADRATURE, entry_ticks);
+}
+
+static int poll_quadrature(ui_event *event) {
+	int16 delta = quadrature_count - quadrature_last;
+	int detents = delta / QUADRATURE_COUNTS_PER_DETENT;
+	if(detents == 0)
+		return 0;
+
+	// Part detents carry over to the next poll
+	quadrature_last += detents * QUADRATURE_COUNTS_PER_DETENT;
+	gesture_turn();
+	event->type = UI_EVENT_UPDOWN;
+	event->when = get_time_us();
+	event->int_arg = detents;
+	return 1;
+}
+
+// Scales a setpoint knob movement by how fast it's being turned, so a quick
+// spin covers the range in a few turns while slow turns still step finely.
+static int accelerate(const ui_event *event) {
+	static uint32 last_when = 0;
+	uint32 interval = event->when - last_when;
+	last_when = event->when;
+
+	int detents = abs(event->int_arg);
+	uint32 multiplier = ENCODER_ACCEL_MAX;
+	if(interval > detents * ENCODER_ACCEL_US / (ENCODER_ACCEL_MAX - 1))
+		multiplier = 1 + detents * ENCODER_ACCEL_US / interval;
+	return event->int_arg * (int)multiplier;
 }
 
 static void adjust_current_setpoint(int delta) {
@@ -187,332 +678,1685 @@ static void adjust_current_setpoint(int delta) {
 	}
 }
 
+// Steps one decimal digit of the setpoint, wrapping within 0-9 so the
+// others are left alone. set_current clamps anything out of range.
+static void adjust_current_digit(int decade, int delta) {
+	int setpoint = state.current_setpoint;
+	int digit = (setpoint / decade) % 10;
+	int new_digit = (digit + delta) % 10;
+	if(new_digit < 0)
+		new_digit += 10;
+	set_current(setpoint + (new_digit - digit) * decade);
+}
+
+static void adjust_voltage_setpoint(int delta) {
+	set_voltage_target(get_voltage_target() + delta * VOLTAGE_STEP);
+}
+
+static void adjust_resistance_setpoint(int delta) {
+	set_resistance_target(get_resistance_target() + delta * RESISTANCE_STEP);
+}
+
+static void adjust_power_setpoint(int delta) {
+	set_power_target(get_power_target() + delta * POWER_STEP);
+}
+
+// The knob moves the high level of the pulse; the setpoint readout shows it
+static void adjust_pulse_high(int delta) {
+	pulse_config_t config = *get_pulse_config();
+	config.high_current += delta * CURRENT_FULLRANGE_STEP;
+	if(config.high_current < config.low_current)
+		config.high_current = config.low_current;
+	set_pulse_config(&config);
+}
+
+static void run_benchmarks();
+#ifdef USE_GRAPH
+static void graph_sample(uint32 now);
+#endif
+
 static void next_event(ui_event *event) {
-	static portTickType last_tick = 0;
+	// The refresh job wakes us as it falls due
+	schedule_set(SCHEDULE_UI_REFRESH, configTICK_RATE_HZ / (display_asleep ? DISPLAY_ASLEEP_REFRESH_HZ : settings->ui_refresh_rate));
 	
-	portTickType now = xTaskGetTickCount();
-	if(now > last_tick + configTICK_RATE_HZ / 10 || !xQueueReceive(ui_queue, event, configTICK_RATE_HZ / 10 - (now - last_tick))) {
-		event->type = UI_EVENT_ADC_READING;
-		event->when = now;
-		last_tick = now;
+	settings_save_pending();
+	fault_save_pending();
+	
+	while(1) {
+		watchdog_heartbeat(WATCHDOG_TASK_UI);
+		gesture_poll(get_time_us());
+		if(take_pending(event)) {
+			if(event->type == UI_EVENT_BENCH) {
+				// Handled here so it works from any screen; the caller just
+				// sees a reading and redraws
+				run_benchmarks();
+				event->type = UI_EVENT_ADC_READING;
+			} else if(event->type == UI_EVENT_FAULT) {
+				// Shown, and left up as long as any input would leave it
+				local_input();
+			} else if(display_asleep) {
+				// The input that wakes the display does nothing else: the
+				// rest of a press is ignored, and the screen just redraws
+				local_input();
+				gesture_start(gesture.doubles);
+				event->type = UI_EVENT_ADC_READING;
+				return;
+			} else {
+				local_input();
+				return;
+			}
+			ui_activity();
+			return;
+		}
+
+		if(schedule_take(SCHEDULE_UI_REFRESH, NULL)) {
+			event->type = UI_EVENT_ADC_READING;
+			event->when = get_time_us();
+			#ifdef USE_GRAPH
+			graph_sample(event->when);
+			#endif
+			check_idle(xTaskGetTickCount());
+			return;
+		}
+		if(poll_quadrature(event)) {
+			if(display_asleep)
+				event->type = UI_EVENT_ADC_READING;
+			local_input();
+			return;
+		}
+
+		xSemaphoreTake(ui_wake, QUADRATURE_POLL_TICKS);
 	}
 }
 
+// Items shown at once: four rows, less one for a title
+static int menu_height(const menudata *menu) {
+	return menu->title ? 3 : 4;
+}
+
+// Draws one item in its row of the page it's on, inverted if selected
+static void draw_menu_item(const menudata *menu, int item, uint8 selected) {
+	int height = menu_height(menu);
+	int page = ((item % height) + 4 - height) * 2;
+	const char *caption = menu->items[item].caption;
+
+	draw_text(page, 0, caption, selected);
+	Display_Clear(page, strlen(caption) * 12, page + 2, 142, selected * 255);
+}
+
+// Draws the whole page the selected item is on: title, items and scroll arrows
 static void draw_menu(const menudata *menu, int selected) {
-	int start_row = 0;
-	int height = 4;
+	int start_row = 4 - menu_height(menu);
+	int height = menu_height(menu);
 
 	if(menu->title) {
 		int8 padding = (160 - strlen(menu->title) * 12) / 2;
 		Display_Clear(0, 0, 2, padding, 0xFF);
-		Display_DrawText(0, padding, menu->title, 1);
+		draw_text(0, padding, menu->title, 1);
 		Display_Clear(0, 160 - padding, 2, 160, 0xFF);
-		start_row++;
-		height--;
 	}
 
 	Display_DrawText(start_row * 2, 148, ((selected / height) > 0)?FONT_GLYPH_UARR:" ", 0);
 	
 	// Find the block of items the selected element is in
-	const menuitem *current = &menu->items[selected - selected % height];
-	selected %= height;
-	
+	int item = selected - selected % height;
 	for(int i = 0; i < height; i++) {
-		if(current->caption != NULL) {
-			Display_DrawText((i + start_row) * 2, 0, current->caption, i == selected);
-			Display_Clear((i + start_row) * 2, strlen(current->caption) * 12, (i + start_row + 1) * 2, 142, (i == selected)*255);
-			current++;
+		if(menu->items[item].caption != NULL) {
+			draw_menu_item(menu, item, item == selected);
+			item++;
 		} else {
 			Display_Clear((i + start_row) * 2, 0, (i + start_row + 1) * 2, 160, 0);
 		}
 	}
 	
-	if(current->caption != NULL) {
+	if(menu->items[item].caption != NULL) {
 		Display_DrawText(6, 148, FONT_GLYPH_DARR, 0);
 	} else {
 		Display_DrawText(6, 148, " ", 0);
 	}
 }
 
-void print_nothing(char *buf) {
-	strcpy(buf, "      ");
-}
+// How each readout is shown. The value comes from take_readings(), multiplied
+// by scale to the micro-units format_number takes.
+#define READOUT_MAX 2000000000 // format_number's limit, 2 kilo-units
+#define READOUT_HOURS 1 // A total: append the 'h'
+#define READOUT_OPTIONAL 2 // A negative value means no reading, shown as dashes
 
-void print_setpoint(char *buf) {
-	format_number(get_current_setpoint(), 'A', buf);
-}
+typedef struct {
+	const char *label;	// Beside the main readout
+	const char *unit;	// format_number's suffix, or NULL for a blank readout
+	uint16 scale;
+	uint8 width;		// Padded with spaces to this many characters
+	uint8 flags;
+} readout_format;
 
-void print_current_usage(char *buf) {
-	format_number(get_current_usage(), 'A', buf);
-}
+static const readout_format readout_formats[READOUT_COUNT] = {
+	[READOUT_NONE] = {"", NULL, 1, 6, 0},
+	[READOUT_CURRENT_SETPOINT] = {"SET", "A", 1, 6, 0},
+	[READOUT_CURRENT_USAGE] = {"ACT", "A", 1, 6, 0},
+	[READOUT_VOLTAGE] = {"", "V", 1, 6, 0},
+	[READOUT_POWER] = {"", "W", 1, 6, 0},
+	[READOUT_RESISTANCE] = {"", FONT_GLYPH_OHM, 1000, 6, READOUT_OPTIONAL},
+	[READOUT_VOLTAGE_SETPOINT] = {"SET", "V", 1, 6, 0},
+	[READOUT_RESISTANCE_SETPOINT] = {"SET", FONT_GLYPH_OHM, 1000, 6, 0},
+	[READOUT_POWER_SETPOINT] = {"SET", "W", 1000, 6, 0},
+	[READOUT_CHARGE] = {"", "A", 1, 7, READOUT_HOURS},
+	[READOUT_ENERGY] = {"", "W", 1, 7, READOUT_HOURS},
+	[READOUT_CURRENT_RIPPLE] = {"P-P", "A", 1, 6, 0},
+	[READOUT_CURRENT_DEVIATION] = {"RMS", "A", 1, 6, 0},
+	[READOUT_VOLTAGE_RIPPLE] = {"P-P", "V", 1, 6, 0},
+	[READOUT_VOLTAGE_DEVIATION] = {"RMS", "V", 1, 6, 0},
+	[READOUT_RIPPLE_TONE] = {"AC", "V", 1, 6, READOUT_OPTIONAL},
+	[READOUT_CURRENT_PEAK] = {"MAX", "A", 1, 6, READOUT_OPTIONAL},
+	[READOUT_CURRENT_VALLEY] = {"MIN", "A", 1, 6, READOUT_OPTIONAL},
+	[READOUT_CURRENT_AVERAGE] = {"AVG", "A", 1, 6, READOUT_OPTIONAL},
+	[READOUT_VOLTAGE_PEAK] = {"MAX", "V", 1, 6, READOUT_OPTIONAL},
+	[READOUT_VOLTAGE_VALLEY] = {"MIN", "V", 1, 6, READOUT_OPTIONAL},
+	[READOUT_VOLTAGE_AVERAGE] = {"AVG", "V", 1, 6, READOUT_OPTIONAL},
+	// Drawn by draw_bar, and only in the smaller displays
+	[READOUT_CURRENT_BAR] = {"", NULL, 1, 6, 0},
+	[READOUT_THERMAL_BAR] = {"", NULL, 1, 6, 0},
+};
 
-void print_voltage(char *buf) {
-	format_number(get_voltage(), 'V', buf);
+static uint8 is_bar(readout_function readout) {
+	return readout == READOUT_CURRENT_BAR || readout == READOUT_THERMAL_BAR;
 }
 
-void print_power(char *buf) {
-	int power = (get_current_usage() / 1000) * (get_voltage() / 1000);
-	format_number(power, 'W', buf);
+// Settings written by an older or newer firmware may hold any byte
+static readout_function valid_readout(uint8 readout) {
+	return (readout < READOUT_COUNT)?readout:READOUT_NONE;
 }
 
-void print_resistance(char *buf) {
-	int current = get_current_usage();
-	if(current > 0) {
-		format_number(((get_voltage() * 10) / (current / 100000)), GLYPH_CHAR(FONT_GLYPH_OHM), buf);
+// Appends the 'h' to a format_number reading: "12.3Ah", or "1.23mAh" with a
+// prefix, which is one character longer than other readouts
+static void append_hours(char *buf) {
+	if(buf[5] == ' ') {
+		buf[5] = 'h';
 	} else {
-		strcpy(buf, "----" FONT_GLYPH_OHM);
+		strcat(buf, "h");
 	}
 }
 
-const readout_function_impl readout_functions[] = {
-	{NULL, ""},
-	{print_setpoint, "SET"},
-	{print_current_usage, "ACT"},
-	{print_voltage, ""},
-	{print_power, ""},
-	{print_resistance, ""},
-};
+static int clamp_total(uint32 total) {
+	return (total > READOUT_MAX)?READOUT_MAX:total;
+}
 
-static void draw_status(const display_config_t *config) {
-	char buf[8];
+// Formats value as readout shows it, into buf of at least 8 characters
+static void format_readout(readout_function readout, int value, char *buf) {
+	const readout_format *f = &readout_formats[readout];
+	uint8 len;
 
-	// Draw the main info
-	const readout_function_impl *readout = &readout_functions[config->readouts[0]];
-	if(readout->func != print_nothing) {
-		readout->func(buf);
-		strcat(buf, " ");
-		Display_DrawBigNumbers(0, 0, buf);
-		if(strchr(buf, '.') == NULL)
-			// Clear any detritus left over from longer strings
-			Display_Clear(0, 108, 4, 120, 0);
+	if(f->unit == NULL) {
+		buf[0] = '\0';
+	} else if(value < 0 && (f->flags & READOUT_OPTIONAL)) {
+		strcpy(buf, "----");
+		strcat(buf, f->unit);
 	} else {
-		Display_Clear(0, 0, 6, 120, 0);
-		Display_Clear(4, 120, 6, 160, 0);
+		int scaled = mul_saturate(value, f->scale);
+		format_number((scaled > READOUT_MAX)?READOUT_MAX:scaled, f->unit[0], buf);
+		if(f->flags & READOUT_HOURS)
+			append_hours(buf);
 	}
+	for(len = strlen(buf); len < f->width; len++)
+		buf[len] = ' ';
+	buf[len] = '\0';
+}
 
-	// Draw the type in the top right
-	uint8 labelsize = strlen(readout->label) * 12;
-	Display_DrawText(0, 160 - labelsize, readout->label, 1);
-	if(labelsize < 36)
-		Display_Clear(0, 124, 2, 160 - labelsize, 0);
+// Fills values, indexed by readout_function, from one measurement. The
+// setpoints and readings are cheap and always filled; the derived ones take a
+// multiply or divide, so only those in wanted (a bit per readout) are.
+static void take_readings(int *values, uint32 wanted) {
+	measurement m;
+	get_measurement(&m);
 
-	// Draw the two smaller displays
-	for(int i = 0; i < 2; i++) {
-		readout = &readout_functions[config->readouts[i + 1]];
-		readout->func(buf);
-		if(strlen(buf) == 5)
-			strcat(buf, " ");
-		Display_DrawText(6, 88 * i, buf, 0);
+	values[READOUT_NONE] = 0;
+	values[READOUT_CURRENT_SETPOINT] = get_current_setpoint();
+	values[READOUT_VOLTAGE_SETPOINT] = get_voltage_target();
+	values[READOUT_RESISTANCE_SETPOINT] = get_resistance_target();
+	values[READOUT_POWER_SETPOINT] = get_power_target();
+	values[READOUT_CURRENT_USAGE] = m.current;
+	values[READOUT_VOLTAGE] = m.voltage;
+	if(wanted & (1 << READOUT_POWER))
+		values[READOUT_POWER] = power_from(m.current, m.voltage);
+	if(wanted & (1 << READOUT_RESISTANCE))
+		values[READOUT_RESISTANCE] = resistance_from_raw(m.raw_voltage, m.raw_current);
+	if(wanted & ((1 << READOUT_CHARGE) | (1 << READOUT_ENERGY))) {
+		energy_totals totals;
+		get_energy_totals(&totals);
+		values[READOUT_CHARGE] = clamp_total(totals.charge);
+		values[READOUT_ENERGY] = clamp_total(totals.energy);
+	}
+	if(wanted & ((1 << READOUT_CURRENT_RIPPLE) | (1 << READOUT_CURRENT_DEVIATION)
+	             | (1 << READOUT_VOLTAGE_RIPPLE) | (1 << READOUT_VOLTAGE_DEVIATION))) {
+		statistics stats;
+		get_statistics(&stats);
+		values[READOUT_CURRENT_RIPPLE] = stats.channel[FILTER_CURRENT].ripple;
+		values[READOUT_CURRENT_DEVIATION] = stats.channel[FILTER_CURRENT].deviation;
+		values[READOUT_VOLTAGE_RIPPLE] = stats.channel[FILTER_VOLTAGE].ripple;
+		values[READOUT_VOLTAGE_DEVIATION] = stats.channel[FILTER_VOLTAGE].deviation;
+	}
+	values[READOUT_RIPPLE_TONE] = get_ripple_amplitude(0);
+	if(wanted & ((1ul << READOUT_CURRENT_PEAK) | (1ul << READOUT_CURRENT_VALLEY) | (1ul << READOUT_CURRENT_AVERAGE)
+	             | (1ul << READOUT_VOLTAGE_PEAK) | (1ul << READOUT_VOLTAGE_VALLEY) | (1ul << READOUT_VOLTAGE_AVERAGE))) {
+		hold_readings holds;
+		get_holds(&holds);
+		// Dashes until the first block since a reset; a reading below zero
+		// is the offset's noise, so it shows as zero rather than as dashes
+		for(int chan = 0; chan < FILTER_CHANNELS; chan++) {
+			int *held = &values[(chan == FILTER_CURRENT)?READOUT_CURRENT_PEAK:READOUT_VOLTAGE_PEAK];
+			held[0] = holds.scans ? (holds.peak[chan] > 0 ? holds.peak[chan] : 0) : -1;
+			held[1] = holds.scans ? (holds.valley[chan] > 0 ? holds.valley[chan] : 0) : -1;
+			held[2] = holds.scans ? (holds.average[chan] > 0 ? holds.average[chan] : 0) : -1;
+		}
+	}
+	// The bars are in thousandths of full, which draw_bar clamps
+	if(wanted & (1ul << READOUT_CURRENT_BAR)) {
+		int setpoint = values[READOUT_CURRENT_SETPOINT];
+		values[READOUT_CURRENT_BAR] = (setpoint > 0) ? (int)(((int64)m.current * 1000) / setpoint) : 0;
 	}
+	if(wanted & (1ul << READOUT_THERMAL_BAR))
+		values[READOUT_THERMAL_BAR] = ((get_temperature() - THERMAL_DEFAULT_CAL_TEMPERATURE) * 1000)
+			/ (FAULT_OVERTEMP_LIMIT - THERMAL_DEFAULT_CAL_TEMPERATURE);
 }
 
-static state_func display_config(const void *arg) {
-	display_config_t *config = (display_config_t*)arg;
-	
-	state_func display = menu(&choose_readout_menu);
-	if(display.func == overtemp)
-		return display;
-	
-	state_func readout = menu(&set_readout_menu);
-	if(readout.func == overtemp)
-		return readout;
-	
-	EEPROM_Write((uint8*)&((readout_function){(readout_function)readout.arg}), (uint8*)&config->readouts[(int)display.arg], sizeof(readout_function));
-	
-	return (state_func)STATE_MAIN;
-}
+// The bars fill a smaller display's 72 by 16 pixels: an outline with a cap at
+// each end, and between them columns that are empty, full, or for the one
+// the edge falls in, a quarter, half or three quarters full shown in gray.
+// Each is a tile of the two pages' 4 grayscale planes, MSB first, so a
+// column goes out as it's stored; only the columns the edge crossed since the
+// last draw are sent.
+#define BAR_COLUMNS 72
+#define BAR_INNER (BAR_COLUMNS - 2)
+#define BAR_STEPS (BAR_INNER * 4)	// Quarter columns
+#define BAR_BURST 8	// Columns per write
 
-static state_func set_contrast(const void *arg) {
-	Display_ClearAll();
-	Display_Clear(0, 0, 2, 160, 0xFF);
-	Display_DrawText(0, 32, "Contrast", 1);
-	Display_DrawText(6, 38, FONT_GLYPH_ENTER ": Done", 0);
+// Outline on rows 2 and 13 and fill on rows 4 to 11, bit 0 at the top. A
+// tile's fill is lit on the planes given, MSB first.
+#define BAR_OUTLINE_TOP 0x04
+#define BAR_OUTLINE_BOTTOM 0x20
+#define BAR_FILL_TOP 0xF0
+#define BAR_FILL_BOTTOM 0x0F
+#define BAR_PAGE(outline, fill, p3, p2, p1, p0) \
+	{(outline) | ((p3)?(fill):0), (outline) | ((p2)?(fill):0), (outline) | ((p1)?(fill):0), (outline) | ((p0)?(fill):0)}
+#define BAR_TILE(p3, p2, p1, p0) { \
+	BAR_PAGE(BAR_OUTLINE_TOP, BAR_FILL_TOP, p3, p2, p1, p0), \
+	BAR_PAGE(BAR_OUTLINE_BOTTOM, BAR_FILL_BOTTOM, p3, p2, p1, p0)}
 
-	// Left and right ends of the bar
-	Display_Clear(4, 15, 5, 16, 0xFF);
-	Display_Clear(4, 145, 5, 146, 0xFF);
-	
-	int contrast = settings->lcd_contrast;
-	ui_event event;
-	while(1) {
-		Display_Clear(4, 16, 5, 16 + contrast * 2, 0xFF);
-		Display_Clear(4, 16 + contrast * 2, 5, 145, 0x81);
-		
-		next_event(&event);
-		switch(event.type) {
-		case UI_EVENT_UPDOWN:
-			contrast += event.int_arg;
-			if(contrast > 0x3F) {
-				contrast = 0x3F;
-			} else if(contrast < 0) {
-				contrast = 0;
-			}
-			Display_SetContrast(contrast);
-			break;
-		case UI_EVENT_BUTTONPRESS:
-			if(event.int_arg == 1) {
-				EEPROM_Write((const uint8*)&contrast, (const uint8*)&settings->lcd_contrast, sizeof(int));
-				return (state_func)STATE_MAIN;
-			}
-			break;
-		case UI_EVENT_OVERTEMP:
-			return (state_func)STATE_OVERTEMP;
-		default:
-			break;
+// By quarters filled: gray levels 0, 4, 8, 12 and 15 of 15
+static const uint8 bar_tiles[5][2][4] = {
+	BAR_TILE(0, 0, 0, 0),
+	BAR_TILE(0, 1, 0, 0),
+	BAR_TILE(1, 0, 0, 0),
+	BAR_TILE(1, 1, 0, 0),
+	BAR_TILE(1, 1, 1, 1),
+};
+// Rows 2 to 13
+static const uint8 bar_cap[2][4] = {{0xFC, 0xFC, 0xFC, 0xFC}, {0x3F, 0x3F, 0x3F, 0x3F}};
+
+// The fill each smaller display's bar showed, in quarter columns
+static uint16 bar_shown[2];
+
+_Static_assert(2 * BAR_BURST * 4 <= DRAW_BUFFER_SIZE, "a bar burst must fit the draw buffer");
+
+// Sends inner columns from first up to, not including, end, filled to steps
+static void draw_bar_columns(uint8 page, uint8 col, uint8 first, uint8 end, uint16 steps) {
+	uint8 (*burst)[BAR_BURST * 4] = (uint8 (*)[BAR_BURST * 4])draw_buffer;
+	while(first < end) {
+		uint8 n = (end - first > BAR_BURST) ? BAR_BURST : end - first;
+		for(uint8 i = 0; i < n; i++) {
+			int quarters = steps - (first + i) * 4;
+			const uint8 (*tile)[4] = bar_tiles[(quarters < 0) ? 0 : (quarters > 4) ? 4 : quarters];
+			memcpy(&burst[0][i * 4], tile[0], 4);
+			memcpy(&burst[1][i * 4], tile[1], 4);
 		}
+		for(uint8 row = 0; row < 2; row++) {
+			Display_SetCursorPosition(page + row, col + 1 + first);
+			Display_WritePixels(burst[row], n * 4);
+		}
+		first += n;
 	}
 }
 
-static state_func overtemp(const void *arg) {
-	Display_Clear(0, 0, 8, 160, 0xFF);
-	Display_DrawText(2, 6, "! OVERTEMP !", 1);
-	Display_DrawText(6, 32, FONT_GLYPH_ENTER ": Reset", 1);
-	
-	ui_event event;
-	event.type = UI_EVENT_NONE;
-	while(event.type != UI_EVENT_BUTTONPRESS || event.int_arg != 1) {
-		next_event(&event);
-		if(get_output_mode() == OUTPUT_MODE_FEEDBACK)
-			return (state_func)STATE_MAIN;
+// Draws smaller display slot's bar at thousandths of full: the whole bar when
+// shown holds anything but a bar, as after invalidate_status or a readout,
+// and after that only the columns between the old edge and the new. Returns
+// whether anything was sent.
+static uint8 draw_bar(uint8 page, uint8 col, int thousandths, char *shown, uint8 slot) {
+	uint16 steps = (thousandths <= 0) ? 0 : (thousandths >= 1000) ? BAR_STEPS : (thousandths * BAR_STEPS) / 1000;
+	if(strcmp(shown, "|") != 0) {
+		for(uint8 row = 0; row < 2; row++) {
+			Display_SetCursorPosition(page + row, col);
+			Display_WritePixels((uint8*)bar_cap[row], 4);
+			Display_SetCursorPosition(page + row, col + BAR_COLUMNS - 1);
+			Display_WritePixels((uint8*)bar_cap[row], 4);
+		}
+		draw_bar_columns(page, col, 0, BAR_INNER, steps);
+		strcpy(shown, "|");
+		bar_shown[slot] = steps;
+		return 1;
 	}
-		
-	set_current(0);
-	set_output_mode(OUTPUT_MODE_FEEDBACK);
-	return (state_func)STATE_MAIN;
+	if(steps == bar_shown[slot])
+		return 0;
+
+	uint16 low = (steps < bar_shown[slot]) ? steps : bar_shown[slot];
+	uint16 high = (steps < bar_shown[slot]) ? bar_shown[slot] : steps;
+	// The columns holding either edge and any between
+	draw_bar_columns(page, col, low / 4, (high + 3) / 4, steps);
+	bar_shown[slot] = steps;
+	return 1;
 }
 
-static state_func menu(const void *arg) {
-	const menudata *menu = (const menudata *)arg;
-	
-	Display_ClearAll();
-	
-	int selected = 0;
-	ui_event event;
-	event.type = UI_EVENT_NONE;
-	while(event.type != UI_EVENT_BUTTONPRESS || event.int_arg != 1) {
-		draw_menu(menu, selected);
-		next_event(&event);
-		switch(event.type) {
-		case UI_EVENT_UPDOWN:
-			if(event.int_arg < 0) {
-				// Move up the menu
-				if(selected + event.int_arg >= 0) {
-					selected += event.int_arg;
-				} else {
-					selected = 0;
-				}
-			} else {
-				// Move down the menu (but not past the end)
-				for(int i = 0; i < event.int_arg; i++) {
-					if(menu->items[selected + 1].caption == NULL)
-						break;
-					selected++;
-				}
-			}
-			break;
-		case UI_EVENT_OVERTEMP:
-			return (state_func)STATE_OVERTEMP;
-		default:
-			break;
-		}
-	}
+// The text each readout showed when last drawn, so unchanged ones aren't
+// sent to the display again. An empty string forces a redraw.
+static char status_shown[3][8];
+// Replaces the main readout's label while not NULL
+static const char *status_label;
 
-	return menu->items[selected].new_state;
+static void invalidate_status() {
+	memset(status_shown, 0, sizeof(status_shown));
 }
 
-#ifdef USE_SPLASHSCREEN
-static state_func splashscreen(const void *arg) {
-	vTaskDelay(configTICK_RATE_HZ * 3);
-	return (state_func)STATE_CC_LOAD;
+// How many columns a character of a readout takes
+static uint8 char_width(char c, uint8 big) {
+	return big?Display_BigNumberWidth(c):12;
 }
-#endif
 
-static state_func cc_load(const void *arg) {
-	Display_ClearAll();
-	
-	ui_event event;
-	while(1) {
-		next_event(&event);
-		switch(event.type) {
-		case UI_EVENT_BUTTONPRESS:
-			if(event.int_arg == 1)
-				return (state_func)STATE_MAIN_MENU;
-		case UI_EVENT_UPDOWN:
-			adjust_current_setpoint(event.int_arg);
-			break;
-		case UI_EVENT_OVERTEMP:
-			return (state_func)STATE_OVERTEMP;
-		default:
-			break;
-		}
-		draw_status(&display_settings.cc);
-		//CyDelay(200);
+// Whether text can be drawn over shown cell by cell. Big characters have
+// widths of their own, and the decimal point is drawn taller than other text,
+// so each must keep its width and the decimal point stay put.
+static uint8 same_layout(const char *text, const char *shown, uint8 big) {
+	for(; *text != '\0' && *shown != '\0'; text++, shown++) {
+		if(big && (char_width(*text, 1) != char_width(*shown, 1) || (*text == '.') != (*shown == '.')))
+			return 0;
 	}
+	return *text == *shown;
 }
 
-// Calibrates the ADC voltage and current offsets.
-// Run with nothing attached to the terminals.
-static void calibrate_offsets(settings_t *new_settings) {
-	Display_DrawText(2, 0, "  1: Offset  ", 1);
-	Display_DrawText(6, 38, FONT_GLYPH_ENTER ": Next", 0);
+// Draws a readout, sending only the runs of characters that differ from what
+// it showed last time, then remembers text in shown. Returns whether anything
+// was sent.
+static uint8 draw_readout(uint8 page, uint8 col, const char *text, char *shown, uint8 big) {
+	if(!same_layout(text, shown, big)) {
+		if(big) {
+			Display_DrawBigNumbers(page, col, text);
+			if(strchr(text, '.') == NULL)
+				// Clear any detritus left over from longer strings
+				Display_Clear(page, col + 108, page + 4, col + 120, 0);
+		} else {
+			Display_DrawText(page, col, text, 0);
+		}
+		strcpy(shown, text);
+		return 1;
+	}
 
-	// Wait for a button press
-	ui_event event;
-	event.type = UI_EVENT_NONE;
-	while(event.type != UI_EVENT_BUTTONPRESS || event.int_arg != 1)
-		next_event(&event);
-	
-	new_settings->adc_voltage_offset = get_raw_voltage();
-	new_settings->adc_current_offset = get_raw_current_usage();
+	uint8 drawn = 0;
+	char run[8];
+	for(uint8 i = 0; text[i] != '\0';) {
+		if(text[i] == shown[i]) {
+			col += char_width(text[i], big);
+			i++;
+			continue;
+		}
+
+		uint8 start_col = col, len = 0;
+		for(; text[i] != '\0' && text[i] != shown[i]; i++) {
+			run[len++] = text[i];
+			col += char_width(text[i], big);
+		}
+		run[len] = '\0';
+		drawn = 1;
+		if(big) {
+			Display_DrawBigNumbers(page, start_col, run);
+		} else {
+			Display_DrawText(page, start_col, run, 0);
+		}
+	}
+	strcpy(shown, text);
+	return drawn;
 }
 
-// Calibrate the ADC voltage gain.
-// Run with a known voltage across the terminals
-static void calibrate_voltage(settings_t *new_settings) {
-	Display_DrawText(2, 0, "  2: Voltage ", 1);
+// Draws the main readout's label, inverted in the top right
+static void draw_label(const char *label) {
+	uint8 labelsize = strlen(label) * 12;
+	draw_text(0, 160 - labelsize, label, 1);
+	if(labelsize < 36)
+		Display_Clear(0, 124, 2, 160 - labelsize, 0);
+}
 
-	ui_event event;
+// Returns whether anything was drawn
+static uint8 draw_status(const display_config_t *config) {
 	char buf[8];
-	event.type = UI_EVENT_NONE;
-	while(event.type != UI_EVENT_BUTTONPRESS || event.int_arg != 1) {
-		next_event(&event);
-		
-		format_number((get_raw_voltage() - new_settings->adc_voltage_offset) * new_settings->adc_voltage_gain, 'V', buf);
-		strcat(buf, " ");
-		Display_DrawText(4, 43, buf, 0);
-		
-		switch(event.type) {
-		case UI_EVENT_UPDOWN:
-			new_settings->adc_voltage_gain += (new_settings->adc_voltage_gain * event.int_arg) / 500;
+	int values[READOUT_COUNT];
+	readout_function readouts[3];
+	uint32 wanted = 0;
+	uint8 drawn = 0;
+
+	for(int i = 0; i < 3; i++) {
+		readouts[i] = valid_readout(config->readouts[i]);
+		// A bar doesn't fit the main display's digits
+		if(i == 0 && is_bar(readouts[i]))
+			readouts[i] = READOUT_NONE;
+		wanted |= 1ul << readouts[i];
+	}
+	take_readings(values, wanted);
+
+	// Draw the main info
+	if(status_shown[0][0] == 0) {
+		draw_label(status_label ? status_label : readout_formats[readouts[0]].label);
+		drawn = 1;
+	}
+
+	if(readouts[0] != READOUT_NONE) {
+		format_readout(readouts[0], values[readouts[0]], buf);
+		// The space clears after a shorter reading; 7 characters fill the width
+		if(strlen(buf) < 7)
+			strcat(buf, " ");
+		drawn |= draw_readout(0, 0, buf, status_shown[0], 1);
+	} else if(status_shown[0][0] == 0) {
+		Display_Clear(0, 0, 6, 120, 0);
+		Display_Clear(4, 120, 6, 160, 0);
+		strcpy(status_shown[0], " ");
+	}
+
+	// Draw the two smaller displays
+	for(int i = 1; i < 3; i++) {
+		if(is_bar(readouts[i])) {
+			drawn |= draw_bar(6, 88 * (i - 1), values[readouts[i]], status_shown[i], i - 1);
+			continue;
+		}
+		format_readout(readouts[i], values[readouts[i]], buf);
+		drawn |= draw_readout(6, 88 * (i - 1), buf, status_shown[i], 0);
+	}
+	return drawn;
+}
+
+// Display benchmarks for 'bench'. They run here because only the UI task may
+// draw. The screen is cleared afterwards and the status redrawn in full, so
+// run them from a load screen; menus don't redraw until they change.
+bench_result ui_bench_results[UI_BENCH_COUNT];
+
+static void bench_clear() {
+	Display_Clear(0, 0, 8, 160, 0);
+}
+
+static void bench_big_numbers() {
+	Display_DrawBigNumbers(0, 0, "1.234");
+}
+
+static void bench_status() {
+	invalidate_status();
+	draw_status(LOAD_DISPLAY(&load_configs[get_load_mode()]));
+}
+
+static void run_benchmarks() {
+	static const struct {
+		const char *name;
+		bench_func func;
+	} cases[UI_BENCH_COUNT] = {
+		{"clear", bench_clear},
+		{"bignumbers", bench_big_numbers},
+		{"status", bench_status},
+	};
+
+	for(int i = 0; i < UI_BENCH_COUNT; i++) {
+		ui_bench_results[i].name = cases[i].name;
+		ui_bench_results[i].cycles = bench_cycles(cases[i].func, 10);
+	}
+	Display_ClearAll();
+	invalidate_status();
+	xQueueSendToBack(comms_queue, &((comms_event){.type=COMMS_EVENT_BENCH}), portMAX_DELAY);
+}
+
+// Screens draw their first frame off-screen, and ui_enter shows it once it's
+// complete, so a new screen never appears a row at a time
+static void clear_screen() {
+	Display_BeginFrame();
+	Display_ClearAll();
+}
+
+// What the showing screen keeps between events. Only one shows at a time, so
+// they share the space.
+static union {
+	struct {
+		const menudata *menu;
+		int selected, shown;	// shown is the selection on screen, -1 for none
+	} menu;
+	int preset_slot;
+	struct {
+		const valueconfig *config;
+		int value, index;
+	} edit;
+	uint8 graph_drawn;	// Graph column drawn up to
+	struct {
+		int8 was_running;
+		int max_power, max_voltage;
+	} sweep;
+	struct {
+		const loadconfig *config;
+		int8 digit;			// Index into load_digits, or -1 to adjust the whole setpoint
+		int preset_slot;	// Picked by press-and-turn, or -1 for none
+		char preset_label[4];
+	} load;
+	portTickType splash_until;
+	struct {
+		uint8 step;
+		// The figures being calibrated, written to settings at the end
+		int voltage_offset, current_offset, voltage_gain, opamp_trim;
+	} calibrate;
+} screen_data;
+
+static int go(state_func *next, const state_func *state) {
+	memcpy(next, state, sizeof(state_func));
+	return 1;
+}
+
+// Which readout choose_readout sets, from choose_readout_menu
+static uint8 readout_display;
+
+static int choose_display(const menuitem *item, state_func *next) {
+	readout_display = (int)item->new_state.arg;
+	return go(next, &(state_func)STATE_MENU(set_readout_menu));
+}
+
+// Sets the readout for whichever load mode is active
+static int choose_readout(const menuitem *item, state_func *next) {
+	const display_config_t *config = LOAD_DISPLAY(&load_configs[get_load_mode()]);
+	uint8 choice = (readout_function)item->new_state.arg;
+	settings_write(&choice, &config->readouts[readout_display], sizeof(choice));
+	return go(next, &(state_func)STATE_MAIN);
+}
+
+// Switches the active load mode to another of its layouts. Only the RAM copy
+// changes; the choice is saved along with the next setting that is.
+static int choose_layout(const menuitem *item, state_func *next) {
+	uint8 mask = 1 << get_load_mode();
+	uint8 layouts = (settings->display_layouts & ~mask) | (((int)item->new_state.arg)?mask:0);
+	settings_write_volatile(&layouts, &settings->display_layouts, sizeof(layouts));
+	return go(next, &(state_func)STATE_MAIN);
+}
+
+static void draw_preset(int slot) {
+	static const char *const mode_labels[] = {"C/C", "C/V", "C/R", "C/P"};
+	static const readout_function target_readouts[] = {
+		READOUT_CURRENT_SETPOINT, READOUT_VOLTAGE_SETPOINT, READOUT_RESISTANCE_SETPOINT, READOUT_POWER_SETPOINT,
+	};
+	const preset *p = get_preset(slot);
+	char buf[14];
+
+	Display_Clear(2, 0, 6, 160, 0);
+	if(p == NULL || p->mode > LOAD_MODE_CP) {
+		format(buf, "%d: Empty", slot + 1);
+		Display_DrawText(2, 6, buf, 0);
+		return;
+	}
+	format(buf, "%d: %s ", slot + 1, mode_labels[p->mode]);
+	format_readout(target_readouts[p->mode], p->target, buf + strlen(buf));
+	Display_DrawText(2, 6, buf, 0);
+	// The trip points, over then under
+	format_number(p->overvoltage_limit * 1000, 'V', buf);
+	Display_DrawText(4, 6, buf, 0);
+	format_number(p->undervoltage_limit * 1000, 'V', buf);
+	Display_DrawText(4, 84, buf, 0);
+}
+
+// The knob picks a preset slot and a tap applies it, going to its load
+// screen. A hold stores the present setpoint in the slot instead.
+static void preset_enter(const void *arg) {
+	clear_screen();
+	Display_Clear(0, 0, 2, 160, 0xFF);
+	Display_DrawText(0, 38, "Presets", 1);
+	Display_DrawText(6, 26, FONT_GLYPH_ENTER ": Recall", 0);
+
+	screen_data.preset_slot = 0;
+	draw_preset(0);
+	gesture_start(0);
+}
+
+static int preset_event(const ui_event *event, state_func *next) {
+	int *slot = &screen_data.preset_slot;
+	switch(event->type) {
+	case UI_EVENT_UPDOWN:
+		*slot += event->int_arg;
+		if(*slot < 0) {
+			*slot = 0;
+		} else if(*slot >= PRESET_COUNT) {
+			*slot = PRESET_COUNT - 1;
+		}
+		draw_preset(*slot);
+		break;
+	case UI_EVENT_GESTURE:
+		switch(event->int_arg) {
+		case GESTURE_CLICK:
+			if(preset_recall(*slot))
+				return go(next, &(state_func)STATE_LOAD(get_load_mode()));
+			break;
+		case GESTURE_LONG_PRESS:
+			preset_store(*slot);
+			draw_preset(*slot);
 			break;
 		default:
 			break;
 		}
+		break;
+	default:
+		break;
 	}
+	return 0;
 }
 
-// Calibrates the opamp and current DAC offsets.
-// Run with a voltage source attached
-static void calibrate_opamp_dac_offsets(settings_t *new_settings) {
-	Display_Clear(2, 0, 8, 160, 0);
-	Display_DrawText(4, 12, "Please wait", 0);
-	set_current(100000);
+static const ui_screen preset_screen = {preset_enter, preset_event};
 
-	// Find the best setting for the opamp trim
-	for(int i = 0; i < 32; i++) {
-		CY_SET_REG32(Opamp_cy_psoc4_abuf__OA_OFFSET_TRIM, i);
-		CyDelay(10);
-		
-//		ADC_EnableInjection();
-		ADC_IsEndConversion(ADC_WAIT_FOR_RESULT_INJ);
-		int offset = ADC_GetResult16(ADC_CHAN_CURRENT_SENSE) - ADC_GetResult16(ADC_CHAN_CURRENT_SET);
-		if(offset <= 0) {
-			new_settings->opamp_offset_trim = i - 1;
+static int read_value(const valueconfig *config) {
+	const void *field = (const char *)settings + config->offset;
+	switch(config->size) {
+	case 0:
+		return config->get();
+	case 1:
+		return *(const uint8 *)field;
+	case 2:
+		return *(const uint16 *)field;
+	default:
+		return *(const int *)field;
+	}
+}
+
+static void write_value(const valueconfig *config, int value) {
+	uint8 byte = value;
+	uint16 half = value;
+	switch(config->size) {
+	case 0:
+		config->set(value);
+		break;
+	case 1:
+		settings_write(&byte, (const char *)settings + config->offset, 1);
+		break;
+	case 2:
+		settings_write(&half, (const char *)settings + config->offset, 2);
+		break;
+	default:
+		settings_write(&value, (const char *)settings + config->offset, 4);
+		break;
+	}
+	if(config->changed)
+		config->changed();
+}
+
+static int choice_index(const valueconfig *config, int value) {
+	for(int i = 0; i < config->choice_count; i++)
+		if(config->choices[i].value == value)
+			return i;
+	return 0;
+}
+
+// Draws the value being edited, and its bar for a number
+static void draw_edit_value() {
+	const valueconfig *config = screen_data.edit.config;
+	int value = screen_data.edit.value;
+	char buf[14];
+
+	if(config->type == VALUE_TYPE_CHOICE) {
+		strcpy(buf, config->choices[screen_data.edit.index].label);
+	} else if(config->unit) {
+		format_number(value * config->scale, config->unit, buf);
+	} else {
+		format(buf, "%d%s", value / config->scale, config->suffix);
+	}
+	Display_Clear(2, 0, 4, 160, 0);
+	Display_DrawText(2, (160 - strlen(buf) * 12) / 2, buf, 0);
+
+	if(config->type == VALUE_TYPE_NUMBER) {
+		// 128 pixels of bar, without overflowing on wide ranges
+		uint32 span = config->max - config->min, offset = value - config->min;
+		int bar = (span > 0xFFFFFF)?offset / (span / 128):offset * 128 / span;
+		Display_Clear(4, 16, 5, 16 + bar, 0xFF);
+		Display_Clear(4, 16 + bar, 5, 145, 0x81);
+	}
+}
+
+// Editor for any valueconfig: numbers as a figure over a bar, choices as their
+// label. The knob changes the value and a tap keeps it.
+static void edit_enter(const void *arg) {
+	const valueconfig *config = (const valueconfig *)arg;
+
+	clear_screen();
+	Display_Clear(0, 0, 2, 160, 0xFF);
+	Display_DrawText(0, (160 - strlen(config->title) * 12) / 2, config->title, 1);
+	draw_text(6, 38, FONT_GLYPH_ENTER ": Done", 0);
+
+	screen_data.edit.config = config;
+	screen_data.edit.value = read_value(config);
+	screen_data.edit.index = choice_index(config, screen_data.edit.value);
+	if(config->type == VALUE_TYPE_NUMBER) {
+		// Left and right ends of the bar
+		Display_Clear(4, 15, 5, 16, 0xFF);
+		Display_Clear(4, 145, 5, 146, 0xFF);
+	}
+	draw_edit_value();
+}
+
+static int edit_event(const ui_event *event, state_func *next) {
+	const valueconfig *config = screen_data.edit.config;
+	int *value = &screen_data.edit.value, *index = &screen_data.edit.index;
+	switch(event->type) {
+	case UI_EVENT_UPDOWN:
+		if(config->type == VALUE_TYPE_CHOICE) {
+			*index += event->int_arg;
+			if(*index < 0) {
+				*index = 0;
+			} else if(*index >= config->choice_count) {
+				*index = config->choice_count - 1;
+			}
+			*value = config->choices[*index].value;
+		} else {
+			*value += accelerate(event) * config->step;
+			if(*value > config->max) {
+				*value = config->max;
+			} else if(*value < config->min) {
+				*value = config->min;
+			}
+		}
+		if(config->preview)
+			config->preview(*value);
+		draw_edit_value();
+		break;
+	case UI_EVENT_BUTTONPRESS:
+		if(event->int_arg == 1) {
+			write_value(config, *value);
+			return go(next, &(state_func)STATE_MAIN);
+		}
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+static const ui_screen edit_screen = {edit_enter, edit_event};
+
+// The cause of the last trip and the current and voltage at the moment of
+// it, until a tap turns the output back on
+static void draw_fault() {
+	// Up to 9 characters, so "! title !" fits the width
+	static const char *const titles[FAULT_COUNT] = {
+		[FAULT_NONE] = "FAULT",
+		[FAULT_FET_MISMATCH] = "FET FAULT",
+		[FAULT_GATE_LIMIT] = "GATE HIGH",
+		[FAULT_OVERTEMP] = "OVERTEMP",
+		[FAULT_SOA] = "SOA LIMIT",
+		[FAULT_OVERVOLTAGE] = "OVERVOLT",
+		[FAULT_UNDERVOLTAGE] = "UNDERVOLT",
+		[FAULT_REVERSE] = "REVERSED",
+	};
+	const fault_record *fault = get_last_fault();
+	char buf[14];
+
+	Display_Clear(0, 0, 8, 160, 0xFF);
+	format(buf, "! %s !", titles[(fault != NULL && fault->code < FAULT_COUNT)?fault->code:FAULT_NONE]);
+	Display_DrawText(1, (160 - strlen(buf) * 12) / 2, buf, 1);
+	if(fault != NULL) {
+		format_number(current_from_raw(fault->raw_current), 'A', buf);
+		Display_DrawText(3, 6, buf, 1);
+		format_number(voltage_from_raw(fault->raw_voltage), 'V', buf);
+		Display_DrawText(3, 84, buf, 1);
+	}
+	Display_DrawText(6, 32, FONT_GLYPH_ENTER ": Reset", 1);
+}
+
+static void fault_enter(const void *arg) {
+	Display_BeginFrame();
+	draw_fault();
+}
+
+// Turning the output back on over the serial port leaves too; ui_dispatch
+// sees to that
+static int fault_event(const ui_event *event, state_func *next) {
+	if(event->type == UI_EVENT_FAULT) {
+		// Tripped again, maybe for another reason
+		draw_fault();
+	} else if(event->type == UI_EVENT_BUTTONPRESS && event->int_arg == 1) {
+		set_current(0);
+		set_output_mode(OUTPUT_MODE_FEEDBACK);
+		return go(next, &(state_func)STATE_MAIN);
+	}
+	return 0;
+}
+
+static const ui_screen fault_screen = {fault_enter, fault_event};
+
+// Remote lockout. While a host runs the unit the panel shows a fixed REMOTE
+// screen and draws nothing more, leaving the SPI bus and the CPU to the ADC and
+// comms tasks. The knob is ignored and a long press hands control back. With
+// auto lockout on, the first command of a session locks it: the first since
+// boot, or after REMOTE_QUIET_MS without one. So a release from the panel
+// holds while the host carries on talking. ui_dispatch follows remote_locked,
+// which either task may change.
+static volatile uint8 remote_locked;
+static uint8 remote_auto = 1;
+static uint8 remote_heard;
+static portTickType remote_last_command;
+
+// Called by the comms task for every command addressed to us
+void ui_remote_command() {
+	portTickType now = xTaskGetTickCount();
+	if(remote_auto && (!remote_heard || now - remote_last_command >= REMOTE_QUIET_MS / portTICK_RATE_MS))
+		remote_locked = 1;
+	remote_heard = 1;
+	remote_last_command = now;
+}
+
+void ui_set_remote(uint8 locked) {
+	remote_locked = locked;
+}
+
+uint8 ui_get_remote() {
+	return remote_locked;
+}
+
+void ui_set_remote_auto(uint8 enabled) {
+	remote_auto = enabled;
+}
+
+uint8 ui_get_remote_auto() {
+	return remote_auto;
+}
+
+static void remote_enter(const void *arg) {
+	clear_screen();
+	Display_Clear(0, 0, 2, 160, 0xFF);
+	Display_DrawText(0, 44, "REMOTE", 1);
+	Display_DrawText(6, 14, "Hold: Local", 0);
+	gesture_start(0);
+	// The sleep delay counts from here
+	last_input = xTaskGetTickCount();
+}
+
+static int remote_event(const ui_event *event, state_func *next) {
+	if(event->type != UI_EVENT_GESTURE || event->int_arg != GESTURE_LONG_PRESS)
+		return 0;
+	remote_locked = 0;
+	return go(next, &(state_func)STATE_MAIN);
+}
+
+static const ui_screen remote_screen = {remote_enter, remote_event};
+
+#ifdef USE_GRAPH
+// Trend graph. A sample of current and voltage is taken every
+// GRAPH_INTERVAL_US whatever is showing, so the graph has history when it's
+// opened. The plot sweeps left to right like a scope: each new sample
+// rewrites its own column and blanks the one ahead, so the cost per sample
+// doesn't depend on the width.
+static struct {
+	uint8 current[GRAPH_WIDTH];	// Pixels up from the bottom
+	uint8 voltage[GRAPH_WIDTH];
+	uint8 next;		// Column the next sample goes in
+	uint32 last_when;
+} graph;
+
+static uint8 graph_scale(int value, int full_scale) {
+	if(value <= 0)
+		return 0;
+	if(value >= full_scale)
+		return GRAPH_HEIGHT - 1;
+	return value / (full_scale / (GRAPH_HEIGHT - 1));
+}
+
+static void graph_sample(uint32 now) {
+	if(now - graph.last_when < GRAPH_INTERVAL_US)
+		return;
+	graph.last_when = now;
+
+	measurement m;
+	get_measurement(&m);
+	graph.current[graph.next] = graph_scale(m.current, CURRENT_FULLRANGE_MAX);
+	graph.voltage[graph.next] = graph_scale(m.voltage, GRAPH_VOLTAGE_MAX);
+	graph.next = (graph.next + 1 < GRAPH_WIDTH) ? graph.next + 1 : 0;
+}
+
+static void graph_plot(uint8 *pixels, uint8 y) {
+	uint8 row = GRAPH_HEIGHT - 1 - y;
+	pixels[row >> 3] |= 1 << (row & 7);
+}
+
+// Columns drawn per burst: the burst's slice of each page is one write. Every
+// page's slice has to fit the draw buffer at once.
+#define GRAPH_BURST 6
+_Static_assert(GRAPH_PAGES * GRAPH_BURST * 4 <= DRAW_BUFFER_SIZE, "a graph burst must fit the draw buffer");
+
+// Which pixels of each page column x lights. Current is drawn as a joined-up
+// line, voltage as dots.
+static void graph_column_pixels(uint8 x, uint8 pixels[GRAPH_PAGES]) {
+	memset(pixels, 0, GRAPH_PAGES);
+
+	if(x != graph.next) {
+		uint8 prev = (x > 0) ? x - 1 : GRAPH_WIDTH - 1;
+		uint8 from = graph.current[x], to = graph.current[x];
+		if(prev != graph.next) {
+			// Run up or down to meet the previous sample
+			if(graph.current[prev] < from) {
+				from = graph.current[prev] + 1;
+			} else if(graph.current[prev] > to) {
+				to = graph.current[prev] - 1;
+			}
+		}
+		for(uint8 y = from; y <= to; y++)
+			graph_plot(pixels, y);
+		graph_plot(pixels, graph.voltage[x]);
+	}
+}
+
+// Draws count columns from x, without wrapping past the right edge. The
+// column address steps on by itself, so each page of a burst takes one cursor
+// command and one write rather than one of each per column.
+static void draw_graph_columns(uint8 x, uint8 count) {
+	uint8 (*burst)[GRAPH_BURST * 4] = (uint8 (*)[GRAPH_BURST * 4])draw_buffer;
+	while(count > 0) {
+		uint8 n = (count > GRAPH_BURST) ? GRAPH_BURST : count;
+		for(uint8 i = 0; i < n; i++) {
+			uint8 pixels[GRAPH_PAGES];
+			graph_column_pixels(x + i, pixels);
+			for(uint8 page = 0; page < GRAPH_PAGES; page++)
+				memset(&burst[page][i * 4], pixels[page], 4);
+		}
+		for(uint8 page = 0; page < GRAPH_PAGES; page++) {
+			Display_SetCursorPosition(page, x);
+			Display_WritePixels(burst[page], n * 4);
+		}
+		x += n;
+		count -= n;
+	}
+}
+
+static void graph_enter(const void *arg) {
+	clear_screen();
+	invalidate_status();
+	draw_graph_columns(0, GRAPH_WIDTH);
+	screen_data.graph_drawn = graph.next;
+}
+
+static int graph_event(const ui_event *event, state_func *next) {
+	if(event->type == UI_EVENT_BUTTONPRESS && event->int_arg == 1)
+		return go(next, &(state_func)STATE_MAIN_MENU);
+
+	uint8 drawn = screen_data.graph_drawn;
+	if(drawn != graph.next) {
+		// Columns sampled since last time, then the gap ahead of them
+		if(graph.next < drawn) {
+			draw_graph_columns(drawn, GRAPH_WIDTH - drawn);
+			drawn = 0;
+		}
+		draw_graph_columns(drawn, graph.next + 1 - drawn);
+		screen_data.graph_drawn = graph.next;
+	}
+
+	measurement m;
+	char buf[8];
+	get_measurement(&m);
+	format_readout(READOUT_CURRENT_USAGE, m.current, buf);
+	draw_readout(6, 0, buf, status_shown[1], 0);
+	format_readout(READOUT_VOLTAGE, m.voltage, buf);
+	draw_readout(6, 88, buf, status_shown[2], 0);
+	return 0;
+}
+
+static const ui_screen graph_screen = {graph_enter, graph_event};
+#endif
+
+#ifdef USE_BATTERY_TEST
+// Battery discharge test. The test itself runs in the ADC task; this screen
+// starts and stops it and shows the totals. While idle the knob sets the
+// cutoff, and a tap starts a test at the C/C setpoint. A tap stops a running
+// test, and a hold opens the menu without stopping it.
+static int battery_cutoff = BATTERY_DEFAULT_CUTOFF;
+
+static int get_cutoff() {
+	return battery_cutoff;
+}
+
+static int set_cutoff(int cutoff) {
+	battery_cutoff = cutoff;
+	return 1;
+}
+#endif
+
+#if defined(USE_BATTERY_TEST) || defined(USE_SWEEP) || defined(USE_MPPT) || defined(USE_IR_TEST) || defined(USE_STANDBY)
+// What each readout on the battery, sweep and MPPT screens last showed
+static char screen_shown[7][8];
+#endif
+
+#ifdef USE_BATTERY_TEST
+// "h:mm:ss", or "hhhmm" past 10 hours, to fit in 7 characters
+static void format_elapsed(uint32 seconds, char *buf) {
+	uint32 hours = seconds / 3600;
+	seconds -= hours * 3600;
+	uint32 minutes = seconds / 60;
+	if(hours < 10) {
+		format(buf, "%u:%02u:%02u", hours, minutes, seconds - minutes * 60);
+	} else {
+		format(buf, "%uh%02u", (hours > 999)?999:hours, minutes);
+	}
+}
+
+static void draw_battery() {
+	static const char *state_labels[] = {"OFF", "RUN", "END", "STP"};
+	char buf[12];
+
+	battery_state test = get_battery_state();
+	draw_readout(0, 124, state_labels[test], screen_shown[0], 0);
+
+	measurement m;
+	get_measurement(&m);
+	format_readout(READOUT_VOLTAGE, m.voltage, buf);
+	draw_readout(2, 0, buf, screen_shown[1], 0);
+	format_readout(READOUT_CURRENT_USAGE, m.current, buf);
+	draw_readout(2, 88, buf, screen_shown[2], 0);
+
+	energy_totals totals;
+	get_battery_result(&totals);
+	format_readout(READOUT_CHARGE, clamp_total(totals.charge), buf);
+	draw_readout(4, 0, buf, screen_shown[3], 0);
+	format_readout(READOUT_ENERGY, clamp_total(totals.energy), buf);
+	draw_readout(4, 88, buf, screen_shown[4], 0);
+	format_elapsed(totals.seconds, buf);
+	draw_readout(6, 0, buf, screen_shown[5], 0);
+	// "<3.00V": the test ends below this
+	buf[0] = '<';
+	format_number((test == BATTERY_RUNNING)?get_battery_cutoff():battery_cutoff, 'V', buf + 1);
+	buf[6] = '\0';
+	draw_readout(6, 88, buf, screen_shown[6], 0);
+}
+
+static void battery_enter(const void *arg) {
+	clear_screen();
+	memset(screen_shown, 0, sizeof(screen_shown));
+	Display_DrawText(0, 0, "Battery", 0);
+	gesture_start(0);
+	draw_battery();
+}
+
+static int battery_event(const ui_event *event, state_func *next) {
+	battery_state test = get_battery_state();
+	switch(event->type) {
+	case UI_EVENT_GESTURE:
+		switch(event->int_arg) {
+		case GESTURE_LONG_PRESS:
+			return go(next, &(state_func)STATE_MAIN_MENU);
+		case GESTURE_CLICK:
+			if(test == BATTERY_RUNNING) {
+				battery_stop();
+			} else {
+				battery_start(LOAD_MODE_CC, get_current_setpoint(), battery_cutoff);
+			}
+			break;
+		default:
 			break;
 		}
+		break;
+	case UI_EVENT_UPDOWN:
+		if(test != BATTERY_RUNNING) {
+			battery_cutoff += accelerate(event) * VOLTAGE_STEP;
+			if(battery_cutoff < VOLTAGE_STEP)
+				battery_cutoff = VOLTAGE_STEP;
+		}
+		break;
+	default:
+		break;
 	}
-	
-	set_current(0);
+	draw_battery();
+	return 0;
+}
+
+static const ui_screen battery_screen = {battery_enter, battery_event};
+#endif
+
+#ifdef USE_SWEEP
+// I-V sweep from zero to sweep_to, which the knob sets while idle. A tap
+// starts or abandons a sweep and a hold opens the menu. Once a sweep is done
+// the screen shows its maximum power point.
+static int sweep_to = SWEEP_DEFAULT_TO;
+
+// Sets *power (microwatts) and *voltage to the last sweep's best point
+static void find_max_power(int *power, int *voltage) {
+	*power = *voltage = 0;
+	for(int i = 0; i < get_sweep_length(); i++) {
+		const sweep_point *point = get_sweep_point(i);
+		int v = voltage_from_raw(point->raw_voltage);
+		int p = power_from(current_from_raw(point->raw_current), v);
+		if(p > *power) {
+			*power = p;
+			*voltage = v;
+		}
+	}
+}
+
+static void draw_sweep() {
+	char buf[12];
+	int index = get_sweep_index();
+	if((index >= 0) != screen_data.sweep.was_running) {
+		// Started or finished
+		screen_data.sweep.was_running = (index >= 0);
+		find_max_power(&screen_data.sweep.max_power, &screen_data.sweep.max_voltage);
+	}
+	draw_readout(0, 124, (index >= 0)?"RUN":"OFF", screen_shown[0], 0);
+
+	measurement m;
+	get_measurement(&m);
+	format_readout(READOUT_VOLTAGE, m.voltage, buf);
+	draw_readout(2, 0, buf, screen_shown[1], 0);
+	format_readout(READOUT_CURRENT_USAGE, m.current, buf);
+	draw_readout(2, 88, buf, screen_shown[2], 0);
+
+	format(buf, "%d/%d ", (index >= 0)?index:get_sweep_length(), SWEEP_MAX_POINTS);
+	draw_readout(4, 0, buf, screen_shown[3], 0);
+	// ">1.00A": the sweep runs up to this
+	buf[0] = '>';
+	format_number(sweep_to, 'A', buf + 1);
+	buf[6] = '\0';
+	draw_readout(4, 88, buf, screen_shown[4], 0);
+
+	format_number(screen_data.sweep.max_power, 'W', buf);
+	draw_readout(6, 0, buf, screen_shown[5], 0);
+	format_number(screen_data.sweep.max_voltage, 'V', buf);
+	draw_readout(6, 88, buf, screen_shown[6], 0);
+}
+
+static void sweep_enter(const void *arg) {
+	clear_screen();
+	memset(screen_shown, 0, sizeof(screen_shown));
+	Display_DrawText(0, 0, "I-V Sweep", 0);
+	gesture_start(0);
+	screen_data.sweep.was_running = -1;
+	screen_data.sweep.max_power = screen_data.sweep.max_voltage = 0;
+	draw_sweep();
+}
+
+static int sweep_event(const ui_event *event, state_func *next) {
+	int index = get_sweep_index();
+	switch(event->type) {
+	case UI_EVENT_GESTURE:
+		switch(event->int_arg) {
+		case GESTURE_LONG_PRESS:
+			return go(next, &(state_func)STATE_MAIN_MENU);
+		case GESTURE_CLICK:
+			if(index >= 0) {
+				sweep_stop();
+			} else {
+				sweep_start(0, sweep_to, SWEEP_MAX_POINTS, SWEEP_DEFAULT_SETTLE);
+			}
+			break;
+		default:
+			break;
+		}
+		break;
+	case UI_EVENT_UPDOWN:
+		if(index < 0) {
+			sweep_to += accelerate(event) * CURRENT_FULLRANGE_STEP;
+			if(sweep_to < CURRENT_FULLRANGE_STEP) {
+				sweep_to = CURRENT_FULLRANGE_STEP;
+			} else if(sweep_to > CURRENT_FULLRANGE_MAX) {
+				sweep_to = CURRENT_FULLRANGE_MAX;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+	draw_sweep();
+	return 0;
+}
+
+static const ui_screen sweep_screen = {sweep_enter, sweep_event};
+#endif
+
+#ifdef USE_MPPT
+// Maximum power point tracking: the live point on the top rows, the best
+// seen and the tracking efficiency below. A tap starts or stops it and a
+// hold opens the menu.
+static void draw_mppt() {
+	char buf[12];
+	mppt_status status;
+	get_mppt_status(&status);
+	draw_readout(0, 124, get_mppt_running()?"RUN":"OFF", screen_shown[0], 0);
+
+	format_number(status.voltage, 'V', buf);
+	draw_readout(2, 0, buf, screen_shown[1], 0);
+	format_number(status.current, 'A', buf);
+	draw_readout(2, 88, buf, screen_shown[2], 0);
+	format_number(status.power, 'W', buf);
+	draw_readout(4, 0, buf, screen_shown[3], 0);
+	// Padded to a constant width, so a shorter figure clears a longer one
+	format(buf, "%d%%   ", status.efficiency);
+	buf[4] = '\0';
+	draw_readout(4, 88, buf, screen_shown[4], 0);
+	format_number(status.max_power, 'W', buf);
+	draw_readout(6, 0, buf, screen_shown[5], 0);
+	format_number(status.max_voltage, 'V', buf);
+	draw_readout(6, 88, buf, screen_shown[6], 0);
+}
+
+static void mppt_enter(const void *arg) {
+	clear_screen();
+	memset(screen_shown, 0, sizeof(screen_shown));
+	Display_DrawText(0, 0, "MPPT", 0);
+	gesture_start(0);
+	draw_mppt();
+}
+
+static int mppt_event(const ui_event *event, state_func *next) {
+	if(event->type == UI_EVENT_GESTURE) {
+		switch(event->int_arg) {
+		case GESTURE_LONG_PRESS:
+			return go(next, &(state_func)STATE_MAIN_MENU);
+		case GESTURE_CLICK:
+			if(get_mppt_running()) {
+				mppt_stop();
+			} else {
+				mppt_start(MPPT_DEFAULT_STEP, MPPT_DEFAULT_INTERVAL);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	draw_mppt();
+	return 0;
+}
+
+static const ui_screen mppt_screen = {mppt_enter, mppt_event};
+#endif
+
+#ifdef USE_IR_TEST
+// Pulsed internal resistance test, from the transient generator's low
+// current up to ir_high, which the knob sets while idle. A tap starts or
+// abandons a test and a hold opens the menu.
+static int ir_high = IR_DEFAULT_HIGH;
+
+static void draw_ir() {
+	static const char *state_labels[] = {"OFF", "RUN", "END", "STP"};
+	char buf[12];
+
+	ir_state test = get_ir_state();
+	draw_readout(0, 124, state_labels[test], screen_shown[0], 0);
+
+	measurement m;
+	get_measurement(&m);
+	format_readout(READOUT_VOLTAGE, m.voltage, buf);
+	draw_readout(2, 0, buf, screen_shown[1], 0);
+	format_readout(READOUT_CURRENT_USAGE, m.current, buf);
+	draw_readout(2, 88, buf, screen_shown[2], 0);
+
+	ir_result result;
+	get_ir_result(&result);
+	if(test == IR_DONE && result.resistance >= 0) {
+		format_number(result.resistance, FONT_GLYPH_OHM[0], buf);
+	} else {
+		strcpy(buf, "----" FONT_GLYPH_OHM);
+	}
+	draw_readout(4, 0, buf, screen_shown[3], 0);
+	format(buf, "%d/%d ", result.pulses, IR_DEFAULT_PULSES);
+	draw_readout(4, 88, buf, screen_shown[4], 0);
+	format_number(result.voltage_drop, 'V', buf);
+	draw_readout(6, 0, buf, screen_shown[5], 0);
+	// ">1.00A": the high current
+	buf[0] = '>';
+	format_number(ir_high, 'A', buf + 1);
+	buf[6] = '\0';
+	draw_readout(6, 88, buf, screen_shown[6], 0);
+}
+
+static void ir_enter(const void *arg) {
+	clear_screen();
+	memset(screen_shown, 0, sizeof(screen_shown));
+	Display_DrawText(0, 0, "DC IR", 0);
+	gesture_start(0);
+	draw_ir();
+}
+
+static int ir_event(const ui_event *event, state_func *next) {
+	ir_state test = get_ir_state();
+	switch(event->type) {
+	case UI_EVENT_GESTURE:
+		switch(event->int_arg) {
+		case GESTURE_LONG_PRESS:
+			return go(next, &(state_func)STATE_MAIN_MENU);
+		case GESTURE_CLICK:
+			if(test == IR_RUNNING) {
+				ir_stop();
+			} else {
+				ir_start(get_pulse_config()->low_current, ir_high, IR_DEFAULT_PULSES, IR_DEFAULT_DELAY);
+			}
+			break;
+		default:
+			break;
+		}
+		break;
+	case UI_EVENT_UPDOWN:
+		if(test != IR_RUNNING) {
+			ir_high += accelerate(event) * CURRENT_FULLRANGE_STEP;
+			if(ir_high < CURRENT_FULLRANGE_STEP) {
+				ir_high = CURRENT_FULLRANGE_STEP;
+			} else if(ir_high > CURRENT_FULLRANGE_MAX) {
+				ir_high = CURRENT_FULLRANGE_MAX;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+	draw_ir();
+	return 0;
+}
+
+static const ui_screen ir_screen = {ir_enter, ir_event};
+#endif
+
+#ifdef USE_STANDBY
+// Standby current measurement at standby_setpoint, which the knob sets in
+// STANDBY_STEPs while idle. A tap starts or stops it and a hold opens the
+// menu, stopping it too. The reading and its uncertainty update once a
+// STANDBY_LINE_CYCLES period.
+static int standby_setpoint = 0;
+
+// "  12uA" below 10mA, where the microamps matter, then as the readouts
+static void format_standby_current(int value, char *buf) {
+	if(value >= 10000) {
+		format_number(value, 'A', buf);
+		return;
+	}
+	char digits[8];
+	format(digits, "%d", value);
+	int pad = 4 - (int)strlen(digits);
+	for(; pad > 0; pad--)
+		*buf++ = ' ';
+	format(buf, "%suA", digits);
+}
+
+static void draw_standby() {
+	static const char *state_labels[] = {"OFF", "ZRO", "RUN"};
+	char buf[12];
+
+	standby_state s = get_standby_state();
+	draw_readout(0, 124, state_labels[s], screen_shown[0], 0);
+
+	standby_reading r;
+	get_standby_reading(&r);
+	if(s == STANDBY_MEASURING && r.readings > 0) {
+		format_standby_current(r.current, buf);
+		draw_readout(2, 40, buf, screen_shown[1], 0);
+		format_standby_current(r.uncertainty, buf);
+		draw_readout(4, 40, buf, screen_shown[2], 0);
+	} else {
+		draw_readout(2, 40, "----uA", screen_shown[1], 0);
+		draw_readout(4, 40, "----uA", screen_shown[2], 0);
+	}
+	format(buf, "%04u", (r.readings > 9999)?9999:r.readings);
+	draw_readout(6, 112, buf, screen_shown[3], 0);
+	// ">1.00mA": the setpoint
+	buf[0] = '>';
+	format_number((s == STANDBY_IDLE)?standby_setpoint:get_standby_setpoint(), 'A', buf + 1);
+	buf[7] = '\0';
+	draw_readout(6, 0, buf, screen_shown[4], 0);
+}
+
+static void standby_enter(const void *arg) {
+	clear_screen();
+	memset(screen_shown, 0, sizeof(screen_shown));
+	Display_DrawText(0, 0, "Standby", 0);
+	Display_DrawText(2, 0, "I", 0);
+	Display_DrawText(4, 0, "+/-", 0);
+	gesture_start(0);
+	draw_standby();
+}
+
+static int standby_event(const ui_event *event, state_func *next) {
+	standby_state s = get_standby_state();
+	switch(event->type) {
+	case UI_EVENT_GESTURE:
+		switch(event->int_arg) {
+		case GESTURE_LONG_PRESS:
+			standby_stop();
+			return go(next, &(state_func)STATE_MAIN_MENU);
+		case GESTURE_CLICK:
+			if(s == STANDBY_IDLE) {
+				standby_start(standby_setpoint);
+			} else {
+				standby_stop();
+			}
+			break;
+		default:
+			break;
+		}
+		break;
+	case UI_EVENT_UPDOWN:
+		if(s == STANDBY_IDLE) {
+			standby_setpoint += accelerate(event) * STANDBY_STEP;
+			if(standby_setpoint < 0) {
+				standby_setpoint = 0;
+			} else if(standby_setpoint > STANDBY_MAX_SETPOINT) {
+				standby_setpoint = STANDBY_MAX_SETPOINT;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+	draw_standby();
+	return 0;
+}
+
+static const ui_screen standby_screen = {standby_enter, standby_event};
+#endif
+
+// Only a new page needs a full draw; moving within one redraws the two rows
+// whose highlight changed, and idle events draw nothing
+static void redraw_menu() {
+	const menudata *menu = screen_data.menu.menu;
+	int selected = screen_data.menu.selected, shown = screen_data.menu.shown;
+	int height = menu_height(menu);
+	if(shown < 0 || shown / height != selected / height) {
+		draw_menu(menu, selected);
+	} else if(shown != selected) {
+		draw_menu_item(menu, shown, 0);
+		draw_menu_item(menu, selected, 1);
+	}
+	screen_data.menu.shown = selected;
+}
+
+static void menu_enter(const void *arg) {
+	clear_screen();
+	screen_data.menu.menu = (const menudata *)arg;
+	screen_data.menu.selected = 0;
+	screen_data.menu.shown = -1;
+	redraw_menu();
+}
+
+static int menu_event(const ui_event *event, state_func *next) {
+	const menudata *menu = screen_data.menu.menu;
+	int *selected = &screen_data.menu.selected;
+	switch(event->type) {
+	case UI_EVENT_UPDOWN:
+		if(event->int_arg < 0) {
+			// Move up the menu
+			if(*selected + event->int_arg >= 0) {
+				*selected += event->int_arg;
+			} else {
+				*selected = 0;
+			}
+		} else {
+			// Move down the menu (but not past the end)
+			for(int i = 0; i < event->int_arg; i++) {
+				if(menu->items[*selected + 1].caption == NULL)
+					break;
+				(*selected)++;
+			}
+		}
+		redraw_menu();
+		break;
+	case UI_EVENT_BUTTONPRESS:
+		if(event->int_arg == 1) {
+			const menuitem *item = &menu->items[*selected];
+			return menu->choose ? menu->choose(item, next) : go(next, &item->new_state);
+		}
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+static const ui_screen menu_screen = {menu_enter, menu_event};
+
+#ifdef USE_SPLASHSCREEN
+static void splash_enter(const void *arg) {
+	screen_data.splash_until = xTaskGetTickCount() + configTICK_RATE_HZ * 3;
+}
+
+// The refresh events keep coming while the splashscreen shows
+static int splash_event(const ui_event *event, state_func *next) {
+	if((int32)(xTaskGetTickCount() - screen_data.splash_until) < 0)
+		return 0;
+	return go(next, &(state_func)STATE_LOAD(get_load_mode()));
+}
+
+static const ui_screen splash_screen = {splash_enter, splash_event};
+#endif
+
+// Labels the main readout with the digit cursor, or its own label without one
+static void show_digit_label(const loadconfig *config, int8 digit) {
+	status_label = (digit >= 0) ? load_digits[digit].label : NULL;
+	draw_label(status_label ? status_label : readout_formats[valid_readout(LOAD_DISPLAY(config)->readouts[0])].label);
+}
+
+// A click moves the digit cursor where there is one, and otherwise opens the
+// menu as a long press does. A double click switches the output off or back
+// on, restarting the hold readouts as it switches on, and turning with the button down picks a preset for the release to
+// recall. ui_dispatch follows mode changes made over the serial port.
+static void load_enter(const void *arg) {
+	const loadconfig *config = (const loadconfig *)arg;
+
+	clear_screen();
+	invalidate_status();
+	set_load_mode(config->mode);
+	mark_boot_milestone(BOOT_MILESTONE_UI);
+
+	screen_data.load.config = config;
+	screen_data.load.digit = -1;
+	screen_data.load.preset_slot = -1;
+	status_label = NULL;
+	gesture_start(1);
+}
+
+static int load_event(const ui_event *event, state_func *next) {
+	const loadconfig *config = screen_data.load.config;
+	int8 *digit = &screen_data.load.digit;
+	int *preset_slot = &screen_data.load.preset_slot;
+	switch(event->type) {
+	case UI_EVENT_GESTURE:
+		switch(event->int_arg) {
+		case GESTURE_CLICK:
+			if(config->adjust_digit == NULL)
+				return go(next, &(state_func)STATE_MAIN_MENU);
+			*digit = (*digit + 1 < (int)LOAD_DIGIT_COUNT) ? *digit + 1 : -1;
+			show_digit_label(config, *digit);
+			break;
+		case GESTURE_LONG_PRESS:
+			return go(next, &(state_func)STATE_MAIN_MENU);
+		case GESTURE_DOUBLE_CLICK:
+			if(get_output_mode() == OUTPUT_MODE_OFF) {
+				holds_reset();
+				output_on();
+			} else {
+				output_off();
+			}
+			break;
+		case GESTURE_PRESS_TURN:
+			if(*preset_slot >= 0)
+				preset_recall(*preset_slot);
+			*preset_slot = -1;
+			show_digit_label(config, *digit);
+			break;
+		default:
+			break;
+		}
+		break;
+	case UI_EVENT_UPDOWN:
+		if(button_held()) {
+			*preset_slot += event->int_arg;
+			if(*preset_slot < 0) {
+				*preset_slot = 0;
+			} else if(*preset_slot >= PRESET_COUNT) {
+				*preset_slot = PRESET_COUNT - 1;
+			}
+			format(screen_data.load.preset_label, "P%d", *preset_slot + 1);
+			status_label = screen_data.load.preset_label;
+			draw_label(status_label);
+		} else if(*digit >= 0) {
+			config->adjust_digit(load_digits[*digit].decade, event->int_arg);
+		} else {
+			config->adjust(accelerate(event));
+		}
+		break;
+	default:
+		break;
+	}
+	// A preset just recalled may be for another mode, which ui_dispatch
+	// follows; this mode's readouts would be the wrong ones
+	if(get_load_mode() != config->mode)
+		return 0;
+	uint8 drawn = draw_status(LOAD_DISPLAY(config));
+	if(event->type == UI_EVENT_ADC_READING)
+		profile_ui_refresh(drawn);
+	return 0;
+}
+
+static const ui_screen load_screen = {load_enter, load_event};
+
+// Calibration goes a step at a time, each waiting for a tap. A trip part way
+// through abandons it, since nothing is written to the settings until the end.
+enum {
+	CALIBRATE_OFFSETS,	// Run with nothing attached to the terminals
+	CALIBRATE_VOLTAGE,	// Run with a known voltage across the terminals
+	CALIBRATE_OPAMP,	// Run with a voltage source attached
+};
+
+// Calibrates the ADC voltage and current offsets
+static int calibrate_offsets(const ui_event *event) {
+	if(event->type != UI_EVENT_BUTTONPRESS || event->int_arg != 1)
+		return 0;
+
+	measurement m;
+	get_measurement(&m);
+	screen_data.calibrate.voltage_offset = m.raw_voltage;
+	screen_data.calibrate.current_offset = m.raw_current;
+	Display_DrawText(2, 0, "  2: Voltage ", 1);
+	return 1;
+}
+
+// Calibrate the ADC voltage gain
+static int calibrate_voltage(const ui_event *event) {
+	char buf[8];
+	int *gain = &screen_data.calibrate.voltage_gain;
+	format_number((get_raw_voltage() - screen_data.calibrate.voltage_offset) * *gain, 'V', buf);
+	strcat(buf, " ");
+	Display_DrawText(4, 43, buf, 0);
+
+	if(event->type == UI_EVENT_UPDOWN) {
+		*gain += (*gain * event->int_arg) / 500;
+	} else if(event->type == UI_EVENT_BUTTONPRESS && event->int_arg == 1) {
+		// Shown while the search runs, from the next event
+		Display_Clear(2, 0, 8, 160, 0);
+		Display_DrawText(4, 12, "Please wait", 0);
+		return 1;
+	}
+	return 0;
+}
+
+// Calibrates the opamp and current DAC offsets
+static void calibrate_opamp_dac_offsets() {
+	// Find the best setting for the opamp trim
+	int trim = opamp_trim_search(OPAMP_TRIM_CURRENT);
+	if(trim >= 0)
+		screen_data.calibrate.opamp_trim = trim;
+
 	// Find the best setting for the DAC offsets
 	/*for(int i = 0; i < 2; i++) {
 		set_current_range(i);
@@ -529,10 +2373,10 @@ static void calibrate_opamp_dac_offsets(settings_t *new_settings) {
 	}*/
 }
 
-static void calibrate_current(settings_t *new_settings) {
+static void calibrate_current() {
 	Display_Clear(4, 0, 8, 160, 0);
 	Display_DrawText(2, 0, "  3: Current ", 1);
-	Display_DrawText(6, 38, FONT_GLYPH_ENTER ": Next", 0);
+	draw_text(6, 38, FONT_GLYPH_ENTER ": Next", 0);
 	
 /*	set_current_range(1);
 	IDAC_SetValue(42 + new_settings->dac_offsets[1]);
@@ -569,49 +2413,122 @@ static void calibrate_current(settings_t *new_settings) {
 	IDAC_SetValue(new_settings->dac_offsets[0]);*/
 }
 
-state_func calibrate(const void *arg) {
+static void calibrate_enter(const void *arg) {
 	set_current(0);
-	
-	settings_t new_settings;
-	memcpy(&new_settings, settings, sizeof(settings_t));
-	
-	Display_ClearAll();
+
+	screen_data.calibrate.step = CALIBRATE_OFFSETS;
+	screen_data.calibrate.voltage_offset = settings->adc_voltage_offset;
+	screen_data.calibrate.current_offset = settings->adc_current_offset;
+	screen_data.calibrate.voltage_gain = settings->adc_voltage_gain;
+	screen_data.calibrate.opamp_trim = settings->opamp_offset_trim;
+
+	clear_screen();
 	Display_DrawText(0, 0, " CALIBRATION ", 1);
-	
-	calibrate_offsets(&new_settings);
-	calibrate_voltage(&new_settings);
-	calibrate_opamp_dac_offsets(&new_settings);
-	calibrate_current(&new_settings);
-	
-	EEPROM_Write((uint8*)&new_settings, (uint8*)settings, sizeof(settings_t));
-	
-	return (state_func){NULL, NULL, 0};
+	Display_DrawText(2, 0, "  1: Offset  ", 1);
+	draw_text(6, 38, FONT_GLYPH_ENTER ": Next", 0);
 }
 
-void vTaskUI( void *pvParameters ) {
-	ui_queue = xQueueCreate(2, sizeof(ui_event));
+static int calibrate_event(const ui_event *event, state_func *next) {
+	switch(screen_data.calibrate.step) {
+	case CALIBRATE_OFFSETS:
+		screen_data.calibrate.step += calibrate_offsets(event);
+		return 0;
+	case CALIBRATE_VOLTAGE:
+		screen_data.calibrate.step += calibrate_voltage(event);
+		return 0;
+	default:
+		break;
+	}
+
+	calibrate_opamp_dac_offsets();
+	calibrate_current();
 
+	settings_write(&screen_data.calibrate.voltage_offset, &settings->adc_voltage_offset, sizeof(int));
+	settings_write(&screen_data.calibrate.current_offset, &settings->adc_current_offset, sizeof(int));
+	settings_write(&screen_data.calibrate.voltage_gain, &settings->adc_voltage_gain, sizeof(int));
+	settings_write(&screen_data.calibrate.opamp_trim, &settings->opamp_offset_trim, sizeof(int));
+	settings_save();
+	calibration_update();
+	return go(next, &(state_func)STATE_MAIN);
+}
+
+static const ui_screen calibrate_screen = {calibrate_enter, calibrate_event};
+
+// The state now showing, and the main state a NULL screen goes back to
+static state_func ui_state, ui_main_state;
+
+static void ui_enter(const state_func *new_state) {
+	memcpy(&ui_state, (new_state->screen == NULL)?&ui_main_state:new_state, sizeof(state_func));
+	if(ui_state.is_main_state)
+		memcpy(&ui_main_state, &ui_state, sizeof(state_func));
+	ui_state.screen->enter(ui_state.arg);
+	Display_ShowFrame();
+}
+
+// Hands an event to the showing screen, with what every screen shares routed
+// here: a trip goes to the fault screen from anywhere, the fault and load
+// screens follow the output being turned back on and the load mode being
+// changed over the serial port, and any other screen gives way to the remote
+// lockout.
+static void ui_dispatch(const ui_event *event) {
+	state_func next;
+	int moved;
+	if(event->type == UI_EVENT_FAULT && ui_state.screen != &fault_screen) {
+		moved = go(&next, &(state_func)STATE_FAULT);
+	} else {
+		moved = ui_state.screen->event(event, &next);
+	}
+	if(!moved) {
+		if(ui_state.screen == &fault_screen && get_output_mode() == OUTPUT_MODE_FEEDBACK) {
+			moved = go(&next, &(state_func)STATE_MAIN);
+		} else if(ui_state.screen == &load_screen
+				&& get_load_mode() != ((const loadconfig *)ui_state.arg)->mode) {
+			moved = go(&next, &(state_func)STATE_LOAD(get_load_mode()));
+		} else if(remote_locked && ui_state.screen != &remote_screen && ui_state.screen != &fault_screen) {
+			moved = go(&next, &(state_func)STATE_REMOTE);
+		} else if(!remote_locked && ui_state.screen == &remote_screen) {
+			moved = go(&next, &(state_func)STATE_MAIN);
+		}
+	}
+	if(moved)
+		ui_enter(&next);
+}
+
+// Called by main() before the scheduler starts, like start_comms()
+void start_ui() {
+	ui_wake = xSemaphoreCreateBinary();
+}
+
+void vTaskUI( void *pvParameters ) {
+	quadrature_levels = Quadrature_Read();
 	QuadratureISR_StartEx(quadrature_event_isr);
+	QuadratureISR_SetPriority(IRQ_PRIORITY_UI);
 	QuadButtonISR_StartEx(button_press_isr);
+	QuadButtonISR_SetPriority(IRQ_PRIORITY_UI);
 
-	state_func main_state = STATE_CC_LOAD;
-	#ifdef USE_SPLASHSCREEN
-	state_func state = STATE_SPLASHSCREEN;
-	#else
-	state_func state = STATE_CC_LOAD;
-	#endif
+	// Normally C/C, unless main() resumed something else after a power fail
+	memcpy(&ui_main_state, &(state_func)STATE_LOAD(get_load_mode()), sizeof(state_func));
+	
+	if(settings->fast_boot) {
+		// main() left the display off; bring it up without holding up the other tasks
+		for(uint8 ms = Display_StartPowerUp(); ms > 0; ms = Display_ContinuePowerUp())
+			vTaskDelay(ms / portTICK_RATE_MS);
+		Display_SetContrast(settings->lcd_contrast);
+		selftest_check_display();
+		mark_boot_milestone(BOOT_MILESTONE_DISPLAY);
+		ui_enter(&(state_func)STATE_MAIN);
+	} else {
+		#ifdef USE_SPLASHSCREEN
+		ui_enter(&(state_func)STATE_SPLASHSCREEN);
+		#else
+		ui_enter(&(state_func)STATE_MAIN);
+		#endif
+	}
 	
 	while(1) {
-		state_func new_state = state.func(state.arg);
-		if(new_state.func == NULL) {
-			memcpy(&state, &main_state, sizeof(state_func));
-		} else {
-			memcpy(&state, &new_state, sizeof(state_func));
-		}
-		
-		if(state.is_main_state) {
-			memcpy(&main_state, &state, sizeof(state_func));
-		}
+		ui_event event;
+		next_event(&event);
+		ui_dispatch(&event);
 	}
 }
 
@@ -0,0 +1,58 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#ifndef UNITS_H
+#define UNITS_H
+
+#include <cytypes.h>
+
+// Physical quantities are 32 bit integers in one fixed unit each: microamps,
+// microvolts and microwatts for readings, milliohms and milliwatts for the CR
+// and CP targets. The typedefs name them in signatures; the helpers do the
+// products between them with 64 bit intermediates and no divide, which the
+// CM0 only has as a library call, and saturate rather than wrap.
+typedef int32 microamps;
+typedef int32 microvolts;
+typedef int32 microwatts;
+typedef int32 milliwatts;
+typedef int32 milliohms;
+
+// Constants in whole or milli units, folded by the compiler
+#define AMPS(a) ((a) * 1000000)
+#define MILLIAMPS(ma) ((ma) * 1000)
+#define VOLTS(v) ((v) * 1000000)
+#define MILLIVOLTS(mv) ((mv) * 1000)
+#define OHMS(r) ((r) * 1000)
+
+static inline int32 saturate32(int64 x) {
+	return (x > INT32_MAX)?INT32_MAX:(x < INT32_MIN)?INT32_MIN:(int32)x;
+}
+
+static inline int32 mul_saturate(int32 a, int32 b) {
+	return saturate32((int64)a * b);
+}
+
+// current * voltage / 10^6. 2251799814 is 2^51 / 10^6 rounded up, so taking
+// the product's halves times that down 51 bits is within 1uW of the quotient
+// for products to 2^51; 6A at 60V is under 2^49.
+static inline microwatts power_from(microamps current, microvolts voltage) {
+	if(current <= 0 || voltage <= 0)
+		return 0;
+	uint64 product = (uint64)(uint32)current * (uint32)voltage;
+	uint64 high = (uint64)(uint32)(product >> 32) * 2251799814u;
+	uint64 low = ((uint64)(uint32)product * 2251799814u) >> 32;
+	return saturate32((high + low) >> 19);
+}
+
+#endif
+
+/* [] END OF FILE */
@@ -11,17 +11,20 @@
 */
 
 #include <FreeRTOS.h>
+#include <task.h>
 #include <stdio.h>
+#include <string.h>
 #include "config.h"
 
-#ifdef USE_SPLASHSCREEN
-#include "splashscreen.h"
-#include "lzfx.h"
-#endif
+#include "assets.h"
 
 void setup() {
 	state.current_setpoint = -1;
 	state.current_range = -1;
+	state.load_mode = LOAD_MODE_CC;
+	state.voltage_setpoint = 0;
+	state.resistance_setpoint = 0;
+	state.power_setpoint = 0;
 
 	set_current(0);
 	
@@ -32,50 +35,327 @@ void set_current(int setpoint) {
 	if(setpoint < 0)
 		setpoint = 0;
 	state.current_setpoint = setpoint;
+	if(setpoint > get_current_limit())
+		setpoint = get_current_limit();
+	slew_to(setpoint);
+}
 
-	int high_value = setpoint / settings->dac_high_gain;
-	int low_value = (setpoint % settings->dac_high_gain) / settings->dac_low_gain;
+int get_current_setpoint() {
+	return state.current_setpoint;
+}
 
-	high_value += settings->dac_high_offset;
-	if(high_value > 255)
-		high_value = 255;
-	
-	low_value += settings->dac_low_offset;
-	if(low_value > 255)
-		low_value = 255;
+#if IDAC_High_cy_psoc4_idac__CSD_IDAC != IDAC_Low_cy_psoc4_idac__CSD_IDAC
+#error write_dac() expects both IDACs in the one CSD_IDAC register
+#endif
 
-	IDAC_High_SetValue(high_value);
-	IDAC_Low_SetValue(low_value);
+// Both IDACs' codes are fields of the one CSD_IDAC register, so they change
+// in a single store. Writing them one after the other, as the component API
+// does, left the output at the new high code with the old low code (or the
+// other way round) for a microsecond or two between the writes: across a
+// high code boundary, that's off by as much as the low code's change, past
+// either end. No order of the two writes avoids it. What remains is the
+// IDACs' own settling, which starts for both on the same clock; where their
+// mirrors settle at different rates a boundary crossing can still show a
+// dip or overshoot, but only for that difference, far shorter than the
+// opamp loop's response.
+RAMFUNC void write_dac(uint8 high, uint8 low) {
+	static const uint32 mask = ((uint32)IDAC_High_IDAC_VALUE_MASK << IDAC_High_IDAC_VALUE_POSITION)
+		| ((uint32)IDAC_Low_IDAC_VALUE_MASK << IDAC_Low_IDAC_VALUE_POSITION);
+	uint8 int_state = CyEnterCriticalSection();
+	IDAC_High_IDAC_CONTROL_REG = (IDAC_High_IDAC_CONTROL_REG & ~mask)
+		| ((uint32)high << IDAC_High_IDAC_VALUE_POSITION) | ((uint32)low << IDAC_Low_IDAC_VALUE_POSITION);
+	CyExitCriticalSection(int_state);
+	TRACE_EVENT(TRACE_DAC, (high << 8) | low);
 }
 
-int get_current_setpoint() {
-	return state.current_setpoint;
+// Current set is a slow channel, on the injection channel. This converts it
+// at the end of the next scan rather than waiting its turn, and works before
+// the scheduler starts as well as after.
+int16 read_current_set() {
+	return adc_read_slow(ADC_SLOW_CURRENT_SET);
+}
+
+// Mean current sense minus current set, in counts, over OPAMP_TRIM_SAMPLES
+// scans after one to settle. Each reading is already the SAR's hardware
+// average.
+static int opamp_offset(int *sense, int *set) {
+	int sense_sum = 0, set_sum = 0;
+	read_current_set();
+	for(int i = 0; i < OPAMP_TRIM_SAMPLES; i++) {
+		set_sum += read_current_set();
+		sense_sum += ADC_GetResult16(ADC_CHAN_CURRENT_SENSE);
+	}
+	*sense = sense_sum / OPAMP_TRIM_SAMPLES;
+	*set = set_sum / OPAMP_TRIM_SAMPLES;
+	return *sense - *set;
+}
+
+// Finds the opamp offset trim by successive approximation: the highest code
+// at which current sense still reads above current set, as the old linear
+// scan did, in five steps rather than up to 32. Needs a source attached to
+// draw setpoint from. Leaves the trim set and returns it, or returns -1 and
+// puts the saved trim back if the current didn't flow. The setpoint goes back
+// to zero either way. Any slew limit is lifted for the search, so each step
+// has settled by the scan that's read. The offset moves a little with the
+// opamp's power level; on auto, the search runs at the static load's.
+int opamp_trim_search(int setpoint) {
+	int trim = 0, sense, set;
+	int slew_rate = get_slew_rate();
+	set_slew_rate(0);
+	set_current(setpoint);
+	for(int bit = OPAMP_TRIM_CODES >> 1; bit > 0; bit >>= 1) {
+		CY_SET_REG32(Opamp_cy_psoc4_abuf__OA_OFFSET_TRIM, trim | bit);
+		if(opamp_offset(&sense, &set) > 0)
+			trim |= bit;
+	}
+	CY_SET_REG32(Opamp_cy_psoc4_abuf__OA_OFFSET_TRIM, trim);
+	opamp_offset(&sense, &set);
+	set_current(0);
+	set_slew_rate(slew_rate);
+
+	if(sense < set / 2) {
+		// The loop never closed, so the readings say nothing about the offset
+		CY_SET_REG32(Opamp_cy_psoc4_abuf__OA_OFFSET_TRIM, settings->opamp_offset_trim);
+		return -1;
+	}
+	return trim;
+}
+
+static volatile uint32 timestamp_overflows = 0;
+static alarm_func alarm_callback = NULL;
+static uint32 alarm_time;
+
+CY_ISR(timestamp_isr) {
+	uint32 entry_ticks = CySysTickGetValue();
+	// The ADC ISR can preempt this one, and get_time_us() must never see the
+	// wrap cleared without the count bumped
+	uint8 int_state = CyEnterCriticalSection();
+	uint32 source = timer_get_interrupt(TIMER_COUNTER_TIMESTAMP);
+	timer_clear_interrupt(TIMER_COUNTER_TIMESTAMP, source);
+	if(source & TIMER_INTR_TC)
+		timestamp_overflows++;
+	CyExitCriticalSection(int_state);
+
+	// The compare matches once per wrap; only the one in the right wrap counts
+	if((source & TIMER_INTR_CC_MATCH) && alarm_callback != NULL && (int32)(get_time_us() - alarm_time) >= 0) {
+		alarm_func callback = alarm_callback;
+		alarm_callback = NULL;
+		callback(alarm_time);
+	}
+	profile_isr(PROFILE_ISR_TIMESTAMP, entry_ticks);
+}
+
+// TIMER_COUNTER_TIMESTAMP is a free-running 16 bit counter clocked at 1MHz;
+// its terminal count interrupt extends it to a 32 bit microsecond clock.
+void start_timestamp() {
+	timer_start(TIMER_COUNTER_TIMESTAMP, 0xFFFF, TIMER_INTR_TC | TIMER_INTR_CC_MATCH, timestamp_isr, IRQ_PRIORITY_CONTROL);
+}
+
+// Calls callback from the timestamp ISR once get_time_us() reaches when, which
+// must be at least a few microseconds away. There is a single alarm; setting a
+// new one replaces it. The callback gets the time it was scheduled for, so
+// periodic users can schedule from that rather than accumulate latency.
+void set_alarm(uint32 when, alarm_func callback) {
+	uint8 int_state = CyEnterCriticalSection();
+	alarm_time = when;
+	alarm_callback = callback;
+	timer_write_compare(TIMER_COUNTER_TIMESTAMP, when & 0xFFFF);
+	CyExitCriticalSection(int_state);
+}
+
+void cancel_alarm() {
+	alarm_callback = NULL;
+}
+
+// Microseconds since boot. Safe to call from tasks and ISRs; wraps every 71 minutes.
+uint32 get_time_us() {
+	uint8 int_state = CyEnterCriticalSection();
+	uint32 low = timer_read_counter(TIMER_COUNTER_TIMESTAMP);
+	uint32 high = timestamp_overflows;
+	// Catch a wrap that happened after we disabled interrupts but before the read
+	if((timer_get_interrupt(TIMER_COUNTER_TIMESTAMP) & TIMER_INTR_TC) && low < 0x8000)
+		high++;
+	CyExitCriticalSection(int_state);
+	return (high << 16) | low;
+}
+
+// The Backlight pin, switched by TIMER_COUNTER_BACKLIGHT: on from each wrap
+// until the compare. The ISR sets it from the counter rather than from which
+// interrupt it was, so one held off past the next edge still comes out right.
+// Full brightness and off need no interrupts, and stop the counter.
+static volatile uint16 backlight_compare;
+static uint8 backlight_pwm = 0;
+
+CY_ISR(backlight_isr) {
+	timer_clear_interrupt(TIMER_COUNTER_BACKLIGHT, TIMER_INTR_TC | TIMER_INTR_CC_MATCH);
+	Backlight_Write(timer_read_counter(TIMER_COUNTER_BACKLIGHT) < backlight_compare);
+}
+
+// 0 to BACKLIGHT_MAX_BRIGHTNESS. Safe from tasks and ISRs.
+void set_backlight(uint8 brightness) {
+	uint8 int_state = CyEnterCriticalSection();
+	if(brightness == 0 || brightness >= BACKLIGHT_MAX_BRIGHTNESS) {
+		timer_stop(TIMER_COUNTER_BACKLIGHT);
+		backlight_pwm = 0;
+		Backlight_Write(brightness != 0);
+	} else {
+		backlight_compare = (uint32)brightness * BACKLIGHT_PWM_PERIOD_US / BACKLIGHT_MAX_BRIGHTNESS;
+		timer_write_compare(TIMER_COUNTER_BACKLIGHT, backlight_compare);
+		if(!backlight_pwm)
+			timer_start(TIMER_COUNTER_BACKLIGHT, BACKLIGHT_PWM_PERIOD_US - 1, TIMER_INTR_TC | TIMER_INTR_CC_MATCH,
+				backlight_isr, IRQ_PRIORITY_UI);
+		backlight_pwm = 1;
+	}
+	CyExitCriticalSection(int_state);
+}
+
+// Measures the cycles between ISR entry (start, from CySysTickGetValue) and now
+// using the SysTick down-counter. Only valid for spans shorter than one SysTick
+// period, which tickless idle stretches while the CPU sleeps.
+uint32 cycles_since(uint32 start) {
+	uint32 now = CySysTickGetValue();
+	return (start >= now)?(start - now):(start + CySysTickGetReload() + 1 - now);
+}
+
+// Average CPU cycles per call of func over iterations back to back, on the
+// microsecond timestamp. Other tasks are held off, but ISRs still run and
+// their share is included, as it would be in use.
+uint32 bench_cycles(bench_func func, int iterations) {
+	vTaskSuspendAll();
+	uint32 start = get_time_us();
+	for(int i = 0; i < iterations; i++)
+		func();
+	uint32 elapsed = get_time_us() - start;
+	xTaskResumeAll();
+	return elapsed * (get_cpu_clock() / 1000000) / iterations;
+}
+
+static uint32 boot_milestones[BOOT_MILESTONE_COUNT];
+
+// Records the time of a startup milestone. Only the first call for each counts.
+void mark_boot_milestone(boot_milestone milestone) {
+	if(boot_milestones[milestone] == 0)
+		boot_milestones[milestone] = get_time_us();
+}
+
+// Microseconds from start_timestamp() to a milestone, or 0 if not reached
+uint32 get_boot_milestone(boot_milestone milestone) {
+	return boot_milestones[milestone];
+}
+
+// Once the scheduler is running the main stack is used only by ISRs. It is painted
+// at boot so that 'debug' can report how much of it has never been touched.
+#define STACK_PAINT 0xA5A5A5A5
+extern uint32 __cy_stack_limit[];
+
+// Must be called first thing in main(), before interrupts are enabled
+void paint_main_stack() {
+	uint32 marker;
+	// Stop short of this frame, which the loop itself is using
+	for(uint32 *p = __cy_stack_limit; p < &marker - 16; p++)
+		*p = STACK_PAINT;
+}
+
+// Words at the bottom of the main stack that no ISR has reached yet, to
+// compare with the task stack high water marks
+int get_main_stack_free() {
+	const uint32 *p = __cy_stack_limit;
+	while(*p == STACK_PAINT)
+		p++;
+	return p - __cy_stack_limit;
+}
+
+// CRC-16/CCITT, polynomial 0x1021. Start with crc = 0xFFFF.
+uint16 crc16_update(uint16 crc, const uint8 *data, int len) {
+	for(int i = 0; i < len; i++) {
+		crc ^= data[i] << 8;
+		for(int bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000)?((crc << 1) ^ 0x1021):(crc << 1);
+	}
+	return crc;
+}
+
+// Compressed asset store. Each asset is a run of segments in asset_data,
+// compressed separately so any one can be decoded on its own, a chunk at a
+// time, with nothing bigger than the decoder's window in RAM.
+int asset_segments(asset_id id) {
+	return (id < ASSET_COUNT)?asset_table[id].segments:0;
+}
+
+// Decodes one segment to sink. Returns its length, or a negative LZFX error.
+int asset_decode(asset_id id, int segment, lzfx_sink sink, void *arg) {
+	if(segment < 0 || segment >= asset_segments(id))
+		return LZFX_EARGS;
+	int i = asset_table[id].first + segment;
+	return lzfx_decompress_stream(asset_data + asset_offsets[i], asset_offsets[i + 1] - asset_offsets[i], sink, arg);
 }
 
 // Loads the splashscreen image
 // ONLY RUN BEFORE STARTING THE RTOS KERNEL!
 // (And after initializing the display)
 #ifdef USE_SPLASHSCREEN
+static void write_splashscreen_chunk(const void *data, unsigned int len, void *arg) {
+	Display_WritePixels((uint8 *)data, len);
+}
+
 void load_splashscreen() {
-	uint8 *page = pvPortMalloc(160 * 4);
+	// Each page is decoded a small chunk at a time straight to the display,
+	// so no page sized buffer is needed
 	Display_SetCursorPosition(0, 0);
-	for(int i = 0; i < 8; i++) {
-		lzfx_decompress(
-			splashscreen_data + splashscreen_indexes[i],
-			splashscreen_indexes[i + 1] - splashscreen_indexes[i],
-			page, &(unsigned int){160 * 4});
-		Display_WritePixels(page, 160 * 4);
+	for(int i = 0; i < ASSET_SPLASHSCREEN_SEGMENTS; i++) {
+		asset_decode(ASSET_SPLASHSCREEN, i, write_splashscreen_chunk, NULL);
 		CyDelay(1);
 	}
+}
+
+static void discard_splashscreen_chunk(const void *data, unsigned int len, void *arg) {
+}
 
-	// Reset the heap to free the memory we used
-	vPortInitialiseBlocks();
+// Decodes the whole image without drawing it, to time the decoder for 'bench'
+void decode_splashscreen() {
+	for(int i = 0; i < ASSET_SPLASHSCREEN_SEGMENTS; i++)
+		asset_decode(ASSET_SPLASHSCREEN, i, discard_splashscreen_chunk, NULL);
 }
 #endif
 
+uint8 draw_buffer[DRAW_BUFFER_SIZE];
+
+// Decodes a label's row into draw_buffer
+static uint8 label_row_len;
+
+static void label_chunk(const void *data, unsigned int len, void *arg) {
+	memcpy(draw_buffer + label_row_len, data, len);
+	label_row_len += len;
+}
+
+// Draws text as Display_DrawText does, but from its pre-rendered label in the
+// asset store if assetpacker.py made one, sending each row in one run instead
+// of a glyph at a time.
+void draw_text(uint8 page, uint8 col, const char *text, uint8 inverse) {
+	for(int i = 0; i < ASSET_LABEL_COUNT; i++) {
+		if(strcmp(asset_labels[i].text, text) != 0)
+			continue;
+		for(int row = 0; row < asset_segments(asset_labels[i].id); row++) {
+			label_row_len = 0;
+			asset_decode(asset_labels[i].id, row, label_chunk, NULL);
+			Display_SetCursorPosition(page + row, col);
+			Display_DrawColumns(draw_buffer, label_row_len, inverse);
+		}
+		return;
+	}
+	Display_DrawText(page, col, text, inverse);
+}
+
 static output_mode current_output_mode = OUTPUT_MODE_FEEDBACK;
+static opamp_power opamp_power_setting = OPAMP_POWER_AUTO;
+static uint8 opamp_fast = 0; // The transient generator is running
+// The component's power for each opamp_power; auto is resolved before use
+static const uint32 opamp_levels[] = {Opamp_HIGHPOWER, Opamp_LOWPOWER, Opamp_MEDPOWER, Opamp_HIGHPOWER};
 
 void set_output_mode(output_mode mode) {
+	// A unit that failed its self test stays off
+	if(!selftest_passed())
+		mode = OUTPUT_MODE_OFF;
 	current_output_mode = mode;
 	switch(mode) {
 	case OUTPUT_MODE_OFF:
@@ -94,10 +374,49 @@ void set_output_mode(output_mode mode) {
 		// Start the opamp and set the pin to hi-z
 		Opamp_Out_SetDriveMode(Opamp_Out_DM_ALG_HIZ);
 		Opamp_Start();
+		// Opamp_Start() leaves the power the component was configured with
+		Opamp_SetPower(opamp_levels[get_opamp_power_level()]);
 		break;
 	}
 }
 
+
+// The level the opamp runs at, with auto resolved
+opamp_power get_opamp_power_level() {
+	if(opamp_power_setting != OPAMP_POWER_AUTO)
+		return opamp_power_setting;
+	return opamp_fast?OPAMP_POWER_HIGH:OPAMP_POWER_LOW;
+}
+
+// A stopped opamp is left stopped, and picks the level up when it starts
+static void opamp_power_update() {
+	if(current_output_mode == OUTPUT_MODE_FEEDBACK)
+		Opamp_SetPower(opamp_levels[get_opamp_power_level()]);
+}
+
+void set_opamp_power(opamp_power power) {
+	opamp_power_setting = power;
+	opamp_power_update();
+}
+
+opamp_power get_opamp_power() {
+	return opamp_power_setting;
+}
+
+// Called by the transient generator as it starts and stops
+void set_opamp_fast(int fast) {
+	opamp_fast = fast;
+	opamp_power_update();
+}
+
+// Fast path for protection: drive the gate low with two pin writes, callable from
+// an ISR. The caller must follow up with set_output_mode(OUTPUT_MODE_OFF) outside
+// interrupt context to stop the opamp and record the new mode.
+RAMFUNC void trip_output() {
+	Opamp_Out_Write(0);
+	Opamp_Out_SetDriveMode(Opamp_Out_DM_STRONG);
+}
+
 output_mode get_output_mode() {
 	return current_output_mode;
 }
@@ -0,0 +1,168 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include "tasks.h"
+#include "config.h"
+
+// Limit watches: a level on the voltage, current, power, temperature or the
+// time since the watch was set, checked by the ADC task against every block's
+// mean, so a host can leave a run alone and hear only when something goes out
+// of bounds rather than polling for it. The level has to be crossed for
+// debounce blocks in a row before the watch fires, so one noisy block can't,
+// and it then fires once, until the reading comes back hysteresis the other
+// side of the level. Firing always posts NOTIFY_WATCH; the action can also
+// turn the output off, jump the sequencer or pulse the trigger output, none
+// of which have to wait on the host. Watches are held in RAM only. Only in
+// builds with USE_WATCH defined.
+
+#ifdef USE_WATCH
+
+static watch_config watches[WATCH_COUNT];
+static uint8 blocks_past[WATCH_COUNT];
+static uint8 fired[WATCH_COUNT];
+static uint16 counts[WATCH_COUNT];
+static portTickType set_at[WATCH_COUNT];
+
+// Called by the comms task, with interrupts off so the ADC task never sees a
+// slot half written
+int watch_set(int slot, const watch_config *config) {
+	if(slot < 0 || slot >= WATCH_COUNT)
+		return 0;
+	if(config->quantity == WATCH_NONE || config->quantity >= WATCH_QUANTITY_MAX || config->action >= WATCH_ACTION_MAX)
+		return 0;
+	if(config->hysteresis < 0 || config->debounce == 0 || config->debounce > WATCH_MAX_DEBOUNCE)
+		return 0;
+	if(config->action == WATCH_STEP && config->step >= SEQUENCE_MAX_STEPS)
+		return 0;
+
+	uint8 int_state = CyEnterCriticalSection();
+	watches[slot] = *config;
+	blocks_past[slot] = 0;
+	fired[slot] = 0;
+	counts[slot] = 0;
+	set_at[slot] = xTaskGetTickCount();
+	CyExitCriticalSection(int_state);
+	return 1;
+}
+
+void watch_clear(int slot) {
+	if(slot >= 0 && slot < WATCH_COUNT)
+		watches[slot].quantity = WATCH_NONE;
+}
+
+const watch_config *get_watch(int slot) {
+	return &watches[slot];
+}
+
+// Whether the watch has fired and not yet re-armed
+int get_watch_fired(int slot) {
+	return fired[slot];
+}
+
+// Times the watch has fired since it was set
+uint16 get_watch_count(int slot) {
+	return counts[slot];
+}
+
+static int32 watch_value(int slot, const int16 *mean) {
+	switch(watches[slot].quantity) {
+	case WATCH_VOLTAGE:
+		return voltage_from_raw(mean[FILTER_VOLTAGE]);
+	case WATCH_CURRENT:
+		return current_from_raw(mean[FILTER_CURRENT]);
+	case WATCH_POWER:
+		return div1000(power_from(current_from_raw(mean[FILTER_CURRENT]), voltage_from_raw(mean[FILTER_VOLTAGE])));
+	case WATCH_TEMPERATURE:
+		return get_temperature();
+	default:
+		return (xTaskGetTickCount() - set_at[slot]) * portTICK_RATE_MS;
+	}
+}
+
+static void fire(int slot) {
+	const watch_config *w = &watches[slot];
+	fired[slot] = 1;
+	counts[slot]++;
+	notify_post(NOTIFY_WATCH, slot);
+	switch(w->action) {
+	case WATCH_OFF:
+		// Before the sequencer's next step can turn it back on
+		sequence_stop();
+		set_output_mode(OUTPUT_MODE_OFF);
+		break;
+	case WATCH_STEP:
+		sequence_jump(w->step);
+		break;
+	case WATCH_TRIGGER:
+		trigger_output_pulse();
+		break;
+	default:
+		break;
+	}
+}
+
+// Called by the ADC task with each block's means
+void watch_block(const int16 *mean) {
+	for(int slot = 0; slot < WATCH_COUNT; slot++) {
+		const watch_config *w = &watches[slot];
+		if(w->quantity == WATCH_NONE)
+			continue;
+
+		int32 value = watch_value(slot, mean);
+		if(fired[slot]) {
+			// Compared as 64 bits, so a level near the limits of its range can't wrap
+			if(w->below?((int64)value >= (int64)w->level + w->hysteresis):((int64)value <= (int64)w->level - w->hysteresis))
+				fired[slot] = 0;
+			continue;
+		}
+		if(w->below?(value >= w->level):(value <= w->level)) {
+			blocks_past[slot] = 0;
+			continue;
+		}
+		if(++blocks_past[slot] >= w->debounce) {
+			blocks_past[slot] = 0;
+			fire(slot);
+		}
+	}
+}
+
+#else
+
+int watch_set(int slot, const watch_config *config) {
+	return 0;
+}
+
+void watch_clear(int slot) {
+}
+
+const watch_config *get_watch(int slot) {
+	static const watch_config none = {.quantity = WATCH_NONE};
+	return &none;
+}
+
+int get_watch_fired(int slot) {
+	return 0;
+}
+
+uint16 get_watch_count(int slot) {
+	return 0;
+}
+
+void watch_block(const int16 *mean) {
+}
+
+#endif
+
+/* [] END OF FILE */
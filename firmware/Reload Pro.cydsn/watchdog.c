@@ -0,0 +1,137 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include "project.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include "tasks.h"
+#include "config.h"
+
+// Supervision. Each task calls watchdog_heartbeat() every time it wakes, and
+// all of them wake well inside WATCHDOG_TIMEOUT_MS. The tick hook checks the
+// heartbeats and feeds the hardware watchdog, which catches what the tick
+// can't: an ISR stuck in a loop, or interrupts left disabled. Whatever goes
+// wrong, the gate is pulled low before anything else, then the reason is
+// left in RAM that startup doesn't clear and the part resets. The next boot
+// picks it up for 'debug'.
+
+#define CRASH_MAGIC 0x43524153
+
+// .noinit survives a reset; the magic tells a record from power-up noise
+static CY_NOINIT crash_record crash;
+static crash_record last_crash;
+
+static volatile portTickType heartbeats[WATCHDOG_TASK_COUNT];
+static uint8 watchdog_running = 0;
+
+static void copy_task_name(const signed char *name) {
+	uint8 i;
+	for(i = 0; name != NULL && name[i] != '\0' && i < sizeof(crash.task) - 1; i++)
+		crash.task[i] = name[i];
+	crash.task[i] = '\0';
+}
+
+// Ends in a reset; safe from any context, with the scheduler or without
+void watchdog_crash(crash_type type, const signed char *task, uint32 pc, uint32 lr) {
+	taskDISABLE_INTERRUPTS();
+	trip_output();
+
+	crash.type = type;
+	crash.pc = pc;
+	crash.lr = lr;
+	copy_task_name(task);
+	crash.magic = CRASH_MAGIC;
+	CySoftwareReset();
+}
+
+// frame is the stack the fault pushed R0-R3, R12, LR, PC and xPSR onto
+__attribute__((used)) static void hard_fault_report(const uint32 *frame, uint32 exc_return) {
+	// Bit 2 of EXC_RETURN says which stack: the process stack is a task's
+	const signed char *task = (exc_return & 4)?pcTaskGetTaskName(NULL):(const signed char *)"isr";
+	watchdog_crash(CRASH_HARD_FAULT, task, frame[6], frame[5]);
+}
+
+__attribute__((naked)) static void hard_fault_isr() {
+	__asm volatile(
+		"movs r0, #4\n"
+		"mov r1, lr\n"
+		"tst r0, r1\n"
+		"mrs r0, msp\n"
+		"beq 1f\n"
+		"mrs r0, psp\n"
+		"1:\n"
+		"ldr r2, =hard_fault_report\n"
+		"bx r2\n"
+	);
+}
+
+// Must be called first thing in main(), before anything that could fault
+void watchdog_init() {
+	extern cyisraddress CyRamVectors[];
+	CyRamVectors[3] = (cyisraddress)hard_fault_isr;
+
+	uint32 cause = CY_GET_REG32(CYREG_RES_CAUSE);
+	if(crash.magic == CRASH_MAGIC) {
+		last_crash = crash;
+	} else if(cause & WATCHDOG_RES_CAUSE_WDT) {
+		// Nothing got the chance to say why
+		last_crash.type = CRASH_WATCHDOG;
+	} else if(cause & WATCHDOG_RES_CAUSE_LOCKUP) {
+		// A fault in the fault handler, usually on a trashed stack
+		last_crash.type = CRASH_LOCKUP;
+	}
+	crash.magic = 0;
+	CY_SET_REG32(CYREG_RES_CAUSE, cause);
+}
+
+// Starts the hardware watchdog, just before the scheduler and its tick
+void watchdog_start() {
+	CySysWdtUnlock();
+	CySysWdtWriteMode(CY_SYS_WDT_COUNTER0, CY_SYS_WDT_MODE_RESET);
+	CySysWdtWriteMatch(CY_SYS_WDT_COUNTER0, WATCHDOG_HARDWARE_MATCH);
+	CySysWdtEnable(CY_SYS_WDT_COUNTER0_MASK);
+	CySysWdtLock();
+	watchdog_running = 1;
+}
+
+// For the bootloader, which doesn't know to feed it
+void watchdog_stop() {
+	CySysWdtUnlock();
+	CySysWdtDisable(CY_SYS_WDT_COUNTER0_MASK);
+	CySysWdtLock();
+	watchdog_running = 0;
+}
+
+void watchdog_heartbeat(watchdog_task task) {
+	heartbeats[task] = xTaskGetTickCount();
+}
+
+// From the tick hook, so in the tick ISR
+void watchdog_tick() {
+	if(!watchdog_running)
+		return;
+
+	static const char *names[] = {"UI", "UART", "ADC"};
+	portTickType now = xTaskGetTickCountFromISR();
+	for(uint8 i = 0; i < WATCHDOG_TASK_COUNT; i++) {
+		if(now - heartbeats[i] > WATCHDOG_TIMEOUT_MS / portTICK_RATE_MS)
+			watchdog_crash(CRASH_HEARTBEAT, (const signed char *)names[i], 0, 0);
+	}
+	CySysWdtResetCounters(CY_SYS_WDT_COUNTER0_RESET);
+}
+
+// What stopped the last run, type CRASH_NONE after a clean reset
+const crash_record *get_last_crash() {
+	return &last_crash;
+}
+
+/* [] END OF FILE */
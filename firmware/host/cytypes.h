@@ -0,0 +1,35 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+// Stands in for the PSoC library's fixed width types
+
+#ifndef HOST_CYTYPES_H
+#define HOST_CYTYPES_H
+
+#include <stdint.h>
+
+typedef uint8_t uint8;
+typedef int8_t int8;
+typedef uint16_t uint16;
+typedef int16_t int16;
+typedef uint32_t uint32;
+typedef int32_t int32;
+typedef uint64_t uint64;
+typedef int64_t int64;
+typedef volatile uint32 reg32;
+typedef void (*cyisraddress)(void);
+
+#define CY_SECTION(name) __attribute__((section(name)))
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,37 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+// Stands in for the header PSoC Creator generates, so the modules that don't
+// touch the hardware build on a PC. Only what their headers and code use is
+// here: the fixed width types, the critical section calls, and the few
+// component constants config.h sizes things by.
+
+#ifndef HOST_PROJECT_H
+#define HOST_PROJECT_H
+
+#include <string.h>
+#include "cytypes.h"
+
+// The tests run on one thread with no interrupts
+static inline uint8 CyEnterCriticalSection() {
+	return 0;
+}
+
+static inline void CyExitCriticalSection(uint8 state) {
+	(void)state;
+}
+
+#define Display_COLUMNS 160
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,134 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <string.h>
+#include "project.h"
+#include "config.h"
+#include "commands.h"
+#include "check.h"
+
+// The serial command table gperf builds from tools/serial_keywords, and
+// arguments.c's parsing to each command's spec. The Makefile generates a stub
+// for every handler, and the list of keywords, from the same file.
+
+// The name of the handler last called
+static const char *handled = NULL;
+
+#include "handlers.h"
+
+static const struct {
+	const char *name;
+	command_func handler;
+	const char *handler_name;
+} keywords[] = {
+#define KEYWORD(name, handler) {name, handler, #handler},
+#include "keywords.h"
+#undef KEYWORD
+};
+
+uint32 div1000(uint32 n) {
+	return n / 1000;
+}
+
+static void test_lookup() {
+	CHECK(sizeof(keywords) / sizeof(keywords[0]) == TOTAL_KEYWORDS);
+	for(unsigned int i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+		const command_def *cmd = in_word_set(keywords[i].name, strlen(keywords[i].name));
+		CHECK(cmd != NULL);
+		if(cmd == NULL) {
+			printf("%s isn't found\n", keywords[i].name);
+			continue;
+		}
+		CHECK(strcmp(cmd->name, keywords[i].name) == 0);
+		CHECK(cmd->handler == keywords[i].handler);
+		cmd->handler("", NULL);
+		CHECK(handled != NULL && strcmp(handled, keywords[i].handler_name) == 0);
+	}
+
+	const char *unknown[] = {"", "m", "mod", "modes", "MODE", "Set", "x", "setpoint", "sequencer"};
+	for(unsigned int i = 0; i < sizeof(unknown) / sizeof(unknown[0]); i++)
+		CHECK(in_word_set(unknown[i], strlen(unknown[i])) == NULL);
+}
+
+static int parses(const char *spec, const char *line, int count, int32 a, int32 b, int32 c) {
+	const command_def cmd = {"test", NULL, spec};
+	char args[64], error[COMMAND_ERROR_LENGTH] = "";
+	command_args parsed;
+	strcpy(args, line);
+	if(!parse_command_args(&cmd, args, &parsed, error)) {
+		printf("\"%s\" to \"%s\": %s", line, spec, error);
+		return 0;
+	}
+	const int32 expected[COMMAND_MAX_ARGS] = {a, b, c};
+	return parsed.count == count && memcmp(parsed.values, expected, count * sizeof(int32)) == 0;
+}
+
+static int fails(const char *spec, const char *line, const char *expected) {
+	const command_def cmd = {"test", NULL, spec};
+	char args[64], error[COMMAND_ERROR_LENGTH] = "";
+	command_args parsed;
+	strcpy(args, line);
+	return !parse_command_args(&cmd, args, &parsed, error) && strcmp(error, expected) == 0;
+}
+
+static void test_arguments() {
+	CHECK(parses("", "", 0, 0, 0, 0));
+	CHECK(parses("i", "42", 1, 42, 0, 0));
+	CHECK(parses("[A]", "", 0, 0, 0, 0));
+	CHECK(parses("[A]", "1.5A", 1, 1500000, 0, 0));
+	CHECK(parses("[VV]", "10V   12V", 2, 10000000, 12000000, 0));
+	CHECK(parses("[VV]", "10V", 1, 10000000, 0, 0));
+	CHECK(parses("iW[R]", "-3 500 2ohm", 3, -3, 500, 2000));
+	CHECK(parses("{begin|commit|abort}", "begin", 1, 0, 0, 0));
+	CHECK(parses("{begin|commit|abort}", "abort", 1, 2, 0, 0));
+	CHECK(parses("[{normal|fast}i]", "fast 7", 2, 1, 7, 0));
+
+	CHECK(fails("i", "", "err test expects more arguments\r\n"));
+	CHECK(fails("[A]", "1A 2A", "err test has too many arguments\r\n"));
+	CHECK(fails("", "extra", "err test has too many arguments\r\n"));
+	CHECK(fails("iA", "1 many", "err test argument 2 is invalid\r\n"));
+	// Whole words only
+	CHECK(fails("{begin|commit|abort}", "beg", "err test argument 1 is invalid\r\n"));
+	CHECK(fails("{begin|commit|abort}", "aborted", "err test argument 1 is invalid\r\n"));
+	CHECK(fails("{begin|commit|abort}", "", "err test expects more arguments\r\n"));
+}
+
+static void test_next_argument() {
+	char line[] = "  one two  three ";
+	char *args = line;
+	CHECK(strcmp(next_argument(&args), "one") == 0);
+	CHECK(strcmp(next_argument(&args), "two") == 0);
+	CHECK(strcmp(next_argument(&args), "three") == 0);
+	CHECK(next_argument(&args) == NULL);
+	CHECK(next_argument(&args) == NULL);
+}
+
+// And the specs the table gives the commands themselves
+static void test_command_specs() {
+	const command_def *set = in_word_set("set", 3);
+	char args[] = "250mA";
+	char error[COMMAND_ERROR_LENGTH];
+	command_args parsed;
+	CHECK(parse_command_args(set, args, &parsed, error));
+	CHECK(parsed.count == 1 && parsed.values[0] == 250000);
+	CHECK(in_word_set("mode", 4)->args == NULL);
+}
+
+int main() {
+	test_lookup();
+	test_arguments();
+	test_next_argument();
+	test_command_specs();
+	return check_failures;
+}
+
+/* [] END OF FILE */
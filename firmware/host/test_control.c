@@ -0,0 +1,278 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <stdlib.h>
+#include "project.h"
+#include "config.h"
+#include "check.h"
+
+// control.c's loops against a model of the supply on the terminals: an open
+// circuit voltage behind a series resistance, read back through the ADC's gain
+// and offset. Everything else control.c calls is stood in for here.
+
+static const settings_t defaults = {
+	.adc_voltage_offset = 10,
+	.adc_voltage_gain = 2008,
+	.adc_current_gain = 1000,
+	.cv_kp = 2000,
+	.cv_ki = 200,
+};
+
+const settings_t *settings = &defaults;
+state_t state;
+
+static int supply_voltage;		// Microvolts, open circuit
+static int supply_resistance;	// Milliohms
+static int idac_error;			// Microamps the IDACs are off by
+static output_mode mode = OUTPUT_MODE_FEEDBACK;
+static int pulsing = 0;
+static int acks_posted = 0;
+static uint32 now_us = 0;
+
+static int terminal_voltage() {
+	int64 drop = (int64)state.current_setpoint * supply_resistance / 1000;
+	return (drop > supply_voltage)?0:supply_voltage - (int)drop;
+}
+
+void set_current(int setpoint) {
+	state.current_setpoint = setpoint;
+}
+
+int get_voltage_fast() {
+	return terminal_voltage();
+}
+
+int16 get_raw_voltage_fast() {
+	return terminal_voltage() / settings->adc_voltage_gain + settings->adc_voltage_offset;
+}
+
+int16 voltage_to_raw(int voltage) {
+	return voltage / settings->adc_voltage_gain + settings->adc_voltage_offset;
+}
+
+int current_from_raw(int16 raw) {
+	return (raw - settings->adc_current_offset) * settings->adc_current_gain;
+}
+
+uint32 reciprocal_q30(uint32 x) {
+	return (1u << 30) / x;
+}
+
+output_mode get_output_mode() {
+	return mode;
+}
+
+int get_current_limit() {
+	return CURRENT_FULLRANGE_MAX;
+}
+
+int get_slewing() {
+	return 0;
+}
+
+void slew_to(int current) {
+	(void)current;
+}
+
+void start_pulse() {
+	pulsing = 1;
+}
+
+void stop_pulse() {
+	pulsing = 0;
+}
+
+void defer_post(defer_work work) {
+	if(work == DEFER_SETPOINT_ACK)
+		acks_posted++;
+}
+
+uint32 get_time_us() {
+	return now_us;
+}
+
+static void reset(int voltage, int resistance) {
+	supply_voltage = voltage;
+	supply_resistance = resistance;
+	set_load_mode(LOAD_MODE_CC);
+	set_current(0);
+	state.voltage_setpoint = 0;
+	state.resistance_setpoint = 0;
+	state.power_setpoint = 0;
+	mode = OUTPUT_MODE_FEEDBACK;
+}
+
+static void run(int blocks) {
+	while(blocks--)
+		control_update();
+}
+
+static int within(int64 value, int64 expected, int64 tolerance) {
+	return llabs(value - expected) <= tolerance;
+}
+
+static void test_cv() {
+	reset(VOLTS(12), 500);
+	set_load_target(LOAD_MODE_CV, VOLTS(11));
+	CHECK(get_load_mode() == LOAD_MODE_CV);
+	run(1000);
+	// 1V across 0.5 ohms, to within a count
+	CHECK(within(terminal_voltage(), VOLTS(11), 2 * defaults.adc_voltage_gain));
+	CHECK(within(state.current_setpoint, AMPS(2), MILLIAMPS(10)));
+
+	// A target the supply never gets down to draws the most there is
+	set_voltage_target(VOLTS(5));
+	run(1000);
+	CHECK(state.current_setpoint == CURRENT_FULLRANGE_MAX);
+	// And one above it, nothing
+	set_voltage_target(VOLTS(20));
+	run(1000);
+	CHECK(state.current_setpoint == 0);
+
+	// Switching to CV with no target holds the terminals where they are
+	reset(VOLTS(12), 500);
+	set_current(AMPS(1));
+	set_load_mode(LOAD_MODE_CV);
+	CHECK(get_voltage_target() == VOLTS(11.5));
+	run(100);
+	CHECK(within(state.current_setpoint, AMPS(1), MILLIAMPS(10)));
+}
+
+static void test_cr() {
+	reset(VOLTS(12), 500);
+	set_load_target(LOAD_MODE_CR, OHMS(4));
+	run(100);
+	int voltage = terminal_voltage();
+	// I = V / R at the terminals, to within a percent
+	CHECK(within((int64)state.current_setpoint * 4, voltage, voltage / 100));
+	CHECK(within(state.current_setpoint, 2666667, MILLIAMPS(30)));
+
+	// Too low a resistance is the lowest allowed, and the current clamps
+	set_resistance_target(0);
+	CHECK(get_resistance_target() == CR_MIN_RESISTANCE);
+	supply_voltage = VOLTS(60);
+	supply_resistance = 0;
+	run(10);
+	CHECK(state.current_setpoint == CURRENT_FULLRANGE_MAX);
+
+	// Nothing on the terminals reads below the offset, and draws nothing
+	supply_voltage = 0;
+	run(10);
+	CHECK(state.current_setpoint == 0);
+}
+
+static void test_cp() {
+	reset(VOLTS(12), 500);
+	set_load_target(LOAD_MODE_CP, 20000);
+	run(100);
+	// 1.80A at 11.1V
+	int64 power = (int64)terminal_voltage() * state.current_setpoint / 1000000000;
+	CHECK(within(power, 20000, 200));
+
+	set_power_target(-1);
+	CHECK(get_power_target() == 0);
+	set_power_target(100000);
+	supply_resistance = 0;
+	supply_voltage = VOLTS(1);
+	run(10);
+	CHECK(state.current_setpoint == CURRENT_FULLRANGE_MAX);
+	supply_voltage = 0;
+	run(10);
+	CHECK(state.current_setpoint == 0);
+}
+
+static void test_output_off() {
+	reset(VOLTS(12), 500);
+	set_load_target(LOAD_MODE_CR, OHMS(4));
+	mode = OUTPUT_MODE_ON;
+	run(10);
+	CHECK(state.current_setpoint == 0);
+	mode = OUTPUT_MODE_FEEDBACK;
+	run(1);
+	CHECK(state.current_setpoint > 0);
+}
+
+static void test_pulse() {
+	reset(VOLTS(12), 500);
+	set_load_mode(LOAD_MODE_PULSE);
+	CHECK(pulsing);
+	set_load_mode(LOAD_MODE_CC);
+	CHECK(!pulsing);
+}
+
+static void test_posted_setpoint() {
+	int32 setpoint;
+	uint32 when;
+
+	reset(VOLTS(12), 500);
+	mode = OUTPUT_MODE_OFF;
+	acks_posted = 0;
+	CHECK(!control_take_applied(&setpoint, &when));
+
+	// Held, nothing is applied
+	set_control_hold(1);
+	control_post_setpoint(AMPS(1));
+	control_post_setpoint(AMPS(2));
+	run(1);
+	CHECK(state.current_setpoint == 0);
+	set_control_hold(0);
+
+	// The last post goes out on the next update, whatever the output mode
+	now_us = 1234;
+	run(1);
+	CHECK(state.current_setpoint == AMPS(2));
+	CHECK(acks_posted == 1);
+	CHECK(control_take_applied(&setpoint, &when));
+	CHECK(setpoint == AMPS(2) && when == 1234);
+	CHECK(!control_take_applied(&setpoint, &when));
+	run(1);
+	CHECK(acks_posted == 1);
+}
+
+static void test_trim() {
+	reset(VOLTS(12), 500);
+	set_current(AMPS(1));
+	idac_error = -MILLIAMPS(10);
+	CHECK(!set_trim_shift(TRIM_MAX_SHIFT + 1));
+	CHECK(set_trim_shift(2));
+
+	for(int i = 0; i < 200; i++) {
+		int16 mean[FILTER_CHANNELS] = {0};
+		mean[FILTER_CURRENT] = (state.current_setpoint + get_current_trim() + idac_error) / 1000;
+		trim_block(mean);
+	}
+	CHECK(within(get_current_trim(), MILLIAMPS(10), MILLIAMPS(1)));
+
+	// An error over an eighth of the setpoint isn't the IDACs
+	CHECK(set_trim_shift(2));
+	idac_error = -AMPS(0.5);
+	for(int i = 0; i < 200; i++) {
+		int16 mean[FILTER_CHANNELS] = {0};
+		mean[FILTER_CURRENT] = (state.current_setpoint + get_current_trim() + idac_error) / 1000;
+		trim_block(mean);
+	}
+	CHECK(get_current_trim() == 0);
+	set_trim_shift(-1);
+}
+
+int main() {
+	test_cv();
+	test_cr();
+	test_cp();
+	test_output_off();
+	test_pulse();
+	test_posted_setpoint();
+	test_trim();
+	return check_failures;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,115 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <string.h>
+#include "project.h"
+#include "config.h"
+#include "check.h"
+
+// format.c's sprintf replacement, format_number() and parse_quantity()
+
+// Stands in for calibration.c's, which is exact for every 32 bit n too
+uint32 div1000(uint32 n) {
+	return n / 1000;
+}
+
+static int formats(const char *expected, const char *out) {
+	if(strcmp(expected, out) == 0)
+		return 1;
+	printf("got \"%s\", expected \"%s\"\n", out, expected);
+	return 0;
+}
+
+static int parses(const char *text, char quantity, int32 expected) {
+	int32 value = 0;
+	return parse_quantity(text, quantity, &value) && value == expected;
+}
+
+static int rejects(const char *text, char quantity) {
+	int32 value = 0;
+	return !parse_quantity(text, quantity, &value);
+}
+
+static void test_integers() {
+	char out[24];
+	CHECK(formats("0", (format_uint(out, 0, 0), out)));
+	CHECK(formats("0042", (format_uint(out, 42, 4), out)));
+	CHECK(formats("4294967295", (format_uint(out, 4294967295u, 0), out)));
+	CHECK(formats("-05", (format_int(out, -5, 3), out)));
+	CHECK(formats("-2147483648", (format_int(out, INT32_MIN, 0), out)));
+	CHECK(formats("ff", (format_hex(out, 0xFF, 0), out)));
+	CHECK(formats("001a", (format_hex(out, 0x1A, 4), out)));
+	CHECK(formats("deadbeef", (format_hex(out, 0xDEADBEEF, 0), out)));
+
+	// Each returns its NUL, for chaining
+	char *end = format_uint(out, 123, 0);
+	CHECK(end == out + 3 && *end == '\0');
+}
+
+static void test_format() {
+	char out[64];
+	char *end = format(out, "%d %u %x %s %c %.3s %03d%%", -12, 34u, 0xABu, "word", 'Z', "truncated", 7);
+	CHECK(formats("-12 34 ab word Z tru 007%", out));
+	CHECK(end == out + strlen(out));
+}
+
+static void test_format_number() {
+	char out[16];
+	CHECK(formats("0.00mA", (format_number(-1, 'A', out), out)));
+	CHECK(formats("1.23mA", (format_number(1234, 'A', out), out)));
+	CHECK(formats("12.3mA", (format_number(12345, 'A', out), out)));
+	CHECK(formats("123mA", (format_number(123456, 'A', out), out)));
+	CHECK(formats("1.23V ", (format_number(1234567, 'V', out), out)));
+	CHECK(formats("60.0V ", (format_number(60000000, 'V', out), out)));
+	CHECK(formats("123W ", (format_number(123456789, 'W', out), out)));
+}
+
+static void test_parse_quantity() {
+	// Bare numbers are in the serial protocol's old units
+	CHECK(parses("12", 'V', 12000));
+	CHECK(parses("2", 'R', 2000));
+	CHECK(parses("1.50", 'A', 1500));
+	// Prefixes and symbols
+	CHECK(parses("1.5A", 'A', 1500000));
+	CHECK(parses("500m", 'A', 500000));
+	CHECK(parses("250uA", 'A', 250));
+	CHECK(parses("12V", 'V', 12000000));
+	CHECK(parses("1.5kR", 'R', 1500000));
+	CHECK(parses("2ohm", 'R', 2000));
+	CHECK(parses("+3W", 'W', 3000));
+	// Lower case quantities take bare whole units, as SCPI does
+	CHECK(parses("1.5", 'a', 1500000));
+	CHECK(parses("12", 'v', 12000000));
+	// Plain integers
+	CHECK(parses("-7", 0, -7));
+	CHECK(parses("2147483647", 0, INT32_MAX));
+
+	CHECK(rejects(NULL, 'A'));
+	CHECK(rejects("", 'A'));
+	CHECK(rejects(".", 'A'));
+	CHECK(rejects("1x", 'A'));
+	CHECK(rejects("1A", 'V'));
+	CHECK(rejects("1.5", 0));
+	CHECK(rejects("0.0001", 'W'));	// Finer than a milliwatt
+	CHECK(rejects("3000000000", 0));
+	CHECK(rejects("3000A", 'A'));	// Over INT32_MAX microamps
+}
+
+int main() {
+	test_integers();
+	test_format();
+	test_format_number();
+	test_parse_quantity();
+	return check_failures;
+}
+
+/* [] END OF FILE */
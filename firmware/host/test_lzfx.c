@@ -0,0 +1,120 @@
+/* ========================================
+ *
+ * Copyright Arachnid Labs, 2013
+ * All Rights Reserved
+ * UNPUBLISHED, LICENSED SOFTWARE.
+ *
+ * CONFIDENTIAL AND PROPRIETARY INFORMATION
+ * WHICH IS THE PROPERTY OF your company.
+ *
+ * ========================================
+*/
+
+#include <string.h>
+#include "lzfx.h"
+#include "check.h"
+
+// lzfx round trips, and the streaming decoder the firmware unpacks assets with
+
+typedef struct {
+	unsigned char data[2048];
+	unsigned int len;
+	unsigned int chunks;
+	unsigned int largest;
+} collected;
+
+static void collect(const void *data, unsigned int len, void *arg) {
+	collected *out = arg;
+	if(out->len + len <= sizeof(out->data))
+		memcpy(out->data + out->len, data, len);
+	out->len += len;
+	out->chunks++;
+	if(len > out->largest)
+		out->largest = len;
+}
+
+static const char text[] =
+	"The Re:load Pro is an adjustable electronic load. It sinks a set current, "
+	"voltage, resistance or power from whatever is connected to its terminals, "
+	"and reports the current, voltage and power it sees as it does.";
+
+static void test_round_trip() {
+	unsigned char packed[512], unpacked[512];
+	unsigned int packed_len = sizeof(packed), unpacked_len = sizeof(unpacked);
+
+	CHECK(lzfx_compress(text, sizeof(text), packed, &packed_len) >= 0);
+	CHECK(packed_len < sizeof(text));
+	CHECK(lzfx_decompress(packed, packed_len, unpacked, &unpacked_len) >= 0);
+	CHECK(unpacked_len == sizeof(text));
+	CHECK(memcmp(text, unpacked, sizeof(text)) == 0);
+
+	// A zero olen asks for the size
+	unsigned int needed = 0;
+	CHECK(lzfx_decompress(packed, packed_len, unpacked, &needed) >= 0);
+	CHECK(needed == sizeof(text));
+
+	unsigned int tiny = 4;
+	CHECK(lzfx_compress(text, sizeof(text), packed, &tiny) == LZFX_ESIZE);
+	CHECK(lzfx_compress(NULL, sizeof(text), packed, &packed_len) == LZFX_EARGS);
+}
+
+static void test_stream() {
+	// lzfx_compress doesn't hold to the window, but the one back reference it
+	// finds in this much of a short period is a period back
+	unsigned char pattern[300];
+	for(unsigned int i = 0; i < sizeof(pattern); i++)
+		pattern[i] = "0123456789abcdefghijklmnopqrstuvwxyzABCD"[i % 40];
+	unsigned char packed[512];
+	unsigned int packed_len = sizeof(packed);
+	CHECK(lzfx_compress(pattern, sizeof(pattern), packed, &packed_len) >= 0);
+
+	collected out = {{0}};
+	CHECK(lzfx_decompress_stream(packed, packed_len, collect, &out) == sizeof(pattern));
+	CHECK(out.len == sizeof(pattern));
+	CHECK(memcmp(out.data, pattern, sizeof(pattern)) == 0);
+	CHECK(out.largest == LZFX_STREAM_CHUNK);
+	CHECK(out.chunks == (sizeof(pattern) + LZFX_STREAM_CHUNK - 1) / LZFX_STREAM_CHUNK);
+
+	// Literals only
+	collected literal = {{0}};
+	const unsigned char three[] = {2, 'a', 'b', 'c'};
+	CHECK(lzfx_decompress_stream(three, sizeof(three), collect, &literal) == 3);
+	CHECK(literal.len == 3 && literal.chunks == 1 && memcmp(literal.data, "abc", 3) == 0);
+
+	CHECK(lzfx_decompress_stream(NULL, 4, collect, &literal) == LZFX_EARGS);
+	CHECK(lzfx_decompress_stream(three, sizeof(three), NULL, &literal) == LZFX_EARGS);
+}
+
+static void test_stream_corrupt() {
+	collected out = {{0}};
+
+	// Three runs of 32 literals, then a reference 80 bytes back: past the window
+	unsigned char far[3 * 33 + 2];
+	for(int run = 0; run < 3; run++) {
+		far[run * 33] = 31;
+		memset(far + run * 33 + 1, 'a' + run, 32);
+	}
+	far[99] = 1 << 5;
+	far[100] = 79;
+	CHECK(lzfx_decompress_stream(far, sizeof(far), collect, &out) == LZFX_ECORRUPT);
+	// The same reference 64 back is in reach
+	far[100] = 63;
+	out.len = 0;
+	CHECK(lzfx_decompress_stream(far, sizeof(far), collect, &out) == 99);
+	CHECK(memcmp(out.data + 96, "bbb", 3) == 0);
+
+	// A reference before the start, and a literal run cut short
+	const unsigned char before[] = {0, 'a', 1 << 5, 4};
+	CHECK(lzfx_decompress_stream(before, sizeof(before), collect, &out) == LZFX_ECORRUPT);
+	const unsigned char short_run[] = {5, 'a', 'b'};
+	CHECK(lzfx_decompress_stream(short_run, sizeof(short_run), collect, &out) == LZFX_ECORRUPT);
+}
+
+int main() {
+	test_round_trip();
+	test_stream();
+	test_stream_corrupt();
+	return check_failures;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,245 @@
+"""Packs the firmware's compressed assets into assets.c and assets.h.
+
+    python tools/assetpacker.py
+
+Each asset in ASSETS is a named list of segments. Every segment is lzfx
+compressed on its own, so the firmware can decode any one of them without
+the rest, through asset_decode() and a streaming sink. The splashscreen is
+one segment per display page; a file is cut into SEGMENT_BYTES pieces, so
+help text or a stored profile can be read from the middle. A label is a
+string from LABELS rendered with the font, one segment per row of monochrome
+columns, which draw_text() in the firmware sends without drawing it glyph by
+glyph. The outputs go in the application's directory, and are only rewritten
+if they've changed. Each segment's size is printed against the assets.c
+being replaced.
+
+To add an asset, add it to ASSETS. Its id is ASSET_<NAME> in assets.h.
+"""
+from __future__ import print_function
+import os
+import re
+try:
+    from StringIO import StringIO
+except ImportError:
+    from io import StringIO
+
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+APPLICATION = os.path.join(os.path.dirname(TOOLS), 'firmware', 'Reload Pro.cydsn')
+
+FONT = 'reload font.png'
+ENTER = '\xdf'  # FONT_GLYPH_ENTER
+
+# Static text drawn often enough to be worth its flash, about 0.6 bytes a
+# column compressed, spelled exactly as ui.c passes it to draw_text(). Rarer
+# screens, such as calibration and faults, are drawn from the font.
+LABELS = [
+    # The main menu
+    'Presets', 'C/C Load', 'C/V Load', 'C/R Load', 'C/P Load', 'Pulse Load',
+    'Graph', 'Battery Test', 'I-V Sweep', 'MPPT', 'IR Test', 'Layout',
+    'Readouts', 'Settings', 'Calibrate',
+    # Main readout labels, redrawn on every load screen and digit change
+    'SET', 'ACT', 'P-P', 'RMS', 'AC',
+    # Prompts
+    ENTER + ': Next', ENTER + ': Done',
+]
+
+
+def label_name(text):
+    return 'label_' + re.sub('[^0-9a-z]+', '_', text.lower()).strip('_')
+
+
+# (name, kind, source in tools/). Kinds are 'splashscreen', for an image in
+# the display's page format, 'file', for any other data, and 'label', whose
+# source is the text itself.
+ASSETS = [
+    ('splashscreen', 'splashscreen', 'splashscreen.gif'),
+] + [(label_name(text), 'label', text) for text in LABELS]
+
+SEGMENT_BYTES = 256  # For 'file' assets
+LABEL_COLUMNS = 160  # The display's width, and draw_text()'s buffer
+
+# Must match LZFX_STREAM_WINDOW in lzfx.h: the firmware decodes each segment
+# with only this many bytes of history, so back references can't reach further.
+WINDOW = 64
+MAX_LITERALS = 32
+MIN_MATCH = 3
+MAX_MATCH = 7 + 255 + 2
+
+
+def match_cost(length):
+    return 2 if length - 2 < 7 else 3
+
+
+def compress(data, window=WINDOW):
+    """LZF compresses data, with back references limited to window bytes.
+
+    The parse is optimal rather than greedy: working back from the end, each
+    position takes whichever literal run or back reference starting there
+    gives the smallest output for the rest of the data.
+    """
+    data = list(bytearray(data))
+    n = len(data)
+
+    # Longest match at each position for each offset, from the longest at
+    # the next position: matches[i][off - 1]
+    matches = [[0] * window for _ in range(n + 1)]
+    for i in range(n - 1, -1, -1):
+        for off in range(1, min(window, i) + 1):
+            if data[i - off] == data[i]:
+                matches[i][off - 1] = min(matches[i + 1][off - 1] + 1, MAX_MATCH, n - i)
+
+    # cost[i] is the fewest bytes that can encode data[i:]; step[i] is how
+    cost = [0] * (n + 1)
+    step = [None] * (n + 1)
+    for i in range(n - 1, -1, -1):
+        best, best_step = None, None
+        for run in range(1, min(MAX_LITERALS, n - i) + 1):
+            c = 1 + run + cost[i + run]
+            if best is None or c < best:
+                best, best_step = c, (0, run)
+        for off in range(1, min(window, i) + 1):
+            for length in range(MIN_MATCH, matches[i][off - 1] + 1):
+                c = match_cost(length) + cost[i + length]
+                if c < best:
+                    best, best_step = c, (off, length)
+        cost[i], step[i] = best, best_step
+
+    out = []
+    i = 0
+    while i < n:
+        off, length = step[i]
+        if off == 0:
+            out.append(length - 1)
+            out.extend(data[i:i + length])
+        elif length - 2 < 7:
+            out.extend((((length - 2) << 5) | ((off - 1) >> 8), (off - 1) & 0xFF))
+        else:
+            out.extend(((7 << 5) | ((off - 1) >> 8), length - 2 - 7, (off - 1) & 0xFF))
+        i += length
+
+    return bytes(bytearray(out))
+
+
+
+_glyphs = []
+
+
+def load_segments(kind, source):
+    """Returns the uncompressed segments of one asset."""
+    if kind == 'label':
+        import fontmaker
+        if not _glyphs:
+            _glyphs.extend(fontmaker.load_glyphs(os.path.join(TOOLS, FONT)))
+        rows = fontmaker.render_text(_glyphs, source)
+        assert len(rows[0]) <= LABEL_COLUMNS, 'label %r is too wide' % source
+        return [bytes(bytearray(row)) for row in rows]
+    path = os.path.join(TOOLS, source)
+    if kind == 'splashscreen':
+        import imageformatter
+        return imageformatter.splashscreen_pages(path)
+    data = open(path, 'rb').read()
+    return [data[i:i + SEGMENT_BYTES] for i in range(0, len(data), SEGMENT_BYTES)]
+
+
+def c_string(text):
+    """Quotes text for C, with anything outside printable ASCII in octal."""
+    return '"%s"' % ''.join(c if ' ' <= c <= '~' and c not in '"\\' else '\\%03o' % ord(c) for c in text)
+
+
+def format_assets(assets, labels):
+    """Returns the text of assets.c and assets.h for [(name, [compressed segment])]
+    and the [(name, text)] of the labels among them."""
+    offsets = [0]
+    for name, segments in assets:
+        for segment in segments:
+            offsets.append(offsets[-1] + len(segment))
+
+    out = StringIO()
+    out.write('#include "assets.h"\n\n')
+    out.write("const uint8 asset_data[] = {\n")
+    index = 0
+    for name, segments in assets:
+        for i, segment in enumerate(segments):
+            out.write("    // %d-%d: %s %d\n" % (offsets[index], offsets[index + 1] - 1, name, i))
+            segment = bytearray(segment)
+            for line in range(0, len(segment), 10):
+                value = ''.join('0x%02X, ' % x for x in segment[line:line + 10]).strip()
+                out.write("    %s\n" % (value,))
+            index += 1
+    out.write("};\n\n")
+    out.write("const uint16 asset_offsets[] = {%s};\n\n" % (', '.join(str(x) for x in offsets)))
+    out.write("const asset_entry asset_table[ASSET_COUNT] = {\n")
+    first = 0
+    for name, segments in assets:
+        out.write("    {%d, %d}, // ASSET_%s\n" % (first, len(segments), name.upper()))
+        first += len(segments)
+    out.write("};\n\n")
+    out.write("const asset_label asset_labels[ASSET_LABEL_COUNT] = {\n")
+    for name, text in labels:
+        out.write("    {%s, ASSET_%s},\n" % (c_string(text), name.upper()))
+    out.write("};\n")
+    source = out.getvalue()
+
+    out = StringIO()
+    out.write("// Generated by tools/assetpacker.py; add assets to its ASSETS list.\n\n")
+    out.write("#include <project.h>\n#include \"lzfx.h\"\n\n")
+    out.write("typedef enum {\n")
+    for name, segments in assets:
+        out.write("\tASSET_%s,\n" % name.upper())
+    out.write("\tASSET_COUNT\n} asset_id;\n\n")
+    for name, segments in assets:
+        out.write("#define ASSET_%s_SEGMENTS %d\n" % (name.upper(), len(segments)))
+    out.write("#define ASSET_LABEL_COUNT %d\n" % len(labels))
+    out.write("\ntypedef struct {\n")
+    out.write("\tuint16 first; // Index into asset_offsets\n")
+    out.write("\tuint16 segments;\n")
+    out.write("} asset_entry;\n\n")
+    out.write("// A label asset and the text it was rendered from\n")
+    out.write("typedef struct {\n")
+    out.write("\tconst char *text;\n")
+    out.write("\tasset_id id;\n")
+    out.write("} asset_label;\n\n")
+    out.write("extern const uint8 asset_data[];\n")
+    out.write("extern const uint16 asset_offsets[];\n")
+    out.write("extern const asset_entry asset_table[ASSET_COUNT];\n")
+    out.write("extern const asset_label asset_labels[ASSET_LABEL_COUNT];\n\n")
+    out.write("int asset_segments(asset_id id);\n")
+    out.write("int asset_decode(asset_id id, int segment, lzfx_sink sink, void *arg);\n")
+    return source, out.getvalue()
+
+
+def segment_sizes(text):
+    """The compressed size of each segment, from assets.c's offset table."""
+    offsets = re.search(r'asset_offsets\[\] = \{([^}]*)\}', text).group(1)
+    offsets = [int(x) for x in offsets.split(',')]
+    return [b - a for a, b in zip(offsets, offsets[1:])]
+
+
+def make_assets():
+    """Returns the text of assets.c and assets.h, and a line about their size."""
+    assets = [(name, [compress(segment) for segment in load_segments(kind, source)])
+              for name, kind, source in ASSETS]
+    labels = [(name, source) for name, kind, source in ASSETS if kind == 'label']
+    source, header = format_assets(assets, labels)
+    size = sum(len(segment) + 2 for name, segments in assets for segment in segments) + 2
+    size += 4 * len(assets) + 8 * len(labels) + sum(len(text) + 1 for name, text in labels)
+    return source, header, "Assets take %d bytes" % size
+
+
+def main():
+    source, header, message = make_assets()
+    source_path = os.path.join(APPLICATION, 'assets.c')
+    if os.path.exists(source_path):
+        old, new = segment_sizes(open(source_path).read()), segment_sizes(source)
+        for i, (before, after) in enumerate(zip(old, new)):
+            print("Segment %d: %d bytes, was %d" % (i, after, before))
+        print("Total: %d bytes, was %d" % (sum(new), sum(old)))
+    for path, text in ((source_path, source), (os.path.join(APPLICATION, 'assets.h'), header)):
+        if not os.path.exists(path) or open(path).read() != text:
+            open(path, 'w').write(text)
+    print(message)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,346 @@
+"""Shares each unit's serial port between many TCP clients.
+
+Only one process can hold a serial port, so a logging daemon and a test
+executive otherwise take turns. The bridge holds each port given, and
+listens for clients of the first on --port, the next on --port + 1 and so
+on:
+
+    python tools/bridge.py /dev/ttyACM0 /dev/ttyACM1 --port 5025
+
+A client talks to the bridge as it would to the unit, so the host library
+works through it with a socket URL in place of the port:
+
+    unit = reloadpro.Unit('socket://rack1:5025')
+
+Each client's commands, text lines or binary frames, are pipelined to the
+unit on one Connection, interleaved with everyone else's, and each reply goes
+back to the client that asked, in the order it asked. A line may start with
+"#<tag> ", which is stripped before it's sent and put in front of every line
+of its reply, for a client that would rather match replies by tag. Frames
+are checked against their CRC here and sent on to the unit as frames, so a
+text command whose name has an opcode (reloadpro.OPCODES) goes to the unit as
+one too, CRC protected.
+
+Streaming is shared: 'stream <blocks>' subscribes the client rather than
+reconfiguring the unit, which streams at the fastest rate anyone has asked
+for, and each subscriber gets every record or every nth as its own rate
+works out, from the one stream. Records keep the unit's sequence numbers,
+so one at a slower rate sees the skipped ones as gaps, which the host
+library counts as dropped. 'stream 0' or disconnecting unsubscribes.
+Only plain records are shared, not channel records. Events, faults,
+readings and finished captures and sweeps go to every client. 'baud' and
+'boot' would cut off everyone else, so they're refused, and 'credit' is
+dropped, the bridge reading the unit as fast as it sends. 'config begin'
+stages every client's commands until the commit, not just its own. Fast
+set frames go straight through, and their acknowledgements to every client,
+as a unit connected directly would send them. Needs pyserial and
+tools/reloadpro.py.
+"""
+from __future__ import print_function
+import argparse
+import socket
+import struct
+import threading
+import time
+
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+import reloadpro
+
+
+FANOUT_INTERVAL = 0.02  # Seconds between passes over the stream and notices
+FRAME_TEXT_MAX = 64  # Argument bytes a text command may have to go as a frame
+REFUSED = {'baud': 'err baud is fixed by the bridge', 'boot': 'err boot would disconnect every client'}
+
+
+def encode_frame(opcode, payload):
+    body = bytes(bytearray([opcode, len(payload)])) + bytes(payload)
+    return bytes(bytearray([reloadpro.FRAME_SYNC])) + body + struct.pack('<H', reloadpro.crc16(body))
+
+
+class Client(object):
+    """One TCP client: a thread reading its requests and one writing their
+    replies, in order."""
+
+    def __init__(self, bridge, sock, address):
+        self.bridge = bridge
+        self.sock = sock
+        self.address = address
+        self.lock = threading.Lock()  # Keeps lines and records whole
+        self.replies = queue.Queue()  # (tag, Reply, or lines answered here)
+        self.blocks = 0  # Stream subscription, 0 for none
+        self.every = 1  # Of the unit's records, to forward
+        self.running = True
+
+    def start(self):
+        for target in (self._read, self._write):
+            thread = threading.Thread(target=target)
+            thread.daemon = True
+            thread.start()
+
+    def send(self, data):
+        try:
+            with self.lock:
+                self.sock.sendall(data)
+        except socket.error:
+            self.running = False
+
+    def send_lines(self, lines, tag=None):
+        prefix = '' if tag is None else '#%s ' % tag
+        self.send(''.join('%s%s\r\n' % (prefix, line) for line in lines).encode('ascii'))
+
+    def _read(self):
+        buf = bytearray()
+        while self.running:
+            try:
+                data = self.sock.recv(4096)
+            except socket.error:
+                data = b''
+            if not data:
+                break
+            buf.extend(data)
+            buf = self._parse(buf)
+        self.running = False
+        self.replies.put(None)
+        self.bridge.disconnect(self)
+
+    def _parse(self, buf):
+        pos = 0
+        while pos < len(buf):
+            if buf[pos] == reloadpro.FRAME_SYNC:
+                if len(buf) - pos < 3 or len(buf) - pos < buf[pos + 2] + 5:
+                    break
+                length = buf[pos + 2]
+                body = bytes(buf[pos + 1:pos + 3 + length])
+                crc, = struct.unpack_from('<H', bytes(buf[pos + 3 + length:pos + 5 + length]))
+                pos += length + 5
+                if crc != reloadpro.crc16(body):
+                    self.replies.put((None, ['err frame crc']))
+                else:
+                    result = self.bridge.request_frame(self, bytearray(body)[0], body[2:])
+                    if result is not None:
+                        self.replies.put((None, result))
+            else:
+                end = buf.find(b'\n', pos)
+                if end < 0:
+                    break
+                line = buf[pos:end].decode('ascii', 'replace').strip()
+                pos = end + 1
+                if line:
+                    self._request(line)
+        return buf[pos:]
+
+    def _request(self, line):
+        tag = None
+        if line.startswith('#'):
+            tag, _, line = line[1:].partition(' ')
+            line = line.strip()
+        result = self.bridge.request(self, line)
+        if result is not None:
+            self.replies.put((tag, result))
+
+    def _write(self):
+        while True:
+            item = self.replies.get()
+            if item is None:
+                return
+            tag, reply = item
+            if isinstance(reply, list):
+                self.send_lines(reply, tag)
+                continue
+            try:
+                lines = reply.wait()
+            except reloadpro.UnitError as e:
+                self.send_lines(['err %s' % e], tag)
+                continue
+            if reply.frame is not None:
+                self.send(encode_frame(*reply.frame))
+                continue
+            self.send_lines(lines, tag)
+            if reply.data:
+                self.send(bytes(reply.data))
+
+
+class Bridge(object):
+    """One unit's port and the clients sharing it."""
+
+    def __init__(self, port, listen, baud, timeout, shared):
+        self.connection = reloadpro.Connection(port, baud, timeout, shared=shared)
+        self.lock = threading.Lock()
+        self.clients = []
+        self.blocks = 0  # The unit's stream rate, 0 if not streaming
+        self.server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.server.bind(listen)
+        self.server.listen(8)
+        for target in (self._accept, self._fanout):
+            thread = threading.Thread(target=target)
+            thread.daemon = True
+            thread.start()
+
+    def close(self):
+        self.server.close()
+        try:
+            if self.blocks:
+                self.connection.command('stream 0')
+        finally:
+            self.connection.close()
+
+    def _accept(self):
+        while True:
+            try:
+                sock, address = self.server.accept()
+            except socket.error:
+                return
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            client = Client(self, sock, address)
+            with self.lock:
+                self.clients.append(client)
+            client.start()
+            print('%s: %s:%d connected' % (self.connection.port, address[0], address[1]))
+
+    def disconnect(self, client):
+        with self.lock:
+            if client in self.clients:
+                self.clients.remove(client)
+        client.sock.close()
+        if client.blocks:
+            client.blocks = 0
+            self._restream()
+        print('%s: %s:%d disconnected' % (self.connection.port, client.address[0], client.address[1]))
+
+    def request(self, client, line):
+        """Sends line on to the unit and returns its Reply, or the lines to
+        answer with here, or None for no answer."""
+        words = line.split()
+        name = words[0].lower() if words else ''
+        if name in REFUSED:
+            return [REFUSED[name]]
+        if name == 'credit':
+            return None
+        if name == 'stream':
+            return self._subscribe(client, words[1:])
+        arguments = line[len(words[0]):].strip() if words else ''
+        if name in reloadpro.OPCODES and len(arguments) <= FRAME_TEXT_MAX:
+            opcode = reloadpro.OPCODES.index(name)
+            if opcode not in reloadpro.BINARY_OPCODES:
+                return self.connection.send_frame(opcode, arguments.encode('ascii'))
+        if line.startswith('@'):
+            address, _, command = line[1:].partition(' ')
+            return self.connection.send(command.strip(), address)
+        return self.connection.send(line)
+
+    def request_frame(self, client, opcode, payload):
+        # Those the bridge answers itself, whichever way they come
+        if opcode < len(reloadpro.OPCODES) and opcode not in reloadpro.BINARY_OPCODES:
+            name = reloadpro.OPCODES[opcode]
+            if name in REFUSED or name in ('stream', 'credit'):
+                return self.request(client, ('%s %s' % (name, bytearray(payload).decode('ascii', 'replace'))).strip())
+        return self.connection.send_frame(opcode, payload)
+
+    def _subscribe(self, client, arguments):
+        try:
+            blocks = int(arguments[0]) if arguments else -1
+        except ValueError:
+            blocks = -1
+        if blocks < 0 or blocks > 0xFFFF:
+            return ['err stream expects blocks']
+        if len(arguments) > 1:
+            return ['err the bridge shares plain stream records only']
+        client.blocks = blocks
+        return self._restream() or ['stream %d' % blocks]
+
+    def _restream(self):
+        """Streams at the fastest rate subscribed, and works out how many of
+        its records each subscriber skips. Returns the error if the unit
+        refused."""
+        with self.lock:
+            rates = [c.blocks for c in self.clients if c.blocks]
+            fastest = min(rates) if rates else 0
+            for client in self.clients:
+                # Rounded down, so nobody gets fewer records than they asked for
+                client.every = max(1, client.blocks // fastest) if fastest else 1
+        if fastest == self.blocks:
+            return None
+        self.blocks = fastest
+        try:
+            self.connection.command('stream %d' % fastest)
+        except reloadpro.UnitError as e:
+            return ['err %s' % e]
+        return None
+
+    def _everyone(self, lines):
+        with self.lock:
+            clients = list(self.clients)
+        for client in clients:
+            client.send_lines(lines)
+
+    def _fanout(self):
+        size = reloadpro.STREAM_RECORD.size
+        while True:
+            time.sleep(FANOUT_INTERVAL)
+            records = self.connection.take_stream()
+            if records:
+                with self.lock:
+                    subscribers = [c for c in self.clients if c.blocks]
+                for client in subscribers:
+                    if client.every == 1:
+                        client.send(records)
+                        continue
+                    chosen = bytearray()
+                    for start in range(0, len(records), size):
+                        record = bytearray(records[start:start + size])
+                        if (record[1] | (record[2] << 8)) % client.every == 0:
+                            chosen.extend(record)
+                    if chosen:
+                        client.send(bytes(chosen))
+            for source in (self.connection.notices, self.connection.captures, self.connection.sweeps):
+                while True:
+                    try:
+                        item = source.get_nowait()
+                    except queue.Empty:
+                        break
+                    self._everyone([item[1]] if source is self.connection.notices else item)
+            while True:
+                try:
+                    ack = self.connection.setpoint_acks.get_nowait()
+                except queue.Empty:
+                    break
+                data = encode_frame(reloadpro.OPCODE_FAST_SET | reloadpro.FRAME_REPLY, struct.pack('<iI', *ack))
+                with self.lock:
+                    clients = list(self.clients)
+                for client in clients:
+                    client.send(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('ports', nargs='+', help='Serial ports, one per unit')
+    parser.add_argument('--port', type=int, default=5025, help='TCP port for the first unit (default %(default)s)')
+    parser.add_argument('--bind', default='', help='Address to listen on (default all)')
+    parser.add_argument('--baud', type=int, default=reloadpro.DEFAULT_BAUD)
+    parser.add_argument('--timeout', type=float, default=reloadpro.DEFAULT_TIMEOUT,
+                        help='Seconds to wait for each reply')
+    parser.add_argument('--shared', action='store_true',
+                        help='Units share each port by address, one command in flight at a time')
+    args = parser.parse_args()
+
+    bridges = []
+    try:
+        for i, port in enumerate(args.ports):
+            bridges.append(Bridge(port, (args.bind, args.port + i), args.baud, args.timeout, args.shared))
+            print('%s on port %d' % (port, args.port + i))
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for bridge in bridges:
+            bridge.close()
+
+
+if __name__ == '__main__':
+    main()
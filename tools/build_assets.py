@@ -0,0 +1,102 @@
+"""Regenerates every generated source file in the firmware from its inputs.
+
+    python tools/build_assets.py [--check]
+
+Builds font.c from "reload font.png" with the FONT_GLYPH_PLANES and
+FONT_GLYPH_RLE settings in font.h, so the two can't disagree about the data's
+format. It also builds assets.c and assets.h, the compressed asset store with
+the splashscreen and pre-rendered labels, with assetpacker.py, and commands.h
+and scpi_commands.h from serial_keywords and scpi_keywords with gperf. Each output is only
+rewritten when its text changes, so a run with nothing to do leaves every timestamp alone and the next
+build stays incremental. The generators have no timestamps or other varying
+output, so the same inputs always give the same files.
+
+It can be run from anywhere. Add it as the application's pre-build command
+(Build Settings > User Commands) to run it on every build. With --check
+nothing is written; it lists stale outputs and exits non-zero if there are
+any.
+"""
+from __future__ import print_function
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+import assetpacker
+import fontmaker
+
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(TOOLS)
+COMPONENT = os.path.join(ROOT, 'firmware', 'Parts.cylib', 'ST7528', 'API')
+APPLICATION = os.path.join(ROOT, 'firmware', 'Reload Pro.cydsn')
+
+
+def font_settings():
+    """Returns (bpp, rle) as font.h has them."""
+    header = open(os.path.join(COMPONENT, 'font.h')).read()
+    values = dict(re.findall(r'#define (FONT_GLYPH_PLANES|FONT_GLYPH_RLE) (\d+)', header))
+    return int(values['FONT_GLYPH_PLANES']), int(values['FONT_GLYPH_RLE']) != 0
+
+
+def make_font():
+    bpp, rle = font_settings()
+    text, message = fontmaker.make_font(os.path.join(TOOLS, 'reload font.png'), bpp, rle)
+    return [text], message
+
+
+def make_assets():
+    source, header, message = assetpacker.make_assets()
+    return [source, header], message
+
+
+def gperf(keywords):
+    # Run from the top so the #line directives name tools/<keywords>
+    return subprocess.check_output(['gperf', '-m', '100', 'tools/' + keywords], cwd=ROOT)
+
+
+def make_commands():
+    text = gperf('serial_keywords')
+    return [text.decode('ascii')], 'Command table has %d keywords' % text.count(b'{"')
+
+
+def make_scpi_commands():
+    text = gperf('scpi_keywords')
+    return [text.decode('ascii')], 'SCPI table has %d headers' % text.count(b'{"')
+
+
+# Each generator returns the text of its outputs, in order, and a line about them
+OUTPUTS = [
+    ([os.path.join(COMPONENT, 'font.c')], make_font),
+    ([os.path.join(APPLICATION, 'assets.c'), os.path.join(APPLICATION, 'assets.h')], make_assets),
+    ([os.path.join(APPLICATION, 'commands.h')], make_commands),
+    ([os.path.join(APPLICATION, 'scpi_commands.h')], make_scpi_commands),
+]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--check', action='store_true', help='Report stale outputs instead of writing them')
+    args = parser.parse_args()
+
+    stale = 0
+    for paths, generate in OUTPUTS:
+        texts, message = generate()
+        for path, text in zip(paths, texts):
+            name = os.path.relpath(path, ROOT)
+            old = open(path).read() if os.path.exists(path) else None
+            if old == text:
+                print('%s: up to date' % name)
+                continue
+            stale += 1
+            if args.check:
+                print('%s: stale' % name)
+            else:
+                open(path, 'w').write(text)
+                print('%s: written. %s' % (name, message))
+    sys.exit(1 if args.check and stale else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,169 @@
+"""Keeps a database of units' calibrations, and pushes them back in bulk.
+
+Each unit's calibration is read with 'cal export' and kept, by the serial
+number 'id' reports, in one JSON file:
+
+    python tools/caldb.py pull /dev/ttyACM0 /dev/ttyACM1 ...
+
+adds an entry for each unit whose calibration changed since the last one
+stored for it. 'push' writes each unit's latest entry back with 'cal import',
+after a reflash or a settings reset; --from gives a serial to push from
+instead, to every unit given, for a unit whose MCU has been replaced. 'list'
+shows what's held, and 'drift' how each unit's gains and offsets have moved
+between its entries, in ppm of the first, to audit the fleet:
+
+    python tools/caldb.py push /dev/ttyACM0 /dev/ttyACM1
+    python tools/caldb.py drift
+
+Entries keep the blob as the unit sent it, in hex, with its fields decoded
+alongside for reading; the hex is what's pushed, checked against its CRC
+first. Units are talked to in parallel, one thread each, and one that fails
+is reported without stopping the rest. Needs pyserial and tools/reloadpro.py.
+"""
+from __future__ import print_function
+import argparse
+import binascii
+import json
+import os
+import sys
+import time
+
+import reloadpro
+
+
+GAIN_FIELDS = ('dac_high_gain', 'dac_low_gain', 'adc_current_gain', 'adc_voltage_gain')
+OFFSET_FIELDS = ('dac_high_offset', 'dac_low_offset', 'adc_current_offset', 'adc_voltage_offset',
+                 'opamp_offset_trim')
+
+
+def load(path):
+    if not os.path.exists(path):
+        return {}
+    with open(path) as f:
+        return json.load(f)
+
+
+def save(path, database):
+    # Written alongside then renamed, so an interrupted save keeps the old one
+    with open(path + '.tmp', 'w') as f:
+        json.dump(database, f, indent=1, sort_keys=True)
+    os.rename(path + '.tmp', path)
+
+
+def entry_blob(entry):
+    return binascii.unhexlify(entry['blob'])
+
+
+def each_unit(ports, function):
+    """Runs function(unit) on every port at once, and returns (port, result or
+    exception) for each."""
+    group = reloadpro.Group(ports)
+    try:
+        def guarded(unit):
+            try:
+                return function(unit)
+            except (reloadpro.UnitError, ValueError) as e:
+                return e
+        return list(zip(ports, group.each(guarded)))
+    finally:
+        group.close()
+
+
+def pull(database, ports):
+    def export(unit):
+        version, _, serial = unit.identify()
+        blob = unit.cal_export()
+        return serial, version, blob
+
+    changed = False
+    for port, result in each_unit(ports, export):
+        if isinstance(result, Exception):
+            print('%s: %s' % (port, result), file=sys.stderr)
+            continue
+        serial, version, blob = result
+        entries = database.setdefault(serial, [])
+        if entries and entry_blob(entries[-1]) == blob:
+            print('%s: %s unchanged' % (port, serial))
+            continue
+        entries.append({
+            'time': time.strftime('%Y-%m-%dT%H:%M:%S'),
+            'firmware': version,
+            'blob': binascii.hexlify(blob).decode('ascii'),
+            'fields': reloadpro.cal_blob_decode(blob),
+        })
+        changed = True
+        print('%s: %s stored, entry %d' % (port, serial, len(entries)))
+    return changed
+
+
+def push(database, ports, source=None):
+    if source is not None and source not in database:
+        raise SystemExit('no calibration stored for %s' % source)
+
+    def restore(unit):
+        _, _, serial = unit.identify()
+        entries = database.get(source or serial)
+        if not entries:
+            raise ValueError('no calibration stored for %s' % serial)
+        unit.cal_import(entry_blob(entries[-1]), force=source is not None)
+        return serial
+
+    failed = 0
+    for port, result in each_unit(ports, restore):
+        if isinstance(result, Exception):
+            print('%s: %s' % (port, result), file=sys.stderr)
+            failed += 1
+        else:
+            print('%s: %s pushed from %s' % (port, result, source or result))
+    return failed
+
+
+def show(database):
+    for serial in sorted(database):
+        entries = database[serial]
+        fields = entries[-1]['fields']
+        print('%s  %d entries, last %s  cal at %dC, trim %d' % (
+            serial, len(entries), entries[-1]['time'], fields['cal_temperature'], fields['opamp_offset_trim']))
+
+
+def drift(database):
+    for serial in sorted(database):
+        entries = database[serial]
+        if len(entries) < 2:
+            continue
+        first = entries[0]['fields']
+        print(serial)
+        for entry in entries[1:]:
+            fields = entry['fields']
+            gains = ['%s %+.0fppm' % (name, 1e6 * (fields[name] - first[name]) / first[name])
+                     for name in GAIN_FIELDS if first[name]]
+            offsets = ['%s %+d' % (name, fields[name] - first[name])
+                       for name in OFFSET_FIELDS if fields[name] != first[name]]
+            print('  %s  %s' % (entry['time'], ', '.join(gains + offsets)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('action', choices=('pull', 'push', 'list', 'drift'))
+    parser.add_argument('ports', nargs='*', help='Serial ports, one per unit, for pull and push')
+    parser.add_argument('--db', default='calibration.json', help='Database file (default %(default)s)')
+    parser.add_argument('--from', dest='source', help='Push this serial\'s calibration to every unit')
+    args = parser.parse_args()
+
+    database = load(args.db)
+    if args.action in ('pull', 'push') and not args.ports:
+        parser.error('%s needs one or more ports' % args.action)
+    if args.action == 'pull':
+        if pull(database, args.ports):
+            save(args.db, database)
+    elif args.action == 'push':
+        if push(database, args.ports, args.source):
+            sys.exit(1)
+    elif args.action == 'list':
+        show(database)
+    else:
+        drift(database)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,133 @@
+"""Reads back the on-device log as CSV.
+
+Sends 'log dump' and decodes the rows it answers with, oldest first:
+
+    python tools/datalog.py /dev/ttyACM0 > run.csv
+
+or decodes rows saved earlier with --save:
+
+    python tools/datalog.py --file run.bin > run.csv
+
+Each line is the time in seconds since logging started, then milliamps and
+millivolts. A row is checked against its CRC and skipped if it's damaged. The
+row layout is datalog_row in firmware/Reload Pro.cydsn/tasks.h: samples are
+varints, the first in each row as is and the rest as zig-zag differences, at
+an implicit fixed interval from the row's timestamp. Needs pyserial unless
+reading a file.
+"""
+from __future__ import print_function
+import argparse
+import struct
+import sys
+
+
+DEFAULT_BAUD = 115200
+
+ROW_SIZE = 128
+HEADER = struct.Struct('<IHHBBHI')  # sequence, count, crc, format, used, interval, timestamp
+FORMAT = 2
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16 CCITT, as crc16_update() in the firmware."""
+    for byte in bytearray(data):
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def read_varint(data, pos):
+    """Returns (value, position after it)."""
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode_row(row):
+    """Returns (sequence, [(ms, mA, mV)]), or None for a row that's damaged or
+    in an older format."""
+    row = bytearray(row)
+    sequence, count, crc, fmt, used, interval, timestamp = HEADER.unpack_from(bytes(row))
+    if sequence == 0 or fmt != FORMAT or used > ROW_SIZE - HEADER.size:
+        return None
+    if crc16(row[8:], crc16(row[:6])) != crc:
+        return None
+
+    data = row[HEADER.size:HEADER.size + used]
+    samples = []
+    pos = current = voltage = 0
+    for i in range(count):
+        a, pos = read_varint(data, pos)
+        b, pos = read_varint(data, pos)
+        if i == 0:
+            current, voltage = a, b
+        else:
+            current += unzigzag(a)
+            voltage += unzigzag(b)
+        samples.append((timestamp + i * interval, current, voltage))
+    return sequence, samples
+
+
+def read_dump(port, baud, timeout):
+    import serial
+    unit = serial.Serial(port, baud, timeout=timeout)
+    unit.reset_input_buffer()
+    unit.write(b'log dump\r\n')
+    reply = unit.readline().decode('ascii', 'replace').split()
+    if len(reply) != 3 or reply[:2] != ['log', 'dump']:
+        raise IOError('unexpected answer to log dump: %s' % ' '.join(reply))
+    rows = int(reply[2])
+    data = unit.read(rows * ROW_SIZE)
+    if len(data) < rows * ROW_SIZE:
+        raise IOError('expected %d rows, got %d bytes' % (rows, len(data)))
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('port', nargs='?', help='Serial port of the unit')
+    parser.add_argument('--file', help='Decode rows saved with --save instead')
+    parser.add_argument('--save', help='Also write the raw rows to this file')
+    parser.add_argument('--baud', type=int, default=DEFAULT_BAUD)
+    parser.add_argument('--timeout', type=float, default=2.0, help='Seconds to wait for the dump')
+    args = parser.parse_args()
+    if (args.port is None) == (args.file is None):
+        parser.error('give a serial port or --file')
+
+    if args.file:
+        data = open(args.file, 'rb').read()
+    else:
+        data = read_dump(args.port, args.baud, args.timeout)
+    if args.save:
+        open(args.save, 'wb').write(data)
+
+    rows = []
+    damaged = 0
+    for offset in range(0, len(data) - ROW_SIZE + 1, ROW_SIZE):
+        decoded = decode_row(data[offset:offset + ROW_SIZE])
+        if decoded is None:
+            damaged += 1
+        else:
+            rows.append(decoded)
+
+    print('seconds,mA,mV')
+    for _, samples in sorted(rows):
+        for ms, current, voltage in samples:
+            print('%.3f,%d,%d' % (ms / 1000.0, current, voltage))
+    if damaged:
+        print('%d rows skipped' % damaged, file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,76 @@
+"""Measures load step edges at each of the opamp's power levels.
+
+For each level, steps the current between --low and --high milliamps, both
+ways, with the on-device capture taking the step response, and reports the
+current's 10-90% edge and the voltage's recovery in microseconds:
+
+    python tools/edges.py /dev/ttyACM0 --low 100 --high 2000
+
+The edge is resolved to the capture's interval between scans, so an edge
+faster than one scan shows as 0; --repeat steps each way that many times
+and reports the median. The opamp is left on auto afterwards, which runs it
+at high power for the transient generator and low power for a static load.
+Run it against the supply the load will see in use: its source impedance and
+leads shape the edges as much as the loop does. Needs pyserial and
+tools/reloadpro.py.
+"""
+from __future__ import print_function
+import argparse
+import time
+
+import reloadpro
+
+
+LEVELS = ('low', 'medium', 'high')
+SETTLE = 0.2  # Seconds at each current before the step
+
+
+def step(unit, start, end, depth):
+    """Sets start, then steps to end with a capture armed on the setpoint,
+    and returns the capture_step_dict()."""
+    unit.set(start)
+    time.sleep(SETTLE)
+    unit.command('capture setpoint %d' % depth)
+    unit.command('capture step')
+    unit.set(end)
+    return unit.wait_capture(timeout=5)
+
+
+def median(values):
+    ordered = sorted(values)
+    return ordered[len(ordered) // 2]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('port', help='Serial port of the unit')
+    parser.add_argument('--low', type=int, default=100, help='Current before a rising step, mA (default %(default)s)')
+    parser.add_argument('--high', type=int, default=1000, help='Current after it, mA (default %(default)s)')
+    parser.add_argument('--repeat', type=int, default=5, help='Steps each way per level (default %(default)s)')
+    parser.add_argument('--depth', type=int, default=32, help='Scans per capture (default %(default)s)')
+    args = parser.parse_args()
+
+    unit = reloadpro.Unit(args.port)
+    results = []
+    try:
+        for level in LEVELS:
+            unit.command('output opamp %s' % level)
+            for name, start, end in (('rise', args.low, args.high), ('fall', args.high, args.low)):
+                steps = [step(unit, start, end, args.depth) for _ in range(args.repeat)]
+                results.append((level, name, median(s['edge'] for s in steps),
+                                median(s['recovery'] for s in steps), median(s['deviation'] for s in steps)))
+    finally:
+        try:
+            unit.set(0)
+            unit.command('output opamp auto')
+        finally:
+            unit.close()
+
+    print('%d mA to %d mA, median of %d' % (args.low, args.high, args.repeat))
+    print('%-8s %-6s %10s %12s %14s' % ('opamp', 'step', 'edge us', 'recovery us', 'deviation mV'))
+    for level, name, edge, recovery, deviation in results:
+        print('%-8s %-6s %10d %12d %14d' % (level, name, edge, recovery, deviation))
+
+
+if __name__ == '__main__':
+    main()
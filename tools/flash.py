@@ -0,0 +1,309 @@
+"""Updates the firmware on several loads at once, one serial port each.
+
+Speaks the Cypress bootloader protocol to the bootloader in
+firmware/Bootloader.cydsn, using the .cyacd file PSoC Creator writes next to
+the application's .hex:
+
+    python tools/flash.py "Reload Pro.cyacd" /dev/ttyACM0 /dev/ttyACM1 ...
+
+Each unit is asked over its application's 'bootload' command to restart into
+the bootloader; one that's already there (button held at reset, or a failed
+update) simply doesn't answer and is bootloaded as it is. The rate can be
+raised for the transfer with --baud. Rows that already match are skipped, and
+the rest are sent lzfx compressed, where the bootloader supports it. Each row
+is verified after programming, and the whole image before the unit is told
+to start it. Needs pyserial.
+"""
+from __future__ import print_function
+import argparse
+import struct
+import sys
+import threading
+import time
+
+import serial
+
+
+SOP = 0x01
+EOP = 0x17
+
+COMMAND_CHECKSUM = 0x31
+COMMAND_ENTER = 0x38
+COMMAND_PROGRAM = 0x39
+COMMAND_VERIFY = 0x3A
+COMMAND_EXIT = 0x3B
+# Extensions handled by this project's bootloader transport
+COMMAND_PROGRAM_COMPRESSED = 0x40
+COMMAND_ROW_HASH = 0x41
+
+ERR_CMD = 0x05
+STATUS_NAMES = {
+    0x01: 'key', 0x02: 'verify', 0x03: 'length', 0x04: 'data', 0x05: 'command',
+    0x06: 'device', 0x07: 'version', 0x08: 'checksum', 0x09: 'array',
+    0x0A: 'row', 0x0B: 'protected', 0x0C: 'app', 0x0D: 'active', 0x0F: 'unknown',
+}
+
+DEFAULT_BAUD = 115200  # What both the application and bootloader start at
+BOOT_WAIT = 0.5  # Seconds for the unit to reset into the bootloader
+
+# The bootloadable's metadata is the last 64 bytes of flash. The bootloader
+# leaves its active and verified flags out of that row's verify checksum.
+METADATA_ROW = 255
+METADATA_EXCLUDED = (64 + 16, 64 + 17)
+
+LZFX_MAX_OFFSET = 1 << 13
+LZFX_MAX_MATCH = 7 + 255 + 2
+
+
+class BootloaderError(Exception):
+    pass
+
+
+def read_cyacd(path):
+    """Returns (silicon id, silicon revision, [(array, row, data)])."""
+    lines = [line.strip() for line in open(path) if line.strip()]
+    header = bytearray.fromhex(lines[0])
+    silicon_id, = struct.unpack('>I', bytes(header[:4]))
+    rows = []
+    for line in lines[1:]:
+        record = bytearray.fromhex(line.lstrip(':'))
+        if sum(record) & 0xFF:
+            raise ValueError('Bad checksum in %s: %s' % (path, line))
+        array, row, length = struct.unpack('>BHH', bytes(record[:5]))
+        rows.append((array, row, bytes(record[5:5 + length])))
+    return silicon_id, header[4], rows
+
+
+def lzfx_compress(data):
+    """Greedy LZF/lzfx compression, for lzfx_decompress in the bootloader."""
+    data = bytearray(data)
+    out = bytearray()
+    literals = bytearray()
+
+    def flush():
+        while literals:
+            run = literals[:32]
+            out.append(len(run) - 1)
+            out.extend(run)
+            del literals[:32]
+
+    i = 0
+    while i < len(data):
+        best_len, best_ref = 0, 0
+        for ref in range(max(0, i - LZFX_MAX_OFFSET), i):
+            length = 0
+            while (i + length < len(data) and length < LZFX_MAX_MATCH
+                   and data[ref + length] == data[i + length]):
+                length += 1
+            if length > best_len:
+                best_len, best_ref = length, ref
+        if best_len < 3:
+            literals.append(data[i])
+            i += 1
+            continue
+
+        flush()
+        offset = i - best_ref - 1
+        length = best_len - 2
+        if length < 7:
+            out.append((length << 5) | (offset >> 8))
+        else:
+            out.append((7 << 5) | (offset >> 8))
+            out.append(length - 7)
+        out.append(offset & 0xFF)
+        i += best_len
+    flush()
+    return bytes(out)
+
+
+def row_crc(data):
+    """CRC-16 CCITT with an initial 0xFFFF, as the row hash command uses."""
+    crc = 0xFFFF
+    for byte in bytearray(data):
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def row_checksum(row, data):
+    """What the bootloader's verify row command should report for data."""
+    data = bytearray(data)
+    total = sum(data)
+    if row == METADATA_ROW:
+        total -= sum(data[i] for i in METADATA_EXCLUDED)
+    return (1 + ~total) & 0xFF
+
+
+def packet_checksum(data):
+    return (1 + ~sum(bytearray(data))) & 0xFFFF
+
+
+class Unit(object):
+    """One load on one serial port."""
+
+    def __init__(self, port, timeout):
+        self.port = port
+        self.serial = serial.Serial(port, DEFAULT_BAUD, timeout=timeout)
+        self.bytes_sent = 0
+
+    def log(self, message):
+        print('%s: %s' % (self.port, message))
+        sys.stdout.flush()
+
+    def read_line(self):
+        return self.serial.readline().decode('ascii', 'replace').strip()
+
+    def write_line(self, line):
+        self.serial.write((line + '\r\n').encode('ascii'))
+
+    def enter_from_application(self, app_baud):
+        """Asks a running application to restart into the bootloader. Returns
+        False if nothing answered, as when the bootloader is already running."""
+        self.serial.baudrate = app_baud
+        self.serial.reset_input_buffer()
+        self.write_line('bootload')
+        reply = self.read_line().split()
+        if len(reply) != 2 or reply[0] != 'bootload':
+            self.serial.baudrate = DEFAULT_BAUD
+            return False
+        self.write_line('bootload %s' % reply[1])
+        if self.read_line() != 'bootload ok':
+            raise BootloaderError('application refused bootload')
+        time.sleep(BOOT_WAIT)
+        self.serial.baudrate = DEFAULT_BAUD
+        self.serial.reset_input_buffer()
+        return True
+
+    def negotiate_baud(self, baud):
+        """The bootloader's 'baud' handshake: ask at the old rate, confirm with
+        the same line at the new one."""
+        line = 'baud %d' % baud
+        self.write_line(line)
+        if self.read_line() != line:
+            raise BootloaderError('bootloader refused %s' % line)
+        self.serial.flush()
+        self.serial.baudrate = baud
+        time.sleep(0.01)
+        self.write_line(line)
+        if self.read_line() != line + ' ok':
+            raise BootloaderError('%s not confirmed' % line)
+
+    def command(self, command, data=b''):
+        """Sends a packet and returns (status, data) from the answer."""
+        packet = bytearray([SOP, command]) + struct.pack('<H', len(data)) + bytearray(data)
+        packet += struct.pack('<HB', packet_checksum(packet), EOP)
+        self.serial.write(bytes(packet))
+        self.bytes_sent += len(packet)
+        if command == COMMAND_EXIT:
+            return 0, b''
+
+        header = bytearray(self.serial.read(4))
+        if len(header) < 4 or header[0] != SOP:
+            raise BootloaderError('no answer to command 0x%02x' % command)
+        length, = struct.unpack('<H', bytes(header[2:4]))
+        rest = bytearray(self.serial.read(length + 3))
+        if len(rest) < length + 3 or rest[-1] != EOP:
+            raise BootloaderError('short answer to command 0x%02x' % command)
+        body = rest[:length]
+        checksum, = struct.unpack('<H', bytes(rest[length:length + 2]))
+        if checksum != packet_checksum(header + body):
+            raise BootloaderError('bad checksum answering command 0x%02x' % command)
+        return header[1], bytes(body)
+
+    def expect(self, command, data=b''):
+        status, body = self.command(command, data)
+        if status != 0:
+            raise BootloaderError('command 0x%02x failed: %s' % (command, STATUS_NAMES.get(status, status)))
+        return body
+
+
+def flash(unit, image, args, results):
+    silicon_id, silicon_rev, rows = image
+    start = time.time()
+    programmed = skipped = 0
+    try:
+        if not args.no_enter:
+            if unit.enter_from_application(args.app_baud):
+                unit.log('restarted into the bootloader')
+        if args.baud != DEFAULT_BAUD:
+            unit.negotiate_baud(args.baud)
+
+        device_id, device_rev = struct.unpack('<IB', unit.expect(COMMAND_ENTER)[:5])
+        if device_id != silicon_id or device_rev != silicon_rev:
+            raise BootloaderError('image is for silicon %08x rev %d, unit is %08x rev %d'
+                                  % (silicon_id, silicon_rev, device_id, device_rev))
+
+        extensions = not args.plain
+        for array, row, data in rows:
+            address = struct.pack('<BH', array, row)
+            if extensions and not args.all:
+                status, body = unit.command(COMMAND_ROW_HASH, address)
+                if status == ERR_CMD:
+                    unit.log('bootloader has no row hash; sending every row uncompressed')
+                    extensions = False
+                elif status == 0 and struct.unpack('<H', body)[0] == row_crc(data):
+                    skipped += 1
+                    continue
+
+            compressed = lzfx_compress(data) if extensions else data
+            if extensions and len(compressed) < len(data):
+                status, _ = unit.command(COMMAND_PROGRAM_COMPRESSED, address + compressed)
+                if status == ERR_CMD:
+                    extensions = False
+                elif status != 0:
+                    raise BootloaderError('row %d: %s' % (row, STATUS_NAMES.get(status, status)))
+            if not extensions or len(compressed) >= len(data):
+                unit.expect(COMMAND_PROGRAM, address + data)
+
+            checksum = bytearray(unit.expect(COMMAND_VERIFY, address))[0]
+            if checksum != row_checksum(row, data):
+                raise BootloaderError('row %d verify failed' % row)
+            programmed += 1
+
+        if bytearray(unit.expect(COMMAND_CHECKSUM))[0] != 1:
+            raise BootloaderError('application checksum failed')
+        unit.command(COMMAND_EXIT)
+        error = None
+    except (BootloaderError, serial.SerialException) as e:
+        error = str(e)
+
+    elapsed = time.time() - start
+    results[unit.port] = (error, programmed, skipped, unit.bytes_sent, elapsed)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('image', help='Application .cyacd file')
+    parser.add_argument('ports', nargs='+', help='Serial ports, one per unit')
+    parser.add_argument('--baud', type=int, default=DEFAULT_BAUD, help='Rate to bootload at (default %(default)s)')
+    parser.add_argument('--app-baud', type=int, default=DEFAULT_BAUD, help='Rate the application is running at')
+    parser.add_argument('--no-enter', action='store_true', help="Don't send 'bootload' to the application first")
+    parser.add_argument('--all', action='store_true', help='Program every row, even ones that already match')
+    parser.add_argument('--plain', action='store_true', help='Use only standard bootloader commands')
+    parser.add_argument('--timeout', type=float, default=1.0, help='Seconds to wait for each answer')
+    args = parser.parse_args()
+
+    image = read_cyacd(args.image)
+    units = [Unit(port, args.timeout) for port in args.ports]
+    results = {}
+    threads = [threading.Thread(target=flash, args=(unit, image, args, results)) for unit in units]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    print()
+    print('%-16s %6s %6s %8s %7s %8s  %s' % ('port', 'rows', 'skip', 'bytes', 'secs', 'bytes/s', 'result'))
+    failed = 0
+    for unit in units:
+        error, programmed, skipped, sent, elapsed = results[unit.port]
+        print('%-16s %6d %6d %8d %7.1f %8d  %s' % (unit.port, programmed, skipped, sent, elapsed,
+                                                 sent / elapsed if elapsed else 0, error or 'ok'))
+        failed += error is not None
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
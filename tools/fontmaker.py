@@ -1,8 +1,22 @@
+from __future__ import print_function
+import argparse
+try:
+    from StringIO import StringIO
+except ImportError:
+    from io import StringIO
 from PIL import Image
 
 
 GLYPH_WIDTH = 12  # Pixels
 GLYPH_ROWS = 2  # Bytes
+GLYPH_OFFSET = 32  # The character of the first glyph, FONT_GLYPH_OFFSET in font.h
+# Big digits are drawn in the image as 3x3 tiles of glyphs, from this one, with
+# each digit's tiles on consecutive rows of BIG_ROW_WIDTH glyphs
+BIG_DIGIT_GLYPH = 96
+BIG_ROW_WIDTH = 32
+BIG_TILES = 3
+BIG_PERIOD_GLYPH = 0xDE - GLYPH_OFFSET  # The bottom of the big '.'
+BIG_CHARACTERS = '0123456789.'  # In the order of FONT_BIG_CHARACTERS in font.h
 
 
 def build_column(img, x, y):
@@ -12,24 +26,195 @@ def build_column(img, x, y):
     return ret
 
 
-def main():
-    img = Image.open("reload font.png")
-    width, height = img.size
-    x_glyphs = width / GLYPH_WIDTH
-    y_glyphs = height / (GLYPH_ROWS * 8)
+def build_gray_column(img, x, y, bpp):
+    """Returns the bit planes for one column of a grayscale glyph, MSB first.
+
+    The ST7528 takes 4 bit planes per column; the ST7528 component expands
+    2 stored planes to 4 by repeating them, so level n of 3 becomes n * 5 of 15.
+    """
+    levels = [(255 - img.getpixel((x, y + (7 - i)))) >> (8 - bpp) for i in range(8)]
+    planes = []
+    for plane in range(bpp):
+        bit = bpp - 1 - plane
+        ret = 0
+        for level in levels:
+            ret = (ret << 1) | ((level >> bit) & 1)
+        planes.append(ret)
+    return planes
+
+
+def rle_encode(data):
+    """Run-length encodes one glyph row for the ST7528 component.
 
-    out = open('font.c', 'w')
-    out.write("const char glyphs[%d][%d][%d] = {\n" % (x_glyphs * y_glyphs, GLYPH_ROWS, GLYPH_WIDTH))
+    A control byte below 0x80 is followed by that many plus one literal bytes;
+    0x80 and above repeats the next byte (control - 0x80 + 2) times.
+    """
+    out = []
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 129:
+            run += 1
+        if run >= 2:
+            out.extend((0x80 + run - 2, data[i]))
+            i += run
+        else:
+            start = i
+            while i < len(data) and i - start < 128 and not (i + 1 < len(data) and data[i + 1] == data[i]):
+                i += 1
+            out.append(i - start - 1)
+            out.extend(data[start:i])
+    return out
+
+
+def write_rle(out, glyphs):
+    """Writes the glyphs run-length encoded, a row at a time, with an index."""
+    offsets = []
+    data = []
+    for glyph in glyphs:
+        offsets.append(len(data))
+        for row in glyph:
+            data.extend(rle_encode(row))
+
+    out.write("const unsigned short glyph_offsets[%d] = {\n" % len(offsets))
+    for i in range(0, len(offsets), 16):
+        out.write("    %s,\n" % (", ".join("%d" % offset for offset in offsets[i:i + 16])))
+    out.write("};\n\n")
+    out.write("const unsigned char glyph_data[%d] = {\n" % len(data))
+    for i in range(0, len(data), 16):
+        out.write("    %s,\n" % (", ".join("0x%X" % byte for byte in data[i:i + 16])))
+    out.write("};\n")
+    return len(data) + len(offsets) * 2
 
+
+def load_glyphs(image, bpp=1):
+    """Returns every glyph in the font image, as GLYPH_ROWS lists of column bytes."""
+    img = Image.open(image)
+    if bpp > 1:
+        img = img.convert('L')
+    width, height = img.size
+    x_glyphs = width // GLYPH_WIDTH
+    y_glyphs = height // (GLYPH_ROWS * 8)
+
+    glyphs = []
     for y in range(y_glyphs):
         for x in range(x_glyphs):
-            out.write("    {\n")
+            rows = []
+            for row in range(GLYPH_ROWS):
+                if bpp == 1:
+                    columns = [build_column(img, x * GLYPH_WIDTH + i, (y * GLYPH_ROWS + row) * 8) for i in range(GLYPH_WIDTH)]
+                else:
+                    columns = []
+                    for i in range(GLYPH_WIDTH):
+                        columns.extend(build_gray_column(img, x * GLYPH_WIDTH + i, (y * GLYPH_ROWS + row) * 8, bpp))
+                rows.append(columns)
+            glyphs.append(rows)
+    return glyphs
+
+
+def render_text(glyphs, text):
+    """Returns text as Display_DrawText draws it with monochrome glyphs from
+    load_glyphs(): GLYPH_ROWS lists of column bytes, one column after another."""
+    rows = [[] for _ in range(GLYPH_ROWS)]
+    for c in text:
+        for row, columns in zip(rows, glyphs[ord(c) - GLYPH_OFFSET]):
+            row.extend(columns)
+    return rows
+
+
+def big_characters(glyphs):
+    """Takes the big digits and the big '.' out of the glyphs, blanking their
+    tiles, and returns each of BIG_CHARACTERS as GLYPH_ROWS * BIG_TILES rows of
+    column bytes. A digit is its tiles side by side, and '.' one glyph wide,
+    blank but for its bottom tile, which stays in the glyphs."""
+    blank = [[0] * len(glyphs[0][0]) for _ in range(GLYPH_ROWS)]
+    characters = []
+    for digit in range(10):
+        rows = []
+        for vglyph in range(BIG_TILES):
+            tiles = [BIG_DIGIT_GLYPH + digit * BIG_TILES + vglyph * BIG_ROW_WIDTH + hglyph for hglyph in range(BIG_TILES)]
             for row in range(GLYPH_ROWS):
-                columns = [build_column(img, x * GLYPH_WIDTH + i, (y * GLYPH_ROWS + row) * 8) for i in range(GLYPH_WIDTH)]
+                rows.append(sum((glyphs[tile][row] for tile in tiles), []))
+            for tile in tiles:
+                glyphs[tile] = blank
+        characters.append(rows)
+    characters.append(blank * (BIG_TILES - 1) + glyphs[BIG_PERIOD_GLYPH])
+    return characters
+
+
+def write_array(out, declaration, values, format="0x%X"):
+    out.write("%s = {\n" % declaration)
+    for i in range(0, len(values), 16):
+        out.write("    %s,\n" % (", ".join(format % value for value in values[i:i + 16])))
+    out.write("};\n")
+
+
+def write_big(out, characters, bpp, rle):
+    """Writes the big characters with a width and an index into one array of
+    their rows, top first, each row's columns contiguous so the component
+    sends a row in one go. Returns the bytes they take."""
+    offsets = []
+    data = []
+    for rows in characters:
+        offsets.append(len(data))
+        for row in rows:
+            data.extend(rle_encode(row) if rle else row)
+
+    widths = [len(rows[0]) // bpp for rows in characters]
+    out.write("\n")
+    write_array(out, "const unsigned char big_widths[%d]" % len(widths), widths, "%d")
+    out.write("\n")
+    write_array(out, "const unsigned short big_offsets[%d]" % len(offsets), offsets, "%d")
+    out.write("\n")
+    write_array(out, "const unsigned char big_data[%d]" % len(data), data)
+    return len(data) + len(offsets) * 2 + len(widths)
+
+
+def font_text(glyphs, bpp=1, rle=False):
+    """Returns the text of font.c for the glyphs load_glyphs() returned, and
+    a line about its size."""
+    characters = big_characters(glyphs)
+    plain_size = len(glyphs) * GLYPH_ROWS * GLYPH_WIDTH * bpp
+    plain_size += sum(len(row) for rows in characters for row in rows)
+
+    out = StringIO()
+    if rle:
+        size = write_rle(out, glyphs)
+    else:
+        out.write("const char glyphs[%d][%d][%d] = {\n" % (len(glyphs), GLYPH_ROWS, GLYPH_WIDTH * bpp))
+        for rows in glyphs:
+            out.write("    {\n")
+            for columns in rows:
                 out.write("        {%s},\n" % (", ".join("0x%X" % column for column in columns)))
             out.write("    },\n")
+        out.write("};\n")
+        size = len(glyphs) * GLYPH_ROWS * GLYPH_WIDTH * bpp
+    size += write_big(out, characters, bpp, rle)
+    if rle:
+        return out.getvalue(), "Font is %d bytes, down from %d" % (size, plain_size)
+    return out.getvalue(), "Font is %d bytes" % size
 
-    out.write("};\n")
+
+def make_font(image, bpp=1, rle=False):
+    """Returns the text of font.c for a font image, and a line about its size."""
+    return font_text(load_glyphs(image, bpp), bpp, rle)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Converts a font image to font.c for the ST7528 component.")
+    parser.add_argument('--bpp', type=int, choices=(1, 2, 4), default=1,
+                        help="Bits per pixel to store. 2 and 4 keep anti-aliased edges, "
+                             "at two or four times the flash.")
+    parser.add_argument('--rle', action='store_true',
+                        help="Run-length encode the glyphs, for about three quarters of the flash. "
+                             "Set FONT_GLYPH_RLE to 1 in font.h to match.")
+    parser.add_argument('image', nargs='?', default="reload font.png")
+    args = parser.parse_args()
+
+    text, message = make_font(args.image, args.bpp, args.rle)
+    open('font.c', 'w').write(text)
+    print(message)
+    print("Set FONT_GLYPH_PLANES to %d in font.h" % args.bpp)
 
 
 if __name__ == '__main__':
@@ -0,0 +1,244 @@
+"""Benchmarks a unit's control loops and protocol against a reference supply.
+
+Runs each measurement on one unit and writes them, with the firmware version
+and serial the unit reports, to a JSON report; given --baseline, an earlier
+report, it also prints each metric beside it, so a change made for speed is
+measured on hardware against the build before it:
+
+    python tools/hil.py /dev/ttyACM0 --out new.json --baseline old.json
+
+The supply goes on the input, set to --supply volts with its current limit
+at --limit milliamps, which has to be below --high: the CV and fault tests
+pull it into current limit, so the load sets the voltage. No scope is
+needed; the load's own capture takes every scan around each event.
+
+  rise      10-90% current edge, in microseconds, of a --low to --high mA
+            setpoint step and back, from 'capture step', --high held to 90%
+            of the supply's limit
+  cv_settle microseconds for the voltage to settle within --band mV after a
+            CV target steps from 90% of the supply to 70% and back,
+            counted from the capture's trigger part way across
+  trip      microseconds from the first scan under the undervoltage limit to
+            the current falling below 10% of the step, with the limit at 80%
+            of the supply and the load stepped past the supply's limit
+  latency   'ping' round trip and the unit's processing time, microseconds,
+            as tools/latency.py measures them
+  stream    records a second sustained streaming every block at --baud,
+            and the fraction of them dropped
+
+Each is the median of --repeat runs, and the table's 90% column their spread.
+A step whose capture missed the event counts as a failed run, and a test
+with only failed runs is left out. Needs pyserial, numpy and
+tools/reloadpro.py.
+"""
+from __future__ import print_function
+import argparse
+import json
+import sys
+import time
+
+import numpy
+
+import latency
+import reloadpro
+
+
+SETTLE = 0.2  # Seconds at each level before a step
+DEPTH = 32  # Scans per capture, the firmware's most
+STREAM_SECONDS = 5.0
+
+
+def summary(values, unit):
+    values = sorted(v for v in values if v is not None)
+    if not values:
+        return None
+    return {'median': values[len(values) // 2], 'p90': values[min(len(values) - 1, int(0.9 * len(values)))],
+            'runs': len(values), 'unit': unit}
+
+
+def arm_and_step(unit, arm, command):
+    unit.command(arm)
+    unit.command(command)
+    return unit.wait_capture(timeout=5)
+
+
+def rise_times(unit, low, high, repeat):
+    edges = {'rise_up': [], 'rise_down': []}
+    for _ in range(repeat):
+        for name, start, end in (('rise_up', low, high), ('rise_down', high, low)):
+            unit.set(start)
+            time.sleep(SETTLE)
+            unit.command('capture setpoint %d' % DEPTH)
+            unit.command('capture step')
+            unit.set(end)
+            edge = unit.wait_capture(timeout=5)['edge']
+            edges[name].append(edge if edge >= 0 else None)
+    return dict((name, summary(values, 'us')) for name, values in edges.items())
+
+
+def settling(capture, final, band):
+    """Microseconds from the trigger until the voltage stays within band mV
+    of final, or None if it never does."""
+    outside = numpy.nonzero(numpy.abs(capture.voltage - final) > band)[0]
+    if len(outside) == 0:
+        return 0
+    if outside[-1] == len(capture) - 1:
+        return None
+    return max(0, int(round(capture.time[outside[-1] + 1] * 1e6)))
+
+
+def cv_settle(unit, supply, band, repeat):
+    high, low = int(supply * 0.9), int(supply * 0.7)
+    results = {'cv_settle_down': [], 'cv_settle_up': []}
+    for _ in range(repeat):
+        for name, start, end, edge in (('cv_settle_down', high, low, 'fall'), ('cv_settle_up', low, high, 'rise')):
+            unit.command('mode cv %dmV' % start)
+            time.sleep(SETTLE)
+            capture = arm_and_step(unit, 'capture %s %d %d %d' % (edge, (start + end) // 2, DEPTH, DEPTH // 4),
+                                   'mode cv %dmV' % end)
+            # The last quarter's mean, as 'capture step' takes the final level
+            final = capture.voltage[-len(capture) // 4:].mean()
+            results[name].append(settling(capture, final, band))
+    unit.command('mode cc')
+    unit.set(0)
+    return dict((name, summary(values, 'us')) for name, values in results.items())
+
+
+def trip_latency(capture, under, step):
+    below = numpy.nonzero(capture.voltage < under)[0]
+    if len(below) == 0:
+        return None
+    off = numpy.nonzero(capture.current[below[0]:] < step / 10)[0]
+    if len(off) == 0:
+        return None
+    return int(round((capture.time[below[0] + off[0]] - capture.time[below[0]]) * 1e6))
+
+
+def trip(unit, supply, low, high, repeat):
+    limits = unit.command('limits')[0].split()
+    over, under = int(limits[1]), int(supply * 0.8)
+    latencies = []
+    try:
+        for _ in range(repeat):
+            unit.command('faults clear')
+            unit.command('limits %dmV %dmV' % (over, under))
+            unit.set(low)
+            unit.command('output on')
+            time.sleep(SETTLE)
+            capture = arm_and_step(unit, 'capture setpoint %d %d' % (DEPTH, DEPTH // 8), 'set %d' % high)
+            latencies.append(trip_latency(capture, under, high))
+            unit.set(0)
+            time.sleep(SETTLE)
+    finally:
+        unit.command('limits %dmV %dmV' % (over, int(limits[2])))
+        unit.command('faults clear')
+    return {'trip': summary(latencies, 'us')}
+
+
+def serial_latency(unit, repeat):
+    samples = [latency.ping(unit, sequence) for sequence in range(repeat * 20)]
+    return {'latency_round_trip': summary([s[0] for s in samples], 'us'),
+            'latency_processing': summary([s[2] for s in samples], 'us')}
+
+
+def stream_rate(unit, baud):
+    unit.connection.set_baud(baud)
+    try:
+        unit.stream(1)
+        unit.take_stream()
+        started = time.time()
+        records, dropped, last = 0, 0, None
+        while time.time() - started < STREAM_SECONDS:
+            time.sleep(0.1)
+            taken = unit.take_stream()
+            if len(taken) == 0:
+                continue
+            sequences = taken['sequence'].astype(numpy.int64)
+            if last is not None:
+                sequences = numpy.concatenate(([last], sequences))
+            dropped += int(((numpy.diff(sequences) - 1) % (1 << 16)).sum())
+            records += len(taken)
+            last = int(taken['sequence'][-1])
+        elapsed = time.time() - started
+    finally:
+        unit.stream(0)
+        unit.connection.set_baud(reloadpro.DEFAULT_BAUD)
+    return {'stream_rate': summary([records / elapsed], 'records/s'),
+            'stream_dropped': summary([dropped / float(records + dropped) if records + dropped else 0], 'fraction')}
+
+
+def compare(report, baseline):
+    print('%-20s %12s %12s %12s %9s' % ('', 'median', '90%', 'baseline', 'change'))
+    for name in sorted(set(report['metrics']) | set(baseline.get('metrics', {}))):
+        now, then = report['metrics'].get(name), baseline.get('metrics', {}).get(name)
+        line = '%-20s %12s %12s' % (name, '%.4g' % now['median'] if now else '-', '%.4g' % now['p90'] if now else '-')
+        if then:
+            line += ' %12s' % ('%.4g' % then['median'])
+            if now and then['median']:
+                line += ' %+8.1f%%' % (100.0 * (now['median'] - then['median']) / then['median'])
+        print(line)
+
+
+TESTS = ('rise', 'cv_settle', 'trip', 'latency', 'stream')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('port', help='Serial port of the unit')
+    parser.add_argument('--supply', type=float, required=True, help='Supply voltage, volts')
+    parser.add_argument('--limit', type=int, required=True, help='Supply current limit, mA')
+    parser.add_argument('--low', type=int, default=100, help='Current before a step, mA (default %(default)s)')
+    parser.add_argument('--high', type=int, default=1000, help='Current after it, mA (default %(default)s)')
+    parser.add_argument('--band', type=int, default=50, help='CV settling band, mV (default %(default)s)')
+    parser.add_argument('--repeat', type=int, default=5, help='Runs of each test (default %(default)s)')
+    parser.add_argument('--baud', type=int, default=460800, help='Rate to stream at (default %(default)s)')
+    parser.add_argument('--test', action='append', choices=TESTS, help='Run only this test; may be repeated')
+    parser.add_argument('--out', default='hil.json', help='Report file (default %(default)s)')
+    parser.add_argument('--baseline', help='Earlier report to compare with')
+    args = parser.parse_args()
+    if args.limit >= args.high:
+        parser.error('the supply limit has to be below --high for the CV and trip tests')
+
+    supply = int(args.supply * 1000)
+    tests = args.test or TESTS
+    unit = reloadpro.Unit(args.port)
+    metrics = {}
+    try:
+        firmware, protocol, serial = unit.identify()
+        if 'rise' in tests:
+            # Short of the supply's limit, so it stays a voltage source
+            metrics.update(rise_times(unit, args.low, min(args.high, args.limit * 9 // 10), args.repeat))
+        if 'cv_settle' in tests:
+            metrics.update(cv_settle(unit, supply, args.band, args.repeat))
+        if 'trip' in tests:
+            metrics.update(trip(unit, supply, args.low, args.high, args.repeat))
+        if 'latency' in tests:
+            metrics.update(serial_latency(unit, args.repeat))
+        if 'stream' in tests:
+            metrics.update(stream_rate(unit, args.baud))
+    finally:
+        try:
+            unit.command('mode cc')
+            unit.set(0)
+        finally:
+            unit.close()
+
+    report = {'firmware': firmware, 'protocol': protocol, 'serial': serial,
+              'time': time.strftime('%Y-%m-%dT%H:%M:%S'),
+              'setup': {'supply_mv': supply, 'limit_ma': args.limit, 'low_ma': args.low, 'high_ma': args.high,
+                        'band_mv': args.band, 'baud': args.baud},
+              'metrics': dict((name, value) for name, value in metrics.items() if value is not None)}
+    with open(args.out, 'w') as f:
+        json.dump(report, f, indent=1, sort_keys=True)
+
+    baseline = {}
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if baseline.get('setup') != report['setup']:
+            print('the baseline was run with another setup: %s' % baseline.get('setup'), file=sys.stderr)
+    compare(report, baseline)
+
+
+if __name__ == '__main__':
+    main()
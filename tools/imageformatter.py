@@ -1,10 +1,12 @@
+"""Converts the splashscreen image to pages in the display's format, for
+assetpacker.py to compress into the asset store."""
 from PIL import Image
-import lzf
 import numpy
 
 
-def main():
-    img = Image.open("splashscreen.gif")
+def splashscreen_pages(image):
+    """Returns the image's display pages, uncompressed, top first."""
+    img = Image.open(image)
 
     # Convert to an array of gray values - data[row, column]
     data = numpy.asarray(img.convert('L'))
@@ -40,28 +42,9 @@ def main():
     # Flatten into pages - pages[page, byte]
     pages = numpy.reshape(pages, (pages.shape[0], -1))
 
-    # Compress each page - pages[page]
-    pages = [lzf.compress(page.tostring('C')) for page in pages]
+    return [page.tostring('C') for page in pages]
 
-    # Neatly format the image for output
-    indexes = [0]
-    for i in range(len(pages)):
-        indexes.append(indexes[i] + len(pages[i]))
-
-    out = open('splashscreen.c', 'w')
-    out.write('#include "splashscreen.h"\n\n')
-    out.write("const uint8 splashscreen_data[] = {\n")
-    for i, page in enumerate(pages):
-        out.write("    // %d-%d: Page %d\n" % (indexes[i], indexes[i + 1] - 1, i))
-        for line in range(0, len(page), 10):
-            value = ''.join('0x%02X, ' % ord(x) for x in page[line:line + 10]).strip()
-            out.write("    %s\n" % (value,))
-    out.write("};\n\n")
-
-    out.write("const int16 splashscreen_indexes[] = {%s};\n" % (', '.join(str(x) for x in indexes)))
-    out.close()
-
-    print "Image output in %d bytes" % (sum(len(page) + 2 for page in pages) + 2,)
 
 if __name__ == '__main__':
-    main()
+    import assetpacker
+    assetpacker.main()
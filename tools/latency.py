@@ -0,0 +1,87 @@
+"""Measures command latency with the firmware's 'ping' command.
+
+Sends --count pings one after another, each once the last has been answered,
+and reports the spread of four times in microseconds:
+
+    python tools/latency.py /dev/ttyACM0 --count 1000
+
+round_trip is from writing the command to having its reply, on the host.
+The rest come from the unit's timestamps: queued is from the UART ISR
+completing the line to the comms task taking it from the ring, processing
+from then to the reply being queued for sending, and outside is what the
+round trip spends beyond both, on the wire, in USB and on the host. --csv
+writes every ping's times as well, to compare runs before and after a
+protocol change. --baud switches the unit to another rate for the run with
+the firmware's 'baud' handshake. Needs pyserial and tools/reloadpro.py.
+"""
+from __future__ import print_function
+import argparse
+import time
+
+import reloadpro
+
+
+COLUMNS = ('round_trip', 'queued', 'processing', 'outside')
+
+
+def ping(unit, sequence):
+    """Returns the (round_trip, queued, processing, outside) microseconds of one ping."""
+    start = time.time()
+    words = unit.send('ping %d' % sequence).line()
+    round_trip = int((time.time() - start) * 1e6)
+    if len(words) != 5 or words[0] != 'ping' or int(words[1]) != sequence:
+        raise reloadpro.UnitError('unexpected answer to ping %d: %s' % (sequence, ' '.join(words)))
+    received, started, sent = (int(word) for word in words[2:])
+    # The unit's clock wraps at 2^32 microseconds
+    queued = (started - received) % (1 << 32)
+    processing = (sent - started) % (1 << 32)
+    return round_trip, queued, processing, round_trip - queued - processing
+
+
+def percentile(ordered, fraction):
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('port', help='Serial port of the unit')
+    parser.add_argument('--count', type=int, default=200, help='Pings to send (default %(default)s)')
+    parser.add_argument('--interval', type=float, default=0.0, help='Seconds between pings')
+    parser.add_argument('--baud', type=int, default=reloadpro.DEFAULT_BAUD, help='Rate to run at')
+    parser.add_argument('--csv', help='Also write each ping\'s times to this file')
+    args = parser.parse_args()
+
+    unit = reloadpro.Unit(args.port)
+    samples = []
+    try:
+        if args.baud != reloadpro.DEFAULT_BAUD:
+            unit.connection.set_baud(args.baud)
+        for sequence in range(args.count):
+            samples.append(ping(unit, sequence))
+            if args.interval:
+                time.sleep(args.interval)
+    finally:
+        try:
+            if args.baud != reloadpro.DEFAULT_BAUD:
+                unit.connection.set_baud(reloadpro.DEFAULT_BAUD)
+        finally:
+            unit.close()
+
+    if args.csv:
+        with open(args.csv, 'w') as out:
+            out.write('sequence,%s\n' % ','.join(COLUMNS))
+            for sequence, times in enumerate(samples):
+                out.write('%d,%s\n' % (sequence, ','.join(str(t) for t in times)))
+
+    print('%d pings at %d baud, microseconds' % (len(samples), args.baud))
+    print('%-12s %8s %8s %8s %8s %8s %8s' % ('', 'min', 'median', '90%', '99%', 'max', 'mean'))
+    for i, name in enumerate(COLUMNS):
+        ordered = sorted(sample[i] for sample in samples)
+        if not ordered:
+            break
+        print('%-12s %8d %8d %8d %8d %8d %8d' % (name, ordered[0], percentile(ordered, 0.5), percentile(ordered, 0.9),
+                                                 percentile(ordered, 0.99), ordered[-1], sum(ordered) / len(ordered)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,289 @@
+"""Compiles a load profile into a sequencer step table, and uploads it.
+
+A profile is a list of holds, ramps and loops, in YAML (needs PyYAML):
+
+    - {hold: cc, target: 2A, ms: 600000, until: v < 3V, label: discharge}
+    - {ramp: cc, from: 0A, to: 1A, ms: 500, stairs: 5}
+    - loop: 3
+      body:
+        - {hold: cc, target: 500mA, ms: 1000}
+        - {hold: cc, target: 0A, ms: 1000}
+    - {hold: cr, target: 10ohm, ms: 5000, until: ah 100mAh, goto: discharge, times: 2}
+
+or in CSV, one row each with the columns below; a loop row starts a loop of
+'times' passes and an end row closes it:
+
+    kind,mode,target,to,ms,stairs,until,label,goto,times
+    hold,cc,2A,,600000,,v < 3V,discharge,,
+    loop,,,,,,,,,3
+    ...
+    end,,,,,,,,,
+
+Targets carry their units (A, V, ohm or W, with u, m or k), or are taken in
+those. Conditions are 'v', 'i' or 'p' compared with < or >, or 'ah' or 'wh'
+drawn since the step started, as 'sequence add ... until' takes them; a step
+with one ends when it holds, its ms being the timeout. A goto goes to a
+label's step when the condition holds or, with none, when the time is up,
+'times' times before falling through (always, if not given). A loop of 0
+passes repeats forever.
+
+A ramp becomes 'stairs' steps (default 4) of equal time climbing to its end
+target. In CC, with the unit's slew limiter ('slew') set to the ramp's rate,
+each stair's edge slews into the next, and the ramp comes out straight; the
+rate each ramp needs is listed. The compiled table is checked against the
+unit's 'caps' when a port is given (otherwise this firmware's limits): the
+number of steps, the longest step, the full-range current and voltage and
+the fastest slew. It's written with --out as packed sequence_steps, or with a
+port uploaded in a few binary frames rather than a command a step, and with
+--start played:
+
+    python tools/loadprofile.py soak.yaml /dev/ttyACM0 --start 1
+
+Needs tools/reloadpro.py, and pyserial to upload.
+"""
+from __future__ import print_function
+import argparse
+import csv
+import re
+import sys
+
+import reloadpro
+
+
+# This firmware's caps, for checking without a unit
+DEFAULT_CAPS = {'current_max': 6000, 'voltage_max': 60000, 'slew_max': 6000,
+                'sequence_steps': 8, 'sequence_step_max': 1800000}
+
+MODES = {'cc': 0, 'cv': 1, 'cr': 2, 'cp': 3}
+# Each mode's wire units from SI: microamps, microvolts, milliohms, milliwatts
+MODE_UNITS = {'cc': ('A', 1e6), 'cv': ('V', 1e6), 'cr': ('ohm', 1e3), 'cp': ('W', 1e3)}
+PREFIXES = {'u': 1e-6, 'm': 1e-3, '': 1.0, 'k': 1e3}
+# Condition name to (sequence_until of the below or only form, unit, scale)
+UNTILS = {'v': (1, 'V', 1e6), 'i': (3, 'A', 1e6), 'p': (5, 'W', 1e6),
+          'ah': (7, 'Ah', 1e6), 'wh': (8, 'Wh', 1e6)}
+DEFAULT_STAIRS = 4
+
+
+class ProfileError(Exception):
+    pass
+
+
+def quantity(text, unit, scale):
+    """text, a number with an optional prefix and unit, in the wire units
+    scale gives per SI unit."""
+    match = re.match(r'^\s*([-+]?[0-9]*\.?[0-9]+(?:[eE][-+]?[0-9]+)?)\s*([umk]?)(%s)?\s*$' % unit, str(text))
+    if not match or (match.group(2) and not match.group(3)):
+        raise ProfileError('%r is not a quantity in %s' % (text, unit))
+    return int(round(float(match.group(1)) * PREFIXES[match.group(2)] * scale))
+
+
+def condition(text):
+    """(sequence_until, threshold) for an 'until'."""
+    match = re.match(r'^\s*(v|i|p)\s*([<>])\s*(.+)$', text) or re.match(r'^\s*(ah|wh)\s+(.+)$', text)
+    if not match:
+        raise ProfileError('%r is not a condition' % text)
+    until, unit, scale = UNTILS[match.group(1)]
+    if match.group(1) in ('v', 'i', 'p'):
+        return until + (match.group(2) == '>'), quantity(match.group(3), unit, scale)
+    return until, quantity(match.group(2), unit, scale)
+
+
+def mode_target(mode, text):
+    if mode not in MODES:
+        raise ProfileError('%r is not a mode of %s' % (mode, ', '.join(sorted(MODES))))
+    unit, scale = MODE_UNITS[mode]
+    return quantity(text, unit, scale)
+
+
+class Compiler(object):
+    def __init__(self):
+        self.steps = []
+        self.labels = {}
+        self.gotos = []  # (step, label, times)
+        self.ramps = []  # (first step, last step, microamps per millisecond) of CC ramps
+
+    def step(self, mode, setpoint, ms):
+        self.steps.append({'ms': int(ms), 'mode': mode, 'setpoint': setpoint, 'until': 0, 'threshold': 0,
+                           'jump': -1, 'jumps': 0})
+
+    def end(self, item, first):
+        """Applies an item's label, condition and goto to its steps from
+        first on: the label to the first, the rest to the last."""
+        if item.get('label'):
+            if item['label'] in self.labels:
+                raise ProfileError('label %r is used twice' % item['label'])
+            self.labels[item['label']] = first
+        last = self.steps[-1]
+        if item.get('until'):
+            last['until'], last['threshold'] = condition(item['until'])
+        if item.get('goto'):
+            self.gotos.append((len(self.steps) - 1, item['goto'], int(item.get('times') or 0)))
+
+    def hold(self, item):
+        first = len(self.steps)
+        self.step(item['hold'], mode_target(item['hold'], item['target']), item['ms'])
+        self.end(item, first)
+
+    def ramp(self, item):
+        mode = item['ramp']
+        start, finish = mode_target(mode, item['from']), mode_target(mode, item['to'])
+        stairs = int(item.get('stairs') or DEFAULT_STAIRS)
+        ms = int(item['ms'])
+        if stairs < 1 or ms < stairs:
+            raise ProfileError('a ramp needs a millisecond a stair at least')
+        first = len(self.steps)
+        for i in range(stairs):
+            self.step(mode, start + (finish - start) * (i + 1) // stairs,
+                      ms * (i + 1) // stairs - ms * i // stairs)
+        if mode == 'cc':
+            self.ramps.append((first, len(self.steps) - 1, abs(finish - start) / float(ms)))
+        self.end(item, first)
+
+    def loop(self, item):
+        passes = int(item['loop'])
+        first = len(self.steps)
+        self.items(item.get('body') or [])
+        if len(self.steps) == first:
+            raise ProfileError('a loop needs a body')
+        if passes == 1:
+            return
+        last = self.steps[-1]
+        if last['until'] or last['jump'] >= 0 or any(step == len(self.steps) - 1 for step, _, _ in self.gotos):
+            raise ProfileError("a loop's last step can't have a condition or goto of its own")
+        if passes > 256:
+            raise ProfileError('a loop runs 256 passes at most, or 0 for forever')
+        last['jump'] = first
+        last['jumps'] = 0 if passes == 0 else passes - 1
+
+    def items(self, items):
+        for item in items:
+            kinds = [kind for kind in ('hold', 'ramp', 'loop') if kind in item]
+            if len(kinds) != 1:
+                raise ProfileError('%r is not one of hold, ramp or loop' % (item,))
+            getattr(self, kinds[0])(item)
+
+    def finish(self):
+        for step, label, times in self.gotos:
+            if label not in self.labels:
+                raise ProfileError('no label %r' % label)
+            if times > 255:
+                raise ProfileError('a goto is taken 255 times at most, or 0 for always')
+            self.steps[step]['jump'] = self.labels[label]
+            self.steps[step]['jumps'] = times
+        return self.steps
+
+
+def check(steps, ramps, caps):
+    problems = []
+    if len(steps) > caps['sequence_steps']:
+        problems.append('%d steps, and the unit holds %d' % (len(steps), caps['sequence_steps']))
+    limits = {'cc': caps['current_max'] * 1000, 'cv': caps['voltage_max'] * 1000}
+    for i, step in enumerate(steps):
+        if not 1 <= step['ms'] <= caps['sequence_step_max']:
+            problems.append('step %d lasts %dms, outside 1 to %d' % (i, step['ms'], caps['sequence_step_max']))
+        if step['setpoint'] < 0 or step['setpoint'] > limits.get(step['mode'], 0x7FFFFFFF):
+            problems.append('step %d is set to %d, past the unit\'s range' % (i, step['setpoint']))
+    for first, last, rate in ramps:
+        if rate > caps['slew_max'] * 1000:
+            problems.append('steps %d to %d ramp at %.0fmA/ms, faster than the unit slews' % (first, last, rate / 1000))
+    return problems
+
+
+def pack(steps):
+    return b''.join(reloadpro.SEQUENCE_STEP.pack(step['ms'], step['setpoint'], step['threshold'], MODES[step['mode']],
+                                                 step['until'], step['jump'], step['jumps'])
+                    for step in steps)
+
+
+def load_csv(path):
+    """The CSV rows as the items YAML gives, loops nested."""
+    stack = [[]]
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            row = dict((key.strip(), (value or '').strip()) for key, value in row.items() if key)
+            kind = row.get('kind')
+            if kind == 'loop':
+                item = {'loop': row.get('times') or 0, 'body': []}
+                stack[-1].append(item)
+                stack.append(item['body'])
+            elif kind == 'end':
+                if len(stack) == 1:
+                    raise ProfileError('an end without a loop')
+                stack.pop()
+            elif kind in ('hold', 'ramp'):
+                item = dict((key, value) for key, value in row.items() if value and key not in ('kind', 'mode', 'target', 'to'))
+                item[kind] = row.get('mode')
+                if kind == 'hold':
+                    item['target'] = row.get('target')
+                else:
+                    item['from'], item['to'] = row.get('target'), row.get('to')
+                stack[-1].append(item)
+            else:
+                raise ProfileError('%r is not a kind of row' % kind)
+    if len(stack) != 1:
+        raise ProfileError('a loop without an end')
+    return stack[0]
+
+
+def load(path):
+    if path.endswith('.csv'):
+        return load_csv(path)
+    import yaml
+    with open(path) as f:
+        return yaml.safe_load(f) or []
+
+
+def listing(steps, ramps):
+    for i, step in enumerate(steps):
+        line = '%2d  %-2s %10d  %7dms' % (i, step['mode'], step['setpoint'], step['ms'])
+        if step['until']:
+            line += '  until %s %d' % (reloadpro.SEQUENCE_UNTILS[step['until']], step['threshold'])
+        if step['jump'] >= 0:
+            line += '  goto %d' % step['jump'] + (' x%d' % step['jumps'] if step['jumps'] else '')
+        print(line)
+    for first, last, rate in ramps:
+        print('steps %d to %d ramp at %.3fmA/ms' % (first, last, rate / 1000))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('profile', help='A .yaml or .csv load profile')
+    parser.add_argument('port', nargs='?', help='Serial port of a unit to check against and upload to')
+    parser.add_argument('--out', help='Write the packed step table here')
+    parser.add_argument('--start', type=int, metavar='LOOPS', help='Play it after uploading, 0 for forever')
+    args = parser.parse_args()
+
+    try:
+        compiler = Compiler()
+        compiler.items(load(args.profile))
+        steps = compiler.finish()
+    except (ProfileError, KeyError, ValueError) as e:
+        raise SystemExit('%s: %s' % (args.profile, e))
+
+    unit = reloadpro.Unit(args.port) if args.port else None
+    try:
+        caps = dict(DEFAULT_CAPS)
+        if unit is not None:
+            caps.update(unit.capabilities())
+        listing(steps, compiler.ramps)
+        problems = check(steps, compiler.ramps, caps)
+        for problem in problems:
+            print('%s: %s' % (args.profile, problem), file=sys.stderr)
+        if problems:
+            sys.exit(1)
+
+        table = pack(steps)
+        if args.out:
+            with open(args.out, 'wb') as f:
+                f.write(table)
+        if unit is not None:
+            print('%d steps uploaded' % unit.sequence_upload(table))
+            if args.start is not None:
+                unit.command('sequence start %d' % args.start)
+    finally:
+        if unit is not None:
+            unit.close()
+
+
+if __name__ == '__main__':
+    main()
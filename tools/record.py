@@ -0,0 +1,258 @@
+"""Records the binary stream from one or more units, optionally plotting it live.
+
+Starts streaming on each unit given, a record every --blocks ADC blocks, and
+writes every record to a file per unit until interrupted or --seconds have
+passed:
+
+    python tools/record.py /dev/ttyACM0 /dev/ttyACM1 --out run --plot
+
+writes run-1.csv and run-2.csv, or run-1.h5 and so on with --format hdf5
+(needs h5py). Each row is the time in seconds since the unit's first record,
+its sequence number, microamps, microvolts and the record's flags.
+
+A record is 18 bytes, so 1000 a second needs more than the default 115200
+baud; each unit is switched to --baud for the run, with the firmware's 'baud'
+handshake, and back afterwards. Records the unit had to drop, because the UART
+couldn't keep up, leave gaps in the sequence numbers: each gap is reported as
+it's seen and the totals at the end, along with records that failed their
+CRC. --credit turns on the firmware's flow control, that many records ahead:
+if this end stalls, the unit thins the stream to one record in 16 rather than
+sending into a full buffer, and the records it held back show up as gaps.
+With --sync, the units' Trigger_In and Trigger_Out wired together, their
+timestamps are kept on the first unit's clock, resynced every --sync seconds,
+so the files line up; the seconds column then counts from the first sync. The plot shows the last --window seconds, each line reduced to the minimum
+and maximum of --points buckets so peaks survive the decimation (needs
+matplotlib). Needs pyserial, numpy and tools/reloadpro.py.
+"""
+from __future__ import print_function
+import argparse
+import sys
+import time
+
+import numpy
+
+import reloadpro
+
+
+POLL_INTERVAL = 0.1  # Seconds between taking each unit's records
+PLOT_INTERVAL = 0.25
+REPORT_INTERVAL = 5.0
+SYNC_WARNING_US = 100  # A unit further off than this at a sync is reported
+
+
+class CsvWriter(object):
+    def __init__(self, path):
+        self.file = open(path, 'w')
+        self.file.write('seconds,sequence,uA,uV,flags\n')
+
+    def write(self, seconds, records):
+        columns = numpy.column_stack((seconds, records['sequence'], records['current'],
+                                      records['voltage'], records['flags']))
+        numpy.savetxt(self.file, columns, fmt=['%.6f', '%d', '%d', '%d', '%d'], delimiter=',')
+
+    def close(self):
+        self.file.close()
+
+
+class Hdf5Writer(object):
+    """A resizable dataset per column, appended to as records arrive."""
+
+    COLUMNS = (('seconds', 'f8'), ('sequence', 'u2'), ('current', 'i4'), ('voltage', 'i4'), ('flags', 'u1'))
+
+    def __init__(self, path):
+        import h5py
+        self.file = h5py.File(path, 'w')
+        self.datasets = dict((name, self.file.create_dataset(name, (0,), dtype=dtype, maxshape=(None,), chunks=(4096,)))
+                             for name, dtype in self.COLUMNS)
+        self.datasets['current'].attrs['units'] = 'uA'
+        self.datasets['voltage'].attrs['units'] = 'uV'
+
+    def write(self, seconds, records):
+        length = self.datasets['seconds'].shape[0]
+        for name, _ in self.COLUMNS:
+            values = seconds if name == 'seconds' else records[name]
+            dataset = self.datasets[name]
+            dataset.resize((length + len(values),))
+            dataset[length:] = values
+
+    def close(self):
+        self.file.close()
+
+
+WRITERS = {'csv': ('.csv', CsvWriter), 'hdf5': ('.h5', Hdf5Writer)}
+
+
+class Recording(object):
+    """One unit's stream: timestamps unwrapped, gaps counted, and the last
+    few seconds kept for the plot."""
+
+    def __init__(self, unit, writer, window):
+        self.unit = unit
+        self.writer = writer
+        self.window = window
+        self.epoch = None  # Timestamp seconds count from, if not the first record's
+        self.start = None  # Unwrapped microseconds of the first record, or the epoch
+        self.last_timestamp = None
+        self.last_us = None
+        self.last_sequence = None
+        self.records = 0
+        self.dropped = 0
+        self.gaps = 0
+        self.recent = []
+
+    def take(self):
+        records = self.unit.take_stream()
+        if len(records) == 0:
+            return
+        timestamps = records['timestamp'].astype(numpy.int64)
+        sequences = records['sequence'].astype(numpy.int64)
+        if self.last_timestamp is None:
+            first = int(timestamps[0]) if self.epoch is None else self.epoch
+            self.start = self.last_us = self.last_timestamp = first
+            self.last_sequence = int(sequences[0]) - 1
+
+        # Both wrap, at 2^32 microseconds and 2^16 records
+        steps = numpy.diff(numpy.concatenate(([self.last_timestamp], timestamps))) % (1 << 32)
+        us = self.last_us + numpy.cumsum(steps)
+        skipped = (numpy.diff(numpy.concatenate(([self.last_sequence], sequences))) - 1) % (1 << 16)
+        for i in numpy.nonzero(skipped)[0]:
+            print('%s: %d records dropped before sequence %d at %.3fs'
+                  % (self.unit.name, skipped[i], sequences[i], (us[i] - self.start) / 1e6), file=sys.stderr)
+        self.gaps += numpy.count_nonzero(skipped)
+        self.dropped += int(skipped.sum())
+        self.last_timestamp, self.last_us, self.last_sequence = int(timestamps[-1]), int(us[-1]), int(sequences[-1])
+
+        seconds = (us - self.start) / 1e6
+        self.writer.write(seconds, records)
+        self.records += len(records)
+
+        if self.window:
+            self.recent.append((seconds, records['current'] / 1000.0, records['voltage'] / 1000.0))
+            while len(self.recent) > 1 and self.recent[1][0][0] < seconds[-1] - self.window:
+                del self.recent[0]
+
+    def seconds(self):
+        return (self.last_us - self.start) / 1e6 if self.start is not None else 0.0
+
+
+def decimate(seconds, values, points):
+    """Reduces to the minimum and maximum of each of points buckets."""
+    if len(values) <= 2 * points:
+        return seconds, values
+    buckets = len(values) // points
+    length = buckets * points
+    shaped = values[-length:].reshape(points, buckets)
+    times = seconds[-length:].reshape(points, buckets)[:, 0]
+    return (numpy.repeat(times, 2),
+            numpy.column_stack((shaped.min(axis=1), shaped.max(axis=1))).ravel())
+
+
+class Plot(object):
+    def __init__(self, recordings, points):
+        import matplotlib.pyplot as pyplot
+        self.pyplot = pyplot
+        self.recordings = recordings
+        self.points = points
+        pyplot.ion()
+        self.figure, (self.current, self.voltage) = pyplot.subplots(2, 1, sharex=True)
+        self.current.set_ylabel('mA')
+        self.voltage.set_ylabel('mV')
+        self.voltage.set_xlabel('seconds')
+        self.lines = [(self.current.plot([], [], label=r.unit.name)[0], self.voltage.plot([], [])[0])
+                      for r in recordings]
+        self.current.legend(loc='upper left')
+
+    def update(self):
+        for recording, (current_line, voltage_line) in zip(self.recordings, self.lines):
+            if not recording.recent:
+                continue
+            seconds = numpy.concatenate([chunk[0] for chunk in recording.recent])
+            current_line.set_data(*decimate(seconds, numpy.concatenate([chunk[1] for chunk in recording.recent]), self.points))
+            voltage_line.set_data(*decimate(seconds, numpy.concatenate([chunk[2] for chunk in recording.recent]), self.points))
+        for axes in (self.current, self.voltage):
+            axes.relim()
+            axes.autoscale_view()
+        self.pyplot.pause(0.001)
+
+
+def report(recordings, started):
+    elapsed = time.time() - started
+    for r in recordings:
+        print('%s: %d records, %.1f/s, %d dropped in %d gaps, %d corrupt'
+              % (r.unit.name, r.records, r.records / elapsed if elapsed else 0, r.dropped, r.gaps,
+                 r.unit.connection.corrupt), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('ports', nargs='+', help='Serial ports, one per unit')
+    parser.add_argument('--out', default='record', help='Output file prefix (default %(default)s)')
+    parser.add_argument('--format', choices=sorted(WRITERS), default='csv')
+    parser.add_argument('--blocks', type=int, default=1, help='ADC blocks per record (default %(default)s)')
+    parser.add_argument('--baud', type=int, default=460800, help='Rate to stream at (default %(default)s)')
+    parser.add_argument('--credit', type=int, default=0, help='Flow control window in records, 0 for none')
+    parser.add_argument('--sync', type=float, help='Sync the units\' clocks this many seconds apart')
+    parser.add_argument('--seconds', type=float, help='Stop after this long')
+    parser.add_argument('--plot', action='store_true', help='Plot live')
+    parser.add_argument('--window', type=float, default=10.0, help='Seconds shown on the plot')
+    parser.add_argument('--points', type=int, default=1000, help='Buckets a line is decimated to')
+    args = parser.parse_args()
+
+    group = reloadpro.Group(args.ports)
+    extension, writer = WRITERS[args.format]
+    recordings = [Recording(unit, writer('%s-%d%s' % (args.out, i + 1, extension)), args.window if args.plot else 0)
+                  for i, unit in enumerate(group.units)]
+    plot = Plot(recordings, args.points) if args.plot else None
+
+    started = time.time()
+    try:
+        if args.baud != reloadpro.DEFAULT_BAUD:
+            group.each(lambda unit: unit.connection.set_baud(args.baud))
+        if args.sync:
+            epoch, _ = group.sync()
+            last_sync = time.time()
+            for recording in recordings:
+                recording.epoch = epoch
+        group.command('stream %d' % args.blocks)
+        if args.credit:
+            group.each(lambda unit: unit.flow_control(args.credit))
+        started = last_plot = last_report = time.time()
+        while args.seconds is None or time.time() - started < args.seconds:
+            time.sleep(POLL_INTERVAL)
+            for recording in recordings:
+                recording.take()
+            now = time.time()
+            if args.sync and now - last_sync >= args.sync:
+                _, statuses = group.sync()
+                for recording, (drift, error) in zip(recordings, statuses):
+                    if abs(error) > SYNC_WARNING_US:
+                        print('%s: clock %dus off at sync, drift %dppb' % (recording.unit.name, error, drift),
+                              file=sys.stderr)
+                last_sync = now
+            if plot is not None and now - last_plot >= PLOT_INTERVAL:
+                plot.update()
+                last_plot = now
+            if now - last_report >= REPORT_INTERVAL:
+                report(recordings, started)
+                last_report = now
+    except KeyboardInterrupt:
+        pass
+    finally:
+        try:
+            group.command('stream 0')
+            for recording in recordings:
+                recording.take()
+            if args.baud != reloadpro.DEFAULT_BAUD:
+                group.each(lambda unit: unit.connection.set_baud(reloadpro.DEFAULT_BAUD))
+        finally:
+            for recording in recordings:
+                recording.writer.close()
+            group.close()
+
+    report(recordings, started)
+    for recording in recordings:
+        print('%s: %.1f seconds recorded' % (recording.unit.name, recording.seconds()), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
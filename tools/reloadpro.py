@@ -0,0 +1,1058 @@
+"""Host library for the Re:load Pro's serial protocol.
+
+Commands are pipelined: send() writes a command straight away and returns a
+Reply to wait on later, so a host can have several in flight instead of
+waiting out a round trip for each one:
+
+    import reloadpro
+    unit = reloadpro.Unit('/dev/ttyACM0')
+    replies = [unit.send('set %d' % ma) for ma in (100, 200, 300)]
+    status = unit.send('status')
+    print(status.wait())
+
+Replies are matched to commands in the order they were sent. The firmware
+answers each command with one line starting with its name, or "ok" or "err
+...", apart from a few with longer answers (REPLY_ENDS) and 'monitor', which
+doesn't answer at all. An "err" reply is raised as UnitError from wait().
+Lines nobody asked for (events, faults, monitor readings, sequence logs, and
+finished sweeps and captures) are kept apart, as are binary stream records,
+which arrive between lines and are checked against their CRC. Impedance
+sweeps and load regulation tables count as sweeps.
+
+One background thread per serial port does the reading. How much can be in
+flight at once is bounded by the firmware's receive ring (COMMS_RX_BUFFER_SIZE
+in tasks.h), which has no flow control.
+
+Several units each on their own port are driven together with Group. Units
+sharing one port (see the firmware's 'address' command) share a Connection;
+only one command is in flight on it at a time, so their answers can't
+collide. They can't stream on it.
+Group.sync() puts their stream timestamps on one clock, over the trigger line.
+Parallel drives units wired in parallel as one load of their combined
+current, stepping them together on the hardware trigger.
+Unit.identify() and Unit.capabilities() read the firmware's version, serial
+number and fixed limits, for tools that set themselves up per unit.
+A port may also be a pyserial URL: socket://host:port reaches a unit shared
+through tools/bridge.py.
+
+The decoders return numpy arrays: stream_array() for stream records,
+channel_array() for the channel records of 'stream' with channels named,
+log_array() for 'log dump' (rows as tools/datalog.py reads them) and
+capture_array() for triggered captures. Needs pyserial, and numpy for the
+decoders. Run on its own it sends commands to each unit given and prints the
+replies:
+
+    python tools/reloadpro.py /dev/ttyACM0 /dev/ttyACM1 -c status -c 'debug'
+"""
+from __future__ import print_function
+import argparse
+import collections
+import struct
+import threading
+import time
+
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+import serial
+
+from datalog import ROW_SIZE, decode_row
+
+
+DEFAULT_BAUD = 115200
+DEFAULT_TIMEOUT = 2.0  # Seconds to wait for a reply
+
+# The firmware's receive ring is COMMS_RX_BUFFER_SIZE bytes; keep the commands
+# it holds at once a little short of that
+RX_WINDOW = 144
+
+STREAM_SYNC = 0xA5
+STREAM_RECORD = struct.Struct('<BHIiiBH')  # sync, sequence, timestamp, current, voltage, flags, crc
+STREAM_PULSE_HIGH = 0x01
+STREAM_PULSE_EDGE = 0x02
+
+# Channel records, laid out as the header before them says. The sizes here
+# are the firmware's, for records arriving before their first header.
+STREAM_SYNC_CHANNELS = 0xAA
+STREAM_SYNC_HEADER = 0xAB
+STREAM_CHANNELS = ('i', 'v', 'p', 'temp', 'opamp', 'fet', 'set', 'flags')
+STREAM_CHANNEL_SIZES = (4, 4, 4, 2, 2, 2, 4, 2)
+STREAM_CHANNEL_TYPES = {4: '<i', 2: '<h', 1: '<b'}
+STREAM_DEGRADED_EVERY = 16  # Records sent, out of credit
+
+FRAME_SYNC = 0xA6
+FRAME_SYNC_ADDRESSED = 0xA7
+FRAME_BROADCAST = 0xFF
+FRAME_REPLY = 0x80
+FRAME_ERROR = 0xFF
+
+# Frame opcodes, as frame_commands in comms.c. Only those in BINARY_OPCODES
+# reply in binary; the rest take their command's arguments as text and get its
+# usual text reply. OPCODE_FAST_SET has no reply of its own: the unit applies
+# it at the next control update and acknowledges it then, between any others.
+OPCODES = ['mode', 'set', 'reset', 'read', 'monitor', 'debug', 'filter', 'stream',
+           'pulse', 'sequence', 'boot', 'baud', 'status', 'awg', 'cal', 'sequence', 'set']
+OPCODE_SET = 0x01
+OPCODE_READ = 0x03
+OPCODE_STATUS = 0x0C
+OPCODE_AWG = 0x0D
+OPCODE_CAL = 0x0E
+OPCODE_SEQUENCE_TABLE = 0x0F
+OPCODE_FAST_SET = 0x10
+BINARY_OPCODES = (OPCODE_SET, OPCODE_READ, OPCODE_STATUS, OPCODE_AWG, OPCODE_CAL, OPCODE_SEQUENCE_TABLE)
+
+# Waveform samples are int16 fractions of the amplitude, this being all of it
+AWG_FULL_SCALE = 32767
+AWG_CHUNK = 32  # Samples per upload frame, to fit MAX_COMMS_LINE_LENGTH
+
+# cal_blob in config.h: header, the calibration settings, the IDAC tables
+# (high then low) and the CRC of everything before it
+CAL_BLOB = struct.Struct('<HBB2I12i64hHH')
+CAL_BLOB_MAGIC = 0xCA1B
+CAL_BLOB_VERSION = 1
+CAL_BLOB_CHUNK = 64  # Bytes per 'cal' frame
+CAL_FIELDS = ('dac_low_gain', 'dac_high_gain', 'dac_low_offset', 'dac_high_offset', 'opamp_offset_trim',
+              'adc_current_offset', 'adc_current_gain', 'adc_voltage_offset', 'adc_voltage_gain',
+              'adc_current_tempco', 'adc_voltage_tempco', 'cal_temperature')
+DAC_TABLE_POINTS = 32
+
+
+def cal_blob_decode(blob):
+    """A cal_blob as a dict: 'version', 'serial' in hex as 'id' gives it,
+    the CAL_FIELDS and 'dac_high' and 'dac_low' tables. Raises ValueError if
+    it's not one, or fails its CRC."""
+    if len(blob) != CAL_BLOB.size:
+        raise ValueError('calibration is %d bytes, not %d' % (len(blob), CAL_BLOB.size))
+    values = CAL_BLOB.unpack(bytes(blob))
+    magic, version, length, serial = values[0], values[1], values[2], values[3:5]
+    if magic != CAL_BLOB_MAGIC or version != CAL_BLOB_VERSION or length != CAL_BLOB.size:
+        raise ValueError('not a version %d calibration' % CAL_BLOB_VERSION)
+    if crc16(blob[:-2]) != values[-1]:
+        raise ValueError('calibration fails its CRC')
+    first = 5 + len(CAL_FIELDS)
+    decoded = dict(zip(CAL_FIELDS, values[5:first]))
+    decoded['version'] = version
+    decoded['serial'] = '%08x%08x' % serial
+    decoded['dac_high'] = list(values[first:first + DAC_TABLE_POINTS])
+    decoded['dac_low'] = list(values[first + DAC_TABLE_POINTS:first + 2 * DAC_TABLE_POINTS])
+    return decoded
+
+
+# sequence_step in config.h: duration ms, setpoint, threshold, mode, until,
+# jump (-1 for none) and jumps (0 for always)
+SEQUENCE_STEP = struct.Struct('<IiiBBbB')
+SEQUENCE_CHUNK = 4  # Steps per upload frame, to fit MAX_COMMS_LINE_LENGTH
+SEQUENCE_UNTILS = ('none', 'v<', 'v>', 'i<', 'i>', 'p<', 'p>', 'ah', 'wh')
+
+# status_snapshot in tasks.h
+STATUS = struct.Struct('<iiiiiBBhhhHB')
+STATUS_FIELDS = ('setpoint', 'current', 'voltage', 'power', 'resistance', 'load_mode',
+                 'output_mode', 'opamp_out', 'fet_in', 'temperature', 'dither_rate', 'dither_fraction')
+LOAD_MODES = ('cc', 'cv', 'cr', 'cp', 'pulse')
+OUTPUT_MODES = ('off', 'on', 'feedback')
+
+# The last line of replies longer than one line, by command and first
+# argument where that matters. "ok" and "err" end any reply.
+REPLY_ENDS = {
+    'debug': ('info boot ui',),
+    'adc': ('adc slow',),
+    'stats': ('stats ui',),
+    'stats iv': ('stats voltage',),
+    'selftest': ('selftest ok', 'selftest failed'),
+    'mppt': ('mppt max',),
+    'bench': ('bench lzfx_byte',),
+    'sweep dump': ('sweep done',),
+    'impedance dump': ('impedance done',),
+    'capture dump': ('capture done',),
+    'loadreg dump': ('loadreg done',),
+    'battery curve': ('battery curve',),
+    'mem': ('mem heap',),
+}
+# Replies giving their own line count ("faults <n>") or a count of binary log
+# rows to follow ("log dump <n>")
+COUNTED_REPLIES = ('faults', 'presets', 'caps', 'macros', 'steps', 'watches', 'results')
+LOG_DUMP = 'log dump'
+NO_REPLY = ('monitor', 'credit')
+
+# Unrequested output that spans several lines
+BLOCKS = {'capture data': 'capture done', 'sweep point': 'sweep done', 'sweep done': 'sweep done',
+          'impedance point': 'impedance done', 'impedance done': 'impedance done',
+          'loadreg point': 'loadreg done', 'loadreg done': 'loadreg done', 'capture step': 'capture step'}
+NOTICES = ('event', 'fault', 'seq')
+# Reported when the firmware drops input, after which replies can't be matched
+RX_ERRORS = ('err line too long', 'err receive buffer overflow')
+
+
+def _crc_table():
+    table = []
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        table.append(crc & 0xFFFF)
+    return table
+
+CRC_TABLE = _crc_table()
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16 CCITT, as crc16_update() in the firmware, a table at a time."""
+    for byte in bytearray(data):
+        crc = ((crc << 8) & 0xFFFF) ^ CRC_TABLE[(crc >> 8) ^ byte]
+    return crc
+
+
+class UnitError(Exception):
+    """An "err" reply, or a connection that lost track of its replies."""
+    pass
+
+
+class Reply(object):
+    """The answer to one command: text lines, a binary frame, or log rows."""
+
+    def __init__(self, command, ends=None):
+        self.command = command
+        self.ends = ends  # Prefixes of the last line, or None for one line
+        self.lines = []
+        self.data = bytearray()  # Rows following "log dump"
+        self.frame = None  # (opcode, payload) of a binary reply
+        self.error = None
+        self.binary = False  # Answered by a frame
+        self.remaining = 0
+        self.size = 0  # Bytes it holds in the firmware's receive ring
+        self.done = threading.Event()
+        self.connection = None
+
+    def started(self):
+        return bool(self.lines) or self.frame is not None
+
+    def wait(self, timeout=None):
+        """Returns the reply's lines, or raises UnitError. A timeout abandons
+        everything in flight on the connection, since the answers still to
+        come could no longer be told apart."""
+        if not self.done.wait(self.connection.timeout if timeout is None else timeout):
+            self.connection.abort('no reply to %s' % self.command)
+        if self.error:
+            raise UnitError('%s: %s' % (self.command, self.error))
+        return self.lines
+
+    def line(self, timeout=None):
+        """The first line as a list of words."""
+        return self.wait(timeout)[0].split()
+
+
+class Connection(object):
+    """One serial port, with a reader thread matching replies to commands."""
+
+    def __init__(self, port, baud=DEFAULT_BAUD, timeout=DEFAULT_TIMEOUT, shared=False):
+        self.port = port
+        self.timeout = timeout
+        self.shared = shared
+        # A URL such as socket://host:port reaches a unit through tools/bridge.py
+        self.serial = serial.serial_for_url(port, baud, timeout=0.1)
+        self.serial.reset_input_buffer()
+
+        self.lock = threading.Condition()
+        self.pending = collections.deque()
+        self.in_flight = 0
+        self.buffer = bytearray()
+        self.block = None  # Lines of an unrequested sweep or capture
+
+        # Records are kept raw, as sent, for stream_array()
+        self.stream = bytearray()
+        self.stream_sequence = None
+        self.stream_dropped = 0
+        self.channel_records = []  # (sequence, timestamp, present, values by channel)
+        self.channel_sizes = list(STREAM_CHANNEL_SIZES)
+        self.channel_layout = None  # (blocks, [(channel, size, every)]) from the last header
+        self.channel_dropped = 0  # As the last channel record counted them
+        self.credit_window = 0  # Records of flow control credit, 0 if off
+        self.credit_due = 0  # Received since credit was last granted
+        self.corrupt = 0  # Stream records and frames failing their CRC
+
+        self.notices = queue.Queue()  # (host time, line) of events, faults, readings...
+        self.captures = queue.Queue()  # Lines of each finished capture
+        self.sweeps = queue.Queue()  # And sweep, I-V or impedance
+        self.setpoint_acks = queue.Queue()  # (microamps, unit microseconds) of each fast set applied
+
+        self.running = True
+        self.reader = threading.Thread(target=self._read)
+        self.reader.daemon = True
+        self.reader.start()
+
+    def close(self):
+        self.running = False
+        self.reader.join()
+        self.serial.close()
+
+    def send(self, command, address=None, ends=None):
+        """Sends a text command and returns its Reply without waiting for it.
+        address is a unit number on a shared bus, or '*' for all of them, in
+        which case nothing answers."""
+        words = command.split()
+        name = words[0] if words else ''
+        line = command if address is None else '@%s %s' % (address, command)
+        data = (line + '\r\n').encode('ascii')
+        if address == '*' or name in NO_REPLY:
+            reply = Reply(command)
+            reply.done.set()
+        else:
+            if ends is None:
+                ends = REPLY_ENDS.get(' '.join(words[:2]), REPLY_ENDS.get(name))
+            reply = Reply(command, ends)
+        return self._submit(reply, data)
+
+    def send_frame(self, opcode, payload=b'', address=None):
+        """Sends a binary frame. The opcodes in BINARY_OPCODES reply with one;
+        for the rest payload is the command's arguments and the reply is text,
+        as from send()."""
+        if address is None:
+            header = bytearray([opcode, len(payload)])
+            sync = FRAME_SYNC
+        else:
+            number = FRAME_BROADCAST if address == '*' else address
+            header = bytearray([number, opcode, len(payload)])
+            sync = FRAME_SYNC_ADDRESSED
+        body = bytes(header) + bytes(payload)
+        data = bytes(bytearray([sync])) + body + struct.pack('<H', crc16(body))
+
+        name = OPCODES[opcode] if opcode < len(OPCODES) else '0x%02x' % opcode
+        if address == '*' or name in NO_REPLY or opcode == OPCODE_FAST_SET:
+            reply = Reply(name)
+            reply.done.set()
+        elif opcode in BINARY_OPCODES:
+            reply = Reply(name)
+            reply.binary = True
+        else:
+            words = [name] + bytearray(payload).decode('ascii').split()
+            reply = Reply(' '.join(words), REPLY_ENDS.get(' '.join(words[:2]), REPLY_ENDS.get(name)))
+        return self._submit(reply, data)
+
+    def _submit(self, reply, data):
+        reply.connection = self
+        with self.lock:
+            if not reply.done.is_set():
+                # Hold back until the firmware has room for it, or on a shared
+                # bus until the last unit has answered
+                deadline = time.time() + self.timeout
+                while self.pending and (self.shared or self.in_flight + len(data) > RX_WINDOW):
+                    if time.time() > deadline:
+                        self._abort('no reply to %s' % self.pending[0].command)
+                        break
+                    self.lock.wait(0.05)
+                reply.size = len(data)
+                self.in_flight += reply.size
+                self.pending.append(reply)
+            self.serial.write(data)
+        return reply
+
+    def command(self, command, address=None, timeout=None):
+        """Sends a command and waits for its reply's lines."""
+        return self.send(command, address).wait(timeout)
+
+    def drain(self, timeout=None):
+        """Waits for every reply in flight."""
+        with self.lock:
+            outstanding = list(self.pending)
+        for reply in outstanding:
+            reply.wait(timeout)
+
+    def abort(self, reason):
+        with self.lock:
+            self._abort(reason)
+        raise UnitError('%s: %s' % (self.port, reason))
+
+    def _abort(self, reason):
+        while self.pending:
+            reply = self.pending.popleft()
+            reply.error = reason
+            reply.done.set()
+        self.in_flight = 0
+        self.lock.notify_all()
+
+    def _finish(self, reply):
+        self.pending.popleft()
+        self.in_flight -= reply.size
+        reply.done.set()
+        self.lock.notify_all()
+
+    def take_stream(self):
+        """Returns the stream records received since the last call, as raw
+        bytes for stream_array()."""
+        with self.lock:
+            records = bytes(self.stream)
+            del self.stream[:]
+        return records
+
+    def take_channels(self):
+        """Returns the channel records received since the last call, as
+        (sequence, timestamp, present, values) for channel_array()."""
+        with self.lock:
+            records, self.channel_records = self.channel_records, []
+        return records
+
+    def set_baud(self, baud):
+        """The firmware's 'baud' handshake: asked at the old rate and confirmed
+        at the new one."""
+        self.drain()
+        self.command('baud %d' % baud)
+        self.serial.flush()
+        self.serial.baudrate = baud
+        time.sleep(0.01)
+        reply = self.command('baud %d' % baud)
+        if reply[0] != 'baud %d ok' % baud:
+            raise UnitError('baud %d not confirmed: %s' % (baud, reply[0]))
+
+    def _read(self):
+        while self.running:
+            try:
+                data = self.serial.read(max(1, self.serial.in_waiting))
+            except serial.SerialException as e:
+                with self.lock:
+                    self._abort(str(e))
+                return
+            if data:
+                with self.lock:
+                    self.buffer.extend(data)
+                    self._parse()
+
+    def _parse(self):
+        buf = self.buffer
+        pos = 0
+        while pos < len(buf):
+            head = self.pending[0] if self.pending else None
+            if head is not None and head.remaining and head.command == LOG_DUMP:
+                # Raw rows straight out of flash
+                take = min(head.remaining, len(buf) - pos)
+                head.data.extend(buf[pos:pos + take])
+                head.remaining -= take
+                pos += take
+                if head.remaining == 0:
+                    self._finish(head)
+                continue
+
+            byte = buf[pos]
+            if byte == STREAM_SYNC:
+                if len(buf) - pos < STREAM_RECORD.size:
+                    break
+                record = buf[pos:pos + STREAM_RECORD.size]
+                if crc16(record[1:-2]) != struct.unpack_from('<H', bytes(record[-2:]))[0]:
+                    self.corrupt += 1
+                    pos += 1
+                    continue
+                sequence = record[1] | (record[2] << 8)
+                if self.stream_sequence is not None:
+                    self.stream_dropped += (sequence - self.stream_sequence - 1) & 0xFFFF
+                self.stream_sequence = sequence
+                self.stream.extend(record)
+                pos += STREAM_RECORD.size
+                self._credit()
+            elif byte == STREAM_SYNC_HEADER:
+                if len(buf) - pos < 3 or len(buf) - pos < 3 * buf[pos + 2] + 5:
+                    break
+                length = 2 + 3 * buf[pos + 2]
+                header = bytes(buf[pos + 1:pos + 1 + length])
+                crc, = struct.unpack_from('<H', bytes(buf[pos + 1 + length:pos + 3 + length]))
+                if crc != crc16(header):
+                    self.corrupt += 1
+                    pos += 1
+                    continue
+                header = bytearray(header)
+                channels = [tuple(header[i:i + 3]) for i in range(2, length, 3)]
+                for channel, size, every in channels:
+                    while channel >= len(self.channel_sizes):
+                        self.channel_sizes.append(0)
+                    self.channel_sizes[channel] = size
+                self.channel_layout = (header[0], channels)
+                pos += length + 3
+            elif byte == STREAM_SYNC_CHANNELS:
+                if len(buf) - pos < 8:
+                    break
+                present = buf[pos + 7]
+                sizes = [size for i, size in enumerate(self.channel_sizes) if present & (1 << i)]
+                length = 10 + sum(sizes) + 2
+                if len(buf) - pos < length:
+                    break
+                record = bytes(buf[pos:pos + length])
+                if crc16(record[1:-2]) != struct.unpack_from('<H', record[-2:])[0]:
+                    self.corrupt += 1
+                    pos += 1
+                    continue
+                sequence, timestamp, present, self.channel_dropped = struct.unpack_from('<HIBH', record, 1)
+                values = [None] * len(self.channel_sizes)
+                offset = 10
+                for i, size in enumerate(self.channel_sizes):
+                    if present & (1 << i):
+                        kind = STREAM_CHANNEL_TYPES.get(size)
+                        if kind is not None:
+                            values[i] = struct.unpack_from(kind, record, offset)[0]
+                        offset += size
+                if self.stream_sequence is not None:
+                    self.stream_dropped += (sequence - self.stream_sequence - 1) & 0xFFFF
+                self.stream_sequence = sequence
+                self.channel_records.append((sequence, timestamp, present, values))
+                pos += length
+                self._credit()
+            elif byte == FRAME_SYNC:
+                if len(buf) - pos < 3 or len(buf) - pos < buf[pos + 2] + 5:
+                    break
+                length = buf[pos + 2]
+                frame = bytes(buf[pos + 1:pos + 3 + length])
+                crc, = struct.unpack_from('<H', bytes(buf[pos + 3 + length:pos + 5 + length]))
+                if crc != crc16(frame):
+                    self.corrupt += 1
+                    pos += 1
+                    continue
+                pos += length + 5
+                self._frame(bytearray(frame)[0], frame[2:])
+            else:
+                end = buf.find(b'\n', pos)
+                if end < 0:
+                    break
+                line = buf[pos:end].decode('ascii', 'replace').strip()
+                pos = end + 1
+                if line:
+                    self._line(line)
+        del buf[:pos]
+
+    def _credit(self):
+        # Grants credit for what has arrived, half a window at a time, so the
+        # unit only runs out if this thread stops reading
+        if self.credit_window:
+            self.credit_due += 1
+            if self.credit_due >= max(1, self.credit_window // 2):
+                self.send('credit %d' % self.credit_due)
+                self.credit_due = 0
+
+    def flow_control(self, window):
+        """Turns on credit flow control for the stream just started, window
+        records ahead; 0 stops granting. The unit sends what it hasn't credit
+        for decimated by STREAM_DEGRADED_EVERY, and counts the rest as
+        dropped. The window's records have to fit in the port's buffers."""
+        with self.lock:
+            self.credit_window = window
+            self.credit_due = 0
+        if window:
+            self.send('credit %d' % window)
+
+    def _frame(self, opcode, payload):
+        if opcode == OPCODE_FAST_SET | FRAME_REPLY and len(payload) == 8:
+            self.setpoint_acks.put(struct.unpack('<iI', bytes(payload)))
+            return
+        head = self.pending[0] if self.pending else None
+        if head is None or head.started():
+            self.corrupt += 1
+            return
+        head.frame = (opcode, payload)
+        if opcode == FRAME_ERROR:
+            head.error = 'frame rejected'
+        self._finish(head)
+
+    def _line(self, line):
+        if self.block is not None:
+            self.block.append(line)
+            if line.startswith(BLOCKS[' '.join(self.block[0].split()[:2])]):
+                (self.captures if line.startswith('capture') else self.sweeps).put(self.block)
+                self.block = None
+            return
+
+        head = self.pending[0] if self.pending else None
+        if head is not None and head.started():
+            self._reply_line(head, line)
+            return
+
+        # A command's reply is never broken up by other output, so only lines
+        # before it starts need sorting out
+        words = line.split()
+        start = ' '.join(words[:2])
+        asked = head.command.split()[0] if head is not None and not head.binary else None
+        if line in RX_ERRORS:
+            self._abort(line)
+        elif start in BLOCKS and not (head is not None and head.command.startswith((start.split()[0] + ' dump', start))):
+            self.block = [line]
+            if line.startswith(BLOCKS[start]):
+                (self.captures if line.startswith('capture') else self.sweeps).put(self.block)
+                self.block = None
+        elif words[0] in NOTICES or (words[0] in ('read', 'bench', 'ocp') and words[0] != asked):
+            # 'read' lines from 'monitor', the display's 'bench' figures and a
+            # finished OCP test's result
+            self.notices.put((time.time(), line))
+        elif head is not None:
+            self._reply_line(head, line)
+        else:
+            self.notices.put((time.time(), line))
+
+    def _reply_line(self, head, line):
+        head.lines.append(line)
+        words = line.split()
+        if words[0] in ('ok', 'err'):
+            if words[0] == 'err':
+                head.error = line
+            self._finish(head)
+        elif len(head.lines) == 1 and head.command == LOG_DUMP:
+            head.remaining = int(words[2]) * ROW_SIZE
+            if head.remaining == 0:
+                self._finish(head)
+        elif len(head.lines) == 1 and words[0] in COUNTED_REPLIES:
+            head.remaining = int(words[1])
+            if head.remaining == 0:
+                self._finish(head)
+        elif head.remaining:
+            head.remaining -= 1
+            if head.remaining == 0:
+                self._finish(head)
+        elif head.ends is None or line.startswith(head.ends):
+            self._finish(head)
+
+
+class Unit(object):
+    """One load: on its own port, or by address on a shared Connection."""
+
+    def __init__(self, port, baud=DEFAULT_BAUD, timeout=DEFAULT_TIMEOUT, address=None):
+        if isinstance(port, Connection):
+            self.connection = port
+        else:
+            self.connection = Connection(port, baud, timeout, shared=address is not None)
+        self.address = address
+        self.name = self.connection.port if address is None else '%s@%s' % (self.connection.port, address)
+
+    def close(self):
+        self.connection.close()
+
+    def send(self, command, ends=None):
+        return self.connection.send(command, self.address, ends)
+
+    def command(self, command, timeout=None):
+        return self.send(command).wait(timeout)
+
+    def frame(self, opcode, payload=b''):
+        return self.connection.send_frame(opcode, payload, self.address)
+
+    def configure(self, commands):
+        """Runs commands together between 'config begin' and 'config
+        commit', so the control loops only ever see all of them, and returns
+        how many answered with an error as they ran. One the unit refuses as
+        it's staged raises UnitError, with none of them run."""
+        self.command('config begin')
+        try:
+            for command in commands:
+                self.command(command)
+        except UnitError:
+            self.command('config abort')
+            raise
+        return int(self.send('config commit').line()[3])
+
+    def set(self, milliamps):
+        """Sets the current and returns the setpoint, in milliamps."""
+        return int(self.send('set %d' % milliamps).line()[1])
+
+    def read(self):
+        """(milliamps, millivolts)"""
+        words = self.send('read').line()
+        return int(words[1]), int(words[2])
+
+    def set_microamps(self, microamps):
+        """As set(), in microamps, by binary frame."""
+        return struct.unpack('<i', self._frame_reply(OPCODE_SET, struct.pack('<i', microamps)))[0]
+
+    def fast_set(self, microamps, timeout=None):
+        """Sets the current, in microamps, by fast set frame, which the unit
+        applies within a block without waiting on its command queue, and
+        returns (setpoint, unit microseconds it was applied at) from its
+        acknowledgement. timeout 0 returns None at once instead, leaving the
+        acknowledgement in connection.setpoint_acks."""
+        self.frame(OPCODE_FAST_SET, struct.pack('<i', microamps))
+        if timeout == 0:
+            return None
+        try:
+            return self.connection.setpoint_acks.get(timeout=timeout or self.connection.timeout)
+        except queue.Empty:
+            raise UnitError('%s: fast set not acknowledged' % self.name)
+
+    def read_micro(self):
+        """(microamps, microvolts), by binary frame."""
+        return struct.unpack('<ii', self._frame_reply(OPCODE_READ))
+
+    def identify(self):
+        """(firmware version, protocol version, serial number) from 'id'."""
+        words = self.send('id').line()
+        return words[2], int(words[3]), words[4]
+
+    def capabilities(self):
+        """The 'caps' table as a dict of ints, with 'modes' a list of names."""
+        caps = {}
+        for line in self.command('caps')[1:]:
+            words = line.split()
+            caps[words[1]] = words[2:] if words[1] == 'modes' else int(words[2])
+        return caps
+
+    def status(self):
+        """status_snapshot as a dict, by binary frame."""
+        values = dict(zip(STATUS_FIELDS, STATUS.unpack(self._frame_reply(OPCODE_STATUS))))
+        values['load_mode'] = LOAD_MODES[values['load_mode']]
+        values['output_mode'] = OUTPUT_MODES[values['output_mode']]
+        return values
+
+    def awg_upload(self, samples):
+        """Replaces the waveform table with samples, each -1.0 to 1.0 of the
+        amplitude about the offset, by binary frame. Play it with 'awg'.
+        Returns the table's length."""
+        values = [int(round(max(-1.0, min(1.0, s)) * AWG_FULL_SCALE)) for s in samples]
+        length = 0
+        for first in range(0, len(values), AWG_CHUNK):
+            chunk = values[first:first + AWG_CHUNK]
+            payload = struct.pack('<B%dh' % len(chunk), first, *chunk)
+            length = struct.unpack('<B', self._frame_reply(OPCODE_AWG, payload))[0]
+        return length
+
+    def cal_export(self):
+        """The unit's calibration as a cal_blob, checked with
+        cal_blob_decode()."""
+        self.command('cal export')
+        blob = bytearray()
+        while len(blob) < CAL_BLOB.size:
+            reply = self._frame_reply(OPCODE_CAL, struct.pack('<B', len(blob)))
+            if len(reply) < 2:
+                raise UnitError('%s: calibration ended at byte %d' % (self.name, len(blob)))
+            blob += reply[1:]
+        cal_blob_decode(blob)
+        return bytes(blob)
+
+    def cal_import(self, blob, force=False):
+        """Makes a cal_blob the unit's calibration, and saves it. Unless
+        forced, the unit refuses one exported by another unit."""
+        cal_blob_decode(blob)
+        for offset in range(0, len(blob), CAL_BLOB_CHUNK):
+            self._frame_reply(OPCODE_CAL, struct.pack('<B', offset) + bytes(blob[offset:offset + CAL_BLOB_CHUNK]))
+        self.command('cal import force' if force else 'cal import')
+
+    def sequence_results(self):
+        """Each step's figures from its last run since the sequence started,
+        as dicts: runs (0 if it hasn't ended yet), end, ms, uah, uwh, and
+        min, mean and max of ma and mv."""
+        results = []
+        for line in self.command('sequence results')[1:]:
+            words = line.split()
+            numbers = [int(w) for w in words[5:]]
+            results.append({'runs': int(words[2]), 'end': words[3], 'ms': int(words[4]),
+                            'uah': numbers[0], 'uwh': numbers[1], 'ma': tuple(numbers[2:5]), 'mv': tuple(numbers[5:8])})
+        return results
+
+    def sequence_upload(self, table):
+        """Replaces the sequencer's steps with table, packed sequence_steps
+        as tools/loadprofile.py compiles them, by binary frame. Start it with
+        'sequence start'. Returns the number of steps."""
+        chunk = SEQUENCE_STEP.size * SEQUENCE_CHUNK
+        if len(table) % SEQUENCE_STEP.size:
+            raise ValueError('a step table is whole sequence_steps')
+        length = 0
+        for first in range(0, max(len(table), 1), chunk):
+            payload = struct.pack('<B', first // SEQUENCE_STEP.size) + bytes(table[first:first + chunk])
+            length = struct.unpack('<B', self._frame_reply(OPCODE_SEQUENCE_TABLE, payload))[0]
+        return length
+
+    def _frame_reply(self, opcode, payload=b''):
+        reply = self.frame(opcode, payload)
+        reply.wait()
+        return reply.frame[1]
+
+    def stream(self, blocks, channels=None):
+        """Starts binary streaming, a record every blocks ADC blocks, or stops
+        it with 0. channels, a list of names from STREAM_CHANNELS or a dict of
+        them to how many records apart each is sent, streams channel records
+        of just those instead."""
+        if isinstance(channels, dict):
+            names = ['%s/%d' % (name, every) for name, every in sorted(channels.items())]
+        else:
+            names = list(channels or ())
+        self.connection.flow_control(0)
+        self.command(' '.join(['stream %d' % blocks] + names))
+
+    def take_stream(self):
+        """The records streamed since the last call, as a stream_array()."""
+        return stream_array(self.connection.take_stream())
+
+    def flow_control(self, window):
+        """Credit flow control for the stream, as Connection.flow_control().
+        Call it after stream(), which turns it off."""
+        self.connection.flow_control(window)
+
+    def take_channels(self):
+        """The channel records streamed since the last call, as a
+        channel_array()."""
+        return channel_array(self.connection.take_channels())
+
+    def log_dump(self):
+        """The on-device log as a log_array()."""
+        reply = self.send(LOG_DUMP)
+        reply.wait()
+        return log_array(reply.data)
+
+    def capture_dump(self):
+        """The last triggered capture again, as a capture_array()."""
+        return capture_array(self.command('capture dump'))
+
+    def capture_step(self, band=None):
+        """The last triggered capture's step response, as a capture_step_dict();
+        band is how close to the final level recovery means, in mV."""
+        return capture_step_dict(self.command('capture step' if band is None else 'capture step %d' % band))
+
+    def memory(self):
+        """RAM use from 'mem': {buffer: (size, bytes, fill, peak)}, {task:
+        (words, peak words)} for the stacks, and (heap bytes, free)."""
+        buffers, stacks, heap = {}, {}, None
+        for line in self.command('mem'):
+            words = line.split()
+            if words[1] == 'stack':
+                stacks[words[2]] = (int(words[3]), int(words[4]))
+            elif words[1] == 'heap':
+                heap = (int(words[2]), int(words[3]))
+            else:
+                buffers[words[1]] = tuple(int(w) for w in words[2:6])
+        return buffers, stacks, heap
+
+    def battery_curve(self):
+        """The running or last battery test's discharge curve, thinned on the
+        unit to at most its BATTERY_CURVE_POINTS, as (uAh, mV) pairs."""
+        return [(int(line.split()[2]), int(line.split()[3])) for line in self.command('battery curve')[:-1]]
+
+    def wait_capture(self, timeout=None):
+        """Waits for an armed capture to be sent, as a capture_array(), or a
+        capture_step_dict() if 'capture step' was given after arming it."""
+        try:
+            lines = self.connection.captures.get(timeout=timeout)
+        except queue.Empty:
+            raise UnitError('%s: no capture' % self.name)
+        if lines[0].startswith('capture step'):
+            return capture_step_dict(lines)
+        return capture_array(lines)
+
+
+class Group(object):
+    """Several units driven together, each on its own port."""
+
+    def __init__(self, ports, baud=DEFAULT_BAUD, timeout=DEFAULT_TIMEOUT):
+        self.units = [Unit(port, baud, timeout) for port in ports]
+
+    def close(self):
+        for unit in self.units:
+            unit.close()
+
+    def command(self, command, timeout=None):
+        """Sends command to every unit before waiting for any of them, and
+        returns their replies' lines in order."""
+        replies = [unit.send(command) for unit in self.units]
+        return [reply.wait(timeout) for reply in replies]
+
+    def each(self, function):
+        """Calls function(unit) for every unit at once, one thread each, and
+        returns the results in order."""
+        results = [None] * len(self.units)
+        errors = []
+
+        def run(i, unit):
+            try:
+                results[i] = function(unit)
+            except Exception as e:
+                errors.append(e)
+
+        threads = [threading.Thread(target=run, args=(i, unit)) for i, unit in enumerate(self.units)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        if errors:
+            raise errors[0]
+        return results
+
+    def sync(self, leader=0):
+        """Puts every unit's stream timestamps on units[leader]'s clock, with
+        a pulse on the trigger line they're all wired to. Repeat every few
+        seconds for the units to follow each other's drift; no trigger
+        actions or sequencer pulses may run meanwhile. Returns the edge's time
+        on that clock, and each unit's sync status as (drift ppb, microseconds
+        the edge was off its predicted time)."""
+        us = int(self.units[leader].command('sync pulse')[0].split()[2])
+        statuses = self.command('sync %d' % us)
+        return us, [tuple(int(word) for word in lines[0].split()[2:4]) for lines in statuses]
+
+
+class Parallel(object):
+    """Units paralleled on one source and driven as a single load.
+
+    Each unit regulates its own current, so they share the load by setpoint
+    alone. set() splits the total in proportion to each unit's present current
+    limit from 'temp', which falls with thermal derating and the SOA. It arms
+    every share with 'trigger set' and then has the leader send 'trigger
+    pulse', so that all of them step on the same edge. That needs every
+    unit's Trigger_In, the leader's included, wired to the leader's
+    Trigger_Out.
+    """
+
+    def __init__(self, units, leader=0):
+        self.units = list(units)
+        self.leader = self.units[leader]
+
+    def limits(self):
+        """Each unit's present current limit, in milliamps."""
+        replies = [unit.send('temp') for unit in self.units]
+        return [int(reply.line()[3]) for reply in replies]
+
+    def split(self, milliamps, limits):
+        """Shares of milliamps in proportion to limits, to the milliamp."""
+        available = sum(limits)
+        if milliamps > available:
+            raise UnitError('%d mA is more than the %d mA the units allow' % (milliamps, available))
+        if available == 0:
+            return [0] * len(limits)
+        shares = [milliamps * limit // available for limit in limits]
+        # The leftover milliamps go to the units with the most to spare
+        spare = sorted(range(len(limits)), key=lambda i: limits[i] - shares[i], reverse=True)
+        for i in spare[:milliamps - sum(shares)]:
+            shares[i] += 1
+        return shares
+
+    def set(self, milliamps):
+        """Steps the units to a total of milliamps together and returns the
+        shares."""
+        shares = self.split(milliamps, self.limits())
+        replies = [unit.send('trigger set %d' % share) for unit, share in zip(self.units, shares)]
+        for unit, share, reply in zip(self.units, shares, replies):
+            armed = int(reply.line()[2])
+            if armed != share:
+                raise UnitError('%s armed %d mA of %d' % (unit.name, armed, share))
+        self.leader.command('trigger pulse')
+        for unit, share in zip(self.units, shares):
+            if unit.status()['setpoint'] // 1000 != share:
+                raise UnitError('%s missed the trigger edge' % unit.name)
+        return shares
+
+    def read(self):
+        """(total milliamps, mean millivolts, [(milliamps, millivolts)] by unit)"""
+        replies = [unit.send('read') for unit in self.units]
+        readings = [(int(words[1]), int(words[2])) for words in (reply.line() for reply in replies)]
+        total = sum(current for current, _ in readings)
+        voltage = sum(voltage for _, voltage in readings) // len(readings)
+        return total, voltage, readings
+
+
+def stream_array(records):
+    """Stream records as sent, into a numpy record array with fields sequence,
+    timestamp (us), current (uA), voltage (uV) and flags. The timestamps wrap
+    every 71 minutes; unwrap_us() undoes that."""
+    import numpy
+    dtype = numpy.dtype({
+        'names': ['sequence', 'timestamp', 'current', 'voltage', 'flags'],
+        'formats': ['<u2', '<u4', '<i4', '<i4', 'u1'],
+        'offsets': [1, 3, 7, 11, 15],
+        'itemsize': STREAM_RECORD.size,
+    })
+    return numpy.frombuffer(records, dtype=dtype).view(numpy.recarray)
+
+
+def channel_array(records):
+    """Channel records into a numpy record array with fields sequence,
+    timestamp (us), present (a bit per channel) and a float field per name in
+    STREAM_CHANNELS, in the firmware's units, NaN where a record doesn't carry
+    that channel."""
+    import numpy
+    dtype = [('sequence', '<u2'), ('timestamp', '<u4'), ('present', 'u1')] + [(name, 'f8') for name in STREAM_CHANNELS]
+    array = numpy.zeros(len(records), dtype=dtype).view(numpy.recarray)
+    for row, (sequence, timestamp, present, values) in zip(array, records):
+        row['sequence'], row['timestamp'], row['present'] = sequence, timestamp, present
+        for name, value in zip(STREAM_CHANNELS, values):
+            row[name] = numpy.nan if value is None else value
+    return array
+
+
+def unwrap_us(timestamps):
+    """32 bit microsecond timestamps into int64s counting on from the first."""
+    import numpy
+    unwrapped = timestamps.astype(numpy.int64)
+    if len(unwrapped):
+        steps = numpy.diff(unwrapped) % (1 << 32)
+        unwrapped[1:] = unwrapped[0] + numpy.cumsum(steps)
+    return unwrapped
+
+
+def log_array(data):
+    """'log dump' rows into a numpy record array of time (seconds since
+    logging started), current (mA) and voltage (mV), skipping damaged rows."""
+    import numpy
+    rows = []
+    for offset in range(0, len(data) - ROW_SIZE + 1, ROW_SIZE):
+        decoded = decode_row(bytes(data[offset:offset + ROW_SIZE]))
+        if decoded is not None:
+            rows.append(decoded)
+    samples = [sample for _, row in sorted(rows) for sample in row]
+    log = numpy.zeros(len(samples), dtype=[('time', 'f8'), ('current', 'i4'), ('voltage', 'i4')])
+    if samples:
+        columns = numpy.array(samples, dtype=numpy.int64)
+        log['time'] = columns[:, 0] / 1000.0
+        log['current'] = columns[:, 1]
+        log['voltage'] = columns[:, 2]
+    return log.view(numpy.recarray)
+
+
+def capture_array(lines):
+    """A capture's "capture data ... capture done" lines into a numpy record
+    array of time (seconds from the trigger), current (mA) and voltage (mV)."""
+    import numpy
+    depth, pre, interval = [int(word) for word in lines[0].split()[2:5]]
+    values = numpy.array([[int(word) for word in line.split()] for line in lines[1:1 + depth]],
+                         dtype=numpy.int32).reshape(-1, 2)
+    capture = numpy.zeros(len(values), dtype=[('time', 'f8'), ('current', 'i4'), ('voltage', 'i4')])
+    capture['time'] = (numpy.arange(len(values)) - pre) * interval * 1e-9
+    capture['current'] = values[:, 0]
+    capture['voltage'] = values[:, 1]
+    return capture.view(numpy.recarray)
+
+
+CAPTURE_STEP_FIELDS = ('before', 'after', 'deviation', 'overshoot', 'recovery', 'current_step', 'edge')
+
+
+def capture_step_dict(lines):
+    """A "capture step" line into a dict of CAPTURE_STEP_FIELDS: millivolts,
+    except recovery in microseconds (-1 if it never settled), the current
+    step in milliamps and the current's 10-90% edge in microseconds (-1 if
+    it never got there)."""
+    return dict(zip(CAPTURE_STEP_FIELDS, [int(word) for word in lines[0].split()[2:]]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('ports', nargs='+', help='Serial ports, one per unit')
+    parser.add_argument('-c', '--command', action='append', default=[], help='Command to send; may be repeated')
+    parser.add_argument('--baud', type=int, default=DEFAULT_BAUD)
+    parser.add_argument('--timeout', type=float, default=DEFAULT_TIMEOUT, help='Seconds to wait for each reply')
+    parser.add_argument('--parallel', type=int, metavar='MA',
+                        help='Set a total shared by the units, the first leading the trigger')
+    args = parser.parse_args()
+
+    group = Group(args.ports, args.baud, args.timeout)
+    try:
+        if args.parallel is not None:
+            load = Parallel(group.units)
+            load.set(args.parallel)
+            total, voltage, readings = load.read()
+            for unit, (current, unit_voltage) in zip(group.units, readings):
+                print('%s: %d mA %d mV' % (unit.name, current, unit_voltage))
+            print('total: %d mA %d mV' % (total, voltage))
+        # Everything goes out before the first reply is waited for
+        replies = [[unit.send(command) for command in args.command] for unit in group.units]
+        for unit, sent in zip(group.units, replies):
+            for reply in sent:
+                try:
+                    lines = reply.wait()
+                except UnitError as e:
+                    lines = [str(e)]
+                for line in lines:
+                    print('%s: %s' % (unit.name, line) if len(group.units) > 1 else line)
+    finally:
+        group.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,146 @@
+"""Flash and RAM use of a linked firmware image, from its link map.
+
+PSoC Creator has the linker write a map beside the .elf. Run this from the
+project directory after a build:
+
+    python tools/size_report.py CortexM0/ARM_GCC_493/Debug/"Reload Pro.map"
+
+It totals each region the map's memory configuration lists, and each object
+file's share of them, largest first: flash is the code, the constants and
+the initial values of .data, and RAM is .data, .bss, the FreeRTOS heap (in
+heap_1's .bss), the main stack and the RAM vectors. The linker script already
+refuses an image that overflows either, so this is for seeing where the
+bytes go, and how close to full each is. Exits with status 1 if a region is
+over its length.
+"""
+from __future__ import print_function
+import argparse
+import re
+import sys
+
+
+MEMORY_RE = re.compile(r'^(\w+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)')
+OUTPUT_RE = re.compile(r'^(\.\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(\s+load address 0x([0-9a-fA-F]+))?')
+INPUT_RE = re.compile(r'^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+NAME_ONLY_RE = re.compile(r'^ ?\S+$')
+
+# Output sections the image doesn't occupy: debug information, and the
+# bootloader's metadata and the protection bits, which go to separate addresses
+UNALLOCATED_RE = re.compile(r'^\.(debug|comment|ARM\.attributes|stab|cyloadermeta|cyflashprotect)')
+# And the ones that only take RAM, whatever load address the script gives them
+NO_CONTENTS_RE = re.compile(r'^\.(bss|noinit|ramvectors|heap|stack)$')
+
+
+def read_map(path):
+    """Returns the regions as [(name, origin, length)], the allocated output
+    sections as {name: (address, load address, size)} and their input
+    sections as [(output section, size, object)]."""
+    lines = open(path).read().split('\n')
+    # The linker wraps a long section name onto a line of its own
+    joined = []
+    for line in lines:
+        if joined and NAME_ONLY_RE.match(joined[-1]) and line.strip().startswith('0x'):
+            joined[-1] += line
+        else:
+            joined.append(line)
+
+    regions = []
+    outputs = {}
+    inputs = []
+    in_memory = False
+    in_map = False
+    output = None
+    for line in joined:
+        if line.startswith('Memory Configuration'):
+            in_memory = True
+            continue
+        if line.startswith('Linker script and memory map'):
+            in_memory = False
+            in_map = True
+            continue
+        if in_memory:
+            match = MEMORY_RE.match(line)
+            if match and match.group(1) != 'Name':
+                regions.append((match.group(1), int(match.group(2), 16), int(match.group(3), 16)))
+            continue
+        if not in_map:
+            continue
+        match = OUTPUT_RE.match(line)
+        if match:
+            output = match.group(1)
+            if UNALLOCATED_RE.match(output):
+                output = None
+                continue
+            address = int(match.group(2), 16)
+            load = int(match.group(5), 16) if match.group(5) else address
+            outputs[output] = (address, load, int(match.group(3), 16))
+            continue
+        match = INPUT_RE.match(line)
+        if match and output is not None:
+            size = int(match.group(3), 16)
+            if size > 0:
+                obj = match.group(4).strip().replace('\\', '/').split('/')[-1]
+                inputs.append((output, size, obj))
+    return regions, outputs, inputs
+
+
+def region_of(regions, address):
+    for name, origin, length in regions:
+        if name != '*default*' and origin <= address < origin + length:
+            return name
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('map', help='Link map of the firmware image')
+    parser.add_argument('--top', type=int, default=20, help='Objects to list for each region')
+    args = parser.parse_args()
+
+    regions, outputs, inputs = read_map(args.map)
+    if not regions:
+        sys.exit('%s has no memory configuration' % args.map)
+
+    # Where each output section's bytes go: RAM at its address, and flash at
+    # its load address too if it has contents to copy from there
+    places = {}
+    for name, (address, load, size) in outputs.items():
+        places[name] = set([region_of(regions, address)])
+        if not NO_CONTENTS_RE.match(name):
+            places[name].add(region_of(regions, load))
+        places[name].discard(None)
+
+    used = {}
+    by_object = {}
+    unclaimed = dict((name, size) for name, (_, _, size) in outputs.items())
+    for output, size, obj in inputs:
+        unclaimed[output] -= size
+        for region in places[output]:
+            by_object.setdefault(region, {})
+            by_object[region][obj] = by_object[region].get(obj, 0) + size
+    for name, (_, _, size) in outputs.items():
+        for region in places[name]:
+            used[region] = used.get(region, 0) + size
+            # Alignment fill, and sections like the main stack that only
+            # reserve space
+            if unclaimed[name] > 0:
+                by_object.setdefault(region, {})
+                by_object[region][name] = by_object[region].get(name, 0) + unclaimed[name]
+
+    over = False
+    for name, origin, length in regions:
+        if name == '*default*':
+            continue
+        total = used.get(name, 0)
+        over = over or total > length
+        print('%-6s %6d of %6d bytes, %3d%%%s' % (name, total, length, (total * 100) // length,
+                                                  '  OVER' if total > length else ''))
+        objects = sorted(by_object.get(name, {}).items(), key=lambda item: -item[1])
+        for obj, size in objects[:args.top]:
+            print('    %6d %s' % (size, obj))
+        print()
+    sys.exit(1 if over else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,136 @@
+"""Worst case stack depth for each task and ISR in the firmware.
+
+Build with -fstack-usage added to the compiler's custom flags (Build Settings >
+Compiler > Command Line), so each object gets a .su file with its functions'
+frame sizes. This script walks the call graph from the firmware .elf's
+disassembly to total up the deepest chain from each root. Run it from the
+project directory after a build:
+
+    python tools/stack_report.py CortexM0/ARM_GCC_493/Debug/"Reload Pro.elf"
+
+Calls through function pointers (blx) can't be followed; functions that make
+them are marked with '*' and their figure is a lower bound. So are recursive
+chains, marked with '!'. Functions with no .su entry (the C library and
+assembler) count as 0 bytes and are listed so they can be checked by hand.
+"""
+from __future__ import print_function
+import argparse
+import os
+import re
+import subprocess
+
+
+# Bytes pushed by the hardware on exception entry
+EXCEPTION_FRAME = 32
+# A task's stack also takes the exception frame when it's interrupted, plus the
+# registers the port saves on a context switch
+TASK_CONTEXT = EXCEPTION_FRAME + 32
+
+# Task entry points; ISRs are found by name
+TASKS = ['vTaskUI', 'vTaskComms', 'vTaskADC', 'prvIdleTask']
+ISR_PATTERN = re.compile(r'(_ISR|_isr|Handler|_func)$')
+
+FUNCTION_RE = re.compile(r'^[0-9a-f]+ <([^>]+)>:$')
+CALL_RE = re.compile(r'\tbl\t[0-9a-f]+ <([^>+]+)>')
+INDIRECT_RE = re.compile(r'\tblx\t')
+
+
+def read_stack_usage(dirs):
+    """Returns {function: frame bytes} from every .su file under dirs."""
+    frames = {}
+    for top in dirs:
+        for root, _, files in os.walk(top):
+            for name in files:
+                if not name.endswith('.su'):
+                    continue
+                for line in open(os.path.join(root, name)):
+                    fields = line.rstrip('\n').split('\t')
+                    if len(fields) < 2:
+                        continue
+                    function = fields[0].split(':')[-1]
+                    frames[function] = max(frames.get(function, 0), int(fields[1]))
+    return frames
+
+
+def read_call_graph(objdump, elf):
+    """Returns {function: set of callees} and the set of functions making
+    indirect calls, from the disassembly."""
+    calls = {}
+    indirect = set()
+    current = None
+    output = subprocess.check_output([objdump, '-d', elf]).decode('ascii', 'replace')
+    for line in output.split('\n'):
+        match = FUNCTION_RE.match(line)
+        if match:
+            current = match.group(1)
+            calls.setdefault(current, set())
+            continue
+        if current is None:
+            continue
+        match = CALL_RE.search(line)
+        if match and match.group(1) != current:
+            calls[current].add(match.group(1))
+        elif INDIRECT_RE.search(line):
+            indirect.add(current)
+    return calls, indirect
+
+
+def worst_case(root, frames, calls, indirect, unknown):
+    """Returns (bytes, chain, flags) for the deepest path from root."""
+    memo = {}
+
+    def walk(function, path):
+        if function in path:
+            return 0, [], '!'
+        if function in memo:
+            return memo[function]
+        if function not in frames:
+            unknown.add(function)
+        best, best_chain, flags = 0, [], ''
+        for callee in calls.get(function, ()):
+            depth, chain, callee_flags = walk(callee, path | {function})
+            flags += callee_flags
+            if depth > best:
+                best, best_chain = depth, chain
+        if function in indirect:
+            flags += '*'
+        result = (frames.get(function, 0) + best, [function] + best_chain, ''.join(sorted(set(flags))))
+        memo[function] = result
+        return result
+
+    return walk(root, frozenset())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('elf', help='Linked firmware image')
+    parser.add_argument('--su', action='append', help='Directory to search for .su files (default: the .elf\'s directory)')
+    parser.add_argument('--objdump', default='arm-none-eabi-objdump')
+    parser.add_argument('--chain', action='store_true', help='Print the deepest call chain for each root')
+    args = parser.parse_args()
+
+    frames = read_stack_usage(args.su or [os.path.dirname(os.path.abspath(args.elf))])
+    calls, indirect = read_call_graph(args.objdump, args.elf)
+    isrs = sorted(f for f in calls if ISR_PATTERN.search(f))
+
+    unknown = set()
+    print('%-28s %6s %6s' % ('root', 'bytes', 'words'))
+    for root in TASKS + isrs:
+        if root not in calls:
+            continue
+        depth, chain, flags = worst_case(root, frames, calls, indirect, unknown)
+        depth += EXCEPTION_FRAME if root in isrs else TASK_CONTEXT
+        print('%-28s %6d %6d %s' % (root, depth, (depth + 3) // 4, flags))
+        if args.chain:
+            print('    ' + ' > '.join(chain))
+
+    print()
+    print('ISRs share the main stack and can nest, so its worst case is the sum')
+    print('of the deepest ISR at each interrupt priority in use.')
+    if unknown:
+        print()
+        print('No stack usage for: ' + ', '.join(sorted(unknown)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,125 @@
+"""Reads back the firmware's event trace and lists it or measures latencies.
+
+Needs firmware built with TRACE defined. Sends 'trace dump' and prints each
+record, oldest first, as microseconds since the first, the gap since the one
+before, the event and its argument:
+
+    python tools/trace.py /dev/ttyACM0
+
+or decodes records saved earlier with --save:
+
+    python tools/trace.py --file run.bin
+
+--latency FROM TO instead reports, for each FROM event, the time until the
+next TO event, e.g. button press to IDAC update or line received to reply:
+
+    python tools/trace.py /dev/ttyACM0 --latency button dac
+    python tools/trace.py /dev/ttyACM0 --latency line_rx tx
+
+A record is trace_record in firmware/Reload Pro.cydsn/config.h, and EVENTS
+follows trace_event_id. Needs pyserial unless reading a file.
+"""
+from __future__ import print_function
+import argparse
+import struct
+import sys
+
+
+DEFAULT_BAUD = 115200
+
+RECORD = struct.Struct('<IHBx')  # time, arg, id
+EVENTS = ['task_switch', 'adc_block', 'trip', 'fault', 'button', 'line_rx', 'command', 'tx', 'dac']
+TASKS = ['ui', 'comms', 'adc', 'idle']
+
+
+def describe(event, arg):
+    """The argument the way the firmware means it."""
+    if event == 'task_switch':
+        return TASKS[arg] if arg < len(TASKS) else str(arg)
+    if event == 'command':
+        return ''.join(chr(c) for c in (arg >> 8, arg & 0xFF) if c)
+    if event == 'dac':
+        return 'high %d low %d' % (arg >> 8, arg & 0xFF)
+    return str(arg)
+
+
+def decode(data):
+    """Returns [(us, event, arg)] with the time unwrapped from 32 bits."""
+    records = []
+    last = None
+    us = 0
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        time, arg, id = RECORD.unpack_from(data, offset)
+        if last is not None:
+            us += (time - last) % (1 << 32)
+        last = time
+        records.append((us, EVENTS[id] if id < len(EVENTS) else 'event%d' % id, arg))
+    return records
+
+
+def read_dump(port, baud, timeout):
+    import serial
+    unit = serial.Serial(port, baud, timeout=timeout)
+    unit.reset_input_buffer()
+    unit.write(b'trace dump\r\n')
+    reply = unit.readline().decode('ascii', 'replace').split()
+    if len(reply) != 3 or reply[:2] != ['trace', 'dump']:
+        raise IOError('unexpected answer to trace dump: %s' % ' '.join(reply))
+    records = int(reply[2])
+    data = unit.read(records * RECORD.size)
+    if len(data) < records * RECORD.size:
+        raise IOError('expected %d records, got %d bytes' % (records, len(data)))
+    return data
+
+
+def latencies(records, start, end):
+    """Microseconds from each start event to the next end event after it."""
+    spans = []
+    pending = None
+    for us, event, _ in records:
+        if event == end and pending is not None:
+            spans.append(us - pending)
+            pending = None
+        if event == start and pending is None:
+            pending = us
+    return spans
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('port', nargs='?', help='Serial port of the unit')
+    parser.add_argument('--file', help='Decode records saved with --save instead')
+    parser.add_argument('--save', help='Also write the raw records to this file')
+    parser.add_argument('--baud', type=int, default=DEFAULT_BAUD)
+    parser.add_argument('--timeout', type=float, default=2.0, help='Seconds to wait for the dump')
+    parser.add_argument('--latency', nargs=2, metavar=('FROM', 'TO'), choices=EVENTS,
+                        help='Report the time from each FROM event to the next TO')
+    args = parser.parse_args()
+    if (args.port is None) == (args.file is None):
+        parser.error('give a serial port or --file')
+
+    if args.file:
+        data = open(args.file, 'rb').read()
+    else:
+        data = read_dump(args.port, args.baud, args.timeout)
+    if args.save:
+        open(args.save, 'wb').write(data)
+    records = decode(data)
+
+    if args.latency:
+        spans = sorted(latencies(records, *args.latency))
+        if not spans:
+            print('no %s followed by %s' % tuple(args.latency), file=sys.stderr)
+            return
+        print('%s to %s: %d, min %dus, median %dus, max %dus'
+              % (args.latency[0], args.latency[1], len(spans), spans[0], spans[len(spans) // 2], spans[-1]))
+        return
+
+    last = 0
+    for us, event, arg in records:
+        print('%10d %+8d %-12s %s' % (us, us - last, event, describe(event, arg)))
+        last = us
+
+
+if __name__ == '__main__':
+    main()